@@ -130,6 +130,52 @@ buf_calc_page_old_checksum(
     return(checksum);
 }
 
+/* CRC32C over the same ranges as buf_calc_page_crc32() in InnoDB,
+used by pages written with innodb_checksum_algorithm=crc32 */
+static ulint crc32c_table[256];
+
+void
+crc32c_table_init(void)
+{
+    ulint i, j, c;
+
+    for (i= 0; i < 256; i++)
+    {
+      c= i;
+      for (j= 0; j < 8; j++)
+        c= (c & 1) ? (c >> 1) ^ 0x82F63B78UL : (c >> 1);
+      crc32c_table[i]= c;
+    }
+}
+
+ulint
+crc32c(
+/*===*/
+               /* out: CRC32C */
+    uchar*    buf,  /* in: data */
+    ulint     len)  /* in: length */
+{
+    ulint crc= 0xFFFFFFFFUL;
+
+    while (len--)
+      crc= crc32c_table[(crc ^ *buf++) & 0xFF] ^ (crc >> 8);
+
+    return(~crc & 0xFFFFFFFFUL);
+}
+
+ulint
+buf_calc_page_crc32(
+/*================*/
+               /* out: checksum */
+    uchar*    page) /* in: buffer page */
+{
+    return(crc32c(page + FIL_PAGE_OFFSET,
+                  FIL_PAGE_FILE_FLUSH_LSN - FIL_PAGE_OFFSET)
+           ^ crc32c(page + FIL_PAGE_DATA,
+                    UNIV_PAGE_SIZE - FIL_PAGE_DATA
+                    - FIL_PAGE_END_LSN_OLD_CHKSUM));
+}
+
 
 int main(int argc, char **argv)
 {
@@ -253,6 +299,7 @@ int main(int argc, char **argv)
 
   /* allocate buffer for reading (so we don't realloc every time) */
   p= (uchar *)malloc(UNIV_PAGE_SIZE);
+  crc32c_table_init();
 
   /* main checksumming loop */
   ct= start_page;
@@ -278,9 +325,21 @@ int main(int argc, char **argv)
       return 1;
     }
 
+    oldcsumfield= mach_read_from_4(p + UNIV_PAGE_SIZE - FIL_PAGE_END_LSN_OLD_CHKSUM);
+    csumfield= mach_read_from_4(p + FIL_PAGE_SPACE_OR_CHKSUM);
+
+    /* pages written with the crc32 algorithm store it in both fields */
+    if (csumfield == oldcsumfield)
+    {
+      csum= buf_calc_page_crc32(p);
+      if (debug)
+        printf("page %lu: crc32: calculated = %lu; recorded = %lu\n", ct, csum, csumfield);
+      if (csum == csumfield)
+        goto page_ok;
+    }
+
     /* check old method of checksumming */
     oldcsum= buf_calc_page_old_checksum(p);
-    oldcsumfield= mach_read_from_4(p + UNIV_PAGE_SIZE - FIL_PAGE_END_LSN_OLD_CHKSUM);
     if (debug)
       printf("page %lu: old style: calculated = %lu; recorded = %lu\n", ct, oldcsum, oldcsumfield);
     if (oldcsumfield != mach_read_from_4(p + FIL_PAGE_LSN) && oldcsumfield != oldcsum)
@@ -291,7 +350,6 @@ int main(int argc, char **argv)
 
     /* now check the new method */
     csum= buf_calc_page_new_checksum(p);
-    csumfield= mach_read_from_4(p + FIL_PAGE_SPACE_OR_CHKSUM);
     if (debug)
       printf("page %lu: new style: calculated = %lu; recorded = %lu\n", ct, csum, csumfield);
     if (csumfield != 0 && csum != csumfield)
@@ -300,6 +358,8 @@ int main(int argc, char **argv)
       return 1;
     }
 
+page_ok:
+
     /* end if this was the last page we were supposed to check */
     if (use_end_page && (ct >= end_page))
       return 0;
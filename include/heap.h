@@ -110,6 +110,25 @@ typedef struct st_heap_block
 
 struct st_heap_info;			/* For referense */
 
+	/* Column types that heap_create() has to know about */
+
+enum hp_column_type
+{
+  HP_COLUMN_FIXED,			/* Stored as is */
+  HP_COLUMN_VARCHAR,			/* length_bytes + data */
+  HP_COLUMN_BLOB			/* packlength + pointer to data */
+};
+
+typedef struct st_hp_columndef		/* Column definition with create */
+{
+  uint8 type;				/* enum hp_column_type */
+  uint8 length_bytes;			/* VARCHAR length or BLOB packlength */
+  uint8 null_bit;			/* If column may be NULL */
+  uint null_pos;			/* Position of null marker */
+  uint offset;				/* Offset of column in record */
+  uint length;				/* Length of column in record */
+} HP_COLUMNDEF;
+
 typedef struct st_hp_keydef		/* Key definition with open */
 {
   uint flag;				/* HA_NOSAME | HA_NULL_PART_KEY */
@@ -134,7 +153,9 @@ typedef struct st_hp_keydef		/* Key definition with open */
 typedef struct st_heap_share
 {
   HP_BLOCK block;
+  HP_BLOCK vblock;			/* Chunks with variable-size parts */
   HP_KEYDEF  *keydef;
+  HP_COLUMNDEF *columndef;
   ulong min_records,max_records;	/* Params to open */
   ulonglong data_length,index_length,max_table_size;
   uint key_stat_version;                /* version to indicate insert/delete */
@@ -142,11 +163,18 @@ typedef struct st_heap_share
   uint blength;				/* records rounded up to 2^n */
   uint deleted;				/* Deleted records in database */
   uint reclength;			/* Length of one record */
+  uint fixed_data_length;		/* Part of record stored in the row */
+  uint visible;				/* Offset of row status byte */
+  uint var_chunk_length;		/* Data in one chunk, 0 if no chunks */
+  uint columns;
   uint changed;
   uint keys,max_key_length;
   uint currently_disabled_keys;    /* saved value from "keys" when disabled */
   uint open_count;
   uchar *del_link;			/* Link to next block with del. rec */
+  ulong vchunks;			/* Chunks in use */
+  ulong vdeleted;			/* Free chunks */
+  uchar *vdel_link;			/* Link to next free chunk */
   char * name;			/* Name of "memory-file" */
   time_t create_time;
   THR_LOCK lock;
@@ -171,6 +199,8 @@ typedef struct st_heap_info
   uint opt_flag,update;
   uchar *lastkey;			/* Last used key with rkey */
   uchar *recbuf;                         /* Record buffer for rb-tree keys */
+  uchar *var_buf;			/* Unpacked var part of last record */
+  ulong var_buf_length;
   enum ha_rkey_function last_find_flag;
   TREE_ELEMENT *parents[MAX_TREE_HEIGHT+1];
   TREE_ELEMENT **last_pos;
@@ -184,11 +214,13 @@ typedef struct st_heap_info
 typedef struct st_heap_create_info
 {
   HP_KEYDEF *keydef;
+  HP_COLUMNDEF *columndef;		/* Columns in record order, or 0 */
   ulong max_records;
   ulong min_records;
   uint auto_key;                        /* keynr [1 - maxkey] for auto key */
   uint auto_key_type;
   uint keys;
+  uint columns;
   uint reclength;
   ulonglong max_table_size;
   ulonglong auto_increment;
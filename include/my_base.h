@@ -86,6 +86,17 @@ enum ha_rkey_function {
   HA_READ_MBR_EQUAL
 };
 
+/*
+  Result of checking the index condition pushed down by the SQL layer
+  on an index entry, before the row is read.
+*/
+
+enum icp_result {
+  ICP_NO_MATCH,                   /* Skip the index entry */
+  ICP_MATCH,                      /* Read the row */
+  ICP_OUT_OF_RANGE                /* End of the scanned range, stop */
+};
+
 	/* Key algorithm types */
 
 enum ha_key_alg {
@@ -297,6 +297,10 @@ extern int mi_extra(struct st_myisam_info *file,
 		    enum ha_extra_function function,
 		    void *extra_arg);
 extern int mi_reset(struct st_myisam_info *file);
+typedef enum icp_result (*index_cond_func_t)(void *param);
+extern void mi_set_index_cond_func(struct st_myisam_info *info,
+                                   index_cond_func_t check_func,
+                                   void *func_arg);
 extern ha_rows mi_records_in_range(MI_INFO *info, int inx,
                                    key_range *min_key, key_range *max_key);
 extern int mi_log(int activate_log);
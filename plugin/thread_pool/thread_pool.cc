@@ -0,0 +1,1058 @@
+/* Copyright (c) 2014, Tokutek Inc. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA */
+
+#include "thread_pool.h"
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+/* Max number of events handled by the listener in one epoll_wait() */
+#define MAX_EVENTS 1024
+
+static thread_group_t all_groups[MAX_THREAD_GROUPS];
+static uint group_count;
+
+/* The timer thread, see tp_timer_thread() */
+static struct pool_timer_t
+{
+  mysql_mutex_t mutex;
+  mysql_cond_t cond;
+  pthread_t thread;
+  ulonglong next_timeout_check;
+  bool shutdown;
+  bool started;
+} pool_timer;
+
+static bool pool_started= false;
+
+ulonglong threadpool_stall_count= 0;
+
+#ifdef HAVE_PSI_INTERFACE
+static PSI_mutex_key key_group_mutex;
+static PSI_mutex_key key_timer_mutex;
+static PSI_cond_key key_worker_cond;
+static PSI_cond_key key_group_cond;
+static PSI_cond_key key_timer_cond;
+static PSI_thread_key key_worker_thread;
+static PSI_thread_key key_timer_thread;
+
+static PSI_mutex_info all_thread_pool_mutexes[]=
+{
+  { &key_group_mutex, "thread_group_t::mutex", 0},
+  { &key_timer_mutex, "pool_timer_t::mutex", PSI_FLAG_GLOBAL}
+};
+
+static PSI_cond_info all_thread_pool_conds[]=
+{
+  { &key_worker_cond, "worker_thread_t::cond", 0},
+  { &key_group_cond, "thread_group_t::cond", 0},
+  { &key_timer_cond, "pool_timer_t::cond", PSI_FLAG_GLOBAL}
+};
+
+static PSI_thread_info all_thread_pool_threads[]=
+{
+  { &key_worker_thread, "worker_thread", 0},
+  { &key_timer_thread, "timer_thread", PSI_FLAG_GLOBAL}
+};
+
+void init_thread_pool_psi_keys()
+{
+  const char* category= "thread_pool";
+  int count;
+
+  if (PSI_server == NULL)
+    return;
+
+  count= array_elements(all_thread_pool_mutexes);
+  PSI_server->register_mutex(category, all_thread_pool_mutexes, count);
+
+  count= array_elements(all_thread_pool_conds);
+  PSI_server->register_cond(category, all_thread_pool_conds, count);
+
+  count= array_elements(all_thread_pool_threads);
+  PSI_server->register_thread(category, all_thread_pool_threads, count);
+}
+#endif /* HAVE_PSI_INTERFACE */
+
+
+/*
+  Poll descriptor helpers.
+
+  Connection sockets are registered with EPOLLONESHOT, so that a
+  connection is handed to exactly one worker and is not reported
+  again until the worker re-arms it after finishing the request.
+*/
+
+static int io_poll_create()
+{
+  return epoll_create(1);
+}
+
+
+static int io_poll_associate_fd(int pollfd, int fd, void *data)
+{
+  struct epoll_event ev;
+  ev.data.u64= 0;
+  ev.data.ptr= data;
+  ev.events= EPOLLIN | EPOLLERR | EPOLLRDHUP | EPOLLONESHOT;
+  return epoll_ctl(pollfd, EPOLL_CTL_ADD, fd, &ev);
+}
+
+
+static int io_poll_start_read(int pollfd, int fd, void *data)
+{
+  struct epoll_event ev;
+  ev.data.u64= 0;
+  ev.data.ptr= data;
+  ev.events= EPOLLIN | EPOLLERR | EPOLLRDHUP | EPOLLONESHOT;
+  return epoll_ctl(pollfd, EPOLL_CTL_MOD, fd, &ev);
+}
+
+
+static int io_poll_wait(int pollfd, struct epoll_event *events, int maxevents,
+                        int timeout_ms)
+{
+  int ret;
+  do
+  {
+    ret= epoll_wait(pollfd, events, maxevents, timeout_ms);
+  }
+  while (ret == -1 && errno == EINTR);
+  return ret;
+}
+
+
+/*
+  A group is oversubscribed when more workers are running than we
+  want to have. Workers then stop taking new requests from the queue,
+  unless the group has been found stalled by the timer.
+*/
+
+static bool too_many_threads(thread_group_t *thread_group)
+{
+  return (thread_group->active_thread_count >=
+          (int) (1 + threadpool_oversubscribe) && !thread_group->stalled);
+}
+
+
+/*
+  Minimum interval between two thread creations in a group, in usec.
+
+  Creating threads is cheap when the group has only a few of them, but
+  it usually does not help when there are already many workers that
+  are all blocked, so the interval grows with the thread count.
+*/
+
+static ulonglong microsecond_throttling_interval(thread_group_t *thread_group)
+{
+  int count= thread_group->thread_count;
+
+  if (count < 4)
+    return 0;
+  if (count < 8)
+    return 50 * 1000;
+  if (count < 16)
+    return 100 * 1000;
+  return 200 * 1000;
+}
+
+
+pthread_handler_t tp_worker_main(void *param);
+
+/*
+  Start a new worker in the group. The group mutex must be held.
+*/
+
+static int create_worker(thread_group_t *thread_group)
+{
+  pthread_t thread_id;
+  int err;
+  DBUG_ENTER("create_worker");
+
+  mysql_mutex_assert_owner(&thread_group->mutex);
+
+  if ((uint) thread_group->thread_count >=
+      max(threadpool_max_threads / group_count, 1U))
+    DBUG_RETURN(-1);
+
+  err= mysql_thread_create(key_worker_thread, &thread_id,
+                           thread_group->pthread_attr, tp_worker_main,
+                           thread_group);
+  if (!err)
+  {
+    thread_group->thread_count++;
+    thread_group->active_thread_count++;
+    thread_group->last_thread_creation_time= my_micro_time();
+    inc_thread_created();
+  }
+  else
+    my_errno= errno;
+  DBUG_RETURN(err);
+}
+
+
+/*
+  Wake up a waiting worker of the group, if there is one.
+
+  @retval 0   a worker was woken up
+  @retval -1  no worker is waiting
+*/
+
+static int wake_thread(thread_group_t *thread_group)
+{
+  worker_thread_t *thread= thread_group->waiting_threads.front();
+  if (thread)
+  {
+    thread->woken= true;
+    thread_group->waiting_threads.remove(thread);
+    mysql_cond_signal(&thread->cond);
+    return 0;
+  }
+  return -1;
+}
+
+
+/*
+  Make sure some worker will handle pending work in the group: either
+  wake up a waiting one, or create a new one if thread creation is not
+  throttled. The group mutex must be held.
+*/
+
+static int wake_or_create_thread(thread_group_t *thread_group)
+{
+  DBUG_ENTER("wake_or_create_thread");
+
+  if (thread_group->shutdown)
+    DBUG_RETURN(0);
+
+  if (wake_thread(thread_group) == 0)
+    DBUG_RETURN(0);
+
+  if (thread_group->active_thread_count == 0)
+  {
+    /*
+      Nobody is running in this group, the pending work would otherwise
+      wait until the next timer tick.
+    */
+    DBUG_RETURN(create_worker(thread_group));
+  }
+
+  if (my_micro_time() - thread_group->last_thread_creation_time <
+      microsecond_throttling_interval(thread_group))
+  {
+    /* Throttled, the timer thread will retry if the group stays stalled. */
+    DBUG_RETURN(0);
+  }
+
+  DBUG_RETURN(create_worker(thread_group));
+}
+
+
+static void queue_put(thread_group_t *thread_group, connection_t *connection)
+{
+  mysql_mutex_assert_owner(&thread_group->mutex);
+  connection->abs_wait_timeout= ULONGLONG_MAX;
+  thread_group->queue.push_back(connection);
+
+  if (thread_group->active_thread_count == 0)
+    wake_or_create_thread(thread_group);
+}
+
+
+static connection_t *queue_get(thread_group_t *thread_group)
+{
+  connection_t *connection;
+
+  mysql_mutex_assert_owner(&thread_group->mutex);
+  if ((connection= thread_group->queue.pop_front()))
+  {
+    connection->prev_in_queue= NULL;
+    thread_group->queue_event_count++;
+  }
+  return connection;
+}
+
+
+/*
+  Wait for network events on the group's poll descriptor.
+
+  If the queue was empty when events arrived, the listener keeps the
+  first connection for itself and stops being the listener: it was
+  just woken up, so it is cheaper for it to do the work than to wake
+  up another thread. Otherwise we suspect a burst of events, the
+  listener queues everything and keeps listening, and a worker is
+  woken up only if none is running.
+
+  @return connection to handle, or NULL on shutdown.
+*/
+
+static connection_t *listener(worker_thread_t *current_thread,
+                               thread_group_t *thread_group)
+{
+  connection_t *retval= NULL;
+  DBUG_ENTER("listener");
+
+  for (;;)
+  {
+    struct epoll_event ev[MAX_EVENTS];
+    bool listener_picks_event;
+    int cnt;
+
+    if (thread_group->shutdown)
+      break;
+
+    cnt= io_poll_wait(thread_group->pollfd, ev, MAX_EVENTS, -1);
+
+    if (cnt <= 0)
+      continue;
+
+    mysql_mutex_lock(&thread_group->mutex);
+
+    if (thread_group->shutdown)
+    {
+      mysql_mutex_unlock(&thread_group->mutex);
+      break;
+    }
+
+    thread_group->io_event_count+= cnt;
+    listener_picks_event= thread_group->queue.is_empty();
+
+    for (int i= 0; i < cnt; i++)
+    {
+      connection_t *connection= (connection_t *) ev[i].data.ptr;
+
+      /* Wakeup through the shutdown pipe */
+      if (!connection)
+        continue;
+
+      if (listener_picks_event && !retval)
+      {
+        retval= connection;
+        connection->abs_wait_timeout= ULONGLONG_MAX;
+      }
+      else
+        queue_put(thread_group, connection);
+    }
+
+    if (!thread_group->queue.is_empty() &&
+        thread_group->active_thread_count == 0 && !retval)
+      wake_or_create_thread(thread_group);
+
+    mysql_mutex_unlock(&thread_group->mutex);
+
+    if (retval)
+      break;
+  }
+
+  DBUG_RETURN(retval);
+}
+
+
+/*
+  Fetch the next connection to handle for a worker.
+
+  In order of preference: take a connection from the queue, become
+  the listener, or sleep until woken up. Returns NULL when the worker
+  should exit, i.e. on shutdown or after idle_timeout seconds of
+  inactivity.
+*/
+
+static connection_t *get_event(worker_thread_t *current_thread,
+                               thread_group_t *thread_group,
+                               struct timespec *abstime)
+{
+  connection_t *connection= NULL;
+  int err= 0;
+  DBUG_ENTER("get_event");
+
+  mysql_mutex_lock(&thread_group->mutex);
+
+  for (;;)
+  {
+    if (thread_group->shutdown)
+      break;
+
+    if (!too_many_threads(thread_group) &&
+        (connection= queue_get(thread_group)))
+      break;
+
+    if (!thread_group->listener)
+    {
+      thread_group->listener= current_thread;
+      thread_group->active_thread_count--;
+      mysql_mutex_unlock(&thread_group->mutex);
+
+      connection= listener(current_thread, thread_group);
+
+      mysql_mutex_lock(&thread_group->mutex);
+      thread_group->active_thread_count++;
+      thread_group->listener= NULL;
+      break;
+    }
+
+    current_thread->woken= false;
+    thread_group->active_thread_count--;
+    thread_group->waiting_threads.push_front(current_thread);
+
+    err= mysql_cond_timedwait(&current_thread->cond, &thread_group->mutex,
+                              abstime);
+
+    thread_group->active_thread_count++;
+    if (!current_thread->woken)
+    {
+      /* Timeout or spurious wakeup, we are still in the waiting list. */
+      thread_group->waiting_threads.remove(current_thread);
+      if (err == ETIMEDOUT || err == ETIME)
+        break;
+    }
+  }
+
+  if (thread_group->queue.is_empty())
+    thread_group->stalled= false;
+  mysql_mutex_unlock(&thread_group->mutex);
+  DBUG_RETURN(connection);
+}
+
+
+/*
+  Make the connection current for this worker: attach THD to the
+  thread and switch the instrumentation to the connection.
+*/
+
+static bool attach_connection(connection_t *connection)
+{
+  THD *thd= connection->thd;
+
+  thd_set_thread_stack(thd, (char*) &thd);
+  if (thd_store_globals(thd))
+    return TRUE;
+  thd_clear_errors(thd);
+#ifdef HAVE_PSI_INTERFACE
+  if (PSI_server)
+    PSI_server->set_thread(thd_get_psi(thd));
+#endif
+  return FALSE;
+}
+
+
+/*
+  Detach the connection from this worker after a request. The THD
+  must not keep a reference to the worker's mysys variables, since a
+  KILL may use them while another connection runs on this worker, or
+  after the worker exits.
+*/
+
+static void detach_connection(worker_thread_t *current_thread,
+                              connection_t *connection)
+{
+  thd_set_mysys_var(connection->thd, NULL);
+#ifdef HAVE_PSI_INTERFACE
+  if (PSI_server)
+    PSI_server->set_thread(current_thread->psi);
+#endif
+}
+
+
+/*
+  Close the connection and destroy its THD.
+
+  The scheduler data is reset under LOCK_thread_count and
+  LOCK_thd_data before the socket is closed, so that
+  tp_post_kill_notification() and the timeout check, which run
+  with one of these locks held, never use a closed descriptor.
+*/
+
+static void connection_abort(worker_thread_t *current_thread,
+                             connection_t *connection)
+{
+  THD *thd= connection->thd;
+  thread_group_t *thread_group= connection->thread_group;
+  DBUG_ENTER("connection_abort");
+
+  (void) attach_connection(connection);
+
+  thd_lock_thread_count(thd);
+  thd_lock_data(thd);
+  thd_set_scheduler_data(thd, NULL);
+  thd_unlock_data(thd);
+  thd_unlock_thread_count(thd);
+
+  thd_set_killed(thd);
+  thd_set_net_read_write(thd, 0);
+  if (connection->logged_in)
+    end_connection(thd);
+  close_connection(thd, 0);
+
+  thd_cleanup(thd);
+  dec_connection_count();
+  thd_lock_thread_remove(thd);
+  thd_lock_thread_count(thd);
+  delete_thd(thd);
+  thd_unlock_thread_count(NULL);
+  thd_unlock_thread_remove(NULL);
+
+#ifdef HAVE_PSI_INTERFACE
+  if (PSI_server)
+  {
+    PSI_thread *psi= PSI_server->get_thread();
+    PSI_server->set_thread(current_thread->psi);
+    if (psi)
+      PSI_server->delete_thread(psi);
+  }
+#endif
+
+  mysql_mutex_lock(&thread_group->mutex);
+  thread_group->connection_count--;
+  mysql_mutex_unlock(&thread_group->mutex);
+
+  my_free(connection);
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Authenticate a new connection. Runs in a worker, so that a slow
+  client cannot block the thread that accepts connections.
+*/
+
+static int threadpool_add_connection(connection_t *connection)
+{
+  THD *thd= connection->thd;
+
+  if (attach_connection(connection))
+    return 1;
+
+  if (thd_prepare_connection(thd) || !thd_is_connection_alive(thd))
+    return 1;
+
+  /*
+    From now on a KILL must only shut the socket down: closing it
+    would remove it from the poll descriptor without an event.
+  */
+  thd_clear_active_vio(thd);
+  connection->logged_in= true;
+  return 0;
+}
+
+
+/*
+  Execute the commands available on the connection. Buffered data
+  (e.g. decrypted SSL records or pipelined commands) is not seen by
+  the poll descriptor, so keep reading while the Vio has some.
+*/
+
+static int threadpool_process_request(connection_t *connection)
+{
+  THD *thd= connection->thd;
+
+  if (attach_connection(connection))
+    return 1;
+
+  for (;;)
+  {
+    if (!thd_is_connection_alive(thd))
+      return 1;
+
+    mysql_audit_release(thd);
+    if (do_command(thd))
+      return 1;
+
+    if (!thd_is_connection_alive(thd))
+      return 1;
+
+    if (!thd_connection_has_data(thd))
+      break;
+  }
+  return 0;
+}
+
+
+static void set_wait_timeout(connection_t *connection)
+{
+  connection->abs_wait_timeout= my_micro_time() +
+    1000000ULL * thd_get_net_wait_timeout(connection->thd);
+}
+
+
+/*
+  Process one event of a connection and put it back into the poll
+  descriptor, or close it on error.
+*/
+
+static void handle_event(worker_thread_t *current_thread,
+                         connection_t *connection)
+{
+  int err;
+  DBUG_ENTER("handle_event");
+
+  if (!connection->logged_in)
+    err= threadpool_add_connection(connection);
+  else
+    err= threadpool_process_request(connection);
+
+  if (err)
+    goto end;
+
+  set_wait_timeout(connection);
+  detach_connection(current_thread, connection);
+
+  /*
+    After the socket is re-armed, another worker may pick the
+    connection up immediately: nothing may be done with it here
+    afterwards.
+  */
+  if (!connection->bound_to_poll_descriptor)
+  {
+    connection->bound_to_poll_descriptor= true;
+    err= io_poll_associate_fd(connection->thread_group->pollfd,
+                              connection->fd, connection);
+  }
+  else
+    err= io_poll_start_read(connection->thread_group->pollfd,
+                            connection->fd, connection);
+
+end:
+  if (err)
+    connection_abort(current_thread, connection);
+  DBUG_VOID_RETURN;
+}
+
+
+pthread_handler_t tp_worker_main(void *param)
+{
+  worker_thread_t this_thread;
+  thread_group_t *thread_group= (thread_group_t*) param;
+
+  my_thread_init();
+
+  this_thread.thread_group= thread_group;
+  this_thread.woken= false;
+  this_thread.next_in_list= NULL;
+  this_thread.prev_in_list= NULL;
+  mysql_cond_init(key_worker_cond, &this_thread.cond, NULL);
+#ifdef HAVE_PSI_INTERFACE
+  this_thread.psi= PSI_server ? PSI_server->get_thread() : NULL;
+#endif
+
+  for (;;)
+  {
+    connection_t *connection;
+    struct timespec ts;
+
+    set_timespec(ts, threadpool_idle_timeout);
+    if (!(connection= get_event(&this_thread, thread_group, &ts)))
+      break;
+    handle_event(&this_thread, connection);
+  }
+
+  mysql_mutex_lock(&thread_group->mutex);
+  thread_group->thread_count--;
+  thread_group->active_thread_count--;
+  if (thread_group->shutdown && thread_group->thread_count == 0)
+    mysql_cond_signal(&thread_group->cond);
+  mysql_mutex_unlock(&thread_group->mutex);
+
+  mysql_cond_destroy(&this_thread.cond);
+  my_thread_end();
+  pthread_exit(0);
+  return 0;
+}
+
+
+/*
+  Called by the timer every thread_pool_stall_limit milliseconds.
+
+  A group is stalled when requests are queued but none has been taken
+  from the queue since the previous check: all workers are busy with
+  long requests. Another worker is then allowed to run, even if that
+  oversubscribes the group.
+*/
+
+static void check_stall(thread_group_t *thread_group)
+{
+  mysql_mutex_lock(&thread_group->mutex);
+
+  /*
+    Nobody listens and no network event was seen: make sure some
+    worker becomes the listener, otherwise new requests would only
+    be noticed when a running worker finishes.
+  */
+  if (!thread_group->listener && !thread_group->io_event_count)
+    wake_or_create_thread(thread_group);
+  thread_group->io_event_count= 0;
+
+  if (!thread_group->queue.is_empty() && !thread_group->queue_event_count)
+  {
+    thread_group->stalled= true;
+    threadpool_stall_count++;
+    wake_or_create_thread(thread_group);
+  }
+  thread_group->queue_event_count= 0;
+
+  mysql_mutex_unlock(&thread_group->mutex);
+}
+
+
+/*
+  Kill connections idle for longer than their wait_timeout. Closing
+  the socket makes the connection readable, so a worker picks it up
+  and takes it down.
+*/
+
+static void timeout_check(ulonglong now)
+{
+  THD *thd;
+  DBUG_ENTER("timeout_check");
+
+  thd_lock_thread_count(NULL);
+  for (thd= first_global_thread(); thd; thd= next_global_thread(thd))
+  {
+    connection_t *connection= (connection_t *) thd_get_scheduler_data(thd);
+    if (connection && connection->abs_wait_timeout < now)
+    {
+      thd_set_killed(thd);
+      shutdown(connection->fd, SHUT_RDWR);
+    }
+  }
+  thd_unlock_thread_count(NULL);
+  DBUG_VOID_RETURN;
+}
+
+
+pthread_handler_t tp_timer_thread(void *param)
+{
+  my_thread_init();
+
+  mysql_mutex_lock(&pool_timer.mutex);
+  while (!pool_timer.shutdown)
+  {
+    struct timespec ts;
+    int err;
+
+    set_timespec_nsec(ts, threadpool_stall_limit * 1000000ULL);
+    err= mysql_cond_timedwait(&pool_timer.cond, &pool_timer.mutex, &ts);
+    if (pool_timer.shutdown)
+      break;
+    if (err == ETIMEDOUT || err == ETIME)
+    {
+      ulonglong now= my_micro_time();
+
+      for (uint i= 0; i < group_count; i++)
+        check_stall(&all_groups[i]);
+
+      if (now >= pool_timer.next_timeout_check)
+      {
+        timeout_check(now);
+        pool_timer.next_timeout_check= now + 1000000ULL;
+      }
+    }
+  }
+  mysql_mutex_unlock(&pool_timer.mutex);
+
+  my_thread_end();
+  pthread_exit(0);
+  return 0;
+}
+
+
+static bool thread_group_init(thread_group_t *thread_group,
+                              pthread_attr_t *thread_attr)
+{
+  DBUG_ENTER("thread_group_init");
+
+  thread_group->pthread_attr= thread_attr;
+  mysql_mutex_init(key_group_mutex, &thread_group->mutex, NULL);
+  mysql_cond_init(key_group_cond, &thread_group->cond, NULL);
+  thread_group->queue.empty();
+  thread_group->waiting_threads.empty();
+  thread_group->listener= NULL;
+  thread_group->thread_count= 0;
+  thread_group->active_thread_count= 0;
+  thread_group->connection_count= 0;
+  thread_group->io_event_count= 0;
+  thread_group->queue_event_count= 0;
+  thread_group->last_thread_creation_time= 0;
+  thread_group->shutdown= false;
+  thread_group->stalled= false;
+  thread_group->shutdown_pipe[0]= thread_group->shutdown_pipe[1]= -1;
+
+  if ((thread_group->pollfd= io_poll_create()) < 0)
+    DBUG_RETURN(TRUE);
+
+  if (pipe(thread_group->shutdown_pipe) ||
+      io_poll_associate_fd(thread_group->pollfd,
+                           thread_group->shutdown_pipe[0], NULL))
+    DBUG_RETURN(TRUE);
+
+  DBUG_RETURN(FALSE);
+}
+
+
+/*
+  Stop all workers of the group and wait until they have exited.
+*/
+
+static void thread_group_close(thread_group_t *thread_group)
+{
+  DBUG_ENTER("thread_group_close");
+
+  mysql_mutex_lock(&thread_group->mutex);
+  thread_group->shutdown= true;
+  thread_group->listener= NULL;
+
+  /* Wake up the listener */
+  if (thread_group->shutdown_pipe[1] >= 0)
+  {
+    char c= 0;
+    if (write(thread_group->shutdown_pipe[1], &c, 1) < 0)
+      sql_print_error("Thread pool: could not wake up listener: %d", errno);
+  }
+
+  while (wake_thread(thread_group) == 0)
+  {}
+
+  while (thread_group->thread_count > 0)
+    mysql_cond_wait(&thread_group->cond, &thread_group->mutex);
+  mysql_mutex_unlock(&thread_group->mutex);
+
+  if (thread_group->pollfd >= 0)
+    close(thread_group->pollfd);
+  if (thread_group->shutdown_pipe[0] >= 0)
+    close(thread_group->shutdown_pipe[0]);
+  if (thread_group->shutdown_pipe[1] >= 0)
+    close(thread_group->shutdown_pipe[1]);
+
+  mysql_cond_destroy(&thread_group->cond);
+  mysql_mutex_destroy(&thread_group->mutex);
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Initialize the thread groups and start the timer thread.
+
+  Called through scheduler_functions::init from network_init().
+*/
+
+bool tp_init()
+{
+  pthread_attr_t timer_attr;
+  int error;
+  DBUG_ENTER("tp_init");
+
+  group_count= min(max(threadpool_size, 1U), (uint) MAX_THREAD_GROUPS);
+  for (uint i= 0; i < group_count; i++)
+  {
+    if (thread_group_init(&all_groups[i], get_connection_attrib()))
+    {
+      sql_print_error("Thread pool: cannot create poll descriptor: %d",
+                      errno);
+      for (uint j= 0; j <= i; j++)
+        thread_group_close(&all_groups[j]);
+      DBUG_RETURN(TRUE);
+    }
+  }
+
+  mysql_mutex_init(key_timer_mutex, &pool_timer.mutex, NULL);
+  mysql_cond_init(key_timer_cond, &pool_timer.cond, NULL);
+  pool_timer.shutdown= false;
+  pool_timer.next_timeout_check= 0;
+  pool_timer.started= false;
+  pool_started= true;
+
+  /*
+    Unlike the workers, the timer is joined in tp_end(): it must be gone
+    before its mutex is destroyed and the plugin is unloaded.
+  */
+  (void) pthread_attr_init(&timer_attr);
+  (void) pthread_attr_setdetachstate(&timer_attr, PTHREAD_CREATE_JOINABLE);
+  (void) pthread_attr_setstacksize(&timer_attr, my_thread_stack_size);
+  error= mysql_thread_create(key_timer_thread, &pool_timer.thread,
+                             &timer_attr, tp_timer_thread, NULL);
+  (void) pthread_attr_destroy(&timer_attr);
+  if (error)
+  {
+    sql_print_error("Thread pool: cannot create timer thread: %d", errno);
+    tp_end();
+    DBUG_RETURN(TRUE);
+  }
+  pool_timer.started= true;
+
+  DBUG_RETURN(FALSE);
+}
+
+
+/**
+  Stop the timer and all workers. Called on server shutdown, when all
+  connections are gone, and from the plugin deinit function.
+*/
+
+void tp_end()
+{
+  DBUG_ENTER("tp_end");
+
+  if (!pool_started)
+    DBUG_VOID_RETURN;
+
+  if (pool_timer.started)
+  {
+    mysql_mutex_lock(&pool_timer.mutex);
+    pool_timer.shutdown= true;
+    mysql_cond_signal(&pool_timer.cond);
+    mysql_mutex_unlock(&pool_timer.mutex);
+    pthread_join(pool_timer.thread, NULL);
+    pool_timer.started= false;
+  }
+
+  for (uint i= 0; i < group_count; i++)
+    thread_group_close(&all_groups[i]);
+
+  mysql_cond_destroy(&pool_timer.cond);
+  mysql_mutex_destroy(&pool_timer.mutex);
+  pool_started= false;
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Called by the acceptor thread with LOCK_thread_count held, for a
+  new connection. Login is done later by a worker.
+*/
+
+void tp_add_connection(THD *thd)
+{
+  connection_t *connection;
+  thread_group_t *thread_group;
+  DBUG_ENTER("tp_add_connection");
+
+  if (!(connection= (connection_t *) my_malloc(sizeof(connection_t),
+                                               MYF(MY_WME | MY_ZEROFILL))))
+  {
+    thd_unlock_thread_count(thd);
+    close_connection(thd, ER_OUT_OF_RESOURCES);
+    dec_connection_count();
+    thd_lock_thread_remove(thd);
+    thd_lock_thread_count(thd);
+    delete_thd(thd);
+    thd_unlock_thread_count(NULL);
+    thd_unlock_thread_remove(NULL);
+    DBUG_VOID_RETURN;
+  }
+
+  thread_group= &all_groups[thd_get_thread_id(thd) % group_count];
+  connection->thd= thd;
+  connection->thread_group= thread_group;
+  connection->fd= thd_get_fd(thd);
+  thd_set_scheduler_data(thd, connection);
+
+  /* Adds THD to the global list and releases LOCK_thread_count */
+  thd_new_connection_setup(thd, (char*) &thd);
+
+  mysql_mutex_lock(&thread_group->mutex);
+  thread_group->connection_count++;
+  queue_put(thread_group, connection);
+  mysql_mutex_unlock(&thread_group->mutex);
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  The connection is about to block inside the server. If this leaves
+  the group without a running worker, let another one handle the
+  pending work.
+*/
+
+void tp_wait_begin(THD *thd, int wait_type)
+{
+  connection_t *connection;
+  thread_group_t *thread_group;
+
+  if (!thd || !(connection= (connection_t *) thd_get_scheduler_data(thd)))
+    return;
+  if (connection->waiting)
+    return;
+
+  connection->waiting= true;
+  thread_group= connection->thread_group;
+  mysql_mutex_lock(&thread_group->mutex);
+  thread_group->active_thread_count--;
+  if (thread_group->active_thread_count == 0 &&
+      (!thread_group->queue.is_empty() || !thread_group->listener))
+    wake_or_create_thread(thread_group);
+  mysql_mutex_unlock(&thread_group->mutex);
+}
+
+
+void tp_wait_end(THD *thd)
+{
+  connection_t *connection;
+  thread_group_t *thread_group;
+
+  if (!thd || !(connection= (connection_t *) thd_get_scheduler_data(thd)))
+    return;
+  if (!connection->waiting)
+    return;
+
+  connection->waiting= false;
+  thread_group= connection->thread_group;
+  mysql_mutex_lock(&thread_group->mutex);
+  thread_group->active_thread_count++;
+  mysql_mutex_unlock(&thread_group->mutex);
+}
+
+
+/**
+  Called with LOCK_thd_data or LOCK_thread_count held when the
+  connection is killed. Shutting the socket down wakes up the
+  listener if the connection is idle.
+*/
+
+void tp_post_kill_notification(THD *thd)
+{
+  connection_t *connection= (connection_t *) thd_get_scheduler_data(thd);
+  if (connection)
+    shutdown(connection->fd, SHUT_RDWR);
+}
+
+
+/**
+  Only called by the server on error paths of thread-per-connection
+  handling, connections of the pool are ended in connection_abort().
+*/
+
+bool tp_end_thread(THD *thd, bool cache_thread)
+{
+  return 1;
+}
+
+
+int tp_get_thread_count()
+{
+  int count= 0;
+  for (uint i= 0; pool_started && i < group_count; i++)
+    count+= all_groups[i].thread_count;
+  return count;
+}
+
+
+int tp_get_idle_thread_count()
+{
+  int count= 0;
+  for (uint i= 0; pool_started && i < group_count; i++)
+  {
+    thread_group_t *thread_group= &all_groups[i];
+    count+= thread_group->thread_count - thread_group->active_thread_count;
+  }
+  return count;
+}
@@ -0,0 +1,150 @@
+/* Copyright (c) 2014, Tokutek Inc. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA */
+
+#ifndef THREAD_POOL_INCLUDED
+#define THREAD_POOL_INCLUDED
+
+#include <my_global.h>
+#include <mysql/plugin.h>
+#include <mysql/psi/psi.h>
+#include <mysql/thread_pool_priv.h>
+#include <sql_plist.h>
+
+/*
+  Pooled thread scheduler.
+
+  Connections are distributed over a small number of thread groups.
+  Each group owns an epoll descriptor on which its idle connections
+  are registered (one-shot), a queue of connections that have a
+  request ready to be processed and a set of worker threads.
+
+  At any time at most one worker of a group is the "listener": it
+  waits on the poll descriptor and moves ready connections into the
+  group's queue (or handles one of them itself). The other workers
+  take connections from the queue, execute one request and put the
+  connection back into the poll descriptor.
+
+  The scheduler tries to keep exactly one active (i.e. not waiting)
+  worker per group. When a worker blocks inside the server (row lock,
+  MDL, sleep, ...) thd_wait_begin() lets another worker of the group
+  run. A timer thread detects groups that made no progress during
+  thread_pool_stall_limit milliseconds and wakes up or creates an
+  additional worker, and it also enforces wait_timeout for idle
+  connections, since no thread is blocked reading from them.
+*/
+
+#define MAX_THREAD_GROUPS 128
+
+struct thread_group_t;
+
+/* Per-connection state, stored as scheduler data in the THD. */
+struct connection_t
+{
+  THD *thd;
+  thread_group_t *thread_group;
+  my_socket fd;
+  connection_t *next_in_queue;
+  connection_t **prev_in_queue;
+  /* When the connection is killed for exceeding wait_timeout, in usec. */
+  ulonglong abs_wait_timeout;
+  /* Login completed, the connection is executing commands. */
+  bool logged_in;
+  /* The socket has been added to the group's poll descriptor. */
+  bool bound_to_poll_descriptor;
+  /* Inside thd_wait_begin()/thd_wait_end(). */
+  bool waiting;
+};
+
+typedef I_P_List<connection_t,
+                 I_P_List_adapter<connection_t,
+                                  &connection_t::next_in_queue,
+                                  &connection_t::prev_in_queue>,
+                 I_P_List_null_counter,
+                 I_P_List_fast_push_back<connection_t> >
+connection_queue_t;
+
+/* State of a worker thread, lives on the worker's stack. */
+struct worker_thread_t
+{
+  thread_group_t *thread_group;
+  worker_thread_t *next_in_list;
+  worker_thread_t **prev_in_list;
+  mysql_cond_t cond;
+  /* Set by the thread that signals cond, to tell timeouts from wakeups. */
+  bool woken;
+#ifdef HAVE_PSI_INTERFACE
+  /* Instrumentation of the worker itself, restored between requests. */
+  PSI_thread *psi;
+#endif
+};
+
+typedef I_P_List<worker_thread_t,
+                 I_P_List_adapter<worker_thread_t,
+                                  &worker_thread_t::next_in_list,
+                                  &worker_thread_t::prev_in_list> >
+worker_list_t;
+
+struct thread_group_t
+{
+  mysql_mutex_t mutex;
+  /* Signalled when the last worker of a group being shut down exits. */
+  mysql_cond_t cond;
+  connection_queue_t queue;
+  worker_list_t waiting_threads;
+  worker_thread_t *listener;
+  pthread_attr_t *pthread_attr;
+  int pollfd;
+  /* Pipe registered in pollfd, written to wake up the listener. */
+  int shutdown_pipe[2];
+  /* Number of workers, including the listener and waiting workers. */
+  int thread_count;
+  /* Number of workers currently executing a request. */
+  int active_thread_count;
+  int connection_count;
+  /* Events seen since the last timer tick, used for stall detection. */
+  int io_event_count;
+  int queue_event_count;
+  ulonglong last_thread_creation_time;
+  bool shutdown;
+  bool stalled;
+};
+
+/* System variables, see thread_pool_plugin.cc */
+extern uint threadpool_size;
+extern uint threadpool_stall_limit;
+extern uint threadpool_max_threads;
+extern uint threadpool_idle_timeout;
+extern uint threadpool_oversubscribe;
+
+/* Status counters */
+extern ulonglong threadpool_stall_count;
+
+#ifdef HAVE_PSI_INTERFACE
+void init_thread_pool_psi_keys();
+#endif
+
+/* Scheduler callbacks, installed through my_thread_scheduler_set() */
+bool tp_init();
+void tp_end();
+void tp_add_connection(THD *thd);
+void tp_wait_begin(THD *thd, int wait_type);
+void tp_wait_end(THD *thd);
+void tp_post_kill_notification(THD *thd);
+bool tp_end_thread(THD *thd, bool cache_thread);
+
+int tp_get_thread_count();
+int tp_get_idle_thread_count();
+
+#endif /* THREAD_POOL_INCLUDED */
@@ -0,0 +1,170 @@
+/* Copyright (c) 2014, Tokutek Inc. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA */
+
+#include "thread_pool.h"
+#include "mysqld.h"                             // mysqld_server_started
+
+uint threadpool_size;
+uint threadpool_stall_limit;
+uint threadpool_max_threads;
+uint threadpool_idle_timeout;
+uint threadpool_oversubscribe;
+
+static MYSQL_SYSVAR_UINT(size, threadpool_size,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of thread groups. Connections are distributed over the groups, "
+  "each of which tries to keep one worker thread running. "
+  "0 means the number of processors.",
+  NULL,                                 // check
+  NULL,                                 // update
+  0, 0, MAX_THREAD_GROUPS, 0);
+
+static MYSQL_SYSVAR_UINT(stall_limit, threadpool_stall_limit,
+  PLUGIN_VAR_RQCMDARG,
+  "Time in milliseconds after which a thread group that did not start "
+  "a queued request is considered stalled, and another worker thread "
+  "is allowed to run in it.",
+  NULL,                                 // check
+  NULL,                                 // update
+  500, 10, UINT_MAX, 0);
+
+static MYSQL_SYSVAR_UINT(max_threads, threadpool_max_threads,
+  PLUGIN_VAR_RQCMDARG,
+  "Maximum total number of worker threads in the pool.",
+  NULL,                                 // check
+  NULL,                                 // update
+  500, 1, 65536, 0);
+
+static MYSQL_SYSVAR_UINT(idle_timeout, threadpool_idle_timeout,
+  PLUGIN_VAR_RQCMDARG,
+  "Time in seconds after which an idle worker thread exits.",
+  NULL,                                 // check
+  NULL,                                 // update
+  60, 1, UINT_MAX, 0);
+
+static MYSQL_SYSVAR_UINT(oversubscribe, threadpool_oversubscribe,
+  PLUGIN_VAR_RQCMDARG,
+  "How many additional worker threads may run in a thread group before "
+  "new requests are left in the queue.",
+  NULL,                                 // check
+  NULL,                                 // update
+  3, 1, 1000, 0);
+
+static struct st_mysql_sys_var* thread_pool_system_vars[]= {
+  MYSQL_SYSVAR(size),
+  MYSQL_SYSVAR(stall_limit),
+  MYSQL_SYSVAR(max_threads),
+  MYSQL_SYSVAR(idle_timeout),
+  MYSQL_SYSVAR(oversubscribe),
+  NULL,
+};
+
+static int thread_pool_threads;
+static int thread_pool_idle_threads;
+
+static int show_threads(MYSQL_THD thd, SHOW_VAR *var, char *buff)
+{
+  thread_pool_threads= tp_get_thread_count();
+  var->type= SHOW_INT;
+  var->value= (char *) &thread_pool_threads;
+  return 0;
+}
+
+static int show_idle_threads(MYSQL_THD thd, SHOW_VAR *var, char *buff)
+{
+  thread_pool_idle_threads= tp_get_idle_thread_count();
+  var->type= SHOW_INT;
+  var->value= (char *) &thread_pool_idle_threads;
+  return 0;
+}
+
+static SHOW_VAR thread_pool_status_vars[]= {
+  {"Thread_pool_threads",
+   (char*) &show_threads,
+   SHOW_FUNC},
+  {"Thread_pool_idle_threads",
+   (char*) &show_idle_threads,
+   SHOW_FUNC},
+  {"Thread_pool_stalls",
+   (char*) &threadpool_stall_count,
+   SHOW_LONGLONG},
+  {NULL, NULL, SHOW_LONG},
+};
+
+static scheduler_functions tp_scheduler_functions=
+{
+  0,                                     // max_threads
+  tp_init,                               // init
+  NULL,                                  // init_new_connection_thread
+  tp_add_connection,                     // add_connection
+  tp_wait_begin,                         // thd_wait_begin
+  tp_wait_end,                           // thd_wait_end
+  tp_post_kill_notification,             // post_kill_notification
+  tp_end_thread,                         // end_thread
+  tp_end,                                // end
+};
+
+static int thread_pool_plugin_init(void *p)
+{
+#ifdef HAVE_PSI_INTERFACE
+  init_thread_pool_psi_keys();
+#endif
+
+  /*
+    Connections handled by the previous scheduler would call our
+    end_thread(), so the scheduler can only be replaced at startup.
+  */
+  if (mysqld_server_started)
+  {
+    sql_print_error("Thread pool: the plugin can only be loaded at server "
+                    "startup, use --plugin-load");
+    return 1;
+  }
+
+  if (!threadpool_size)
+    threadpool_size= (uint) sysconf(_SC_NPROCESSORS_ONLN);
+  tp_scheduler_functions.max_threads= threadpool_max_threads;
+  return my_thread_scheduler_set(&tp_scheduler_functions);
+}
+
+static int thread_pool_plugin_deinit(void *p)
+{
+  tp_end();
+  return my_thread_scheduler_reset();
+}
+
+struct st_mysql_daemon thread_pool_plugin=
+{ MYSQL_DAEMON_INTERFACE_VERSION  };
+
+/*
+  Plugin library descriptor
+*/
+mysql_declare_plugin(thread_pool)
+{
+  MYSQL_DAEMON_PLUGIN,
+  &thread_pool_plugin,
+  "thread_pool",
+  "Tokutek",
+  "Pooled thread scheduler, multiplexes connections over thread groups",
+  PLUGIN_LICENSE_GPL,
+  thread_pool_plugin_init,      /* Plugin Init */
+  thread_pool_plugin_deinit,    /* Plugin Deinit */
+  0x0100 /* 1.0 */,
+  thread_pool_status_vars,      /* status variables */
+  thread_pool_system_vars,      /* system variables */
+  NULL,                         /* config options */
+  0,                            /* flags */
+}
+mysql_declare_plugin_end;
@@ -35,6 +35,7 @@
 #include "opt_range.h"                          // SQL_SELECT
 #include "debug_sync.h"
 #include "sql_base.h"
+#include "queues.h"                             // QUEUE
 
 /// How to write record_ref.
 #define WRITE_REF(file,from) \
@@ -50,7 +51,7 @@ static uchar *read_buffpek_from_file(IO_CACHE *buffer_file, uint count,
                                      uchar *buf);
 static ha_rows find_all_keys(SORTPARAM *param,SQL_SELECT *select,
 			     uchar * *sort_keys, IO_CACHE *buffer_file,
-			     IO_CACHE *tempfile);
+			     IO_CACHE *tempfile, QUEUE *pq);
 static int write_keys(SORTPARAM *param,uchar * *sort_keys,
 		      uint count, IO_CACHE *buffer_file, IO_CACHE *tempfile);
 static void make_sortkey(SORTPARAM *param,uchar *to, uchar *ref_pos);
@@ -68,6 +69,9 @@ static SORT_ADDON_FIELD *get_addon_fields(THD *thd, Field **ptabfield,
                                           uint sortlength, uint *plength);
 static void unpack_addon_fields(struct st_sort_addon_field *addon_field,
                                 uchar *buff);
+static bool check_if_pq_applicable(SORTPARAM *param, ha_rows num_rows,
+                                   ulong memory_available);
+static int pq_key_cmp(void *cmp_arg, uchar *a, uchar *b);
 /**
   Sort a table.
   Creates a set of pointers that can be used to read the rows
@@ -85,7 +89,10 @@ static void unpack_addon_fields(struct st_sort_addon_field *addon_field,
   @param sortorder	How to sort the table
   @param s_length	Number of elements in sortorder
   @param select		condition to apply to the rows
-  @param max_rows	Return only this many rows
+  @param max_rows	Return only this many rows. If they fit in the
+                        sort buffer, only the first max_rows keys are
+                        kept, in a priority queue, and nothing is
+                        written to disk.
   @param sort_positions	Set to 1 if we want to force sorting by position
 			(Needed by UPDATE/INSERT or ALTER TABLE)
   @param examined_rows	Store number of examined rows here
@@ -114,6 +121,7 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
   uchar **sort_keys= 0;
   IO_CACHE tempfile, buffpek_pointers, *outfile; 
   SORTPARAM param;
+  QUEUE pq;
   bool multi_byte_charset;
   DBUG_ENTER("filesort");
   DBUG_EXECUTE("info",TEST_filesort(sortorder,s_length););
@@ -148,6 +156,7 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
   buffpek=0;
   error= 1;
   bzero((char*) &param,sizeof(param));
+  bzero((char*) &pq, sizeof(pq));
   param.sort_length= sortlength(thd, sortorder, s_length, &multi_byte_charset);
   param.ref_length= table->file->ref_length;
   param.addon_field= 0;
@@ -199,6 +208,38 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
       !(param.tmp_buffer= (char*) my_malloc(param.sort_length,MYF(MY_WME))))
     goto err;
 
+  if (check_if_pq_applicable(&param, num_rows, memory_available))
+  {
+    /*
+      Keep the first max_rows keys in a priority queue with the greatest
+      key on top, plus one slot for the key of the row being examined.
+    */
+    param.keys= (uint) param.max_rows + 1;
+    if (table_sort.sort_keys &&
+        table_sort.sort_keys_size != char_array_size(param.keys,
+                                                     param.rec_length))
+    {
+      my_free(table_sort.sort_keys);
+      table_sort.sort_keys= NULL;
+      table_sort.sort_keys_size= 0;
+    }
+    if ((table_sort.sort_keys=
+         make_char_array(table_sort.sort_keys,
+                         param.keys, param.rec_length, MYF(0))))
+    {
+      table_sort.sort_keys_size=
+        char_array_size(param.keys, param.rec_length);
+      if (init_queue(&pq, (uint) param.max_rows, 0, TRUE, pq_key_cmp,
+                     &param.sort_length))
+        goto err;
+      DBUG_PRINT("info", ("using priority queue for %lu rows",
+                          (ulong) param.max_rows));
+    }
+    /* Otherwise fall back to the merge sort below */
+  }
+  sort_keys= table_sort.sort_keys;
+
+  if (!is_queue_inited(&pq))
   {
     const ulong min_sort_memory=
       max(MIN_SORT_MEMORY,
@@ -246,7 +287,8 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
                           select,
                           sort_keys,
                           &buffpek_pointers,
-                          &tempfile);
+                          &tempfile,
+                          is_queue_inited(&pq) ? &pq : NULL);
   if (num_rows == HA_POS_ERROR)
     goto err;
   maxbuffer= (uint) (my_b_tell(&buffpek_pointers)/sizeof(*buffpek));
@@ -311,6 +353,7 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
 
  err:
   my_free(param.tmp_buffer);
+  delete_queue(&pq);
   if (!subselect || !subselect->is_uncacheable())
   {
     my_free(sort_keys);
@@ -524,6 +567,10 @@ static void dbug_print_record(TABLE *table, bool print_rowid)
   @param buffpek_pointers  File to write BUFFPEKs describing sorted segments
                            in tempfile.
   @param tempfile          File to write sorted sequences of sortkeys to.
+  @param pq                If not NULL, keep only the smallest keys in this
+                           priority queue instead of writing sorted
+                           sequences to tempfile. sort_keys must have room
+                           for one key more than the queue holds.
 
   @note
     Basic idea:
@@ -553,7 +600,7 @@ static void dbug_print_record(TABLE *table, bool print_rowid)
 static ha_rows find_all_keys(SORTPARAM *param, SQL_SELECT *select,
 			     uchar **sort_keys,
 			     IO_CACHE *buffpek_pointers,
-			     IO_CACHE *tempfile)
+			     IO_CACHE *tempfile, QUEUE *pq)
 {
   int error,flag,quick_select;
   uint idx,indexpos,ref_length;
@@ -565,6 +612,8 @@ static ha_rows find_all_keys(SORTPARAM *param, SQL_SELECT *select,
   handler *file;
   MY_BITMAP *save_read_set, *save_write_set;
   bool skip_record;
+  /* Key buffer not in the priority queue, see below */
+  uchar *pq_spare= pq ? sort_keys[param->keys - 1] : NULL;
   DBUG_ENTER("find_all_keys");
   DBUG_PRINT("info",("using: %s",
                      (select ? select->quick ? "ranges" : "where":
@@ -656,15 +705,38 @@ static ha_rows find_all_keys(SORTPARAM *param, SQL_SELECT *select,
     if (!error && (!select ||
                    (!select->skip_record(thd, &skip_record) && !skip_record)))
     {
-      if (idx == param->keys)
+      if (pq)
+      {
+        if (!queue_is_full(pq))
+        {
+          make_sortkey(param, sort_keys[idx], ref_pos);
+          queue_insert(pq, sort_keys[idx++]);
+        }
+        else
+        {
+          /* Replace the greatest key in the queue if the new one is less */
+          make_sortkey(param, pq_spare, ref_pos);
+          if (pq_key_cmp(&param->sort_length, pq_spare, queue_top(pq)) < 0)
+          {
+            uchar *top= queue_top(pq);
+            queue_top(pq)= pq_spare;
+            queue_replaced(pq);
+            pq_spare= top;
+          }
+        }
+      }
+      else
       {
-	if (write_keys(param, sort_keys,
-                       idx, buffpek_pointers, tempfile))
-	  DBUG_RETURN(HA_POS_ERROR);
-	idx= 0;
-	indexpos++;
+        if (idx == param->keys)
+        {
+          if (write_keys(param, sort_keys,
+                         idx, buffpek_pointers, tempfile))
+            DBUG_RETURN(HA_POS_ERROR);
+          idx= 0;
+          indexpos++;
+        }
+        make_sortkey(param,sort_keys[idx++],ref_pos);
       }
-      make_sortkey(param,sort_keys[idx++],ref_pos);
     }
 
     /*
@@ -696,9 +768,15 @@ static ha_rows find_all_keys(SORTPARAM *param, SQL_SELECT *select,
     file->print_error(error,MYF(ME_ERROR | ME_WAITTANG | ME_FATALERROR)); // purecov: inspected
     DBUG_RETURN(HA_POS_ERROR);			/* purecov: inspected */
   }
-  if (indexpos && idx &&
-      write_keys(param, sort_keys,
-                 idx, buffpek_pointers, tempfile))
+  if (pq)
+  {
+    /* Leave the queued keys at the start of sort_keys for save_index() */
+    for (uint i= 0; i < pq->elements; i++)
+      sort_keys[i]= queue_element(pq, i);
+  }
+  else if (indexpos && idx &&
+           write_keys(param, sort_keys,
+                      idx, buffpek_pointers, tempfile))
     DBUG_RETURN(HA_POS_ERROR);			/* purecov: inspected */
   const ha_rows retval=
     my_b_inited(tempfile) ?
@@ -768,6 +846,42 @@ err:
 } /* write_keys */
 
 
+/**
+  Check if the rows to return can be collected in a priority queue.
+
+  This is the case when the sort has a LIMIT that is smaller than the
+  number of rows in the table, and the keys of LIMIT + 1 rows fit in
+  the sort buffer. Then only the first max_rows keys are kept while
+  the rows are read, and nothing has to be merged.
+
+  @param param             Sort parameters, with rec_length and max_rows set
+  @param num_rows          Upper bound of the number of rows to sort
+  @param memory_available  Size of the sort buffer
+*/
+
+static bool check_if_pq_applicable(SORTPARAM *param, ha_rows num_rows,
+                                   ulong memory_available)
+{
+  if (param->max_rows == HA_POS_ERROR || param->max_rows == 0 ||
+      param->max_rows >= num_rows || param->max_rows >= (ha_rows) UINT_MAX32)
+    return FALSE;
+  return (ulonglong) (param->max_rows + 1) *
+         (param->rec_length + sizeof(uchar*)) <= memory_available;
+}
+
+
+/**
+  Compare two sort keys in the priority queue.
+
+  @param cmp_arg  Pointer to the sort key length
+*/
+
+static int pq_key_cmp(void *cmp_arg, uchar *a, uchar *b)
+{
+  return memcmp(a, b, *(uint*) cmp_arg);
+}
+
+
 /**
   Store length as suffix in high-byte-first order.
 */
@@ -294,6 +294,8 @@ void ha_partition::init_handler_variables()
   m_is_clone_of= NULL;
   m_clone_mem_root= NULL;
   m_part_ids_sorted_by_num_of_records= NULL;
+  m_parallel_scan= NULL;
+  m_parallel_scan_query_id= 0;
 
 #ifdef DONT_HAVE_TO_BE_INITALIZED
   m_start_key.flag= 0;
@@ -2759,6 +2761,26 @@ int ha_partition::open(const char *name, int mode, uint test_if_locked)
   }
   bitmap_clear_all(&m_key_not_found_partitions);
   m_key_not_found= false;
+  /*
+    Initialize the bitmaps of partitions that external_lock() has locked
+    and of partitions that need ha_reset() at the end of the statement.
+    The first reset() covers all partitions.
+  */
+  if (bitmap_init(&m_locked_partitions, NULL, m_tot_parts, FALSE))
+  {
+    bitmap_free(&m_bulk_insert_started);
+    bitmap_free(&m_key_not_found_partitions);
+    DBUG_RETURN(error);
+  }
+  bitmap_clear_all(&m_locked_partitions);
+  if (bitmap_init(&m_partitions_to_reset, NULL, m_tot_parts, FALSE))
+  {
+    bitmap_free(&m_bulk_insert_started);
+    bitmap_free(&m_key_not_found_partitions);
+    bitmap_free(&m_locked_partitions);
+    DBUG_RETURN(error);
+  }
+  bitmap_set_all(&m_partitions_to_reset);
   /* Initialize the bitmap we use to determine what partitions are used */
   if (!m_is_clone_of)
   {
@@ -2766,9 +2788,22 @@ int ha_partition::open(const char *name, int mode, uint test_if_locked)
     if (bitmap_init(&(m_part_info->used_partitions), NULL, m_tot_parts, TRUE))
     {
       bitmap_free(&m_bulk_insert_started);
+      bitmap_free(&m_locked_partitions);
+      bitmap_free(&m_partitions_to_reset);
       DBUG_RETURN(error);
     }
     bitmap_set_all(&(m_part_info->used_partitions));
+    /* Initialize the bitmap of partitions the statement locks */
+    if (bitmap_init(&(m_part_info->lock_partitions), NULL, m_tot_parts,
+                    FALSE))
+    {
+      bitmap_free(&m_bulk_insert_started);
+      bitmap_free(&m_locked_partitions);
+      bitmap_free(&m_partitions_to_reset);
+      bitmap_free(&(m_part_info->used_partitions));
+      DBUG_RETURN(error);
+    }
+    bitmap_set_all(&(m_part_info->lock_partitions));
   }
 
   if (m_is_clone_of)
@@ -2900,8 +2935,13 @@ err_handler:
 err_alloc:
   bitmap_free(&m_bulk_insert_started);
   bitmap_free(&m_key_not_found_partitions);
+  bitmap_free(&m_locked_partitions);
+  bitmap_free(&m_partitions_to_reset);
   if (!m_is_clone_of)
+  {
     bitmap_free(&(m_part_info->used_partitions));
+    bitmap_free(&(m_part_info->lock_partitions));
+  }
 
   DBUG_RETURN(error);
 }
@@ -2974,11 +3014,18 @@ int ha_partition::close(void)
   DBUG_ENTER("ha_partition::close");
 
   DBUG_ASSERT(table->s == table_share);
+  if (m_parallel_scan)
+    end_parallel_scan(0);
   destroy_record_priority_queue();
   bitmap_free(&m_bulk_insert_started);
   bitmap_free(&m_key_not_found_partitions);
+  bitmap_free(&m_locked_partitions);
+  bitmap_free(&m_partitions_to_reset);
   if (!m_is_clone_of)
+  {
     bitmap_free(&(m_part_info->used_partitions));
+    bitmap_free(&(m_part_info->lock_partitions));
+  }
   file= m_file;
 
 repeat:
@@ -3036,45 +3083,63 @@ repeat:
 
     Called from lock.cc by lock_external() and unlock_external(). Also called
     from sql_table.cc by copy_data_between_tables().
+
+    Only the partitions in m_part_info->lock_partitions are locked, and
+    unlocking releases exactly the partitions that were locked.
 */
 
 int ha_partition::external_lock(THD *thd, int lock_type)
 {
-  bool first= TRUE;
   uint error;
+  uint i;
   handler **file;
   DBUG_ENTER("ha_partition::external_lock");
 
   DBUG_ASSERT(!auto_increment_lock && !auto_increment_safe_stmt_log_lock);
-  file= m_file;
+  if (m_parallel_scan)
+    end_parallel_scan(0);
   m_lock_type= lock_type;
 
-repeat:
-  do
+  if (lock_type == F_UNLCK)
   {
-    DBUG_PRINT("info", ("external_lock(thd, %d) iteration %d",
-                        lock_type, (int) (file - m_file)));
-    if ((error= (*file)->ha_external_lock(thd, lock_type)))
+    for (i= 0; i < m_tot_parts; i++)
     {
-      if (F_UNLCK != lock_type)
-        goto err_handler;
+      if (!bitmap_is_set(&m_locked_partitions, i))
+        continue;
+      DBUG_PRINT("info", ("external_lock(thd, %d) part %u", lock_type, i));
+      (void) m_file[i]->ha_external_lock(thd, lock_type);
     }
-  } while (*(++file));
+    bitmap_clear_all(&m_locked_partitions);
+    if (m_added_file && m_added_file[0])
+    {
+      file= m_added_file;
+      do
+      {
+        (void) (*file)->ha_external_lock(thd, lock_type);
+      } while (*(++file));
+    }
+    DBUG_RETURN(0);
+  }
 
-  if (first && m_added_file && m_added_file[0])
+  for (i= 0; i < m_tot_parts; i++)
   {
-    DBUG_ASSERT(lock_type == F_UNLCK);
-    file= m_added_file;
-    first= FALSE;
-    goto repeat;
+    if (!bitmap_is_set(&(m_part_info->lock_partitions), i))
+      continue;
+    DBUG_PRINT("info", ("external_lock(thd, %d) part %u", lock_type, i));
+    if ((error= m_file[i]->ha_external_lock(thd, lock_type)))
+      goto err_handler;
+    bitmap_set_bit(&m_locked_partitions, i);
+    bitmap_set_bit(&m_partitions_to_reset, i);
   }
   DBUG_RETURN(0);
 
 err_handler:
-  while (file-- != m_file)
+  for (i= 0; i < m_tot_parts; i++)
   {
-    (*file)->ha_external_lock(thd, F_UNLCK);
+    if (bitmap_is_set(&m_locked_partitions, i))
+      (void) m_file[i]->ha_external_lock(thd, F_UNLCK);
   }
+  bitmap_clear_all(&m_locked_partitions);
   DBUG_RETURN(error);
 }
 
@@ -3129,14 +3194,22 @@ THR_LOCK_DATA **ha_partition::store_lock(THD *thd,
 					 THR_LOCK_DATA **to,
 					 enum thr_lock_type lock_type)
 {
-  handler **file;
+  uint i;
   DBUG_ENTER("ha_partition::store_lock");
-  file= m_file;
-  do
+  /*
+    Until the shared auto_increment value is initialized, writing a row
+    reads the auto_increment value of every partition.
+  */
+  if (table->found_next_number_field &&
+      !table_share->ha_part_data->auto_inc_initialized)
+    bitmap_set_all(&(m_part_info->lock_partitions));
+  for (i= 0; i < m_tot_parts; i++)
   {
-    DBUG_PRINT("info", ("store lock %d iteration", (int) (file - m_file)));
-    to= (*file)->store_lock(thd, to, lock_type);
-  } while (*(++file));
+    if (!bitmap_is_set(&(m_part_info->lock_partitions), i))
+      continue;
+    DBUG_PRINT("info", ("store lock %u iteration", i));
+    to= m_file[i]->store_lock(thd, to, lock_type);
+  }
   DBUG_RETURN(to);
 }
 
@@ -3160,15 +3233,17 @@ THR_LOCK_DATA **ha_partition::store_lock(THD *thd,
 int ha_partition::start_stmt(THD *thd, thr_lock_type lock_type)
 {
   int error= 0;
-  handler **file;
+  uint i;
   DBUG_ENTER("ha_partition::start_stmt");
 
-  file= m_file;
-  do
+  for (i= 0; i < m_tot_parts; i++)
   {
-    if ((error= (*file)->start_stmt(thd, lock_type)))
+    if (!bitmap_is_set(&(m_part_info->lock_partitions), i))
+      continue;
+    bitmap_set_bit(&m_partitions_to_reset, i);
+    if ((error= m_file[i]->start_stmt(thd, lock_type)))
       break;
-  } while (*(++file));
+  }
   DBUG_RETURN(error);
 }
 
@@ -3408,6 +3483,13 @@ int ha_partition::write_row(uchar * buf)
     m_part_info->err_value= func_value;
     goto exit;
   }
+  /* The partitions to lock were pruned before the row was known */
+  if (unlikely(!bitmap_is_set(&(m_part_info->lock_partitions), part_id)))
+  {
+    DBUG_ASSERT(0);
+    error= HA_ERR_INTERNAL_ERROR;
+    goto exit;
+  }
   m_last_part= part_id;
   DBUG_PRINT("info", ("Insert in partition %d", part_id));
   start_part_bulk_insert(thd, part_id);
@@ -3494,6 +3576,12 @@ int ha_partition::update_row(const uchar *old_data, uchar *new_data)
     m_err_rec= old_data;
     DBUG_RETURN(HA_ERR_NO_PARTITION_FOUND);
   }
+  if (unlikely(!bitmap_is_set(&(m_part_info->lock_partitions), new_part_id)))
+  {
+    DBUG_ASSERT(0);
+    error= HA_ERR_INTERNAL_ERROR;
+    goto exit;
+  }
 
   m_last_part= new_part_id;
   start_part_bulk_insert(thd, new_part_id);
@@ -3927,6 +4015,49 @@ int ha_partition::end_bulk_insert()
 }
 
 
+/* Size of a block of rows passed from a scan thread to rnd_next() */
+#define PARTITION_SCAN_BLOCK_SIZE (32 * 1024)
+
+struct Partition_scan_block
+{
+  Partition_scan_block *next;
+  uint rows;
+  uchar *data;
+};
+
+
+class Partition_scan
+{
+public:
+  ha_partition *owner;
+  mysql_mutex_t LOCK_scan;
+  mysql_cond_t COND_rows;               /* A block was queued or thread ended */
+  mysql_cond_t COND_blocks;             /* A block was freed or scan stopped */
+  pthread_t *threads;
+  uint started_threads;                 /* Only used by the owner */
+  uint running_threads;
+  uint next_part;                       /* Next partition to hand out */
+  Partition_scan_block *free_blocks;
+  Partition_scan_block *first_full, *last_full;
+  Partition_scan_block *current;        /* Block read by rnd_next() */
+  uint current_row;
+  const uchar *last_row;                /* Row returned by rnd_next() */
+  uint row_length;                      /* Position followed by record */
+  uint block_rows;
+  uint extra_cache_size;
+  bool extra_cache;
+  int error;
+  volatile bool stop;
+  ulong rnd_next_count;                 /* Reads not in the status yet */
+
+  void run();
+private:
+  uint get_next_partition(bool *use_cache, uint *cache_size);
+  Partition_scan_block *get_free_block();
+  void queue_block(Partition_scan_block *block, ulong *reads);
+};
+
+
 /****************************************************************************
                 MODULE full table scan
 ****************************************************************************/
@@ -4015,6 +4146,13 @@ int ha_partition::rnd_init(bool scan)
       is already in use
     */
     rnd_end();
+    if (use_parallel_scan() && !init_parallel_scan())
+    {
+      m_scan_value= 1;
+      m_part_spec.start_part= NO_CURRENT_PART_ID;
+      m_part_spec.end_part= m_tot_parts - 1;
+      DBUG_RETURN(0);
+    }
     late_extra_cache(part_id);
     if ((error= m_file[part_id]->ha_rnd_init(scan)))
       goto err;
@@ -4064,6 +4202,8 @@ int ha_partition::rnd_end()
 {
   handler **file;
   DBUG_ENTER("ha_partition::rnd_end");
+  if (m_parallel_scan)
+    end_parallel_scan(0);
   switch (m_scan_value) {
   case 2:                                       // Error
     break;
@@ -4116,6 +4256,9 @@ int ha_partition::rnd_next(uchar *buf)
   uint part_id= m_part_spec.start_part;
   DBUG_ENTER("ha_partition::rnd_next");
 
+  if (m_parallel_scan)
+    DBUG_RETURN(parallel_rnd_next(buf));
+
   if (NO_CURRENT_PART_ID == part_id)
   {
     /*
@@ -4211,6 +4354,14 @@ void ha_partition::position(const uchar *record)
   uint pad_length;
   DBUG_ENTER("ha_partition::position");
 
+  if (m_parallel_scan)
+  {
+    /* The row was queued together with its position */
+    DBUG_ASSERT(m_parallel_scan->last_row);
+    memcpy(ref, m_parallel_scan->last_row, m_ref_length);
+    DBUG_VOID_RETURN;
+  }
+
   file->position(record);
   int2store(ref, m_last_part);
   memcpy((ref + PARTITION_BYTES_IN_POS), file->ref, file->ref_length);
@@ -4228,6 +4379,433 @@ void ha_partition::column_bitmaps_signal()
     /* Must read all partition fields to make position() call possible */
     bitmap_union(table->read_set, &m_part_info->full_part_field_set);
 }
+
+
+/****************************************************************************
+                MODULE parallel table scan
+****************************************************************************/
+/*
+  A full table scan can be done by several threads when the session sets
+  partition_scan_threads above 1. Each thread takes the next partition to
+  scan and reads its rows into a block. Full blocks are queued for
+  rnd_next(), which returns the rows block by block, so the rows of the
+  partitions are interleaved. Every row is queued together with its
+  position, since the partition handler has moved on when position() is
+  called.
+
+  A partition is read through a private copy of the TABLE object, as the
+  engine sets table->status for each row it reads.
+*/
+
+uint Partition_scan::get_next_partition(bool *use_cache, uint *cache_size)
+{
+  uint part_id= MY_BIT_NONE;
+  mysql_mutex_lock(&LOCK_scan);
+  *use_cache= extra_cache;
+  *cache_size= extra_cache_size;
+  if (!stop)
+  {
+    while (next_part < owner->m_tot_parts &&
+           !bitmap_is_set(&(owner->m_part_info->used_partitions), next_part))
+      next_part++;
+    if (next_part < owner->m_tot_parts)
+      part_id= next_part++;
+  }
+  mysql_mutex_unlock(&LOCK_scan);
+  return part_id;
+}
+
+
+Partition_scan_block *Partition_scan::get_free_block()
+{
+  Partition_scan_block *block= NULL;
+  mysql_mutex_lock(&LOCK_scan);
+  while (!free_blocks && !stop)
+    mysql_cond_wait(&COND_blocks, &LOCK_scan);
+  if (!stop)
+  {
+    block= free_blocks;
+    free_blocks= block->next;
+    block->rows= 0;
+  }
+  mysql_mutex_unlock(&LOCK_scan);
+  return block;
+}
+
+
+void Partition_scan::queue_block(Partition_scan_block *block, ulong *reads)
+{
+  mysql_mutex_lock(&LOCK_scan);
+  rnd_next_count+= *reads;
+  *reads= 0;
+  block->next= NULL;
+  if (last_full)
+    last_full->next= block;
+  else
+    first_full= block;
+  last_full= block;
+  mysql_cond_signal(&COND_rows);
+  mysql_mutex_unlock(&LOCK_scan);
+}
+
+
+/*
+  Read partitions until there are no more or the scan is stopped
+
+  NOTES
+    Runs in a scan thread. The partition handlers are used by one thread
+    at a time, the owner does not touch them until all threads have ended.
+    The handlers do not update the status variables of the owner's THD,
+    the reads are counted here and added to Handler_read_rnd_next by the
+    owner.
+*/
+
+void Partition_scan::run()
+{
+  TABLE table_copy= *owner->table;
+  Partition_scan_block *block= NULL;
+  uint ref_length= owner->m_ref_length;
+  uint part_id, cache_size;
+  ulong reads= 0;
+  bool use_cache;
+  int result= 0;
+  DBUG_ENTER("Partition_scan::run");
+
+  while (!result &&
+         (part_id= get_next_partition(&use_cache, &cache_size)) != MY_BIT_NONE)
+  {
+    handler *file= owner->m_file[part_id];
+    DBUG_PRINT("info", ("scanning partition %u", part_id));
+    file->change_table_ptr(&table_copy, owner->table_share);
+    file->no_statistics= TRUE;
+    if (use_cache)
+    {
+      if (cache_size == 0)
+        (void) file->extra(HA_EXTRA_CACHE);
+      else
+        (void) file->extra_opt(HA_EXTRA_CACHE, cache_size);
+    }
+    if (!(result= file->ha_rnd_init(1)))
+    {
+      while (!stop)
+      {
+        uchar *row;
+        if (!block && !(block= get_free_block()))
+          break;
+        row= block->data + block->rows * row_length;
+        reads++;
+        if ((result= file->rnd_next(row + ref_length)))
+        {
+          if (result == HA_ERR_RECORD_DELETED)
+            continue;
+          if (result == HA_ERR_END_OF_FILE)
+            result= 0;
+          break;
+        }
+        file->position(row + ref_length);
+        int2store(row, part_id);
+        memcpy(row + PARTITION_BYTES_IN_POS, file->ref, file->ref_length);
+        bzero(row + PARTITION_BYTES_IN_POS + file->ref_length,
+              ref_length - PARTITION_BYTES_IN_POS - file->ref_length);
+        if (++block->rows == block_rows)
+        {
+          queue_block(block, &reads);
+          block= NULL;
+        }
+      }
+      file->ha_rnd_end();
+    }
+    if (use_cache)
+      (void) file->extra(HA_EXTRA_NO_CACHE);
+    file->no_statistics= FALSE;
+    file->change_table_ptr(owner->table, owner->table_share);
+  }
+
+  mysql_mutex_lock(&LOCK_scan);
+  rnd_next_count+= reads;
+  if (block)
+  {
+    if (block->rows && !stop)
+    {
+      block->next= NULL;
+      if (last_full)
+        last_full->next= block;
+      else
+        first_full= block;
+      last_full= block;
+    }
+    else
+    {
+      block->next= free_blocks;
+      free_blocks= block;
+    }
+  }
+  if (result && !error)
+  {
+    error= result;
+    stop= TRUE;
+    mysql_cond_broadcast(&COND_blocks);
+  }
+  running_threads--;
+  mysql_cond_signal(&COND_rows);
+  mysql_mutex_unlock(&LOCK_scan);
+  DBUG_VOID_RETURN;
+}
+
+
+extern "C" pthread_handler_t partition_scan_thread(void *arg)
+{
+  Partition_scan *scan= (Partition_scan*) arg;
+  my_thread_init();
+  scan->run();
+  my_thread_end();
+  pthread_exit(0);
+  return 0;
+}
+
+
+/*
+  Check if the table scan that is started can use scan threads
+
+  SYNOPSIS
+    use_parallel_scan()
+
+  RETURN VALUE
+    TRUE                  Start scan threads
+    FALSE                 Scan the partitions in this thread
+
+  DESCRIPTION
+    Only read-only scans are done in parallel, since update_row() and
+    delete_row() act on the row last read by the partition handler. Blobs
+    point into the buffers of the partition handler and are not queued.
+    A table that is scanned more than once in a statement, like the
+    inner table of a join, is only scanned in parallel the first time so
+    that the threads are not started for every outer row.
+*/
+
+bool ha_partition::use_parallel_scan()
+{
+  THD *thd= ha_thd();
+  uint i, parts= 0;
+  DBUG_ENTER("ha_partition::use_parallel_scan");
+
+  if (thd->variables.partition_scan_threads < 2 ||
+      m_lock_type != F_RDLCK ||
+      table_share->blob_fields ||
+      !(m_file[0]->ht->flags & HTON_SUPPORTS_PARALLEL_SCAN) ||
+      m_parallel_scan_query_id == thd->query_id)
+    DBUG_RETURN(FALSE);
+
+  for (i= 0; i < m_tot_parts; i++)
+  {
+    if (bitmap_is_set(&(m_part_info->used_partitions), i) && ++parts > 1)
+    {
+      m_parallel_scan_query_id= thd->query_id;
+      DBUG_RETURN(TRUE);
+    }
+  }
+  DBUG_RETURN(FALSE);
+}
+
+
+/*
+  Start the threads of a parallel table scan
+
+  SYNOPSIS
+    init_parallel_scan()
+
+  RETURN VALUE
+    TRUE                  No thread could be started, scan sequentially
+    FALSE                 Success
+*/
+
+bool ha_partition::init_parallel_scan()
+{
+  Partition_scan *scan;
+  Partition_scan_block *blocks;
+  pthread_t *threads;
+  pthread_attr_t thr_attr;
+  uchar *data;
+  uint i, num_threads, num_blocks, num_parts= 0, row_length, block_rows;
+  DBUG_ENTER("ha_partition::init_parallel_scan");
+
+  for (i= 0; i < m_tot_parts; i++)
+    if (bitmap_is_set(&(m_part_info->used_partitions), i))
+      num_parts++;
+  num_threads= min(ha_thd()->variables.partition_scan_threads, num_parts);
+  /* One block filled by each thread, one read and one queued per thread */
+  num_blocks= 2 * num_threads + 1;
+  row_length= m_ref_length + m_rec_length;
+  block_rows= max(PARTITION_SCAN_BLOCK_SIZE / row_length, 1);
+
+  if (!my_multi_malloc(MYF(0),
+                       &scan, sizeof(Partition_scan),
+                       &threads, sizeof(pthread_t) * num_threads,
+                       &blocks, sizeof(Partition_scan_block) * num_blocks,
+                       &data, (size_t) num_blocks * block_rows * row_length,
+                       NullS))
+    DBUG_RETURN(TRUE);
+
+  bzero(scan, sizeof(Partition_scan));
+  scan->owner= this;
+  scan->threads= threads;
+  scan->row_length= row_length;
+  scan->block_rows= block_rows;
+  scan->extra_cache= m_extra_cache;
+  scan->extra_cache_size= m_extra_cache_size;
+  for (i= 0; i < num_blocks; i++)
+  {
+    blocks[i].data= data + (size_t) i * block_rows * row_length;
+    blocks[i].next= scan->free_blocks;
+    scan->free_blocks= blocks + i;
+  }
+  mysql_mutex_init(key_PARTITION_LOCK_scan, &scan->LOCK_scan,
+                   MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_PARTITION_COND_scan_rows, &scan->COND_rows, NULL);
+  mysql_cond_init(key_PARTITION_COND_scan_blocks, &scan->COND_blocks, NULL);
+  m_parallel_scan= scan;
+
+  /* Unlike connection threads, the scan threads are joined */
+  (void) pthread_attr_init(&thr_attr);
+  (void) pthread_attr_setdetachstate(&thr_attr, PTHREAD_CREATE_JOINABLE);
+  (void) pthread_attr_setstacksize(&thr_attr, my_thread_stack_size);
+  for (i= 0; i < num_threads; i++)
+  {
+    mysql_mutex_lock(&scan->LOCK_scan);
+    scan->running_threads++;
+    mysql_mutex_unlock(&scan->LOCK_scan);
+    if (mysql_thread_create(key_thread_partition_scan, threads + i,
+                            &thr_attr, partition_scan_thread,
+                            (void*) scan))
+    {
+      mysql_mutex_lock(&scan->LOCK_scan);
+      scan->running_threads--;
+      mysql_mutex_unlock(&scan->LOCK_scan);
+      break;
+    }
+    scan->started_threads++;
+  }
+  (void) pthread_attr_destroy(&thr_attr);
+  DBUG_PRINT("info", ("started %u scan threads", scan->started_threads));
+
+  if (!scan->started_threads)
+  {
+    end_parallel_scan(0);
+    DBUG_RETURN(TRUE);
+  }
+  DBUG_RETURN(FALSE);
+}
+
+
+/*
+  Return the next row queued by the scan threads
+
+  SYNOPSIS
+    parallel_rnd_next()
+    buf                   Buffer that should be filled with data
+
+  RETURN VALUE
+    >0                    Error code
+    0                     Success
+*/
+
+int ha_partition::parallel_rnd_next(uchar *buf)
+{
+  Partition_scan *scan= m_parallel_scan;
+  const uchar *row;
+  DBUG_ENTER("ha_partition::parallel_rnd_next");
+
+  if (!scan->current || scan->current_row == scan->current->rows)
+  {
+    int error;
+    mysql_mutex_lock(&scan->LOCK_scan);
+    if (scan->current)
+    {
+      scan->current->next= scan->free_blocks;
+      scan->free_blocks= scan->current;
+      scan->current= NULL;
+      mysql_cond_signal(&scan->COND_blocks);
+    }
+    while (!scan->first_full && scan->running_threads && !scan->error)
+      mysql_cond_wait(&scan->COND_rows, &scan->LOCK_scan);
+    status_var_add(ha_thd()->status_var.ha_read_rnd_next_count,
+                   scan->rnd_next_count);
+    scan->rnd_next_count= 0;
+    if (!(error= scan->error) && (scan->current= scan->first_full))
+    {
+      if (!(scan->first_full= scan->current->next))
+        scan->last_full= NULL;
+      scan->current_row= 0;
+    }
+    mysql_mutex_unlock(&scan->LOCK_scan);
+    if (!scan->current)
+    {
+      scan->last_row= NULL;
+      table->status= STATUS_NOT_FOUND;
+      DBUG_RETURN(error ? error : HA_ERR_END_OF_FILE);
+    }
+  }
+
+  row= scan->current->data + scan->current_row++ * scan->row_length;
+  memcpy(buf, row + m_ref_length, m_rec_length);
+  scan->last_row= row;
+  m_last_part= uint2korr(row);
+  table->status= 0;
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Stop the scan threads and free the parallel scan
+
+  SYNOPSIS
+    end_parallel_scan()
+    error                 Error to report if rows were left unread,
+                          0 when the scan is ended by rnd_end()
+
+  DESCRIPTION
+    The scan is kept after an error so that the next rnd_next() reports
+    it, it is freed by rnd_end().
+*/
+
+void ha_partition::end_parallel_scan(int error)
+{
+  Partition_scan *scan= m_parallel_scan;
+  uint i;
+  DBUG_ENTER("ha_partition::end_parallel_scan");
+
+  mysql_mutex_lock(&scan->LOCK_scan);
+  if (error && !scan->error &&
+      (scan->running_threads || scan->first_full ||
+       (scan->current && scan->current_row < scan->current->rows)))
+    scan->error= error;
+  scan->stop= TRUE;
+  mysql_cond_broadcast(&scan->COND_blocks);
+  mysql_mutex_unlock(&scan->LOCK_scan);
+
+  for (i= 0; i < scan->started_threads; i++)
+    pthread_join(scan->threads[i], NULL);
+  scan->started_threads= 0;
+  status_var_add(ha_thd()->status_var.ha_read_rnd_next_count,
+                 scan->rnd_next_count);
+  scan->rnd_next_count= 0;
+
+  if (error)
+  {
+    /* Nothing more is read, rnd_next() returns the error */
+    scan->first_full= scan->last_full= scan->current= NULL;
+    if (!scan->error)
+      scan->error= HA_ERR_END_OF_FILE;
+    DBUG_VOID_RETURN;
+  }
+
+  mysql_cond_destroy(&scan->COND_blocks);
+  mysql_cond_destroy(&scan->COND_rows);
+  mysql_mutex_destroy(&scan->LOCK_scan);
+  my_free(scan);
+  m_parallel_scan= NULL;
+  DBUG_VOID_RETURN;
+}
  
 
 /*
@@ -4257,6 +4835,9 @@ int ha_partition::rnd_pos(uchar * buf, uchar *pos)
   handler *file;
   DBUG_ENTER("ha_partition::rnd_pos");
 
+  /* The scan threads may be using the partition */
+  if (m_parallel_scan)
+    end_parallel_scan(HA_ERR_INTERNAL_ERROR);
   part_id= uint2korr((const uchar *) pos);
   DBUG_ASSERT(part_id < m_tot_parts);
   file= m_file[part_id];
@@ -6252,6 +6833,14 @@ int ha_partition::extra(enum ha_extra_function operation)
   DBUG_ENTER("ha_partition:extra");
   DBUG_PRINT("info", ("operation: %d", (int) operation));
 
+  /*
+    The scan threads own the partitions and their caches until the scan
+    is ended. Anything but setting up or dropping the cache stops the scan.
+  */
+  if (m_parallel_scan && operation != HA_EXTRA_CACHE &&
+      operation != HA_EXTRA_NO_CACHE)
+    end_parallel_scan(HA_ERR_INTERNAL_ERROR);
+
   switch (operation) {
     /* Category 1), used by most handlers */
   case HA_EXTRA_KEYREAD:
@@ -6413,16 +7002,23 @@ int ha_partition::extra(enum ha_extra_function operation)
 int ha_partition::reset(void)
 {
   int result= 0, tmp;
-  handler **file;
+  uint i;
   DBUG_ENTER("ha_partition::reset");
+  if (m_parallel_scan)
+    end_parallel_scan(0);
   if (m_part_info)
+  {
     bitmap_set_all(&m_part_info->used_partitions);
-  file= m_file;
-  do
+    bitmap_set_all(&m_part_info->lock_partitions);
+  }
+  /* Only the partitions the statement has touched need a reset */
+  for (i= 0; i < m_tot_parts; i++)
   {
-    if ((tmp= (*file)->ha_reset()))
+    if (bitmap_is_set(&m_partitions_to_reset, i) &&
+        (tmp= m_file[i]->ha_reset()))
       result= tmp;
-  } while (*(++file));
+  }
+  bitmap_clear_all(&m_partitions_to_reset);
   DBUG_RETURN(result);
 }
 
@@ -6467,7 +7063,15 @@ void ha_partition::prepare_extra_cache(uint cachesize)
 
   m_extra_cache= TRUE;
   m_extra_cache_size= cachesize;
-  if (m_part_spec.start_part != NO_CURRENT_PART_ID)
+  if (m_parallel_scan)
+  {
+    /* Used from the next partition a scan thread reads */
+    mysql_mutex_lock(&m_parallel_scan->LOCK_scan);
+    m_parallel_scan->extra_cache= TRUE;
+    m_parallel_scan->extra_cache_size= cachesize;
+    mysql_mutex_unlock(&m_parallel_scan->LOCK_scan);
+  }
+  else if (m_part_spec.start_part != NO_CURRENT_PART_ID)
   {
     late_extra_cache(m_part_spec.start_part);
   }
@@ -6528,9 +7132,12 @@ int ha_partition::loop_extra(enum ha_extra_function operation)
   is_select= (thd_sql_command(ha_thd()) == SQLCOM_SELECT);
   for (file= m_file; *file; file++)
   {
-    if (!is_select ||
-        bitmap_is_set(&(m_part_info->used_partitions), file - m_file))
+    uint part_id= file - m_file;
+    if ((!is_select ||
+         bitmap_is_set(&(m_part_info->used_partitions), part_id)) &&
+        bitmap_is_set(&(m_part_info->lock_partitions), part_id))
     {
+      bitmap_set_bit(&m_partitions_to_reset, part_id);
       if ((tmp= (*file)->extra(operation)))
         result= tmp;
     }
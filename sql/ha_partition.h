@@ -41,6 +41,8 @@ enum partition_keywords
                                         HA_CAN_SQL_HANDLER | \
                                         HA_CAN_INSERT_DELAYED)
 
+class Partition_scan;
+
 /* First 4 bytes in the .par file is the number of 32-bit words in the file */
 #define PAR_WORD_SIZE 4
 /* offset to the .par file checksum */
@@ -189,6 +191,15 @@ private:
   /** partitions that returned HA_ERR_KEY_NOT_FOUND. */
   MY_BITMAP m_key_not_found_partitions;
   bool m_key_not_found;
+  /** partitions locked by external_lock(). */
+  MY_BITMAP m_locked_partitions;
+  /** partitions that need ha_reset() at the end of the statement. */
+  MY_BITMAP m_partitions_to_reset;
+  /** Threads reading the partitions of the current table scan, if any. */
+  Partition_scan *m_parallel_scan;
+  /** Statement that started a parallel scan, see use_parallel_scan(). */
+  query_id_t m_parallel_scan_query_id;
+  friend class Partition_scan;
 public:
   handler *clone(const char *name, MEM_ROOT *mem_root);
   virtual void set_part_info(partition_info *part_info)
@@ -437,6 +448,13 @@ public:
   virtual int rnd_pos_by_record(uchar *record);
   virtual void position(const uchar * record);
 
+private:
+  bool use_parallel_scan();
+  bool init_parallel_scan();
+  int parallel_rnd_next(uchar *buf);
+  void end_parallel_scan(int error);
+public:
+
   /*
     -------------------------------------------------------------------------
     MODULE index scan
@@ -820,7 +838,15 @@ public:
         m_handler_status >= handler_closed)
       DBUG_RETURN(PARTITION_ENABLED_TABLE_FLAGS);
 
-    DBUG_RETURN((m_file[0]->ha_table_flags() &
+    /*
+      Take the flags from a locked partition when there is one, since
+      some engines (InnoDB) only refresh them in external_lock().
+    */
+    uint part_id= 0;
+    if (m_handler_status == handler_opened &&
+        (part_id= bitmap_get_first_set(&m_locked_partitions)) == MY_BIT_NONE)
+      part_id= 0;
+    DBUG_RETURN((m_file[part_id]->ha_table_flags() &
                  ~(PARTITION_DISABLED_TABLE_FLAGS)) |
                 (PARTITION_ENABLED_TABLE_FLAGS));
   }
@@ -2212,7 +2212,8 @@ double handler::keyread_time(uint keynr, uint ranges, ha_rows records)
 
 void handler::ha_statistic_increment(ulong SSV::*offset) const
 {
-  status_var_increment(table->in_use->status_var.*offset);
+  if (!no_statistics)
+    status_var_increment(table->in_use->status_var.*offset);
 }
 
 void **handler::ha_data(THD *thd) const
@@ -4658,6 +4659,250 @@ scan_it_again:
 }
 
 
+/****************************************************************************
+  DS-MRR: read_multi_range_first()/next() reading the rows in rowid order
+****************************************************************************/
+
+/**
+  Check if the rows of a scan on the given index may be read in rowid
+  order.
+
+  @note The clone scans the index without the row locks of a locking
+        read and would see the index change under it if the statement
+        modifies the table, so only plain reads qualify.
+*/
+
+bool DsMrr_impl::can_read_in_rowid_order(uint keynr)
+{
+  TABLE *table= h->table;
+  enum thr_lock_type lock_type= table->reginfo.lock_type;
+
+  if (keynr == table->s->primary_key && h->primary_key_is_clustered())
+    return FALSE;                               // Already in rowid order
+  if (table->key_info[keynr].flags & (HA_SPATIAL | HA_FULLTEXT))
+    return FALSE;
+  return (lock_type < TL_WRITE_ALLOW_WRITE &&
+          lock_type != TL_READ_WITH_SHARED_LOCKS);
+}
+
+
+/**
+  Implementation of handler::multi_range_read_info().
+*/
+
+bool DsMrr_impl::dsmrr_info(uint keynr, ha_rows rows, uint *bufsz,
+                            ha_rows *buf_rows)
+{
+  uint elem_length= h->ref_length + sizeof(KEY_MULTI_RANGE*);
+  ha_rows max_buf_rows= *bufsz / elem_length;
+
+  if (!max_buf_rows || !can_read_in_rowid_order(keynr))
+    return TRUE;
+
+  /* Don't ask for more buffer space than the rows in the ranges need */
+  *buf_rows= min(rows + 1, max_buf_rows);
+  *bufsz= (uint) (*buf_rows * elem_length);
+  return FALSE;
+}
+
+
+/**
+  Implementation of handler::read_multi_range_first().
+
+  Falls back to the default implementation if the caller needs the rows
+  in key order, has not given a buffer, or reads only the index.
+*/
+
+int DsMrr_impl::dsmrr_first(KEY_MULTI_RANGE **found_range_p,
+                            KEY_MULTI_RANGE *ranges, uint range_count,
+                            bool sorted, HANDLER_BUFFER *buffer)
+{
+  TABLE *table= h->table;
+  uint keynr;
+  int res;
+  DBUG_ENTER("DsMrr_impl::dsmrr_first");
+
+  rowid_length= h->ref_length + sizeof(KEY_MULTI_RANGE*);
+  if (sorted || !buffer || table->key_read ||
+      (size_t) (buffer->buffer_end - buffer->buffer) < rowid_length)
+    goto use_default;
+
+  if (h->inited == handler::INDEX)
+  {
+    keynr= h->active_index;
+    if (!can_read_in_rowid_order(keynr))
+      goto use_default;
+  }
+  else if (h->inited == handler::RND && h2 && h2->inited == handler::INDEX)
+    keynr= h2->active_index;                    // Next ranges of our scan
+  else
+    goto use_default;
+
+  if (!h2)
+  {
+    THD *thd= table->in_use;
+    handler *new_h2;
+
+    if (!(new_h2= h->clone(table->s->normalized_path.str, thd->mem_root)))
+      DBUG_RETURN(HA_ERR_OUT_OF_MEM);
+    if ((res= new_h2->ha_external_lock(thd, F_RDLCK)))
+    {
+      new_h2->close();
+      delete new_h2;
+      DBUG_RETURN(res);
+    }
+    new_h2->extra(HA_EXTRA_KEYREAD);
+    h2= new_h2;
+  }
+
+  if (h->inited == handler::INDEX)
+  {
+    /*
+      Switch h to rnd_pos() calls. This ends the scan of h2, if any,
+      through dsmrr_close(). The primary key columns must be read by h2
+      for position().
+    */
+    table->prepare_for_position();
+    if (h->pushed_idx_cond && h->pushed_idx_cond_keyno == keynr)
+      h2->idx_cond_push(keynr, h->pushed_idx_cond);
+    else
+      h2->cancel_pushed_idx_cond();
+    if ((res= h->ha_index_end()) ||
+        (res= h2->ha_index_init(keynr, FALSE)) ||
+        (res= h->ha_rnd_init(FALSE)))
+      DBUG_RETURN(res);
+  }
+
+  use_default_impl= FALSE;
+  rowids_buf= (uchar*) buffer->buffer;
+  rowids_buf_end= rowids_buf + ((buffer->buffer_end - buffer->buffer) /
+                                rowid_length) * rowid_length;
+  rowids_buf_cur= rowids_buf_last= rowids_buf;
+  ranges_start= ranges;
+  ranges_count= range_count;
+  dsmrr_eof= FALSE;
+  DBUG_RETURN(dsmrr_next(found_range_p));
+
+use_default:
+  use_default_impl= TRUE;
+  DBUG_RETURN(h->handler::read_multi_range_first(found_range_p, ranges,
+                                                 range_count, sorted, buffer));
+}
+
+
+static int rowid_cmp(void *h, uchar *a, uchar *b)
+{
+  return ((handler*)h)->cmp_ref(a, b);
+}
+
+
+/**
+  Scan the index until the buffer is full or the ranges are exhausted,
+  then sort the collected rowids.
+*/
+
+int DsMrr_impl::dsmrr_fill_buffer()
+{
+  TABLE *table= h->table;
+  KEY_MULTI_RANGE *range;
+  int res= 0;
+  DBUG_ENTER("DsMrr_impl::dsmrr_fill_buffer");
+
+  rowids_buf_cur= rowids_buf;
+  while (rowids_buf_cur < rowids_buf_end)
+  {
+    if (ranges_start)
+    {
+      res= h2->handler::read_multi_range_first(&range, ranges_start,
+                                               ranges_count, FALSE, NULL);
+      ranges_start= NULL;
+    }
+    else
+      res= h2->handler::read_multi_range_next(&range);
+    if (res)
+      break;
+
+    /* Put the {rowid, range} pair into the buffer */
+    h2->position(table->record[0]);
+    memcpy(rowids_buf_cur, h2->ref, h2->ref_length);
+    memcpy(rowids_buf_cur + h2->ref_length, &range, sizeof(range));
+    rowids_buf_cur+= rowid_length;
+  }
+
+  if (res && res != HA_ERR_END_OF_FILE)
+    DBUG_RETURN(res);
+  dsmrr_eof= test(res == HA_ERR_END_OF_FILE);
+
+  my_qsort2(rowids_buf, (rowids_buf_cur - rowids_buf) / rowid_length,
+            rowid_length, (qsort2_cmp) rowid_cmp, (void*) h);
+  rowids_buf_last= rowids_buf_cur;
+  rowids_buf_cur= rowids_buf;
+  DBUG_RETURN(0);
+}
+
+
+/**
+  Implementation of handler::read_multi_range_next().
+*/
+
+int DsMrr_impl::dsmrr_next(KEY_MULTI_RANGE **found_range_p)
+{
+  int res;
+
+  if (use_default_impl)
+    return h->handler::read_multi_range_next(found_range_p);
+
+  do
+  {
+    if (rowids_buf_cur == rowids_buf_last)
+    {
+      if (dsmrr_eof)
+        return HA_ERR_END_OF_FILE;
+      if ((res= dsmrr_fill_buffer()))
+        return res;
+      if (rowids_buf_cur == rowids_buf_last)
+        return HA_ERR_END_OF_FILE;
+    }
+    memcpy(found_range_p, rowids_buf_cur + h->ref_length,
+           sizeof(KEY_MULTI_RANGE*));
+    res= h->rnd_pos(h->table->record[0], rowids_buf_cur);
+    rowids_buf_cur+= rowid_length;
+  } while (res == HA_ERR_RECORD_DELETED);
+
+  return res;
+}
+
+
+/**
+  End the index scan of the clone, if any. The clone is kept for the
+  next scan in the statement.
+*/
+
+void DsMrr_impl::dsmrr_close()
+{
+  if (h2 && h2->inited != handler::NONE)
+    h2->ha_index_or_rnd_end();
+  use_default_impl= TRUE;
+}
+
+
+/**
+  Release the clone at the end of the statement.
+*/
+
+void DsMrr_impl::reset()
+{
+  if (h2)
+  {
+    dsmrr_close();
+    h2->ha_external_lock(current_thd, F_UNLCK);
+    h2->close();
+    delete h2;
+    h2= NULL;
+  }
+}
+
+
 /**
   Read first row between two ranges.
   Store ranges for future calls to read_range_next.
@@ -4795,11 +5040,37 @@ int handler::compare_key(key_range *range)
 }
 
 
+/**
+  Check the index condition pushed down to the handler.
+
+  Called by the storage engine for each index entry found while scanning
+  the index the condition was pushed for, after the index columns have
+  been stored in table->record[0].
+
+  @param h_arg  The handler, see handler::idx_cond_push()
+
+  @retval ICP_NO_MATCH      The condition is false, skip the index entry
+  @retval ICP_MATCH         The condition is true, read the row
+  @retval ICP_OUT_OF_RANGE  The entry is beyond the end of the range being
+                            read, stop the scan
+*/
+
+extern "C" enum icp_result handler_index_cond_check(void* h_arg)
+{
+  handler *h= (handler*) h_arg;
+  if (h->end_range && h->compare_key(h->end_range) > 0)
+    return ICP_OUT_OF_RANGE;
+  return h->pushed_idx_cond->val_int() ? ICP_MATCH : ICP_NO_MATCH;
+}
+
+
 int handler::index_read_idx_map(uchar * buf, uint index, const uchar * key,
                                 key_part_map keypart_map,
                                 enum ha_rkey_function find_flag)
 {
   int error, error1;
+  /* Not part of a range scan: the pushed index condition has no end */
+  end_range= NULL;
   error= index_init(index, 0);
   if (!error)
   {
@@ -5127,6 +5398,9 @@ int handler::ha_external_lock(THD *thd, int lock_type)
   */
   DBUG_ASSERT(next_insert_id == 0);
 
+  /* Counted per handler, so a partitioned table shows its locked partitions */
+  status_var_increment(thd->status_var.ha_external_lock_count);
+
   if (MYSQL_HANDLER_RDLOCK_START_ENABLED() ||
       MYSQL_HANDLER_WRLOCK_START_ENABLED() ||
       MYSQL_HANDLER_UNLOCK_START_ENABLED())
@@ -5197,6 +5471,7 @@ int handler::ha_reset()
   /* reset the bitmaps to point to defaults */
   table->default_column_bitmaps();
   pushed_cond= NULL;
+  cancel_pushed_idx_cond();
   DBUG_RETURN(reset());
 }
 
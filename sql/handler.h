@@ -199,6 +199,8 @@ enum enum_alter_inplace_result {
 //  i.e index is covering
 // skipping 128 because SOME product has HA_KEY_SCAN_NOT_ROR
 #define HA_CLUSTERED_INDEX      256
+/* Supports index condition pushdown, see handler::idx_cond_push() */
+#define HA_DO_INDEX_COND_PUSHDOWN 512
 
 /*
   bits in alter_table_flags:
@@ -908,6 +910,7 @@ struct handlerton
 #define HTON_SUPPORT_LOG_TABLES      (1 << 7) //Engine supports log tables
 #define HTON_NO_PARTITION            (1 << 8) //You can not partition these tables
 #define HTON_SUPPORTS_FOREIGN_KEYS   (1 << 9) //Foreign key constraint supported.
+#define HTON_SUPPORTS_PARALLEL_SCAN  (1 << 10) //Partitions can be scanned by other threads
 
 class Ha_trx_info;
 
@@ -1562,7 +1565,19 @@ public:
   enum {NONE=0, INDEX, RND} inited;
   bool locked;
   bool implicit_emptied;                /* Can be !=0 only if HEAP */
+  /*
+    The handler is read by a partition scan thread, which must not update
+    the status of table->in_use. The reads are counted by the scan.
+  */
+  bool no_statistics;
   const COND *pushed_cond;
+  /**
+    Condition on the columns of index pushed_idx_cond_keyno, which the
+    engine checks on each index entry before it reads the row.
+    @see idx_cond_push()
+  */
+  Item *pushed_idx_cond;
+  uint pushed_idx_cond_keyno;
   /**
     next_insert_id is the next value which should be inserted into the
     auto_increment column: in a inserting-multi-row statement (like INSERT
@@ -1613,8 +1628,9 @@ public:
     ref(0), key_used_on_scan(MAX_KEY), active_index(MAX_KEY),
     ref_length(sizeof(my_off_t)),
     ft_handler(0), inited(NONE),
-    locked(FALSE), implicit_emptied(0),
-    pushed_cond(0), next_insert_id(0), insert_id_for_cur_row(0),
+    locked(FALSE), implicit_emptied(0), no_statistics(FALSE),
+    pushed_cond(0), pushed_idx_cond(NULL), pushed_idx_cond_keyno(MAX_KEY),
+    next_insert_id(0), insert_id_for_cur_row(0),
     auto_inc_intervals_count(0),
     m_psi(NULL)
     {}
@@ -1640,6 +1656,7 @@ public:
     DBUG_ASSERT(inited==NONE);
     if (!(result= index_init(idx, sorted)))
       inited=INDEX;
+    end_range= NULL;
     DBUG_RETURN(result);
   }
   int ha_index_end()
@@ -1906,6 +1923,26 @@ public:
                                      KEY_MULTI_RANGE *ranges, uint range_count,
                                      bool sorted, HANDLER_BUFFER *buffer);
   virtual int read_multi_range_next(KEY_MULTI_RANGE **found_range_p);
+  /**
+    Check if read_multi_range_first() can return the rows of a range scan
+    in rowid order, by sorting the rowids found in the index first.
+
+    @param keynr      Index to scan
+    @param rows       Estimated number of rows in the ranges
+    @param[in,out] bufsz  IN:  Size of the buffer the caller can provide
+                          OUT: Size of the buffer the handler needs
+    @param[out] buf_rows  Number of rows one buffer fill can hold
+
+    @note If the caller decides to read the rows in rowid order, it passes
+          a buffer of *bufsz bytes to read_multi_range_first() and does
+          not ask for a sorted result.
+
+    @retval FALSE  The rows can be read in rowid order
+    @retval TRUE   Not supported
+  */
+  virtual bool multi_range_read_info(uint keynr, ha_rows rows, uint *bufsz,
+                                     ha_rows *buf_rows)
+  { return TRUE; }
   virtual int read_range_first(const key_range *start_key,
                                const key_range *end_key,
                                bool eq_range, bool sorted);
@@ -2266,6 +2303,35 @@ public:
    Pops the top if condition stack, if stack is not empty.
  */
  virtual void cond_pop() { return; };
+
+ /**
+   Push down an index condition to the handler.
+
+   The condition only refers to columns of index 'keyno' (and to
+   constants). An engine that supports it, see HA_DO_INDEX_COND_PUSHDOWN,
+   checks the condition with handler_index_cond_check() on each index
+   entry it finds while scanning index 'keyno', after storing the index
+   columns in table->record[0], and skips the entry without reading the
+   row if the condition is false.
+
+   Unlike cond_push(), the pushed condition stays in effect until
+   cancel_pushed_idx_cond() or ha_reset() is called.
+
+   @param  keyno     Index for which the condition is pushed
+   @param  idx_cond  Condition to be checked on the index entries
+
+   @return
+     The part of the condition that the handler does not check, which the
+     caller must check on the rows returned. NULL means the whole
+     condition is checked by the handler.
+ */
+ virtual Item *idx_cond_push(uint keyno, Item *idx_cond) { return idx_cond; }
+ /** Stop checking the index condition pushed by idx_cond_push(). */
+ virtual void cancel_pushed_idx_cond()
+ {
+   pushed_idx_cond= NULL;
+   pushed_idx_cond_keyno= MAX_KEY;
+ }
  virtual bool check_if_incompatible_data(HA_CREATE_INFO *create_info,
 					 uint table_changes)
  { return COMPATIBLE_DATA_NO; }
@@ -2811,6 +2877,64 @@ public:
   virtual bool rpl_lookup_rows() {
       return true;
   }
+
+  friend class DsMrr_impl;
+};
+
+
+extern "C" enum icp_result handler_index_cond_check(void* h_arg);
+
+
+/**
+  Disk-sweep implementation of read_multi_range_first()/next().
+
+  The ranges are scanned through a clone of the handler, reading only the
+  index, and the rowids found are collected in the buffer passed by the
+  caller. When the buffer is full or the ranges are exhausted the rowids
+  are sorted and the rows fetched with rnd_pos() in rowid order, so the
+  table is read in one sweep instead of a random access per row.
+
+  A storage engine uses it by embedding an instance and forwarding
+  read_multi_range_first(), read_multi_range_next() and
+  multi_range_read_info() to it. It must call dsmrr_close() from its
+  index_end() and rnd_end(), and reset() from its reset(), close() and
+  external_lock(F_UNLCK).
+*/
+
+class DsMrr_impl
+{
+public:
+  DsMrr_impl() : h(NULL), h2(NULL), use_default_impl(TRUE) {}
+  void init(handler *h_arg) { h= h_arg; }
+
+  int dsmrr_first(KEY_MULTI_RANGE **found_range_p, KEY_MULTI_RANGE *ranges,
+                  uint range_count, bool sorted, HANDLER_BUFFER *buffer);
+  int dsmrr_next(KEY_MULTI_RANGE **found_range_p);
+  bool dsmrr_info(uint keynr, ha_rows rows, uint *bufsz, ha_rows *buf_rows);
+  void dsmrr_close();
+  void reset();
+private:
+  /* The handler which owns this object, used for the rnd_pos() calls */
+  handler *h;
+  /* Clone of h used to scan the index, created on first use */
+  handler *h2;
+
+  /* Buffer of {rowid, range} pairs */
+  uchar *rowids_buf;
+  uchar *rowids_buf_cur;   /* Current position when reading/writing */
+  uchar *rowids_buf_last;  /* When reading: end of used buffer space */
+  uchar *rowids_buf_end;   /* End of the buffer */
+  uint rowid_length;       /* Length of one buffer element */
+
+  /* Ranges of the current scan, until it has been started on h2 */
+  KEY_MULTI_RANGE *ranges_start;
+  uint ranges_count;
+
+  bool use_default_impl;   /* TRUE <=> the ranges are read by h itself */
+  bool dsmrr_eof;          /* TRUE <=> the index scan is exhausted */
+
+  bool can_read_in_rowid_order(uint keynr);
+  int dsmrr_fill_buffer();
 };
 
 
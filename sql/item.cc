@@ -604,7 +604,8 @@ Item_ident::Item_ident(Name_resolution_context *context_arg,
 
 Item_ident::Item_ident(TABLE_LIST *view_arg, const char *field_name_arg)
   :orig_db_name(NullS), orig_table_name(view_arg->table_name),
-   orig_field_name(field_name_arg), context(&view_arg->view->select_lex.context),
+   orig_field_name(field_name_arg),
+   context(&view_arg->get_single_select()->context),
    db_name(NullS), table_name(view_arg->alias),
    field_name(field_name_arg),
    alias_name_used(FALSE), cached_field_index(NO_CACHED_FIELD_INDEX),
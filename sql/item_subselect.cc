@@ -39,6 +39,8 @@
 #include "sql_select.h"
 #include "sql_parse.h"                          // check_stack_overrun
 #include "sql_test.h"
+#include "sql_derived.h"                        // mysql_derived_materialize
+#include <myisam.h>                             // MI_MAX_KEY_LENGTH
 
 inline Item * and_items(Item* cond, Item *item)
 {
@@ -683,7 +685,7 @@ bool Item_in_subselect::test_limit(st_select_lex_unit *unit_arg)
 
 Item_in_subselect::Item_in_subselect(Item * left_exp,
 				     st_select_lex *select_lex):
-  Item_exists_subselect(), optimizer(0), transformed(0),
+  Item_exists_subselect(), optimizer(0), transformed(0), materialized(0),
   pushed_cond_guards(NULL), upper_item(0)
 {
   DBUG_ENTER("Item_in_subselect::Item_in_subselect");
@@ -726,6 +728,19 @@ void Item_exists_subselect::fix_length_and_dec()
   unit->global_parameters->select_limit= new Item_int((int32) 1);
 }
 
+void Item_in_subselect::fix_length_and_dec()
+{
+  if (!materialized)
+  {
+    Item_exists_subselect::fix_length_and_dec();
+    return;
+  }
+  /* A materialized subquery must produce all its rows: no LIMIT 1 */
+  decimals= 0;
+  max_length= 1;
+  max_columns= engine->cols();
+}
+
 double Item_exists_subselect::val_real()
 {
   DBUG_ASSERT(fixed == 1);
@@ -1537,6 +1552,190 @@ Item_in_subselect::row_value_transformer(JOIN *join)
 }
 
 
+/**
+  Check if both sides of one column of an IN predicate compare the same
+  way as their images in the materialized temporary table do.
+
+  @param outer  column of the left expression
+  @param inner  column of the subquery select list
+*/
+
+static bool types_allow_materialization(Item *outer, Item *inner)
+{
+  Field *outer_field= ((Item_field *) outer)->field;
+  Field *inner_field= ((Item_field *) inner)->field;
+
+  if (outer->result_type() != inner->result_type() ||
+      (inner_field->flags & BLOB_FLAG) ||
+      inner->max_length >= CONVERT_IF_BIGGER_TO_BLOB)
+    return FALSE;
+
+  for (uint i= 0; i < 2; i++)
+  {
+    switch ((i ? outer_field : inner_field)->real_type()) {
+    case MYSQL_TYPE_BIT:
+    case MYSQL_TYPE_ENUM:
+    case MYSQL_TYPE_SET:
+    case MYSQL_TYPE_YEAR:
+    case MYSQL_TYPE_GEOMETRY:
+      return FALSE;
+    default:
+      break;
+    }
+  }
+
+  switch (inner->result_type()) {
+  case INT_RESULT:
+  case DECIMAL_RESULT:
+    return TRUE;
+  case STRING_RESULT:
+    if (outer->collation.collation != inner->collation.collation)
+      return FALSE;
+    /* Temporal values are compared as such, not as strings */
+    if (outer->is_datetime() || inner->is_datetime() ||
+        outer->field_type() == MYSQL_TYPE_TIME ||
+        inner->field_type() == MYSQL_TYPE_TIME)
+      return outer->field_type() == inner->field_type();
+    return TRUE;
+  default:
+    /* REAL_RESULT may be compared with a precision tolerance */
+    return FALSE;
+  }
+}
+
+
+/**
+  Decide whether an IN subquery is executed by materialization.
+
+  Materialization is possible for an uncorrelated and deterministic
+  subquery without UNION whose select list consists of columns that
+  compare with the columns of the left expression the same way their
+  copies in a temporary table do. With more than one column, no column
+  on either side may be NULL.
+
+  The choice against the IN->EXISTS transformation is cost based. EXISTS
+  executes the subquery once per outer row, which is a single index
+  lookup if the subquery selects the first column of an index of its
+  only table, and a read of all subquery rows otherwise. Materialization
+  reads the subquery rows once and then does one temporary table lookup
+  per outer row, which is costed like a comparison.
+
+  @param join  JOIN of the subquery
+
+  @retval TRUE   Materialize the subquery
+  @retval FALSE  Use IN->EXISTS
+*/
+
+bool Item_in_subselect::use_materialization(JOIN *join)
+{
+  SELECT_LEX *select_lex= join->select_lex;
+  SELECT_LEX *outer_select= select_lex->outer_select();
+  List_iterator_fast<Item> it(select_lex->item_list);
+  uint cols_num= left_expr->cols();
+  uint key_length= 1;                           // null flags
+  double inner_rows= 1.0, outer_rows= 1.0;
+  double exists_cost, materialize_cost;
+  bool index_lookup;
+  Item *inner;
+  DBUG_ENTER("Item_in_subselect::use_materialization");
+
+  if (!optimizer_flag(thd, OPTIMIZER_SWITCH_MATERIALIZATION) ||
+      substype() != IN_SUBS ||
+      select_lex->master_unit()->is_union() ||
+      select_lex->master_unit()->uncacheable || select_lex->uncacheable ||
+      !select_lex->leaf_tables ||
+      select_lex->item_list.elements != cols_num ||
+      cols_num >= MI_MAX_KEY_SEG ||
+      left_expr->const_item())
+    DBUG_RETURN(FALSE);
+
+  for (uint i= 0; (inner= it++); i++)
+  {
+    Item *outer= left_expr->element_index(i);
+    if (outer->real_item()->type() != Item::FIELD_ITEM ||
+        inner->real_item()->type() != Item::FIELD_ITEM ||
+        !types_allow_materialization(outer->real_item(), inner->real_item()))
+      DBUG_RETURN(FALSE);
+    if (cols_num > 1 && (outer->maybe_null || inner->maybe_null))
+      DBUG_RETURN(FALSE);
+    key_length+= inner->max_length + HA_KEY_BLOB_LENGTH;
+  }
+  if (key_length >= MI_MAX_KEY_LENGTH)
+    DBUG_RETURN(FALSE);
+
+  for (TABLE_LIST *tl= select_lex->leaf_tables; tl; tl= tl->next_leaf)
+  {
+    tl->table->file->info(HA_STATUS_VARIABLE | HA_STATUS_NO_LOCK);
+    inner_rows*= max(rows2double(tl->table->file->stats.records), 1.0);
+  }
+  for (TABLE_LIST *tl= outer_select->leaf_tables; tl; tl= tl->next_leaf)
+  {
+    tl->table->file->info(HA_STATUS_VARIABLE | HA_STATUS_NO_LOCK);
+    outer_rows*= max(rows2double(tl->table->file->stats.records), 1.0);
+  }
+
+  inner= select_lex->item_list.head()->real_item();
+  index_lookup= (cols_num == 1 && !select_lex->leaf_tables->next_leaf &&
+                 !join->having && !select_lex->with_sum_func &&
+                 !select_lex->group_list.elements &&
+                 !((Item_field *) inner)->field->key_start.is_clear_all());
+
+  exists_cost= outer_rows * (index_lookup ? 1.0 : inner_rows);
+  materialize_cost= inner_rows + outer_rows / TIME_FOR_COMPARE;
+  DBUG_PRINT("info", ("exists cost: %g  materialization cost: %g",
+                      exists_cost, materialize_cost));
+  DBUG_RETURN(materialize_cost < exists_cost);
+}
+
+
+/**
+  Set up execution of an IN subquery by materialization.
+
+  Unlike the IN->EXISTS transformations nothing is injected into the
+  subquery: it stays uncorrelated, is executed once with its result
+  redirected to a select_materialize_subselect, and is evaluated by a
+  subselect_materialize_engine wrapping its original engine. The engine
+  is created in the statement arena and is kept for re-executions.
+
+  @param join  JOIN of the subquery
+
+  @retval RES_OK     OK
+  @retval RES_ERROR  Error
+*/
+
+Item_subselect::trans_res
+Item_in_subselect::materialize_transformer(JOIN *join)
+{
+  SELECT_LEX *current= thd->lex->current_select;
+  select_materialize_subselect *mat_result;
+  subselect_materialize_engine *mat_engine;
+  DBUG_ENTER("Item_in_subselect::materialize_transformer");
+
+  substitution= optimizer;
+  thd->lex->current_select= current->return_after_parsing();
+  //optimizer never use Item **ref => we can pass 0 as parameter
+  if (!optimizer || optimizer->fix_left(thd, 0))
+  {
+    thd->lex->current_select= current;
+    DBUG_RETURN(RES_ERROR);
+  }
+  thd->lex->current_select= current;
+
+  /* We will refer to upper level cache array => we have to save it for SP */
+  optimizer->keep_top_level_cache();
+
+  if (!(mat_result= new select_materialize_subselect(this)) ||
+      !(mat_engine= new subselect_materialize_engine(engine, join->select_lex,
+                                                     mat_result, this)) ||
+      engine->change_result(this, mat_result))
+    DBUG_RETURN(RES_ERROR);
+  mat_engine->set_thd(thd);
+  engine= mat_engine;
+  materialized= TRUE;
+  DBUG_RETURN(RES_OK);
+}
+
+
 Item_subselect::trans_res
 Item_in_subselect::select_transformer(JOIN *join)
 {
@@ -1631,7 +1830,9 @@ Item_in_subselect::select_in_like_transformer(JOIN *join, Comp_creator *func)
     of Item, we have to call fix_fields() for it only with original arena to
     avoid memory leack)
   */
-  if (left_expr->cols() == 1)
+  if (func == &eq_creator && use_materialization(join))
+    res= materialize_transformer(join);
+  else if (left_expr->cols() == 1)
     res= single_value_transformer(join, func);
   else
   {
@@ -1655,7 +1856,12 @@ err:
 
 void Item_in_subselect::print(String *str, enum_query_type query_type)
 {
-  if (transformed)
+  if (materialized)
+  {
+    left_expr->print(str, query_type);
+    str->append(STRING_WITH_LEN(" in <materialize>"));
+  }
+  else if (transformed)
     str->append(STRING_WITH_LEN("<exists>"));
   else
   {
@@ -2359,6 +2565,10 @@ int subselect_indexsubquery_engine::exec()
   bool null_finding= 0;
   TABLE *table= tab->table;
 
+  /* The index may be one that generate_derived_keys() added */
+  if (table->materialize_pending &&
+      mysql_derived_materialize(thd, table->pos_in_table_list))
+    DBUG_RETURN(1);
   ((Item_in_subselect *) item)->value= 0;
   empty_result_set= TRUE;
   null_keypart= 0;
@@ -2695,3 +2905,250 @@ bool subselect_uniquesubquery_engine::no_tables()
   /* returning value is correct, but this method should never be called */
   return 0;
 }
+
+
+subselect_materialize_engine::~subselect_materialize_engine()
+{
+  delete materialize_engine;
+}
+
+
+select_materialize_subselect *subselect_materialize_engine::materialize_result()
+{
+  return (select_materialize_subselect *) result;
+}
+
+
+void subselect_materialize_engine::cleanup()
+{
+  DBUG_ENTER("subselect_materialize_engine::cleanup");
+  is_materialized= FALSE;
+  key_fields= 0;
+  key_buff= 0;
+  /* Frees the temporary table through select_materialize_subselect */
+  materialize_engine->cleanup();
+  DBUG_VOID_RETURN;
+}
+
+
+int subselect_materialize_engine::prepare()
+{
+  materialize_engine->set_thd(thd);
+  return materialize_engine->prepare();
+}
+
+
+/**
+  Execute the subquery, store its rows in the temporary table and set
+  up the search tuple for the index lookups done by exec().
+
+  The search tuple has the layout of the unique key over all columns of
+  the table. Its first part may be the null flags of the row which are
+  the same for all rows, as all columns are NOT NULL.
+
+  @retval FALSE  OK
+  @retval TRUE   Error
+*/
+
+bool subselect_materialize_engine::materialize()
+{
+  select_materialize_subselect *mat_result= materialize_result();
+  TABLE *table;
+  KEY *key_info;
+  KEY_PART_INFO *key_part;
+  uchar *key_pos;
+  uint ncols= cols();
+  int error;
+  DBUG_ENTER("subselect_materialize_engine::materialize");
+
+  if (!mat_result->table &&
+      mat_result->create_result_table(thd, &select_lex->item_list))
+    DBUG_RETURN(TRUE);
+  if (materialize_engine->exec())
+    DBUG_RETURN(TRUE);
+
+  /* The table may have been converted from HEAP to MyISAM */
+  table= mat_result->table;
+  DBUG_ASSERT(table->s->keys == 1);
+  key_info= table->key_info;
+  key_part= key_info->key_part;
+  if (!(key_buff= (uchar *) thd->calloc(key_info->key_length +
+                                        ncols * HA_KEY_BLOB_LENGTH)) ||
+      !(key_fields= (Field **) thd->alloc(ncols * sizeof(Field *))))
+    DBUG_RETURN(TRUE);
+
+  key_pos= key_buff;
+  if (key_info->key_parts > ncols)
+  {
+    memcpy(key_pos, table->record[0] + key_part->offset, key_part->length);
+    key_pos+= key_part->length;
+    key_part++;
+  }
+  for (uint i= 0; i < ncols; i++, key_part++)
+  {
+    if (!(key_fields[i]= key_part->field->new_key_field(thd->mem_root, table,
+                                                        key_pos, 0, 0)))
+      DBUG_RETURN(TRUE);
+    key_pos+= key_part->length;
+    if (key_part->field->type() == MYSQL_TYPE_VARCHAR)
+      key_pos+= HA_KEY_BLOB_LENGTH;
+  }
+
+  if ((error= table->file->ha_index_init(0, 0)))
+  {
+    (void) report_error(table, error);
+    DBUG_RETURN(TRUE);
+  }
+  is_materialized= TRUE;
+  DBUG_RETURN(FALSE);
+}
+
+
+/**
+  Check that a value stored in a search tuple field is still equal to
+  the original value, i.e. that it was not truncated or converted.
+*/
+
+static bool stored_value_matches(Field *field, Item *value)
+{
+  switch (value->result_type()) {
+  case INT_RESULT:
+  {
+    longlong nr= value->val_int();
+    return (nr == field->val_int() &&
+            (nr >= 0 ||
+             test(value->unsigned_flag) == test(field->flags & UNSIGNED_FLAG)));
+  }
+  case DECIMAL_RESULT:
+  {
+    my_decimal value_buff, field_buff;
+    return !my_decimal_cmp(value->val_decimal(&value_buff),
+                           field->val_decimal(&field_buff));
+  }
+  case STRING_RESULT:
+  {
+    char value_buff[MAX_FIELD_WIDTH], field_buff[MAX_FIELD_WIDTH];
+    String value_str(value_buff, sizeof(value_buff), field->charset());
+    String field_str(field_buff, sizeof(field_buff), field->charset());
+    String *res= value->val_str(&value_str);
+    return !sortcmp(res, field->val_str(&field_str), field->charset());
+  }
+  default:
+    return FALSE;
+  }
+}
+
+
+/**
+  Store the current value of the left expression in the search tuple.
+
+  @retval FALSE  OK
+  @retval TRUE   A value cannot be stored in the column type of the
+                 temporary table unchanged, so there is no match
+*/
+
+bool subselect_materialize_engine::copy_left_expr()
+{
+  Item_cache *cache= *((Item_in_subselect *) item)->optimizer->get_cache();
+  enum_check_fields save_count_cuted_fields= thd->count_cuted_fields;
+  ulonglong save_sql_mode= thd->variables.sql_mode;
+  bool res= FALSE;
+
+  thd->count_cuted_fields= CHECK_FIELD_IGNORE;
+  thd->variables.sql_mode&= ~(MODE_NO_ZERO_IN_DATE | MODE_NO_ZERO_DATE);
+  for (uint i= 0; i < cols() && !res; i++)
+  {
+    Item *value= cache->element_index(i);
+    res= (value->save_in_field(key_fields[i], 1) < 0 ||
+          !stored_value_matches(key_fields[i], value));
+  }
+  thd->count_cuted_fields= save_count_cuted_fields;
+  thd->variables.sql_mode= save_sql_mode;
+  return res;
+}
+
+
+/*
+  Evaluate the IN predicate with a lookup in the materialized subquery
+
+  SYNOPSIS
+    subselect_materialize_engine::exec()
+
+  DESCRIPTION
+    Materialize the subquery on the first call, then look up the current
+    value of the left expression in the unique index of the temporary
+    table. Without a match the result is NULL if the subquery produced
+    a row with a NULL (single column only, see
+    Item_in_subselect::use_materialization()).
+
+    If the left expression is NULL, Item_in_optimizer only needs to know
+    whether the subquery produced any rows, which no_rows() tells.
+
+  RETURN
+    FALSE - OK
+    TRUE  - Error
+*/
+
+int subselect_materialize_engine::exec()
+{
+  Item_in_subselect *item_in= (Item_in_subselect *) item;
+  select_materialize_subselect *mat_result= materialize_result();
+  DBUG_ENTER("subselect_materialize_engine::exec");
+
+  if (!is_materialized && materialize())
+    DBUG_RETURN(1);
+
+  item_in->value= 0;
+  if (!mat_result->has_rows ||
+      (*item_in->optimizer->get_cache())->null_value)
+    DBUG_RETURN(0);
+
+  if (!copy_left_expr())
+  {
+    TABLE *table= mat_result->table;
+    int error= table->file->index_read_map(table->record[0], key_buff,
+                                           HA_WHOLE_KEY, HA_READ_KEY_EXACT);
+    if (error &&
+        error != HA_ERR_KEY_NOT_FOUND && error != HA_ERR_END_OF_FILE)
+    {
+      (void) report_error(table, error);
+      DBUG_RETURN(1);
+    }
+    item_in->value= !error;
+  }
+  item_in->was_null= !item_in->value && mat_result->has_null_row;
+  DBUG_RETURN(0);
+}
+
+
+bool subselect_materialize_engine::no_rows()
+{
+  return !materialize_result()->has_rows;
+}
+
+
+void subselect_materialize_engine::print(String *str,
+                                         enum_query_type query_type)
+{
+  materialize_engine->print(str, query_type);
+}
+
+
+/**
+  change select_result emulation, never should be called.
+
+  @param si		new subselect Item
+  @param res		new select_result object
+
+  @retval
+    FALSE OK
+  @retval
+    TRUE  error
+*/
+
+bool subselect_materialize_engine::change_result(Item_subselect *si,
+                                               select_subselect *res)
+{
+  DBUG_ASSERT(0);
+  return TRUE;
+}
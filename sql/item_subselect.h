@@ -26,6 +26,7 @@ class st_select_lex;
 class st_select_lex_unit;
 class JOIN;
 class select_subselect;
+class select_materialize_subselect;
 class subselect_engine;
 class Item_bool_func2;
 class Comp_creator;
@@ -252,6 +253,7 @@ public:
   friend class select_exists_subselect;
   friend class subselect_uniquesubquery_engine;
   friend class subselect_indexsubquery_engine;
+  friend class subselect_materialize_engine;
 };
 
 
@@ -282,6 +284,8 @@ protected:
   bool was_null;
   bool abort_on_null;
   bool transformed;
+  /* TRUE <=> subquery is evaluated by subselect_materialize_engine */
+  bool materialized;
 public:
   /* Used to trigger on/off conditions that were pushed down to subselect */
   bool *pushed_cond_guards;
@@ -302,7 +306,7 @@ public:
   Item_in_subselect(Item * left_expr, st_select_lex *select_lex);
   Item_in_subselect()
     :Item_exists_subselect(), optimizer(0), abort_on_null(0), transformed(0),
-     pushed_cond_guards(NULL), upper_item(0)
+     materialized(0), pushed_cond_guards(NULL), upper_item(0)
   {}
 
   subs_type substype() { return IN_SUBS; }
@@ -316,6 +320,8 @@ public:
   trans_res select_in_like_transformer(JOIN *join, Comp_creator *func);
   trans_res single_value_transformer(JOIN *join, Comp_creator *func);
   trans_res row_value_transformer(JOIN * join);
+  bool use_materialization(JOIN *join);
+  trans_res materialize_transformer(JOIN *join);
   longlong val_int();
   double val_real();
   String *val_str(String*);
@@ -325,12 +331,14 @@ public:
   void top_level_item() { abort_on_null=1; }
   inline bool is_top_level_item() { return abort_on_null; }
   bool test_limit(st_select_lex_unit *unit);
+  void fix_length_and_dec();
   virtual void print(String *str, enum_query_type query_type);
   bool fix_fields(THD *thd, Item **ref);
 
   friend class Item_ref_null_helper;
   friend class Item_is_not_null_test;
   friend class subselect_indexsubquery_engine;
+  friend class subselect_materialize_engine;
 };
 
 
@@ -582,6 +590,64 @@ public:
   virtual void print (String *str, enum_query_type query_type);
 };
 
+
+/*
+  A subquery execution engine that evaluates an uncorrelated subquery
+
+    (oe1, .. oeN) IN (SELECT ie1, .. ieN FROM ... WHERE subq_where)
+
+  by executing it once, storing the distinct rows in a temporary table
+  with a unique index over all columns (HEAP, unless it gets too big),
+  and then answering every evaluation of the predicate with one index
+  lookup.
+
+  The engine that executes the subquery is kept in materialize_engine;
+  its result is redirected to a select_materialize_subselect.
+*/
+
+class subselect_materialize_engine: public subselect_engine
+{
+  subselect_engine *materialize_engine; /* engine filling the table */
+  st_select_lex *select_lex;            /* the materialized select */
+  Field **key_fields;                   /* key parts of the search tuple */
+  uchar *key_buff;                      /* search tuple */
+  bool is_materialized;
+
+  select_materialize_subselect *materialize_result();
+  bool materialize();
+  bool copy_left_expr();
+public:
+  subselect_materialize_engine(subselect_engine *engine_arg,
+                               st_select_lex *select,
+                               select_subselect *result_arg,
+                               Item_subselect *item_arg)
+    :subselect_engine(item_arg, result_arg), materialize_engine(engine_arg),
+     select_lex(select), key_fields(0), key_buff(0), is_materialized(0)
+  {}
+  ~subselect_materialize_engine();
+  void cleanup();
+  int prepare();
+  void fix_length_and_dec(Item_cache** row)
+  {
+    materialize_engine->fix_length_and_dec(row);
+  }
+  int exec();
+  uint cols() { return materialize_engine->cols(); }
+  uint8 uncacheable() { return materialize_engine->uncacheable(); }
+  void exclude() { materialize_engine->exclude(); }
+  table_map upper_select_const_tables()
+  {
+    return materialize_engine->upper_select_const_tables();
+  }
+  virtual void print (String *str, enum_query_type query_type);
+  bool change_result(Item_subselect *si, select_subselect *result);
+  bool no_tables() { return materialize_engine->no_tables(); }
+  bool may_be_null() { return materialize_engine->may_be_null(); }
+  bool is_executed() const { return is_materialized; }
+  bool no_rows();
+};
+
+
 /*
   This function is actually defined in sql_parse.cc, but it depends on
   chooser_compare_func_creator defined in this file.
@@ -422,6 +422,7 @@ public:
                     ulong *param_ptr_binlog_stmt_cache_disk_use,
                     ulong *param_ptr_binlog_cache_use,
                     ulong *param_ptr_binlog_cache_disk_use)
+    : commit_seq(0), commit_pos(0)
   {
      stmt_cache.set_binlog_cache_info(param_max_binlog_stmt_cache_size,
                                       param_ptr_binlog_stmt_cache_use,
@@ -450,6 +451,15 @@ public:
 
   binlog_cache_data trx_cache;
 
+  /*
+    Position of the last XID transaction written to the binary log in
+    the engine commit order, 0 once engines have committed it. See
+    MYSQL_BIN_LOG::commit_order_wait().
+  */
+  ulonglong commit_seq;
+  /* End of that transaction in the binary log */
+  my_off_t commit_pos;
+
 private:
 
   binlog_cache_mngr& operator=(const binlog_cache_mngr& info);
@@ -2844,7 +2854,8 @@ const char *MYSQL_LOG::generate_name(const char *log_name,
 
 
 MYSQL_BIN_LOG::MYSQL_BIN_LOG(uint *sync_period)
-  :bytes_written(0), prepared_xids(0), file_id(1), open_count(1),
+  :group_commit_queue(0), commit_seq_last(0), commit_seq_done(0),
+   bytes_written(0), prepared_xids(0), file_id(1), open_count(1),
    need_start_event(TRUE),
    sync_period_ptr(sync_period), sync_counter(0),
    is_relay_log(0), signal_cnt(0),
@@ -2875,6 +2886,10 @@ void MYSQL_BIN_LOG::cleanup()
     mysql_mutex_destroy(&LOCK_log);
     mysql_mutex_destroy(&LOCK_index);
     mysql_cond_destroy(&update_cond);
+    mysql_mutex_destroy(&LOCK_group_commit);
+    mysql_cond_destroy(&COND_group_commit);
+    mysql_mutex_destroy(&LOCK_commit_order);
+    mysql_cond_destroy(&COND_commit_order);
   }
   DBUG_VOID_RETURN;
 }
@@ -2896,6 +2911,12 @@ void MYSQL_BIN_LOG::init_pthread_objects()
   MYSQL_LOG::init_pthread_objects();
   mysql_mutex_init(m_key_LOCK_index, &LOCK_index, MY_MUTEX_INIT_SLOW);
   mysql_cond_init(m_key_update_cond, &update_cond, 0);
+  mysql_mutex_init(key_BINLOG_LOCK_group_commit, &LOCK_group_commit,
+                   MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_BINLOG_COND_group_commit, &COND_group_commit, 0);
+  mysql_mutex_init(key_BINLOG_LOCK_commit_order, &LOCK_commit_order,
+                   MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_BINLOG_COND_commit_order, &COND_commit_order, 0);
 }
 
 
@@ -5516,6 +5537,12 @@ bool MYSQL_BIN_LOG::write_incident(THD *thd, bool lock)
     The thing in the cache is always a complete transaction.
   @note
     'cache' needs to be reinitialized after this functions returns.
+  @note
+    Transactions committing at the same time are written as a group:
+    the first thread to queue becomes the leader, and writes the caches
+    of all the threads that queued while it was waiting for LOCK_log,
+    in arrival order, followed by a single flush_and_sync(). The other
+    threads of the group just wait for the leader to finish.
 */
 
 bool MYSQL_BIN_LOG::write(THD *thd, IO_CACHE *cache, Log_event *commit_event,
@@ -5526,98 +5553,306 @@ bool MYSQL_BIN_LOG::write(THD *thd, IO_CACHE *cache, Log_event *commit_event,
   DBUG_ASSERT(is_open());
   if (likely(is_open()))                       // Should always be true
   {
-    bool check_purge;
-    
-    mysql_mutex_lock(&LOCK_log);
-    /*
-      We only bother to write to the binary log if there is anything
-      to write.
-     */
-    if (my_b_tell(cache) > 0)
+    binlog_group_commit_entry entry;
+    bool leader;
+
+    entry.thd= thd;
+    entry.cache= cache;
+    entry.commit_event= commit_event;
+    entry.incident= incident;
+    entry.done= entry.error= FALSE;
+    entry.end_pos= 0;
+    entry.commit_seq= 0;
+
+    mysql_mutex_lock(&LOCK_group_commit);
+    entry.next= group_commit_queue;
+    group_commit_queue= &entry;
+    leader= (entry.next == NULL);
+    if (leader)
+      mysql_mutex_unlock(&LOCK_group_commit);
+    else
     {
-      /*
-        Log "BEGIN" at the beginning of every transaction.  Here, a
-        transaction is either a BEGIN..COMMIT block or a single
-        statement in autocommit mode.
-      */
-      Query_log_event qinfo(thd, STRING_WITH_LEN("BEGIN"), TRUE, FALSE, TRUE, 0);
-      if (qinfo.write(&log_file))
-        goto err;
-      DBUG_EXECUTE_IF("crash_before_writing_xid",
-                      {
-                        if ((write_error= write_cache(cache, false, true)))
-                          DBUG_PRINT("info", ("error writing binlog cache: %d",
-                                               write_error));
-                        DBUG_PRINT("info", ("crashing before writing xid"));
-                        DBUG_SUICIDE();
-                      });
-
-      if ((write_error= write_cache(cache, false, false)))
-        goto err;
+      const char *old_msg;
+      old_msg= thd->enter_cond(&COND_group_commit, &LOCK_group_commit,
+                               "Waiting for binlog group commit");
+      while (!entry.done)
+        mysql_cond_wait(&COND_group_commit, &LOCK_group_commit);
+      thd->exit_cond(old_msg);
+    }
 
-      if (commit_event && commit_event->write(&log_file))
-        goto err;
+    if (leader)
+    {
+      DEBUG_SYNC(thd, "binlog_group_commit_leader");
+      write_group_commit(&entry);
+    }
 
-      if (incident && write_incident(thd, FALSE))
-        goto err;
+    if (entry.error)
+      DBUG_RETURN(1);
 
-      bool synced= 0;
-      if (flush_and_sync(&synced))
-        goto err;
-      DBUG_EXECUTE_IF("half_binlogged_transaction", DBUG_SUICIDE(););
-      if (cache->error)				// Error on read
+    if (entry.commit_seq)
+    {
+      binlog_cache_mngr *const cache_mngr=
+        (binlog_cache_mngr*) thd_get_ha_data(thd, binlog_hton);
+      cache_mngr->commit_seq= entry.commit_seq;
+      cache_mngr->commit_pos= entry.end_pos;
+    }
+  }
+
+  DBUG_RETURN(0);
+}
+
+
+/**
+  Write the transactions queued for group commit, as the leader of the
+  group.
+
+  The group is every thread that queued itself in write() until the
+  leader got LOCK_log. XID transactions are given their position in the
+  engine commit order (see commit_order_wait()) and are counted in
+  prepared_xids, so the binary log is not rotated before they are
+  committed in the engines.
+
+  @param leader  The entry of the calling thread
+*/
+
+void MYSQL_BIN_LOG::write_group_commit(binlog_group_commit_entry *leader)
+{
+  binlog_group_commit_entry *queue, *entry, *next;
+  bool error= FALSE, written= FALSE, synced= FALSE, check_purge= FALSE;
+  long xid_count= 0;
+  DBUG_ENTER("MYSQL_BIN_LOG::write_group_commit");
+
+  mysql_mutex_lock(&LOCK_log);
+
+  /* Threads queueing from now on will form the next group */
+  mysql_mutex_lock(&LOCK_group_commit);
+  queue= group_commit_queue;
+  group_commit_queue= NULL;
+  mysql_mutex_unlock(&LOCK_group_commit);
+
+  /* The queue is in reverse arrival order, put it back in commit order */
+  for (entry= queue, queue= NULL; entry; entry= next)
+  {
+    next= entry->next;
+    entry->next= queue;
+    queue= entry;
+  }
+  DBUG_ASSERT(queue == leader);
+
+  for (entry= queue; entry; entry= entry->next)
+  {
+    /*
+      Once a write failed, the following transactions are not written
+      to keep the binary log consistent.
+    */
+    if (error || write_group_commit_entry(entry))
+    {
+      entry->error= error= TRUE;
+      continue;
+    }
+    if (entry->end_pos)
+      written= TRUE;
+  }
+
+  if (written)
+  {
+    if (flush_and_sync(&synced))
+    {
+      for (entry= queue; entry; entry= entry->next)
+        entry->error= TRUE;
+      error= TRUE;
+    }
+    DBUG_EXECUTE_IF("half_binlogged_transaction", DBUG_SUICIDE(););
+
+    for (entry= queue; entry; entry= entry->next)
+    {
+      if (entry->error || !entry->end_pos)
+        continue;
+      if (entry->cache->error)                 // Error on read
       {
-        sql_print_error(ER(ER_ERROR_ON_READ), cache->file_name, errno);
-        write_error=1;				// Don't give more errors
-        goto err;
+        sql_print_error(ER(ER_ERROR_ON_READ), entry->cache->file_name, errno);
+        write_error=1;                          // Don't give more errors
+        entry->error= error= TRUE;
+        continue;
       }
-
       if (RUN_HOOK(binlog_storage, after_flush,
-                   (thd, log_file_name, log_file.pos_in_file, synced)))
+                   (entry->thd, log_file_name, entry->end_pos, synced)))
       {
         sql_print_error("Failed to run 'after_flush' hooks");
         write_error=1;
-        goto err;
+        entry->error= error= TRUE;
       }
-
-      signal_update();
     }
+    signal_update();
+    binlog_group_commits++;
+  }
 
-    /*
-      if commit_event is Xid_log_event, increase the number of
-      prepared_xids (it's decreasd in ::unlog()). Binlog cannot be rotated
-      if there're prepared xids in it - see the comment in new_file() for
-      an explanation.
-      If the commit_event is not Xid_log_event (then it's a Query_log_event)
-      rotate binlog, if necessary.
-    */
-    if (commit_event && commit_event->get_type_code() == XID_EVENT)
-    {
-      mysql_mutex_lock(&LOCK_prep_xids);
-      prepared_xids++;
-      mysql_mutex_unlock(&LOCK_prep_xids);
-      mysql_mutex_unlock(&LOCK_log);
-    }
-    else
+  /*
+    XID transactions are accounted in prepared_xids (it's decreased in
+    ::unlog()) as the binlog cannot be rotated while there are prepared
+    xids in it, see the comment in new_file(). When the group contains
+    no XID transaction, rotate here if necessary, otherwise it is done
+    by ::unlog().
+  */
+  for (entry= queue; entry; entry= entry->next)
+  {
+    if (!entry->error && entry->commit_event &&
+        entry->commit_event->get_type_code() == XID_EVENT)
     {
-      if (rotate(false, &check_purge))
-        goto err;
-      mysql_mutex_unlock(&LOCK_log);
-      if (check_purge) 
-        purge();
+      entry->commit_seq= ++commit_seq_last;
+      xid_count++;
     }
   }
 
-  DBUG_RETURN(0);
+  if (xid_count)
+  {
+    mysql_mutex_lock(&LOCK_prep_xids);
+    prepared_xids+= xid_count;
+    mysql_mutex_unlock(&LOCK_prep_xids);
+  }
+  else if (!error && rotate(false, &check_purge))
+  {
+    for (entry= queue; entry; entry= entry->next)
+      entry->error= TRUE;
+    error= TRUE;
+  }
 
-err:
-  if (!write_error)
+  if (error && !write_error)
   {
     write_error= 1;
     sql_print_error(ER(ER_ERROR_ON_WRITE), name, errno);
   }
   mysql_mutex_unlock(&LOCK_log);
-  DBUG_RETURN(1);
+
+  /*
+    Wake up the rest of the group. An entry must not be touched once it
+    is marked done, the thread owning it may return at any time.
+  */
+  mysql_mutex_lock(&LOCK_group_commit);
+  for (entry= queue; entry; entry= next)
+  {
+    next= entry->next;
+    if (entry != leader)
+      entry->done= TRUE;
+  }
+  mysql_cond_broadcast(&COND_group_commit);
+  mysql_mutex_unlock(&LOCK_group_commit);
+
+  if (check_purge)
+    purge();
+
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Write one transaction of a commit group to the binary log, without
+  flushing it. Called by the group leader with LOCK_log held.
+
+  @retval FALSE  success
+  @retval TRUE   error
+*/
+
+bool MYSQL_BIN_LOG::write_group_commit_entry(binlog_group_commit_entry *entry)
+{
+  DBUG_ENTER("MYSQL_BIN_LOG::write_group_commit_entry");
+  mysql_mutex_assert_owner(&LOCK_log);
+
+  /*
+    We only bother to write to the binary log if there is anything
+    to write. end_pos stays 0 otherwise.
+  */
+  if (my_b_tell(entry->cache) > 0)
+  {
+    /*
+      Log "BEGIN" at the beginning of every transaction.  Here, a
+      transaction is either a BEGIN..COMMIT block or a single
+      statement in autocommit mode.
+    */
+    Query_log_event qinfo(entry->thd, STRING_WITH_LEN("BEGIN"),
+                          TRUE, FALSE, TRUE, 0);
+    if (qinfo.write(&log_file))
+      DBUG_RETURN(TRUE);
+    DBUG_EXECUTE_IF("crash_before_writing_xid",
+                    {
+                      if ((write_error= write_cache(entry->cache, false, true)))
+                        DBUG_PRINT("info", ("error writing binlog cache: %d",
+                                             write_error));
+                      DBUG_PRINT("info", ("crashing before writing xid"));
+                      DBUG_SUICIDE();
+                    });
+
+    if ((write_error= write_cache(entry->cache, false, false)))
+      DBUG_RETURN(TRUE);
+
+    if (entry->commit_event && entry->commit_event->write(&log_file))
+      DBUG_RETURN(TRUE);
+
+    if (entry->incident && write_incident(entry->thd, FALSE))
+      DBUG_RETURN(TRUE);
+
+    entry->end_pos= my_b_tell(&log_file);
+  }
+  DBUG_RETURN(FALSE);
+}
+
+
+/**
+  Wait until the engines have committed all the XID transactions that
+  were written to the binary log before the last one of a thread.
+
+  Engines that must commit in binary log order (e.g. for a backup to
+  find a consistent binary log position) call this before committing,
+  and commit_order_done() right after, before making the commit durable
+  so that the log writes of a group can still be combined.
+
+  @param thd  The committing thread
+*/
+
+void MYSQL_BIN_LOG::commit_order_wait(THD *thd)
+{
+  binlog_cache_mngr *const cache_mngr=
+    (binlog_cache_mngr*) thd_get_ha_data(thd, binlog_hton);
+  DBUG_ENTER("MYSQL_BIN_LOG::commit_order_wait");
+
+  if (!cache_mngr || !cache_mngr->commit_seq)
+    DBUG_VOID_RETURN;
+
+  mysql_mutex_lock(&LOCK_commit_order);
+  while (commit_seq_done + 1 != cache_mngr->commit_seq)
+    mysql_cond_wait(&COND_commit_order, &LOCK_commit_order);
+  mysql_mutex_unlock(&LOCK_commit_order);
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Let the next XID transaction of the binary log commit in the engines.
+  Waits for the previous ones first if the thread did not call
+  commit_order_wait(). Does nothing if the engines of the thread already
+  called it for its last transaction.
+
+  @param thd  The committing thread
+*/
+
+void MYSQL_BIN_LOG::commit_order_done(THD *thd)
+{
+  binlog_cache_mngr *const cache_mngr=
+    (binlog_cache_mngr*) thd_get_ha_data(thd, binlog_hton);
+  DBUG_ENTER("MYSQL_BIN_LOG::commit_order_done");
+
+  if (!cache_mngr || !cache_mngr->commit_seq)
+    DBUG_VOID_RETURN;
+
+  mysql_mutex_lock(&LOCK_commit_order);
+  while (commit_seq_done + 1 != cache_mngr->commit_seq)
+    mysql_cond_wait(&COND_commit_order, &LOCK_commit_order);
+  commit_seq_done= cache_mngr->commit_seq;
+  mysql_cond_broadcast(&COND_commit_order);
+  mysql_mutex_unlock(&LOCK_commit_order);
+
+  cache_mngr->commit_seq= 0;
+  DBUG_VOID_RETURN;
 }
 
 
@@ -6651,8 +6886,8 @@ void TC_LOG_BINLOG::close()
 }
 
 /**
-  @todo
-  group commit
+  Write the transaction to the binary log, as part of a commit group,
+  see MYSQL_BIN_LOG::write().
 
   @retval
     0    error
@@ -6678,6 +6913,8 @@ int TC_LOG_BINLOG::log_xid(THD *thd, my_xid xid)
 int TC_LOG_BINLOG::unlog(ulong cookie, my_xid xid)
 {
   DBUG_ENTER("TC_LOG_BINLOG::unlog");
+  /* In case no engine of the transaction followed the binlog order */
+  commit_order_done(current_thd);
   mysql_mutex_lock(&LOCK_prep_xids);
   // prepared_xids can be 0 if the transaction had ignorable errors.
   DBUG_ASSERT(prepared_xids >= 0);
@@ -6757,6 +6994,39 @@ ulonglong mysql_bin_log_file_pos(void)
 {
   return (ulonglong) mysql_bin_log.get_log_file()->pos_in_file;
 }
+/**
+  Get the end position in the MySQL binlog of the transaction being
+  committed by a thread.
+  @return byte offset from the beginning of the binlog
+*/
+extern "C"
+ulonglong mysql_bin_log_commit_pos(THD *thd)
+{
+  binlog_cache_mngr *const cache_mngr= opt_bin_log ?
+    (binlog_cache_mngr*) thd_get_ha_data(thd, binlog_hton) : NULL;
+  if (cache_mngr && cache_mngr->commit_seq)
+    return (ulonglong) cache_mngr->commit_pos;
+  return mysql_bin_log_file_pos();
+}
+/**
+  Wait until the transactions written to the binlog before the one
+  being committed by a thread are committed by the engines.
+*/
+extern "C"
+void mysql_bin_log_commit_order_wait(THD *thd)
+{
+  if (opt_bin_log)
+    mysql_bin_log.commit_order_wait(thd);
+}
+/**
+  Let the next transaction of the binlog be committed by the engines.
+*/
+extern "C"
+void mysql_bin_log_commit_order_done(THD *thd)
+{
+  if (opt_bin_log)
+    mysql_bin_log.commit_order_done(thd);
+}
 #endif /* INNODB_COMPATIBILITY_HOOKS */
 
 
@@ -276,6 +276,27 @@ private:
   time_t last_time;
 };
 
+/*
+  A transaction waiting in MYSQL_BIN_LOG::write() for the leader of its
+  commit group to write its cache to the binary log. Lives on the stack
+  of the committing thread.
+*/
+struct binlog_group_commit_entry
+{
+  THD *thd;
+  IO_CACHE *cache;
+  Log_event *commit_event;
+  bool incident;
+  /* Set by the leader once the entry has been written (or failed). */
+  bool done;
+  bool error;
+  /* End of the transaction in the binary log. */
+  my_off_t end_pos;
+  /* Position in the engine commit order, 0 if not an XID transaction. */
+  ulonglong commit_seq;
+  binlog_group_commit_entry *next;
+};
+
 class MYSQL_BIN_LOG: public TC_LOG, private MYSQL_LOG
 {
  private:
@@ -294,6 +315,23 @@ class MYSQL_BIN_LOG: public TC_LOG, private MYSQL_LOG
   mysql_mutex_t LOCK_prep_xids;
   mysql_cond_t  COND_prep_xids;
   mysql_cond_t update_cond;
+  /*
+    Group commit: transactions committing at the same time are queued
+    here, the first one becomes the leader and writes the whole group
+    under LOCK_log with a single flush_and_sync().
+  */
+  mysql_mutex_t LOCK_group_commit;
+  mysql_cond_t COND_group_commit;
+  binlog_group_commit_entry *group_commit_queue;
+  /*
+    Engines commit XID transactions in the order they were written to
+    the binary log: commit_seq_done is the last transaction that went
+    through commit_order_done(), see commit_order_wait().
+  */
+  mysql_mutex_t LOCK_commit_order;
+  mysql_cond_t COND_commit_order;
+  ulonglong commit_seq_last;
+  ulonglong commit_seq_done;
   ulonglong bytes_written;
   IO_CACHE index_file;
   char index_file_name[FN_REFLEN];
@@ -351,6 +389,8 @@ class MYSQL_BIN_LOG: public TC_LOG, private MYSQL_LOG
   */
   int new_file_without_locking();
   int new_file_impl(bool need_lock);
+  void write_group_commit(binlog_group_commit_entry *leader);
+  bool write_group_commit_entry(binlog_group_commit_entry *entry);
 
 public:
   using MYSQL_LOG::generate_name;
@@ -441,6 +481,8 @@ public:
   bool write(Log_event* event_info); // binary log write
   bool write(THD *thd, IO_CACHE *cache, Log_event *commit_event, bool incident);
   bool write_incident(THD *thd, bool lock);
+  void commit_order_wait(THD *thd);
+  void commit_order_done(THD *thd);
 
   int  write_cache(IO_CACHE *cache, bool lock_log, bool flush_and_sync);
   void set_write_error(THD *thd, bool is_transactional);
@@ -8083,6 +8083,13 @@ int Rows_log_event::do_apply_event(Relay_log_info const *rli)
     if (!is_auto_inc_in_extra_columns())
       thd->variables.sql_mode= MODE_NO_AUTO_VALUE_ON_ZERO;
 
+    /*
+      Start from the first row: a worker of the multi-threaded applier
+      applies the event again when it retries the transaction.
+    */
+    m_curr_row= m_rows_buf;
+    m_curr_row_end= NULL;
+
     // row processing loop
 
     /* 
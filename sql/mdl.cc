@@ -17,6 +17,7 @@
 #include "mdl.h"
 #include "debug_sync.h"
 #include <hash.h>
+#include <my_atomic.h>
 #include <mysqld_error.h>
 #include <mysql/plugin.h>
 #include <mysql/service_thd_wait.h>
@@ -27,7 +28,7 @@ static PSI_mutex_key key_MDL_wait_LOCK_wait_status;
 
 static PSI_mutex_info all_mdl_mutexes[]=
 {
-  { &key_MDL_map_mutex, "MDL_map::mutex", PSI_FLAG_GLOBAL},
+  { &key_MDL_map_mutex, "MDL_map::mutex", 0},
   { &key_MDL_wait_LOCK_wait_status, "MDL_wait::LOCK_wait_status", 0}
 };
 
@@ -91,54 +92,7 @@ const char *MDL_key::m_namespace_to_wait_state_name[NAMESPACE_END]=
 static bool mdl_initialized= 0;
 
 
-class MDL_object_lock;
-class MDL_object_lock_cache_adapter;
-
-
-/**
-  A collection of all MDL locks. A singleton,
-  there is only one instance of the map in the server.
-  Maps MDL_key to MDL_lock instances.
-*/
-
-class MDL_map
-{
-public:
-  void init();
-  void destroy();
-  MDL_lock *find_or_insert(const MDL_key *key);
-  void remove(MDL_lock *lock);
-private:
-  bool move_from_hash_to_lock_mutex(MDL_lock *lock);
-private:
-  /** All acquired locks in the server. */
-  HASH m_locks;
-  /* Protects access to m_locks hash. */
-  mysql_mutex_t m_mutex;
-  /**
-    Cache of (unused) MDL_lock objects available for re-use.
-
-    On some systems (e.g. Windows XP) constructing/destructing
-    MDL_lock objects can be fairly expensive. We use this cache
-    to avoid these costs in scenarios in which they can have
-    significant negative effect on performance. For example, when
-    there is only one thread constantly executing statements in
-    auto-commit mode and thus constantly causing creation/
-    destruction of MDL_lock objects for the tables it uses.
-
-    Note that this cache contains only MDL_object_lock objects.
-
-    Protected by m_mutex mutex.
-  */
-  typedef I_P_List<MDL_object_lock, MDL_object_lock_cache_adapter,
-                   I_P_List_counter>
-          Lock_cache;
-  Lock_cache m_unused_locks_cache;
-  /** Pre-allocated MDL_lock object for GLOBAL namespace. */
-  MDL_lock *m_global_lock;
-  /** Pre-allocated MDL_lock object for COMMIT namespace. */
-  MDL_lock *m_commit_lock;
-};
+class MDL_map_partition;
 
 
 /**
@@ -330,6 +284,18 @@ public:
 
   typedef Ticket_list::List::Iterator Ticket_iterator;
 
+  /** Type of m_fast_path_state and of increments for its counters. */
+  typedef int64 fast_path_state_t;
+
+  /** Mask for one counter of unobtrusive locks in m_fast_path_state. */
+  static const fast_path_state_t UNOBTRUSIVE_COUNTER_MASK= (1LL << 20) - 1;
+
+  /**
+    Flag in m_fast_path_state which is set while there are obtrusive
+    locks granted or pending for this lock.
+  */
+  static const fast_path_state_t HAS_OBTRUSIVE= 1LL << 62;
+
 public:
   /** The key of the object (data) being protected. */
   MDL_key key;
@@ -395,6 +361,60 @@ public:
 
   virtual bitmap_t hog_lock_types_bitmap() const = 0;
 
+  /**
+    Get value by which the counter in m_fast_path_state is incremented
+    when lock of the type is acquired on the fast path, 0 if the type
+    is obtrusive and can't be acquired on the fast path.
+  */
+  virtual fast_path_state_t
+  get_unobtrusive_lock_increment(enum_mdl_type type) const = 0;
+  inline static fast_path_state_t
+  get_unobtrusive_lock_increment(const MDL_request *request);
+
+  /** Bitmap of types of locks granted on the fast path. */
+  virtual bitmap_t fast_path_granted_bitmap() const = 0;
+  /** Bitmap of types of locks which can't be acquired on the fast path. */
+  virtual bitmap_t obtrusive_lock_types_bitmap() const = 0;
+
+  fast_path_state_t get_fast_path_state() const
+  {
+    fast_path_state_t state;
+    my_atomic_rwlock_rdlock(&m_fast_path_state_lock);
+    state= my_atomic_load64(&m_fast_path_state);
+    my_atomic_rwlock_rdunlock(&m_fast_path_state_lock);
+    return state;
+  }
+
+  void fast_path_state_add(fast_path_state_t value)
+  {
+    my_atomic_rwlock_wrlock(&m_fast_path_state_lock);
+    my_atomic_add64(&m_fast_path_state, value);
+    my_atomic_rwlock_wrunlock(&m_fast_path_state_lock);
+  }
+
+  bool fast_path_state_cas(fast_path_state_t *old_state,
+                           fast_path_state_t new_state)
+  {
+    bool result;
+    my_atomic_rwlock_wrlock(&m_fast_path_state_lock);
+    result= my_atomic_cas64(&m_fast_path_state, old_state, new_state);
+    my_atomic_rwlock_wrunlock(&m_fast_path_state_lock);
+    return result;
+  }
+
+  bool try_acquire_on_fast_path(fast_path_state_t increment);
+  void remove_fast_path_lock(fast_path_state_t increment);
+
+  void set_has_obtrusive();
+  void update_has_obtrusive();
+
+  /** TRUE for pre-allocated objects for GLOBAL and COMMIT namespaces. */
+  bool is_singleton() const
+  {
+    return (key.mdl_namespace() == MDL_key::GLOBAL ||
+            key.mdl_namespace() == MDL_key::COMMIT);
+  }
+
   /** List of granted tickets for this lock. */
   Ticket_list m_granted;
   /** Tickets for contexts waiting to acquire a lock. */
@@ -406,21 +426,60 @@ public:
   */
   ulong m_hog_lock_count;
 
+  /**
+    State of the fast path for this lock.
+
+    Locks of "unobtrusive" types, i.e. types which are compatible with
+    each other and are requested by every DML statement, are normally
+    acquired on the fast path. Such a lock is not represented by a
+    ticket in m_granted list. Instead, the counter for its type packed
+    in this member is atomically incremented without acquiring m_rwlock.
+    Descendant classes define which types are unobtrusive and the layout
+    of counters, see get_unobtrusive_lock_increment().
+
+    The HAS_OBTRUSIVE flag is set while there are tickets of other,
+    "obtrusive" types in m_granted or m_waiting lists, or while the
+    thread holding m_rwlock processes a request for such a lock. The
+    flag is changed only under protection of m_rwlock. While it is set
+    locks are not acquired on the fast path, and locks acquired on the
+    fast path are released under protection of m_rwlock so waiters can
+    be rescheduled.
+
+    Counters are incremented only while holding the m_mutex of the
+    MDL_map_partition containing this object (pre-allocated objects for
+    GLOBAL and COMMIT namespaces are never removed, so this doesn't
+    apply to them). Counters are decremented to zero only while holding
+    m_rwlock. So once both locks are held, the value of zero can't
+    change. This is what allows to remove object from the hash safely.
+  */
+  mutable volatile fast_path_state_t m_fast_path_state;
+  mutable my_atomic_rwlock_t m_fast_path_state_lock;
+
+  /**
+    Partition of MDL_map containing this object, NULL for pre-allocated
+    objects for GLOBAL and COMMIT namespaces.
+  */
+  MDL_map_partition *m_map_part;
+
 public:
 
   MDL_lock(const MDL_key *key_arg)
   : key(key_arg),
     m_hog_lock_count(0),
+    m_fast_path_state(0),
+    m_map_part(NULL),
     m_ref_usage(0),
     m_ref_release(0),
     m_is_destroyed(FALSE),
     m_version(0)
   {
     mysql_prlock_init(key_MDL_lock_rwlock, &m_rwlock);
+    my_atomic_rwlock_init(&m_fast_path_state_lock);
   }
 
   virtual ~MDL_lock()
   {
+    my_atomic_rwlock_destroy(&m_fast_path_state_lock);
     mysql_prlock_destroy(&m_rwlock);
   }
   inline static void destroy(MDL_lock *lock);
@@ -504,6 +563,27 @@ public:
     return 0;
   }
 
+  /*
+    Only IX locks are unobtrusive. Their counter occupies the lowest
+    bits of m_fast_path_state.
+  */
+  virtual fast_path_state_t
+  get_unobtrusive_lock_increment(enum_mdl_type type) const
+  {
+    return m_unobtrusive_lock_increment[type];
+  }
+  virtual bitmap_t fast_path_granted_bitmap() const
+  {
+    return (get_fast_path_state() & UNOBTRUSIVE_COUNTER_MASK) ?
+           MDL_BIT(MDL_INTENTION_EXCLUSIVE) : 0;
+  }
+  virtual bitmap_t obtrusive_lock_types_bitmap() const
+  {
+    return MDL_BIT(MDL_SHARED) | MDL_BIT(MDL_EXCLUSIVE);
+  }
+
+  static const fast_path_state_t m_unobtrusive_lock_increment[MDL_TYPE_END];
+
 private:
   static const bitmap_t m_granted_incompatible[MDL_TYPE_END];
   static const bitmap_t m_waiting_incompatible[MDL_TYPE_END];
@@ -534,6 +614,8 @@ public:
     DBUG_ASSERT(is_empty());
     /* Object should not be marked as destroyed. */
     DBUG_ASSERT(! m_is_destroyed);
+    /* Nor it should be acquired on the fast path. */
+    DBUG_ASSERT(get_fast_path_state() == 0);
     /*
       Values of the rest of the fields should be preserved between old and
       new versions of the object. E.g., m_version and m_ref_usage/release
@@ -568,6 +650,39 @@ public:
             MDL_BIT(MDL_EXCLUSIVE));
   }
 
+  /*
+    S, SH, SR and SW locks are unobtrusive. m_fast_path_state contains
+    counters for S and SH locks (shared, as these types are equivalent
+    from the point of view of other requests), SR and SW locks, 20 bits
+    each, starting from the lowest bits.
+  */
+  virtual fast_path_state_t
+  get_unobtrusive_lock_increment(enum_mdl_type type) const
+  {
+    return m_unobtrusive_lock_increment[type];
+  }
+  virtual bitmap_t fast_path_granted_bitmap() const
+  {
+    fast_path_state_t state= get_fast_path_state();
+    bitmap_t result= 0;
+
+    if (state & UNOBTRUSIVE_COUNTER_MASK)
+      result|= MDL_BIT(MDL_SHARED) | MDL_BIT(MDL_SHARED_HIGH_PRIO);
+    if (state & (UNOBTRUSIVE_COUNTER_MASK << 20))
+      result|= MDL_BIT(MDL_SHARED_READ);
+    if (state & (UNOBTRUSIVE_COUNTER_MASK << 40))
+      result|= MDL_BIT(MDL_SHARED_WRITE);
+    return result;
+  }
+  virtual bitmap_t obtrusive_lock_types_bitmap() const
+  {
+    return (MDL_BIT(MDL_SHARED_NO_WRITE) |
+            MDL_BIT(MDL_SHARED_NO_READ_WRITE) |
+            MDL_BIT(MDL_EXCLUSIVE));
+  }
+
+  static const fast_path_state_t m_unobtrusive_lock_increment[MDL_TYPE_END];
+
 private:
   static const bitmap_t m_granted_incompatible[MDL_TYPE_END];
   static const bitmap_t m_waiting_incompatible[MDL_TYPE_END];
@@ -588,11 +703,92 @@ class MDL_object_lock_cache_adapter :
 };
 
 
+/**
+  A partition of the collection of all MDL locks. Each partition
+  maps its share of MDL_keys to MDL_lock instances.
+*/
+
+class MDL_map_partition
+{
+public:
+  MDL_map_partition();
+  ~MDL_map_partition();
+  MDL_lock *find_or_insert(const MDL_key *mdl_key,
+                           my_hash_value_type hash_value,
+                           MDL_lock::fast_path_state_t unobtrusive_increment,
+                           bool *is_fast_path);
+  void remove(MDL_lock *lock);
+  my_hash_value_type get_key_hash(const MDL_key *mdl_key) const
+  {
+    return my_calc_hash(&m_locks, mdl_key->ptr(), mdl_key->length());
+  }
+  bool is_empty() const { return m_locks.records == 0; }
+private:
+  bool move_from_hash_to_lock_mutex(MDL_lock *lock);
+private:
+  /** Acquired locks which belong to this partition. */
+  HASH m_locks;
+  /* Protects access to m_locks hash. */
+  mysql_mutex_t m_mutex;
+  /**
+    Cache of (unused) MDL_lock objects available for re-use.
+
+    On some systems (e.g. Windows XP) constructing/destructing
+    MDL_lock objects can be fairly expensive. We use this cache
+    to avoid these costs in scenarios in which they can have
+    significant negative effect on performance. For example, when
+    there is only one thread constantly executing statements in
+    auto-commit mode and thus constantly causing creation/
+    destruction of MDL_lock objects for the tables it uses.
+
+    Note that this cache contains only MDL_object_lock objects.
+
+    Protected by m_mutex mutex.
+  */
+  typedef I_P_List<MDL_object_lock, MDL_object_lock_cache_adapter,
+                   I_P_List_counter>
+          Lock_cache;
+  Lock_cache m_unused_locks_cache;
+};
+
+
+/**
+  A collection of all MDL locks. A singleton,
+  there is only one instance of the map in the server.
+  Contains instances of MDL_map_partition.
+*/
+
+class MDL_map
+{
+public:
+  void init();
+  void destroy();
+  MDL_lock *find_or_insert(const MDL_key *key,
+                           MDL_lock::fast_path_state_t unobtrusive_increment,
+                           bool *is_fast_path);
+  void remove(MDL_lock *lock);
+private:
+  /**
+    Partitions of the map. Having several of them reduces contention
+    on their mutexes when locks on different objects are acquired.
+  */
+  MDL_map_partition *m_partitions;
+  /** Pre-allocated MDL_lock object for GLOBAL namespace. */
+  MDL_lock *m_global_lock;
+  /** Pre-allocated MDL_lock object for COMMIT namespace. */
+  MDL_lock *m_commit_lock;
+};
+
+
 static MDL_map mdl_locks;
 /**
   Start-up parameter for the maximum size of the unused MDL_lock objects cache.
 */
 ulong mdl_locks_cache_size;
+/**
+  Start-up parameter for the number of partitions of the MDL_lock hash.
+*/
+ulong mdl_locks_hash_partitions;
 
 
 extern "C"
@@ -649,33 +845,54 @@ void mdl_destroy()
 }
 
 
-/** Initialize the global hash containing all MDL locks. */
+/** Initialize the container for all MDL locks. */
 
 void MDL_map::init()
 {
   MDL_key global_lock_key(MDL_key::GLOBAL, "", "");
   MDL_key commit_lock_key(MDL_key::COMMIT, "", "");
 
+  m_partitions= new MDL_map_partition[mdl_locks_hash_partitions];
+
+  m_global_lock= MDL_lock::create(&global_lock_key);
+  m_commit_lock= MDL_lock::create(&commit_lock_key);
+}
+
+
+/** Initialize the partition of the container with all MDL locks. */
+
+MDL_map_partition::MDL_map_partition()
+{
   mysql_mutex_init(key_MDL_map_mutex, &m_mutex, NULL);
   my_hash_init(&m_locks, &my_charset_bin, 16 /* FIXME */, 0, 0,
                mdl_locks_key, 0, 0);
-  m_global_lock= MDL_lock::create(&global_lock_key);
-  m_commit_lock= MDL_lock::create(&commit_lock_key);
 }
 
 
 /**
-  Destroy the global hash containing all MDL locks.
+  Destroy the container for all MDL locks.
   @pre It must be empty.
 */
 
 void MDL_map::destroy()
 {
-  DBUG_ASSERT(!m_locks.records);
-  mysql_mutex_destroy(&m_mutex);
-  my_hash_free(&m_locks);
+  delete [] m_partitions;
+
   MDL_lock::destroy(m_global_lock);
   MDL_lock::destroy(m_commit_lock);
+}
+
+
+/**
+  Destroy the partition of the container with all MDL locks.
+  @pre It must be empty.
+*/
+
+MDL_map_partition::~MDL_map_partition()
+{
+  DBUG_ASSERT(is_empty());
+  mysql_mutex_destroy(&m_mutex);
+  my_hash_free(&m_locks);
 
   MDL_object_lock *lock;
   while ((lock= m_unused_locks_cache.pop_front()))
@@ -687,21 +904,35 @@ void MDL_map::destroy()
   Find MDL_lock object corresponding to the key, create it
   if it does not exist.
 
+  @param      mdl_key                Key for the lock.
+  @param      unobtrusive_increment  Increment for the fast path counter
+                                     if the lock should be acquired on
+                                     the fast path, 0 otherwise.
+  @param[out] is_fast_path           Set to TRUE if the lock has been
+                                     acquired on the fast path.
+
   @retval non-NULL - Success. MDL_lock instance for the key with
-                     locked MDL_lock::m_rwlock.
+                     locked MDL_lock::m_rwlock, unless the lock was
+                     acquired on the fast path.
   @retval NULL     - Failure (OOM).
 */
 
-MDL_lock* MDL_map::find_or_insert(const MDL_key *mdl_key)
+MDL_lock* MDL_map::find_or_insert(const MDL_key *mdl_key,
+                                  MDL_lock::fast_path_state_t
+                                    unobtrusive_increment,
+                                  bool *is_fast_path)
 {
   MDL_lock *lock;
   my_hash_value_type hash_value;
+  uint part_id;
+
+  *is_fast_path= FALSE;
 
   if (mdl_key->mdl_namespace() == MDL_key::GLOBAL ||
       mdl_key->mdl_namespace() == MDL_key::COMMIT)
   {
     /*
-      Avoid locking m_mutex when lock for GLOBAL or COMMIT namespace is
+      Avoid locking any m_mutex when lock for GLOBAL or COMMIT namespace is
       requested. Return pointer to pre-allocated MDL_lock instance instead.
       Such an optimization allows to save one mutex lock/unlock for any
       statement changing data.
@@ -714,13 +945,46 @@ MDL_lock* MDL_map::find_or_insert(const MDL_key *mdl_key)
     lock= (mdl_key->mdl_namespace() == MDL_key::GLOBAL) ? m_global_lock :
                                                           m_commit_lock;
 
+    if (unobtrusive_increment &&
+        lock->try_acquire_on_fast_path(unobtrusive_increment))
+    {
+      *is_fast_path= TRUE;
+      return lock;
+    }
+
     mysql_prlock_wrlock(&lock->m_rwlock);
 
     return lock;
   }
 
+  hash_value= m_partitions[0].get_key_hash(mdl_key);
+  /*
+    MDL_map_partition::m_locks uses the lowest bits of the hash value
+    to choose a bucket, so use the higher ones to choose the partition.
+  */
+  part_id= (hash_value >> 16) % mdl_locks_hash_partitions;
+
+  return m_partitions[part_id].find_or_insert(mdl_key, hash_value,
+                                              unobtrusive_increment,
+                                              is_fast_path);
+}
+
+
+/**
+  Find MDL_lock object corresponding to the key and hash value in
+  MDL_map partition, create it if it does not exist.
 
-  hash_value= my_calc_hash(&m_locks, mdl_key->ptr(), mdl_key->length());
+  @sa MDL_map::find_or_insert().
+*/
+
+MDL_lock*
+MDL_map_partition::find_or_insert(const MDL_key *mdl_key,
+                                  my_hash_value_type hash_value,
+                                  MDL_lock::fast_path_state_t
+                                    unobtrusive_increment,
+                                  bool *is_fast_path)
+{
+  MDL_lock *lock;
 
 retry:
   mysql_mutex_lock(&m_mutex);
@@ -754,6 +1018,8 @@ retry:
     else
     {
       lock= MDL_lock::create(mdl_key);
+      if (lock)
+        lock->m_map_part= this;
     }
 
     if (!lock || my_hash_insert(&m_locks, (uchar*)lock))
@@ -776,6 +1042,19 @@ retry:
     }
   }
 
+  /*
+    Holding m_mutex guarantees that the object won't be removed from
+    the hash, so we can simply bump the counter if there are no
+    obtrusive locks.
+  */
+  if (unobtrusive_increment &&
+      lock->try_acquire_on_fast_path(unobtrusive_increment))
+  {
+    mysql_mutex_unlock(&m_mutex);
+    *is_fast_path= TRUE;
+    return lock;
+  }
+
   if (move_from_hash_to_lock_mutex(lock))
     goto retry;
 
@@ -784,16 +1063,16 @@ retry:
 
 
 /**
-  Release mdl_locks.m_mutex mutex and lock MDL_lock::m_rwlock for lock
-  object from the hash. Handle situation when object was released
-  while we held no locks.
+  Release MDL_map_partition::m_mutex mutex and lock MDL_lock::m_rwlock
+  for lock object from the hash. Handle situation when object was
+  released while we held no locks.
 
   @retval FALSE - Success.
   @retval TRUE  - Object was released while we held no mutex, caller
                   should re-try looking up MDL_lock object in the hash.
 */
 
-bool MDL_map::move_from_hash_to_lock_mutex(MDL_lock *lock)
+bool MDL_map_partition::move_from_hash_to_lock_mutex(MDL_lock *lock)
 {
   ulonglong version;
 
@@ -802,8 +1081,8 @@ bool MDL_map::move_from_hash_to_lock_mutex(MDL_lock *lock)
 
   /*
     We increment m_ref_usage which is a reference counter protected by
-    mdl_locks.m_mutex under the condition it is present in the hash and
-    m_is_destroyed is FALSE.
+    MDL_map_partition::m_mutex under the condition it is present in the
+    hash and m_is_destroyed is FALSE.
   */
   lock->m_ref_usage++;
   /* Read value of the version counter under protection of m_mutex lock. */
@@ -860,12 +1139,13 @@ bool MDL_map::move_from_hash_to_lock_mutex(MDL_lock *lock)
   Destroy MDL_lock object or delegate this responsibility to
   whatever thread that holds the last outstanding reference to
   it.
+
+  @note Releases MDL_lock::m_rwlock, which must be locked by caller.
 */
 
 void MDL_map::remove(MDL_lock *lock)
 {
-  if (lock->key.mdl_namespace() == MDL_key::GLOBAL ||
-      lock->key.mdl_namespace() == MDL_key::COMMIT)
+  if (lock->is_singleton())
   {
     /*
       Never destroy pre-allocated MDL_lock objects for GLOBAL and
@@ -875,28 +1155,53 @@ void MDL_map::remove(MDL_lock *lock)
     return;
   }
 
+  lock->m_map_part->remove(lock);
+}
+
+
+/**
+  Destroy MDL_lock object belonging to specific MDL_map partition
+  or delegate this responsibility to whatever thread that holds the
+  last outstanding reference to it.
+*/
+
+void MDL_map_partition::remove(MDL_lock *lock)
+{
   mysql_mutex_lock(&m_mutex);
+
+  if (lock->get_fast_path_state() != 0)
+  {
+    /*
+      The lock is still held by contexts which have acquired it on
+      the fast path. The last of them will remove the object.
+    */
+    mysql_mutex_unlock(&m_mutex);
+    mysql_prlock_unlock(&lock->m_rwlock);
+    return;
+  }
+
   my_hash_delete(&m_locks, (uchar*) lock);
   /*
     To let threads holding references to the MDL_lock object know that it was
     moved to the list of unused objects or destroyed, we increment the version
-    counter under protection of both MDL_map::m_mutex and MDL_lock::m_rwlock
-    locks. This allows us to read the version value while having either one
-    of those locks.
+    counter under protection of both MDL_map_partition::m_mutex and
+    MDL_lock::m_rwlock locks. This allows us to read the version value while
+    having either one of those locks.
   */
   lock->m_version++;
 
   if ((lock->key.mdl_namespace() != MDL_key::SCHEMA) &&
-      (m_unused_locks_cache.elements() < mdl_locks_cache_size))
+      (m_unused_locks_cache.elements() <
+       mdl_locks_cache_size / mdl_locks_hash_partitions))
   {
     /*
       This is an object of MDL_object_lock type and the cache of unused
       objects has not reached its maximum size yet. So instead of destroying
       object we move it to the list of unused objects to allow its later
       re-use with possibly different key. Any threads holding references to
-      this object (owning MDL_map::m_mutex or MDL_lock::m_rwlock) will notice
-      this thanks to the fact that we have changed the MDL_lock::m_version
-      counter.
+      this object (owning MDL_map_partition::m_mutex or MDL_lock::m_rwlock)
+      will notice this thanks to the fact that we have changed the
+      MDL_lock::m_version counter.
     */
     DBUG_ASSERT(lock->key.mdl_namespace() != MDL_key::GLOBAL &&
                 lock->key.mdl_namespace() != MDL_key::COMMIT);
@@ -913,8 +1218,8 @@ void MDL_map::remove(MDL_lock *lock)
       has the responsibility to release it.
 
       Setting of m_is_destroyed to TRUE while holding _both_
-      mdl_locks.m_mutex and MDL_lock::m_rwlock mutexes transfers the
-      protection of m_ref_usage from mdl_locks.m_mutex to
+      MDL_map_partition::m_mutex and MDL_lock::m_rwlock mutexes transfers
+      the protection of m_ref_usage from MDL_map_partition::m_mutex to
       MDL_lock::m_rwlock while removal of the object from the hash
       (and cache of unused objects) makes it read-only. Therefore
       whoever acquires MDL_lock::m_rwlock next will see the most up
@@ -946,6 +1251,7 @@ void MDL_map::remove(MDL_lock *lock)
 MDL_context::MDL_context()
   : m_thd(NULL),
   m_needs_thr_lock_abort(FALSE),
+  m_fast_path_locks_count(0),
   m_waiting_for(NULL)
 {
   mysql_prlock_init(key_MDL_context_LOCK_waiting_for, &m_LOCK_waiting_for);
@@ -1047,6 +1353,29 @@ inline MDL_lock *MDL_lock::create(const MDL_key *mdl_key)
 }
 
 
+/**
+  Get increment for the fast path counter for the lock request,
+  0 if the request can't be satisfied on the fast path.
+
+  @note Chooses an MDL_lock descendant appropriate for object namespace,
+        in the same way as MDL_lock::create().
+*/
+
+inline MDL_lock::fast_path_state_t
+MDL_lock::get_unobtrusive_lock_increment(const MDL_request *request)
+{
+  switch (request->key.mdl_namespace())
+  {
+    case MDL_key::GLOBAL:
+    case MDL_key::SCHEMA:
+    case MDL_key::COMMIT:
+      return MDL_scoped_lock::m_unobtrusive_lock_increment[request->type];
+    default:
+      return MDL_object_lock::m_unobtrusive_lock_increment[request->type];
+  }
+}
+
+
 void MDL_lock::destroy(MDL_lock *lock)
 {
   delete lock;
@@ -1481,6 +1810,18 @@ const MDL_lock::bitmap_t MDL_scoped_lock::m_waiting_incompatible[MDL_TYPE_END] =
 };
 
 
+/**
+  Increments for the fast path counter of the scoped lock.
+  Only IX locks can be acquired on the fast path.
+*/
+
+const MDL_lock::fast_path_state_t
+MDL_scoped_lock::m_unobtrusive_lock_increment[MDL_TYPE_END] =
+{
+  1, 0, 0, 0, 0, 0, 0, 0
+};
+
+
 /**
   Compatibility (or rather "incompatibility") matrices for per-object
   metadata lock. Arrays of bitmaps which elements specify which granted/
@@ -1564,6 +1905,18 @@ MDL_object_lock::m_waiting_incompatible[MDL_TYPE_END] =
 };
 
 
+/**
+  Increments for the fast path counters of the per-object lock.
+  S, SH, SR and SW locks can be acquired on the fast path.
+*/
+
+const MDL_lock::fast_path_state_t
+MDL_object_lock::m_unobtrusive_lock_increment[MDL_TYPE_END] =
+{
+  0, 1, 1, 1LL << 20, 1LL << 40, 0, 0, 0
+};
+
+
 /**
   Check if request for the metadata lock can be satisfied given its
   current state.
@@ -1598,7 +1951,14 @@ MDL_lock::can_grant_lock(enum_mdl_type type_arg,
   */
   if (ignore_lock_priority || !(m_waiting.bitmap() & waiting_incompat_map))
   {
-    if (! (m_granted.bitmap() & granted_incompat_map))
+    /*
+      Locks acquired on the fast path belong to other contexts, as
+      contexts materialize their own such locks before taking the
+      slow path, see MDL_context::try_acquire_lock_impl().
+    */
+    if (fast_path_granted_bitmap() & granted_incompat_map)
+      can_grant= FALSE;
+    else if (! (m_granted.bitmap() & granted_incompat_map))
       can_grant= TRUE;
     else
     {
@@ -1626,6 +1986,7 @@ void MDL_lock::remove_ticket(Ticket_list MDL_lock::*list, MDL_ticket *ticket)
 {
   mysql_prlock_wrlock(&m_rwlock);
   (this->*list).remove_ticket(ticket);
+  update_has_obtrusive();
   if (is_empty())
     mdl_locks.remove(this);
   else
@@ -1650,6 +2011,101 @@ void MDL_lock::remove_ticket(Ticket_list MDL_lock::*list, MDL_ticket *ticket)
 }
 
 
+/**
+  Try to acquire lock on the fast path, i.e. by incrementing the counter
+  in m_fast_path_state, which is possible if there are no obtrusive locks.
+
+  @param increment  Increment for the counter for requested lock type.
+
+  @note The caller must ensure that the object can't be removed from
+        the hash concurrently, e.g. by holding MDL_map_partition::m_mutex.
+
+  @retval TRUE   The lock has been acquired.
+  @retval FALSE  There are obtrusive locks, the slow path has to be taken.
+*/
+
+bool MDL_lock::try_acquire_on_fast_path(fast_path_state_t increment)
+{
+  fast_path_state_t old_state= get_fast_path_state();
+
+  do
+  {
+    if (old_state & HAS_OBTRUSIVE)
+      return FALSE;
+  } while (! fast_path_state_cas(&old_state, old_state + increment));
+
+  return TRUE;
+}
+
+
+/**
+  Release lock which has been acquired on the fast path.
+
+  @param increment  Increment which was used for the counter for
+                    the lock type when the lock was acquired.
+*/
+
+void MDL_lock::remove_fast_path_lock(fast_path_state_t increment)
+{
+  fast_path_state_t old_state= get_fast_path_state();
+
+  do
+  {
+    if ((old_state & HAS_OBTRUSIVE) ||
+        (old_state == increment && ! is_singleton()))
+    {
+      /*
+        Either there are obtrusive locks and some of the waiting requests
+        might be satisfied once we release our lock, or it is the last
+        lock on the object and the object has to be removed from the hash.
+        In both cases counter has to be decremented under protection of
+        m_rwlock. Our lock keeps the object alive until we acquire it.
+      */
+      mysql_prlock_wrlock(&m_rwlock);
+      fast_path_state_add(-increment);
+      if (is_empty() && get_fast_path_state() == 0)
+        mdl_locks.remove(this);
+      else
+      {
+        reschedule_waiters();
+        mysql_prlock_unlock(&m_rwlock);
+      }
+      return;
+    }
+  } while (! fast_path_state_cas(&old_state, old_state - increment));
+}
+
+
+/**
+  Disable the fast path for the lock as obtrusive lock is going
+  to be requested by the thread holding m_rwlock.
+*/
+
+void MDL_lock::set_has_obtrusive()
+{
+  mysql_prlock_assert_write_owner(&m_rwlock);
+
+  if (! (get_fast_path_state() & HAS_OBTRUSIVE))
+    fast_path_state_add(HAS_OBTRUSIVE);
+}
+
+
+/**
+  Re-enable the fast path for the lock if there are no obtrusive
+  locks granted or pending for it.
+*/
+
+void MDL_lock::update_has_obtrusive()
+{
+  mysql_prlock_assert_write_owner(&m_rwlock);
+
+  if (((m_granted.bitmap() | m_waiting.bitmap()) &
+       obtrusive_lock_types_bitmap()) == 0 &&
+      (get_fast_path_state() & HAS_OBTRUSIVE))
+    fast_path_state_add(-HAS_OBTRUSIVE);
+}
+
+
 /**
   Check if we have any pending locks which conflict with existing
   shared lock.
@@ -1794,11 +2250,17 @@ MDL_context::try_acquire_lock(MDL_request *mdl_request)
     /*
       Our attempt to acquire lock without waiting has failed.
       Let us release resources which were acquired in the process.
-      We can't get here if we allocated a new lock object so there
-      is no need to release it.
+      The lock object is in use by the owners of conflicting locks, but
+      those might have acquired them on the fast path and so are not in
+      its lists, so let MDL_map::remove() decide if it can be removed.
     */
-    DBUG_ASSERT(! ticket->m_lock->is_empty());
-    mysql_prlock_unlock(&ticket->m_lock->m_rwlock);
+    MDL_lock *lock= ticket->m_lock;
+
+    lock->update_has_obtrusive();
+    if (lock->is_empty())
+      mdl_locks.remove(lock);
+    else
+      mysql_prlock_unlock(&lock->m_rwlock);
     MDL_ticket::destroy(ticket);
   }
 
@@ -1830,6 +2292,8 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
   MDL_key *key= &mdl_request->key;
   MDL_ticket *ticket;
   enum_mdl_duration found_duration;
+  MDL_lock::fast_path_state_t unobtrusive_increment;
+  bool is_fast_path;
 
   DBUG_ASSERT(mdl_request->type != MDL_EXCLUSIVE ||
               is_lock_owner(MDL_key::GLOBAL, "", "", MDL_INTENTION_EXCLUSIVE));
@@ -1883,8 +2347,28 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
                                    )))
     return TRUE;
 
-  /* The below call implicitly locks MDL_lock::m_rwlock on success. */
-  if (!(lock= mdl_locks.find_or_insert(key)))
+  /*
+    Unobtrusive locks are acquired on the fast path, unless this context
+    has to be notified about conflicting requests by other contexts,
+    which look for the contexts to notify in MDL_lock::m_granted lists.
+  */
+  unobtrusive_increment= m_needs_thr_lock_abort ? 0 :
+                         MDL_lock::get_unobtrusive_lock_increment(mdl_request);
+
+  /*
+    We are going to take the slow path and might have to wait for the
+    lock. Locks of a waiting context must be visible to the deadlock
+    detector, so turn our fast path locks into ordinary tickets first.
+  */
+  if (! unobtrusive_increment)
+    materialize_fast_path_locks();
+
+  /*
+    The below call implicitly locks MDL_lock::m_rwlock on success,
+    unless the lock has been acquired on the fast path.
+  */
+  if (!(lock= mdl_locks.find_or_insert(key, unobtrusive_increment,
+                                       &is_fast_path)))
   {
     MDL_ticket::destroy(ticket);
     return TRUE;
@@ -1892,6 +2376,49 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
 
   ticket->m_lock= lock;
 
+  if (is_fast_path)
+  {
+    ticket->m_is_fast_path= TRUE;
+    m_fast_path_locks_count++;
+
+    m_tickets[mdl_request->duration].push_front(ticket);
+
+    mdl_request->ticket= ticket;
+    return FALSE;
+  }
+
+  if (unobtrusive_increment && m_fast_path_locks_count)
+  {
+    /*
+      The fast path is blocked by obtrusive locks, so we might have to
+      wait as well. Materialize our fast path locks as above. To avoid
+      deadlocks we can't do it while holding this lock's m_rwlock, so
+      release it and look the lock up once again.
+    */
+    if (lock->is_empty())
+      mdl_locks.remove(lock);
+    else
+      mysql_prlock_unlock(&lock->m_rwlock);
+
+    materialize_fast_path_locks();
+
+    if (!(lock= mdl_locks.find_or_insert(key, 0, &is_fast_path)))
+    {
+      MDL_ticket::destroy(ticket);
+      return TRUE;
+    }
+
+    ticket->m_lock= lock;
+  }
+
+  /*
+    Disable the fast path before checking the counters of fast path
+    locks, so no new conflicting locks can be acquired on it after
+    the check.
+  */
+  if (! lock->get_unobtrusive_lock_increment(mdl_request->type))
+    lock->set_has_obtrusive();
+
   if (lock->can_grant_lock(mdl_request->type, this, false))
   {
     lock->m_granted.add_ticket(ticket);
@@ -1918,6 +2445,10 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
   vice versa -- when we COMMIT, we don't mistakenly
   release a ticket for an open HANDLER.
 
+  Clones are never acquired on the fast path, even if the original
+  ticket was. Thus delayed insert handler threads, which get all their
+  locks by cloning, can be found and notified by conflicting requests.
+
   @retval TRUE   Out of memory.
   @retval FALSE  Success.
 */
@@ -1968,6 +2499,11 @@ void MDL_object_lock::notify_conflicting_locks(MDL_context *ctx)
   Ticket_iterator it(m_granted);
   MDL_ticket *conflicting_ticket;
 
+  /*
+    Locks acquired on the fast path are not in the m_granted list. This
+    is fine as their owners don't need to be notified, see comment for
+    MDL_context::try_acquire_lock_impl() and MDL_context::clone_ticket().
+  */
   while ((conflicting_ticket= it++))
   {
     /* Only try to abort locks on which we back off. */
@@ -2573,7 +3109,14 @@ void MDL_context::release_lock(enum_mdl_duration duration, MDL_ticket *ticket)
   DBUG_ASSERT(this == ticket->get_ctx());
   mysql_mutex_assert_not_owner(&LOCK_open);
 
-  lock->remove_ticket(&MDL_lock::m_granted, ticket);
+  if (ticket->m_is_fast_path)
+  {
+    lock->remove_fast_path_lock(
+            lock->get_unobtrusive_lock_increment(ticket->get_type()));
+    m_fast_path_locks_count--;
+  }
+  else
+    lock->remove_ticket(&MDL_lock::m_granted, ticket);
 
   m_tickets[duration].remove(ticket);
   MDL_ticket::destroy(ticket);
@@ -2582,6 +3125,43 @@ void MDL_context::release_lock(enum_mdl_duration duration, MDL_ticket *ticket)
 }
 
 
+/**
+  Turn locks acquired by this context on the fast path into ordinary
+  tickets in the lists of granted tickets for the corresponding locks,
+  where other contexts, e.g. the deadlock detector, can see them.
+
+  @note Must not be called while holding any MDL_lock::m_rwlock.
+*/
+
+void MDL_context::materialize_fast_path_locks()
+{
+  int i;
+
+  for (i= 0; i < MDL_DURATION_END && m_fast_path_locks_count; i++)
+  {
+    Ticket_iterator it(m_tickets[i]);
+    MDL_ticket *ticket;
+
+    while ((ticket= it++))
+    {
+      if (ticket->m_is_fast_path)
+      {
+        MDL_lock *lock= ticket->m_lock;
+
+        mysql_prlock_wrlock(&lock->m_rwlock);
+        lock->fast_path_state_add(
+                -lock->get_unobtrusive_lock_increment(ticket->get_type()));
+        lock->m_granted.add_ticket(ticket);
+        mysql_prlock_unlock(&lock->m_rwlock);
+
+        ticket->m_is_fast_path= FALSE;
+        m_fast_path_locks_count--;
+      }
+    }
+  }
+}
+
+
 /**
   Release lock with explicit duration.
 
@@ -2681,6 +3261,7 @@ void MDL_ticket::downgrade_exclusive_lock(enum_mdl_type type)
   m_lock->m_granted.remove_ticket(this);
   m_type= type;
   m_lock->m_granted.add_ticket(this);
+  m_lock->update_has_obtrusive();
   m_lock->reschedule_waiters();
   mysql_prlock_unlock(&m_lock->m_rwlock);
 }
@@ -2712,6 +3293,7 @@ void MDL_ticket::downgrade_shared_lock(enum_mdl_type type)
   m_lock->m_granted.remove_ticket(this);
   m_type= type;
   m_lock->m_granted.add_ticket(this);
+  m_lock->update_has_obtrusive();
   m_lock->reschedule_waiters();
   mysql_prlock_unlock(&m_lock->m_rwlock);
 }
@@ -515,7 +515,8 @@ private:
      m_duration(duration_arg),
 #endif
      m_ctx(ctx_arg),
-     m_lock(NULL)
+     m_lock(NULL),
+     m_is_fast_path(FALSE)
   {}
 
   static MDL_ticket *create(MDL_context *ctx_arg, enum_mdl_type type_arg
@@ -544,6 +545,13 @@ private:
   */
   MDL_lock *m_lock;
 
+  /**
+    TRUE if the lock was acquired on the fast path, i.e. it is accounted
+    in the MDL_lock's counter of unobtrusive locks and the ticket is not
+    in the list of granted tickets for the lock. Context private.
+  */
+  bool m_is_fast_path;
+
 private:
   MDL_ticket(const MDL_ticket &);               /* not implemented */
   MDL_ticket &operator=(const MDL_ticket &);    /* not implemented */
@@ -703,6 +711,14 @@ public:
             will see the new value eventually.
     */
     m_needs_thr_lock_abort= needs_thr_lock_abort;
+
+    /*
+      Contexts which need to be notified about conflicting lock requests
+      must have all their locks in the MDL_lock's lists of granted tickets,
+      as that is where notify_conflicting_locks() looks for them.
+    */
+    if (needs_thr_lock_abort)
+      materialize_fast_path_locks();
   }
   bool get_needs_thr_lock_abort() const
   {
@@ -782,6 +798,12 @@ private:
   */
   bool m_needs_thr_lock_abort;
 
+  /**
+    Number of tickets in m_tickets lists which were acquired on the
+    fast path and have not been materialized yet.
+  */
+  uint m_fast_path_locks_count;
+
   /**
     Read-write lock protecting m_waiting_for member.
 
@@ -809,11 +831,15 @@ private:
 public:
   void find_deadlock();
 
+  void materialize_fast_path_locks();
+
   bool visit_subgraph(MDL_wait_for_graph_visitor *dvisitor);
 
   /** Inform the deadlock detector there is an edge in the wait-for graph. */
   void will_wait_for(MDL_wait_for_subgraph *waiting_for_arg)
   {
+    /* All our locks must be visible to the deadlock detector. */
+    DBUG_ASSERT(m_fast_path_locks_count == 0);
     mysql_prlock_wrlock(&m_LOCK_waiting_for);
     m_waiting_for=  waiting_for_arg;
     mysql_prlock_unlock(&m_LOCK_waiting_for);
@@ -866,6 +892,14 @@ extern mysql_mutex_t LOCK_open;
 extern ulong mdl_locks_cache_size;
 static const ulong MDL_LOCKS_CACHE_SIZE_DEFAULT = 1024;
 
+/*
+  Start-up parameter for the number of partitions of the hash
+  containing all the MDL_lock objects and a constant for its
+  default value.
+*/
+extern ulong mdl_locks_hash_partitions;
+static const ulong MDL_LOCKS_HASH_PARTITIONS_DEFAULT = 8;
+
 /*
   Metadata locking subsystem tries not to grant more than
   max_write_lock_count high-prio, strong locks successively,
@@ -1198,6 +1198,7 @@ QUICK_RANGE_SELECT::QUICK_RANGE_SELECT(THD *thd, TABLE *table, uint key_nr,
   multi_range_length= 0;
   multi_range= NULL;
   multi_range_buff= NULL;
+  mrr_buf_size= 0;
 
   if (!no_alloc && !parent_alloc)
   {
@@ -1969,9 +1970,10 @@ class TRP_RANGE : public TABLE_READ_PLAN
 public:
   SEL_ARG *key; /* set of intervals to be used in "range" method retrieval */
   uint     key_idx; /* key number in PARAM::key */
+  uint     mrr_buf_size; /* rowid buffer size if read in rowid order, or 0 */
 
   TRP_RANGE(SEL_ARG *key_arg, uint idx_arg)
-   : key(key_arg), key_idx(idx_arg)
+   : key(key_arg), key_idx(idx_arg), mrr_buf_size(0)
   {}
   virtual ~TRP_RANGE() {}                     /* Remove gcc warning */
 
@@ -1984,6 +1986,7 @@ public:
     {
       quick->records= records;
       quick->read_time= read_cost;
+      quick->mrr_buf_size= mrr_buf_size;
     }
     DBUG_RETURN(quick);
   }
@@ -3726,6 +3729,53 @@ static void dbug_print_singlepoint_range(SEL_ARG **start, uint num)
 #endif
 
 
+/*
+  Get cost of reading records in the order of the data file blocks.
+  SYNOPSIS
+    get_disk_sweep_cost()
+      param            Parameter from test_quick_select
+      records          # of records to be retrieved
+  RETURN
+    cost of sweep
+*/
+
+static double get_disk_sweep_cost(const PARAM *param, ha_rows records)
+{
+  double result;
+  double n_blocks=
+    ceil(ulonglong2double(param->table->file->stats.data_file_length) /
+         IO_SIZE);
+  double busy_blocks=
+    n_blocks * (1.0 - pow(1.0 - 1.0/n_blocks, rows2double(records)));
+  if (busy_blocks < 1.0)
+    busy_blocks= 1.0;
+  DBUG_PRINT("info",("sweep: nblocks: %g, busy_blocks: %g", n_blocks,
+                     busy_blocks));
+  /*
+    Disabled: Bail out if # of blocks to read is bigger than # of blocks in
+    table data file.
+  if (max_cost != DBL_MAX  && (busy_blocks+index_reads_cost) >= n_blocks)
+    return 1;
+  */
+  JOIN *join= param->thd->lex->select_lex.join;
+  if (!join || join->tables == 1)
+  {
+    /* No join, assume reading is done in one 'sweep' */
+    result= busy_blocks*(DISK_SEEK_BASE_COST +
+                        DISK_SEEK_PROP_COST*n_blocks/busy_blocks);
+  }
+  else
+  {
+    /*
+      Possibly this is a join with source table being non-last table, so
+      assume that disk seeks are random here.
+    */
+    result= busy_blocks;
+  }
+  return result;
+}
+
+
 /*
   Get cost of 'sweep' full records retrieval.
   SYNOPSIS
@@ -3746,43 +3796,47 @@ double get_sweep_read_cost(const PARAM *param, ha_rows records)
                                           (uint)records, records);
   }
   else
-  {
-    double n_blocks=
-      ceil(ulonglong2double(param->table->file->stats.data_file_length) /
-           IO_SIZE);
-    double busy_blocks=
-      n_blocks * (1.0 - pow(1.0 - 1.0/n_blocks, rows2double(records)));
-    if (busy_blocks < 1.0)
-      busy_blocks= 1.0;
-    DBUG_PRINT("info",("sweep: nblocks: %g, busy_blocks: %g", n_blocks,
-                       busy_blocks));
-    /*
-      Disabled: Bail out if # of blocks to read is bigger than # of blocks in
-      table data file.
-    if (max_cost != DBL_MAX  && (busy_blocks+index_reads_cost) >= n_blocks)
-      return 1;
-    */
-    JOIN *join= param->thd->lex->select_lex.join;
-    if (!join || join->tables == 1)
-    {
-      /* No join, assume reading is done in one 'sweep' */
-      result= busy_blocks*(DISK_SEEK_BASE_COST +
-                          DISK_SEEK_PROP_COST*n_blocks/busy_blocks);
-    }
-    else
-    {
-      /*
-        Possibly this is a join with source table being non-last table, so
-        assume that disk seeks are random here.
-      */
-      result= busy_blocks;
-    }
-  }
+    result= get_disk_sweep_cost(param, records);
   DBUG_PRINT("return",("cost: %g", result));
   DBUG_RETURN(result);
 }
 
 
+/*
+  Get cost of a range scan which reads the records in rowid order.
+  SYNOPSIS
+    get_mrr_read_time()
+      param            Parameter from test_quick_select
+      records          # of records in the ranges
+      keynr            Index to scan
+      buf_rows         # of rowids that fit in the buffer at once
+  DESCRIPTION
+    The index is scanned once, and each buffer fill of rowids is sorted
+    and then read in one sweep over the data file. The sweep is costed
+    like an unclustered table even for a clustered primary key, since
+    the rows of one fill are read in primary key order.
+  RETURN
+    cost of the scan, without the cost of checking the rows
+*/
+
+static double get_mrr_read_time(const PARAM *param, ha_rows records,
+                                uint keynr, ha_rows buf_rows)
+{
+  double result= get_index_only_read_time(param, records, keynr);
+  ha_rows fill_rows= min(records, buf_rows);
+  double n_fills= ceil(rows2double(records) / rows2double(buf_rows));
+  if (fill_rows)
+  {
+    double n= rows2double(fill_rows);
+    result+= n_fills * (get_disk_sweep_cost(param, fill_rows) +
+                        n * log(n) / (TIME_FOR_COMPARE_ROWID * M_LN2));
+  }
+  DBUG_PRINT("info",("mrr: records: %lu, buf_rows: %lu, cost: %g",
+                     (ulong) records, (ulong) buf_rows, result));
+  return result;
+}
+
+
 /*
   Get best plan for a SEL_IMERGE disjunctive expression.
   SYNOPSIS
@@ -5010,6 +5064,7 @@ static TRP_RANGE *get_key_scans_params(PARAM *param, SEL_TREE *tree,
   int idx;
   SEL_ARG **key,**end, **key_to_read= NULL;
   ha_rows UNINIT_VAR(best_records);              /* protected by key_to_read */
+  uint best_mrr_buf_size= 0;
   TRP_RANGE* read_plan= NULL;
   bool pk_is_clustered= param->table->file->primary_key_is_clustered();
   DBUG_ENTER("get_key_scans_params");
@@ -5028,6 +5083,7 @@ static TRP_RANGE *get_key_scans_params(PARAM *param, SEL_TREE *tree,
   {
     ha_rows found_records;
     double found_read_time;
+    uint mrr_buf_size= 0;
     if (*key)
     {
       uint keynr= param->real_keynr[idx];
@@ -5068,6 +5124,31 @@ static TRP_RANGE *get_key_scans_params(PARAM *param, SEL_TREE *tree,
                                                        param->range_count,
                                                        found_records) +
 			 cpu_cost + 0.01;
+        /*
+          Check if reading the rows in rowid order after collecting their
+          rowids from the index is cheaper, see DsMrr_impl.
+        */
+        uint bufsz= param->thd->variables.read_rnd_buff_size;
+        ha_rows buf_rows;
+        if (!index_read_must_be_used &&
+            optimizer_flag(param->thd, OPTIMIZER_SWITCH_MRR) &&
+            found_records != HA_POS_ERROR &&
+            !param->table->file->multi_range_read_info(keynr, found_records,
+                                                       &bufsz, &buf_rows))
+        {
+          double mrr_read_time= get_mrr_read_time(param, found_records,
+                                                  keynr, buf_rows) +
+                                cpu_cost + 0.01;
+          DBUG_PRINT("info",("key %s: mrr_read_time: %g",
+                             param->table->key_info[keynr].name,
+                             mrr_read_time));
+          if (!optimizer_flag(param->thd, OPTIMIZER_SWITCH_MRR_COST_BASED) ||
+              mrr_read_time < found_read_time)
+          {
+            found_read_time= mrr_read_time;
+            mrr_buf_size= bufsz;
+          }
+        }
       }
       DBUG_PRINT("info",("key %s: found_read_time: %g (cur. read_time: %g)",
                          param->table->key_info[keynr].name, found_read_time,
@@ -5077,6 +5158,7 @@ static TRP_RANGE *get_key_scans_params(PARAM *param, SEL_TREE *tree,
       {
         read_time=    found_read_time;
         best_records= found_records;
+        best_mrr_buf_size= mrr_buf_size;
         key_to_read=  key;
       }
 
@@ -5093,6 +5175,7 @@ static TRP_RANGE *get_key_scans_params(PARAM *param, SEL_TREE *tree,
       read_plan->records= best_records;
       read_plan->is_ror= tree->ror_scans_map.is_set(idx);
       read_plan->read_cost= read_time;
+      read_plan->mrr_buf_size= best_mrr_buf_size;
       DBUG_PRINT("info",
                  ("Returning range plan for key %s, cost %g, records %lu",
                   param->table->key_info[param->real_keynr[idx]].name,
@@ -8744,11 +8827,18 @@ int QUICK_RANGE_SELECT::reset()
     DBUG_RETURN(HA_ERR_OUT_OF_MEM);
   }
 
-  /* Allocate the handler buffer if necessary.  */
-  if (file->ha_table_flags() & HA_NEED_READ_RANGE_BUFFER)
+  /*
+    Allocate the handler buffer if necessary. A scan which reads the rows
+    in rowid order uses it for the rowids, see DsMrr_impl.
+  */
+  if (uses_mrr() || (file->ha_table_flags() & HA_NEED_READ_RANGE_BUFFER))
   {
-    mrange_bufsiz= min(multi_range_bufsiz,
-                       ((uint)QUICK_SELECT_I::records + 1)* head->s->reclength);
+    if (uses_mrr())
+      mrange_bufsiz= mrr_buf_size;
+    else
+      mrange_bufsiz= min(multi_range_bufsiz,
+                         ((uint)QUICK_SELECT_I::records + 1) *
+                         head->s->reclength);
 
     while (mrange_bufsiz &&
            ! my_multi_malloc(MYF(MY_WME),
@@ -9045,6 +9135,7 @@ QUICK_SELECT_DESC::QUICK_SELECT_DESC(QUICK_RANGE_SELECT *q,
   multi_range_length= 0;
   multi_range= NULL;
   multi_range_buff= NULL;
+  mrr_buf_size= 0;
 
   QUICK_RANGE **pr= (QUICK_RANGE**)ranges.buffer;
   QUICK_RANGE **end_range= pr + ranges.elements;
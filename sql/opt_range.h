@@ -397,9 +397,11 @@ protected:
                                        freed by QUICK_RANGE_SELECT) */
   HANDLER_BUFFER *multi_range_buff; /* the handler buffer (allocated and
                                        freed by QUICK_RANGE_SELECT) */
+  uint mrr_buf_size; /* rowid buffer size if rows are read in rowid order */
   MY_BITMAP column_bitmap, *save_read_set, *save_write_set;
 
   friend class TRP_ROR_INTERSECT;
+  friend class TRP_RANGE;
   friend
   QUICK_RANGE_SELECT *get_quick_select_for_ref(THD *thd, TABLE *table,
                                                struct st_table_ref *ref,
@@ -440,6 +442,8 @@ public:
   int get_next_prefix(uint prefix_length, uint group_key_parts, 
                       uchar *cur_prefix);
   bool reverse_sorted() { return 0; }
+  /* TRUE if the rows are read in rowid order, see DsMrr_impl */
+  bool uses_mrr() { return mrr_buf_size && !sorted; }
   bool unique_key_range();
   int init_ror_merged_scan(bool reuse_handler);
   void save_last_pos()
@@ -285,13 +285,14 @@ int opt_sum_query(THD *thd,
       If the storage manager of 'tl' gives exact row count as part of
       statistics (cheap), compute the total number of rows. If there are
       no outer table dependencies, this count may be used as the real count.
-      Schema tables are filled after this function is invoked, so we can't
-      get row count 
+      Schema tables and derived tables that are filled on their first read
+      are filled after this function is invoked, so we can't get row count 
     */
     if (!(tl->table->file->ha_table_flags() & HA_STATS_RECORDS_IS_EXACT) ||
-        tl->schema_table)
+        tl->schema_table || tl->table->materialize_pending)
     {
       maybe_exact_count&= test(!tl->schema_table &&
+                               !tl->table->materialize_pending &&
                                (tl->table->file->ha_table_flags() &
                                 HA_HAS_RECORDS));
       is_exact_count= FALSE;
@@ -120,6 +120,18 @@ public:
   */
   MY_BITMAP used_partitions;
 
+  /*
+    A bitmap of partitions the current statement locks.
+    Usage pattern:
+    * All partitions are set at the end of each statement by
+      handler->reset().
+    * INSERT, UPDATE and DELETE may clear the partitions they cannot touch
+      before the table is locked, see can_prune_partitions_before_lock().
+    used_partitions is always a subset of lock_partitions while the table
+    is locked.
+  */
+  MY_BITMAP lock_partitions;
+
   union {
     longlong *range_int_array;
     LIST_PART_ENTRY *list_array;
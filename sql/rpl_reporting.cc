@@ -73,6 +73,16 @@ Slave_reporting_capability::report(loglevel level, int err_code,
                   err_code);
 }
 
+void
+Slave_reporting_capability::set_last_error(Error const &error)
+{
+  mysql_mutex_lock(&err_lock);
+  m_last_error.number= error.number;
+  strmake(m_last_error.message, error.message,
+          sizeof(m_last_error.message) - 1);
+  mysql_mutex_unlock(&err_lock);
+}
+
 Slave_reporting_capability::~Slave_reporting_capability()
 {
   mysql_mutex_destroy(&err_lock);
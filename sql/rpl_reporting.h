@@ -90,6 +90,12 @@ public:
 
   Error const& last_error() const { return m_last_error; }
 
+  /**
+     Sets Last_Error to an error already written to the error log by
+     another slave thread.
+   */
+  void set_last_error(Error const &error);
+
   virtual ~Slave_reporting_capability()= 0;
 private:
   /**
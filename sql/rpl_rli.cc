@@ -52,7 +52,10 @@ Relay_log_info::Relay_log_info(bool is_slave_recovery)
    inited(0), abort_slave(0), slave_running(0), until_condition(UNTIL_NONE),
    until_log_pos(0), retried_trans(0),
    tables_to_lock(0), tables_to_lock_count(0),
-   last_event_start_time(0), deferred_events(NULL),m_flags(0),
+   last_event_start_time(0), deferred_events(NULL),
+   workers(NULL), workers_count(0), mts_group(NULL), mts_replay(FALSE),
+   mts_groups_assigned(0), mts_groups_committed(0), mts_failed_seqno(0),
+   mts_workers_running(0), m_flags(0),
    row_stmt_start_timestamp(0), long_find_row_note_printed(false)
 {
   DBUG_ENTER("Relay_log_info::Relay_log_info");
@@ -81,6 +84,8 @@ Relay_log_info::Relay_log_info(bool is_slave_recovery)
   mysql_cond_init(key_relay_log_info_stop_cond, &stop_cond, NULL);
   mysql_cond_init(key_relay_log_info_log_space_cond, &log_space_cond, NULL);
   mysql_cond_init(key_relay_log_info_sleep_cond, &sleep_cond, NULL);
+  mysql_mutex_init(key_relay_log_info_mts_lock, &mts_lock, MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_relay_log_info_mts_cond, &mts_cond, NULL);
   relay_log.init_pthread_objects();
   DBUG_VOID_RETURN;
 }
@@ -99,11 +104,85 @@ Relay_log_info::~Relay_log_info()
   mysql_cond_destroy(&stop_cond);
   mysql_cond_destroy(&log_space_cond);
   mysql_cond_destroy(&sleep_cond);
+  mysql_mutex_destroy(&mts_lock);
+  mysql_cond_destroy(&mts_cond);
   relay_log.cleanup();
   DBUG_VOID_RETURN;
 }
 
 
+Slave_job_group::Slave_job_group()
+  :seqno(0), replayed(0), next(NULL)
+{
+  relay_log_name[0]= master_log_name[0]= 0;
+  my_init_dynamic_array(&events, sizeof(Slave_job_event), 16, 16);
+}
+
+
+Slave_job_group::~Slave_job_group()
+{
+  for (uint i= 0; i < events.elements; i++)
+    delete dynamic_element(&events, i, Slave_job_event*)->ev;
+  delete_dynamic(&events);
+}
+
+
+bool Slave_job_group::add(Log_event *ev, ulonglong end_pos)
+{
+  Slave_job_event job= { ev, end_pos };
+  return insert_dynamic(&events, (uchar*) &job);
+}
+
+
+Slave_worker::Slave_worker(Relay_log_info *rli, uint id_arg)
+  :Relay_log_info(FALSE), c_rli(rli), id(id_arg),
+   jobs_head(NULL), jobs_tail(NULL), jobs_count(0),
+   stop(FALSE), running(FALSE), groups_done(0)
+{
+  /* The coordinator owns the info file */
+  no_storage= TRUE;
+  mi= rli->mi;
+  deferred_events_collecting= FALSE;
+  mysql_cond_init(key_slave_worker_jobs_cond, &jobs_cond, NULL);
+}
+
+
+Slave_worker::~Slave_worker()
+{
+  Slave_job_group *group;
+  while ((group= dequeue()))
+    delete group;
+  mysql_cond_destroy(&jobs_cond);
+}
+
+
+void Slave_worker::enqueue(Slave_job_group *group)
+{
+  mysql_mutex_assert_owner(&c_rli->mts_lock);
+  group->next= NULL;
+  if (jobs_tail)
+    jobs_tail->next= group;
+  else
+    jobs_head= group;
+  jobs_tail= group;
+  jobs_count++;
+  mysql_cond_signal(&jobs_cond);
+}
+
+
+Slave_job_group *Slave_worker::dequeue()
+{
+  Slave_job_group *group= jobs_head;
+  if (group)
+  {
+    if (!(jobs_head= group->next))
+      jobs_tail= NULL;
+    jobs_count--;
+  }
+  return group;
+}
+
+
 int init_relay_log_info(Relay_log_info* rli,
 			const char* info_fname)
 {
@@ -24,6 +24,8 @@
 
 struct RPL_TABLE_LIST;
 class Master_info;
+class Slave_worker;
+struct Slave_job_group;
 extern uint sql_slave_skip_counter;
 
 /****************************************************************************
@@ -525,6 +527,42 @@ public:
     return long_find_row_note_printed;
   }
 
+  /*
+    Multi-threaded applier (--slave-parallel-workers > 0).
+
+    The slave SQL thread acts as the coordinator: it reads row-based
+    transactions from the relay log into a Slave_job_group and hands
+    every group over to one of the workers, chosen by the databases the
+    group modifies, so that groups on the same database are executed by
+    the same worker in relay log order. Everything else is executed by
+    the coordinator itself once all the workers are idle.
+
+    Groups are numbered in the order they are read and committed in that
+    order, so group_relay_log_pos and group_master_log_pos always point
+    to the end of a gap-free prefix of the relay log, and the positions
+    written to the info file are safe to restart from.
+
+    workers, workers_count and mts_group are only used by the
+    coordinator, the other members are protected by mts_lock.
+  */
+  Slave_worker **workers;
+  uint workers_count;
+  /* Group being read from the relay log, not dispatched yet */
+  Slave_job_group *mts_group;
+  /*
+    mts_group has met an event that cannot be executed by a worker: the
+    coordinator executes the events of the group itself.
+  */
+  bool mts_replay;
+  mysql_mutex_t mts_lock;
+  /* Broadcast when a group is committed or a worker stops */
+  mysql_cond_t mts_cond;
+  /* Sequence numbers of the last group dispatched and committed */
+  ulonglong mts_groups_assigned, mts_groups_committed;
+  /* Group a worker failed to execute, or 0 */
+  ulonglong mts_failed_seqno;
+  uint mts_workers_running;
+
 private:
 
   uint32 m_flags;
@@ -538,6 +576,72 @@ private:
 };
 
 
+/**
+  An event of a Slave_job_group, along with the position following it
+  in the relay log.
+*/
+struct Slave_job_event
+{
+  Log_event *ev;
+  ulonglong end_pos;
+};
+
+/**
+  A transaction read from the relay log by the coordinator, to be
+  executed by a Slave_worker.
+*/
+struct Slave_job_group
+{
+  /* Slave_job_event, in relay log order */
+  DYNAMIC_ARRAY events;
+  /* Commit order of the group, see Relay_log_info::mts_groups_committed */
+  ulonglong seqno;
+  /* Events already executed by the coordinator, see mts_replay */
+  uint replayed;
+  /* Coordinates of the end of the group */
+  char relay_log_name[FN_REFLEN];
+  char master_log_name[FN_REFLEN];
+  Slave_job_group *next;
+
+  Slave_job_group();
+  ~Slave_job_group();
+  bool add(Log_event *ev, ulonglong end_pos);
+};
+
+
+/**
+  Worker thread of the multi-threaded applier.
+
+  Events are applied against the worker's own Relay_log_info, so that
+  the table map, the tables to lock and the statement flags of
+  concurrent transactions are kept apart. Its group_* coordinates are
+  the checkpoint of the worker: the end of the last group it committed,
+  which is copied to the coordinator when the group is committed.
+*/
+class Slave_worker : public Relay_log_info
+{
+public:
+  Slave_worker(Relay_log_info *rli, uint id);
+  ~Slave_worker();
+
+  /* The coordinator */
+  Relay_log_info *c_rli;
+  uint id;
+
+  /* Groups waiting for execution, protected by c_rli->mts_lock */
+  Slave_job_group *jobs_head, *jobs_tail;
+  uint jobs_count;
+  /* Signalled when a group is queued or the worker must stop */
+  mysql_cond_t jobs_cond;
+  bool stop;
+  bool running;
+  /* Groups executed since the worker was started */
+  ulonglong groups_done;
+
+  void enqueue(Slave_job_group *group);
+  Slave_job_group *dequeue();
+};
+
 // Defined in rpl_rli.cc
 int init_relay_log_info(Relay_log_info* rli, const char* info_fname);
 
@@ -255,12 +255,14 @@ void unlock_slave_threads(Master_info* mi)
 }
 
 #ifdef HAVE_PSI_INTERFACE
-static PSI_thread_key key_thread_slave_io, key_thread_slave_sql;
+static PSI_thread_key key_thread_slave_io, key_thread_slave_sql,
+  key_thread_slave_worker;
 
 static PSI_thread_info all_slave_threads[]=
 {
   { &key_thread_slave_io, "slave_io", PSI_FLAG_GLOBAL},
-  { &key_thread_slave_sql, "slave_sql", PSI_FLAG_GLOBAL}
+  { &key_thread_slave_sql, "slave_sql", PSI_FLAG_GLOBAL},
+  { &key_thread_slave_worker, "slave_worker", 0}
 };
 
 static void init_slave_psi_keys(void)
@@ -2483,6 +2485,570 @@ int apply_event_and_update_pos(Log_event* ev, THD* thd, Relay_log_info* rli)
 }
 
 
+/*
+  Multi-threaded applier, see the comment on Relay_log_info::workers.
+*/
+
+/* What mts_schedule_event() did with an event read by the coordinator */
+enum enum_mts_schedule
+{
+  /* The event was added to a group, which may have been dispatched */
+  MTS_EVENT_QUEUED,
+  /* The coordinator must apply the event itself */
+  MTS_EVENT_SEQUENTIAL,
+  /* The event was discarded because of an error or a kill */
+  MTS_EVENT_ERROR
+};
+
+
+static bool slave_worker_killed(THD *thd, Slave_worker *w)
+{
+  return abort_loop || thd->killed;
+}
+
+
+/**
+  Records that a worker could not execute a group: the groups that
+  follow it in the relay log must not be committed either.
+
+  @note Called with rli->mts_lock held.
+*/
+static void mts_group_failed(Relay_log_info *rli, ulonglong seqno)
+{
+  mysql_mutex_assert_owner(&rli->mts_lock);
+  if (!rli->mts_failed_seqno || seqno < rli->mts_failed_seqno)
+    rli->mts_failed_seqno= seqno;
+  mysql_cond_broadcast(&rli->mts_cond);
+}
+
+
+/**
+  Waits until all the groups preceding the given one in the relay log
+  have been committed.
+
+  @retval 0 The group can be committed.
+  @retval 1 The worker has been killed.
+  @retval 2 A preceding group has failed, the group must be rolled back.
+*/
+static int slave_worker_wait_for_turn(THD *thd, Slave_worker *w,
+                                      ulonglong seqno)
+{
+  Relay_log_info *rli= w->c_rli;
+  const char *old_msg;
+  int error= 0;
+
+  mysql_mutex_lock(&rli->mts_lock);
+  old_msg= thd->enter_cond(&rli->mts_cond, &rli->mts_lock,
+                           "Waiting for preceding transaction to commit");
+  while (rli->mts_groups_committed + 1 != seqno)
+  {
+    if (rli->mts_failed_seqno && rli->mts_failed_seqno < seqno)
+    {
+      error= 2;
+      break;
+    }
+    if (thd->killed)
+    {
+      error= 1;
+      break;
+    }
+    mysql_cond_wait(&rli->mts_cond, &rli->mts_lock);
+  }
+  thd->exit_cond(old_msg);
+  return error;
+}
+
+
+/**
+  Executes a group on a worker and, once it is committed, advances the
+  coordinates of the coordinator to the end of the group.
+
+  Transactions that fail with a temporary error are retried up to
+  slave_transaction_retries times, like the slave SQL thread does.
+*/
+static void slave_worker_exec_group(THD *thd, Slave_worker *w,
+                                    Slave_job_group *group)
+{
+  Relay_log_info *rli= w->c_rli;
+  uint last= group->events.elements - 1;
+  int error= 0;
+  DBUG_ENTER("slave_worker_exec_group");
+
+  mysql_mutex_lock(&rli->mts_lock);
+  if (rli->mts_failed_seqno && rli->mts_failed_seqno < group->seqno)
+    error= 2;
+  mysql_mutex_unlock(&rli->mts_lock);
+
+  w->clear_error();
+  w->trans_retries= 0;
+  strmake(w->event_relay_log_name, group->relay_log_name,
+          sizeof(w->event_relay_log_name) - 1);
+  strmake(w->group_master_log_name, group->master_log_name,
+          sizeof(w->group_master_log_name) - 1);
+
+  while (!error)
+  {
+    thd_proc_info(thd, "Executing event");
+    for (uint i= 0; i <= last && !error; i++)
+    {
+      Slave_job_event *job= dynamic_element(&group->events, i,
+                                            Slave_job_event*);
+      /* Commit in relay log order */
+      if (i == last &&
+          (error= slave_worker_wait_for_turn(thd, w, group->seqno)))
+        break;
+      w->future_event_relay_log_pos= job->end_pos;
+      mysql_mutex_lock(&w->data_lock);
+      error= apply_event_and_update_pos(job->ev, thd, w);
+    }
+    if (error != 1 || !has_temporary_error(thd) ||
+        w->trans_retries >= slave_trans_retries)
+      break;
+
+    w->cleanup_context(thd, 1);
+    error= 0;
+    slave_sleep(thd, min(w->trans_retries, MAX_SLAVE_RETRY_PAUSE),
+                slave_worker_killed, w);
+    w->trans_retries++;
+    mysql_mutex_lock(&rli->data_lock);          // because of SHOW STATUS
+    rli->retried_trans++;
+    mysql_mutex_unlock(&rli->data_lock);
+    DBUG_PRINT("info", ("Slave worker %u retries transaction %lu time(s)",
+                        w->id, w->trans_retries));
+  }
+
+  if (!error)
+  {
+    mysql_mutex_lock(&rli->data_lock);
+    strmake(rli->group_relay_log_name, w->group_relay_log_name,
+            sizeof(rli->group_relay_log_name) - 1);
+    rli->group_relay_log_pos= w->group_relay_log_pos;
+    strmake(rli->group_master_log_name, w->group_master_log_name,
+            sizeof(rli->group_master_log_name) - 1);
+    rli->group_master_log_pos= w->group_master_log_pos;
+    rli->notify_group_relay_log_name_update();
+    rli->notify_group_master_log_name_update();
+    if (w->last_master_timestamp)
+      rli->last_master_timestamp= w->last_master_timestamp;
+    flush_relay_log_info(rli);
+    mysql_cond_broadcast(&rli->data_cond);
+    mysql_mutex_unlock(&rli->data_lock);
+
+    mysql_mutex_lock(&rli->mts_lock);
+    rli->mts_groups_committed= group->seqno;
+    w->groups_done++;
+    mysql_cond_broadcast(&rli->mts_cond);
+    mysql_mutex_unlock(&rli->mts_lock);
+    DBUG_VOID_RETURN;
+  }
+
+  w->cleanup_context(thd, 1);
+  if (error == 2)
+  {
+    /* Not executed because of the failure of a preceding group */
+    thd->clear_error();
+    DBUG_VOID_RETURN;
+  }
+
+  if (!w->last_error().number)
+  {
+    if (thd->is_error())
+      w->report(ERROR_LEVEL, thd->stmt_da->sql_errno(), "%s",
+                thd->stmt_da->message());
+    else
+      w->report(ERROR_LEVEL, ER_SLAVE_FATAL_ERROR, ER(ER_SLAVE_FATAL_ERROR),
+                "Slave worker thread was killed");
+  }
+  thd->clear_error();
+  mysql_mutex_lock(&rli->mts_lock);
+  if (!rli->mts_failed_seqno || group->seqno < rli->mts_failed_seqno)
+    rli->set_last_error(w->last_error());
+  mts_group_failed(rli, group->seqno);
+  mysql_mutex_unlock(&rli->mts_lock);
+  DBUG_VOID_RETURN;
+}
+
+
+pthread_handler_t handle_slave_worker(void *arg)
+{
+  THD *thd;                     /* needs to be first for thread_stack */
+  Slave_worker *w= (Slave_worker*) arg;
+  Relay_log_info *rli= w->c_rli;
+  Slave_job_group *group;
+  const char *old_msg;
+
+  my_thread_init();
+  DBUG_ENTER("handle_slave_worker");
+
+  thd= new THD;
+  thd->thread_stack= (char*) &thd;
+  w->sql_thd= thd;
+  w->slave_running= 1;
+  pthread_detach_this_thread();
+  if (init_slave_thread(thd, SLAVE_THD_SQL))
+  {
+    rli->report(ERROR_LEVEL, ER_SLAVE_FATAL_ERROR,
+                "Failed during slave worker thread initialization");
+    mysql_mutex_lock(&rli->mts_lock);
+    mts_group_failed(rli, rli->mts_groups_committed + 1);
+    mysql_mutex_unlock(&rli->mts_lock);
+  }
+  else
+  {
+    thd->init_for_queries();
+    thd->rli_slave= w;
+    mysql_mutex_lock(&LOCK_thread_count);
+    threads.append(thd);
+    mysql_mutex_unlock(&LOCK_thread_count);
+  }
+
+  /*
+    Groups queued before a stop request are still executed, so that the
+    coordinates of the coordinator are the end of all the groups it has
+    dispatched.
+  */
+  mysql_mutex_lock(&rli->mts_lock);
+  for (;;)
+  {
+    old_msg= thd->enter_cond(&w->jobs_cond, &rli->mts_lock,
+                             "Waiting for an event from the coordinator");
+    while (!(group= w->dequeue()) && !w->stop)
+      mysql_cond_wait(&w->jobs_cond, &rli->mts_lock);
+    /* Wake up the coordinator waiting for room in the queue */
+    mysql_cond_broadcast(&rli->mts_cond);
+    thd->exit_cond(old_msg);
+    if (!group)
+      break;
+
+    /* Groups are discarded if the initialization failed */
+    if (thd->rli_slave)
+      slave_worker_exec_group(thd, w, group);
+    delete group;
+    mysql_mutex_lock(&rli->mts_lock);
+  }
+
+  thd->clear_error();
+  thd->catalog= 0;
+  thd->reset_query();
+  thd->reset_db(NULL, 0);
+  net_end(&thd->net);
+  w->slave_running= 0;
+  w->sql_thd= 0;
+  mysql_mutex_lock(&LOCK_thd_remove);
+  mysql_mutex_lock(&LOCK_thread_count);
+  delete thd;
+  mysql_mutex_unlock(&LOCK_thread_count);
+  mysql_mutex_unlock(&LOCK_thd_remove);
+
+  mysql_mutex_lock(&rli->mts_lock);
+  w->running= FALSE;
+  rli->mts_workers_running--;
+  mysql_cond_broadcast(&rli->mts_cond);
+  mysql_mutex_unlock(&rli->mts_lock);
+
+  DBUG_LEAVE;                                   // Must match DBUG_ENTER()
+  my_thread_end();
+  pthread_exit(0);
+  return 0;                                     // Avoid compiler warnings
+}
+
+
+/**
+  Starts the workers of the multi-threaded applier.
+
+  @retval 0 OK, some workers may have failed to start, in which case
+            rli->mts_failed_seqno is set.
+  @retval 1 Out of memory.
+*/
+static int slave_start_workers(Relay_log_info *rli, uint count)
+{
+  DBUG_ENTER("slave_start_workers");
+
+  rli->mts_groups_assigned= rli->mts_groups_committed= 0;
+  rli->mts_failed_seqno= 0;
+  if (!(rli->workers= (Slave_worker**) my_malloc(count * sizeof(Slave_worker*),
+                                                  MYF(MY_WME | MY_ZEROFILL))))
+    DBUG_RETURN(1);
+
+  for (uint i= 0; i < count; i++)
+  {
+    pthread_t th;
+    int error;
+    Slave_worker *w;
+
+    if (!(w= new Slave_worker(rli, i)))
+      DBUG_RETURN(1);
+    rli->workers[rli->workers_count++]= w;
+
+    mysql_mutex_lock(&rli->mts_lock);
+    w->running= TRUE;
+    rli->mts_workers_running++;
+    mysql_mutex_unlock(&rli->mts_lock);
+    if ((error= mysql_thread_create(key_thread_slave_worker, &th,
+                                    &connection_attrib, handle_slave_worker,
+                                    (void*) w)))
+    {
+      rli->report(ERROR_LEVEL, ER_SLAVE_THREAD,
+                  "Can't create slave worker thread (errno= %d).", error);
+      mysql_mutex_lock(&rli->mts_lock);
+      w->running= FALSE;
+      rli->mts_workers_running--;
+      mts_group_failed(rli, 1);
+      mysql_mutex_unlock(&rli->mts_lock);
+      break;
+    }
+  }
+  DBUG_RETURN(0);
+}
+
+
+/**
+  Stops the workers once they have executed the groups already
+  dispatched to them, and discards the group the coordinator was
+  reading.
+*/
+static void slave_stop_workers(THD *thd, Relay_log_info *rli)
+{
+  DBUG_ENTER("slave_stop_workers");
+
+  if (!rli->workers)
+    DBUG_VOID_RETURN;
+
+  thd_proc_info(thd, "Waiting for slave workers to exit");
+  mysql_mutex_lock(&rli->mts_lock);
+  for (uint i= 0; i < rli->workers_count; i++)
+  {
+    rli->workers[i]->stop= TRUE;
+    mysql_cond_signal(&rli->workers[i]->jobs_cond);
+  }
+  while (rli->mts_workers_running)
+    mysql_cond_wait(&rli->mts_cond, &rli->mts_lock);
+  mysql_mutex_unlock(&rli->mts_lock);
+
+  for (uint i= 0; i < rli->workers_count; i++)
+    delete rli->workers[i];
+  my_free(rli->workers);
+  rli->workers= NULL;
+  rli->workers_count= 0;
+
+  delete rli->mts_group;
+  rli->mts_group= NULL;
+  rli->mts_replay= FALSE;
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Waits until the workers have committed all the groups dispatched to
+  them, so that the coordinator can execute an event itself.
+
+  @retval 0 OK.
+  @retval 1 A worker failed or the coordinator was killed.
+*/
+static int mts_wait_for_workers(THD *thd, Relay_log_info *rli)
+{
+  const char *old_msg;
+  int error;
+
+  mysql_mutex_lock(&rli->mts_lock);
+  old_msg= thd->enter_cond(&rli->mts_cond, &rli->mts_lock,
+                           "Waiting for slave workers to finish");
+  while (rli->mts_groups_committed != rli->mts_groups_assigned &&
+         !rli->mts_failed_seqno && !thd->killed)
+    mysql_cond_wait(&rli->mts_cond, &rli->mts_lock);
+  error= rli->mts_groups_committed != rli->mts_groups_assigned ||
+         rli->mts_failed_seqno;
+  thd->exit_cond(old_msg);
+  return error;
+}
+
+
+/**
+  Returns the worker executing the groups that modify a database.
+*/
+static uint mts_worker_for_db(Relay_log_info *rli, const char *db)
+{
+  ulong nr1= 1, nr2= 4;
+  my_charset_bin.coll->hash_sort(&my_charset_bin, (const uchar*) db,
+                                 strlen(db), &nr1, &nr2);
+  return (uint) (nr1 % rli->workers_count);
+}
+
+
+/**
+  Hands over a complete group to a worker.
+
+  The group goes to the worker of the databases of its table map
+  events. A group that modifies databases belonging to different
+  workers is dispatched once all the workers are idle.
+
+  @retval 0 OK.
+  @retval 1 A worker failed or the coordinator was killed, the group has
+            been discarded.
+*/
+static int mts_dispatch_group(THD *thd, Relay_log_info *rli,
+                              Slave_job_group *group)
+{
+  uint target= UINT_MAX;
+  bool conflict= FALSE;
+  Slave_worker *w;
+  const char *old_msg;
+  DBUG_ENTER("mts_dispatch_group");
+
+  for (uint i= 0; i < group->events.elements; i++)
+  {
+    Log_event *ev= dynamic_element(&group->events, i, Slave_job_event*)->ev;
+    if (ev->get_type_code() == TABLE_MAP_EVENT)
+    {
+      uint idx= mts_worker_for_db(rli, ev->get_db());
+      if (target == UINT_MAX)
+        target= idx;
+      else if (idx != target)
+        conflict= TRUE;
+    }
+  }
+  if (target == UINT_MAX)
+    target= 0;
+  if (conflict && mts_wait_for_workers(thd, rli))
+  {
+    delete group;
+    DBUG_RETURN(1);
+  }
+
+  w= rli->workers[target];
+  mysql_mutex_lock(&rli->mts_lock);
+  old_msg= thd->enter_cond(&rli->mts_cond, &rli->mts_lock,
+                           "Waiting for a slave worker queue");
+  while (w->jobs_count >= SLAVE_WORKER_QUEUE_SIZE &&
+         !rli->mts_failed_seqno && !thd->killed)
+    mysql_cond_wait(&rli->mts_cond, &rli->mts_lock);
+  if (rli->mts_failed_seqno || thd->killed)
+  {
+    thd->exit_cond(old_msg);
+    delete group;
+    DBUG_RETURN(1);
+  }
+  group->seqno= ++rli->mts_groups_assigned;
+  w->enqueue(group);
+  thd->exit_cond(old_msg);
+  DBUG_PRINT("info", ("group %lu dispatched to worker %u",
+                      (ulong) group->seqno, target));
+  DBUG_RETURN(0);
+}
+
+
+/**
+  Called by the coordinator for every event it reads from the relay log.
+
+  Transactions made of row events (BEGIN, table maps, rows events and
+  COMMIT or XID) are collected into rli->mts_group and dispatched to a
+  worker when complete. If the group contains any other event, the
+  coordinator waits for the workers to be idle and executes the group
+  itself: the events are returned by mts_next_event() in place of the
+  relay log.
+
+  @note Called with rli->data_lock held, which is released unless
+  MTS_EVENT_SEQUENTIAL is returned.
+*/
+static enum_mts_schedule
+mts_schedule_event(THD *thd, Relay_log_info *rli, Log_event *ev)
+{
+  Slave_job_group *group= rli->mts_group;
+  Log_event_type type= ev->get_type_code();
+  DBUG_ENTER("mts_schedule_event");
+
+  mysql_mutex_assert_owner(&rli->data_lock);
+  if (!group)
+  {
+    if (type == QUERY_EVENT && !rli->is_in_group() &&
+        !rli->slave_skip_counter &&
+        rli->until_condition == Relay_log_info::UNTIL_NONE &&
+        !strcmp("BEGIN", ((Query_log_event*) ev)->query))
+    {
+      if (!(rli->mts_group= group= new Slave_job_group))
+      {
+        mysql_mutex_unlock(&rli->data_lock);
+        delete ev;
+        DBUG_RETURN(MTS_EVENT_ERROR);
+      }
+    }
+    else
+    {
+      mysql_mutex_unlock(&rli->data_lock);
+      if (mts_wait_for_workers(thd, rli))
+      {
+        delete ev;
+        DBUG_RETURN(MTS_EVENT_ERROR);
+      }
+      mysql_mutex_lock(&rli->data_lock);
+      DBUG_RETURN(MTS_EVENT_SEQUENTIAL);
+    }
+  }
+
+  if (group->add(ev, rli->future_event_relay_log_pos))
+  {
+    mysql_mutex_unlock(&rli->data_lock);
+    delete ev;
+    DBUG_RETURN(MTS_EVENT_ERROR);
+  }
+  rli->inc_event_relay_log_pos();
+
+  switch (type) {
+  case TABLE_MAP_EVENT:
+  case WRITE_ROWS_EVENT:
+  case UPDATE_ROWS_EVENT:
+  case DELETE_ROWS_EVENT:
+    mysql_mutex_unlock(&rli->data_lock);
+    DBUG_RETURN(MTS_EVENT_QUEUED);
+  case XID_EVENT:
+    break;
+  case QUERY_EVENT:
+    if (!strcmp("COMMIT", ((Query_log_event*) ev)->query))
+      break;
+    /* fall through */
+  default:
+    /* The group has to be executed by the coordinator */
+    rli->mts_replay= TRUE;
+    mysql_mutex_unlock(&rli->data_lock);
+    DBUG_RETURN(mts_wait_for_workers(thd, rli) ?
+                MTS_EVENT_ERROR : MTS_EVENT_QUEUED);
+  }
+
+  strmake(group->relay_log_name, rli->event_relay_log_name,
+          sizeof(group->relay_log_name) - 1);
+  strmake(group->master_log_name, rli->group_master_log_name,
+          sizeof(group->master_log_name) - 1);
+  rli->mts_group= NULL;
+  mysql_mutex_unlock(&rli->data_lock);
+  DBUG_RETURN(mts_dispatch_group(thd, rli, group) ?
+              MTS_EVENT_ERROR : MTS_EVENT_QUEUED);
+}
+
+
+/**
+  Returns the next event of a group executed by the coordinator, see
+  mts_schedule_event().
+*/
+static Log_event *mts_next_event(Relay_log_info *rli)
+{
+  Slave_job_group *group= rli->mts_group;
+  Slave_job_event *job= dynamic_element(&group->events, group->replayed++,
+                                        Slave_job_event*);
+  Log_event *ev= job->ev;
+
+  mysql_mutex_assert_owner(&rli->data_lock);
+  job->ev= NULL;                                // Now owned by the caller
+  rli->future_event_relay_log_pos= job->end_pos;
+  if (group->replayed == group->events.elements)
+  {
+    delete group;
+    rli->mts_group= NULL;
+    rli->mts_replay= FALSE;
+  }
+  return ev;
+}
+
+
 /**
   Top-level function for executing the next event from the relay log.
 
@@ -2522,7 +3088,9 @@ static int exec_relay_log_event(THD* thd, Relay_log_info* rli)
    */
   mysql_mutex_lock(&rli->data_lock);
 
-  Log_event * ev = next_event(rli);
+  /* Events of a group that could not be dispatched to a worker */
+  bool replayed= rli->mts_replay;
+  Log_event * ev = replayed ? mts_next_event(rli) : next_event(rli);
 
   DBUG_ASSERT(rli->sql_thd==thd);
 
@@ -2576,6 +3144,18 @@ static int exec_relay_log_event(THD* thd, Relay_log_info* rli)
                       };);
     }
 
+    if (rli->workers_count && !replayed)
+    {
+      switch (mts_schedule_event(thd, rli, ev)) {
+      case MTS_EVENT_QUEUED:
+        DBUG_RETURN(0);
+      case MTS_EVENT_ERROR:
+        DBUG_RETURN(1);
+      case MTS_EVENT_SEQUENTIAL:
+        break;
+      }
+    }
+
     exec_res= apply_event_and_update_pos(ev, thd, rli);
 
     /*
@@ -2631,6 +3211,10 @@ static int exec_relay_log_event(THD* thd, Relay_log_info* rli)
           {
             exec_res= 0;
             rli->cleanup_context(thd, 1);
+            /* The group is read again from the relay log */
+            delete rli->mts_group;
+            rli->mts_group= NULL;
+            rli->mts_replay= FALSE;
             /* chance for concurrent connection to get more locks */
             slave_sleep(thd, min(rli->trans_retries, MAX_SLAVE_RETRY_PAUSE),
                        sql_slave_killed, rli);
@@ -3350,6 +3934,14 @@ log '%s' at position %s, relay log '%s' position: %s", RPL_LOG_NAME,
     }
   }
 
+  if (opt_slave_parallel_workers &&
+      slave_start_workers(rli, (uint) opt_slave_parallel_workers))
+  {
+    rli->report(ERROR_LEVEL, ER_OUT_OF_RESOURCES,
+                "Slave SQL thread aborted. Can't start slave workers");
+    goto err;
+  }
+
   /*
     First check until condition - probably there is nothing to execute. We
     do not want to wait for next event in this case.
@@ -3467,6 +4059,9 @@ the slave SQL thread with \"SLAVE START\". We stopped at log \
     }
   }
 
+  /* The position is final once the dispatched groups are committed */
+  slave_stop_workers(thd, rli);
+
   /* Thread stopped. Print the current replication position to the log */
   sql_print_information("Slave SQL thread exiting, replication stopped in log "
                         "'%s' at position %s",
@@ -3482,6 +4077,7 @@ the slave SQL thread with \"SLAVE START\". We stopped at log \
   */
   thd->clear_error();
   rli->cleanup_context(thd, 1);
+  slave_stop_workers(thd, rli);
   /*
     Some extra safety, which should not been needed (normally, event deletion
     should already have done these assignments (each event which sets these
@@ -144,6 +144,15 @@ extern ulonglong relay_log_space_limit;
 */
 #define SLAVE_FORCE_ALL 4
 
+/* Upper bound of --slave-parallel-workers */
+#define MAX_SLAVE_PARALLEL_WORKERS 1024
+
+/*
+  Groups queued for a worker of the multi-threaded applier before the
+  coordinator waits for the worker to catch up.
+*/
+#define SLAVE_WORKER_QUEUE_SIZE 16
+
 int init_slave();
 int init_recovery(Master_info* mi, const char** errmsg);
 void init_slave_skip_errors(const char* arg);
@@ -54,6 +54,7 @@
 #include "sql_table.h"                          // build_table_filename
 #include "datadict.h"   // dd_frm_type()
 #include "sql_hset.h"   // Hash_set
+#include "table_cache.h" // Table_cache_manager, Table_cache
 #ifdef  __WIN__
 #include <io.h>
 #endif
@@ -158,9 +159,11 @@ Repair_mrg_table_error_handler::handle_condition(THD *,
 */
 
 /**
-  Protects table_def_hash, used and unused lists in the
-  TABLE_SHARE object, LRU lists of used TABLEs and used
-  TABLE_SHAREs, refresh_version and the table id counter.
+  Protects table_def_hash, LRU list of unused TABLE_SHAREs and the
+  table id counter. Together with the locks of all table cache
+  instances it also protects refresh_version and TABLE_SHARE::version.
+  Lists of used and unused TABLE objects are protected by the lock
+  of the table cache instance which holds them (see Table_cache).
 */
 mysql_mutex_t LOCK_open;
 
@@ -189,19 +192,6 @@ static void init_tdc_psi_keys(void)
 #endif /* HAVE_PSI_INTERFACE */
 
 
-/**
-   Total number of TABLE instances for tables in the table definition cache
-   (both in use by threads and not in use). This value is accessible to user
-   as "Open_tables" status variable.
-*/
-uint  table_cache_count= 0;
-/**
-   List that contains all TABLE instances for tables in the table definition
-   cache that are not in use by any thread. Recently used TABLE instances are
-   appended to the end of the list. Thus the beginning of the list contains
-   tables which have been least recently used.
-*/
-TABLE *unused_tables;
 HASH table_def_cache;
 static TABLE_SHARE *oldest_unused_share, end_of_unused_share;
 static bool table_def_inited= 0;
@@ -211,7 +201,6 @@ static bool check_and_update_table_version(THD *thd, TABLE_LIST *tables,
                                            TABLE_SHARE *table_share);
 static bool open_table_entry_fini(THD *thd, TABLE_SHARE *share, TABLE *entry);
 static bool auto_repair_table(THD *thd, TABLE_LIST *table_list);
-static void free_cache_entry(TABLE *entry);
 static bool
 has_write_table_with_auto_increment(TABLE_LIST *tables);
 static bool
@@ -220,71 +209,10 @@ static bool has_write_table_auto_increment_not_first_in_pk(TABLE_LIST *tables);
 
 uint cached_open_tables(void)
 {
-  return table_cache_count;
+  return table_cache_manager.cached_tables();
 }
 
 
-#ifdef EXTRA_DEBUG
-static void check_unused(void)
-{
-  uint count= 0, open_files= 0, idx= 0;
-  TABLE *cur_link, *start_link, *entry;
-  TABLE_SHARE *share;
-
-  if ((start_link=cur_link=unused_tables))
-  {
-    do
-    {
-      if (cur_link != cur_link->next->prev || cur_link != cur_link->prev->next)
-      {
-	DBUG_PRINT("error",("Unused_links aren't linked properly")); /* purecov: inspected */
-	return; /* purecov: inspected */
-      }
-    } while (count++ < table_cache_count &&
-	     (cur_link=cur_link->next) != start_link);
-    if (cur_link != start_link)
-    {
-      DBUG_PRINT("error",("Unused_links aren't connected")); /* purecov: inspected */
-    }
-  }
-  for (idx=0 ; idx < table_def_cache.records ; idx++)
-  {
-    share= (TABLE_SHARE*) my_hash_element(&table_def_cache, idx);
-
-    I_P_List_iterator<TABLE, TABLE_share> it(share->free_tables);
-    while ((entry= it++))
-    {
-      /* We must not have TABLEs in the free list that have their file closed. */
-      DBUG_ASSERT(entry->db_stat && entry->file);
-      /* Merge children should be detached from a merge parent */
-      DBUG_ASSERT(! entry->file->extra(HA_EXTRA_IS_ATTACHED_CHILDREN));
-
-      if (entry->in_use)
-      {
-        DBUG_PRINT("error",("Used table is in share's list of unused tables")); /* purecov: inspected */
-      }
-      count--;
-      open_files++;
-    }
-    it.init(share->used_tables);
-    while ((entry= it++))
-    {
-      if (!entry->in_use)
-      {
-        DBUG_PRINT("error",("Unused table is in share's list of used tables")); /* purecov: inspected */
-      }
-      open_files++;
-    }
-  }
-  if (count != 0)
-  {
-    DBUG_PRINT("error",("Unused_links doesn't match open_cache: diff: %d", /* purecov: inspected */
-			count)); /* purecov: inspected */
-  }
-}
-#else
-#define check_unused()
-#endif
 
 
 /*
@@ -360,7 +288,6 @@ static void table_def_free_entry(TABLE_SHARE *share)
 
 bool table_def_init(void)
 {
-  table_def_inited= 1;
 #ifdef HAVE_PSI_INTERFACE
   init_tdc_psi_keys();
 #endif
@@ -368,6 +295,12 @@ bool table_def_init(void)
   oldest_unused_share= &end_of_unused_share;
   end_of_unused_share.prev= &oldest_unused_share;
 
+  if (table_cache_manager.init())
+  {
+    mysql_mutex_destroy(&LOCK_open);
+    return true;
+  }
+  table_def_inited= 1;
 
   return my_hash_init(&table_def_cache, &my_charset_bin, table_def_size,
                       0, 0, table_def_key,
@@ -385,7 +318,7 @@ void table_def_start_shutdown(void)
 {
   if (table_def_inited)
   {
-    mysql_mutex_lock(&LOCK_open);
+    table_cache_manager.lock_all_and_tdc();
     /*
       Ensure that TABLE and TABLE_SHARE objects which are created for
       tables that are open during process of plugins' shutdown are
@@ -393,7 +326,7 @@ void table_def_start_shutdown(void)
       plugins minimal and allows shutdown to proceed smoothly.
     */
     table_def_shutdown_in_progress= TRUE;
-    mysql_mutex_unlock(&LOCK_open);
+    table_cache_manager.unlock_all_and_tdc();
     /* Free all cached but unused TABLEs and TABLE_SHAREs. */
     close_cached_tables(NULL, NULL, FALSE, LONG_TIMEOUT);
   }
@@ -406,6 +339,8 @@ void table_def_free(void)
   if (table_def_inited)
   {
     table_def_inited= 0;
+    /* Destroy table cache instances. */
+    table_cache_manager.destroy();
     /* Free table definitions. */
     my_hash_free(&table_def_cache);
     mysql_mutex_destroy(&LOCK_open);
@@ -420,121 +355,6 @@ uint cached_table_definitions(void)
 }
 
 
-/*
-  Auxiliary routines for manipulating with per-share used/unused and
-  global unused lists of TABLE objects and table_cache_count counter.
-  Responsible for preserving invariants between those lists, counter
-  and TABLE::in_use member.
-  In fact those routines implement sort of implicit table cache as
-  part of table definition cache.
-*/
-
-
-/**
-   Add newly created TABLE object for table share which is going
-   to be used right away.
-*/
-
-static void table_def_add_used_table(THD *thd, TABLE *table)
-{
-  DBUG_ASSERT(table->in_use == thd);
-  table->s->used_tables.push_front(table);
-  table_cache_count++;
-}
-
-
-/**
-   Prepare used or unused TABLE instance for destruction by removing
-   it from share's and global list.
-*/
-
-static void table_def_remove_table(TABLE *table)
-{
-  if (table->in_use)
-  {
-    /* Remove from per-share chain of used TABLE objects. */
-    table->s->used_tables.remove(table);
-  }
-  else
-  {
-    /* Remove from per-share chain of unused TABLE objects. */
-    table->s->free_tables.remove(table);
-
-    /* And global unused chain. */
-    table->next->prev=table->prev;
-    table->prev->next=table->next;
-    if (table == unused_tables)
-    {
-      unused_tables=unused_tables->next;
-      if (table == unused_tables)
-	unused_tables=0;
-    }
-    check_unused();
-  }
-  table_cache_count--;
-}
-
-
-/**
-   Mark already existing TABLE instance as used.
-*/
-
-static void table_def_use_table(THD *thd, TABLE *table)
-{
-  DBUG_ASSERT(!table->in_use);
-
-  /* Unlink table from list of unused tables for this share. */
-  table->s->free_tables.remove(table);
-  /* Unlink able from global unused tables list. */
-  if (table == unused_tables)
-  {						// First unused
-    unused_tables=unused_tables->next;	        // Remove from link
-    if (table == unused_tables)
-      unused_tables=0;
-  }
-  table->prev->next=table->next;		/* Remove from unused list */
-  table->next->prev=table->prev;
-  check_unused();
-  /* Add table to list of used tables for this share. */
-  table->s->used_tables.push_front(table);
-  table->in_use= thd;
-  /* The ex-unused table must be fully functional. */
-  DBUG_ASSERT(table->db_stat && table->file);
-  /* The children must be detached from the table. */
-  DBUG_ASSERT(! table->file->extra(HA_EXTRA_IS_ATTACHED_CHILDREN));
-}
-
-
-/**
-   Mark already existing used TABLE instance as unused.
-*/
-
-static void table_def_unuse_table(TABLE *table)
-{
-  DBUG_ASSERT(table->in_use);
-
-  /* We shouldn't put the table to 'unused' list if the share is old. */
-  DBUG_ASSERT(! table->s->has_old_version());
-
-  table->in_use= 0;
-  /* Remove table from the list of tables used in this share. */
-  table->s->used_tables.remove(table);
-  /* Add table to the list of unused TABLE objects for this share. */
-  table->s->free_tables.push_front(table);
-  /* Also link it last in the global list of unused TABLE objects. */
-  if (unused_tables)
-  {
-    table->next=unused_tables;
-    table->prev=unused_tables->prev;
-    unused_tables->prev=table;
-    table->prev->next=table;
-  }
-  else
-    unused_tables=table->next=table->prev=table;
-  check_unused();
-}
-
-
 /*
   Get TABLE_SHARE for a table.
 
@@ -850,7 +670,7 @@ OPEN_TABLE_LIST *list_open_tables(THD *thd, const char *db, const char *wild)
   TABLE_LIST table_list;
   DBUG_ENTER("list_open_tables");
 
-  mysql_mutex_lock(&LOCK_open);
+  table_cache_manager.lock_all_and_tdc();
   bzero((char*) &table_list,sizeof(table_list));
   start_list= &open_list;
   open_list=0;
@@ -883,14 +703,14 @@ OPEN_TABLE_LIST *list_open_tables(THD *thd, const char *db, const char *wild)
 		  share->db.str)+1,
 	   share->table_name.str);
     (*start_list)->in_use= 0;
-    I_P_List_iterator<TABLE, TABLE_share> it(share->used_tables);
+    Table_cache_iterator it(share);
     while (it++)
       ++(*start_list)->in_use;
     (*start_list)->locked= 0;                   /* Obsolete. */
     start_list= &(*start_list)->next;
     *start_list=0;
   }
-  mysql_mutex_unlock(&LOCK_open);
+  table_cache_manager.unlock_all_and_tdc();
   DBUG_RETURN(open_list);
 }
 
@@ -914,30 +734,6 @@ void intern_close_table(TABLE *table)
   DBUG_VOID_RETURN;
 }
 
-/*
-  Remove table from the open table cache
-
-  SYNOPSIS
-    free_cache_entry()
-    table		Table to remove
-
-  NOTE
-    We need to have a lock on LOCK_open when calling this
-*/
-
-static void free_cache_entry(TABLE *table)
-{
-  DBUG_ENTER("free_cache_entry");
-
-  /* This should be done before releasing table share. */
-  table_def_remove_table(table);
-
-  intern_close_table(table);
-
-  my_free(table);
-  DBUG_VOID_RETURN;
-}
-
 /* Free resources allocated by filesort() and read_record() */
 
 void free_io_cache(TABLE *table)
@@ -959,15 +755,16 @@ void free_io_cache(TABLE *table)
 
    @param share Table share.
 
-   @pre Caller should have LOCK_open mutex.
+   @pre Caller should have LOCK_open mutex and locks on all
+        table cache instances.
 */
 
 static void kill_delayed_threads_for_table(TABLE_SHARE *share)
 {
-  I_P_List_iterator<TABLE, TABLE_share> it(share->used_tables);
+  Table_cache_iterator it(share);
   TABLE *tab;
 
-  mysql_mutex_assert_owner(&LOCK_open);
+  table_cache_manager.assert_owner_all_and_tdc();
 
   while ((tab= it++))
   {
@@ -1018,7 +815,7 @@ bool close_cached_tables(THD *thd, TABLE_LIST *tables,
   DBUG_ENTER("close_cached_tables");
   DBUG_ASSERT(thd || (!wait_for_refresh && !tables));
 
-  mysql_mutex_lock(&LOCK_open);
+  table_cache_manager.lock_all_and_tdc();
   if (!tables)
   {
     /*
@@ -1029,6 +826,9 @@ bool close_cached_tables(THD *thd, TABLE_LIST *tables,
       shares from TDC happens atomically under protection of LOCK_open,
       or putting it another way that TDC does not contain old shares
       which don't have any tables used.
+      Locks on all table cache instances are needed as well, since
+      open_table() checks refresh_version and TABLE_SHARE::version
+      holding only the lock of its own instance.
     */
     refresh_version++;
     DBUG_PRINT("tcache", ("incremented global refresh_version to: %lu",
@@ -1038,8 +838,7 @@ bool close_cached_tables(THD *thd, TABLE_LIST *tables,
       Get rid of all unused TABLE and TABLE_SHARE instances. By doing
       this we automatically close all tables which were marked as "old".
     */
-    while (unused_tables)
-      free_cache_entry(unused_tables);
+    table_cache_manager.free_all_unused_tables();
     /* Free table shares which were not freed implicitly by loop above. */
     while (oldest_unused_share->next)
       (void) my_hash_delete(&table_def_cache, (uchar*) oldest_unused_share);
@@ -1064,7 +863,7 @@ bool close_cached_tables(THD *thd, TABLE_LIST *tables,
       wait_for_refresh=0;			// Nothing to wait for
   }
 
-  mysql_mutex_unlock(&LOCK_open);
+  table_cache_manager.unlock_all_and_tdc();
 
   if (!wait_for_refresh)
     DBUG_RETURN(result);
@@ -1119,6 +918,12 @@ bool close_cached_tables(THD *thd, TABLE_LIST *tables,
     mysql_ha_flush(thd);
     DEBUG_SYNC(thd, "after_flush_unlock");
 
+    /*
+      We might have to wait for the flush, so our metadata locks must be
+      visible to the deadlock detector. This can't be done under LOCK_open.
+    */
+    thd->mdl_context.materialize_fast_path_locks();
+
     mysql_mutex_lock(&LOCK_open);
 
     if (!tables)
@@ -1599,26 +1404,24 @@ bool close_thread_table(THD *thd, TABLE **table_ptr)
     table->file->ha_reset();
   }
 
-  mysql_mutex_lock(&LOCK_open);
+  Table_cache *tc= table_cache_manager.get_cache(thd);
+
+  tc->lock();
 
   if (table->s->has_old_version() || table->needs_reopen() ||
       table_def_shutdown_in_progress)
   {
-    free_cache_entry(table);
+    tc->remove_table(table);
+    mysql_mutex_lock(&LOCK_open);
+    intern_close_table(table);
+    mysql_mutex_unlock(&LOCK_open);
+    my_free(table);
     found_old_table= 1;
   }
   else
-  {
-    DBUG_ASSERT(table->file);
-    table_def_unuse_table(table);
-    /*
-      We free the least used table, not the subject table,
-      to keep the LRU order.
-    */
-    if (table_cache_count > table_cache_size)
-      free_cache_entry(unused_tables);
-  }
-  mysql_mutex_unlock(&LOCK_open);
+    tc->release_table(thd, table);
+
+  tc->unlock();
   DBUG_RETURN(found_old_table);
 }
 
@@ -2602,6 +2405,9 @@ tdc_wait_for_old_version(THD *thd, const char *db, const char *table_name,
   TABLE_SHARE *share;
   bool res= FALSE;
 
+  /* See comment in close_cached_tables(). */
+  thd->mdl_context.materialize_fast_path_locks();
+
   mysql_mutex_lock(&LOCK_open);
   if ((share= get_cached_table_share(db, table_name)) &&
       share->has_old_version())
@@ -2940,6 +2746,48 @@ bool open_table(THD *thd, TABLE_LIST *table_list, MEM_ROOT *mem_root,
     DBUG_RETURN(FALSE);
 
 retry_share:
+  {
+    Table_cache *tc= table_cache_manager.get_cache(thd);
+
+    tc->lock();
+
+    /*
+      Try to get an unused TABLE object from the table cache of this
+      connection. This does not require LOCK_open.
+    */
+    if ((table= tc->get_table(thd, hash_value, key, key_length)))
+    {
+      if (!(flags & MYSQL_OPEN_IGNORE_FLUSH))
+      {
+        /*
+          TABLE_SHARE::version and refresh_version are only changed while
+          holding LOCK_open AND locks on all table cache instances, so it
+          is safe to compare them holding only the lock of this instance.
+          Table cache never contains unused TABLE objects with old version.
+        */
+        DBUG_ASSERT(!table->s->has_old_version());
+        /*
+          Still some of already opened tables might have become outdated
+          (e.g. due to a concurrent table flush). So we need to compare
+          the version of opened tables with the one of the TABLE we got.
+        */
+        if (thd->open_tables &&
+            thd->open_tables->s->version != table->s->version)
+        {
+          tc->release_table(thd, table);
+          tc->unlock();
+          (void)ot_ctx->request_backoff_action(Open_table_context::OT_REOPEN_TABLES,
+                                               NULL);
+          DBUG_RETURN(TRUE);
+        }
+      }
+      tc->unlock();
+      share= table->s;
+      goto table_found;
+    }
+
+    tc->unlock();
+  }
 
   mysql_mutex_lock(&LOCK_open);
 
@@ -3068,62 +2916,59 @@ retry_share:
     }
   }
 
-  if (!share->free_tables.is_empty())
-  {
-    table= share->free_tables.front();
-    table_def_use_table(thd, table);
-    /* We need to release share as we have EXTRA reference to it in our hands. */
-    release_table_share(share);
-  }
-  else
-  {
-    /* We have too many TABLE instances around let us try to get rid of them. */
-    while (table_cache_count > table_cache_size && unused_tables)
-      free_cache_entry(unused_tables);
+  mysql_mutex_unlock(&LOCK_open);
 
-    mysql_mutex_unlock(&LOCK_open);
+  /* make a new table */
+  if (!(table=(TABLE*) my_malloc(sizeof(*table),MYF(MY_WME))))
+    goto err_lock;
 
-    /* make a new table */
-    if (!(table=(TABLE*) my_malloc(sizeof(*table),MYF(MY_WME))))
-      goto err_lock;
+  error= open_table_from_share(thd, share, alias,
+                               (uint) (HA_OPEN_KEYFILE |
+                                       HA_OPEN_RNDFILE |
+                                       HA_GET_INDEX |
+                                       HA_TRY_READ_ONLY),
+                               (READ_KEYINFO | COMPUTE_TYPES |
+                                EXTRA_RECORD),
+                               thd->open_options, table, FALSE);
 
-    error= open_table_from_share(thd, share, alias,
-                                 (uint) (HA_OPEN_KEYFILE |
-                                         HA_OPEN_RNDFILE |
-                                         HA_GET_INDEX |
-                                         HA_TRY_READ_ONLY),
-                                 (READ_KEYINFO | COMPUTE_TYPES |
-                                  EXTRA_RECORD),
-                                 thd->open_options, table, FALSE);
+  if (error)
+  {
+    my_free(table);
 
-    if (error)
-    {
-      my_free(table);
+    if (error == 7)
+      (void) ot_ctx->request_backoff_action(Open_table_context::OT_DISCOVER,
+                                            table_list);
+    else if (share->crashed)
+      (void) ot_ctx->request_backoff_action(Open_table_context::OT_REPAIR,
+                                            table_list);
 
-      if (error == 7)
-        (void) ot_ctx->request_backoff_action(Open_table_context::OT_DISCOVER,
-                                              table_list);
-      else if (share->crashed)
-        (void) ot_ctx->request_backoff_action(Open_table_context::OT_REPAIR,
-                                              table_list);
+    goto err_lock;
+  }
 
-      goto err_lock;
-    }
+  if (open_table_entry_fini(thd, share, table))
+  {
+    closefrm(table, 0);
+    my_free(table);
+    goto err_lock;
+  }
+
+  {
+    /* Add new TABLE object to table cache for this connection. */
+    Table_cache *tc= table_cache_manager.get_cache(thd);
+
+    tc->lock();
 
-    if (open_table_entry_fini(thd, share, table))
+    if (tc->add_used_table(thd, table))
     {
+      tc->unlock();
       closefrm(table, 0);
       my_free(table);
       goto err_lock;
     }
-
-    mysql_mutex_lock(&LOCK_open);
-    /* Add table to the share's used tables list. */
-    table_def_add_used_table(thd, table);
+    tc->unlock();
   }
 
-  mysql_mutex_unlock(&LOCK_open);
-
+table_found:
   table->mdl_ticket= mdl_ticket;
 
   table->next= thd->open_tables;		/* Link into simple list */
@@ -3929,10 +3774,13 @@ static bool auto_repair_table(THD *thd, TABLE_LIST *table_list)
 
   mysql_mutex_lock(&LOCK_open);
   release_table_share(share);
+  mysql_mutex_unlock(&LOCK_open);
   /* Remove the repaired share from the table cache. */
   tdc_remove_table(thd, TDC_RT_REMOVE_ALL,
                    table_list->db, table_list->table_name,
-                   TRUE);
+                   FALSE);
+  return result;
+
 end_unlock:
   mysql_mutex_unlock(&LOCK_open);
   return result;
@@ -5485,6 +5333,12 @@ end:
                               for details).
   @param prelocking_strategy  Strategy which specifies how prelocking algorithm
                               should work for this statement.
+  @param[out] counter         Number of tables opened, for lock_tables().
+  @param[in,out] prune_before_lock
+                              NULL if the tables are always locked. Otherwise
+                              TRUE on entry if partitions may be pruned before
+                              the table is locked; on return TRUE if the
+                              tables were left unlocked for that.
 
   @note
     The thr_lock locks will automatically be freed by
@@ -5494,16 +5348,16 @@ end:
   @retval TRUE   Error
 */
 
-bool open_and_lock_tables(THD *thd, TABLE_LIST *tables,
-                          bool derived, uint flags,
-                          Prelocking_strategy *prelocking_strategy)
+static bool open_and_lock_tables(THD *thd, TABLE_LIST *tables,
+                                 bool derived, uint flags,
+                                 Prelocking_strategy *prelocking_strategy,
+                                 uint *counter, bool *prune_before_lock)
 {
-  uint counter;
   MDL_savepoint mdl_savepoint= thd->mdl_context.mdl_savepoint();
   DBUG_ENTER("open_and_lock_tables");
   DBUG_PRINT("enter", ("derived handling: %d", derived));
 
-  if (open_tables(thd, &tables, &counter, flags, prelocking_strategy))
+  if (open_tables(thd, &tables, counter, flags, prelocking_strategy))
     goto err;
 
   DBUG_EXECUTE_IF("sleep_open_and_lock_after_open", {
@@ -5512,7 +5366,18 @@ bool open_and_lock_tables(THD *thd, TABLE_LIST *tables,
                   my_sleep(6000000);
                   thd->proc_info= old_proc_info;});
 
-  if (lock_tables(thd, tables, counter, flags))
+  if (prune_before_lock)
+  {
+#ifdef WITH_PARTITION_STORAGE_ENGINE
+    *prune_before_lock= (*prune_before_lock &&
+                         can_prune_partitions_before_lock(thd, tables));
+#else
+    *prune_before_lock= FALSE;
+#endif
+  }
+
+  if ((!prune_before_lock || !*prune_before_lock) &&
+      lock_tables(thd, tables, *counter, flags))
     goto err;
 
   if (derived)
@@ -5540,6 +5405,46 @@ err:
 }
 
 
+bool open_and_lock_tables(THD *thd, TABLE_LIST *tables,
+                          bool derived, uint flags,
+                          Prelocking_strategy *prelocking_strategy)
+{
+  uint counter;
+  return open_and_lock_tables(thd, tables, derived, flags,
+                              prelocking_strategy, &counter, NULL);
+}
+
+
+/**
+  Open the table of a single table INSERT, UPDATE or DELETE and process
+  derived tables, leaving the table unlocked if the partitions to lock
+  can be pruned first.
+
+  @param thd                     Thread context.
+  @param tables                  List of tables for open and locking.
+  @param try_prune               If the statement may prune partitions
+                                 before locking.
+  @param[out] counter            Number of tables opened, for lock_tables().
+  @param[out] prune_before_lock  TRUE if the tables were not locked. The
+                                 caller restricts
+                                 partition_info::lock_partitions and then
+                                 calls lock_tables().
+
+  @retval FALSE  OK.
+  @retval TRUE   Error
+*/
+
+bool open_tables_for_pruning(THD *thd, TABLE_LIST *tables, bool try_prune,
+                             uint *counter, bool *prune_before_lock)
+{
+  DML_prelocking_strategy prelocking_strategy;
+
+  *prune_before_lock= try_prune;
+  return open_and_lock_tables(thd, tables, TRUE, 0, &prelocking_strategy,
+                              counter, prune_before_lock);
+}
+
+
 /*
   Open all tables in list and process derived tables
 
@@ -6133,7 +6038,8 @@ find_field_in_view(THD *thd, TABLE_LIST *table_list,
   Query_arena *arena= 0, backup;  
   
   DBUG_ASSERT(table_list->schema_table_reformed ||
-              (ref != 0 && table_list->view != 0));
+              (ref != 0 &&
+               (table_list->view != 0 || table_list->is_merged_derived())));
   for (; !field_it.end_of_fields(); field_it.next())
   {
     if (!my_strcasecmp(system_charset_info, field_it.name(), name))
@@ -6701,7 +6607,8 @@ find_field_in_tables(THD *thd, Item_ident *item,
       find_field_in_table even in the case of information schema tables
       when table_ref->field_translation != NULL.
       */
-    if (table_ref->table && !table_ref->view)
+    if (table_ref->table && !table_ref->view &&
+        !table_ref->is_merged_derived())
     {
       found= find_field_in_table(thd, table_ref->table, name, length,
                                  TRUE, &(item->cached_field_index));
@@ -7982,7 +7889,7 @@ TABLE_LIST **make_leaves_list(TABLE_LIST **list, TABLE_LIST *tables)
   {
     if (table->merge_underlying_list)
     {
-      DBUG_ASSERT(table->view &&
+      DBUG_ASSERT((table->view || table->is_merged_derived()) &&
                   table->effective_algorithm == VIEW_ALGORITHM_MERGE);
       list= make_leaves_list(list, table->merge_underlying_list);
     }
@@ -8071,7 +7978,7 @@ bool setup_tables(THD *thd, Name_resolution_context *context,
   {
     if (table_list->merge_underlying_list)
     {
-      DBUG_ASSERT(table_list->view &&
+      DBUG_ASSERT((table_list->view || table_list->is_merged_derived()) &&
                   table_list->effective_algorithm == VIEW_ALGORITHM_MERGE);
       Query_arena *arena= thd->stmt_arena, backup;
       bool res;
@@ -8084,6 +7991,11 @@ bool setup_tables(THD *thd, Name_resolution_context *context,
         thd->restore_active_arena(arena, &backup);
       if (res)
         DBUG_RETURN(1);
+#ifndef NO_EMBEDDED_ACCESS_CHECKS
+      if (table_list->is_merged_derived() &&
+          table_list->check_derived_column_grants(thd))
+        DBUG_RETURN(1);
+#endif
     }
   }
 
@@ -8284,8 +8196,10 @@ insert_fields(THD *thd, Name_resolution_context *context, const char *db_name,
        information_schema table, or a nested table reference. See the comment
        for TABLE_LIST.
     */
-    if (!((table && !tables->view && (table->grant.privilege & SELECT_ACL)) ||
-          (tables->view && (tables->grant.privilege & SELECT_ACL))) &&
+    if (!((table && !tables->view && !tables->is_merged_derived() &&
+           (table->grant.privilege & SELECT_ACL)) ||
+          ((tables->view || tables->is_merged_derived()) &&
+           (tables->grant.privilege & SELECT_ACL))) &&
         !any_privileges)
     {
       field_iterator.set(tables);
@@ -8836,10 +8750,9 @@ my_bool mysql_rm_tmp_tables(void)
 
 void tdc_flush_unused_tables()
 {
-  mysql_mutex_lock(&LOCK_open);
-  while (unused_tables)
-    free_cache_entry(unused_tables);
-  mysql_mutex_unlock(&LOCK_open);
+  table_cache_manager.lock_all_and_tdc();
+  table_cache_manager.free_all_unused_tables();
+  table_cache_manager.unlock_all_and_tdc();
 }
 
 
@@ -8933,7 +8846,8 @@ bool mysql_notify_thread_having_shared_lock(THD *thd, THD *in_use,
                                                 remove TABLE_SHARE).
    @param  db           Name of database
    @param  table_name   Name of table
-   @param  has_lock     If TRUE, LOCK_open is already acquired
+   @param  has_lock     If TRUE, LOCK_open and locks on all table cache
+                        instances are already acquired
 
    @note It assumes that table instances are already not used by any
    (other) thread (this should be achieved by using meta-data locks).
@@ -8945,15 +8859,12 @@ void tdc_remove_table(THD *thd, enum_tdc_remove_table_type remove_type,
 {
   char key[MAX_DBKEY_LENGTH];
   uint key_length;
-  TABLE *table;
   TABLE_SHARE *share;
 
   if (! has_lock)
-    mysql_mutex_lock(&LOCK_open);
+    table_cache_manager.lock_all_and_tdc();
   else
-  {
-    mysql_mutex_assert_owner(&LOCK_open);
-  }
+    table_cache_manager.assert_owner_all_and_tdc();
 
   DBUG_ASSERT(remove_type == TDC_RT_REMOVE_UNUSED ||
               thd->mdl_context.is_lock_owner(MDL_key::TABLE, db, table_name,
@@ -8966,22 +8877,6 @@ void tdc_remove_table(THD *thd, enum_tdc_remove_table_type remove_type,
   {
     if (share->ref_count)
     {
-      I_P_List_iterator<TABLE, TABLE_share> it(share->free_tables);
-#ifndef DBUG_OFF
-      if (remove_type == TDC_RT_REMOVE_ALL)
-      {
-        DBUG_ASSERT(share->used_tables.is_empty());
-      }
-      else if (remove_type == TDC_RT_REMOVE_NOT_OWN)
-      {
-        I_P_List_iterator<TABLE, TABLE_share> it2(share->used_tables);
-        while ((table= it2++))
-          if (table->in_use != thd)
-          {
-            DBUG_ASSERT(0);
-          }
-      }
-#endif
       /*
         Set share's version to zero in order to ensure that it gets
         automatically deleted once it is no longer referenced.
@@ -8995,15 +8890,14 @@ void tdc_remove_table(THD *thd, enum_tdc_remove_table_type remove_type,
       */
       share->version= 0;
 
-      while ((table= it++))
-        free_cache_entry(table);
+      table_cache_manager.free_table(thd, remove_type, share);
     }
     else
       (void) my_hash_delete(&table_def_cache, (uchar*) share);
   }
 
   if (! has_lock)
-    mysql_mutex_unlock(&LOCK_open);
+    table_cache_manager.unlock_all_and_tdc();
 }
 
 
@@ -893,7 +893,7 @@ Query_cache::insert(Query_cache_tls *query_cache_tls,
   DBUG_ENTER("Query_cache::insert");
 
   /* See the comment on double-check locking usage above. */
-  if (is_disabled() || query_cache_tls->first_query_block == NULL)
+  if (query_cache_tls->first_query_block == NULL)
     DBUG_VOID_RETURN;
 
   QC_DEBUG_SYNC("wait_in_query_cache_insert");
@@ -930,8 +930,8 @@ Query_cache::insert(Query_cache_tls *query_cache_tls,
     header->result(result);
     DBUG_PRINT("qcache", ("free query 0x%lx", (ulong) query_block));
     // The following call will remove the lock on query_block
-    query_cache.free_query(query_block);
-    query_cache.refused++;
+    free_query(query_block);
+    refused++;
     // append_result_data no success => we need unlock
     unlock();
     DBUG_VOID_RETURN;
@@ -953,7 +953,7 @@ Query_cache::abort(Query_cache_tls *query_cache_tls)
   THD *thd= current_thd;
 
   /* See the comment on double-check locking usage above. */
-  if (is_disabled() || query_cache_tls->first_query_block == NULL)
+  if (query_cache_tls->first_query_block == NULL)
     DBUG_VOID_RETURN;
 
   if (try_lock())
@@ -1041,9 +1041,9 @@ void Query_cache::end_of_result(THD *thd)
     }
     last_result_block= header->result()->prev;
     allign_size= ALIGN_SIZE(last_result_block->used);
-    len= max(query_cache.min_allocation_unit, allign_size);
-    if (last_result_block->length >= query_cache.min_allocation_unit + len)
-      query_cache.split_block(last_result_block,len);
+    len= max(min_allocation_unit, allign_size);
+    if (last_result_block->length >= min_allocation_unit + len)
+      split_block(last_result_block,len);
 
     header->found_rows(limit_found_rows);
     header->result()->type= Query_cache_block::RESULT;
@@ -1078,19 +1078,256 @@ void mysql_query_cache_invalidate4(THD *thd,
 }
 
 
+/*****************************************************************************
+   Query_cache_manager methods
+*****************************************************************************/
+
+/**
+  Get the query cache instance for a query.
+
+  Both lookup and store of a query use the text of the statement, so
+  they always come to the same instance.
+*/
+
+Query_cache *Query_cache_manager::get_query_cache(const char *query,
+                                                  size_t query_length)
+{
+  ulong nr1= 1, nr2= 4;
+
+  if (query_cache_instances == 1)
+    return &m_query_cache[0];
+
+  my_charset_bin.coll->hash_sort(&my_charset_bin, (const uchar*) query,
+                                 query_length, &nr1, &nr2);
+  return &m_query_cache[nr1 % query_cache_instances];
+}
+
+
+/** Init all instances of the query cache (mutexes). */
+
+void Query_cache_manager::init()
+{
+  DBUG_ENTER("Query_cache_manager::init");
+  for (uint i= 0; i < query_cache_instances; i++)
+    m_query_cache[i].init();
+  /*
+    If we explicitly turn off query cache from the command line query cache will
+    be disabled for the reminder of the server life time. This is because we
+    want to avoid locking the QC specific mutex if query cache isn't going to
+    be used.
+  */
+  if (global_system_variables.query_cache_type == 0)
+    disable_query_cache();
+
+  DBUG_VOID_RETURN;
+}
+
+
+/** Destroy all instances of the query cache. */
+
+void Query_cache_manager::destroy()
+{
+  for (uint i= 0; i < query_cache_instances; i++)
+    m_query_cache[i].destroy();
+}
+
+
+/**
+  Resize the query cache. The memory is divided evenly between the
+  instances.
+
+  @return Memory used by all instances, 0 if the cache is disabled.
+*/
+
+ulong Query_cache_manager::resize(ulong query_cache_size_arg)
+{
+  ulong instance_size= query_cache_size_arg / query_cache_instances;
+  ulong new_query_cache_size= 0;
+
+  for (uint i= 0; i < query_cache_instances; i++)
+    new_query_cache_size+= m_query_cache[i].resize(instance_size);
+
+  query_cache_size= new_query_cache_size;
+  return new_query_cache_size;
+}
+
+
+ulong Query_cache_manager::set_min_res_unit(ulong size)
+{
+  ulong res= size;
+  for (uint i= 0; i < query_cache_instances; i++)
+    res= m_query_cache[i].set_min_res_unit(size);
+  return res;
+}
+
+
+void Query_cache_manager::store_query(THD *thd, TABLE_LIST *tables_used)
+{
+  get_query_cache(thd->query(), thd->query_length())->store_query(thd,
+                                                                  tables_used);
+}
+
+
+int Query_cache_manager::send_result_to_client(THD *thd, char *sql,
+                                               uint query_length)
+{
+  return get_query_cache(sql, query_length)->send_result_to_client(thd, sql,
+                                                                   query_length);
+}
+
+
+void Query_cache_manager::insert(Query_cache_tls *query_cache_tls,
+                                 const char *packet, ulong length,
+                                 unsigned pkt_nr)
+{
+  /* See the comment on double-check locking usage above. */
+  if (is_disabled() || query_cache_tls->first_query_block == NULL)
+    return;
+
+  query_cache_tls->query_cache->insert(query_cache_tls, packet, length,
+                                       pkt_nr);
+}
+
+
+void Query_cache_manager::end_of_result(THD *thd)
+{
+  /* See the comment on double-check locking usage above. */
+  if (thd->query_cache_tls.first_query_block == NULL)
+    return;
+
+  thd->query_cache_tls.query_cache->end_of_result(thd);
+}
+
+
+void Query_cache_manager::abort(Query_cache_tls *query_cache_tls)
+{
+  /* See the comment on double-check locking usage above. */
+  if (is_disabled() || query_cache_tls->first_query_block == NULL)
+    return;
+
+  query_cache_tls->query_cache->abort(query_cache_tls);
+}
+
+
+/* Remove all queries from all instances of the cache */
+
+void Query_cache_manager::flush()
+{
+  if (is_disabled())
+    return;
+
+  for (uint i= 0; i < query_cache_instances; i++)
+    m_query_cache[i].flush();
+}
+
+
+void Query_cache_manager::pack(ulong join_limit, uint iteration_limit)
+{
+  if (is_disabled())
+    return;
+
+  for (uint i= 0; i < query_cache_instances; i++)
+    m_query_cache[i].pack(join_limit, iteration_limit);
+}
+
+
+ulong Query_cache_manager::free_memory()
+{
+  ulong result= 0;
+  for (uint i= 0; i < query_cache_instances; i++)
+    result+= m_query_cache[i].free_memory;
+  return result;
+}
+
+
+ulong Query_cache_manager::free_memory_blocks()
+{
+  ulong result= 0;
+  for (uint i= 0; i < query_cache_instances; i++)
+    result+= m_query_cache[i].free_memory_blocks;
+  return result;
+}
+
+
+ulong Query_cache_manager::queries_in_cache()
+{
+  ulong result= 0;
+  for (uint i= 0; i < query_cache_instances; i++)
+    result+= m_query_cache[i].queries_in_cache;
+  return result;
+}
+
+
+ulong Query_cache_manager::total_blocks()
+{
+  ulong result= 0;
+  for (uint i= 0; i < query_cache_instances; i++)
+    result+= m_query_cache[i].total_blocks;
+  return result;
+}
+
+
+ulong Query_cache_manager::hits()
+{
+  ulong result= 0;
+  for (uint i= 0; i < query_cache_instances; i++)
+    result+= m_query_cache[i].hits;
+  return result;
+}
+
+
+ulong Query_cache_manager::inserts()
+{
+  ulong result= 0;
+  for (uint i= 0; i < query_cache_instances; i++)
+    result+= m_query_cache[i].inserts;
+  return result;
+}
+
+
+ulong Query_cache_manager::refused()
+{
+  ulong result= 0;
+  for (uint i= 0; i < query_cache_instances; i++)
+    result+= m_query_cache[i].refused;
+  return result;
+}
+
+
+ulong Query_cache_manager::lowmem_prunes()
+{
+  ulong result= 0;
+  for (uint i= 0; i < query_cache_instances; i++)
+    result+= m_query_cache[i].lowmem_prunes;
+  return result;
+}
+
+
+/**
+  Reset the statistic counters of all instances, used by FLUSH STATUS.
+*/
+
+void Query_cache_manager::reset_statistics()
+{
+  for (uint i= 0; i < query_cache_instances; i++)
+  {
+    Query_cache *qc= &m_query_cache[i];
+    qc->hits= qc->inserts= qc->refused= qc->lowmem_prunes= 0;
+  }
+}
+
+
 /*****************************************************************************
    Query_cache methods
 *****************************************************************************/
 
-Query_cache::Query_cache(ulong query_cache_limit_arg,
-			 ulong min_allocation_unit_arg,
+Query_cache::Query_cache(ulong min_allocation_unit_arg,
 			 ulong min_result_data_size_arg,
 			 uint def_query_hash_size_arg,
 			 uint def_table_hash_size_arg)
   :query_cache_size(0),
-   query_cache_limit(query_cache_limit_arg),
-   queries_in_cache(0), hits(0), inserts(0), refused(0),
-   total_blocks(0), lowmem_prunes(0), m_query_cache_is_disabled(FALSE),
+   queries_in_cache(0), total_blocks(0),
+   hits(0), inserts(0), refused(0), lowmem_prunes(0),
    min_allocation_unit(ALIGN_SIZE(min_allocation_unit_arg)),
    min_result_data_size(ALIGN_SIZE(min_result_data_size_arg)),
    def_query_hash_size(ALIGN_SIZE(def_query_hash_size_arg)),
@@ -1300,6 +1537,17 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
     Query_cache_block *competitor = (Query_cache_block *)
       my_hash_search(&queries, (uchar*) thd->query(), tot_length);
     DBUG_PRINT("qcache", ("competitor 0x%lx", (ulong) competitor));
+    /*
+      A stale query which was in use when its tables were invalidated is
+      replaced, unless it is still in use.
+    */
+    if (competitor && is_stale_query(competitor) &&
+        competitor->query()->try_lock_writing())
+    {
+      DBUG_PRINT("qcache", ("free stale competitor"));
+      free_query(competitor);
+      competitor= 0;
+    }
     if (competitor == 0)
     {
       /* Query is not in cache and no one is working with it; Store it */
@@ -1337,6 +1585,7 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
 	inserts++;
 	queries_in_cache++;
 	thd->query_cache_tls.first_query_block= query_block;
+	thd->query_cache_tls.query_cache= this;
 	header->writer(&thd->query_cache_tls);
 	header->tables_type(tables_type);
 
@@ -1460,7 +1709,7 @@ Query_cache::send_result_to_client(THD *thd, char *sql, uint query_length)
 
     See also a note on double-check locking usage above.
   */
-  if (is_disabled() || thd->locked_tables_mode ||
+  if (query_cache.is_disabled() || thd->locked_tables_mode ||
       thd->variables.query_cache_type == 0 || query_cache_size == 0)
     goto err;
 
@@ -1647,7 +1896,20 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
     BLOCK_UNLOCK_RD(query_block);
     goto err_unlock;
   }
-      
+
+  if (is_stale_query(query_block))
+  {
+    /*
+      Some of the tables were invalidated while the query was in use.
+      Free it now if nobody uses it any more.
+    */
+    DBUG_PRINT("qcache", ("query is stale"));
+    BLOCK_UNLOCK_RD(query_block);
+    if (query_block->query()->try_lock_writing())
+      free_query(query_block);
+    goto err_unlock;
+  }
+
   // Check access;
   thd_proc_info(thd, "checking privileges on cached query");
   block_table= query_block->table(0);
@@ -1720,16 +1982,25 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
       BLOCK_UNLOCK_RD(query_block);
       if (engine_data != table->engine_data())
       {
+        char key[MAX_DBKEY_LENGTH];
+        uint32 key_length= table->key_length();
         DBUG_PRINT("qcache",
                    ("Handler require invalidation queries of %s.%s %lu-%lu",
                     table_list.db, table_list.alias,
                     (ulong) engine_data, (ulong) table->engine_data()));
-        invalidate_table_internal(thd,
-                                  (uchar *) table->db(),
-                                  table->key_length());
+        /*
+          The table has to be invalidated in all query cache instances,
+          which can't be done while we own the lock on this one.
+        */
+        memcpy(key, table->db(), key_length);
+        unlock();
+        query_cache.invalidate(thd, key, key_length, FALSE);
       }
       else
+      {
         thd->lex->safe_to_cache_query= 0;       // Don't try to cache this
+        unlock();
+      }
       /*
         End the statement transaction potentially started by engine.
         Currently our engines do not request rollback from callbacks.
@@ -1737,7 +2008,7 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
       */
       DBUG_ASSERT(! thd->transaction_rollback_request);
       trans_rollback_stmt(thd);
-      goto err_unlock;				// Parse query
+      goto err;					// Parse query
     }
     else
       DBUG_PRINT("qcache", ("handler allow caching %s,%s",
@@ -1747,6 +2018,8 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
   hits++;
   unlock();
 
+  DEBUG_SYNC(thd, "wait_in_query_cache_send_result");
+
   /*
     Send cached result to client
   */
@@ -1804,10 +2077,10 @@ err:
   Remove all cached queries that uses any of the tables in the list
 */
 
-void Query_cache::invalidate(THD *thd, TABLE_LIST *tables_used,
-			     my_bool using_transactions)
+void Query_cache_manager::invalidate(THD *thd, TABLE_LIST *tables_used,
+                                     my_bool using_transactions)
 {
-  DBUG_ENTER("Query_cache::invalidate (table list)");
+  DBUG_ENTER("Query_cache_manager::invalidate (table list)");
   if (is_disabled())
     DBUG_VOID_RETURN;
 
@@ -1835,9 +2108,9 @@ void Query_cache::invalidate(THD *thd, TABLE_LIST *tables_used,
   DBUG_VOID_RETURN;
 }
 
-void Query_cache::invalidate(CHANGED_TABLE_LIST *tables_used)
+void Query_cache_manager::invalidate(CHANGED_TABLE_LIST *tables_used)
 {
-  DBUG_ENTER("Query_cache::invalidate (changed table list)");
+  DBUG_ENTER("Query_cache_manager::invalidate (changed table list)");
   if (is_disabled())
     DBUG_VOID_RETURN;
 
@@ -1858,15 +2131,15 @@ void Query_cache::invalidate(CHANGED_TABLE_LIST *tables_used)
   Invalidate locked for write
 
   SYNOPSIS
-    Query_cache::invalidate_locked_for_write()
+    Query_cache_manager::invalidate_locked_for_write()
     tables_used - table list
 
   NOTE
     can be used only for opened tables
 */
-void Query_cache::invalidate_locked_for_write(TABLE_LIST *tables_used)
+void Query_cache_manager::invalidate_locked_for_write(TABLE_LIST *tables_used)
 {
-  DBUG_ENTER("Query_cache::invalidate_locked_for_write");
+  DBUG_ENTER("Query_cache_manager::invalidate_locked_for_write");
   if (is_disabled())
     DBUG_VOID_RETURN;
 
@@ -1887,10 +2160,10 @@ void Query_cache::invalidate_locked_for_write(TABLE_LIST *tables_used)
   Remove all cached queries that uses the given table
 */
 
-void Query_cache::invalidate(THD *thd, TABLE *table, 
-			     my_bool using_transactions)
+void Query_cache_manager::invalidate(THD *thd, TABLE *table,
+                                     my_bool using_transactions)
 {
-  DBUG_ENTER("Query_cache::invalidate (table)");
+  DBUG_ENTER("Query_cache_manager::invalidate (table)");
   if (is_disabled())
     DBUG_VOID_RETURN;
 
@@ -1905,10 +2178,11 @@ void Query_cache::invalidate(THD *thd, TABLE *table,
   DBUG_VOID_RETURN;
 }
 
-void Query_cache::invalidate(THD *thd, const char *key, uint32  key_length,
-			     my_bool using_transactions)
+void Query_cache_manager::invalidate(THD *thd, const char *key,
+                                     uint32 key_length,
+                                     my_bool using_transactions)
 {
-  DBUG_ENTER("Query_cache::invalidate (key)");
+  DBUG_ENTER("Query_cache_manager::invalidate (key)");
   if (is_disabled())
    DBUG_VOID_RETURN;
 
@@ -1926,12 +2200,28 @@ void Query_cache::invalidate(THD *thd, const char *key, uint32  key_length,
    Remove all cached queries that uses the given database.
 */
 
+void Query_cache_manager::invalidate(char *db)
+{
+  DBUG_ENTER("Query_cache_manager::invalidate (db)");
+  if (is_disabled())
+    DBUG_VOID_RETURN;
+
+  for (uint i= 0; i < query_cache_instances; i++)
+    m_query_cache[i].invalidate(db);
+
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+   Remove all cached queries of this instance that uses the given
+   database.
+*/
+
 void Query_cache::invalidate(char *db)
 {
   
   DBUG_ENTER("Query_cache::invalidate (db)");
-  if (is_disabled())
-    DBUG_VOID_RETURN;
 
   bool restart= FALSE;
   /*
@@ -2000,14 +2290,15 @@ void Query_cache::invalidate(char *db)
 }
 
 
-void Query_cache::invalidate_by_MyISAM_filename(const char *filename)
+void Query_cache_manager::invalidate_by_MyISAM_filename(const char *filename)
 {
-  DBUG_ENTER("Query_cache::invalidate_by_MyISAM_filename");
+  DBUG_ENTER("Query_cache_manager::invalidate_by_MyISAM_filename");
 
   /* Calculate the key outside the lock to make the lock shorter */
   char key[MAX_DBKEY_LENGTH];
   uint32 db_length;
-  uint key_length= filename_2_table_key(key, filename, &db_length);
+  uint key_length= Query_cache::filename_2_table_key(key, filename,
+                                                     &db_length);
   THD *thd= current_thd;
   invalidate_table(thd,(uchar *)key, key_length);
   DBUG_VOID_RETURN;
@@ -2018,8 +2309,6 @@ void Query_cache::invalidate_by_MyISAM_filename(const char *filename)
 void Query_cache::flush()
 {
   DBUG_ENTER("Query_cache::flush");
-  if (is_disabled())
-    DBUG_VOID_RETURN;
 
   QC_DEBUG_SYNC("wait_in_query_cache_flush1");
 
@@ -2031,7 +2320,7 @@ void Query_cache::flush()
     DUMP(this);
   }
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
   unlock();
   DBUG_VOID_RETURN;
 }
@@ -2051,9 +2340,6 @@ void Query_cache::pack(ulong join_limit, uint iteration_limit)
 {
   DBUG_ENTER("Query_cache::pack");
 
-  if (is_disabled())
-    DBUG_VOID_RETURN;
-
   /*
     If the entire qc is being invalidated we can bail out early
     instead of waiting for the lock.
@@ -2113,15 +2399,6 @@ void Query_cache::init()
                   &COND_cache_status_changed, NULL);
   m_cache_lock_status= Query_cache::UNLOCKED;
   initialized = 1;
-  /*
-    If we explicitly turn off query cache from the command line query cache will
-    be disabled for the reminder of the server life time. This is because we
-    want to avoid locking the QC specific mutex if query cache isn't going to
-    be used.
-  */
-  if (global_system_variables.query_cache_type == 0)
-    query_cache.disable_query_cache();
-
   DBUG_VOID_RETURN;
 }
 
@@ -2557,11 +2834,11 @@ Query_cache::append_result_data(Query_cache_block **current_block,
   DBUG_PRINT("qcache", ("append %lu bytes to 0x%lx query",
 		      data_len, (long) query_block));
 
-  if (query_block->query()->add(data_len) > query_cache_limit)
+  if (query_block->query()->add(data_len) > query_cache.query_cache_limit)
   {
     DBUG_PRINT("qcache", ("size limit reached %lu > %lu",
 			query_block->query()->length(),
-			query_cache_limit));
+			query_cache.query_cache_limit));
     DBUG_RETURN(0);
   }
   if (*current_block == 0)
@@ -2705,7 +2982,7 @@ inline ulong Query_cache::get_min_first_result_data_size()
   if (queries_in_cache < QUERY_CACHE_MIN_ESTIMATED_QUERIES_NUMBER)
     return min_result_data_size;
   ulong avg_result = (query_cache_size - free_memory) / queries_in_cache;
-  avg_result = min(avg_result, query_cache_limit);
+  avg_result = min(avg_result, query_cache.query_cache_limit);
   return max(min_result_data_size, avg_result);
 }
 
@@ -2782,7 +3059,7 @@ my_bool Query_cache::allocate_data_chain(Query_cache_block **result_block,
   Invalidate the first table in the table_list
 */
 
-void Query_cache::invalidate_table(THD *thd, TABLE_LIST *table_list)
+void Query_cache_manager::invalidate_table(THD *thd, TABLE_LIST *table_list)
 {
   if (table_list->table != 0)
     invalidate_table(thd, table_list->table);	// Table is open
@@ -2799,12 +3076,19 @@ void Query_cache::invalidate_table(THD *thd, TABLE_LIST *table_list)
   }
 }
 
-void Query_cache::invalidate_table(THD *thd, TABLE *table)
+void Query_cache_manager::invalidate_table(THD *thd, TABLE *table)
 {
   invalidate_table(thd, (uchar*) table->s->table_cache_key.str,
                    table->s->table_cache_key.length);
 }
 
+void Query_cache_manager::invalidate_table(THD *thd, uchar *key,
+                                           uint32 key_length)
+{
+  for (uint i= 0; i < query_cache_instances; i++)
+    m_query_cache[i].invalidate_table(thd, key, key_length);
+}
+
 void Query_cache::invalidate_table(THD *thd, uchar * key, uint32  key_length)
 {
   DEBUG_SYNC(thd, "wait_in_query_cache_invalidate1");
@@ -2847,25 +3131,80 @@ Query_cache::invalidate_table_internal(THD *thd, uchar *key, uint32 key_length)
 /**
   Invalidate a linked list of query cache blocks.
 
-  Each block tries to acquire a block level lock before
-  free_query is a called. This function will in turn affect
-  related table- and result-blocks.
+  The version of the table is increased first, so that none of the
+  queries in the list can be sent to a client any more. Then the queries
+  are freed, which will in turn affect related table- and result-blocks.
+
+  Queries which are being sent to a client or stored by another thread
+  can't be locked without waiting; they are left in the list and freed
+  later, when found by send_result_to_client() or store_query(), or when
+  memory is needed. This way invalidation never waits for clients.
 
   @param[in,out] thd Thread context.
   @param[in,out] list_root A pointer to a circular list of query blocks.
 
+  @retval TRUE  All queries and the table block were freed.
+  @retval FALSE Some queries are in use, the table block is still there.
 */
 
-void
+bool
 Query_cache::invalidate_query_block_list(THD *thd,
                                          Query_cache_block_table *list_root)
 {
-  while (list_root->next != list_root)
+  Query_cache_table *table= list_root->block()->table();
+  /* Last node of a query which is in use, or list_root. */
+  Query_cache_block_table *in_use= list_root;
+
+  table->m_version++;
+
+  while (in_use->next != list_root)
   {
-    Query_cache_block *query_block= list_root->next->block();
-    BLOCK_LOCK_WR(query_block);
+    Query_cache_block *query_block= in_use->next->block();
+    if (!query_block->query()->try_lock_writing())
+    {
+      in_use= in_use->next;
+      continue;
+    }
+
+    /*
+      The table block is freed together with the last query using it,
+      which may be linked several times if it uses the table twice.
+    */
+    int32 links= 0;
+    for (TABLE_COUNTER_TYPE i= 0; i < query_block->n_tables; i++)
+    {
+      if (query_block->table(i)->parent == table)
+        links++;
+    }
+    bool last= (in_use == list_root && links == table->m_cached_query_count);
+
     free_query(query_block);
+    if (last)
+      return TRUE;
+  }
+  return FALSE;
+}
+
+
+/**
+  Check if some of the tables used by a query were invalidated after
+  the query was registered.
+
+  @see invalidate_query_block_list()
+*/
+
+bool Query_cache::is_stale_query(Query_cache_block *query_block)
+{
+  Query_cache_block_table *block_table= query_block->table(0);
+  Query_cache_block_table *block_table_end= block_table +
+                                            query_block->n_tables;
+
+  for (; block_table != block_table_end; block_table++)
+  {
+    if (block_table->version != block_table->parent->m_version)
+      return TRUE;
   }
+  return FALSE;
 }
 
 /*
@@ -3045,15 +3384,14 @@ Query_cache::insert_table(uint key_len, char *key,
                 (ulong) engine_data,
                 (ulong) table_block->table()->engine_data()));
     /*
-      as far as we delete all queries with this table, table block will be
-      deleted, too
+      As far as we delete all queries with this table, table block will be
+      deleted, too. Queries which are still in use have become stale and
+      keep the table block.
     */
-    {
-      Query_cache_block_table *list_root= table_block->table(0);
-      invalidate_query_block_list(thd, list_root);
-    }
-
-    table_block= 0;
+    if (invalidate_query_block_list(thd, table_block->table(0)))
+      table_block= 0;
+    else
+      table_block->table()->engine_data(engine_data);
   }
 
   if (table_block == 0)
@@ -3102,6 +3440,7 @@ Query_cache::insert_table(uint key_len, char *key,
       any queries.
     */
     header->m_cached_query_count= 0;
+    header->m_version= 0;
   }
 
   /*
@@ -3115,6 +3454,7 @@ Query_cache::insert_table(uint key_len, char *key,
   node->next->prev= node;
   node->prev= list_root;
   node->parent= table_block->table();
+  node->version= node->parent->m_version;
   /*
     Increase the counter to keep track on how long this chain
     of queries is.
@@ -3166,10 +3506,10 @@ Query_cache::allocate_block(ulong len, my_bool not_less, ulong min)
   DBUG_PRINT("qcache", ("len %lu, not less %d, min %lu",
              len, not_less,min));
 
-  if (len >= min(query_cache_size, query_cache_limit))
+  if (len >= min(query_cache_size, query_cache.query_cache_limit))
   {
     DBUG_PRINT("qcache", ("Query cache hase only %lu memory and limit %lu",
-			query_cache_size, query_cache_limit));
+			query_cache_size, query_cache.query_cache_limit));
     DBUG_RETURN(0); // in any case we don't have such piece of memory
   }
 
@@ -3604,16 +3944,16 @@ Query_cache::process_and_count_tables(THD *thd, TABLE_LIST *tables_used,
     }
     else
     {
-      DBUG_PRINT("qcache", ("table: %s  db:  %s  type: %u",
-                            tables_used->table->s->table_name.str,
-                            tables_used->table->s->db.str,
-                            tables_used->table->s->db_type()->db_type));
       if (tables_used->derived)
       {
         table_count--;
         DBUG_PRINT("qcache", ("derived table skipped"));
         continue;
       }
+      DBUG_PRINT("qcache", ("table: %s  db:  %s  type: %u",
+                            tables_used->table->s->table_name.str,
+                            tables_used->table->s->db.str,
+                            tables_used->table->s->db_type()->db_type));
       *tables_type|= tables_used->table->file->table_cache_type();
 
       /*
@@ -3751,7 +4091,7 @@ void Query_cache::pack_cache()
 {
   DBUG_ENTER("Query_cache::pack_cache");
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
 
   uchar *border = 0;
   Query_cache_block *before = 0;
@@ -3783,7 +4123,7 @@ void Query_cache::pack_cache()
     DUMP(this);
   }
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
   DBUG_VOID_RETURN;
 }
 
@@ -3972,13 +4312,13 @@ my_bool Query_cache::move_by_type(uchar **border,
   case Query_cache_block::RES_CONT:
   case Query_cache_block::RESULT:
   {
-    DBUG_PRINT("qcache", ("block 0x%lx RES* (%d)", (ulong) block,
-               (int) block->type));
-    if (*border == 0)
-      break;
-    Query_cache_block *query_block= block->result()->parent();
-    BLOCK_LOCK_WR(query_block);
-    Query_cache_block *next= block->next, *prev= block->prev;
+    DBUG_PRINT("qcache", ("block 0x%lx RES* (%d)", (ulong) block,
+               (int) block->type));
+    if (*border == 0)
+      break;
+    Query_cache_block *query_block= block->result()->parent();
+    BLOCK_LOCK_WR(query_block);
+    Query_cache_block *next= block->next, *prev= block->prev;
     Query_cache_block::block_type type= block->type;
     ulong len = block->length, used = block->used;
     Query_cache_block *pprev = block->pprev,
@@ -4165,6 +4505,26 @@ my_bool in_blocks(Query_cache_block * point) { return 0; }
 #else
 
 
+/*
+  Debug methods of Query_cache_manager, see below.
+*/
+
+void Query_cache_manager::wreck(uint line, const char *message)
+{
+  for (uint i= 0; i < query_cache_instances; i++)
+    m_query_cache[i].wreck(line, message);
+}
+
+
+my_bool Query_cache_manager::check_integrity(bool locked)
+{
+  my_bool result= 0;
+  for (uint i= 0; i < query_cache_instances; i++)
+    result|= m_query_cache[i].check_integrity(locked);
+  return result;
+}
+
+
 /*
   Debug method which switch query cache off but left content for
   investigation.
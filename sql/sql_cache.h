@@ -111,6 +111,12 @@ struct Query_cache_block_table
   */
   Query_cache_table *parent;
 
+  /**
+    Version of the table when the query was registered.
+    The query is stale if it differs from Query_cache_table::m_version.
+  */
+  ulong version;
+
   /**
     A method to calculate the address of the query cache block
     owning this node. The purpose of this calculation is to 
@@ -201,6 +207,12 @@ struct Query_cache_table
   */
   int32 m_cached_query_count;
 
+  /**
+    Increased each time the table is invalidated. Queries which were
+    registered with an older version are never sent to clients.
+  */
+  ulong m_version;
+
   inline char *db()			     { return (char *) data(); }
   inline char *table()			     { return tbl; }
   inline void table(char *table_arg)	     { tbl= table_arg; }
@@ -278,14 +290,20 @@ struct Query_cache_memory_bin_step
   }
 };
 
+/**
+  Instance of the query cache, with its own memory, hashes and lock.
+
+  @see Query_cache_manager
+*/
+
 class Query_cache
 {
 public:
   /* Info */
-  ulong query_cache_size, query_cache_limit;
+  ulong query_cache_size;
   /* statistics */
-  ulong free_memory, queries_in_cache, hits, inserts, refused,
-    free_memory_blocks, total_blocks, lowmem_prunes;
+  ulong free_memory, queries_in_cache, free_memory_blocks, total_blocks;
+  ulong hits, inserts, refused, lowmem_prunes;
 
 
 private:
@@ -296,11 +314,8 @@ private:
   enum Cache_lock_status { UNLOCKED, LOCKED_NO_WAIT, LOCKED };
   Cache_lock_status m_cache_lock_status;
 
-  bool m_query_cache_is_disabled;
-
   void free_query_internal(Query_cache_block *point);
   void invalidate_table_internal(THD *thd, uchar *key, uint32 key_length);
-  void disable_query_cache(void) { m_query_cache_is_disabled= TRUE; }
 
 protected:
   /*
@@ -343,10 +358,6 @@ protected:
   static void double_linked_list_join(Query_cache_block *head_tail,
 				      Query_cache_block *tail_head);
 
-  /* Table key generation */
-  static uint filename_2_table_key (char *key, const char *filename,
-				    uint32 *db_langth);
-
   /* The following functions require that structure_guard_mutex is locked */
   void flush_cache();
   my_bool free_old_query();
@@ -355,12 +366,9 @@ protected:
 			      ulong data_len,
 			      Query_cache_block *query_block,
 			      my_bool first_block);
-  void invalidate_table(THD *thd, TABLE_LIST *table);
-  void invalidate_table(THD *thd, TABLE *table);
-  void invalidate_table(THD *thd, uchar *key, uint32  key_length);
-  void invalidate_table(THD *thd, Query_cache_block *table_block);
-  void invalidate_query_block_list(THD *thd, 
+  bool invalidate_query_block_list(THD *thd,
                                    Query_cache_block_table *list_root);
+  static bool is_stale_query(Query_cache_block *query_block);
 
   TABLE_COUNTER_TYPE
     register_tables_from_list(TABLE_LIST *tables_used,
@@ -438,20 +446,19 @@ protected:
   static my_bool ask_handler_allowance(THD *thd, TABLE_LIST *tables_used);
  public:
 
-  Query_cache(ulong query_cache_limit = ULONG_MAX,
-	      ulong min_allocation_unit = QUERY_CACHE_MIN_ALLOCATION_UNIT,
+  Query_cache(ulong min_allocation_unit = QUERY_CACHE_MIN_ALLOCATION_UNIT,
 	      ulong min_result_data_size = QUERY_CACHE_MIN_RESULT_DATA_SIZE,
 	      uint def_query_hash_size = QUERY_CACHE_DEF_QUERY_HASH_SIZE,
 	      uint def_table_hash_size = QUERY_CACHE_DEF_TABLE_HASH_SIZE);
 
-  bool is_disabled(void) { return m_query_cache_is_disabled; }
+  /* Table key generation */
+  static uint filename_2_table_key (char *key, const char *filename,
+				    uint32 *db_langth);
 
   /* initialize cache (mutex) */
   void init();
   /* resize query cache (return real query size, 0 if disabled) */
   ulong resize(ulong query_cache_size);
-  /* set limit on result size */
-  inline void result_size_limit(ulong limit){query_cache_limit=limit;}
   /* set minimal result data allocation unit size */
   ulong set_min_res_unit(ulong size);
 
@@ -464,21 +471,12 @@ protected:
   */
   int send_result_to_client(THD *thd, char *query, uint query_length);
 
-  /* Remove all queries that uses any of the listed following tables */
-  void invalidate(THD* thd, TABLE_LIST *tables_used,
-		  my_bool using_transactions);
-  void invalidate(CHANGED_TABLE_LIST *tables_used);
-  void invalidate_locked_for_write(TABLE_LIST *tables_used);
-  void invalidate(THD* thd, TABLE *table, my_bool using_transactions);
-  void invalidate(THD *thd, const char *key, uint32  key_length,
-		  my_bool using_transactions);
+  /* Remove all queries that uses the following table */
+  void invalidate_table(THD *thd, uchar *key, uint32  key_length);
 
   /* Remove all queries that uses any of the tables in following database */
   void invalidate(char *db);
 
-  /* Remove all queries that uses any of the listed following table */
-  void invalidate_by_MyISAM_filename(const char *filename);
-
   void flush();
   void pack(ulong join_limit = QUERY_CACHE_PACK_LIMIT,
 	    uint iteration_limit = QUERY_CACHE_PACK_ITERATION);
@@ -517,6 +515,107 @@ protected:
   void unlock(void);
 };
 
+
+/**
+  Container for all query cache instances in the system.
+
+  A query is cached in the instance chosen by a hash of its text, so
+  lookups and inserts of different queries mostly take different locks.
+  Each instance registers the tables of its own queries, invalidation
+  of a table visits all of them.
+*/
+
+class Query_cache_manager
+{
+public:
+  /** Maximum supported number of query cache instances. */
+  static const int MAX_QUERY_CACHES= 64;
+
+  /* Info */
+  ulong query_cache_size, query_cache_limit;
+
+  Query_cache_manager()
+    :query_cache_size(0), query_cache_limit(ULONG_MAX),
+     m_query_cache_is_disabled(FALSE)
+  {}
+
+  bool is_disabled(void) { return m_query_cache_is_disabled; }
+
+  void init();
+  void destroy();
+  /* resize query cache (return real query size, 0 if disabled) */
+  ulong resize(ulong query_cache_size);
+  /* set limit on result size */
+  inline void result_size_limit(ulong limit){query_cache_limit=limit;}
+  /* set minimal result data allocation unit size */
+  ulong set_min_res_unit(ulong size);
+
+  /* register query in cache */
+  void store_query(THD *thd, TABLE_LIST *used_tables);
+
+  /*
+    Check if the query is in the cache and if this is true send the
+    data to client.
+  */
+  int send_result_to_client(THD *thd, char *query, uint query_length);
+
+  void insert(Query_cache_tls *query_cache_tls,
+              const char *packet,
+              ulong length,
+              unsigned pkt_nr);
+  void end_of_result(THD *thd);
+  void abort(Query_cache_tls *query_cache_tls);
+
+  /* Remove all queries that uses any of the listed following tables */
+  void invalidate(THD* thd, TABLE_LIST *tables_used,
+		  my_bool using_transactions);
+  void invalidate(CHANGED_TABLE_LIST *tables_used);
+  void invalidate_locked_for_write(TABLE_LIST *tables_used);
+  void invalidate(THD* thd, TABLE *table, my_bool using_transactions);
+  void invalidate(THD *thd, const char *key, uint32  key_length,
+		  my_bool using_transactions);
+
+  /* Remove all queries that uses any of the tables in following database */
+  void invalidate(char *db);
+
+  /* Remove all queries that uses any of the listed following table */
+  void invalidate_by_MyISAM_filename(const char *filename);
+
+  void flush();
+  void pack(ulong join_limit = QUERY_CACHE_PACK_LIMIT,
+	    uint iteration_limit = QUERY_CACHE_PACK_ITERATION);
+
+  /* Totals for all instances, read without locks */
+  ulong free_memory();
+  ulong free_memory_blocks();
+  ulong queries_in_cache();
+  ulong total_blocks();
+  ulong hits();
+  ulong inserts();
+  ulong refused();
+  ulong lowmem_prunes();
+  void reset_statistics();
+
+  /* Only used when debugging, see Query_cache */
+  void wreck(uint line, const char *message);
+  my_bool check_integrity(bool not_locked);
+
+private:
+  void disable_query_cache(void) { m_query_cache_is_disabled= TRUE; }
+  void invalidate_table(THD *thd, TABLE_LIST *table);
+  void invalidate_table(THD *thd, TABLE *table);
+  void invalidate_table(THD *thd, uchar *key, uint32  key_length);
+  Query_cache *get_query_cache(const char *query, size_t query_length);
+
+  bool m_query_cache_is_disabled;
+
+  /**
+    Array of query cache instances.
+    Only the first query_cache_instances elements in it are used.
+  */
+  Query_cache m_query_cache[MAX_QUERY_CACHES];
+};
+
 #ifdef HAVE_QUERY_CACHE
 struct Query_cache_query_flags
 {
@@ -580,5 +679,5 @@ struct Query_cache_query_flags
 #define query_cache_is_cacheable_query(L) 0
 #endif /*HAVE_QUERY_CACHE*/
 
-extern Query_cache query_cache;
+extern Query_cache_manager query_cache;
 #endif
@@ -59,6 +59,7 @@
 #include "transaction.h"
 #include "debug_sync.h"
 #include "sql_parse.h"                          // is_update_query
+#include "sql_select.h"                         // create_tmp_table
 #include "sql_callback.h"
 
 /*
@@ -443,6 +444,23 @@ int thd_connection_has_data(THD *thd)
   return vio->has_data(vio);
 }
 
+/**
+  Forget the socket registered by the login for THD::awake() to close.
+
+  A thread pool does not block reading from an idle connection, it
+  wakes it up through post_kill_notification instead. Closing the
+  socket from the killing thread would silently remove it from the
+  pool's poll descriptor.
+
+  @param thd                       THD object
+*/
+void thd_clear_active_vio(THD *thd)
+{
+#ifdef SIGNAL_WITH_VIO_CLOSE
+  thd->clear_active_vio();
+#endif
+}
+
 /**
   Set reading/writing on socket, used by SHOW PROCESSLIST
 
@@ -2935,6 +2953,100 @@ bool select_exists_subselect::send_data(List<Item> &items)
 }
 
 
+/**
+  Create the temporary table that a materialized IN subquery is stored in.
+
+  The table gets one NOT NULL column per subquery column and a unique
+  index over all columns. Rows with a NULL in any column can never match
+  and are not stored, only recorded in has_null_row.
+
+  @param thd_arg       thread handle
+  @param column_types  select list of the subquery
+
+  @retval FALSE  OK
+  @retval TRUE   Error
+*/
+
+bool select_materialize_subselect::create_result_table(THD *thd_arg,
+                                                       List<Item> *column_types)
+{
+  List_iterator_fast<Item> it(*column_types);
+  List<Item> types;
+  Item *sel_item;
+  DBUG_ENTER("select_materialize_subselect::create_result_table");
+  DBUG_ASSERT(table == 0);
+
+  while ((sel_item= it++))
+  {
+    Item_type_holder *holder= new Item_type_holder(thd_arg, sel_item);
+    if (!holder || types.push_back(holder))
+      DBUG_RETURN(TRUE);
+    holder->maybe_null= 0;
+  }
+  tmp_table_param.init();
+  tmp_table_param.field_count= types.elements;
+
+  if (!(table= create_tmp_table(thd_arg, &tmp_table_param, types,
+                                (ORDER*) 0, TRUE, 1,
+                                thd_arg->variables.option_bits |
+                                TMP_TABLE_ALL_COLUMNS,
+                                HA_POS_ERROR, "materialized_subquery")))
+    DBUG_RETURN(TRUE);
+  table->file->extra(HA_EXTRA_IGNORE_DUP_KEY);
+  has_rows= has_null_row= FALSE;
+  DBUG_RETURN(FALSE);
+}
+
+
+bool select_materialize_subselect::send_data(List<Item> &items)
+{
+  List_iterator_fast<Item> it(items);
+  Item *val_item;
+  int error;
+  DBUG_ENTER("select_materialize_subselect::send_data");
+  if (unit->offset_limit_cnt)
+  {				          // Using limit offset,count
+    unit->offset_limit_cnt--;
+    DBUG_RETURN(0);
+  }
+  has_rows= TRUE;
+  while ((val_item= it++))
+  {
+    if (val_item->is_null())
+    {
+      has_null_row= TRUE;
+      DBUG_RETURN(0);
+    }
+  }
+  fill_record(thd, table->field, items, 1);
+  if (thd->is_error())
+    DBUG_RETURN(1);
+
+  if ((error= table->file->ha_write_row(table->record[0])))
+  {
+    /* create_myisam_from_heap will generate error if needed */
+    if (table->file->is_fatal_error(error, HA_CHECK_DUP) &&
+        create_myisam_from_heap(thd, table, &tmp_table_param, error, 1))
+      DBUG_RETURN(1);
+  }
+  DBUG_RETURN(0);
+}
+
+
+void select_materialize_subselect::cleanup()
+{
+  DBUG_ENTER("select_materialize_subselect::cleanup");
+  if (table)
+  {
+    table->file->ha_index_or_rnd_end();
+    free_tmp_table(thd, table);
+    table= 0;
+  }
+  has_rows= has_null_row= FALSE;
+  DBUG_VOID_RETURN;
+}
+
+
 /***************************************************************************
   Dump of select to variables
 ***************************************************************************/
@@ -335,6 +335,7 @@ class MY_LOCALE;
 */
 
 struct Query_cache_block;
+class Query_cache;
 
 struct Query_cache_tls
 {
@@ -343,12 +344,14 @@ struct Query_cache_tls
     functions and methods to maintain proper locking.
   */
   Query_cache_block *first_query_block;
+  /* Query cache instance to which 'first_query_block' belongs. */
+  Query_cache *query_cache;
   void set_first_query_block(Query_cache_block *first_query_block_arg)
   {
     first_query_block= first_query_block_arg;
   }
 
-  Query_cache_tls() :first_query_block(NULL) {}
+  Query_cache_tls() :first_query_block(NULL), query_cache(NULL) {}
 };
 
 /* SIGNAL / RESIGNAL / GET DIAGNOSTICS */
@@ -443,6 +446,7 @@ typedef struct system_variables
   ulong net_write_timeout;
   ulong optimizer_prune_level;
   ulong optimizer_search_depth;
+  ulong partition_scan_threads;
   ulong preload_buff_size;
   ulong profiling_history_size;
   ulong read_buff_size;
@@ -538,6 +542,7 @@ typedef struct system_status_var
   ulong ha_write_count;
   ulong ha_prepare_count;
   ulong ha_discover_count;
+  ulong ha_external_lock_count;
   ulong ha_savepoint_count;
   ulong ha_savepoint_rollback_count;
 
@@ -3271,8 +3276,8 @@ public:
 
 class select_union :public select_result_interceptor
 {
-  TMP_TABLE_PARAM tmp_table_param;
 public:
+  TMP_TABLE_PARAM tmp_table_param;
   TABLE *table;
 
   select_union() :table(0) {}
@@ -3334,6 +3339,23 @@ public:
   bool send_data(List<Item> &items);
 };
 
+/* Materialized IN subselect: stores the subquery rows in a temporary table */
+class select_materialize_subselect :public select_subselect
+{
+  TMP_TABLE_PARAM tmp_table_param;
+public:
+  TABLE *table;
+  bool has_rows;                  /* subquery produced at least one row */
+  bool has_null_row;              /* ... and one of them had a NULL column */
+
+  select_materialize_subselect(Item_subselect *item_arg)
+    :select_subselect(item_arg), table(0), has_rows(0), has_null_row(0)
+  {}
+  bool create_result_table(THD *thd, List<Item> *column_types);
+  bool send_data(List<Item> &items);
+  void cleanup();
+};
+
 /* Structs used when sorting */
 
 typedef struct st_sort_field {
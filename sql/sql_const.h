@@ -64,6 +64,7 @@
                            RAND_TABLE_BIT)
 #define MAX_FIELDS	4096			/* Limit in the .frm file */
 #define MAX_PARTITIONS  1024
+#define MAX_PARTITION_SCAN_THREADS 64  /* Max threads of a partition scan */
 
 #define MAX_SELECT_NESTING (sizeof(nesting_map)*8-1)
 
@@ -37,6 +37,7 @@
 #include "transaction.h"
 #include "records.h"                            // init_read_record,
                                                 // end_read_record
+#include "sql_partition.h"                     // prune_lock_partitions
 
 /**
   Implement DELETE SQL word.
@@ -63,12 +64,19 @@ bool mysql_delete(THD *thd, TABLE_LIST *table_list, COND *conds,
   ORDER *order= (ORDER *) ((order_list && order_list->elements) ?
                            order_list->first : NULL);
   uint usable_index= MAX_KEY;
+  uint table_count= 0;
+  bool prune_before_lock= FALSE;
   SELECT_LEX   *select_lex= &thd->lex->select_lex;
   THD::killed_state killed_status= THD::NOT_KILLED;
   THD::enum_binlog_query_type query_type= THD::ROW_QUERY_TYPE;
   DBUG_ENTER("mysql_delete");
 
-  if (open_and_lock_tables(thd, table_list, TRUE, 0))
+  /*
+    A partitioned table is locked after prune_partitions() below, so that
+    only the partitions the statement can touch are locked.
+  */
+  if (open_tables_for_pruning(thd, table_list, TRUE, &table_count,
+                              &prune_before_lock))
     DBUG_RETURN(TRUE);
   if (!(table= table_list->table))
   {
@@ -114,6 +122,25 @@ bool mysql_delete(THD *thd, TABLE_LIST *table_list, COND *conds,
 
   select_lex->no_error= thd->lex->ignore;
 
+#ifdef WITH_PARTITION_STORAGE_ENGINE
+  if (prune_before_lock)
+  {
+    if (prune_partitions(thd, table, conds))
+    {
+      free_underlaid_joins(thd, select_lex);
+      // No matching record
+      my_ok(thd, 0);
+      DBUG_RETURN(0);
+    }
+    prune_lock_partitions(table, NULL);
+    if (lock_tables(thd, table_list, table_count, 0))
+    {
+      free_underlaid_joins(thd, select_lex);
+      DBUG_RETURN(TRUE);
+    }
+  }
+#endif
+
   const_cond_result= const_cond && (!conds || conds->val_int());
   if (thd->is_error())
   {
@@ -173,7 +200,8 @@ bool mysql_delete(THD *thd, TABLE_LIST *table_list, COND *conds,
   }
 
 #ifdef WITH_PARTITION_STORAGE_ENGINE
-  if (prune_partitions(thd, table, conds))
+  /* A table locked after pruning above keeps its used partitions */
+  if (!prune_before_lock && prune_partitions(thd, table, conds))
   {
     free_underlaid_joins(thd, select_lex);
     // No matching record
@@ -242,7 +270,7 @@ bool mysql_delete(THD *thd, TABLE_LIST *table_list, COND *conds,
     
       if (!(sortorder= make_unireg_sortorder(order, &length, NULL)) ||
 	  (table->sort.found_records = filesort(thd, table, sortorder, length,
-                                                select, HA_POS_ERROR, 1,
+                                                select, limit, 1,
                                                 &examined_rows))
 	  == HA_POS_ERROR)
       {
@@ -77,6 +77,290 @@ out:
 }
 
 
+/*
+  Check if a join list contains a NATURAL or USING join at any level
+*/
+
+static bool has_natural_join(List<TABLE_LIST> *join_list)
+{
+  List_iterator_fast<TABLE_LIST> it(*join_list);
+  TABLE_LIST *tbl;
+  while ((tbl= it++))
+  {
+    if (tbl->natural_join || tbl->is_natural_join ||
+        (tbl->nested_join && has_natural_join(&tbl->nested_join->join_list)))
+      return TRUE;
+  }
+  return FALSE;
+}
+
+
+/*
+  Check if a table reference or a nest embedding it is an operand of a
+  NATURAL or USING join
+*/
+
+static bool is_natural_join_operand(TABLE_LIST *table)
+{
+  for (TABLE_LIST *tbl= table; tbl; tbl= tbl->embedding)
+  {
+    if (tbl->natural_join)
+      return TRUE;
+    if (tbl->join_list)
+    {
+      List_iterator_fast<TABLE_LIST> it(*tbl->join_list);
+      TABLE_LIST *sibling;
+      while ((sibling= it++))
+      {
+        if (sibling->natural_join == tbl)
+          return TRUE;
+      }
+    }
+  }
+  return FALSE;
+}
+
+
+/*
+  Check if a derived table can be merged into the outer SELECT
+
+  SYNOPSIS
+    derived_can_be_merged()
+    thd                 Thread handle
+    lex                 LEX for this thread
+    derived             TABLE_LIST of the derived table
+
+  DESCRIPTION
+    A derived table is merged like a VIEW with the MERGE algorithm (see
+    LEX::can_be_merged()) if it is a single SELECT of a SELECT statement
+    without grouping, aggregation, DISTINCT, ORDER BY, LIMIT, subqueries
+    outside of WHERE and ON, derived tables of its own, and NATURAL or
+    USING joins. On the inner side of an outer join all its columns must
+    be plain columns: a constant would not be NULL-complemented.
+
+  RETURN
+    TRUE   the derived table can be merged
+    FALSE  it has to be materialized
+*/
+
+static bool derived_can_be_merged(THD *thd, LEX *lex, TABLE_LIST *derived)
+{
+  SELECT_LEX_UNIT *unit= derived->derived;
+  SELECT_LEX *sl= unit->first_select();
+
+  if (!optimizer_flag(thd, OPTIMIZER_SWITCH_DERIVED_MERGE) ||
+      lex->sql_command != SQLCOM_SELECT ||
+      !derived->is_anonymous_derived_table() ||
+      derived->belong_to_view ||
+      unit->is_union() ||
+      sl->group_list.elements || sl->having || sl->with_sum_func ||
+      (sl->options & (SELECT_DISTINCT | SELECT_STRAIGHT_JOIN)) ||
+      sl->select_limit || sl->offset_limit || sl->order_list.elements ||
+      sl->table_list.elements < 1 ||
+      (sl->uncacheable & ~UNCACHEABLE_EXPLAIN) ||
+      has_natural_join(&sl->top_join_list) ||
+      is_natural_join_operand(derived))
+    return FALSE;
+
+  for (SELECT_LEX_UNIT *tmp_unit= sl->first_inner_unit();
+       tmp_unit;
+       tmp_unit= tmp_unit->next_unit())
+  {
+    if (tmp_unit->item == 0 ||
+        (tmp_unit->item->place() != IN_WHERE &&
+         tmp_unit->item->place() != IN_ON))
+      return FALSE;
+  }
+
+  for (TABLE_LIST *tbl= derived; tbl; tbl= tbl->embedding)
+  {
+    if (tbl->outer_join)
+    {
+      List_iterator_fast<Item> it(sl->item_list);
+      Item *item;
+      while ((item= it++))
+      {
+        if (item->type() != Item::FIELD_ITEM)
+          return FALSE;
+      }
+      break;
+    }
+  }
+  return TRUE;
+}
+
+
+/*
+  Attach the tables and name resolution contexts of a merged SELECT to
+  the outer SELECT, including those of the VIEWs merged into it
+*/
+
+static void set_merged_select(SELECT_LEX *sl, SELECT_LEX *outer)
+{
+  sl->context.select_lex= outer;
+  for (TABLE_LIST *tbl= sl->get_table_list(); tbl; tbl= tbl->next_local)
+  {
+    tbl->select_lex= outer;
+    if (tbl->merge_underlying_list)
+      set_merged_select(tbl->get_single_select(), outer);
+  }
+}
+
+
+/*
+  Merge a derived table into the outer SELECT
+
+  SYNOPSIS
+    merge_derived()
+    thd                 Thread handle
+    derived             TABLE_LIST of the derived table
+
+  DESCRIPTION
+    The tables of the derived table become a nested join in its place and
+    the TABLE_LIST is turned into a VIEW-like reference with the MERGE
+    algorithm: its columns are resolved through the field translation
+    table built by TABLE_LIST::setup_underlying() and its WHERE clause is
+    added to the outer one by TABLE_LIST::prep_where(). The changes are
+    made on the statement arena, they are kept for re-execution.
+
+  RETURN
+    FALSE  OK
+    TRUE   Error
+*/
+
+static bool merge_derived(THD *thd, TABLE_LIST *derived)
+{
+  SELECT_LEX_UNIT *unit= derived->derived;
+  SELECT_LEX *sl= unit->first_select();
+  SELECT_LEX *outer= derived->select_lex;
+  NESTED_JOIN *nested_join;
+  TABLE_LIST *tbl;
+  Query_arena *arena, backup;
+  DBUG_ENTER("merge_derived");
+
+  arena= thd->activate_stmt_arena_if_needed(&backup);
+  if (!(nested_join= (NESTED_JOIN *) thd->calloc(sizeof(NESTED_JOIN))))
+  {
+    if (arena)
+      thd->restore_active_arena(arena, &backup);
+    DBUG_RETURN(TRUE);
+  }
+
+  /* Nest the tables of the derived table in its place */
+  derived->nested_join= nested_join;
+  nested_join->join_list= sl->top_join_list;
+  List_iterator_fast<TABLE_LIST> ti(nested_join->join_list);
+  while ((tbl= ti++))
+  {
+    tbl->join_list= &nested_join->join_list;
+    tbl->embedding= derived;
+  }
+
+  derived->effective_algorithm= VIEW_ALGORITHM_MERGE;
+  derived->merge_underlying_list= sl->get_table_list();
+  derived->multitable_view= test(derived->merge_underlying_list->next_local);
+  /* Store WHERE clause for post-processing in setup_underlying */
+  derived->where= sl->where;
+  derived->table_name= derived->alias;
+  derived->table_name_length= strlen(derived->alias);
+  derived->db= (char *) "";
+  derived->db_length= 0;
+#ifndef NO_EMBEDDED_ACCESS_CHECKS
+  derived->grant.privilege= SELECT_ACL;
+#endif
+
+  sl->context.resolve_in_table_list_only(derived->merge_underlying_list);
+  set_merged_select(sl, outer);
+  outer->select_n_having_items+= sl->select_n_having_items;
+  outer->select_n_where_fields+= sl->select_n_where_fields;
+
+  /* Subqueries of the derived table become subqueries of the outer SELECT */
+  unit->exclude_from_tree();
+
+  if (arena)
+    thd->restore_active_arena(arena, &backup);
+  DBUG_RETURN(FALSE);
+}
+
+
+/*
+  Check if a derived table can be filled on its first read
+
+  SYNOPSIS
+    derived_can_be_lazy()
+    thd                 Thread handle
+    lex                 LEX for this thread
+    derived             TABLE_LIST of the derived table
+
+  DESCRIPTION
+    The single SELECT of a derived table of a SELECT statement is then
+    only optimized by mysql_derived_filling(). The optimizer of the outer
+    SELECT may add keys to the table for its join conditions, EXPLAIN
+    does not execute it and it is not executed at all if it is not read.
+
+  RETURN
+    TRUE   fill the table on its first read
+    FALSE  fill it now
+*/
+
+static bool derived_can_be_lazy(THD *thd, LEX *lex, TABLE_LIST *derived)
+{
+  return (optimizer_flag(thd, OPTIMIZER_SWITCH_DERIVED_WITH_KEYS) &&
+          lex->sql_command == SQLCOM_SELECT &&
+          !derived->derived->is_union());
+}
+
+
+/*
+  Optimize the SELECT of a derived table to be filled on its first read
+
+  SYNOPSIS
+    derived_optimize()
+    thd                 Thread handle
+    derived             TABLE_LIST of the derived table
+
+  DESCRIPTION
+    The JOIN stays in the SELECT_LEX, mysql_select() reuses it when the
+    table is filled. The estimated number of rows of the result is stored
+    in the statistics of the empty table. A table estimated to have at
+    most one row is not marked as pending: it is filled right away, so
+    that the outer SELECT can read it as a constant table.
+
+  RETURN
+    FALSE  OK
+    TRUE   Error
+*/
+
+static bool derived_optimize(THD *thd, TABLE_LIST *derived)
+{
+  SELECT_LEX_UNIT *unit= derived->derived;
+  SELECT_LEX *first_select= unit->first_select();
+  JOIN *join= first_select->join;
+  double rows= 1.0;
+  DBUG_ENTER("derived_optimize");
+
+  join->select_options= (first_select->options | thd->variables.option_bits |
+                         SELECT_NO_UNLOCK);
+  if (join->optimize() || thd->is_error())
+    DBUG_RETURN(TRUE);
+
+  /* Aggregates without GROUP BY give one row */
+  if (join->zero_result_cause ||
+      (join->tmp_table_param.sum_func_count && !join->group_list) ||
+      join->const_tables == join->tables)
+    DBUG_RETURN(FALSE);
+  for (uint i= join->const_tables; i < join->tables; i++)
+    rows*= join->best_positions[i].records_read;
+  set_if_smaller(rows, (double) unit->select_limit_cnt);
+  if (rows >= 2.0)
+  {
+    derived->table->materialize_pending= TRUE;
+    derived->table->file->stats.records= (ha_rows) rows;
+  }
+  DBUG_RETURN(FALSE);
+}
+
+
 /**
   @brief Create temporary table structure (but do not fill it).
 
@@ -95,6 +379,10 @@ out:
   The table reference, contained in @c orig_table_list, is updated with the
   fields of a new temporary table.
 
+  An anonymous derived table that derived_can_be_merged() accepts gets no
+  temporary table: it is merged into the outer SELECT and from then on
+  processed like a VIEW with the @c MERGE algorithm.
+
   Derived tables are stored in @c thd->derived_tables and closed by
   close_thread_tables().
 
@@ -138,6 +426,21 @@ bool mysql_derived_prepare(THD *thd, LEX *lex, TABLE_LIST *orig_table_list)
   ulonglong create_options;
   DBUG_ENTER("mysql_derived_prepare");
   bool res= FALSE;
+
+  /* Merged at the first execution of a prepared statement */
+  if (orig_table_list->is_merged_derived())
+  {
+    orig_table_list->set_underlying_merge();
+    DBUG_RETURN(FALSE);
+  }
+  if (unit && derived_can_be_merged(thd, lex, orig_table_list))
+  {
+    if (merge_derived(thd, orig_table_list))
+      DBUG_RETURN(TRUE);
+    orig_table_list->set_underlying_merge();
+    DBUG_RETURN(FALSE);
+  }
+
   if (unit)
   {
     SELECT_LEX *first_select= unit->first_select();
@@ -255,6 +558,8 @@ exit:
     for derived table and node is deleted is it is a  simple SELECT.
     If you use this function, make sure it's not called at prepare.
     Due to evaluation of LIMIT clause it can not be used at prepared stage.
+    A table that derived_can_be_lazy() accepts is only optimized here and
+    filled by mysql_derived_materialize() on its first read.
 
   RETURN
     FALSE  OK
@@ -268,7 +573,7 @@ bool mysql_derived_filling(THD *thd, LEX *lex, TABLE_LIST *orig_table_list)
   bool res= FALSE;
 
   /*check that table creation pass without problem and it is derived table */
-  if (table && unit)
+  if (table && unit && !orig_table_list->is_merged_derived())
   {
     SELECT_LEX *first_select= unit->first_select();
     select_union *derived_result= orig_table_list->derived_result;
@@ -285,6 +590,20 @@ bool mysql_derived_filling(THD *thd, LEX *lex, TABLE_LIST *orig_table_list)
 	first_select->options&= ~OPTION_FOUND_ROWS;
 
       lex->current_select= first_select;
+      if (first_select->join && !first_select->join->optimized &&
+          derived_can_be_lazy(thd, lex, orig_table_list))
+      {
+        /*
+          Execute it on the first read of the table, once the optimizer
+          of the outer SELECT had the chance to add keys to it
+        */
+        if ((res= derived_optimize(thd, orig_table_list)) ||
+            table->materialize_pending)
+        {
+          lex->current_select= save_current_select;
+          return res;
+        }
+      }
       res= mysql_select(thd, &first_select->ref_pointer_array,
 			first_select->table_list.first,
 			first_select->with_wild,
@@ -314,6 +633,38 @@ bool mysql_derived_filling(THD *thd, LEX *lex, TABLE_LIST *orig_table_list)
 }
 
 
+/*
+  Fill a derived table on its first read
+
+  SYNOPSIS
+    mysql_derived_materialize()
+    thd                 Thread handle
+    derived             TABLE_LIST of the derived table
+
+  DESCRIPTION
+    Executes the SELECT that mysql_derived_filling() only optimized and
+    cleans up its unit, as open_and_lock_tables() does for the derived
+    tables it fills. Called by the readers of a table with
+    TABLE::materialize_pending set.
+
+  RETURN
+    FALSE  OK
+    TRUE   Error
+*/
+
+bool mysql_derived_materialize(THD *thd, TABLE_LIST *derived)
+{
+  bool res;
+  DBUG_ENTER("mysql_derived_materialize");
+
+  derived->table->materialize_pending= FALSE;
+  res= mysql_derived_filling(thd, thd->lex, derived);
+  if (!thd->lex->describe)
+    mysql_derived_cleanup(thd, thd->lex, derived);
+  DBUG_RETURN(res);
+}
+
+
 /**
    Cleans up the SELECT_LEX_UNIT for the derived table (if any).
 */
@@ -321,7 +672,9 @@ bool mysql_derived_filling(THD *thd, LEX *lex, TABLE_LIST *orig_table_list)
 bool mysql_derived_cleanup(THD *thd, LEX *lex, TABLE_LIST *derived)
 {
   SELECT_LEX_UNIT *unit= derived->derived;
-  if (unit)
+  /* A table filled on first read is cleaned up by mysql_derived_materialize */
+  if (unit && !derived->is_merged_derived() &&
+      !(derived->table && derived->table->materialize_pending))
     unit->cleanup();
   return false;
 }
@@ -25,6 +25,7 @@ bool mysql_handle_derived(LEX *lex, bool (*processor)(THD *thd,
                                                       TABLE_LIST *table));
 bool mysql_derived_prepare(THD *thd, LEX *lex, TABLE_LIST *t);
 bool mysql_derived_filling(THD *thd, LEX *lex, TABLE_LIST *t);
+bool mysql_derived_materialize(THD *thd, TABLE_LIST *derived);
 
 /**
    Cleans up the SELECT_LEX_UNIT for the derived table (if any).
@@ -76,6 +76,7 @@
 #include "rpl_mi.h"
 #include "transaction.h"
 #include "sql_audit.h"
+#include "sql_partition.h"       // prune_lock_partitions_for_insert
 
 #include "debug_sync.h"
 
@@ -661,6 +662,8 @@ bool mysql_insert(THD *thd,TABLE_LIST *table_list,
   bool changed;
   bool was_insert_delayed= (table_list->lock_type ==  TL_WRITE_DELAYED);
   uint value_count;
+  uint table_count= 0;
+  bool prune_before_lock= FALSE;
   ulong counter = 1;
   ulonglong id;
   COPY_INFO info;
@@ -711,7 +714,13 @@ bool mysql_insert(THD *thd,TABLE_LIST *table_list,
   }
   else
   {
-    if (open_and_lock_tables(thd, table_list, TRUE, 0))
+    /*
+      A partitioned table is locked once the rows are known, so that only
+      the partitions they go to are locked. ON DUPLICATE KEY UPDATE may
+      move a row to any partition.
+    */
+    if (open_tables_for_pruning(thd, table_list, duplic != DUP_UPDATE,
+                                &table_count, &prune_before_lock))
       DBUG_RETURN(TRUE);
   }
   lock_type= table_list->lock_type;
@@ -770,6 +779,15 @@ bool mysql_insert(THD *thd,TABLE_LIST *table_list,
   /* Restore the current context. */
   ctx_state.restore_state(context, table_list);
 
+#ifdef WITH_PARTITION_STORAGE_ENGINE
+  if (prune_before_lock)
+  {
+    prune_lock_partitions_for_insert(thd, table, fields, values_list);
+    if (lock_tables(thd, table_list, table_count, 0))
+      goto abort;
+  }
+#endif
+
   /*
     Fill in the given fields and dump it to the table file
   */
@@ -1975,6 +1975,40 @@ void st_select_lex_unit::exclude_tree()
 }
 
 
+/*
+  Exclude current unit from tree of SELECTs, but keep its SELECTs in the
+  global list
+
+  SYNOPSYS
+    st_select_lex_unit::exclude_from_tree()
+
+  NOTE: used for a derived table merged into the outer SELECT. The units
+  of its subqueries are brought up to the outer SELECT. Its SELECT_LEX is
+  still processed by mysql_handle_derived(), like the one of a merged VIEW,
+  but it is not executed.
+*/
+void st_select_lex_unit::exclude_from_tree()
+{
+  SELECT_LEX *upper= outer_select();
+  for (SELECT_LEX *sl= first_select(); sl; sl= sl->next_select())
+  {
+    SELECT_LEX_UNIT *next_unit;
+    for (SELECT_LEX_UNIT *u= sl->first_inner_unit(); u; u= next_unit)
+    {
+      SELECT_LEX_NODE *save_slave= u->slave;
+      next_unit= u->next_unit();
+      u->include_down(upper);
+      u->slave= save_slave; // fix include_down initialisation
+    }
+    sl->slave= 0;
+  }
+  // exclude currect unit from list of nodes
+  (*prev)= next;
+  if (next)
+    next->prev= prev;
+}
+
+
 /*
   st_select_lex_node::mark_as_dependent mark all st_select_lex struct from 
   this to 'last' as dependent
@@ -651,6 +651,7 @@ public:
   st_select_lex* return_after_parsing() { return return_to; }
   void exclude_level();
   void exclude_tree();
+  void exclude_from_tree();
 
   /* UNION methods */
   bool prepare(THD *thd, select_result *result, ulong additional_options);
@@ -2733,6 +2733,158 @@ bool partition_key_modified(TABLE *table, const MY_BITMAP *fields)
 }
 
 
+/*
+  Check if the partitions to lock can be pruned before locking the table
+
+  SYNOPSIS
+    can_prune_partitions_before_lock()
+    thd                  Thread object
+    table_list           Table of a single table INSERT, UPDATE or DELETE,
+                         opened but not locked
+
+  RETURN VALUES
+    TRUE                 The statement may restrict lock_partitions before
+                         it calls lock_tables()
+    FALSE                All partitions must be locked
+
+  DESCRIPTION
+    The conditions and values are fixed and used for pruning before the
+    table is locked, so they must not read any other table. This is only
+    done for a partitioned base table that is the only table of the
+    statement, without subqueries, stored functions or triggers, and
+    outside LOCK TABLES where all partitions are locked already.
+*/
+
+bool can_prune_partitions_before_lock(THD *thd, TABLE_LIST *table_list)
+{
+  TABLE *table;
+  LEX *lex= thd->lex;
+  DBUG_ENTER("can_prune_partitions_before_lock");
+
+  if (table_list->view || !(table= table_list->table) || !table->part_info)
+    DBUG_RETURN(FALSE);
+  DBUG_RETURN(table->s->db_type() == partition_hton &&
+              !table_list->next_global &&
+              !thd->locked_tables_mode &&
+              !table->triggers &&
+              !lex->uses_stored_routines() &&
+              !lex->select_lex.first_inner_unit());
+}
+
+
+/*
+  Lock only the partitions marked in used_partitions
+
+  SYNOPSIS
+    prune_lock_partitions()
+    table                Partitioned table, not locked yet
+    fields               Fields the statement modifies, NULL if none
+
+  DESCRIPTION
+    Called after prune_partitions() has marked the partitions an UPDATE or
+    DELETE reads. A row whose partitioning fields are modified may move to
+    any partition, so then all partitions stay locked.
+*/
+
+void prune_lock_partitions(TABLE *table, const MY_BITMAP *fields)
+{
+  partition_info *part_info= table->part_info;
+  DBUG_ENTER("prune_lock_partitions");
+
+  if (!fields ||
+      !bitmap_is_overlapping(&part_info->full_part_field_set, fields))
+    bitmap_copy(&part_info->lock_partitions, &part_info->used_partitions);
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Lock only the partitions the rows of an INSERT ... VALUES go to
+
+  SYNOPSIS
+    prune_lock_partitions_for_insert()
+    thd                  Thread object
+    table                Partitioned table, not locked yet
+    fields               Insert field list, empty if all fields are given
+    values_list          Rows to insert, already fixed
+
+  DESCRIPTION
+    The partitioning fields of each row are stored in record[0] and the
+    partition is found as in write_row(). Only values that are basic
+    constants are used, so nothing is evaluated twice. If the partition of
+    some row cannot be found here, all partitions stay locked and
+    write_row() reports the error.
+*/
+
+void prune_lock_partitions_for_insert(THD *thd, TABLE *table,
+                                      List<Item> &fields,
+                                      List<List<Item> > &values_list)
+{
+  partition_info *part_info= table->part_info;
+  List_iterator_fast<List_item> its(values_list);
+  List_item *values;
+  enum_check_fields saved_count_cuted_fields= thd->count_cuted_fields;
+  Dummy_error_handler error_handler;
+  my_bitmap_map *old_maps[2];
+  uint32 part_id;
+  longlong func_value;
+  DBUG_ENTER("prune_lock_partitions_for_insert");
+
+  /* These fields get their values in write_row() */
+  if ((table->timestamp_field &&
+       bitmap_is_set(&part_info->full_part_field_set,
+                     table->timestamp_field->field_index)) ||
+      (table->found_next_number_field &&
+       bitmap_is_set(&part_info->full_part_field_set,
+                     table->found_next_number_field->field_index)))
+    DBUG_VOID_RETURN;
+
+  /* The rows are stored again by the insert, which reports any warnings */
+  thd->count_cuted_fields= CHECK_FIELD_IGNORE;
+  thd->push_internal_handler(&error_handler);
+  dbug_tmp_use_all_columns(table, old_maps, table->read_set, table->write_set);
+  bitmap_clear_all(&part_info->lock_partitions);
+  while ((values= its++))
+  {
+    List_iterator_fast<Item> f(fields), v(*values);
+    Field **field_ptr= table->field;
+    Item *value;
+
+    restore_record(table, s->default_values);
+    while ((value= v++))
+    {
+      Field *field;
+      if (fields.elements)
+      {
+        Item_field *item_field= (f++)->filed_for_view_update();
+        if (!item_field)
+          goto all_partitions;
+        field= item_field->field;
+      }
+      else
+        field= *field_ptr++;
+      if (!bitmap_is_set(&part_info->full_part_field_set, field->field_index))
+        continue;
+      if (!value->basic_const_item() || value->save_in_field(field, 0) < 0)
+        goto all_partitions;
+    }
+    if (part_info->get_partition_id(part_info, &part_id, &func_value))
+      goto all_partitions;
+    bitmap_set_bit(&part_info->lock_partitions, part_id);
+  }
+  goto end;
+
+all_partitions:
+  bitmap_set_all(&part_info->lock_partitions);
+end:
+  restore_record(table, s->default_values);
+  dbug_tmp_restore_column_maps(table->read_set, table->write_set, old_maps);
+  thd->pop_internal_handler();
+  thd->count_cuted_fields= saved_count_cuted_fields;
+  DBUG_VOID_RETURN;
+}
+
+
 /*
   A function to handle correct handling of NULL values in partition
   functions.
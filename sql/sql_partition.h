@@ -97,6 +97,11 @@ bool check_partition_info(partition_info *part_info,handlerton **eng_type,
 void set_linear_hash_mask(partition_info *part_info, uint num_parts);
 bool fix_partition_func(THD *thd, TABLE *table, bool create_table_ind);
 bool partition_key_modified(TABLE *table, const MY_BITMAP *fields);
+bool can_prune_partitions_before_lock(THD *thd, TABLE_LIST *table_list);
+void prune_lock_partitions(TABLE *table, const MY_BITMAP *fields);
+void prune_lock_partitions_for_insert(THD *thd, TABLE *table,
+                                      List<Item> &fields,
+                                      List<List<Item> > &values_list);
 void get_partition_set(const TABLE *table, uchar *buf, const uint index,
                        const key_range *key_spec,
                        part_id_range *part_spec);
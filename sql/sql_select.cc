@@ -47,6 +47,7 @@
 #include "records.h"             // init_read_record, end_read_record
 #include "filesort.h"            // filesort_free_buffers
 #include "sql_union.h"           // mysql_union
+#include "sql_derived.h"         // mysql_derived_materialize
 #include "debug_sync.h"          // DEBUG_SYNC
 #include <m_ctype.h>
 #include <my_bit.h>
@@ -101,6 +102,9 @@ C_MODE_END
 static bool find_best(JOIN *join,table_map rest_tables,uint index,
 		      double record_count,double read_time);
 static uint cache_record_length(JOIN *join,uint index);
+static void calc_used_field_length(THD *thd, JOIN_TAB *join_tab);
+static bool has_equi_join(JOIN *join, JOIN_TAB *s, table_map prefix_tables);
+static bool hash_join_key_type(Item *a, Item *b, Item_result *cmp_type);
 static double prev_record_reads(JOIN *join, uint idx, table_map found_ref);
 static bool get_best_combination(JOIN *join);
 static store_key *get_store_key(THD *thd,
@@ -150,6 +154,10 @@ evaluate_null_complemented_join_record(JOIN *join, JOIN_TAB *join_tab);
 static enum_nested_loop_state
 flush_cached_records(JOIN *join, JOIN_TAB *join_tab, bool skip_last);
 static enum_nested_loop_state
+flush_cached_records_bka(JOIN *join, JOIN_TAB *join_tab);
+static enum_nested_loop_state
+flush_cached_records_hash(JOIN *join, JOIN_TAB *join_tab, bool last_flush);
+static enum_nested_loop_state
 end_send(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
 static enum_nested_loop_state
 end_send_group(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
@@ -216,11 +224,17 @@ static int remove_dup_with_hash_index(THD *thd,TABLE *table,
 
 				      ulong key_length,Item *having);
 static int join_init_cache(THD *thd,JOIN_TAB *tables,uint table_count);
+static int join_init_cache_fields(THD *thd, JOIN_CACHE *cache,
+                                  JOIN_TAB *tables, uint table_count);
+static int join_init_bka_cache(THD *thd, JOIN_TAB *tab);
+static JOIN_HASH *make_join_hash(JOIN *join, JOIN_TAB *tab);
+static int join_init_hash_cache(THD *thd, JOIN_TAB *tab);
+static void free_join_hash(JOIN_HASH *hash);
 static ulong used_blob_length(CACHE_FIELD **ptr);
 static bool store_record_in_cache(JOIN_CACHE *cache);
 static void reset_cache_read(JOIN_CACHE *cache);
 static void reset_cache_write(JOIN_CACHE *cache);
-static void read_cached_record(JOIN_TAB *tab);
+static void read_cached_record(JOIN_CACHE *cache);
 static bool cmp_buffer_with_ref(JOIN_TAB *tab);
 static bool setup_new_fields(THD *thd, List<Item> &fields,
 			     List<Item> &all_fields, ORDER *new_order);
@@ -2717,7 +2731,9 @@ make_join_statistics(JOIN *join, TABLE_LIST *tables_arg, COND *conds,
     s->filesort_used_loose_index_scan_agg_distinct= false;
     table_vector[i]=s->table=table=tables->table;
     table->pos_in_table_list= tables;
-    error= table->file->info(HA_STATUS_VARIABLE | HA_STATUS_NO_LOCK);
+    /* A derived table that is not filled yet keeps its estimate */
+    error= table->materialize_pending ? 0 :
+           table->file->info(HA_STATUS_VARIABLE | HA_STATUS_NO_LOCK);
 
     DBUG_EXECUTE_IF("bug11747970_raise_error",
                     {
@@ -3071,7 +3087,8 @@ make_join_statistics(JOIN *join, TABLE_LIST *tables_arg, COND *conds,
     add_group_and_distinct_keys(join, s);
 
     if (!s->const_keys.is_clear_all() &&
-        !s->table->pos_in_table_list->embedding)
+        !s->table->pos_in_table_list->embedding &&
+        !s->table->materialize_pending)
     {
       ha_rows records;
       SQL_SELECT *select;
@@ -3335,7 +3352,8 @@ add_key_field(KEY_FIELD **key_fields,uint and_level, Item_func *cond,
               table_map usable_tables, SARGABLE_PARAM **sargables)
 {
   uint exists_optimize= 0;
-  if (!(field->flags & PART_KEY_FLAG))
+  /* generate_derived_keys() may add keys to a table that is not filled yet */
+  if (!(field->flags & PART_KEY_FLAG) && !field->table->materialize_pending)
   {
     // Don't remove column IS NULL on a LEFT JOIN table
     if (!eq_func || (*value)->type() != Item::NULL_ITEM ||
@@ -3965,6 +3983,252 @@ static void add_key_fields_for_nj(JOIN *join, TABLE_LIST *nested_join_table,
 }
 
 
+/*
+  A key that generate_derived_keys() adds to a derived table: the columns
+  compared with values that depend on one set of tables.
+*/
+
+typedef struct st_derived_key {
+  table_map	used_tables;
+  uint		key_parts;
+  uint		key_length;
+  Field		*fields[HA_MAX_KEY_SEG];
+} DERIVED_KEY;
+
+
+/**
+  Add a column to a key of a derived table.
+
+  The keys are kept within what MyISAM supports, so that the HEAP table
+  can still be converted to MyISAM when it gets full. Columns that can
+  not be part of such a key are skipped.
+*/
+
+static void add_derived_key_part(DERIVED_KEY *key, Field *field)
+{
+  uint length;
+  if ((field->flags & BLOB_FLAG) || field->type() == MYSQL_TYPE_BIT ||
+      key->key_parts == HA_MAX_KEY_SEG)
+    return;
+  for (uint i= 0; i < key->key_parts; i++)
+  {
+    if (key->fields[i] == field)
+      return;
+  }
+  length= field->key_length();
+  if (field->real_maybe_null())
+    length+= HA_KEY_NULL_LENGTH;
+  if (field->real_type() == MYSQL_TYPE_VARCHAR)
+    length+= HA_KEY_BLOB_LENGTH;
+  if (key->key_length + length >= HA_MAX_KEY_LENGTH)
+    return;
+  key->fields[key->key_parts++]= field;
+  key->key_length+= length;
+}
+
+
+/**
+  Recreate the empty table of a derived table with the given keys.
+
+  The keys are named <auto_keyN>; they have no statistics until the table
+  is filled, and the estimated number of rows of the table is kept.
+
+  @retval
+    FALSE  OK
+  @retval
+    TRUE   Error
+*/
+
+static bool
+add_derived_keys(THD *thd, JOIN_TAB *tab, DERIVED_KEY *keys, uint key_count)
+{
+  TABLE *table= tab->table;
+  TABLE_SHARE *share= table->s;
+  TABLE_LIST *derived= table->pos_in_table_list;
+  ha_rows records= table->file->stats.records;
+  uint key_parts= 0;
+  KEY *keyinfo;
+  KEY_PART_INFO *key_part;
+  ulong *rec_per_key;
+  char name[32];
+
+  for (uint i= 0; i < key_count; i++)
+    key_parts+= keys[i].key_parts;
+  if (!(keyinfo= (KEY*) alloc_root(&table->mem_root,
+                                   sizeof(KEY) * key_count)) ||
+      !(key_part= (KEY_PART_INFO*) alloc_root(&table->mem_root,
+                                              sizeof(KEY_PART_INFO) *
+                                              key_parts)) ||
+      !(rec_per_key= (ulong*) alloc_root(&table->mem_root,
+                                         sizeof(ulong) * key_parts)))
+    return TRUE;
+  bzero((char*) keyinfo, sizeof(KEY) * key_count);
+  bzero((char*) key_part, sizeof(KEY_PART_INFO) * key_parts);
+  bzero((char*) rec_per_key, sizeof(ulong) * key_parts);
+
+  table->key_info= share->key_info= keyinfo;
+  share->keys= key_count;
+  share->key_parts= key_parts;
+  share->max_key_length= 0;
+  for (uint i= 0; i < key_count; i++, keyinfo++)
+  {
+    DERIVED_KEY *key= keys + i;
+    my_snprintf(name, sizeof(name), "<auto_key%u>", i);
+    if (!(keyinfo->name= strdup_root(&table->mem_root, name)))
+      return TRUE;
+    keyinfo->key_part= key_part;
+    keyinfo->rec_per_key= rec_per_key;
+    keyinfo->usable_key_parts= keyinfo->key_parts= key->key_parts;
+    keyinfo->algorithm= HA_KEY_ALG_UNDEF;
+    keyinfo->table= table;
+    for (uint j= 0; j < key->key_parts; j++, key_part++, rec_per_key++)
+    {
+      Field *field= key->fields[j];
+      key_part->field= field;
+      key_part->fieldnr= field->field_index + 1;
+      key_part->offset= field->offset(table->record[0]);
+      key_part->length= (uint16) field->key_length();
+      key_part->store_length= key_part->length;
+      key_part->type= (uint8) field->key_type();
+      key_part->key_type =
+	((ha_base_keytype) key_part->type == HA_KEYTYPE_TEXT ||
+	 (ha_base_keytype) key_part->type == HA_KEYTYPE_VARTEXT1 ||
+	 (ha_base_keytype) key_part->type == HA_KEYTYPE_VARTEXT2) ?
+	0 : FIELDFLAG_BINARY;
+      if (field->real_maybe_null())
+      {
+        key_part->null_bit= field->null_bit;
+        key_part->null_offset= (uint) (field->null_ptr - table->record[0]);
+        key_part->store_length+= HA_KEY_NULL_LENGTH;
+        keyinfo->flags|= HA_NULL_PART_KEY;
+      }
+      if (field->real_type() == MYSQL_TYPE_VARCHAR)
+      {
+        key_part->key_part_flag|= HA_VAR_LENGTH_PART;
+        key_part->store_length+= HA_KEY_BLOB_LENGTH;
+      }
+      keyinfo->key_length+= key_part->store_length;
+      if (j == 0)
+        field->key_start.set_bit(i);
+      field->flags|= PART_KEY_FLAG;
+    }
+    set_if_bigger(share->max_key_length, keyinfo->key_length);
+    share->keys_in_use.set_bit(i);
+    table->const_key_parts[i]= 0;
+    tab->keys.set_bit(i);
+  }
+  table->keys_in_use_for_query= share->keys_in_use;
+
+  table->file->ha_drop_table(share->table_name.str);
+  if (share->db_type() == myisam_hton &&
+      create_myisam_tmp_table(table, &derived->derived_result->tmp_table_param,
+                              (derived->derived->first_select()->options |
+                               thd->variables.option_bits),
+                              thd->variables.big_tables))
+    return TRUE;
+  if (open_tmp_table(table))
+    return TRUE;
+  table->file->extra(HA_EXTRA_WRITE_CACHE);
+  table->file->extra(HA_EXTRA_IGNORE_DUP_KEY);
+  table->file->stats.records= records;
+  return FALSE;
+}
+
+
+/**
+  Add keys for the equalities on their columns to the derived tables that
+  are filled on their first read.
+
+  @param       thd         Thread handle
+  @param       join_tab    Array in tablenr_order
+  @param       tables      Number of tables in join
+  @param       key_fields  Equalities found by add_key_fields()
+  @param       end         End of key_fields
+
+  @details
+    The columns of such a table that are compared with values depending on
+    the same tables form one key. Columns compared with constants are
+    appended to each of these keys, or form a key of their own if there is
+    no other one. add_key_part() then finds the keys like those of any
+    other table.
+
+  @retval
+    FALSE  OK
+  @retval
+    TRUE   Out of memory.
+*/
+
+static bool
+generate_derived_keys(THD *thd, JOIN_TAB *join_tab, uint tables,
+                      KEY_FIELD *key_fields, KEY_FIELD *end)
+{
+  for (uint i= 0; i < tables; i++)
+  {
+    TABLE *table= join_tab[i].table;
+    DERIVED_KEY *keys= NULL, const_key;
+    uint key_count= 0;
+
+    if (!table->materialize_pending || table->s->keys)
+      continue;
+    const_key.used_tables= 0;
+    const_key.key_parts= const_key.key_length= 0;
+    for (KEY_FIELD *field= key_fields; field != end; field++)
+    {
+      table_map used_tables;
+      DERIVED_KEY *key;
+
+      if (field->field->table != table || !field->eq_func ||
+          (field->optimize & KEY_OPTIMIZE_EXISTS))
+        continue;
+      if (!(used_tables= field->val->used_tables()))
+      {
+        add_derived_key_part(&const_key, field->field);
+        continue;
+      }
+      for (key= keys; key != keys + key_count; key++)
+      {
+        if (key->used_tables == used_tables)
+          break;
+      }
+      if (key == keys + key_count)
+      {
+        if (key_count == MAX_KEY)
+          continue;
+        if (!keys &&
+            !(keys= (DERIVED_KEY*) thd->alloc(sizeof(DERIVED_KEY) * MAX_KEY)))
+          return TRUE;
+        key= keys + key_count;
+        key->used_tables= used_tables;
+        key->key_parts= key->key_length= 0;
+      }
+      add_derived_key_part(key, field->field);
+      if (key->key_parts && key == keys + key_count)
+        key_count++;
+    }
+
+    if (const_key.key_parts)
+    {
+      if (!key_count)
+      {
+        keys= &const_key;
+        key_count= 1;
+      }
+      else
+      {
+        for (DERIVED_KEY *key= keys; key != keys + key_count; key++)
+        {
+          for (uint j= 0; j < const_key.key_parts; j++)
+            add_derived_key_part(key, const_key.fields[j]);
+        }
+      }
+    }
+    if (key_count && add_derived_keys(thd, join_tab + i, keys, key_count))
+      return TRUE;
+  }
+  return FALSE;
+}
+
+
 /**
   Update keyuse array with all possible keys we can use to fetch rows.
   
@@ -3993,7 +4257,7 @@ update_ref_and_keys(THD *thd, DYNAMIC_ARRAY *keyuse,JOIN_TAB *join_tab,
                     SARGABLE_PARAM **sargables)
 {
   uint	and_level,i,found_eq_constant;
-  KEY_FIELD *key_fields, *end, *field;
+  KEY_FIELD *key_fields, *end, *field, *where_end;
   uint sz;
   uint m= max(select_lex->max_equal_elems,1);
   
@@ -4033,19 +4297,9 @@ update_ref_and_keys(THD *thd, DYNAMIC_ARRAY *keyuse,JOIN_TAB *join_tab,
   if (my_init_dynamic_array(keyuse,sizeof(KEYUSE),20,64))
     return TRUE;
   if (cond)
-  {
     add_key_fields(join_tab->join, &end, &and_level, cond, normal_tables,
                    sargables);
-    for (; field != end ; field++)
-    {
-      if (add_key_part(keyuse,field))
-        return TRUE;
-      /* Mark that we can optimize LEFT JOIN */
-      if (field->val->type() == Item::NULL_ITEM &&
-	  !field->field->real_maybe_null())
-	field->field->table->reginfo.not_exists_optimize=1;
-    }
-  }
+  where_end= end;
   for (i=0 ; i < tables ; i++)
   {
     /*
@@ -4075,11 +4329,18 @@ update_ref_and_keys(THD *thd, DYNAMIC_ARRAY *keyuse,JOIN_TAB *join_tab,
     }
   }
 
+  if (generate_derived_keys(thd, join_tab, tables, key_fields, end))
+    return TRUE;
+
   /* fill keyuse with found key parts */
   for ( ; field != end ; field++)
   {
     if (add_key_part(keyuse,field))
       return TRUE;
+    /* Mark that we can optimize LEFT JOIN */
+    if (field < where_end && field->val->type() == Item::NULL_ITEM &&
+        !field->field->real_maybe_null())
+      field->field->table->reginfo.not_exists_optimize=1;
   }
 
   if (select_lex->ftfunc_list->elements)
@@ -4885,6 +5146,26 @@ best_access_path(JOIN      *join,
           (tmp +
            (s->records - rnd_records)/(double) TIME_FOR_COMPARE);
       }
+      else if (optimizer_flag(thd, OPTIMIZER_SWITCH_HASH_JOIN) &&
+               has_equi_join(join, s, ~remaining_tables))
+      {
+        /*
+          Hash join reads the table once. If the records of the previous
+          tables do not fit in the join buffer, both sides are written to
+          partition files and read back once more.
+        */
+        double cache_length= (double) cache_record_length(join,idx) *
+                             record_count;
+        if (cache_length > (double) thd->variables.join_buff_size)
+        {
+          if (!s->used_fieldlength)
+            calc_used_field_length(thd, s);
+          tmp+= 2.0 * (cache_length +
+                       (double) s->used_fieldlength * s->records) /
+                (double) IO_SIZE;
+        }
+        tmp+= (s->records - rnd_records)/(double) TIME_FOR_COMPARE;
+      }
       else
       {
         /* We read the table as many times as join buffer becomes full. */
@@ -4940,6 +5221,49 @@ best_access_path(JOIN      *join,
 }
 
 
+/**
+  Check if a table is joined with some of the given tables by an
+  equality of columns, which a hash join can use.
+
+    Only pairs of columns accepted by hash_join_key_type() are considered,
+    the same as make_join_hash() does when it builds the key.
+
+  @param join           the join
+  @param s              the table
+  @param prefix_tables  tables that precede the table in the join order
+*/
+
+static bool has_equi_join(JOIN *join, JOIN_TAB *s, table_map prefix_tables)
+{
+  if (!join->cond_equal)
+    return FALSE;
+  List_iterator_fast<Item_equal> it(join->cond_equal->current_level);
+  Item_equal *item_equal;
+  while ((item_equal= it++))
+  {
+    Item_equal_iterator field_it(*item_equal);
+    Item_equal_iterator prefix_it(*item_equal);
+    Item_field *item_field, *prefix_field;
+    if (item_equal->get_const())
+      continue;                                 // Substituted by constants
+    while ((item_field= field_it++))
+    {
+      if (item_field->field->table->map != s->table->map)
+        continue;
+      prefix_it.rewind();
+      while ((prefix_field= prefix_it++))
+      {
+        Item_result cmp_type;
+        if ((prefix_field->field->table->map & prefix_tables) &&
+            hash_join_key_type(item_field, prefix_field, &cmp_type))
+          return TRUE;
+      }
+    }
+  }
+  return FALSE;
+}
+
+
 /**
   Selects and invokes a search strategy for an optimal query plan.
 
@@ -6174,9 +6498,13 @@ JOIN::make_simple_join(JOIN *parent, TABLE *temp_table)
   do_send_rows= row_limit ? 1 : 0;
 
   join_tab->cache.buff=0;			/* No caching */
+  join_tab->cache.ranges=0;
+  join_tab->cache.hash=0;
+  join_tab->use_bka= 0;
   join_tab->table=temp_table;
   join_tab->select=0;
   join_tab->select_cond=0;
+  join_tab->pre_idx_push_select_cond= 0;
   join_tab->quick=0;
   join_tab->type= JT_ALL;			/* Map through all records */
   join_tab->keys.init();
@@ -6641,15 +6969,17 @@ make_join_select(JOIN *join,SQL_SELECT *select,COND *cond)
 	    We plan to scan all rows.
 	    Check again if we should use an index.
 	    We could have used an column from a previous table in
-	    the index if we are using limit and this is the first table
+	    the index if we are using limit and this is the first table.
+	    A derived table that is not filled yet has no rows to check.
 	  */
 
-	  if ((cond &&
-              !tab->keys.is_subset(tab->const_keys) && i > 0) ||
-	      (!tab->const_keys.is_clear_all() && i == join->const_tables &&
-	       join->unit->select_limit_cnt <
-	       join->best_positions[i].records_read &&
-	       !(join->select_options & OPTION_FOUND_ROWS)))
+	  if (!tab->table->materialize_pending &&
+              ((cond &&
+                !tab->keys.is_subset(tab->const_keys) && i > 0) ||
+               (!tab->const_keys.is_clear_all() && i == join->const_tables &&
+                join->unit->select_limit_cnt <
+                join->best_positions[i].records_read &&
+                !(join->select_options & OPTION_FOUND_ROWS))))
 	  {
 	    /* Join with outer join condition */
 	    COND *orig_cond=sel->cond;
@@ -6836,109 +7166,422 @@ void rr_unlock_row(st_join_table *tab)
 
 
 /**
-  Pick the appropriate access method functions
-
-  Sets the functions for the selected table access method
-
-  @param      tab               Table reference to put access method
+  Check if some key part of a ref access is built from an equality
+  that the subquery code can switch off.
 */
 
-static void
-pick_table_access_method(JOIN_TAB *tab)
+static bool ref_has_cond_guards(TABLE_REF *ref)
 {
-  switch (tab->type) 
+  for (uint i= 0; i < ref->key_parts; i++)
   {
-  case JT_REF:
-    tab->read_first_record= join_read_always_key;
-    tab->read_record.read_record= join_read_next_same;
-    break;
+    if (ref->cond_guards[i])
+      return TRUE;
+  }
+  return FALSE;
+}
 
-  case JT_REF_OR_NULL:
-    tab->read_first_record= join_read_always_key_or_null;
-    tab->read_record.read_record= join_read_next_same_or_null;
-    break;
 
-  case JT_CONST:
-    tab->read_first_record= join_read_const;
-    tab->read_record.read_record= join_no_more_records;
-    break;
+/**
+  Check if an item can be evaluated using only the columns of an index.
 
-  case JT_EQ_REF:
-    tab->read_first_record= join_read_key;
-    tab->read_record.read_record= join_no_more_records;
-    break;
+  @param item   Condition or expression to check
+  @param tbl    The table the index belongs to
+  @param keyno  The index
 
-  case JT_FT:
-    tab->read_first_record= join_ft_read_first;
-    tab->read_record.read_record= join_ft_read_next;
-    break;
+  @note Subqueries, stored and user-defined functions, user variable
+  assignments and trigger guards are never evaluated by the storage
+  engine: they may have side effects or depend on state the engine does
+  not see.
 
-  case JT_SYSTEM:
-    tab->read_first_record= join_read_system;
-    tab->read_record.read_record= join_no_more_records;
-    break;
+  @return TRUE if the item can be checked against an index record.
+*/
 
-  /* keep gcc happy */  
+static bool uses_index_fields_only(Item *item, TABLE *tbl, uint keyno)
+{
+  if (item->has_subquery())
+    return FALSE;
+  if (item->const_item())
+    return TRUE;
+  if (item->used_tables() & ~tbl->map)
+    return FALSE;
+
+  switch (item->type()) {
+  case Item::FUNC_ITEM:
+  {
+    Item_func *item_func= (Item_func*) item;
+    switch (item_func->functype()) {
+    case Item_func::TRIG_COND_FUNC:
+    case Item_func::FT_FUNC:
+    case Item_func::FUNC_SP:
+    case Item_func::UDF_FUNC:
+    case Item_func::SUSERVAR_FUNC:
+      return FALSE;
+    default:
+      break;
+    }
+    Item **arg= item_func->arguments();
+    Item **arg_end= arg + item_func->argument_count();
+    for (; arg < arg_end; arg++)
+    {
+      if (!uses_index_fields_only(*arg, tbl, keyno))
+        return FALSE;
+    }
+    return TRUE;
+  }
+  case Item::COND_ITEM:
+  {
+    List_iterator<Item> li(*((Item_cond*) item)->argument_list());
+    Item *cond_item;
+    while ((cond_item= li++))
+    {
+      if (!uses_index_fields_only(cond_item, tbl, keyno))
+        return FALSE;
+    }
+    return TRUE;
+  }
+  case Item::FIELD_ITEM:
+  {
+    Field *field= ((Item_field*) item)->field;
+    if (field->table != tbl || !field->part_of_key.is_set(keyno))
+      return FALSE;
+    /* Only a prefix of a BLOB is stored in the index */
+    return field->type() != MYSQL_TYPE_BLOB &&
+           field->type() != MYSQL_TYPE_GEOMETRY;
+  }
+  case Item::REF_ITEM:
+    return uses_index_fields_only(item->real_item(), tbl, keyno);
   default:
-    break;  
+    return FALSE;
   }
 }
 
 
-static void
-make_join_readinfo(JOIN *join, ulonglong options)
-{
-  uint i;
-  bool statistics= test(!(join->select_options & SELECT_DESCRIBE));
-  bool ordered_set= 0;
-  bool sorted= 1;
-  DBUG_ENTER("make_join_readinfo");
+/**
+  Extract the part of a condition that can be checked on index records.
 
-  for (i=join->const_tables ; i < join->tables ; i++)
-  {
-    JOIN_TAB *tab=join->join_tab+i;
-    TABLE *table=tab->table;
-    tab->read_record.table= table;
-    tab->read_record.file=table->file;
-    tab->read_record.unlock_row= rr_unlock_row;
-    tab->next_select=sub_select;		/* normal select */
+  For an AND, the usable conjuncts are extracted. An OR is extracted
+  only if every disjunct has a usable part. The result may be weaker
+  than the original condition, but never stronger.
 
-    /*
-      Determine if the set is already ordered for ORDER BY, so it can 
-      disable join cache because it will change the ordering of the results.
-      Code handles sort table that is at any location (not only first after 
-      the const tables) despite the fact that it's currently prohibited.
-      We must disable join cache if the first non-const table alone is
-      ordered. If there is a temp table the ordering is done as a last
-      operation and doesn't prevent join cache usage.
-    */
-    if (!ordered_set && !join->need_tmp && 
-        (table == join->sort_by_table ||
-         (join->sort_by_table == (TABLE *) 1 && i != join->const_tables)))
-      ordered_set= 1;
+  @param cond   Condition to extract from
+  @param table  The table the index belongs to
+  @param keyno  The index
 
-    tab->sorted= sorted;
-    sorted= 0;                                  // only first must be sorted
-    table->status=STATUS_NO_RECORD;
-    pick_table_access_method (tab);
+  @return The index condition, or NULL if no part of cond can be checked.
+*/
 
-    switch (tab->type) {
-    case JT_EQ_REF:
-      tab->read_record.unlock_row= join_read_key_unlock_row;
-      /* fall through */
-    case JT_REF_OR_NULL:
-    case JT_REF:
-      if (tab->select)
+static Item *make_cond_for_index(Item *cond, TABLE *table, uint keyno)
+{
+  if (cond->type() == Item::COND_ITEM)
+  {
+    if (((Item_cond*) cond)->functype() == Item_func::COND_AND_FUNC)
+    {
+      Item_cond_and *new_cond= new Item_cond_and;
+      if (!new_cond)
+        return NULL;
+      List_iterator<Item> li(*((Item_cond*) cond)->argument_list());
+      Item *item;
+      while ((item= li++))
       {
-	delete tab->select->quick;
-	tab->select->quick=0;
+        Item *fix= make_cond_for_index(item, table, keyno);
+        if (fix)
+          new_cond->argument_list()->push_back(fix);
       }
-      delete tab->quick;
-      tab->quick=0;
-      /* fall through */
-    case JT_CONST:				// Only happens with left join
-      if (table->covering_keys.is_set(tab->ref.key) &&
-	  !table->no_keyread)
+      switch (new_cond->argument_list()->elements) {
+      case 0:
+        return NULL;
+      case 1:
+        return new_cond->argument_list()->head();
+      default:
+        new_cond->quick_fix_field();
+        new_cond->used_tables_cache=
+          ((Item_cond_and*) cond)->used_tables_cache & table->map;
+        return new_cond;
+      }
+    }
+    else
+    {
+      Item_cond_or *new_cond= new Item_cond_or;
+      if (!new_cond)
+        return NULL;
+      List_iterator<Item> li(*((Item_cond*) cond)->argument_list());
+      Item *item;
+      while ((item= li++))
+      {
+        Item *fix= make_cond_for_index(item, table, keyno);
+        if (!fix)
+          return NULL;
+        new_cond->argument_list()->push_back(fix);
+      }
+      new_cond->quick_fix_field();
+      new_cond->used_tables_cache= ((Item_cond_or*) cond)->used_tables_cache;
+      new_cond->top_level_item();
+      return new_cond;
+    }
+  }
+
+  if (!uses_index_fields_only(cond, table, keyno))
+    return NULL;
+  return cond;
+}
+
+
+/**
+  Extract the part of a condition that is not fully checked by the
+  index condition built by make_cond_for_index().
+
+  @return The remaining condition, or NULL if nothing remains.
+*/
+
+static Item *make_cond_remainder(Item *cond, TABLE *table, uint keyno)
+{
+  if (cond->type() == Item::COND_ITEM &&
+      ((Item_cond*) cond)->functype() == Item_func::COND_AND_FUNC)
+  {
+    Item_cond_and *new_cond= new Item_cond_and;
+    if (!new_cond)
+      return cond;
+    List_iterator<Item> li(*((Item_cond*) cond)->argument_list());
+    Item *item;
+    while ((item= li++))
+    {
+      Item *fix= make_cond_remainder(item, table, keyno);
+      if (fix)
+        new_cond->argument_list()->push_back(fix);
+    }
+    switch (new_cond->argument_list()->elements) {
+    case 0:
+      return NULL;
+    case 1:
+      return new_cond->argument_list()->head();
+    default:
+      new_cond->quick_fix_field();
+      new_cond->used_tables_cache= ((Item_cond_and*) cond)->used_tables_cache;
+      return new_cond;
+    }
+  }
+  /* An OR is only checked in full if all of its disjuncts are */
+  return uses_index_fields_only(cond, table, keyno) ? NULL : cond;
+}
+
+
+/**
+  Push the part of a table's condition that depends only on the columns
+  of the index used to access it down to the storage engine.
+
+  The engine then checks the condition on index records and skips
+  non-matching rows before it reads the full row. What is left of the
+  condition is evaluated by the join as usual.
+
+  @param tab    Join table, access method already chosen
+  @param keyno  The index used to access the table
+*/
+
+static void push_index_cond(JOIN_TAB *tab, uint keyno)
+{
+  TABLE *table= tab->table;
+  THD *thd= tab->join->thd;
+  Item *idx_cond;
+  DBUG_ENTER("push_index_cond");
+
+  if (!optimizer_flag(thd, OPTIMIZER_SWITCH_INDEX_CONDITION_PUSHDOWN) ||
+      !tab->select_cond ||
+      thd->lex->sql_command == SQLCOM_UPDATE_MULTI ||
+      thd->lex->sql_command == SQLCOM_DELETE_MULTI ||
+      !(table->file->index_flags(keyno, 0, 1) & HA_DO_INDEX_COND_PUSHDOWN) ||
+      (table->file->index_flags(keyno, 0, 0) & HA_CLUSTERED_INDEX) ||
+      (keyno == table->s->primary_key &&
+       table->file->primary_key_is_clustered()) ||
+      table->key_read)
+    DBUG_VOID_RETURN;
+
+  if (!(idx_cond= make_cond_for_index(tab->select_cond, table, keyno)))
+    DBUG_VOID_RETURN;
+
+  Item *idx_remainder_cond= table->file->idx_cond_push(keyno, idx_cond);
+  if (idx_remainder_cond == idx_cond)
+    DBUG_VOID_RETURN;                           // Not accepted
+
+  Item *row_cond= make_cond_remainder(tab->select_cond, table, keyno);
+  if (idx_remainder_cond)
+  {
+    if (row_cond)
+    {
+      Item_cond_and *new_cond= new Item_cond_and(row_cond,
+                                                 idx_remainder_cond);
+      if (!new_cond)
+      {
+        table->file->cancel_pushed_idx_cond();
+        DBUG_VOID_RETURN;
+      }
+      new_cond->quick_fix_field();
+      new_cond->used_tables_cache= row_cond->used_tables() |
+                                   idx_remainder_cond->used_tables();
+      row_cond= new_cond;
+    }
+    else
+      row_cond= idx_remainder_cond;
+  }
+
+  tab->pre_idx_push_select_cond= tab->select_cond;
+  tab->select_cond= row_cond;
+  if (tab->select)
+    tab->select->cond= row_cond;
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Undo push_index_cond() when the access method of a table is changed
+  to one the pushed index condition is not valid for.
+*/
+
+static void cancel_index_cond_push(JOIN_TAB *tab)
+{
+  if (!tab->pre_idx_push_select_cond)
+    return;
+  tab->table->file->cancel_pushed_idx_cond();
+  tab->select_cond= tab->pre_idx_push_select_cond;
+  if (tab->select)
+    tab->select->cond= tab->select_cond;
+  tab->pre_idx_push_select_cond= NULL;
+}
+
+
+/**
+  Pick the appropriate access method functions
+
+  Sets the functions for the selected table access method
+
+  @param      tab               Table reference to put access method
+*/
+
+static void
+pick_table_access_method(JOIN_TAB *tab)
+{
+  switch (tab->type) 
+  {
+  case JT_REF:
+    tab->read_first_record= join_read_always_key;
+    tab->read_record.read_record= join_read_next_same;
+    break;
+
+  case JT_REF_OR_NULL:
+    tab->read_first_record= join_read_always_key_or_null;
+    tab->read_record.read_record= join_read_next_same_or_null;
+    break;
+
+  case JT_CONST:
+    tab->read_first_record= join_read_const;
+    tab->read_record.read_record= join_no_more_records;
+    break;
+
+  case JT_EQ_REF:
+    tab->read_first_record= join_read_key;
+    tab->read_record.read_record= join_no_more_records;
+    break;
+
+  case JT_FT:
+    tab->read_first_record= join_ft_read_first;
+    tab->read_record.read_record= join_ft_read_next;
+    break;
+
+  case JT_SYSTEM:
+    tab->read_first_record= join_read_system;
+    tab->read_record.read_record= join_no_more_records;
+    break;
+
+  /* keep gcc happy */  
+  default:
+    break;  
+  }
+}
+
+
+static void
+make_join_readinfo(JOIN *join, ulonglong options)
+{
+  uint i;
+  bool statistics= test(!(join->select_options & SELECT_DESCRIBE));
+  bool ordered_set= 0;
+  bool sorted= 1;
+  DBUG_ENTER("make_join_readinfo");
+
+  for (i=join->const_tables ; i < join->tables ; i++)
+  {
+    JOIN_TAB *tab=join->join_tab+i;
+    TABLE *table=tab->table;
+    tab->read_record.table= table;
+    tab->read_record.file=table->file;
+    tab->read_record.unlock_row= rr_unlock_row;
+    tab->next_select=sub_select;		/* normal select */
+
+    /*
+      Determine if the set is already ordered for ORDER BY, so it can 
+      disable join cache because it will change the ordering of the results.
+      Code handles sort table that is at any location (not only first after 
+      the const tables) despite the fact that it's currently prohibited.
+      We must disable join cache if the first non-const table alone is
+      ordered. If there is a temp table the ordering is done as a last
+      operation and doesn't prevent join cache usage.
+    */
+    if (!ordered_set && !join->need_tmp && 
+        (table == join->sort_by_table ||
+         (join->sort_by_table == (TABLE *) 1 && i != join->const_tables)))
+      ordered_set= 1;
+
+    tab->sorted= sorted;
+    sorted= 0;                                  // only first must be sorted
+    table->status=STATUS_NO_RECORD;
+    pick_table_access_method (tab);
+
+    switch (tab->type) {
+    case JT_EQ_REF:
+      tab->read_record.unlock_row= join_read_key_unlock_row;
+      /* fall through */
+    case JT_REF_OR_NULL:
+    case JT_REF:
+      if (tab->select)
+      {
+	delete tab->select->quick;
+	tab->select->quick=0;
+      }
+      delete tab->quick;
+      tab->quick=0;
+      /*
+        Batched Key Access: buffer the rows of the previous tables in the
+        join cache and look up their keys in this table in batches.
+        Like the cache for full scans, this changes the order of the rows.
+      */
+      if (tab->type != JT_REF_OR_NULL &&
+          i != join->const_tables && !(options & SELECT_NO_JOIN_CACHE) &&
+          !tab->first_inner && !ordered_set &&
+          optimizer_flag(join->thd, OPTIMIZER_SWITCH_BKA) &&
+          !ref_has_cond_guards(&tab->ref))
+      {
+        bool use_cache= TRUE;
+        if (!(options & SELECT_DESCRIBE))
+        {
+          if (join_init_cache(join->thd, join->join_tab+join->const_tables,
+                              i-join->const_tables))
+            use_cache= FALSE;
+          else if (join_init_bka_cache(join->thd, tab))
+          {
+            my_free(tab->cache.buff);
+            tab->cache.buff= 0;
+            use_cache= FALSE;
+          }
+        }
+        if (use_cache)
+        {
+          tab[-1].next_select=sub_select_cache; /* Patch previous */
+          tab->use_bka= TRUE;
+        }
+      }
+      /* fall through */
+    case JT_CONST:				// Only happens with left join
+      if (table->covering_keys.is_set(tab->ref.key) &&
+	  !table->no_keyread)
         table->set_keyread(TRUE);
       break;
     case JT_ALL:
@@ -6954,6 +7597,18 @@ make_join_readinfo(JOIN *join, ulonglong options)
 			     i-join->const_tables))
 	{
 	  tab[-1].next_select=sub_select_cache; /* Patch previous */
+          /*
+            Hash join: probe a hash table over the cached records with the
+            rows of this table instead of comparing every pair of them.
+          */
+          if (optimizer_flag(join->thd, OPTIMIZER_SWITCH_HASH_JOIN) &&
+              (tab->cache.hash= make_join_hash(join, tab)) &&
+              !(options & SELECT_DESCRIBE) &&
+              join_init_hash_cache(join->thd, tab))
+          {
+            free_join_hash(tab->cache.hash);
+            tab->cache.hash= 0;
+          }
 	}
       }
       /* These init changes read_record */
@@ -7042,6 +7697,16 @@ make_join_readinfo(JOIN *join, ulonglong options)
     case JT_MAYBE_REF:
       abort();					/* purecov: deadcode */
     }
+
+    /* Let the storage engine filter index records with the condition */
+    if (tab->type == JT_REF || tab->type == JT_EQ_REF ||
+        tab->type == JT_REF_OR_NULL)
+      push_index_cond(tab, tab->ref.key);
+    else if (tab->type == JT_ALL && tab->use_quick != 2 &&
+             tab->select && tab->select->quick &&
+             tab->select->quick->get_type() ==
+             QUICK_SELECT_I::QS_TYPE_RANGE)
+      push_index_cond(tab, tab->select->quick->index);
   }
   join->join_tab[join->tables-1].next_select=0; /* Set by do_select */
   DBUG_VOID_RETURN;
@@ -7093,6 +7758,13 @@ void JOIN_TAB::cleanup()
   quick= 0;
   my_free(cache.buff);
   cache.buff= 0;
+  my_free(cache.ranges);
+  cache.ranges= 0;
+  if (cache.hash)
+  {
+    free_join_hash(cache.hash);
+    cache.hash= 0;
+  }
   limit= 0;
   if (table)
   {
@@ -10623,9 +11295,15 @@ create_tmp_table(THD *thd,TMP_TABLE_PARAM *param,List<Item> &fields,
   *blob_field= 0;				// End marker
   share->fields= field_count;
 
-  /* If result table is small; use a heap */
+  /*
+    If result table is small; use a heap. HEAP stores BLOB columns but
+    can't use them in keys, so GROUP BY and DISTINCT over them need MyISAM.
+    I_S tables with BLOB columns stay in MyISAM too: CREATE TABLE ... LIKE
+    copies their engine into a durable table, which must keep its rows.
+  */
   /* future: storage engine selection can be made dynamic? */
-  if (blob_count || using_unique_constraint
+  if ((blob_count && (group || distinct || param->schema_table)) ||
+      using_unique_constraint
       || (thd->variables.big_tables && !(select_options & SELECT_SMALL_RESULT))
       || (select_options & TMP_TABLE_FORCE_MYISAM))
   {
@@ -10801,8 +11479,10 @@ create_tmp_table(THD *thd,TMP_TABLE_PARAM *param,List<Item> &fields,
   param->recinfo=recinfo;
   store_record(table,s->default_values);        // Make empty default record
 
-  if (thd->variables.tmp_table_size == ~ (ulonglong) 0)		// No limit
-    share->max_rows= ~(ha_rows) 0;
+  if (thd->variables.tmp_table_size == ~ (ulonglong) 0 ||	// No limit
+      (share->db_type() == heap_hton &&
+       share->blob_fields + share->varchar_fields))
+    share->max_rows= ~(ha_rows) 0;	// HEAP checks the memory it uses
   else
     share->max_rows= (ha_rows) (((share->db_type() == heap_hton) ?
                                  min(thd->variables.tmp_table_size,
@@ -11140,24 +11820,34 @@ static bool create_myisam_tmp_table(TABLE *table,TMP_TABLE_PARAM *param,
 				    ulonglong options, my_bool big_tables)
 {
   int error;
-  MI_KEYDEF keydef;
+  MI_KEYDEF keydef_buff, *keydef= &keydef_buff;
   MI_UNIQUEDEF uniquedef;
-  KEY *keyinfo=param->keyinfo;
+  KEY *keyinfo=table->key_info;
   TABLE_SHARE *share= table->s;
   DBUG_ENTER("create_myisam_tmp_table");
 
   if (share->keys)
   {						// Get keys for ni_create
     bool using_unique_constraint=0;
+    KEY *keyinfo_end= keyinfo + share->keys;
+    uint key_parts= 0;
+    for (uint i=0; i < share->keys ; i++)
+      key_parts+= keyinfo[i].key_parts;
     HA_KEYSEG *seg= (HA_KEYSEG*) alloc_root(&table->mem_root,
-                                            sizeof(*seg) * keyinfo->key_parts);
+                                            sizeof(*seg) * key_parts);
     if (!seg)
       goto err;
 
-    bzero(seg, sizeof(*seg) * keyinfo->key_parts);
-    if (keyinfo->key_length >= table->file->max_key_length() ||
-	keyinfo->key_parts > table->file->max_key_parts() ||
-	share->uniques)
+    bzero(seg, sizeof(*seg) * key_parts);
+    /* Derived tables may have several keys, see generate_derived_keys() */
+    if (share->keys > 1 &&
+        !(keydef= (MI_KEYDEF*) alloc_root(&table->mem_root,
+                                          sizeof(*keydef) * share->keys)))
+      goto err;
+    if (share->keys == 1 &&
+        (keyinfo->key_length >= table->file->max_key_length() ||
+         keyinfo->key_parts > table->file->max_key_parts() ||
+         share->uniques))
     {
       /* Can't create a key; Make a unique constraint instead of a key */
       share->keys=    0;
@@ -11175,49 +11865,53 @@ static bool create_myisam_tmp_table(TABLE *table,TMP_TABLE_PARAM *param,
       param->recinfo++;
       share->reclength+=MI_UNIQUE_HASH_LENGTH;
     }
-    else
-    {
-      /* Create an unique key */
-      bzero((char*) &keydef,sizeof(keydef));
-      keydef.flag=HA_NOSAME | HA_BINARY_PACK_KEY | HA_PACK_KEY;
-      keydef.keysegs=  keyinfo->key_parts;
-      keydef.seg= seg;
-    }
-    for (uint i=0; i < keyinfo->key_parts ; i++,seg++)
+    for (uint k=0; keyinfo != keyinfo_end ; k++, keyinfo++)
     {
-      Field *field=keyinfo->key_part[i].field;
-      seg->flag=     0;
-      seg->language= field->charset()->number;
-      seg->length=   keyinfo->key_part[i].length;
-      seg->start=    keyinfo->key_part[i].offset;
-      if (field->flags & BLOB_FLAG)
-      {
-	seg->type=
-	((keyinfo->key_part[i].key_type & FIELDFLAG_BINARY) ?
-	 HA_KEYTYPE_VARBINARY2 : HA_KEYTYPE_VARTEXT2);
-	seg->bit_start= (uint8)(field->pack_length() - share->blob_ptr_size);
-	seg->flag= HA_BLOB_PART;
-	seg->length=0;			// Whole blob in unique constraint
-      }
-      else
+      if (!using_unique_constraint)
       {
-	seg->type= keyinfo->key_part[i].type;
-        /* Tell handler if it can do suffic space compression */
-	if (field->real_type() == MYSQL_TYPE_STRING &&
-	    keyinfo->key_part[i].length > 4)
-	  seg->flag|= HA_SPACE_PACK;
+        /* Create a key, unique for GROUP BY and DISTINCT */
+        bzero((char*) &keydef[k],sizeof(keydef[k]));
+        keydef[k].flag= ((keyinfo->flags & HA_NOSAME) |
+                         HA_BINARY_PACK_KEY | HA_PACK_KEY);
+        keydef[k].keysegs=  keyinfo->key_parts;
+        keydef[k].seg= seg;
       }
-      if (!(field->flags & NOT_NULL_FLAG))
+      for (uint i=0; i < keyinfo->key_parts ; i++,seg++)
       {
-	seg->null_bit= field->null_bit;
-	seg->null_pos= (uint) (field->null_ptr - (uchar*) table->record[0]);
-	/*
-	  We are using a GROUP BY on something that contains NULL
-	  In this case we have to tell MyISAM that two NULL should
-	  on INSERT be regarded at the same value
-	*/
-	if (!using_unique_constraint)
-	  keydef.flag|= HA_NULL_ARE_EQUAL;
+        Field *field=keyinfo->key_part[i].field;
+        seg->flag=     0;
+        seg->language= field->charset()->number;
+        seg->length=   keyinfo->key_part[i].length;
+        seg->start=    keyinfo->key_part[i].offset;
+        if (field->flags & BLOB_FLAG)
+        {
+          seg->type=
+          ((keyinfo->key_part[i].key_type & FIELDFLAG_BINARY) ?
+           HA_KEYTYPE_VARBINARY2 : HA_KEYTYPE_VARTEXT2);
+          seg->bit_start= (uint8)(field->pack_length() - share->blob_ptr_size);
+          seg->flag= HA_BLOB_PART;
+          seg->length=0;			// Whole blob in unique constraint
+        }
+        else
+        {
+          seg->type= keyinfo->key_part[i].type;
+          /* Tell handler if it can do suffic space compression */
+          if (field->real_type() == MYSQL_TYPE_STRING &&
+              keyinfo->key_part[i].length > 4)
+            seg->flag|= HA_SPACE_PACK;
+        }
+        if (!(field->flags & NOT_NULL_FLAG))
+        {
+          seg->null_bit= field->null_bit;
+          seg->null_pos= (uint) (field->null_ptr - (uchar*) table->record[0]);
+          /*
+            We are using a GROUP BY on something that contains NULL
+            In this case we have to tell MyISAM that two NULL should
+            on INSERT be regarded at the same value
+          */
+          if (!using_unique_constraint)
+            keydef[k].flag|= HA_NULL_ARE_EQUAL;
+        }
       }
     }
   }
@@ -11227,7 +11921,7 @@ static bool create_myisam_tmp_table(TABLE *table,TMP_TABLE_PARAM *param,
   if (big_tables && !(options & SELECT_SMALL_RESULT))
     create_info.data_file_length= ~(ulonglong) 0;
 
-  if ((error=mi_create(share->table_name.str, share->keys, &keydef,
+  if ((error=mi_create(share->table_name.str, share->keys, keydef,
 		       (uint) (param->recinfo-param->start_recinfo),
 		       param->start_recinfo,
 		       share->uniques, &uniquedef,
@@ -11635,7 +12329,10 @@ sub_select_cache(JOIN *join,JOIN_TAB *join_tab,bool end_of_records)
 
   if (end_of_records)
   {
-    rc= flush_cached_records(join,join_tab,FALSE);
+    if (join_tab->cache.hash)
+      rc= flush_cached_records_hash(join, join_tab, TRUE);
+    else
+      rc= flush_cached_records(join,join_tab,FALSE);
     if (rc == NESTED_LOOP_OK || rc == NESTED_LOOP_NO_MORE_ROWS)
       rc= sub_select(join,join_tab,end_of_records);
     return rc;
@@ -11649,6 +12346,8 @@ sub_select_cache(JOIN *join,JOIN_TAB *join_tab,bool end_of_records)
   {
     if (!store_record_in_cache(&join_tab->cache))
       return NESTED_LOOP_OK;                     // There is more room in cache
+    if (join_tab->cache.hash)
+      return flush_cached_records_hash(join, join_tab, FALSE);
     return flush_cached_records(join,join_tab,FALSE);
   }
   rc= flush_cached_records(join, join_tab, TRUE);
@@ -11803,6 +12502,10 @@ sub_select(JOIN *join,JOIN_TAB *join_tab,bool end_of_records)
   }
   join->thd->warning_info->reset_current_row_for_warning();
 
+  if (join_tab->table->materialize_pending &&
+      mysql_derived_materialize(join->thd,
+                                join_tab->table->pos_in_table_list))
+    return NESTED_LOOP_ERROR;
   error= (*join_tab->read_first_record)(join_tab);
   rc= evaluate_join_record(join, join_tab, error);
 
@@ -12062,6 +12765,12 @@ flush_cached_records(JOIN *join,JOIN_TAB *join_tab,bool skip_last)
   join_tab->table->null_row= 0;
   if (!join_tab->cache.records)
     return NESTED_LOOP_OK;                      /* Nothing to do */
+  if (join_tab->table->materialize_pending &&
+      mysql_derived_materialize(join->thd,
+                                join_tab->table->pos_in_table_list))
+    return NESTED_LOOP_ERROR;
+  if (join_tab->use_bka)
+    return flush_cached_records_bka(join, join_tab);
   if (skip_last)
     (void) store_record_in_cache(&join_tab->cache); // Must save this for later
   if (join_tab->use_quick == 2)
@@ -12110,7 +12819,7 @@ flush_cached_records(JOIN *join,JOIN_TAB *join_tab,bool skip_last)
         reset_cache_read(&join_tab->cache);
         for (i=(join_tab->cache.records- (skip_last ? 1 : 0)) ; i-- > 0 ;)
         {
-          read_cached_record(join_tab);
+          read_cached_record(&join_tab->cache);
           skip_record= FALSE;
           if (select && select->skip_record(join->thd, &skip_record))
           {
@@ -12132,7 +12841,7 @@ flush_cached_records(JOIN *join,JOIN_TAB *join_tab,bool skip_last)
   } while (!(error=info->read_record(info)));
 
   if (skip_last)
-    read_cached_record(join_tab);		// Restore current record
+    read_cached_record(&join_tab->cache);		// Restore current record
   reset_cache_write(&join_tab->cache);
   if (error > 0)				// Fatal error
     return NESTED_LOOP_ERROR;                   /* purecov: inspected */
@@ -12142,34 +12851,725 @@ flush_cached_records(JOIN *join,JOIN_TAB *join_tab,bool skip_last)
 }
 
 
-/*****************************************************************************
-  The different ways to read a record
-  Returns -1 if row was not found, 0 if row was found and 1 on errors
-*****************************************************************************/
+/**
+  Join the records in the join cache with a ref table by Batched Key Access.
 
-/** Help function when we get some an error from the table handler. */
+    The ref keys of the cached records are looked up in join_tab in
+    batches of up to cache.max_ranges keys with one multi-range read.
+    The engine can then read the rows of a batch in rowid order (see
+    DsMrr_impl) instead of doing one random index lookup per record.
+    Each row found is joined with the cached record its key came from.
+*/
 
-int report_error(TABLE *table, int error)
+static enum_nested_loop_state
+flush_cached_records_bka(JOIN *join, JOIN_TAB *join_tab)
 {
-  if (error == HA_ERR_END_OF_FILE || error == HA_ERR_KEY_NOT_FOUND)
+  JOIN_CACHE *cache= &join_tab->cache;
+  TABLE *table= join_tab->table;
+  TABLE_REF *ref= &join_tab->ref;
+  COND *select_cond= join_tab->select_cond;
+  enum_nested_loop_state rc;
+  KEY_MULTI_RANGE *found_range;
+  uchar *last_pos= cache->buff;
+  uint records_left, last_record_nr= 0;
+  int error;
+
+  if (!table->file->inited &&
+      (error= table->file->ha_index_init(ref->key, FALSE)))
   {
-    table->status= STATUS_GARBAGE;
-    return -1;					// key not found; ok
+    reset_cache_write(cache);
+    (void) report_error(table, error);
+    return NESTED_LOOP_ERROR;
   }
-  /*
-    Locking reads can legally return also these errors, do not
-    print them to the .err log
-  */
-  if (error != HA_ERR_LOCK_DEADLOCK && error != HA_ERR_LOCK_WAIT_TIMEOUT && error != HA_ERR_TABLE_DEF_CHANGED
-      && !table->in_use->killed)
-    sql_print_error("Got error %d when reading table '%s'",
-		    error, table->s->path.str);
-  table->file->print_error(error,MYF(0));
-  return 1;
-}
 
-
-int safe_index_read(JOIN_TAB *tab)
+  for (JOIN_TAB *tmp=join->join_tab; tmp != join_tab ; tmp++)
+  {
+    tmp->status=tmp->table->status;
+    tmp->table->status=0;
+  }
+
+  reset_cache_read(cache);
+  records_left= cache->records;
+  while (records_left)
+  {
+    uint count= 0;
+    uchar *key= cache->range_keys;
+
+    /* Build the ranges for the next batch of cached records */
+    for (; records_left && count < cache->max_ranges; records_left--)
+    {
+      KEY_MULTI_RANGE *range= cache->ranges + count;
+      bool null_key= FALSE;
+      last_pos= cache->pos;
+      last_record_nr= cache->record_nr;
+      read_cached_record(cache);
+
+      /* Perform "Late NULLs Filtering", as join_read_always_key() does */
+      for (uint i= 0 ; i < ref->key_parts ; i++)
+      {
+        if ((ref->null_rejecting & ((key_part_map)1 << i)) &&
+            ref->items[i]->is_null())
+          null_key= TRUE;
+      }
+      if (null_key || cp_buffer_from_ref(join->thd, table, ref))
+        continue;
+
+      memcpy(key, ref->key_buff, ref->key_length);
+      range->start_key.key= key;
+      range->start_key.length= ref->key_length;
+      range->start_key.keypart_map= make_prev_keypart_map(ref->key_parts);
+      range->start_key.flag= HA_READ_KEY_EXACT;
+      range->end_key= range->start_key;
+      range->end_key.flag= HA_READ_AFTER_KEY;
+      range->range_flag= EQ_RANGE;
+      range->ptr= (char*) last_pos;
+      cache->range_record_nr[count++]= last_record_nr;
+      key+= ref->key_length;
+    }
+    if (!count)
+      continue;
+
+    for (error= table->file->read_multi_range_first(&found_range,
+                                                    cache->ranges, count,
+                                                    FALSE, cache->mrr_buff);
+         !error;
+         error= table->file->read_multi_range_next(&found_range))
+    {
+      if (join->thd->killed)
+      {
+        join->thd->send_kill_message();
+        reset_cache_write(cache);
+        return NESTED_LOOP_KILLED;
+      }
+      table->status= 0;
+      table->null_row= 0;
+
+      /* Restore the cached record that the row was found for */
+      cache->pos= (uchar*) found_range->ptr;
+      cache->record_nr= cache->range_record_nr[found_range - cache->ranges];
+      read_cached_record(cache);
+
+      bool skip_record= select_cond && !select_cond->val_int();
+      if (join->thd->is_error())
+      {
+        reset_cache_write(cache);
+        return NESTED_LOOP_ERROR;
+      }
+      if (!skip_record)
+      {
+        rc= (join_tab->next_select)(join,join_tab+1,0);
+        if (rc != NESTED_LOOP_OK && rc != NESTED_LOOP_NO_MORE_ROWS)
+        {
+          reset_cache_write(cache);
+          return rc;
+        }
+      }
+    }
+    if (error != HA_ERR_END_OF_FILE)
+    {
+      reset_cache_write(cache);
+      (void) report_error(table, error);
+      return NESTED_LOOP_ERROR;
+    }
+  }
+
+  /* Leave the last cached record, the current one, in the record buffers */
+  cache->pos= last_pos;
+  cache->record_nr= last_record_nr;
+  read_cached_record(cache);
+  reset_cache_write(cache);
+  for (JOIN_TAB *tmp2=join->join_tab; tmp2 != join_tab ; tmp2++)
+    tmp2->table->status=tmp2->status;
+  return NESTED_LOOP_OK;
+}
+
+
+/*****************************************************************************
+  Hash join of the join cache with a table scan, see JOIN_HASH
+*****************************************************************************/
+
+#define JOIN_HASH_MIN_PARTITIONS 4
+#define JOIN_HASH_MAX_PARTITIONS 32
+#define JOIN_HASH_FILE_BUFFER    (IO_SIZE*4)  /* buffer of a partition file */
+
+/**
+  Compute the hash value of the key of a hash join.
+
+  @param hash        hash join
+  @param items       the key parts, hash->outer_items or hash->inner_items
+  @param hash_value  [out] the hash value
+
+  @retval TRUE   a key part is NULL, the equalities can't be true
+  @retval FALSE  ok
+*/
+
+static bool join_hash_key(JOIN_HASH *hash, Item **items, uint32 *hash_value)
+{
+  ulong nr1= 1, nr2= 4;
+  uchar buff[8];
+
+  for (uint i= 0; i < hash->key_parts; i++)
+  {
+    Item *item= items[i];
+    switch (hash->cmp_types[i]) {
+    case INT_RESULT:
+    {
+      longlong nr= item->val_int();
+      if (item->null_value)
+        return TRUE;
+      int8store(buff, nr);
+      my_charset_bin.coll->hash_sort(&my_charset_bin, buff, 8, &nr1, &nr2);
+      break;
+    }
+    case DECIMAL_RESULT:
+    {
+      /* Equal decimal values have equal double values */
+      double nr= item->val_real();
+      if (item->null_value)
+        return TRUE;
+      if (nr == 0.0)
+        nr= 0.0;                                // Same hash for -0.0
+      float8store(buff, nr);
+      my_charset_bin.coll->hash_sort(&my_charset_bin, buff, 8, &nr1, &nr2);
+      break;
+    }
+    default:
+    {
+      CHARSET_INFO *cs= hash->collations[i];
+      char str_buff[MAX_FIELD_WIDTH];
+      String tmp(str_buff, sizeof(str_buff), cs), *str;
+      if (!(str= item->val_str(&tmp)))
+        return TRUE;
+      /* The hash function of the collation matches its comparison */
+      cs->coll->hash_sort(cs, (uchar*) str->ptr(), str->length(), &nr1, &nr2);
+      break;
+    }
+    }
+  }
+  *hash_value= (uint32) nr1;
+  return FALSE;
+}
+
+
+static inline uint join_hash_bucket(JOIN_HASH *hash, uint32 hash_value)
+{
+  /* The partition of a record is given by hash_value % partitions */
+  return (hash_value / hash->partitions) & (hash->bucket_count - 1);
+}
+
+
+/**
+  Allocate bucket_count buckets and link the entries into them.
+*/
+
+static bool join_hash_resize(JOIN_HASH *hash, uint bucket_count)
+{
+  my_free(hash->buckets);
+  if (!(hash->buckets= (uint*) my_malloc(bucket_count * sizeof(uint),
+                                         MYF(MY_WME))))
+  {
+    hash->bucket_count= 0;
+    return TRUE;
+  }
+  hash->bucket_count= bucket_count;
+  bzero(hash->buckets, bucket_count * sizeof(uint));
+  for (uint i= 0; i < hash->entry_count; i++)
+  {
+    uint *bucket= hash->buckets + join_hash_bucket(hash,
+                                                   hash->entries[i].hash_value);
+    hash->entries[i].next= *bucket;
+    *bucket= i + 1;
+  }
+  return FALSE;
+}
+
+
+/**
+  Empty the hash table, making room for the given number of records.
+*/
+
+static bool join_hash_reset(JOIN_HASH *hash, uint records)
+{
+  hash->entry_count= 0;
+  if (records > hash->bucket_count || !hash->buckets)
+  {
+    uint bucket_count= 16;
+    while (bucket_count < records)
+      bucket_count*= 2;
+    return join_hash_resize(hash, bucket_count);
+  }
+  bzero(hash->buckets, hash->bucket_count * sizeof(uint));
+  return FALSE;
+}
+
+
+static bool join_hash_insert(JOIN_HASH *hash, uchar *pos, uint record_nr,
+                             uint32 hash_value)
+{
+  JOIN_HASH_ENTRY *entry;
+  uint *bucket;
+
+  if (hash->entry_count == hash->max_entries)
+  {
+    uint max_entries= max(hash->max_entries * 2, 256);
+    if (!(entry= (JOIN_HASH_ENTRY*)
+          my_realloc(hash->entries, max_entries * sizeof(JOIN_HASH_ENTRY),
+                     MYF(MY_WME | MY_ALLOW_ZERO_PTR))))
+      return TRUE;
+    hash->entries= entry;
+    hash->max_entries= max_entries;
+  }
+  entry= hash->entries + hash->entry_count++;
+  entry->pos= pos;
+  entry->record_nr= record_nr;
+  entry->hash_value= hash_value;
+  bucket= hash->buckets + join_hash_bucket(hash, hash_value);
+  entry->next= *bucket;
+  *bucket= hash->entry_count;
+  /* Keep the buckets short if the number of records was not known */
+  if (hash->entry_count > hash->bucket_count * 2)
+    return join_hash_resize(hash, hash->bucket_count * 4);
+  return FALSE;
+}
+
+
+/**
+  Join the build records with a given hash value with the current row.
+
+  @param join        the join
+  @param join_tab    the table joined by hash join
+  @param build       the join cache the build records are read with
+  @param probe       if not NULL, the probe record to restore before
+                     the first build record with the hash value
+  @param hash_value  hash value of the probe record
+
+    The condition of join_tab is checked for each pair, as different
+    keys can have the same hash value.
+*/
+
+static enum_nested_loop_state
+join_hash_probe(JOIN *join, JOIN_TAB *join_tab, JOIN_CACHE *build,
+                JOIN_CACHE *probe, uint32 hash_value)
+{
+  JOIN_HASH *hash= join_tab->cache.hash;
+  SQL_SELECT *select= join_tab->select;
+  uint nr= hash->buckets[join_hash_bucket(hash, hash_value)];
+  enum_nested_loop_state rc;
+
+  while (nr)
+  {
+    JOIN_HASH_ENTRY *entry= hash->entries + nr - 1;
+    bool skip_record= FALSE;
+    nr= entry->next;
+    if (entry->hash_value != hash_value)
+      continue;
+    if (probe)
+    {
+      read_cached_record(probe);
+      probe= 0;
+    }
+    build->pos= entry->pos;
+    build->record_nr= entry->record_nr;
+    read_cached_record(build);
+    if (select && select->skip_record(join->thd, &skip_record))
+      return NESTED_LOOP_ERROR;
+    if (!skip_record)
+    {
+      rc= (join_tab->next_select)(join,join_tab+1,0);
+      if (rc != NESTED_LOOP_OK && rc != NESTED_LOOP_NO_MORE_ROWS)
+        return rc;
+    }
+  }
+  return NESTED_LOOP_OK;
+}
+
+
+/**
+  Join the records in the join buffer with the table by hash join.
+
+    A hash table is built over the cached records, and the table is read
+    once. Each row that passes the part of the condition that only
+    depends on the table is joined with the records in its bucket.
+*/
+
+static enum_nested_loop_state
+join_hash_in_memory(JOIN *join, JOIN_TAB *join_tab)
+{
+  JOIN_CACHE *cache= &join_tab->cache;
+  JOIN_HASH *hash= cache->hash;
+  READ_RECORD *info= &join_tab->read_record;
+  enum_nested_loop_state rc= NESTED_LOOP_OK;
+  uchar *last_pos= cache->buff;
+  uint last_record_nr= 0;
+  uint32 hash_value;
+  int error;
+
+  if (join_hash_reset(hash, cache->records))
+  {
+    reset_cache_write(cache);
+    return NESTED_LOOP_ERROR;
+  }
+  reset_cache_read(cache);
+  for (uint i= cache->records ; i-- > 0 ;)
+  {
+    last_pos= cache->pos;
+    last_record_nr= cache->record_nr;
+    read_cached_record(cache);
+    if (!join_hash_key(hash, hash->outer_items, &hash_value) &&
+        join_hash_insert(hash, last_pos, last_record_nr, hash_value))
+    {
+      reset_cache_write(cache);
+      return NESTED_LOOP_ERROR;
+    }
+  }
+  if (join->thd->is_error() || !hash->entry_count)
+  {
+    reset_cache_write(cache);
+    return join->thd->is_error() ? NESTED_LOOP_ERROR : NESTED_LOOP_OK;
+  }
+
+  if ((error=join_init_read_record(join_tab)))
+  {
+    reset_cache_write(cache);
+    return error < 0 ? NESTED_LOOP_NO_MORE_ROWS: NESTED_LOOP_ERROR;
+  }
+
+  for (JOIN_TAB *tmp=join->join_tab; tmp != join_tab ; tmp++)
+  {
+    tmp->status=tmp->table->status;
+    tmp->table->status=0;
+  }
+
+  do
+  {
+    bool skip_record= FALSE;
+    if (join->thd->killed)
+    {
+      join->thd->send_kill_message();
+      reset_cache_write(cache);
+      return NESTED_LOOP_KILLED;
+    }
+    if (cache->select &&
+        cache->select->skip_record(join->thd, &skip_record))
+    {
+      reset_cache_write(cache);
+      return NESTED_LOOP_ERROR;
+    }
+    if (skip_record || join_hash_key(hash, hash->inner_items, &hash_value))
+      continue;
+    rc= join_hash_probe(join, join_tab, cache, NULL, hash_value);
+    if (rc != NESTED_LOOP_OK)
+    {
+      reset_cache_write(cache);
+      return rc;
+    }
+  } while (!(error=info->read_record(info)));
+
+  /* Leave the last cached record, the current one, in the record buffers */
+  cache->pos= last_pos;
+  cache->record_nr= last_record_nr;
+  read_cached_record(cache);
+  reset_cache_write(cache);
+  if (error > 0 || join->thd->is_error())	// Fatal error
+    return NESTED_LOOP_ERROR;
+  for (JOIN_TAB *tmp2=join->join_tab; tmp2 != join_tab ; tmp2++)
+    tmp2->table->status=tmp2->status;
+  return NESTED_LOOP_OK;
+}
+
+
+static bool write_join_hash_record(IO_CACHE *file, uint32 hash_value,
+                                   uchar *record, uint length)
+{
+  uchar header[8];
+  int4store(header, length);
+  int4store(header + 4, hash_value);
+  return (my_b_write(file, header, sizeof(header)) ||
+          my_b_write(file, record, length));
+}
+
+
+static bool read_join_hash_record(IO_CACHE *file, uint32 *hash_value,
+                                  uchar *record, uint *length)
+{
+  uchar header[8];
+  if (my_b_read(file, header, sizeof(header)))
+    return TRUE;
+  *length= uint4korr(header);
+  *hash_value= uint4korr(header + 4);
+  return my_b_read(file, record, *length) != 0;
+}
+
+
+/**
+  Write the records in the join buffer to the partition files.
+*/
+
+static bool join_hash_spill_cache(JOIN *join, JOIN_TAB *join_tab)
+{
+  JOIN_CACHE *cache= &join_tab->cache;
+  JOIN_HASH *hash= cache->hash;
+  uint32 hash_value;
+
+  if (!hash->spilled)
+  {
+    for (uint i= 0; i < hash->partitions * 2; i++)
+    {
+      IO_CACHE *file= hash->outer_files + i;
+      if (!my_b_inited(file) &&
+          open_cached_file(file, mysql_tmpdir, TEMP_PREFIX,
+                           JOIN_HASH_FILE_BUFFER, MYF(MY_WME)))
+        return TRUE;
+    }
+    hash->spilled= TRUE;
+  }
+
+  reset_cache_read(cache);
+  for (uint i= cache->records ; i-- > 0 ;)
+  {
+    uchar *pos= cache->pos;
+    read_cached_record(cache);
+    if (!join_hash_key(hash, hash->outer_items, &hash_value) &&
+        write_join_hash_record(hash->outer_files +
+                               hash_value % hash->partitions,
+                               hash_value, pos, (uint) (cache->pos - pos)))
+      return TRUE;
+  }
+  return join->thd->is_error();
+}
+
+
+/**
+  Write the rows of the table to the partition files.
+*/
+
+static enum_nested_loop_state
+join_hash_spill_table(JOIN *join, JOIN_TAB *join_tab)
+{
+  JOIN_HASH *hash= join_tab->cache.hash;
+  JOIN_CACHE *inner_cache= &hash->inner_cache;
+  SQL_SELECT *select= join_tab->cache.select;
+  READ_RECORD *info= &join_tab->read_record;
+  uint32 hash_value;
+  int error;
+
+  if ((error=join_init_read_record(join_tab)))
+    return error < 0 ? NESTED_LOOP_NO_MORE_ROWS: NESTED_LOOP_ERROR;
+
+  do
+  {
+    bool skip_record= FALSE;
+    if (join->thd->killed)
+    {
+      join->thd->send_kill_message();
+      return NESTED_LOOP_KILLED;
+    }
+    if (select && select->skip_record(join->thd, &skip_record))
+      return NESTED_LOOP_ERROR;
+    if (skip_record || join_hash_key(hash, hash->inner_items, &hash_value))
+      continue;
+    reset_cache_write(inner_cache);
+    (void) store_record_in_cache(inner_cache);
+    if (write_join_hash_record(hash->inner_files +
+                               hash_value % hash->partitions,
+                               hash_value, inner_cache->buff,
+                               (uint) (inner_cache->pos - inner_cache->buff)))
+      return NESTED_LOOP_ERROR;
+  } while (!(error=info->read_record(info)));
+  if (error > 0 || join->thd->is_error())
+    return NESTED_LOOP_ERROR;
+  return NESTED_LOOP_OK;
+}
+
+
+/**
+  Join the partitions of the cached records and of the table pairwise.
+
+    The hash table is built from the smaller partition of a pair, as
+    many of its records at a time as fit in the join buffer, and the
+    other partition is read once for each of these.
+*/
+
+static enum_nested_loop_state
+join_hash_partitions(JOIN *join, JOIN_TAB *join_tab)
+{
+  JOIN_CACHE *cache= &join_tab->cache;
+  JOIN_HASH *hash= cache->hash;
+  enum_nested_loop_state rc;
+  uint32 hash_value;
+  uint length;
+
+  for (JOIN_TAB *tmp=join->join_tab; tmp != join_tab ; tmp++)
+  {
+    tmp->status=tmp->table->status;
+    tmp->table->status=0;
+  }
+
+  for (uint i= 0; i < hash->partitions; i++)
+  {
+    IO_CACHE *outer_file= hash->outer_files + i;
+    IO_CACHE *inner_file= hash->inner_files + i;
+    my_off_t outer_length= my_b_tell(outer_file);
+    my_off_t inner_length= my_b_tell(inner_file);
+    if (!outer_length || !inner_length)
+      continue;
+
+    bool build_outer= outer_length <= inner_length;
+    IO_CACHE *build_file= build_outer ? outer_file : inner_file;
+    IO_CACHE *probe_file= build_outer ? inner_file : outer_file;
+    my_off_t build_length= build_outer ? outer_length : inner_length;
+    my_off_t probe_length= build_outer ? inner_length : outer_length;
+    JOIN_CACHE *build= build_outer ? cache : &hash->inner_cache;
+    JOIN_CACHE *probe= build_outer ? &hash->inner_cache : cache;
+
+    if (reinit_io_cache(build_file, READ_CACHE, 0L, 0, 0))
+      return NESTED_LOOP_ERROR;
+    while (my_b_tell(build_file) < build_length)
+    {
+      /* Load as many build records as fit in the join buffer */
+      uchar *pos= cache->buff;
+      if (join_hash_reset(hash, 0))
+        return NESTED_LOOP_ERROR;
+      while (my_b_tell(build_file) < build_length &&
+             (size_t) (cache->end - pos) >= build->length)
+      {
+        if (read_join_hash_record(build_file, &hash_value, pos, &length) ||
+            join_hash_insert(hash, pos, 0, hash_value))
+          return NESTED_LOOP_ERROR;
+        pos+= length;
+      }
+
+      if (reinit_io_cache(probe_file, READ_CACHE, 0L, 0, 0))
+        return NESTED_LOOP_ERROR;
+      while (my_b_tell(probe_file) < probe_length)
+      {
+        if (join->thd->killed)
+        {
+          join->thd->send_kill_message();
+          return NESTED_LOOP_KILLED;
+        }
+        if (read_join_hash_record(probe_file, &hash_value,
+                                  hash->record_buff, &length))
+          return NESTED_LOOP_ERROR;
+        probe->pos= hash->record_buff;
+        probe->record_nr= 0;
+        rc= join_hash_probe(join, join_tab, build, probe, hash_value);
+        if (rc != NESTED_LOOP_OK)
+          return rc;
+      }
+    }
+  }
+
+  for (JOIN_TAB *tmp2=join->join_tab; tmp2 != join_tab ; tmp2++)
+    tmp2->table->status=tmp2->status;
+  return NESTED_LOOP_OK;
+}
+
+
+/**
+  Empty the partition files for the next join.
+*/
+
+static bool join_hash_end_spill(JOIN_HASH *hash)
+{
+  bool error= FALSE;
+  for (uint i= 0; i < hash->partitions * 2; i++)
+  {
+    if (my_b_inited(hash->outer_files + i) &&
+        reinit_io_cache(hash->outer_files + i, WRITE_CACHE, 0L, 0, 0))
+      error= TRUE;
+  }
+  hash->spilled= FALSE;
+  return error;
+}
+
+
+/**
+  Join the records in the join cache with the table by hash join.
+
+  @param join        the join
+  @param join_tab    the table joined by hash join
+  @param last_flush  TRUE if all records of the previous tables have
+                     been cached, FALSE if the join buffer is full
+
+    As long as all records fit in the join buffer, they are joined with
+    the table in memory (see join_hash_in_memory()). When the buffer
+    gets full, they are written to the partition files instead. After
+    the last record the rows of the table are written to partition files
+    too, and the partitions are joined (see join_hash_partitions()).
+
+    If records or rows can't be written to files (e.g. they have blobs)
+    the table is read each time the join buffer is full, like for a
+    join cache without hash join.
+*/
+
+static enum_nested_loop_state
+flush_cached_records_hash(JOIN *join, JOIN_TAB *join_tab, bool last_flush)
+{
+  JOIN_CACHE *cache= &join_tab->cache;
+  JOIN_HASH *hash= cache->hash;
+  enum_nested_loop_state rc;
+
+  join_tab->table->null_row= 0;
+  if ((cache->records || hash->spilled) &&
+      join_tab->table->materialize_pending &&
+      mysql_derived_materialize(join->thd,
+                                join_tab->table->pos_in_table_list))
+    return NESTED_LOOP_ERROR;
+  if (!hash->spilled && (last_flush || !hash->can_spill))
+  {
+    if (!cache->records)
+      return NESTED_LOOP_OK;                    /* Nothing to do */
+    return join_hash_in_memory(join, join_tab);
+  }
+
+  if (cache->records && join_hash_spill_cache(join, join_tab))
+  {
+    reset_cache_write(cache);
+    (void) join_hash_end_spill(hash);
+    return NESTED_LOOP_ERROR;
+  }
+  reset_cache_write(cache);
+  if (!last_flush)
+    return NESTED_LOOP_OK;
+
+  rc= join_hash_spill_table(join, join_tab);
+  if (rc == NESTED_LOOP_OK)
+    rc= join_hash_partitions(join, join_tab);
+  if (join_hash_end_spill(hash) && rc == NESTED_LOOP_OK)
+    rc= NESTED_LOOP_ERROR;
+  return rc;
+}
+
+
+/*****************************************************************************
+  The different ways to read a record
+  Returns -1 if row was not found, 0 if row was found and 1 on errors
+*****************************************************************************/
+
+/** Help function when we get some an error from the table handler. */
+
+int report_error(TABLE *table, int error)
+{
+  if (error == HA_ERR_END_OF_FILE || error == HA_ERR_KEY_NOT_FOUND)
+  {
+    table->status= STATUS_GARBAGE;
+    return -1;					// key not found; ok
+  }
+  /*
+    Locking reads can legally return also these errors, do not
+    print them to the .err log
+  */
+  if (error != HA_ERR_LOCK_DEADLOCK && error != HA_ERR_LOCK_WAIT_TIMEOUT && error != HA_ERR_TABLE_DEF_CHANGED
+      && !table->in_use->killed)
+    sql_print_error("Got error %d when reading table '%s'",
+		    error, table->s->path.str);
+  table->file->print_error(error,MYF(0));
+  return 1;
+}
+
+
+int safe_index_read(JOIN_TAB *tab)
 {
   int error;
   TABLE *table= tab->table;
@@ -13976,6 +15376,8 @@ test_if_skip_sort_order(JOIN_TAB *tab,ORDER *order,ha_rows select_limit,
               0)
             goto use_filesort;
 	}
+        /* The index condition was pushed for the old index */
+        cancel_index_cond_push(tab);
         ref_key= new_ref_key;
       }
     }
@@ -14076,6 +15478,14 @@ check_reverse_order:
   */
   if (!no_changes) // We are allowed to update QEP
   {
+    /*
+      The pushed index condition is only valid for the index and scan
+      direction it was pushed for: a backward scan would not stop at
+      the end of the range.
+    */
+    if (best_key >= 0 || order_direction == -1)
+      cancel_index_cond_push(tab);
+
     if (best_key >= 0)
     {
       bool quick_created= 
@@ -14233,6 +15643,9 @@ create_sort_index(THD *thd, JOIN *join, ORDER *order,
   table=  tab->table;
   select= tab->select;
   tab->saved_select= NULL;
+  if (table->materialize_pending &&
+      mysql_derived_materialize(thd, table->pos_in_table_list))
+    DBUG_RETURN(-1);
   /* 
     If we have a select->quick object that is created outside of
     create_sort_index() and this is part of a subquery that
@@ -14561,7 +15974,9 @@ err:
   Generate a hash index for each row to quickly find duplicate rows.
 
   @note
-    Note that this will not work on tables with blobs!
+    BLOB columns are compared by their first max_sort_length bytes, so
+    this is only used for tables with blobs when they are HEAP tables,
+    which can't restart a scan for remove_dup_with_compare().
 */
 
 static int remove_dup_with_hash_index(THD *thd, TABLE *table,
@@ -14578,6 +15993,22 @@ static int remove_dup_with_hash_index(THD *thd, TABLE *table,
   HASH hash;
   DBUG_ENTER("remove_dup_with_hash_index");
 
+  {
+    /*
+      HEAP tables may have BLOB columns, whose sort key is longer than
+      their part of the record: size the key buffer by the sort keys.
+    */
+    Field **ptr;
+    ulong total_length= 0;
+    for (ptr= first_field ; *ptr ; ptr++)
+      total_length+= (*ptr)->sort_length();
+    DBUG_PRINT("info",("field_count: %u  key_length: %lu  total_length: %lu",
+                       field_count, key_length, total_length));
+    DBUG_ASSERT(total_length <= key_length || table->s->blob_fields);
+    key_length= total_length;
+    extra_length= ALIGN_SIZE(key_length)-key_length;
+  }
+
   if (!my_multi_malloc(MYF(MY_WME),
 		       &key_buffer,
 		       (uint) ((key_length + extra_length) *
@@ -14587,21 +16018,9 @@ static int remove_dup_with_hash_index(THD *thd, TABLE *table,
 		       NullS))
     DBUG_RETURN(1);
 
-  {
-    Field **ptr;
-    ulong total_length= 0;
-    for (ptr= first_field, field_length=field_lengths ; *ptr ; ptr++)
-    {
-      uint length= (*ptr)->sort_length();
-      (*field_length++)= length;
-      total_length+= length;
-    }
-    DBUG_PRINT("info",("field_count: %u  key_length: %lu  total_length: %lu",
-                       field_count, key_length, total_length));
-    DBUG_ASSERT(total_length <= key_length);
-    key_length= total_length;
-    extra_length= ALIGN_SIZE(key_length)-key_length;
-  }
+  field_length= field_lengths;
+  for (Field **ptr= first_field ; *ptr ; ptr++)
+    (*field_length++)= (*ptr)->sort_length();
 
   if (my_hash_init(&hash, &my_charset_bin, (uint) file->stats.records, 0, 
                    key_length, (my_hash_get_key) 0, 0, 0))
@@ -14724,15 +16143,47 @@ SORT_FIELD *make_unireg_sortorder(ORDER *order, uint *length,
 static int
 join_init_cache(THD *thd,JOIN_TAB *tables,uint table_count)
 {
-  reg1 uint i;
-  uint length, blobs;
   size_t size;
-  CACHE_FIELD *copy,**blob_ptr;
   JOIN_CACHE  *cache;
-  JOIN_TAB *join_tab;
   DBUG_ENTER("join_init_cache");
 
   cache= &tables[table_count].cache;
+  if (join_init_cache_fields(thd, cache, tables, table_count))
+  {
+    my_free(cache->buff);		/* purecov: inspected */
+    cache->buff=0;				/* purecov: inspected */
+    DBUG_RETURN(1);				/* purecov: inspected */
+  }
+  size=max(thd->variables.join_buff_size, cache->length);
+  if (!(cache->buff=(uchar*) my_malloc(size,MYF(0))))
+    DBUG_RETURN(1);				/* Don't use cache */ /* purecov: inspected */
+  cache->end=cache->buff+size;
+  reset_cache_write(cache);
+  DBUG_RETURN(0);
+}
+
+
+/**
+  Set up the fields of the records of a join cache.
+
+  @param thd          thread handle
+  @param cache        the join cache
+  @param tables       the tables whose used fields are cached
+  @param table_count  number of tables
+
+  @retval 0  ok
+  @retval 1  out of memory
+*/
+
+static int
+join_init_cache_fields(THD *thd, JOIN_CACHE *cache, JOIN_TAB *tables,
+                       uint table_count)
+{
+  reg1 uint i;
+  uint length, blobs;
+  CACHE_FIELD *copy,**blob_ptr;
+  JOIN_TAB *join_tab;
+
   cache->fields=blobs=0;
 
   join_tab=tables;
@@ -14747,11 +16198,7 @@ join_init_cache(THD *thd,JOIN_TAB *tables,uint table_count)
 	sql_alloc(sizeof(CACHE_FIELD)*(cache->fields+table_count*2)+(blobs+1)*
 
 		  sizeof(CACHE_FIELD*))))
-  {
-    my_free(cache->buff);		/* purecov: inspected */
-    cache->buff=0;				/* purecov: inspected */
-    DBUG_RETURN(1);				/* purecov: inspected */
-  }
+    return 1;
   copy=cache->field;
   blob_ptr=cache->blob_ptr=(CACHE_FIELD**)
     (cache->field+cache->fields+table_count*2);
@@ -14809,15 +16256,228 @@ join_init_cache(THD *thd,JOIN_TAB *tables,uint table_count)
   cache->length=length+blobs*sizeof(char*);
   cache->blobs=blobs;
   *blob_ptr=0;					/* End sequentel */
-  size=max(thd->variables.join_buff_size, cache->length);
-  if (!(cache->buff=(uchar*) my_malloc(size,MYF(0))))
-    DBUG_RETURN(1);				/* Don't use cache */ /* purecov: inspected */
-  cache->end=cache->buff+size;
-  reset_cache_write(cache);
+  return 0;
+}
+
+
+/**
+  Allocate the arrays for joining the join cache of a ref table by
+  Batched Key Access.
+
+    The records are looked up in batches of multi_range_count keys. If
+    the engine can read the rows of a batch in rowid order, a rowid
+    buffer of up to read_rnd_buffer_size bytes is allocated for it.
+
+  @retval 0  ok
+  @retval 1  out of memory
+*/
+
+static int
+join_init_bka_cache(THD *thd, JOIN_TAB *tab)
+{
+  JOIN_CACHE *cache= &tab->cache;
+  uint key_length= tab->ref.key_length;
+  uint max_ranges= (uint) max(thd->variables.multi_range_count, 1UL);
+  uint mrr_bufsz= (uint) thd->variables.read_rnd_buff_size;
+  ha_rows mrr_buf_rows;
+  HANDLER_BUFFER *mrr_buff;
+  uchar *mrr_area;
+  DBUG_ENTER("join_init_bka_cache");
+
+  if (tab->table->file->multi_range_read_info(tab->ref.key, max_ranges,
+                                              &mrr_bufsz, &mrr_buf_rows))
+    mrr_bufsz= 0;                               // No rowid ordered reads
+  if (!my_multi_malloc(MYF(0),
+                       &cache->ranges, max_ranges * sizeof(KEY_MULTI_RANGE),
+                       &cache->range_record_nr, max_ranges * sizeof(uint),
+                       &cache->range_keys, max_ranges * key_length,
+                       &mrr_buff, sizeof(HANDLER_BUFFER),
+                       &mrr_area, mrr_bufsz,
+                       NullS))
+  {
+    cache->ranges= 0;
+    DBUG_RETURN(1);
+  }
+  cache->max_ranges= max_ranges;
+  cache->mrr_buff= 0;
+  if (mrr_bufsz)
+  {
+    mrr_buff->buffer= mrr_area;
+    mrr_buff->buffer_end= mrr_area + mrr_bufsz;
+    mrr_buff->end_of_used_area= mrr_area;
+    cache->mrr_buff= mrr_buff;
+  }
   DBUG_RETURN(0);
 }
 
 
+/**
+  Check if an equality can be a key part of a hash join, i.e. if equal
+  values of its arguments always get equal hash values.
+*/
+
+static bool hash_join_key_type(Item *a, Item *b, Item_result *cmp_type)
+{
+  /* Temporal values can be compared as dates, see Arg_comparator */
+  if (a->is_datetime() || b->is_datetime() ||
+      a->field_type() == MYSQL_TYPE_TIME || b->field_type() == MYSQL_TYPE_TIME ||
+      a->field_type() == MYSQL_TYPE_YEAR || b->field_type() == MYSQL_TYPE_YEAR)
+    return FALSE;
+  *cmp_type= item_cmp_type(a->result_type(), b->result_type());
+  return (*cmp_type == INT_RESULT || *cmp_type == DECIMAL_RESULT ||
+          (*cmp_type == STRING_RESULT &&
+           a->result_type() == STRING_RESULT &&
+           b->result_type() == STRING_RESULT));
+}
+
+
+/**
+  Find the key of a hash join of a table with the join cache.
+
+    The key parts are the top level equalities of the table condition
+    between an expression over the table and an expression over the
+    preceding tables. Equalities that are compared as REAL or as dates
+    are not used, as equal values may get different hash values.
+
+  @param join  the join
+  @param tab   the table that is joined through the join cache
+
+  @return the hash join, allocated in the statement memory, or NULL
+    if there are no equalities to use
+*/
+
+static JOIN_HASH *make_join_hash(JOIN *join, JOIN_TAB *tab)
+{
+  THD *thd= join->thd;
+  Item *outer_items[MAX_REF_PARTS], *inner_items[MAX_REF_PARTS];
+  Item_result cmp_types[MAX_REF_PARTS];
+  CHARSET_INFO *collations[MAX_REF_PARTS];
+  table_map prefix_tables= 0;
+  uint key_parts= 0;
+  List<Item> conds;
+  Item *cond;
+  JOIN_HASH *hash;
+  DBUG_ENTER("make_join_hash");
+
+  if (!tab->select_cond)
+    DBUG_RETURN(0);
+  for (JOIN_TAB *prev= join->join_tab; prev != tab; prev++)
+    prefix_tables|= prev->table->map;
+  if (tab->select_cond->type() == Item::COND_ITEM &&
+      ((Item_cond*) tab->select_cond)->functype() == Item_func::COND_AND_FUNC)
+    conds= *((Item_cond*) tab->select_cond)->argument_list();
+  else if (conds.push_back(tab->select_cond))
+    DBUG_RETURN(0);
+
+  List_iterator_fast<Item> it(conds);
+  while ((cond= it++) && key_parts < MAX_REF_PARTS)
+  {
+    if (cond->type() != Item::FUNC_ITEM ||
+        ((Item_func*) cond)->functype() != Item_func::EQ_FUNC)
+      continue;
+    Item_func_eq *eq= (Item_func_eq*) cond;
+    Item **args= eq->arguments();
+    for (uint i= 0; i < 2; i++)
+    {
+      Item *inner= args[i], *outer= args[1 - i];
+      table_map outer_tables= outer->used_tables();
+      if (inner->used_tables() != tab->table->map ||
+          !outer_tables || (outer_tables & ~prefix_tables) ||
+          !hash_join_key_type(inner, outer, cmp_types + key_parts))
+        continue;
+      outer_items[key_parts]= outer;
+      inner_items[key_parts]= inner;
+      collations[key_parts]= eq->compare_collation();
+      key_parts++;
+      break;
+    }
+  }
+  if (!key_parts)
+    DBUG_RETURN(0);
+
+  if (!(hash= (JOIN_HASH*) thd->calloc(sizeof(JOIN_HASH))) ||
+      !(hash->outer_items= (Item**) thd->memdup(outer_items,
+                                                key_parts * sizeof(Item*))) ||
+      !(hash->inner_items= (Item**) thd->memdup(inner_items,
+                                                key_parts * sizeof(Item*))) ||
+      !(hash->cmp_types= (Item_result*)
+        thd->memdup(cmp_types, key_parts * sizeof(Item_result))) ||
+      !(hash->collations= (CHARSET_INFO**)
+        thd->memdup(collations, key_parts * sizeof(CHARSET_INFO*))))
+    DBUG_RETURN(0);
+  hash->key_parts= key_parts;
+  hash->partitions= 1;
+  DBUG_RETURN(hash);
+}
+
+
+/**
+  Set up the partition files of a hash join.
+
+    The records can only be written to files if neither the cached
+    records nor the rows of the table have blobs. The number of
+    partitions is chosen from the estimated size of the table.
+
+  @retval 0  ok
+  @retval 1  out of memory
+*/
+
+static int
+join_init_hash_cache(THD *thd, JOIN_TAB *tab)
+{
+  JOIN_CACHE *cache= &tab->cache;
+  JOIN_HASH *hash= cache->hash;
+  JOIN_CACHE *inner_cache= &hash->inner_cache;
+  size_t buff_size= (size_t) (cache->end - cache->buff);
+  uint record_length;
+  double partitions;
+  DBUG_ENTER("join_init_hash_cache");
+
+  if (join_init_cache_fields(thd, inner_cache, tab, 1))
+    DBUG_RETURN(1);
+  hash->can_spill= (!cache->blobs && !inner_cache->blobs &&
+                    inner_cache->length <= buff_size);
+  if (!hash->can_spill)
+    DBUG_RETURN(0);
+
+  record_length= max(cache->length, inner_cache->length);
+  if (!(hash->record_buff= (uchar*) my_malloc(record_length, MYF(0))))
+    DBUG_RETURN(1);
+  inner_cache->buff= hash->record_buff;
+  inner_cache->end= hash->record_buff + record_length;
+  reset_cache_write(inner_cache);
+
+  partitions= rows2double(tab->records) * inner_cache->length / buff_size;
+  hash->partitions= (uint) min(max(partitions,
+                                   (double) JOIN_HASH_MIN_PARTITIONS),
+                               (double) JOIN_HASH_MAX_PARTITIONS);
+  if (!(hash->outer_files= (IO_CACHE*)
+        thd->calloc(hash->partitions * 2 * sizeof(IO_CACHE))))
+    DBUG_RETURN(1);
+  hash->inner_files= hash->outer_files + hash->partitions;
+  DBUG_RETURN(0);
+}
+
+
+static void free_join_hash(JOIN_HASH *hash)
+{
+  if (hash->outer_files)
+  {
+    for (uint i= 0; i < hash->partitions * 2; i++)
+      close_cached_file(hash->outer_files + i);
+    hash->outer_files= hash->inner_files= 0;
+  }
+  my_free(hash->record_buff);
+  my_free(hash->entries);
+  my_free(hash->buckets);
+  hash->record_buff= 0;
+  hash->entries= 0;
+  hash->buckets= 0;
+  hash->max_entries= hash->bucket_count= 0;
+  hash->spilled= FALSE;
+}
+
+
 static ulong
 used_blob_length(CACHE_FIELD **ptr)
 {
@@ -14919,17 +16579,17 @@ static void reset_cache_write(JOIN_CACHE *cache)
 
 
 static void
-read_cached_record(JOIN_TAB *tab)
+read_cached_record(JOIN_CACHE *cache)
 {
   uchar *pos;
   uint length;
   bool last_record;
   CACHE_FIELD *copy,*end_field;
 
-  last_record=tab->cache.record_nr++ == tab->cache.ptr_record;
-  pos=tab->cache.pos;
+  last_record=cache->record_nr++ == cache->ptr_record;
+  pos=cache->pos;
 
-  for (copy=tab->cache.field,end_field=copy+tab->cache.fields ;
+  for (copy=cache->field,end_field=copy+cache->fields ;
        copy < end_field;
        copy++)
   {
@@ -14964,7 +16624,7 @@ read_cached_record(JOIN_TAB *tab)
       }
     }
   }
-  tab->cache.pos=pos;
+  cache->pos=pos;
   return;
 }
 
@@ -17146,7 +18806,8 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
             examined_rows= tab->limit;
           else
           {
-            tab->table->file->info(HA_STATUS_VARIABLE);
+            if (!tab->table->materialize_pending)
+              tab->table->file->info(HA_STATUS_VARIABLE);
             examined_rows= tab->table->file->stats.records;
           }
         }
@@ -17205,6 +18866,8 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
           extra.append(STRING_WITH_LEN("; Using "));
           tab->select->quick->add_info_string(&extra);
         }
+        if (table->file->pushed_idx_cond)
+          extra.append(STRING_WITH_LEN("; Using index condition"));
 	if (tab->select)
 	{
 	  if (tab->use_quick == 2)
@@ -17235,6 +18898,9 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
               extra.append(STRING_WITH_LEN("; Using where"));
           }
 	}
+        if (quick_type == QUICK_SELECT_I::QS_TYPE_RANGE && !key_read &&
+            ((QUICK_RANGE_SELECT *) tab->select->quick)->uses_mrr())
+          extra.append(STRING_WITH_LEN("; Using MRR"));
         if (table_list->schema_table &&
             table_list->schema_table->i_s_requested_object & OPTIMIZE_I_S_TABLE)
         {
@@ -17289,7 +18955,15 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
           }
         }
         if (i > 0 && tab[-1].next_select == sub_select_cache)
-          extra.append(STRING_WITH_LEN("; Using join buffer"));
+        {
+          if (tab->use_bka)
+            extra.append(STRING_WITH_LEN("; Using join buffer "
+                                         "(Batched Key Access)"));
+          else if (tab->cache.hash)
+            extra.append(STRING_WITH_LEN("; Using join buffer (Hash Join)"));
+          else
+            extra.append(STRING_WITH_LEN("; Using join buffer"));
+        }
         
         /* Skip initial "; "*/
         const char *str= extra.ptr();
@@ -124,9 +124,64 @@ typedef struct st_join_cache {
   uint records,record_nr,ptr_record,fields,length,blobs;
   CACHE_FIELD *field,**blob_ptr;
   SQL_SELECT *select;
+  /*
+    Used with Batched Key Access only: the ref keys of up to max_ranges
+    cached records are looked up at once, see flush_cached_records_bka()
+  */
+  KEY_MULTI_RANGE *ranges;
+  uint *range_record_nr;        /**< record_nr of the record of each range */
+  uchar *range_keys;            /**< key values of the ranges */
+  uint max_ranges;
+  HANDLER_BUFFER *mrr_buff;     /**< rowid buffer of the engine, or NULL */
+  /** Used with hash join only, see flush_cached_records_hash() */
+  struct st_join_hash *hash;
 } JOIN_CACHE;
 
 
+/**
+  An entry of the hash table over the records of a join buffer
+*/
+
+typedef struct st_join_hash_entry {
+  uchar *pos;                   /**< start of the record in the buffer */
+  uint record_nr;
+  uint32 hash_value;
+  uint next;                    /**< next entry in the bucket + 1, or 0 */
+} JOIN_HASH_ENTRY;
+
+
+/**
+  Hash join of the records in a join cache with a table scan.
+
+    The key of the hash join is built from the equalities between the
+    table and the cached tables in the table condition. A record and a
+    row that have the same hash value are then checked against the full
+    condition, so the hash only has to give equal values equal hashes.
+
+    If the cached records do not fit in the join buffer, they are
+    written to partition files by hash value, and so are the rows of the
+    table once all records are cached. Each pair of partitions is then
+    joined in memory, building the hash table from the smaller one.
+*/
+
+typedef struct st_join_hash {
+  uint key_parts;
+  Item **outer_items;           /**< key parts over the cached tables */
+  Item **inner_items;           /**< key parts over the joined table */
+  Item_result *cmp_types;       /**< how the key parts are compared */
+  CHARSET_INFO **collations;
+  JOIN_HASH_ENTRY *entries;
+  uint *buckets;                /**< first entry in the bucket + 1, or 0 */
+  uint entry_count, max_entries, bucket_count;
+  /* Only used if the cached records are written to partition files */
+  JOIN_CACHE inner_cache;       /**< record format of the joined table */
+  uchar *record_buff;           /**< one record read from or to a file */
+  IO_CACHE *outer_files, *inner_files;
+  uint partitions;
+  bool can_spill, spilled;
+} JOIN_HASH;
+
+
 /*
   The structs which holds the join connections and join states
 */
@@ -175,6 +230,12 @@ typedef struct st_join_table {
   */
   SQL_SELECT    *saved_select;
   COND		*select_cond;
+  /**
+    select_cond as it was before a part of it was pushed down to the
+    storage engine as an index condition, NULL if nothing was pushed.
+    @see push_index_cond()
+  */
+  COND          *pre_idx_push_select_cond;
   QUICK_SELECT_I *quick;
   Item	       **on_expr_ref;   /**< pointer to the associated on expression   */
   COND_EQUAL    *cond_equal;    /**< multiple equalities for the on expression */
@@ -230,6 +291,8 @@ typedef struct st_join_table {
   enum join_type type;
   bool		cached_eq_ref_table,eq_ref_table,not_used_in_distinct;
   bool		sorted;
+  /** The join cache is joined with this ref table by Batched Key Access */
+  bool          use_bka;
   /* 
     If it's not 0 the number stored this field indicates that the index
     scan has been chosen to access the table data and we expect to scan 
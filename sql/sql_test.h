@@ -24,6 +24,8 @@ typedef class Item COND;
 typedef class st_select_lex SELECT_LEX;
 typedef struct st_sort_field SORT_FIELD;
 
+extern const char *lock_descriptions[];
+
 #ifndef DBUG_OFF
 void print_where(COND *cond,const char *info, enum_query_type query_type);
 void TEST_filesort(SORT_FIELD *sortorder,uint s_length);
@@ -271,6 +271,7 @@ int mysql_update(THD *thd,
   uint		want_privilege;
 #endif
   uint          table_count= 0;
+  bool          prune_before_lock= FALSE;
   ha_rows	updated, found;
   key_map	old_covering_keys;
   TABLE		*table;
@@ -295,7 +296,14 @@ int mysql_update(THD *thd,
     /* convert to multiupdate */
     DBUG_RETURN(2);
   }
-  if (lock_tables(thd, table_list, table_count, 0))
+#ifdef WITH_PARTITION_STORAGE_ENGINE
+  /*
+    Lock the table after prune_partitions() below, so that only the
+    partitions the statement can touch are locked.
+  */
+  prune_before_lock= can_prune_partitions_before_lock(thd, table_list);
+#endif
+  if (!prune_before_lock && lock_tables(thd, table_list, table_count, 0))
     DBUG_RETURN(1);
 
   if (mysql_handle_derived(thd->lex, &mysql_derived_prepare))
@@ -399,6 +407,15 @@ int mysql_update(THD *thd,
     my_ok(thd);				// No matching records
     DBUG_RETURN(0);
   }
+  if (prune_before_lock)
+  {
+    prune_lock_partitions(table, table->write_set);
+    if (lock_tables(thd, table_list, table_count, 0))
+    {
+      free_underlaid_joins(thd, select_lex);
+      DBUG_RETURN(1);
+    }
+  }
 #endif
   /* Update the table->file->stats.records number */
   table->file->info(HA_STATUS_VARIABLE | HA_STATUS_NO_LOCK);
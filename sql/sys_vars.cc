@@ -44,6 +44,7 @@
                      // mysql_user_table_is_in_short_password_format
 #include "derror.h"  // read_texts
 #include "sql_base.h"                           // close_cached_tables
+#include "table_cache.h"                        // Table_cache_manager
 
 #include "log_event.h"
 #ifdef WITH_PERFSCHEMA_STORAGE_ENGINE
@@ -1249,6 +1250,12 @@ static Sys_var_ulong Sys_metadata_locks_cache_size(
        VALID_RANGE(1, 1024*1024), DEFAULT(MDL_LOCKS_CACHE_SIZE_DEFAULT),
        BLOCK_SIZE(1));
 
+static Sys_var_ulong Sys_metadata_locks_hash_instances(
+       "metadata_locks_hash_instances", "Number of metadata locks hash instances",
+       READ_ONLY GLOBAL_VAR(mdl_locks_hash_partitions), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, 1024), DEFAULT(MDL_LOCKS_HASH_PARTITIONS_DEFAULT),
+       BLOCK_SIZE(1));
+
 static Sys_var_ulong Sys_pseudo_thread_id(
        "pseudo_thread_id",
        "This variable is for internal server use",
@@ -1519,6 +1526,9 @@ static const char *optimizer_switch_names[]=
 {
   "index_merge", "index_merge_union", "index_merge_sort_union",
   "index_merge_intersection", "engine_condition_pushdown",
+  "mrr", "mrr_cost_based", "batched_key_access",
+  "index_condition_pushdown", "materialization", "hash_join",
+  "derived_merge", "derived_with_keys",
   "default", NullS
 };
 /** propagates changes to @@engine_condition_pushdown */
@@ -1534,7 +1544,10 @@ static Sys_var_flagset Sys_optimizer_switch(
        "optimizer_switch",
        "optimizer_switch=option=val[,option=val...], where option is one of "
        "{index_merge, index_merge_union, index_merge_sort_union, "
-       "index_merge_intersection, engine_condition_pushdown}"
+       "index_merge_intersection, engine_condition_pushdown, "
+       "mrr, mrr_cost_based, batched_key_access, "
+       "index_condition_pushdown, materialization, hash_join, "
+       "derived_merge, derived_with_keys}"
        " and val is one of {on, off, default}",
        SESSION_VAR(optimizer_switch), CMD_LINE(REQUIRED_ARG),
        optimizer_switch_names, DEFAULT(OPTIMIZER_SWITCH_DEFAULT),
@@ -1562,6 +1575,17 @@ static Sys_var_uint Sys_port(
        READ_ONLY GLOBAL_VAR(mysqld_port), CMD_LINE(REQUIRED_ARG, 'P'),
        VALID_RANGE(0, UINT_MAX32), DEFAULT(0), BLOCK_SIZE(1));
 
+static Sys_var_ulong Sys_partition_scan_threads(
+       "partition_scan_threads",
+       "Number of threads used for a full table scan of a partitioned "
+       "table, each thread reads whole partitions and queues the rows for "
+       "the statement. 1 (the default) reads the partitions one after "
+       "another in the client thread. Only used for read-only scans of "
+       "engines that allow it, such as MyISAM",
+       SESSION_VAR(partition_scan_threads), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, MAX_PARTITION_SCAN_THREADS), DEFAULT(1),
+       BLOCK_SIZE(1));
+
 static Sys_var_ulong Sys_preload_buff_size(
        "preload_buffer_size",
        "The size of the buffer that is allocated when preloading indexes",
@@ -1884,6 +1908,12 @@ static Sys_var_ulong Sys_query_cache_size(
        NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
        ON_UPDATE(fix_query_cache_size));
 
+static Sys_var_ulong Sys_query_cache_instances(
+       "query_cache_instances", "The number of query cache instances",
+       READ_ONLY GLOBAL_VAR(query_cache_instances), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, Query_cache_manager::MAX_QUERY_CACHES), DEFAULT(1),
+       BLOCK_SIZE(1));
+
 static Sys_var_ulong Sys_query_cache_limit(
        "query_cache_limit",
        "Don't cache results that are bigger than this",
@@ -2176,10 +2206,30 @@ static Sys_var_ulong Sys_table_def_size(
        VALID_RANGE(TABLE_DEF_CACHE_MIN, 512*1024),
        DEFAULT(TABLE_DEF_CACHE_DEFAULT), BLOCK_SIZE(1));
 
+static bool fix_table_cache_size(sys_var *self, THD *thd, enum_var_type type)
+{
+  /*
+    table_open_cache parameter is a soft limit for total number of objects
+    in all table cache instances. Once this value is updated we need to
+    update value of a per-instance soft limit on table cache size.
+  */
+  table_cache_size_per_instance= max(table_cache_size / table_cache_instances,
+                                     1UL);
+  return false;
+}
+
 static Sys_var_ulong Sys_table_cache_size(
-       "table_open_cache", "The number of cached open tables",
+       "table_open_cache", "The number of cached open tables "
+       "(total for all table cache instances)",
        GLOBAL_VAR(table_cache_size), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(1, 512*1024), DEFAULT(TABLE_OPEN_CACHE_DEFAULT),
+       BLOCK_SIZE(1), NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
+       ON_UPDATE(fix_table_cache_size));
+
+static Sys_var_ulong Sys_table_cache_instances(
+       "table_open_cache_instances", "The number of table cache instances",
+       READ_ONLY GLOBAL_VAR(table_cache_instances), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, Table_cache_manager::MAX_TABLE_CACHES), DEFAULT(1),
        BLOCK_SIZE(1));
 
 static Sys_var_ulong Sys_thread_cache_size(
@@ -3215,6 +3265,15 @@ static Sys_var_ulong Sys_slave_trans_retries(
        "or elapsed lock wait timeout, before giving up and stopping",
        GLOBAL_VAR(slave_trans_retries), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(0, ULONG_MAX), DEFAULT(10), BLOCK_SIZE(1));
+
+static Sys_var_ulong Sys_slave_parallel_workers(
+       "slave_parallel_workers", "Number of worker threads executing "
+       "row-based transactions in parallel on the slave, transactions on "
+       "different databases can be executed by different workers. "
+       "0 (the default) lets the slave SQL thread execute all the events "
+       "itself. Takes effect at the next START SLAVE",
+       GLOBAL_VAR(opt_slave_parallel_workers), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, MAX_SLAVE_PARALLEL_WORKERS), DEFAULT(0), BLOCK_SIZE(1));
 #endif
 
 static bool check_locale(sys_var *self, THD *thd, set_var *var)
@@ -31,11 +31,13 @@
 #include "sql_partition.h"       // mysql_unpack_partition,
                                  // fix_partition_func, partition_info
 #include "sql_acl.h"             // *_ACL, acl_getroot_no_password
-#include "sql_base.h"            // release_table_share
+#include "sql_base.h"            // release_table_share, setup_wild
+#include "sql_view.h"            // check_duplicate_names
 #include <m_ctype.h>
 #include "my_md5.h"
 #include "sql_select.h"
 #include "mdl.h"                 // MDL_wait_for_graph_visitor
+#include "table_cache.h"         // table_cache_manager
 
 /* INFORMATION_SCHEMA name */
 LEX_STRING INFORMATION_SCHEMA_NAME= {C_STRING_WITH_LEN("information_schema")};
@@ -287,6 +289,7 @@ TABLE_SHARE *alloc_table_share(TABLE_LIST *table_list, char *key,
   MEM_ROOT mem_root;
   TABLE_SHARE *share;
   char *key_buff, *path_buff;
+  Table_cache_element **cache_element_array;
   char path[FN_REFLEN];
   uint path_length;
   DBUG_ENTER("alloc_table_share");
@@ -301,6 +304,8 @@ TABLE_SHARE *alloc_table_share(TABLE_LIST *table_list, char *key,
                        &share, sizeof(*share),
                        &key_buff, key_length,
                        &path_buff, path_length + 1,
+                       &cache_element_array,
+                       table_cache_instances * sizeof(*cache_element_array),
                        NULL))
   {
     bzero((char*) share, sizeof(*share));
@@ -325,8 +330,10 @@ TABLE_SHARE *alloc_table_share(TABLE_LIST *table_list, char *key,
     share->table_map_id= ~0UL;
     share->cached_row_logging_check= -1;
 
-    share->used_tables.empty();
-    share->free_tables.empty();
+    bzero(cache_element_array,
+          table_cache_instances * sizeof(*cache_element_array));
+    share->cache_element= cache_element_array;
+
     share->m_flush_tickets.empty();
 
     memcpy((char*) &share->mem_root, (char*) &mem_root, sizeof(mem_root));
@@ -390,8 +397,12 @@ void init_tmp_table_share(THD *thd, TABLE_SHARE *share, const char *key,
   */
   share->table_map_id= (ulong) thd->query_id;
 
-  share->used_tables.empty();
-  share->free_tables.empty();
+  /*
+    Temporary tables are not added to the table cache so
+    TABLE_SHARE::cache_element is not used for them.
+  */
+  share->cache_element= NULL;
+
   share->m_flush_tickets.empty();
 
   DBUG_VOID_RETURN;
@@ -3200,15 +3211,16 @@ bool TABLE_SHARE::visit_subgraph(Wait_for_flush *wait_for_flush,
 
   /*
     To protect used_tables list from being concurrently modified
-    while we are iterating through it we acquire LOCK_open.
+    while we are iterating through it we acquire LOCK_open and
+    locks on all table cache instances.
     This does not introduce deadlocks in the deadlock detector
-    because we won't try to acquire LOCK_open while
+    because we won't try to acquire these locks while
     holding a write-lock on MDL_lock::m_rwlock.
   */
   if (gvisitor->m_lock_open_count++ == 0)
-    mysql_mutex_lock(&LOCK_open);
+    table_cache_manager.lock_all_and_tdc();
 
-  I_P_List_iterator <TABLE, TABLE_share> tables_it(used_tables);
+  Table_cache_iterator tables_it(this);
 
   /*
     In case of multiple searches running in parallel, avoid going
@@ -3248,7 +3260,7 @@ end_leave_node:
 
 end:
   if (gvisitor->m_lock_open_count-- == 1)
-    mysql_mutex_unlock(&LOCK_open);
+    table_cache_manager.unlock_all_and_tdc();
 
   return result;
 }
@@ -3266,6 +3278,8 @@ end:
        non-zero reference count), is marked for flush and
        this connection does not reference the share.
        LOCK_open will be unlocked temporarily during execution.
+  @pre The connection has no metadata locks acquired on the fast
+       path, see MDL_context::materialize_fast_path_locks().
 
   @retval FALSE - Success.
   @retval TRUE  - Error (OOM, deadlock, timeout, etc...).
@@ -3511,13 +3525,14 @@ void TABLE_LIST::set_underlying_merge()
 
   if ((tbl= merge_underlying_list))
   {
-    /* This is a view. Process all tables of view */
-    DBUG_ASSERT(view && effective_algorithm == VIEW_ALGORITHM_MERGE);
+    /* This is a view or merged derived table. Process all its tables */
+    DBUG_ASSERT((view || is_merged_derived()) &&
+                effective_algorithm == VIEW_ALGORITHM_MERGE);
     do
     {
       if (tbl->merge_underlying_list)          // This is a view
       {
-        DBUG_ASSERT(tbl->view &&
+        DBUG_ASSERT((tbl->view || tbl->is_merged_derived()) &&
                     tbl->effective_algorithm == VIEW_ALGORITHM_MERGE);
         /*
           This is the only case where set_ancestor is called on an object
@@ -3548,6 +3563,9 @@ void TABLE_LIST::set_underlying_merge()
     - preparing translation table for view columns
     If there are underlying view(s) procedure first will be called for them.
 
+    The select list of a merged derived table has not been checked yet:
+    its wildcards are expanded and its column names checked here.
+
   RETURN
     FALSE - OK
     TRUE  - error
@@ -3560,10 +3578,9 @@ bool TABLE_LIST::setup_underlying(THD *thd)
   if (!field_translation && merge_underlying_list)
   {
     Field_translator *transl;
-    SELECT_LEX *select= &view->select_lex;
+    SELECT_LEX *select= get_single_select();
     Item *item;
     TABLE_LIST *tbl;
-    List_iterator_fast<Item> it(select->item_list);
     uint field_count= 0;
 
     if (check_stack_overrun(thd, STACK_MIN_SIZE, (uchar*) &field_count))
@@ -3580,6 +3597,22 @@ bool TABLE_LIST::setup_underlying(THD *thd)
       }
     }
 
+    if (select->with_wild)
+    {
+      /* Only merged derived tables, VIEW definitions are stored expanded */
+      SELECT_LEX *save_current_select= thd->lex->current_select;
+      int res;
+      thd->lex->current_select= select;
+      res= setup_wild(thd, merge_underlying_list, select->item_list, NULL,
+                      select->with_wild);
+      thd->lex->current_select= save_current_select;
+      if (res)
+        DBUG_RETURN(TRUE);
+      select->with_wild= 0;
+    }
+    if (is_merged_derived() && check_duplicate_names(select->item_list, 0))
+      DBUG_RETURN(TRUE);
+
     /* Create view fields translation table */
 
     if (!(transl=
@@ -3590,6 +3623,7 @@ bool TABLE_LIST::setup_underlying(THD *thd)
       DBUG_RETURN(TRUE);
     }
 
+    List_iterator_fast<Item> it(select->item_list);
     while ((item= it++))
     {
       transl[field_count].name= item->name;
@@ -3600,12 +3634,12 @@ bool TABLE_LIST::setup_underlying(THD *thd)
     /* TODO: use hash for big number of fields */
 
     /* full text function moving to current select */
-    if (view->select_lex.ftfunc_list->elements)
+    if (select->ftfunc_list->elements)
     {
       Item_func_match *ifm;
       SELECT_LEX *current_select= thd->lex->current_select;
       List_iterator_fast<Item_func_match>
-        li(*(view->select_lex.ftfunc_list));
+        li(*(select->ftfunc_list));
       while ((ifm= li++))
         current_select->ftfunc_list->push_front(ifm);
     }
@@ -3614,6 +3648,84 @@ bool TABLE_LIST::setup_underlying(THD *thd)
 }
 
 
+#ifndef NO_EMBEDDED_ACCESS_CHECKS
+/*
+  Check if columns of some of the tables need column privileges checked
+
+  SYNOPSIS
+    want_column_grants()
+    tables          - underlying tables of a merged view or derived table
+*/
+
+static bool want_column_grants(TABLE_LIST *tables)
+{
+  for (TABLE_LIST *tbl= tables; tbl; tbl= tbl->next_local)
+  {
+    if (tbl->merge_underlying_list)
+    {
+      if ((tbl->view && tbl->grant.want_privilege) ||
+          want_column_grants(tbl->merge_underlying_list))
+        return TRUE;
+    }
+    else if (tbl->table && tbl->table->grant.want_privilege)
+      return TRUE;
+  }
+  return FALSE;
+}
+
+
+/*
+  Check privileges on all columns of a merged derived table
+
+  SYNOPSIS
+    TABLE_LIST::check_derived_column_grants()
+    thd             - thread handler
+
+  DESCRIPTION
+    Only the columns of a merged derived table which the outer query uses
+    are fixed through the field translation table. If privileges of some
+    underlying columns have to be checked, all items of the select list
+    are fixed here, so that the SELECT privilege is checked on them as it
+    is by JOIN::prepare() of a materialized derived table. Otherwise the
+    unused columns are left out of the read set.
+
+    It is called on every execution, outside of the statement arena.
+
+  RETURN
+    FALSE - OK
+    TRUE  - error
+*/
+
+bool TABLE_LIST::check_derived_column_grants(THD *thd)
+{
+  DBUG_ENTER("TABLE_LIST::check_derived_column_grants");
+  DBUG_ASSERT(is_merged_derived() && field_translation);
+
+  for (TABLE_LIST *tbl= merge_underlying_list; tbl; tbl= tbl->next_local)
+  {
+    if (tbl->is_merged_derived() && tbl->check_derived_column_grants(thd))
+      DBUG_RETURN(TRUE);
+  }
+  if (!want_column_grants(merge_underlying_list))
+    DBUG_RETURN(FALSE);
+
+  enum_mark_columns save_mark_used_columns= thd->mark_used_columns;
+  thd->mark_used_columns= MARK_COLUMNS_READ;
+  for (Field_translator *transl= field_translation;
+       transl < field_translation_end; transl++)
+  {
+    if (!transl->item->fixed && transl->item->fix_fields(thd, &transl->item))
+    {
+      thd->mark_used_columns= save_mark_used_columns;
+      DBUG_RETURN(TRUE);
+    }
+  }
+  thd->mark_used_columns= save_mark_used_columns;
+  DBUG_RETURN(FALSE);
+}
+#endif /* NO_EMBEDDED_ACCESS_CHECKS */
+
+
 /*
   Prepare where expression of view
 
@@ -3639,7 +3751,8 @@ bool TABLE_LIST::prep_where(THD *thd, Item **conds,
 
   for (TABLE_LIST *tbl= merge_underlying_list; tbl; tbl= tbl->next_local)
   {
-    if (tbl->view && tbl->prep_where(thd, conds, no_where_clause))
+    if ((tbl->view || tbl->is_merged_derived()) &&
+        tbl->prep_where(thd, conds, no_where_clause))
     {
       DBUG_RETURN(TRUE);
     }
@@ -4028,8 +4141,8 @@ bool TABLE_LIST::set_insert_values(MEM_ROOT *mem_root)
 */
 bool TABLE_LIST::is_leaf_for_name_resolution()
 {
-  return (view || is_natural_join || is_join_columns_complete ||
-          !nested_join);
+  return (view || is_merged_derived() || is_natural_join ||
+          is_join_columns_complete || !nested_join);
 }
 
 
@@ -4545,7 +4658,7 @@ void Field_iterator_table_ref::set_field_iterator()
   /* This is a merge view, so use field_translation. */
   else if (table_ref->field_translation)
   {
-    DBUG_ASSERT(table_ref->view &&
+    DBUG_ASSERT((table_ref->view || table_ref->is_merged_derived()) &&
                 table_ref->effective_algorithm == VIEW_ALGORITHM_MERGE);
     field_it= &view_field_it;
     DBUG_PRINT("info", ("field_it for '%s' is Field_iterator_view",
@@ -4596,6 +4709,8 @@ const char *Field_iterator_table_ref::get_table_name()
 {
   if (table_ref->view)
     return table_ref->view_name.str;
+  else if (table_ref->is_merged_derived())
+    return table_ref->alias;
   else if (table_ref->is_natural_join)
     return natural_join_it.column_ref()->table_name();
 
@@ -4609,6 +4724,8 @@ const char *Field_iterator_table_ref::get_db_name()
 {
   if (table_ref->view)
     return table_ref->view_db.str;
+  else if (table_ref->is_merged_derived())
+    return table_ref->db;
   else if (table_ref->is_natural_join)
     return natural_join_it.column_ref()->db_name();
 
@@ -4628,7 +4745,7 @@ const char *Field_iterator_table_ref::get_db_name()
 
 GRANT_INFO *Field_iterator_table_ref::grant()
 {
-  if (table_ref->view)
+  if (table_ref->view || table_ref->is_merged_derived())
     return &(table_ref->grant);
   else if (table_ref->is_natural_join)
     return natural_join_it.column_ref()->grant();
@@ -5109,6 +5226,13 @@ Item_subselect *TABLE_LIST::containing_subselect()
   return (select_lex ? select_lex->master_unit()->item : 0);
 }
 
+
+st_select_lex *TABLE_LIST::get_single_select()
+{
+  DBUG_ASSERT(view || derived);
+  return view ? &view->select_lex : derived->first_select();
+}
+
 /*
   Compiles the tagged hints list and fills up the bitmasks.
 
@@ -450,6 +450,7 @@ TABLE_CATEGORY get_table_category(const LEX_STRING *db,
 
 
 struct TABLE_share;
+class Table_cache_element;
 
 extern ulong refresh_version;
 
@@ -555,12 +556,14 @@ struct TABLE_SHARE
   mysql_mutex_t LOCK_ha_data;           /* To protect access to ha_data */
   TABLE_SHARE *next, **prev;            /* Link to unused shares */
 
-  /*
-    Doubly-linked (back-linked) lists of used and unused TABLE objects
-    for this share.
+  /**
+    Array of table_cache_instances pointers to elements of table caches
+    respresenting this table in each of Table_cache instances.
+    Allocated along with the share itself in alloc_table_share().
+    Each element of the array is protected by Table_cache::m_lock in the
+    corresponding Table_cache.
   */
-  I_P_List <TABLE, TABLE_share> used_tables;
-  I_P_List <TABLE, TABLE_share> free_tables;
+  Table_cache_element **cache_element;
 
   /* The following is copied to each TABLE on OPEN */
   Field **field;
@@ -1087,6 +1090,12 @@ public:
   my_bool alias_name_used;		/* true if table_name is alias */
   my_bool get_fields_in_item_tree;      /* Signal to fix_field */
   my_bool m_needs_reopen;
+  /*
+    Derived table that is filled on its first read, see
+    mysql_derived_materialize(). Until then file->stats.records holds the
+    estimated number of rows and the optimizer may add keys to it.
+  */
+  my_bool materialize_pending;
 
   REGINFO reginfo;			/* field connections */
   MEM_ROOT mem_root;
@@ -1733,6 +1742,7 @@ struct TABLE_LIST
 #ifndef NO_EMBEDDED_ACCESS_CHECKS
   Security_context *find_view_security_context(THD *thd);
   bool prepare_view_securety_context(THD *thd);
+  bool check_derived_column_grants(THD *thd);
 #endif
   /*
     Cleanup for re-execution in a prepared statement or a stored
@@ -1786,6 +1796,19 @@ struct TABLE_LIST
   */
   bool is_anonymous_derived_table() const { return derived && !view; }
 
+  /**
+     @brief True if this TABLE_LIST represents an anonymous derived table
+     that has been merged into the outer query block, like a view with the
+     MERGE algorithm.
+  */
+  bool is_merged_derived() const
+  { return is_anonymous_derived_table() && merge_underlying_list; }
+
+  /**
+     @brief Returns the SELECT of a merged view or merged derived table.
+  */
+  st_select_lex *get_single_select();
+
   /**
      @brief Returns the name of the database that the referenced table belongs
      to.
@@ -19,11 +19,30 @@
 
 #include "heapdef.h"
 
+/*
+  Only the part of the record stored in the row is compared. BLOB columns
+  in it are skipped, as the row has a stale copy of them.
+*/
+
 int hp_rectest(register HP_INFO *info, register const uchar *old)
 {
+  HP_SHARE *share= info->s;
+  HP_COLUMNDEF *column, *end;
+  uint offset= 0;
   DBUG_ENTER("hp_rectest");
 
-  if (memcmp(info->current_ptr,old,(size_t) info->s->reclength))
+  for (column= share->columndef, end= column + share->columns;
+       column < end && column->offset < share->fixed_data_length; column++)
+  {
+    if (column->type != HP_COLUMN_BLOB)
+      continue;
+    if (memcmp(info->current_ptr + offset, old + offset,
+               (size_t) (column->offset - offset)))
+      DBUG_RETURN((my_errno=HA_ERR_RECORD_CHANGED));
+    offset= column->offset + column->length;
+  }
+  if (memcmp(info->current_ptr + offset, old + offset,
+             (size_t) (share->fixed_data_length - offset)))
   {
     DBUG_RETURN((my_errno=HA_ERR_RECORD_CHANGED)); /* Record have changed */
   }
@@ -647,10 +647,11 @@ heap_prepare_hp_create_info(TABLE *table_arg, bool internal_table,
                             HP_CREATE_INFO *hp_create_info)
 {
   uint key, parts, mem_per_row= 0, keys= table_arg->s->keys;
-  uint auto_key= 0, auto_key_type= 0;
+  uint auto_key= 0, auto_key_type= 0, var_data_length= 0;
   ha_rows max_rows;
   HP_KEYDEF *keydef;
   HA_KEYSEG *seg;
+  HP_COLUMNDEF *columndef;
   TABLE_SHARE *share= table_arg->s;
   bool found_real_auto_increment= 0;
 
@@ -660,10 +661,52 @@ heap_prepare_hp_create_info(TABLE *table_arg, bool internal_table,
     parts+= table_arg->key_info[key].key_parts;
 
   if (!(keydef= (HP_KEYDEF*) my_malloc(keys * sizeof(HP_KEYDEF) +
-				       parts * sizeof(HA_KEYSEG),
+				       parts * sizeof(HA_KEYSEG) +
+				       share->fields * sizeof(HP_COLUMNDEF),
 				       MYF(MY_WME))))
     return my_errno;
   seg= reinterpret_cast<HA_KEYSEG*>(keydef + keys);
+  columndef= reinterpret_cast<HP_COLUMNDEF*>(seg + parts);
+
+  /*
+    Tell HEAP where the VARCHAR and BLOB columns are, so that it can
+    store them in chunks of their used length.
+  */
+  for (uint i= 0; i < share->fields; i++)
+  {
+    Field *field= table_arg->field[i];
+    HP_COLUMNDEF *column= columndef + i;
+
+    column->offset= (uint) (field->ptr - table_arg->record[0]);
+    column->length= field->pack_length();
+    if (field->flags & BLOB_FLAG)
+    {
+      column->type= HP_COLUMN_BLOB;
+      column->length_bytes= ((Field_blob*) field)->pack_length_no_ptr();
+      var_data_length+= column->length - column->length_bytes;
+    }
+    else if (field->real_type() == MYSQL_TYPE_VARCHAR)
+    {
+      column->type= HP_COLUMN_VARCHAR;
+      column->length_bytes= ((Field_varstring*) field)->length_bytes;
+      var_data_length+= column->length - column->length_bytes;
+    }
+    else
+    {
+      column->type= HP_COLUMN_FIXED;
+      column->length_bytes= 0;
+    }
+    if (field->null_ptr)
+    {
+      column->null_bit= field->null_bit;
+      column->null_pos= (uint) (field->null_ptr - table_arg->record[0]);
+    }
+    else
+    {
+      column->null_bit= 0;
+      column->null_pos= 0;
+    }
+  }
   for (key= 0; key < keys; key++)
   {
     KEY *pos= table_arg->key_info+key;
@@ -734,7 +777,12 @@ heap_prepare_hp_create_info(TABLE *table_arg, bool internal_table,
       }
     }
   }
-  mem_per_row+= MY_ALIGN(share->reclength + 1, sizeof(char*));
+  /*
+    Rows with VARCHAR or BLOB columns may be shorter than reclength; leave
+    it to the max_table_size check to stop inserts.
+  */
+  mem_per_row+= MY_ALIGN(share->reclength - var_data_length + 1,
+                         sizeof(char*));
   if (table_arg->found_next_number_field)
   {
     keydef[share->next_number_index].flag|= HA_AUTO_KEY;
@@ -743,6 +791,13 @@ heap_prepare_hp_create_info(TABLE *table_arg, bool internal_table,
   hp_create_info->auto_key= auto_key;
   hp_create_info->auto_key_type= auto_key_type;
   hp_create_info->max_table_size=current_thd->variables.max_heap_table_size;
+  /*
+    create_tmp_table() limits temporary tables by rows of reclength bytes;
+    with variable-size rows the limit is on memory instead.
+  */
+  if (internal_table && var_data_length)
+    set_if_smaller(hp_create_info->max_table_size,
+                   current_thd->variables.tmp_table_size);
   hp_create_info->with_auto_increment= found_real_auto_increment;
   hp_create_info->internal_table= internal_table;
 
@@ -755,6 +810,8 @@ heap_prepare_hp_create_info(TABLE *table_arg, bool internal_table,
   hp_create_info->keys= share->keys;
   hp_create_info->reclength= share->reclength;
   hp_create_info->keydef= keydef;
+  hp_create_info->columns= share->fields;
+  hp_create_info->columndef= columndef;
   return 0;
 }
 
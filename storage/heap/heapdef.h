@@ -32,6 +32,15 @@ C_MODE_START
 #define HP_MIN_RECORDS_IN_BLOCK 16
 #define HP_MAX_RECORDS_IN_BLOCK 8192
 
+/*
+  Bytes of data in one chunk of the variable-size part of a record, and
+  the bytes a row with such a part uses to point at its chunks (first
+  chunk and length of the part).
+*/
+
+#define HP_VAR_CHUNK_LENGTH 64
+#define HP_VAR_PART_REF_LENGTH (sizeof(uchar*) + 4)
+
 	/* Some extern variables */
 
 extern LIST *heap_open_list,*heap_share_list;
@@ -100,6 +109,13 @@ extern void hp_clear(HP_SHARE *info);
 extern void hp_clear_keys(HP_SHARE *info);
 extern uint hp_rb_pack_key(HP_KEYDEF *keydef, uchar *key, const uchar *old,
                            key_part_map keypart_map);
+extern int hp_write_var_part(HP_INFO *info, const uchar *record,
+                             uchar **chain, uint *length);
+extern void hp_free_var_part(HP_SHARE *share, uchar *chain);
+extern uchar *hp_get_var_part(HP_SHARE *share, const uchar *pos);
+extern void hp_store_record(HP_SHARE *share, uchar *pos, const uchar *record,
+                            uchar *chain, uint length);
+extern int hp_extract_record(HP_INFO *info, uchar *record, const uchar *pos);
 
 extern mysql_mutex_t THR_LOCK_heap;
 
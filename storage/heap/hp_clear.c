@@ -35,8 +35,14 @@ void hp_clear(HP_SHARE *info)
     (void) hp_free_level(&info->block,info->block.levels,info->block.root,
 			(uchar*) 0);
   info->block.levels=0;
+  if (info->vblock.levels)
+    (void) hp_free_level(&info->vblock,info->vblock.levels,info->vblock.root,
+			(uchar*) 0);
+  info->vblock.levels=0;
   hp_clear_keys(info);
   info->records= info->deleted= 0;
+  info->vchunks= info->vdeleted= 0;
+  info->vdel_link=0;
   info->data_length= 0;
   info->blength=1;
   info->changed=0;
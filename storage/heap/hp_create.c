@@ -18,6 +18,7 @@
 static int keys_compare(heap_rb_param *param, uchar *key1, uchar *key2);
 static void init_block(HP_BLOCK *block,uint reclength,ulong min_records,
 		       ulong max_records);
+static void init_record_format(HP_SHARE *share);
 
 /* Create a heap table */
 
@@ -133,13 +134,17 @@ int heap_create(const char *name, HP_CREATE_INFO *create_info,
     }
     if (!(share= (HP_SHARE*) my_malloc((uint) sizeof(HP_SHARE)+
 				       keys*sizeof(HP_KEYDEF)+
-				       key_segs*sizeof(HA_KEYSEG),
+				       key_segs*sizeof(HA_KEYSEG)+
+				       create_info->columns*sizeof(HP_COLUMNDEF),
 				       MYF(MY_ZEROFILL))))
       goto err;
     share->keydef= (HP_KEYDEF*) (share + 1);
     share->key_stat_version= 1;
     keyseg= (HA_KEYSEG*) (share->keydef + keys);
-    init_block(&share->block, reclength + 1, min_records, max_records);
+    share->columndef= (HP_COLUMNDEF*) (keyseg + key_segs);
+    share->columns= create_info->columns;
+    memcpy(share->columndef, create_info->columndef,
+           (size_t) (sizeof(HP_COLUMNDEF) * create_info->columns));
 	/* Fix keys */
     memcpy(share->keydef, keydef, (size_t) (sizeof(keydef[0]) * keys));
     for (i= 0, keyinfo= share->keydef; i < keys; i++, keyinfo++)
@@ -179,8 +184,13 @@ int heap_create(const char *name, HP_CREATE_INFO *create_info,
     share->max_table_size= create_info->max_table_size;
     share->data_length= share->index_length= 0;
     share->reclength= reclength;
-    share->blength= 1;
     share->keys= keys;
+    init_record_format(share);
+    init_block(&share->block, share->visible + 1, min_records, max_records);
+    if (share->var_chunk_length)
+      init_block(&share->vblock, sizeof(uchar*) + share->var_chunk_length,
+                 min_records, max_records);
+    share->blength= 1;
     share->max_key_length= max_length;
     share->changed= 0;
     share->auto_key= create_info->auto_key;
@@ -228,6 +238,70 @@ static int keys_compare(heap_rb_param *param, uchar *key1, uchar *key2)
 		    param->search_flag, not_used);
 }
 
+/*
+  Decide which part of the records is stored in the rows
+
+  The rows hold the record up to the first VARCHAR or BLOB column that
+  follows every key segment. If the rest of the record can be long, or
+  there are BLOB columns, it is packed into chunks, see hp_record.c.
+  Otherwise the whole record is stored in the row.
+*/
+
+static void init_record_format(HP_SHARE *share)
+{
+  HP_KEYDEF *keyinfo, *keyend;
+  HA_KEYSEG *seg, *segend;
+  HP_COLUMNDEF *column, *end;
+  uint key_end= 0, fixed_length= share->reclength;
+  my_bool blobs= 0;
+
+  for (keyinfo= share->keydef, keyend= keyinfo + share->keys;
+       keyinfo < keyend; keyinfo++)
+  {
+    for (seg= keyinfo->seg, segend= seg + keyinfo->keysegs; seg < segend;
+         seg++)
+    {
+      uint seg_end= seg->start + seg->length;
+      if (seg->type == HA_KEYTYPE_VARTEXT1)
+        seg_end+= seg->bit_start;
+      set_if_bigger(key_end, seg_end);
+      if (seg->null_bit)
+        set_if_bigger(key_end, seg->null_pos + 1);
+      if (seg->type == HA_KEYTYPE_BIT && seg->bit_length)
+        set_if_bigger(key_end, seg->bit_pos + 1);
+    }
+  }
+
+  for (column= share->columndef, end= column + share->columns;
+       column < end; column++)
+  {
+    DBUG_ASSERT(column == share->columndef ||
+                column->offset >= column[-1].offset + column[-1].length);
+    if (column->type == HP_COLUMN_BLOB)
+      blobs= 1;
+    if (column->type != HP_COLUMN_FIXED && column->offset >= key_end)
+      set_if_smaller(fixed_length, column->offset);
+  }
+
+  if (blobs || share->reclength - fixed_length > HP_VAR_CHUNK_LENGTH)
+  {
+    share->fixed_data_length= fixed_length;
+    share->var_chunk_length= HP_VAR_CHUNK_LENGTH;
+    share->visible= fixed_length + HP_VAR_PART_REF_LENGTH;
+  }
+  else
+  {
+    share->fixed_data_length= share->reclength;
+    share->var_chunk_length= 0;
+    share->visible= share->reclength;
+  }
+  /* Deleted rows store del_link */
+  set_if_bigger(share->visible, sizeof(uchar*));
+  DBUG_PRINT("info",("fixed_data_length: %u  var_chunk_length: %u",
+                     share->fixed_data_length, share->var_chunk_length));
+}
+
+
 static void init_block(HP_BLOCK *block, uint reclength, ulong min_records,
 		       ulong max_records)
 {
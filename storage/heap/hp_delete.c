@@ -43,9 +43,10 @@ int heap_delete(HP_INFO *info, const uchar *record)
   }
 
   info->update=HA_STATE_DELETED;
+  hp_free_var_part(share, hp_get_var_part(share, pos));
   *((uchar**) pos)=share->del_link;
   share->del_link=pos;
-  pos[share->reclength]=0;		/* Record deleted */
+  pos[share->visible]=0;		/* Record deleted */
   share->deleted++;
   info->current_hash_ptr=0;
 #if !defined(DBUG_OFF) && defined(EXTRA_HEAP_DEBUG)
@@ -0,0 +1,388 @@
+/* Copyright (c) 2012, Oracle and/or its affiliates. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/*
+  Variable-size part of records.
+
+  If a table has BLOB columns, or long VARCHAR columns that are not part
+  of any key, heap_create() splits its records in two. The record up to
+  share->fixed_data_length, which holds every key column, is stored in
+  the row as before. The rest of the record is packed: VARCHAR columns
+  keep only their used length and BLOB columns their data. The packed
+  image is stored in a chain of chunks of share->vblock.
+
+  A row is then
+    [record prefix][first chunk][length of packed part (4 bytes)][status]
+  and a chunk
+    [next chunk][share->var_chunk_length bytes of packed data]
+
+  NULL VARCHAR and BLOB columns are stored with length 0. BLOB columns in
+  the record prefix are stored in the packed part too, the row only keeps
+  a stale copy of their length and pointer.
+*/
+
+#include "heapdef.h"
+
+typedef struct st_hp_chunk_writer
+{
+  uchar *chunk;				/* Chunk being written */
+  uchar *pos;				/* Next byte in chunk */
+  uint left;				/* Bytes left in chunk */
+} HP_CHUNK_WRITER;
+
+
+static uint hp_get_length(uint length_bytes, const uchar *pos)
+{
+  switch (length_bytes) {
+  case 1: return (uint) *pos;
+  case 2: return uint2korr(pos);
+  case 3: return uint3korr(pos);
+  case 4: return uint4korr(pos);
+  default:
+    DBUG_ASSERT(0);
+  }
+  return 0;
+}
+
+
+static void hp_store_length(uchar *pos, uint length_bytes, uint length)
+{
+  switch (length_bytes) {
+  case 1: *pos= (uchar) length; break;
+  case 2: int2store(pos, length); break;
+  case 3: int3store(pos, length); break;
+  case 4: int4store(pos, length); break;
+  default:
+    DBUG_ASSERT(0);
+  }
+}
+
+
+/*
+  Get the data of a VARCHAR or BLOB column
+
+  RETURN
+    length of data, 0 if the column is NULL
+*/
+
+static uint hp_column_data(HP_COLUMNDEF *column, const uchar *record,
+                           const uchar **data)
+{
+  const uchar *pos= record + column->offset;
+  uint length;
+
+  if (column->null_bit && (record[column->null_pos] & column->null_bit))
+  {
+    *data= pos;
+    return 0;
+  }
+  length= hp_get_length(column->length_bytes, pos);
+  if (column->type == HP_COLUMN_VARCHAR)
+  {
+    set_if_smaller(length, column->length - column->length_bytes);
+    *data= pos + column->length_bytes;
+  }
+  else
+    memcpy((void*) data, pos + column->length_bytes, sizeof(uchar*));
+  return length;
+}
+
+
+/* Length of the packed part of a record */
+
+static uint hp_var_part_length(HP_SHARE *share, const uchar *record)
+{
+  HP_COLUMNDEF *column, *end;
+  const uchar *data;
+  uint length= share->reclength - share->fixed_data_length;
+
+  for (column= share->columndef, end= column + share->columns;
+       column < end; column++)
+  {
+    if (column->type == HP_COLUMN_FIXED ||
+        (column->type == HP_COLUMN_VARCHAR &&
+         column->offset < share->fixed_data_length))
+      continue;
+    length+= column->length_bytes + hp_column_data(column, record, &data);
+    if (column->offset >= share->fixed_data_length)
+      length-= column->length;
+  }
+  return length;
+}
+
+
+static void hp_chunk_write(HP_SHARE *share, HP_CHUNK_WRITER *writer,
+                           const uchar *from, uint length)
+{
+  while (length)
+  {
+    uint copy;
+    if (!writer->left)
+    {
+      writer->chunk= *((uchar**) writer->chunk);
+      DBUG_ASSERT(writer->chunk);
+      writer->pos= writer->chunk + sizeof(uchar*);
+      writer->left= share->var_chunk_length;
+    }
+    copy= min(length, writer->left);
+    memcpy(writer->pos, from, copy);
+    writer->pos+= copy;
+    writer->left-= copy;
+    from+= copy;
+    length-= copy;
+  }
+}
+
+
+	/* Find where to place a new chunk */
+
+static uchar *hp_alloc_chunk(HP_SHARE *share)
+{
+  int block_pos;
+  uchar *chunk;
+  size_t length;
+
+  if (share->vdel_link)
+  {
+    chunk= share->vdel_link;
+    share->vdel_link= *((uchar**) chunk);
+    share->vdeleted--;
+  }
+  else
+  {
+    if (!(block_pos= (share->vchunks % share->vblock.records_in_block)))
+    {
+      if (share->data_length + share->index_length >= share->max_table_size)
+      {
+        my_errno= HA_ERR_RECORD_FILE_FULL;
+        return NULL;
+      }
+      if (hp_get_new_block(&share->vblock, &length))
+        return NULL;
+      share->data_length+= length;
+    }
+    chunk= ((uchar*) share->vblock.level_info[0].last_blocks +
+            block_pos * share->vblock.recbuffer);
+  }
+  share->vchunks++;
+  return chunk;
+}
+
+
+/*
+  Pack the variable-size part of a record into a new chain of chunks
+
+  SYNOPSIS
+    hp_write_var_part()
+    info          Heap table info
+    record        Table record
+    chain   OUT   First chunk, 0 if the packed part is empty
+    length  OUT   Length of the packed part
+
+  NOTE
+    The chain is not linked to any row; the caller stores it with
+    hp_store_record() or frees it with hp_free_var_part().
+
+  RETURN
+    0     OK
+    #     Error code; no chunks are allocated
+*/
+
+int hp_write_var_part(HP_INFO *info, const uchar *record,
+                      uchar **chain, uint *length)
+{
+  HP_SHARE *share= info->s;
+  HP_COLUMNDEF *column, *end;
+  HP_CHUNK_WRITER writer;
+  const uchar *data;
+  uchar *chunk, length_buff[4];
+  uint var_length, chunks, end_offset, data_length;
+  DBUG_ENTER("hp_write_var_part");
+
+  var_length= hp_var_part_length(share, record);
+  *chain= 0;
+  for (chunks= ((var_length + share->var_chunk_length - 1) /
+                share->var_chunk_length) ; chunks ; chunks--)
+  {
+    if (!(chunk= hp_alloc_chunk(share)))
+    {
+      hp_free_var_part(share, *chain);
+      *chain= 0;
+      DBUG_RETURN(my_errno);
+    }
+    *((uchar**) chunk)= *chain;
+    *chain= chunk;
+  }
+  *length= var_length;
+  if (!var_length)
+    DBUG_RETURN(0);
+
+  writer.chunk= *chain;
+  writer.pos= *chain + sizeof(uchar*);
+  writer.left= share->var_chunk_length;
+  end_offset= share->fixed_data_length;
+  for (column= share->columndef, end= column + share->columns;
+       column < end; column++)
+  {
+    if (column->offset < share->fixed_data_length)
+    {
+      if (column->type != HP_COLUMN_BLOB)
+        continue;				/* Stored in the row */
+    }
+    else
+    {
+      /* Bytes between columns, like separate null flags of tmp tables */
+      hp_chunk_write(share, &writer, record + end_offset,
+                     column->offset - end_offset);
+      end_offset= column->offset + column->length;
+      if (column->type == HP_COLUMN_FIXED)
+      {
+        hp_chunk_write(share, &writer, record + column->offset,
+                       column->length);
+        continue;
+      }
+    }
+    data_length= hp_column_data(column, record, &data);
+    hp_store_length(length_buff, column->length_bytes, data_length);
+    hp_chunk_write(share, &writer, length_buff, column->length_bytes);
+    hp_chunk_write(share, &writer, data, data_length);
+  }
+  hp_chunk_write(share, &writer, record + end_offset,
+                 share->reclength - end_offset);
+  DBUG_RETURN(0);
+}
+
+
+	/* Put a chain of chunks in the free list */
+
+void hp_free_var_part(HP_SHARE *share, uchar *chain)
+{
+  while (chain)
+  {
+    uchar *next= *((uchar**) chain);
+    *((uchar**) chain)= share->vdel_link;
+    share->vdel_link= chain;
+    share->vchunks--;
+    share->vdeleted++;
+    chain= next;
+  }
+}
+
+
+	/* Get first chunk of a row, 0 if it has none */
+
+uchar *hp_get_var_part(HP_SHARE *share, const uchar *pos)
+{
+  uchar *chain= 0;
+  if (share->var_chunk_length)
+    memcpy(&chain, pos + share->fixed_data_length, sizeof(uchar*));
+  return chain;
+}
+
+
+	/* Store a record and its packed part in a row */
+
+void hp_store_record(HP_SHARE *share, uchar *pos, const uchar *record,
+                     uchar *chain, uint length)
+{
+  memcpy(pos, record, (size_t) share->fixed_data_length);
+  if (share->var_chunk_length)
+  {
+    memcpy(pos + share->fixed_data_length, &chain, sizeof(uchar*));
+    int4store(pos + share->fixed_data_length + sizeof(uchar*), length);
+  }
+}
+
+
+/*
+  Read a record from a row
+
+  NOTE
+    BLOB columns point into info->var_buf, which is overwritten by the
+    next read through the same handle.
+
+  RETURN
+    0     OK
+    #     Error code
+*/
+
+int hp_extract_record(HP_INFO *info, uchar *record, const uchar *pos)
+{
+  HP_SHARE *share= info->s;
+  HP_COLUMNDEF *column, *end;
+  uchar *chunk, *from, *to;
+  uint var_length, left, copy, end_offset, data_length;
+  DBUG_ENTER("hp_extract_record");
+
+  memcpy(record, pos, (size_t) share->fixed_data_length);
+  if (!share->var_chunk_length)
+    DBUG_RETURN(0);
+
+  chunk= hp_get_var_part(share, pos);
+  var_length= uint4korr(pos + share->fixed_data_length + sizeof(uchar*));
+  if (var_length > info->var_buf_length)
+  {
+    uchar *buff;
+    if (!(buff= (uchar*) my_realloc(info->var_buf, var_length,
+                                    MYF(MY_ALLOW_ZERO_PTR))))
+      DBUG_RETURN(my_errno= HA_ERR_OUT_OF_MEM);
+    info->var_buf= buff;
+    info->var_buf_length= var_length;
+  }
+  for (to= info->var_buf, left= var_length ; left ; left-= copy, to+= copy)
+  {
+    DBUG_ASSERT(chunk);
+    copy= min(left, share->var_chunk_length);
+    memcpy(to, chunk + sizeof(uchar*), copy);
+    chunk= *((uchar**) chunk);
+  }
+
+  from= info->var_buf;
+  end_offset= share->fixed_data_length;
+  for (column= share->columndef, end= column + share->columns;
+       column < end; column++)
+  {
+    if (column->offset < share->fixed_data_length)
+    {
+      if (column->type != HP_COLUMN_BLOB)
+        continue;
+    }
+    else
+    {
+      memcpy(record + end_offset, from, column->offset - end_offset);
+      from+= column->offset - end_offset;
+      end_offset= column->offset + column->length;
+      if (column->type == HP_COLUMN_FIXED)
+      {
+        memcpy(record + column->offset, from, column->length);
+        from+= column->length;
+        continue;
+      }
+    }
+    to= record + column->offset;
+    memcpy(to, from, column->length_bytes);
+    data_length= hp_get_length(column->length_bytes, from);
+    from+= column->length_bytes;
+    if (column->type == HP_COLUMN_VARCHAR)
+      memcpy(to + column->length_bytes, from, data_length);
+    else
+      memcpy(to + column->length_bytes, &from, sizeof(uchar*));
+    from+= data_length;
+  }
+  memcpy(record + end_offset, from, share->reclength - end_offset);
+  DBUG_ASSERT(from + share->reclength - end_offset ==
+              info->var_buf + var_length);
+  DBUG_RETURN(0);
+}
@@ -67,7 +67,8 @@ int heap_rkey(HP_INFO *info, uchar *record, int inx, const uchar *key,
     if (!(keyinfo->flag & HA_NOSAME))
       memcpy(info->lastkey, key, (size_t) keyinfo->length);
   }
-  memcpy(record, pos, (size_t) share->reclength);
+  if (hp_extract_record(info, record, pos))
+    DBUG_RETURN(my_errno);
   info->update= HA_STATE_AKTIV;
   DBUG_RETURN(0);
 }
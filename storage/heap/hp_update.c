@@ -21,7 +21,8 @@
 int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
 {
   HP_KEYDEF *keydef, *end, *p_lastinx;
-  uchar *pos;
+  uchar *pos, *chain= 0, *old_chain;
+  uint var_length= 0;
   my_bool auto_key_changed= 0;
   HP_SHARE *share= info->s;
   DBUG_ENTER("heap_update");
@@ -31,6 +32,10 @@ int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
 
   if (info->opt_flag & READ_CHECK_USED && hp_rectest(info,old))
     DBUG_RETURN(my_errno);				/* Record changed */
+  /* Write the new variable-size part first, the old one stays on error */
+  if (share->var_chunk_length &&
+      hp_write_var_part(info, heap_new, &chain, &var_length))
+    DBUG_RETURN(my_errno);
   if (--(share->records) < share->blength >> 1) share->blength>>= 1;
   share->changed=1;
 
@@ -47,7 +52,9 @@ int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
     }
   }
 
-  memcpy(pos,heap_new,(size_t) share->reclength);
+  old_chain= hp_get_var_part(share, pos);
+  hp_store_record(share, pos, heap_new, chain, var_length);
+  hp_free_var_part(share, old_chain);
   if (++(share->records) == share->blength) share->blength+= share->blength;
 
 #if !defined(DBUG_OFF) && defined(EXTRA_HEAP_DEBUG)
@@ -66,6 +73,7 @@ int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
       /* we don't need to delete non-inserted key from rb-tree */
       if ((*keydef->write_key)(info, keydef, old, pos))
       {
+        hp_free_var_part(share, chain);
         if (++(share->records) == share->blength)
 	  share->blength+= share->blength;
         DBUG_RETURN(my_errno);
@@ -83,6 +91,7 @@ int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
       keydef--;
     }
   }
+  hp_free_var_part(share, chain);
   if (++(share->records) == share->blength)
     share->blength+= share->blength;
   DBUG_RETURN(my_errno);
@@ -33,7 +33,8 @@ static HASH_INFO *hp_find_free_hash(HP_SHARE *info, HP_BLOCK *block,
 int heap_write(HP_INFO *info, const uchar *record)
 {
   HP_KEYDEF *keydef, *end;
-  uchar *pos;
+  uchar *pos, *chain= 0;
+  uint var_length= 0;
   HP_SHARE *share=info->s;
   DBUG_ENTER("heap_write");
 #ifndef DBUG_OFF
@@ -42,8 +43,14 @@ int heap_write(HP_INFO *info, const uchar *record)
     DBUG_RETURN(my_errno=EACCES);
   }
 #endif
+  if (share->var_chunk_length &&
+      hp_write_var_part(info, record, &chain, &var_length))
+    DBUG_RETURN(my_errno);
   if (!(pos=next_free_record_pos(share)))
+  {
+    hp_free_var_part(share, chain);
     DBUG_RETURN(my_errno);
+  }
   share->changed=1;
 
   for (keydef = share->keydef, end = keydef + share->keys; keydef < end;
@@ -53,8 +60,8 @@ int heap_write(HP_INFO *info, const uchar *record)
       goto err;
   }
 
-  memcpy(pos,record,(size_t) share->reclength);
-  pos[share->reclength]=1;		/* Mark record as not deleted */
+  hp_store_record(share, pos, record, chain, var_length);
+  pos[share->visible]=1;		/* Mark record as not deleted */
   if (++share->records == share->blength)
     share->blength+= share->blength;
   info->current_ptr=pos;
@@ -88,10 +95,11 @@ err:
     keydef--;
   } 
 
+  hp_free_var_part(share, chain);
   share->deleted++;
   *((uchar**) pos)=share->del_link;
   share->del_link=pos;
-  pos[share->reclength]=0;			/* Record deleted */
+  pos[share->visible]=0;			/* Record deleted */
 
   DBUG_RETURN(my_errno);
 } /* heap_write */
@@ -44,7 +44,7 @@ Created 2/17/1996 Heikki Tuuri
 #include "ha0ha.h"
 
 /** Flag: has the search system been enabled?
-Protected by btr_search_latch. */
+Protected by the latches of all partitions. */
 UNIV_INTERN char		btr_search_enabled	= TRUE;
 
 #ifdef UNIV_PFS_MUTEX
@@ -62,30 +62,20 @@ UNIV_INTERN ulint		btr_search_n_succ	= 0;
 UNIV_INTERN ulint		btr_search_n_hash_fail	= 0;
 #endif /* UNIV_SEARCH_PERF_STAT */
 
-/** padding to prevent other memory update
-hotspots from residing on the same memory
-cache line as btr_search_latch */
-UNIV_INTERN byte		btr_sea_pad1[64];
-
-/** The latch protecting the adaptive search system: this latch protects the
-(1) positions of records on those pages where a hash index has been built.
+/** The adaptive hash index. Each partition has its own latch that
+protects the (1) positions of records on those pages where a hash index
+has been built for an index tree mapped to that partition.
 NOTE: It does not protect values of non-ordering fields within a record from
 being updated in-place! We can use fact (1) to perform unique searches to
 indexes. */
-
-/* We will allocate the latch from dynamic memory to get it to the
-same DRAM page as other hotspot semaphores */
-UNIV_INTERN rw_lock_t*		btr_search_latch_temp;
-
-/** padding to prevent other memory update hotspots from residing on
-the same memory cache line */
-UNIV_INTERN byte		btr_sea_pad2[64];
-
-/** The adaptive hash index */
 UNIV_INTERN btr_search_sys_t*	btr_search_sys;
 
+/** Number of adaptive hash index partitions to create at startup */
+UNIV_INTERN ulong		btr_search_n_parts	= 8;
+
 #ifdef UNIV_PFS_RWLOCK
-/* Key to register btr_search_sys with performance schema */
+/* Key to register the partition latches of btr_search_sys with
+performance schema */
 UNIV_INTERN mysql_pfs_key_t	btr_search_latch_key;
 #endif /* UNIV_PFS_RWLOCK */
 
@@ -127,20 +117,22 @@ allocate a new node to the hash table, it will succeed. However, the check
 will not guarantee success. */
 static
 void
-btr_search_check_free_space_in_heap(void)
-/*=====================================*/
+btr_search_check_free_space_in_heap(
+/*================================*/
+	const dict_index_t*	index)	/*!< in: index whose partition
+					is about to be modified */
 {
-	hash_table_t*	table;
-	mem_heap_t*	heap;
+	btr_search_part_t*	part;
+	mem_heap_t*		heap;
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!btr_search_own_any(RW_LOCK_SHARED));
+	ut_ad(!btr_search_own_any(RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
-	table = btr_search_sys->hash_index;
+	part = btr_search_get_part(index);
 
-	heap = table->heap;
+	heap = part->hash_index->heap;
 
 	/* Note that we peek the value of heap->free_block without reserving
 	the latch: this is ok, because we will not guarantee that there will
@@ -149,7 +141,7 @@ btr_search_check_free_space_in_heap(void)
 	if (heap->free_block == NULL) {
 		buf_block_t*	block = buf_block_alloc(NULL);
 
-		rw_lock_x_lock(&btr_search_latch);
+		rw_lock_x_lock(part->latch);
 
 		if (heap->free_block == NULL) {
 			heap->free_block = block;
@@ -157,9 +149,82 @@ btr_search_check_free_space_in_heap(void)
 			buf_block_free(block);
 		}
 
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(part->latch);
+	}
+}
+
+/*****************************************************************//**
+X-latches the latches of all adaptive hash index partitions, in the
+order of the partitions. */
+static
+void
+btr_search_x_lock_all(void)
+/*=======================*/
+{
+	ulint	i;
+
+	for (i = 0; i < btr_search_sys->n_parts; i++) {
+		rw_lock_x_lock(btr_search_sys->parts[i].latch);
+	}
+}
+
+/*****************************************************************//**
+Releases the latches of all adaptive hash index partitions. */
+static
+void
+btr_search_x_unlock_all(void)
+/*=========================*/
+{
+	ulint	i;
+
+	for (i = 0; i < btr_search_sys->n_parts; i++) {
+		rw_lock_x_unlock(btr_search_sys->parts[i].latch);
+	}
+}
+
+#ifdef UNIV_SYNC_DEBUG
+/********************************************************************//**
+Checks if the thread owns the latches of all adaptive hash index
+partitions in the given mode.
+@return	TRUE if all of them are owned */
+UNIV_INTERN
+ibool
+btr_search_own_all(
+/*===============*/
+	ulint	lock_type)	/*!< in: RW_LOCK_SHARED or RW_LOCK_EX */
+{
+	ulint	i;
+
+	for (i = 0; i < btr_search_sys->n_parts; i++) {
+		if (!rw_lock_own(btr_search_sys->parts[i].latch, lock_type)) {
+			return(FALSE);
+		}
+	}
+
+	return(TRUE);
+}
+
+/********************************************************************//**
+Checks if the thread owns the latch of any adaptive hash index
+partition in the given mode.
+@return	TRUE if some latch is owned */
+UNIV_INTERN
+ibool
+btr_search_own_any(
+/*===============*/
+	ulint	lock_type)	/*!< in: RW_LOCK_SHARED or RW_LOCK_EX */
+{
+	ulint	i;
+
+	for (i = 0; i < btr_search_sys->n_parts; i++) {
+		if (rw_lock_own(btr_search_sys->parts[i].latch, lock_type)) {
+			return(TRUE);
+		}
 	}
+
+	return(FALSE);
 }
+#endif /* UNIV_SYNC_DEBUG */
 
 /*****************************************************************//**
 Creates and initializes the adaptive search system at a database start. */
@@ -167,19 +232,35 @@ UNIV_INTERN
 void
 btr_search_sys_create(
 /*==================*/
-	ulint	hash_size)	/*!< in: hash index hash table size */
+	ulint	hash_size)	/*!< in: hash index hash table size,
+				summed over all partitions */
 {
-	/* We allocate the search latch from dynamic memory:
-	see above at the global variable definition */
+	ulint	i;
 
-	btr_search_latch_temp = mem_alloc(sizeof(rw_lock_t));
-
-	rw_lock_create(btr_search_latch_key, &btr_search_latch,
-		       SYNC_SEARCH_SYS);
+	ut_a(btr_search_n_parts > 0);
 
 	btr_search_sys = mem_alloc(sizeof(btr_search_sys_t));
 
-	btr_search_sys->hash_index = ha_create(hash_size, 0, 0);
+	btr_search_sys->n_parts = btr_search_n_parts;
+	btr_search_sys->parts = mem_zalloc(
+		btr_search_sys->n_parts * sizeof(btr_search_part_t));
+
+	for (i = 0; i < btr_search_sys->n_parts; i++) {
+		btr_search_part_t*	part = &btr_search_sys->parts[i];
+
+		/* We allocate each partition latch from dynamic memory
+		to get it to the same DRAM page as other hotspot
+		semaphores, and away from the latches of the other
+		partitions */
+
+		part->latch = mem_alloc(sizeof(rw_lock_t));
+
+		rw_lock_create(btr_search_latch_key, part->latch,
+			       SYNC_SEARCH_SYS);
+
+		part->hash_index = ha_create(
+			hash_size / btr_search_sys->n_parts, 0, 0);
+	}
 }
 
 /*****************************************************************//**
@@ -189,11 +270,18 @@ void
 btr_search_sys_free(void)
 /*=====================*/
 {
-	rw_lock_free(&btr_search_latch);
-	mem_free(btr_search_latch_temp);
-	btr_search_latch_temp = NULL;
-	mem_heap_free(btr_search_sys->hash_index->heap);
-	hash_table_free(btr_search_sys->hash_index);
+	ulint	i;
+
+	for (i = 0; i < btr_search_sys->n_parts; i++) {
+		btr_search_part_t*	part = &btr_search_sys->parts[i];
+
+		rw_lock_free(part->latch);
+		mem_free(part->latch);
+		mem_heap_free(part->hash_index->heap);
+		hash_table_free(part->hash_index);
+	}
+
+	mem_free(btr_search_sys->parts);
 	mem_free(btr_search_sys);
 	btr_search_sys = NULL;
 }
@@ -206,9 +294,10 @@ btr_search_disable(void)
 /*====================*/
 {
 	dict_table_t*	table;
+	ulint		i;
 
 	mutex_enter(&dict_sys->mutex);
-	rw_lock_x_lock(&btr_search_latch);
+	btr_search_x_lock_all();
 
 	btr_search_enabled = FALSE;
 
@@ -232,10 +321,15 @@ btr_search_disable(void)
 	buf_pool_clear_hash_index();
 
 	/* Clear the adaptive hash index. */
-	hash_table_clear(btr_search_sys->hash_index);
-	mem_heap_empty(btr_search_sys->hash_index->heap);
+	for (i = 0; i < btr_search_sys->n_parts; i++) {
+		hash_table_t*	hash_index
+			= btr_search_sys->parts[i].hash_index;
+
+		hash_table_clear(hash_index);
+		mem_heap_empty(hash_index->heap);
+	}
 
-	rw_lock_x_unlock(&btr_search_latch);
+	btr_search_x_unlock_all();
 }
 
 /********************************************************************//**
@@ -245,11 +339,11 @@ void
 btr_search_enable(void)
 /*====================*/
 {
-	rw_lock_x_lock(&btr_search_latch);
+	btr_search_x_lock_all();
 
 	btr_search_enabled = TRUE;
 
-	rw_lock_x_unlock(&btr_search_latch);
+	btr_search_x_unlock_all();
 }
 
 /*****************************************************************//**
@@ -295,26 +389,31 @@ btr_search_info_create(
 
 /*****************************************************************//**
 Returns the value of ref_count. The value is protected by
-btr_search_latch.
+the adaptive hash index partition latch of the index.
 @return	ref_count value. */
 UNIV_INTERN
 ulint
 btr_search_info_get_ref_count(
 /*==========================*/
-	btr_search_t*   info)	/*!< in: search info. */
+	btr_search_t*		info,	/*!< in: search info. */
+	const dict_index_t*	index)	/*!< in: index of info */
 {
-	ulint ret;
+	ulint		ret;
+	rw_lock_t*	latch;
 
 	ut_ad(info);
+	ut_ad(info == index->search_info);
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!btr_search_own_any(RW_LOCK_SHARED));
+	ut_ad(!btr_search_own_any(RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
-	rw_lock_s_lock(&btr_search_latch);
+	latch = btr_search_get_latch(index);
+
+	rw_lock_s_lock(latch);
 	ret = info->ref_count;
-	rw_lock_s_unlock(&btr_search_latch);
+	rw_lock_s_unlock(latch);
 
 	return(ret);
 }
@@ -335,8 +434,8 @@ btr_search_info_update_hash(
 	int		cmp;
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!btr_search_own_any(RW_LOCK_SHARED));
+	ut_ad(!btr_search_own_any(RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
 	index = cursor->index;
@@ -454,8 +553,8 @@ btr_search_update_block_hash_info(
 				/*!< in: cursor */
 {
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!btr_search_own_any(RW_LOCK_SHARED));
+	ut_ad(!btr_search_own_any(RW_LOCK_EX));
 	ut_ad(rw_lock_own(&block->lock, RW_LOCK_SHARED)
 	      || rw_lock_own(&block->lock, RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
@@ -539,7 +638,7 @@ btr_search_update_hash_ref(
 
 	ut_ad(cursor->flag == BTR_CUR_HASH_FAIL);
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(rw_lock_own(btr_search_get_latch(cursor->index), RW_LOCK_EX));
 	ut_ad(rw_lock_own(&(block->lock), RW_LOCK_SHARED)
 	      || rw_lock_own(&(block->lock), RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
@@ -579,12 +678,8 @@ btr_search_update_hash_ref(
 		if (UNIV_LIKELY_NULL(heap)) {
 			mem_heap_free(heap);
 		}
-#ifdef UNIV_SYNC_DEBUG
-		ut_ad(rw_lock_own(&btr_search_latch, RW_LOCK_EX));
-#endif /* UNIV_SYNC_DEBUG */
-
-		ha_insert_for_fold(btr_search_sys->hash_index, fold,
-				   block, rec);
+		ha_insert_for_fold(btr_search_get_part(index)->hash_index,
+				   fold, block, rec);
 	}
 }
 
@@ -603,8 +698,8 @@ btr_search_info_update_slow(
 	ulint*		params2;
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!btr_search_own_any(RW_LOCK_SHARED));
+	ut_ad(!btr_search_own_any(RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
 	block = btr_cur_get_block(cursor);
@@ -620,21 +715,23 @@ btr_search_info_update_slow(
 
 	if (build_index || (cursor->flag == BTR_CUR_HASH_FAIL)) {
 
-		btr_search_check_free_space_in_heap();
+		btr_search_check_free_space_in_heap(cursor->index);
 	}
 
 	if (cursor->flag == BTR_CUR_HASH_FAIL) {
+		rw_lock_t*	latch = btr_search_get_latch(cursor->index);
+
 		/* Update the hash node reference, if appropriate */
 
 #ifdef UNIV_SEARCH_PERF_STAT
 		btr_search_n_hash_fail++;
 #endif /* UNIV_SEARCH_PERF_STAT */
 
-		rw_lock_x_lock(&btr_search_latch);
+		rw_lock_x_lock(latch);
 
 		btr_search_update_hash_ref(info, block, cursor);
 
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(latch);
 	}
 
 	if (build_index) {
@@ -678,7 +775,8 @@ btr_search_check_guess(
 	ibool		can_only_compare_to_cursor_rec,
 				/*!< in: if we do not have a latch on the page
 				of cursor, but only a latch on
-				btr_search_latch, then ONLY the columns
+				the partition of the adaptive hash index,
+				then ONLY the columns
 				of the record UNDER the cursor are
 				protected, not the next or previous record
 				in the chain: we cannot look at the next or
@@ -833,15 +931,17 @@ btr_search_guess_on_hash(
 					to protect the record! */
 	btr_cur_t*	cursor,		/*!< out: tree cursor */
 	ulint		has_search_latch,/*!< in: latch mode the caller
-					currently has on btr_search_latch:
+					currently has on
+					btr_search_get_latch(index):
 					RW_S_LATCH, RW_X_LATCH, or 0 */
 	mtr_t*		mtr)		/*!< in: mtr */
 {
-	buf_pool_t*	buf_pool;
-	buf_block_t*	block;
-	const rec_t*	rec;
-	ulint		fold;
-	index_id_t	index_id;
+	buf_pool_t*		buf_pool;
+	buf_block_t*		block;
+	const rec_t*		rec;
+	ulint			fold;
+	index_id_t		index_id;
+	btr_search_part_t*	part;
 #ifdef notdefined
 	btr_cur_t	cursor2;
 	btr_pcur_t	pcur;
@@ -878,18 +978,20 @@ btr_search_guess_on_hash(
 	cursor->fold = fold;
 	cursor->flag = BTR_CUR_HASH;
 
+	part = btr_search_get_part(index);
+
 	if (UNIV_LIKELY(!has_search_latch)) {
-		rw_lock_s_lock(&btr_search_latch);
+		rw_lock_s_lock(part->latch);
 
 		if (UNIV_UNLIKELY(!btr_search_enabled)) {
 			goto failure_unlock;
 		}
 	}
 
-	ut_ad(rw_lock_get_writer(&btr_search_latch) != RW_LOCK_EX);
-	ut_ad(rw_lock_get_reader_count(&btr_search_latch) > 0);
+	ut_ad(rw_lock_get_writer(part->latch) != RW_LOCK_EX);
+	ut_ad(rw_lock_get_reader_count(part->latch) > 0);
 
-	rec = ha_search_and_get_data(btr_search_sys->hash_index, fold);
+	rec = ha_search_and_get_data(part->hash_index, fold);
 
 	if (UNIV_UNLIKELY(!rec)) {
 		goto failure_unlock;
@@ -907,7 +1009,7 @@ btr_search_guess_on_hash(
 			goto failure_unlock;
 		}
 
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(part->latch);
 
 		buf_block_dbg_add_level(block, SYNC_TREE_NODE_FROM_HASH);
 	}
@@ -929,7 +1031,7 @@ btr_search_guess_on_hash(
 
 	/* Check the validity of the guess within the page */
 
-	/* If we only have the latch on btr_search_latch, not on the
+	/* If we only have the latch on the hash index partition, not on the
 	page, it only protects the columns of the record the cursor
 	is positioned on. We cannot look at the next of the previous
 	record to determine if our guess for the cursor position is
@@ -984,6 +1086,7 @@ btr_search_guess_on_hash(
 	meanwhile! Thus it might not be a bug. */
 #endif
 	info->last_hash_succ = TRUE;
+	part->n_hash_succ++;
 
 #ifdef UNIV_SEARCH_PERF_STAT
 	btr_search_n_succ++;
@@ -1004,10 +1107,11 @@ btr_search_guess_on_hash(
 	/*-------------------------------------------*/
 failure_unlock:
 	if (UNIV_LIKELY(!has_search_latch)) {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(part->latch);
 	}
 failure:
 	cursor->flag = BTR_CUR_HASH_FAIL;
+	part->n_hash_fail++;
 
 #ifdef UNIV_SEARCH_PERF_STAT
 	info->n_hash_fail++;
@@ -1047,25 +1151,39 @@ btr_search_drop_page_hash_index(
 	mem_heap_t*		heap;
 	const dict_index_t*	index;
 	ulint*			offsets;
+	rw_lock_t*		latch;
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!btr_search_own_any(RW_LOCK_SHARED));
+	ut_ad(!btr_search_own_any(RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
 retry:
-	rw_lock_s_lock(&btr_search_latch);
+	/* We do a dirty read of block->index to find out which partition
+	latch to acquire. The page is latched by us or not fixed by anyone,
+	so that block->index can meanwhile only be reset to NULL, and it
+	is checked again below while holding the partition latch. */
 	index = block->index;
 
 	if (UNIV_LIKELY(!index)) {
 
-		rw_lock_s_unlock(&btr_search_latch);
+		return;
+	}
+
+	latch = btr_search_get_latch(index);
+
+	rw_lock_s_lock(latch);
+
+	if (UNIV_UNLIKELY(!block->index)) {
+
+		rw_lock_s_unlock(latch);
 
 		return;
 	}
 
+	ut_a(block->index == index);
 	ut_a(!dict_index_is_ibuf(index));
-	table = btr_search_sys->hash_index;
+	table = btr_search_get_part(index)->hash_index;
 
 #ifdef UNIV_SYNC_DEBUG
 	ut_ad(rw_lock_own(&(block->lock), RW_LOCK_SHARED)
@@ -1077,10 +1195,10 @@ retry:
 	n_bytes = block->curr_n_bytes;
 
 	/* NOTE: The fields of block must not be accessed after
-	releasing btr_search_latch, as the index page might only
+	releasing the partition latch, as the index page might only
 	be s-latched! */
 
-	rw_lock_s_unlock(&btr_search_latch);
+	rw_lock_s_unlock(latch);
 
 	ut_a(n_fields + n_bytes > 0);
 
@@ -1131,7 +1249,7 @@ next_rec:
 		mem_heap_free(heap);
 	}
 
-	rw_lock_x_lock(&btr_search_latch);
+	rw_lock_x_lock(latch);
 
 	if (UNIV_UNLIKELY(!block->index)) {
 		/* Someone else has meanwhile dropped the hash index */
@@ -1147,7 +1265,7 @@ next_rec:
 		/* Someone else has meanwhile built a new hash index on the
 		page, with different parameters */
 
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(latch);
 
 		mem_free(folds);
 		goto retry;
@@ -1174,14 +1292,14 @@ cleanup:
 			"InnoDB: the hash index to a page of %s,"
 			" still %lu hash nodes remain.\n",
 			index->name, (ulong) block->n_pointers);
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(latch);
 
 		ut_ad(btr_search_validate());
 	} else {
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(latch);
 	}
 #else /* UNIV_AHI_DEBUG || UNIV_DEBUG */
-	rw_lock_x_unlock(&btr_search_latch);
+	rw_lock_x_unlock(latch);
 #endif /* UNIV_AHI_DEBUG || UNIV_DEBUG */
 
 	mem_free(folds);
@@ -1254,36 +1372,39 @@ btr_search_build_page_hash_index(
 	mem_heap_t*	heap		= NULL;
 	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
 	ulint*		offsets		= offsets_;
+	rw_lock_t*	latch;
 	rec_offs_init(offsets_);
 
 	ut_ad(index);
 	ut_a(!dict_index_is_ibuf(index));
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!btr_search_own_any(RW_LOCK_EX));
 	ut_ad(rw_lock_own(&(block->lock), RW_LOCK_SHARED)
 	      || rw_lock_own(&(block->lock), RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
-	rw_lock_s_lock(&btr_search_latch);
+	latch = btr_search_get_latch(index);
+
+	rw_lock_s_lock(latch);
 
 	if (!btr_search_enabled) {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(latch);
 		return;
 	}
 
-	table = btr_search_sys->hash_index;
+	table = btr_search_get_part(index)->hash_index;
 	page = buf_block_get_frame(block);
 
 	if (block->index && ((block->curr_n_fields != n_fields)
 			     || (block->curr_n_bytes != n_bytes)
 			     || (block->curr_left_side != left_side))) {
 
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(latch);
 
 		btr_search_drop_page_hash_index(block);
 	} else {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(latch);
 	}
 
 	n_recs = page_get_n_recs(page);
@@ -1377,9 +1498,9 @@ btr_search_build_page_hash_index(
 		fold = next_fold;
 	}
 
-	btr_search_check_free_space_in_heap();
+	btr_search_check_free_space_in_heap(index);
 
-	rw_lock_x_lock(&btr_search_latch);
+	rw_lock_x_lock(latch);
 
 	if (UNIV_UNLIKELY(!btr_search_enabled)) {
 		goto exit_func;
@@ -1413,7 +1534,7 @@ btr_search_build_page_hash_index(
 	}
 
 exit_func:
-	rw_lock_x_unlock(&btr_search_latch);
+	rw_lock_x_unlock(latch);
 
 	mem_free(folds);
 	mem_free(recs);
@@ -1439,16 +1560,19 @@ btr_search_move_or_delete_hash_entries(
 					from this page */
 	dict_index_t*	index)		/*!< in: record descriptor */
 {
-	ulint	n_fields;
-	ulint	n_bytes;
-	ibool	left_side;
+	ulint		n_fields;
+	ulint		n_bytes;
+	ibool		left_side;
+	rw_lock_t*	latch;
 
 #ifdef UNIV_SYNC_DEBUG
 	ut_ad(rw_lock_own(&(block->lock), RW_LOCK_EX));
 	ut_ad(rw_lock_own(&(new_block->lock), RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
-	rw_lock_s_lock(&btr_search_latch);
+	latch = btr_search_get_latch(index);
+
+	rw_lock_s_lock(latch);
 
 	ut_a(!new_block->index || new_block->index == index);
 	ut_a(!block->index || block->index == index);
@@ -1457,7 +1581,7 @@ btr_search_move_or_delete_hash_entries(
 
 	if (new_block->index) {
 
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(latch);
 
 		btr_search_drop_page_hash_index(block);
 
@@ -1474,7 +1598,7 @@ btr_search_move_or_delete_hash_entries(
 		new_block->n_bytes = block->curr_n_bytes;
 		new_block->left_side = left_side;
 
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(latch);
 
 		ut_a(n_fields + n_bytes > 0);
 
@@ -1486,7 +1610,7 @@ btr_search_move_or_delete_hash_entries(
 		return;
 	}
 
-	rw_lock_s_unlock(&btr_search_latch);
+	rw_lock_s_unlock(latch);
 }
 
 /********************************************************************//**
@@ -1499,13 +1623,14 @@ btr_search_update_hash_on_delete(
 				record to delete using btr_cur_search_...,
 				the record is not yet deleted */
 {
-	hash_table_t*	table;
-	buf_block_t*	block;
-	const rec_t*	rec;
-	ulint		fold;
-	dict_index_t*	index;
-	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
-	mem_heap_t*	heap		= NULL;
+	hash_table_t*		table;
+	btr_search_part_t*	part;
+	buf_block_t*		block;
+	const rec_t*		rec;
+	ulint			fold;
+	dict_index_t*		index;
+	ulint			offsets_[REC_OFFS_NORMAL_SIZE];
+	mem_heap_t*		heap		= NULL;
 	rec_offs_init(offsets_);
 
 	block = btr_cur_get_block(cursor);
@@ -1525,7 +1650,8 @@ btr_search_update_hash_on_delete(
 	ut_a(block->curr_n_fields + block->curr_n_bytes > 0);
 	ut_a(!dict_index_is_ibuf(index));
 
-	table = btr_search_sys->hash_index;
+	part = btr_search_get_part(index);
+	table = part->hash_index;
 
 	rec = btr_cur_get_rec(cursor);
 
@@ -1536,7 +1662,7 @@ btr_search_update_hash_on_delete(
 		mem_heap_free(heap);
 	}
 
-	rw_lock_x_lock(&btr_search_latch);
+	rw_lock_x_lock(part->latch);
 
 	if (block->index) {
 		ut_a(block->index == index);
@@ -1544,7 +1670,7 @@ btr_search_update_hash_on_delete(
 		ha_search_and_delete_if_found(table, fold, rec);
 	}
 
-	rw_lock_x_unlock(&btr_search_latch);
+	rw_lock_x_unlock(part->latch);
 }
 
 /********************************************************************//**
@@ -1558,10 +1684,11 @@ btr_search_update_hash_node_on_insert(
 				and the new record has been inserted next
 				to the cursor */
 {
-	hash_table_t*	table;
-	buf_block_t*	block;
-	dict_index_t*	index;
-	rec_t*		rec;
+	hash_table_t*		table;
+	btr_search_part_t*	part;
+	buf_block_t*		block;
+	dict_index_t*		index;
+	rec_t*			rec;
 
 	rec = btr_cur_get_rec(cursor);
 
@@ -1581,7 +1708,9 @@ btr_search_update_hash_node_on_insert(
 	ut_a(cursor->index == index);
 	ut_a(!dict_index_is_ibuf(index));
 
-	rw_lock_x_lock(&btr_search_latch);
+	part = btr_search_get_part(index);
+
+	rw_lock_x_lock(part->latch);
 
 	if (!block->index) {
 
@@ -1595,15 +1724,15 @@ btr_search_update_hash_node_on_insert(
 	    && (cursor->n_bytes == block->curr_n_bytes)
 	    && !block->curr_left_side) {
 
-		table = btr_search_sys->hash_index;
+		table = part->hash_index;
 
 		ha_search_and_update_if_found(table, cursor->fold, rec,
 					      block, page_rec_get_next(rec));
 
 func_exit:
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(part->latch);
 	} else {
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(part->latch);
 
 		btr_search_update_hash_on_insert(cursor);
 	}
@@ -1633,14 +1762,16 @@ btr_search_update_hash_on_insert(
 	ulint		n_bytes;
 	ibool		left_side;
 	ibool		locked		= FALSE;
+	rw_lock_t*	latch;
 	mem_heap_t*	heap		= NULL;
 	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
 	ulint*		offsets		= offsets_;
 	rec_offs_init(offsets_);
 
-	table = btr_search_sys->hash_index;
+	table = btr_search_get_part(cursor->index)->hash_index;
+	latch = btr_search_get_latch(cursor->index);
 
-	btr_search_check_free_space_in_heap();
+	btr_search_check_free_space_in_heap(cursor->index);
 
 	rec = btr_cur_get_rec(cursor);
 
@@ -1685,7 +1816,7 @@ btr_search_update_hash_on_insert(
 	} else {
 		if (left_side) {
 
-			rw_lock_x_lock(&btr_search_latch);
+			rw_lock_x_lock(latch);
 
 			locked = TRUE;
 
@@ -1703,7 +1834,7 @@ btr_search_update_hash_on_insert(
 
 		if (!locked) {
 
-			rw_lock_x_lock(&btr_search_latch);
+			rw_lock_x_lock(latch);
 
 			locked = TRUE;
 
@@ -1725,7 +1856,7 @@ check_next_rec:
 		if (!left_side) {
 
 			if (!locked) {
-				rw_lock_x_lock(&btr_search_latch);
+				rw_lock_x_lock(latch);
 
 				locked = TRUE;
 
@@ -1744,7 +1875,7 @@ check_next_rec:
 
 		if (!locked) {
 
-			rw_lock_x_lock(&btr_search_latch);
+			rw_lock_x_lock(latch);
 
 			locked = TRUE;
 
@@ -1771,18 +1902,19 @@ function_exit:
 		mem_heap_free(heap);
 	}
 	if (locked) {
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(latch);
 	}
 }
 
 #if defined UNIV_AHI_DEBUG || defined UNIV_DEBUG
 /********************************************************************//**
-Validates the search system.
+Validates a partition of the search system.
 @return	TRUE if ok */
-UNIV_INTERN
+static
 ibool
-btr_search_validate(void)
+btr_search_validate_part(
 /*=====================*/
+	btr_search_part_t*	part)	/*!< in: partition to validate */
 {
 	ha_node_t*	node;
 	ulint		n_page_dumps	= 0;
@@ -1794,28 +1926,28 @@ btr_search_validate(void)
 	ulint*		offsets		= offsets_;
 
 	/* How many cells to check before temporarily releasing
-	btr_search_latch. */
+	the partition latch. */
 	ulint		chunk_size = 10000;
 
 	rec_offs_init(offsets_);
 
-	rw_lock_x_lock(&btr_search_latch);
+	rw_lock_x_lock(part->latch);
 	buf_pool_mutex_enter_all();
 
-	cell_count = hash_get_n_cells(btr_search_sys->hash_index);
+	cell_count = hash_get_n_cells(part->hash_index);
 
 	for (i = 0; i < cell_count; i++) {
-		/* We release btr_search_latch every once in a while to
+		/* We release the partition latch every once in a while to
 		give other queries a chance to run. */
 		if ((i != 0) && ((i % chunk_size) == 0)) {
 			buf_pool_mutex_exit_all();
-			rw_lock_x_unlock(&btr_search_latch);
+			rw_lock_x_unlock(part->latch);
 			os_thread_yield();
-			rw_lock_x_lock(&btr_search_latch);
+			rw_lock_x_lock(part->latch);
 			buf_pool_mutex_enter_all();
 		}
 
-		node = hash_get_nth_cell(btr_search_sys->hash_index, i)->node;
+		node = hash_get_nth_cell(part->hash_index, i)->node;
 
 		for (; node != NULL; node = node->next) {
 			const buf_block_t*	block
@@ -1853,7 +1985,7 @@ btr_search_validate(void)
 				After that, it invokes
 				btr_search_drop_page_hash_index() to
 				remove the block from
-				btr_search_sys->hash_index. */
+				the adaptive hash index. */
 
 				ut_a(buf_block_get_state(block)
 				     == BUF_BLOCK_REMOVE_HASH);
@@ -1920,27 +2052,47 @@ btr_search_validate(void)
 	for (i = 0; i < cell_count; i += chunk_size) {
 		ulint end_index = ut_min(i + chunk_size - 1, cell_count - 1);
 
-		/* We release btr_search_latch every once in a while to
+		/* We release the partition latch every once in a while to
 		give other queries a chance to run. */
 		if (i != 0) {
 			buf_pool_mutex_exit_all();
-			rw_lock_x_unlock(&btr_search_latch);
+			rw_lock_x_unlock(part->latch);
 			os_thread_yield();
-			rw_lock_x_lock(&btr_search_latch);
+			rw_lock_x_lock(part->latch);
 			buf_pool_mutex_enter_all();
 		}
 
-		if (!ha_validate(btr_search_sys->hash_index, i, end_index)) {
+		if (!ha_validate(part->hash_index, i, end_index)) {
 			ok = FALSE;
 		}
 	}
 
 	buf_pool_mutex_exit_all();
-	rw_lock_x_unlock(&btr_search_latch);
+	rw_lock_x_unlock(part->latch);
 	if (UNIV_LIKELY_NULL(heap)) {
 		mem_heap_free(heap);
 	}
 
 	return(ok);
 }
+
+/********************************************************************//**
+Validates the search system.
+@return	TRUE if ok */
+UNIV_INTERN
+ibool
+btr_search_validate(void)
+/*=====================*/
+{
+	ibool	ok	= TRUE;
+	ulint	i;
+
+	for (i = 0; i < btr_search_sys->n_parts; i++) {
+		if (!btr_search_validate_part(&btr_search_sys->parts[i])) {
+			ok = FALSE;
+		}
+	}
+
+	return(ok);
+}
 #endif /* defined UNIV_AHI_DEBUG || defined UNIV_DEBUG */
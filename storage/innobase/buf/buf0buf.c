@@ -51,6 +51,7 @@ Created 11/5/1995 Heikki Tuuri
 #include "dict0dict.h"
 #include "log0recv.h"
 #include "page0zip.h"
+#include "ut0crc32.h"
 
 /*
 		IMPLEMENTATION OF THE BUFFER POOL
@@ -513,6 +514,99 @@ buf_calc_page_old_checksum(
 	return(checksum);
 }
 
+/********************************************************************//**
+Calculates the CRC32C checksum of a page. The value is stored to the page
+when it is written to a file with innodb_checksum_algorithm=crc32, both to
+FIL_PAGE_SPACE_OR_CHKSUM and to the old formula checksum field at the end
+of the page.
+@return	checksum */
+UNIV_INTERN
+ib_uint32_t
+buf_calc_page_crc32(
+/*================*/
+	const byte*	page)	/*!< in: buffer page */
+{
+	ib_uint32_t	checksum;
+
+	/* The same fields are skipped as in buf_calc_page_new_checksum():
+	FIL_PAGE_SPACE_OR_CHKSUM, FIL_PAGE_FILE_FLUSH_LSN and the last
+	8 bytes of the page, where the checksum and the low 32 bits of
+	the lsn are stored. */
+
+	checksum = ut_crc32(page + FIL_PAGE_OFFSET,
+			    FIL_PAGE_FILE_FLUSH_LSN - FIL_PAGE_OFFSET)
+		^ ut_crc32(page + FIL_PAGE_DATA,
+			   UNIV_PAGE_SIZE - FIL_PAGE_DATA
+			   - FIL_PAGE_END_LSN_OLD_CHKSUM);
+
+	return(checksum);
+}
+
+/********************************************************************//**
+Checks if the page carries a valid crc32 checksum.
+@return	TRUE if the page checksum is a valid crc32 checksum */
+static
+ibool
+buf_page_is_checksum_valid_crc32(
+/*=============================*/
+	const byte*	read_buf,		/*!< in: a database page */
+	ulint		checksum_field,		/*!< in: stored
+						FIL_PAGE_SPACE_OR_CHKSUM */
+	ulint		old_checksum_field)	/*!< in: stored checksum
+						at the end of the page */
+{
+	/* The crc32 algorithm stores the same value to both fields,
+	which a page written with the innodb algorithm practically
+	never does. Only compute the crc32 if the fields agree. */
+
+	return(checksum_field == old_checksum_field
+	       && checksum_field == buf_calc_page_crc32(read_buf));
+}
+
+/********************************************************************//**
+Checks if the page carries valid innodb checksums.
+@return	TRUE if the page checksums are valid innodb checksums */
+static
+ibool
+buf_page_is_checksum_valid_innodb(
+/*==============================*/
+	const byte*	read_buf,		/*!< in: a database page */
+	ulint		checksum_field,		/*!< in: stored
+						FIL_PAGE_SPACE_OR_CHKSUM */
+	ulint		old_checksum_field)	/*!< in: stored checksum
+						at the end of the page */
+{
+	/* There are 2 valid formulas for old_checksum_field:
+
+	1. Very old versions of InnoDB only stored 8 byte lsn to the
+	start and the end of the page.
+
+	2. Newer InnoDB versions store the old formula checksum
+	there. */
+
+	if (old_checksum_field != mach_read_from_4(read_buf
+						   + FIL_PAGE_LSN)
+	    && old_checksum_field != BUF_NO_CHECKSUM_MAGIC
+	    && old_checksum_field
+	    != buf_calc_page_old_checksum(read_buf)) {
+
+		return(FALSE);
+	}
+
+	/* InnoDB versions < 4.0.14 and < 4.1.1 stored the space id
+	(always equal to 0), to FIL_PAGE_SPACE_OR_CHKSUM */
+
+	if (checksum_field != 0
+	    && checksum_field != BUF_NO_CHECKSUM_MAGIC
+	    && checksum_field
+	    != buf_calc_page_new_checksum(read_buf)) {
+
+		return(FALSE);
+	}
+
+	return(TRUE);
+}
+
 /********************************************************************//**
 Checks if a page is corrupt.
 @return	TRUE if corrupted */
@@ -572,49 +666,42 @@ buf_page_is_corrupted(
 	/* If we use checksums validation, make additional check before
 	returning TRUE to ensure that the checksum is not equal to
 	BUF_NO_CHECKSUM_MAGIC which might be stored by InnoDB with checksums
-	disabled. Otherwise, skip checksum calculation and return FALSE */
+	disabled. Otherwise, skip checksum calculation and return FALSE.
+	Whatever innodb_checksum_algorithm is set to, pages written with
+	any of the algorithms are accepted; the configured one is only
+	tried first. */
 
 	if (UNIV_LIKELY(srv_use_checksums)) {
-		checksum_field = mach_read_from_4(read_buf
-						  + FIL_PAGE_SPACE_OR_CHKSUM);
-
 		if (UNIV_UNLIKELY(zip_size)) {
-			return(checksum_field != BUF_NO_CHECKSUM_MAGIC
-			       && checksum_field
-			       != page_zip_calc_checksum(read_buf, zip_size));
+			return(!page_zip_verify_checksum(read_buf, zip_size));
 		}
 
+		checksum_field = mach_read_from_4(read_buf
+						  + FIL_PAGE_SPACE_OR_CHKSUM);
+
 		old_checksum_field = mach_read_from_4(
 			read_buf + UNIV_PAGE_SIZE
 			- FIL_PAGE_END_LSN_OLD_CHKSUM);
 
-		/* There are 2 valid formulas for old_checksum_field:
-
-		1. Very old versions of InnoDB only stored 8 byte lsn to the
-		start and the end of the page.
-
-		2. Newer InnoDB versions store the old formula checksum
-		there. */
+		if (checksum_field == BUF_NO_CHECKSUM_MAGIC
+		    && old_checksum_field == BUF_NO_CHECKSUM_MAGIC) {
 
-		if (old_checksum_field != mach_read_from_4(read_buf
-							   + FIL_PAGE_LSN)
-		    && old_checksum_field != BUF_NO_CHECKSUM_MAGIC
-		    && old_checksum_field
-		    != buf_calc_page_old_checksum(read_buf)) {
-
-			return(TRUE);
+			return(FALSE);
 		}
 
-		/* InnoDB versions < 4.0.14 and < 4.1.1 stored the space id
-		(always equal to 0), to FIL_PAGE_SPACE_OR_CHKSUM */
-
-		if (checksum_field != 0
-		    && checksum_field != BUF_NO_CHECKSUM_MAGIC
-		    && checksum_field
-		    != buf_calc_page_new_checksum(read_buf)) {
-
-			return(TRUE);
+		if (srv_checksum_algorithm == SRV_CHECKSUM_ALGORITHM_CRC32) {
+			return(!buf_page_is_checksum_valid_crc32(
+				       read_buf, checksum_field,
+				       old_checksum_field)
+			       && !buf_page_is_checksum_valid_innodb(
+				       read_buf, checksum_field,
+				       old_checksum_field));
 		}
+
+		return(!buf_page_is_checksum_valid_innodb(
+			       read_buf, checksum_field, old_checksum_field)
+		       && !buf_page_is_checksum_valid_crc32(
+			       read_buf, checksum_field, old_checksum_field));
 	}
 
 	return(FALSE);
@@ -639,6 +726,7 @@ buf_page_print(
 #endif /* !UNIV_HOTBACKUP */
 	ulint		checksum;
 	ulint		old_checksum;
+	ulint		crc32_checksum;
 	ulint		size	= zip_size;
 
 	if (!size) {
@@ -661,7 +749,9 @@ buf_page_print(
 		case FIL_PAGE_TYPE_ZBLOB:
 		case FIL_PAGE_TYPE_ZBLOB2:
 			checksum = srv_use_checksums
-				? page_zip_calc_checksum(read_buf, zip_size)
+				? page_zip_calc_checksum(
+					read_buf, zip_size,
+					srv_checksum_algorithm)
 				: BUF_NO_CHECKSUM_MAGIC;
 			ut_print_timestamp(stderr);
 			fprintf(stderr,
@@ -694,7 +784,9 @@ buf_page_print(
 			/* fall through */
 		case FIL_PAGE_INDEX:
 			checksum = srv_use_checksums
-				? page_zip_calc_checksum(read_buf, zip_size)
+				? page_zip_calc_checksum(
+					read_buf, zip_size,
+					srv_checksum_algorithm)
 				: BUF_NO_CHECKSUM_MAGIC;
 
 			ut_print_timestamp(stderr);
@@ -729,11 +821,13 @@ buf_page_print(
 		? buf_calc_page_new_checksum(read_buf) : BUF_NO_CHECKSUM_MAGIC;
 	old_checksum = srv_use_checksums
 		? buf_calc_page_old_checksum(read_buf) : BUF_NO_CHECKSUM_MAGIC;
+	crc32_checksum = srv_use_checksums
+		? buf_calc_page_crc32(read_buf) : BUF_NO_CHECKSUM_MAGIC;
 
 	ut_print_timestamp(stderr);
 	fprintf(stderr,
 		"  InnoDB: Page checksum %lu, prior-to-4.0.14-form"
-		" checksum %lu\n"
+		" checksum %lu, crc32 checksum %lu\n"
 		"InnoDB: stored checksum %lu, prior-to-4.0.14-form"
 		" stored checksum %lu\n"
 		"InnoDB: Page lsn %lu %lu, low 4 bytes of lsn"
@@ -742,6 +836,7 @@ buf_page_print(
 		"InnoDB: space id (if created with >= MySQL-4.1.1"
 		" and stored already) %lu\n",
 		(ulong) checksum, (ulong) old_checksum,
+		(ulong) crc32_checksum,
 		(ulong) mach_read_from_4(read_buf + FIL_PAGE_SPACE_OR_CHKSUM),
 		(ulong) mach_read_from_4(read_buf + UNIV_PAGE_SIZE
 					 - FIL_PAGE_END_LSN_OLD_CHKSUM),
@@ -1302,6 +1397,9 @@ buf_pool_init(
 	the buffer pools and also used as a waiting object during flushing. */
 	buf_pool_ptr = mem_zalloc(n_instances * sizeof *buf_pool_ptr);
 
+	buf_flush_event = os_event_create(NULL);
+	buf_flush_LRU_event = os_event_create(NULL);
+
 	for (i = 0; i < n_instances; i++) {
 		buf_pool_t*	ptr	= &buf_pool_ptr[i];
 
@@ -1351,7 +1449,7 @@ buf_pool_clear_hash_index(void)
 	ulint	p;
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(btr_search_own_all(RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 	ut_ad(!btr_search_enabled);
 
@@ -1368,8 +1466,9 @@ buf_pool_clear_hash_index(void)
 				dict_index_t*	index	= block->index;
 
 				/* We can set block->index = NULL
-				when we have an x-latch on btr_search_latch;
-				see the comment in buf0buf.h */
+				when we have an x-latch on the partition
+				latch of the index; see the comment in
+				buf0buf.h */
 
 				if (!index) {
 					/* Not hashed */
@@ -1964,19 +2063,24 @@ buf_zip_decompress(
 	ut_ad(buf_block_get_zip_size(block));
 	ut_a(buf_block_get_space(block) != 0);
 
-	if (UNIV_LIKELY(check && stamp_checksum != BUF_NO_CHECKSUM_MAGIC)) {
-		ulint	calc_checksum	= page_zip_calc_checksum(
-			frame, page_zip_get_size(&block->page.zip));
+	if (UNIV_UNLIKELY(check
+			  && !page_zip_verify_checksum(
+				  frame,
+				  page_zip_get_size(&block->page.zip)))) {
+		ulint	size	= page_zip_get_size(&block->page.zip);
 
-		if (UNIV_UNLIKELY(stamp_checksum != calc_checksum)) {
-			ut_print_timestamp(stderr);
-			fprintf(stderr,
-				"  InnoDB: compressed page checksum mismatch"
-				" (space %u page %u): %lu != %lu\n",
-				block->page.space, block->page.offset,
-				stamp_checksum, calc_checksum);
-			return(FALSE);
-		}
+		ut_print_timestamp(stderr);
+		fprintf(stderr,
+			"  InnoDB: compressed page checksum mismatch"
+			" (space %u page %u): stored: %lu, crc32: %lu,"
+			" innodb: %lu\n",
+			block->page.space, block->page.offset,
+			stamp_checksum,
+			page_zip_calc_checksum(
+				frame, size, SRV_CHECKSUM_ALGORITHM_CRC32),
+			page_zip_calc_checksum(
+				frame, size, SRV_CHECKSUM_ALGORITHM_INNODB));
+		return(FALSE);
 	}
 
 	switch (fil_page_get_type(frame)) {
@@ -3404,9 +3508,6 @@ buf_page_create(
 
 	ibuf_merge_or_delete_for_page(NULL, space, offset, zip_size, TRUE);
 
-	/* Flush pages from the end of the LRU list if necessary */
-	buf_flush_free_margin(buf_pool);
-
 	frame = block->frame;
 
 	memset(frame + FIL_PAGE_PREV, 0xff, 4);
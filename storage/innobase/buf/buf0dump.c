@@ -0,0 +1,731 @@
+/*****************************************************************************
+
+Copyright (c) 2012, Oracle and/or its affiliates. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file buf/buf0dump.c
+Implements a buffer pool dump/load.
+
+A dump copies the (space, page_no) of every page in the LRU list of each
+buffer pool instance while holding that instance's mutex, and then writes
+the copy out to a text file without holding any latches. The file is first
+written as <name>.incomplete and renamed when complete, so that a crash
+in the middle of a dump never leaves a truncated dump behind.
+
+A load reads the file, sorts the entries by (space, page_no) so that the
+reads are as sequential as possible, and issues them in batches of
+asynchronous reads. Between batches the load is throttled to
+innodb_io_capacity pages per second while there is user activity, so that
+warming up the buffer pool does not starve foreground I/O.
+*******************************************************/
+
+#include "buf0dump.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <errno.h>
+
+#include "buf0buf.h"
+#include "buf0rea.h"
+#include "srv0srv.h"
+#include "srv0start.h"
+#include "os0sync.h"
+#include "os0thread.h"
+#include "ut0byte.h"
+#include "ut0mem.h"
+#include "ut0sort.h"
+#include "ut0ut.h"
+
+/** Flags that tell the buffer pool dump/load thread which action it
+should take after being waked up. */
+static ibool	buf_dump_should_start = FALSE;
+static ibool	buf_load_should_start = FALSE;
+
+/** Set by buf_load_abort() to make a running load stop */
+static ibool	buf_load_abort_flag = FALSE;
+
+/** Human readable progress of the last dump and load, shown in
+SHOW STATUS as innodb_buffer_pool_dump_status and
+innodb_buffer_pool_load_status */
+static char	buf_dump_status_str[512];
+static char	buf_load_status_str[512];
+
+/** TRUE while the buffer pool dump/load thread is running */
+UNIV_INTERN ibool	buf_dump_thread_active = FALSE;
+
+#ifdef UNIV_PFS_THREAD
+UNIV_INTERN mysql_pfs_key_t	buf_dump_thread_key;
+#endif /* UNIV_PFS_THREAD */
+
+/** Number of pages to read in with one buf_read_load_pages() call */
+#define BUF_LOAD_BATCH		64
+
+/** Severity of a status message. Messages above STATUS_INFO are also
+written to the error log. */
+enum status_severity {
+	STATUS_INFO,
+	STATUS_NOTICE,
+	STATUS_ERR
+};
+
+/* A dump entry packs the space id into the high and the page number into
+the low 32 bits, so that sorting the entries as integers sorts them by
+(space, page_no). */
+#define BUF_DUMP_CREATE(space, page)	ut_ull_create(space, page)
+#define BUF_DUMP_SPACE(a)		((ulint) ((a) >> 32))
+#define BUF_DUMP_PAGE(a)		((ulint) ((a) & 0xFFFFFFFFUL))
+
+/** TRUE if the server is shutting down */
+#define SHUTTING_DOWN()	(srv_shutdown_state != SRV_SHUTDOWN_NONE)
+
+/*****************************************************************//**
+Wakes up the buffer pool dump/load thread and instructs it to start
+a dump. This function is called by MySQL code via buffer_pool_dump_now()
+and it should return immediately because the whole MySQL is frozen during
+its execution. */
+UNIV_INTERN
+void
+buf_dump_start(void)
+/*================*/
+{
+	buf_dump_should_start = TRUE;
+	os_event_set(srv_buf_dump_event);
+}
+
+/*****************************************************************//**
+Wakes up the buffer pool dump/load thread and instructs it to start
+a load. This function is called by MySQL code via buffer_pool_load_now()
+and it should return immediately because the whole MySQL is frozen during
+its execution. */
+UNIV_INTERN
+void
+buf_load_start(void)
+/*================*/
+{
+	buf_load_should_start = TRUE;
+	os_event_set(srv_buf_dump_event);
+}
+
+/*****************************************************************//**
+Aborts a currently running buffer pool load. This function is called by
+MySQL code via buffer_pool_load_abort() and it should return immediately
+because the whole MySQL is frozen during its execution. */
+UNIV_INTERN
+void
+buf_load_abort(void)
+/*================*/
+{
+	buf_load_abort_flag = TRUE;
+}
+
+/*****************************************************************//**
+Copies the current dump and load status messages, to be shown in
+SHOW STATUS. */
+UNIV_INTERN
+void
+buf_dump_status_get(
+/*================*/
+	char*	dump_status,	/*!< out: dump status */
+	ulint	dump_size,	/*!< in: size of dump_status */
+	char*	load_status,	/*!< out: load status */
+	ulint	load_size)	/*!< in: size of load_status */
+{
+	ut_strlcpy(dump_status, buf_dump_status_str, dump_size);
+	ut_strlcpy(load_status, buf_load_status_str, load_size);
+}
+
+/*****************************************************************//**
+Formats a status message into the given buffer and, unless it is only
+informational, prints it to the error log. */
+static
+void
+buf_dump_set_status(
+/*================*/
+	char*			str,		/*!< out: status buffer */
+	ulint			size,		/*!< in: size of str */
+	enum status_severity	severity,	/*!< in: severity */
+	const char*		fmt,		/*!< in: format */
+	va_list			ap)		/*!< in: format values */
+{
+	ut_vsnprintf(str, size, fmt, ap);
+
+	if (severity > STATUS_INFO) {
+		ut_print_timestamp(stderr);
+		fprintf(stderr, "  InnoDB: %s\n", str);
+	}
+}
+
+/*****************************************************************//**
+Sets the status of the buffer pool dump. */
+static
+void
+buf_dump_status(
+/*============*/
+	enum status_severity	severity,	/*!< in: severity */
+	const char*		fmt,		/*!< in: format */
+	...)					/*!< in: format values */
+{
+	va_list	ap;
+
+	va_start(ap, fmt);
+	buf_dump_set_status(buf_dump_status_str, sizeof buf_dump_status_str,
+			    severity, fmt, ap);
+	va_end(ap);
+}
+
+/*****************************************************************//**
+Sets the status of the buffer pool load. */
+static
+void
+buf_load_status(
+/*============*/
+	enum status_severity	severity,	/*!< in: severity */
+	const char*		fmt,		/*!< in: format */
+	...)					/*!< in: format values */
+{
+	va_list	ap;
+
+	va_start(ap, fmt);
+	buf_dump_set_status(buf_load_status_str, sizeof buf_load_status_str,
+			    severity, fmt, ap);
+	va_end(ap);
+}
+
+/*****************************************************************//**
+Builds the full path of the dump file from innodb_data_home_dir and
+innodb_buffer_pool_filename. */
+static
+void
+buf_dump_get_path(
+/*==============*/
+	char*	path,	/*!< out: full path of the dump file */
+	ulint	size)	/*!< in: size of path */
+{
+	const char*	home	= srv_data_home;
+	ulint		len	= strlen(home);
+
+	if (len > 0 && home[len - 1] != SRV_PATH_SEPARATOR) {
+		ut_snprintf(path, size, "%s%c%s", home, SRV_PATH_SEPARATOR,
+			    srv_buf_dump_filename);
+	} else {
+		ut_snprintf(path, size, "%s%s", home, srv_buf_dump_filename);
+	}
+}
+
+/*****************************************************************//**
+Performs a buffer pool dump into the file specified by
+innodb_buffer_pool_filename. If any errors occur then the value of
+innodb_buffer_pool_dump_status will be set accordingly, see
+buf_dump_status(). The dump filename can be specified by (relative to
+innodb_data_home_dir):
+SET GLOBAL innodb_buffer_pool_filename='filename'; */
+static
+void
+buf_dump(
+/*=====*/
+	ibool	obey_shutdown)	/*!< in: quit if we are in a shutting down
+				state */
+{
+#define SHOULD_QUIT()	(SHUTTING_DOWN() && obey_shutdown)
+
+	char	full_filename[OS_FILE_MAX_PATH];
+	char	tmp_filename[OS_FILE_MAX_PATH + sizeof ".incomplete"];
+	char	now[32];
+	FILE*	f;
+	ulint	i;
+	int	ret;
+
+	buf_dump_get_path(full_filename, sizeof full_filename);
+
+	ut_snprintf(tmp_filename, sizeof tmp_filename,
+		    "%s.incomplete", full_filename);
+
+	buf_dump_status(STATUS_NOTICE, "Dumping buffer pool(s) to %s",
+			full_filename);
+
+	f = fopen(tmp_filename, "w");
+	if (f == NULL) {
+		buf_dump_status(STATUS_ERR,
+				"Cannot open '%s' for writing: %s",
+				tmp_filename, strerror(errno));
+		return;
+	}
+	/* else */
+
+	/* walk through each buffer pool */
+	for (i = 0; i < srv_buf_pool_instances && !SHOULD_QUIT(); i++) {
+		buf_pool_t*		buf_pool;
+		const buf_page_t*	bpage;
+		ib_uint64_t*		dump;
+		ulint			n_pages;
+		ulint			j;
+
+		buf_pool = buf_pool_from_array(i);
+
+		/* obtain buf_pool mutex before allocate, since
+		UT_LIST_GET_LEN(buf_pool->LRU) could change */
+		buf_pool_mutex_enter(buf_pool);
+
+		n_pages = UT_LIST_GET_LEN(buf_pool->LRU);
+
+		/* skip empty buffer pools */
+		if (n_pages == 0) {
+			buf_pool_mutex_exit(buf_pool);
+			continue;
+		}
+
+		dump = ut_malloc(n_pages * sizeof(*dump));
+
+		if (dump == NULL) {
+			buf_pool_mutex_exit(buf_pool);
+			fclose(f);
+			buf_dump_status(STATUS_ERR,
+					"Cannot allocate %lu bytes: %s",
+					(ulong) (n_pages * sizeof(*dump)),
+					strerror(errno));
+			/* leave tmp_filename to exist */
+			return;
+		}
+
+		for (bpage = UT_LIST_GET_LAST(buf_pool->LRU), j = 0;
+		     bpage != NULL;
+		     bpage = UT_LIST_GET_PREV(LRU, bpage), j++) {
+
+			ut_a(buf_page_in_file(bpage));
+
+			dump[j] = BUF_DUMP_CREATE(buf_page_get_space(bpage),
+						  buf_page_get_page_no(bpage));
+		}
+
+		ut_a(j == n_pages);
+
+		buf_pool_mutex_exit(buf_pool);
+
+		for (j = 0; j < n_pages && !SHOULD_QUIT(); j++) {
+			ret = fprintf(f, "%lu,%lu\n",
+				      (ulong) BUF_DUMP_SPACE(dump[j]),
+				      (ulong) BUF_DUMP_PAGE(dump[j]));
+			if (ret < 0) {
+				ut_free(dump);
+				fclose(f);
+				buf_dump_status(STATUS_ERR,
+						"Cannot write to '%s': %s",
+						tmp_filename, strerror(errno));
+				/* leave tmp_filename to exist */
+				return;
+			}
+
+			if (j % 128 == 0) {
+				buf_dump_status(
+					STATUS_INFO,
+					"Dumping buffer pool "
+					"%lu/%lu, page %lu/%lu",
+					(ulong) (i + 1),
+					(ulong) srv_buf_pool_instances,
+					(ulong) (j + 1), (ulong) n_pages);
+			}
+		}
+
+		ut_free(dump);
+	}
+
+	ret = fclose(f);
+	if (ret != 0) {
+		buf_dump_status(STATUS_ERR,
+				"Cannot close '%s': %s",
+				tmp_filename, strerror(errno));
+		return;
+	}
+	/* else */
+
+	ret = unlink(full_filename);
+	if (ret != 0 && errno != ENOENT) {
+		buf_dump_status(STATUS_ERR,
+				"Cannot delete '%s': %s",
+				full_filename, strerror(errno));
+		/* leave tmp_filename to exist */
+		return;
+	}
+	/* else */
+
+	ret = rename(tmp_filename, full_filename);
+	if (ret != 0) {
+		buf_dump_status(STATUS_ERR,
+				"Cannot rename '%s' to '%s': %s",
+				tmp_filename, full_filename,
+				strerror(errno));
+		/* leave tmp_filename to exist */
+		return;
+	}
+	/* else */
+
+	/* success */
+
+	ut_sprintf_timestamp(now);
+
+	buf_dump_status(STATUS_NOTICE,
+			"Buffer pool(s) dump completed at %s", now);
+
+#undef SHOULD_QUIT
+}
+
+/*****************************************************************//**
+Compare two dump entries. Since the space id is in the high bits, this
+orders the entries by (space, page_no).
+@return 1 if a > b, 0 if a == b, -1 if a < b */
+UNIV_INLINE
+int
+buf_dump_cmp(
+/*=========*/
+	ib_uint64_t	a,	/*!< in: first entry */
+	ib_uint64_t	b)	/*!< in: second entry */
+{
+	return(a > b ? 1 : (a == b ? 0 : -1));
+}
+
+/*****************************************************************//**
+Sort dump entries by (space, page_no). */
+static
+void
+buf_dump_sort(
+/*==========*/
+	ib_uint64_t*	dump,	/*!< in/out: array to sort */
+	ib_uint64_t*	tmp,	/*!< in/out: aux array */
+	ulint		low,	/*!< in: lower bound, inclusive */
+	ulint		high)	/*!< in: upper bound, exclusive */
+{
+	UT_SORT_FUNCTION_BODY(buf_dump_sort, dump, tmp, low, high,
+			      buf_dump_cmp);
+}
+
+/*****************************************************************//**
+Throttles the buffer pool load so that it does not starve foreground
+I/O. As long as there is no user activity the load proceeds at full
+speed; otherwise at most innodb_io_capacity pages are read per second. */
+static
+void
+buf_load_throttle_if_needed(
+/*========================*/
+	ulint*	last_check_time,	/*!< in/out: milliseconds since
+					epoch of the last check, must be
+					initialized the first time */
+	ulint*	last_activity_count,	/*!< in/out: activity count
+					observed at the last check, must
+					be initialized the first time */
+	ulint*	n_io)			/*!< in/out: number of pages
+					read since the last check */
+{
+	ulint	elapsed_time;
+
+	if (*n_io < srv_io_capacity) {
+		return;
+	}
+
+	*n_io = 0;
+
+	/* srv_activity_count is increased by the MySQL threads on every
+	query; if it has not changed since the last check, then nobody
+	else needs the disk and we can load at full speed. */
+	if (srv_activity_count == *last_activity_count) {
+		*last_check_time = ut_time_ms();
+		return;
+	}
+
+	elapsed_time = ut_time_ms() - *last_check_time;
+
+	/* Do not sleep for more than a second: we have read
+	innodb_io_capacity pages in less than that time, so wait for
+	the rest of the second. */
+	if (elapsed_time < 1000) {
+		os_thread_sleep((1000 - elapsed_time) * 1000);
+	}
+
+	*last_check_time = ut_time_ms();
+	*last_activity_count = srv_activity_count;
+}
+
+/*****************************************************************//**
+Performs a buffer pool load from the file specified by
+innodb_buffer_pool_filename. If any errors occur then the value of
+innodb_buffer_pool_load_status will be set accordingly, see
+buf_load_status(). The dump filename can be specified by (relative to
+innodb_data_home_dir):
+SET GLOBAL innodb_buffer_pool_filename='filename'; */
+static
+void
+buf_load(void)
+/*==========*/
+{
+	char		full_filename[OS_FILE_MAX_PATH];
+	char		now[32];
+	FILE*		f;
+	ib_uint64_t*	dump;
+	ib_uint64_t*	dump_tmp;
+	ulint		dump_n;
+	ulint		total_buffer_pools_pages;
+	ulint		i;
+	ulong		space_id;
+	ulong		page_no;
+	int		fscanf_ret;
+	ulint		last_check_time;
+	ulint		last_activity_count;
+	ulint		n_io;
+
+	/* Ignore any leftovers from before */
+	buf_load_abort_flag = FALSE;
+
+	buf_dump_get_path(full_filename, sizeof full_filename);
+
+	buf_load_status(STATUS_NOTICE,
+			"Loading buffer pool(s) from %s", full_filename);
+
+	f = fopen(full_filename, "r");
+	if (f == NULL) {
+		buf_load_status(STATUS_ERR,
+				"Cannot open '%s' for reading: %s",
+				full_filename, strerror(errno));
+		return;
+	}
+	/* else */
+
+	/* First scan the file to estimate how many entries are in it.
+	This file is tiny (approx 500KB per 1GB buffer pool), reading it
+	two times is fine. */
+	dump_n = 0;
+	while (fscanf(f, "%lu,%lu", &space_id, &page_no) == 2
+	       && !SHUTTING_DOWN()) {
+		dump_n++;
+	}
+
+	if (!SHUTTING_DOWN() && !feof(f)) {
+		/* fscanf() returned != 2 */
+		const char*	what;
+		if (ferror(f)) {
+			what = "reading";
+		} else {
+			what = "parsing";
+		}
+		fclose(f);
+		buf_load_status(STATUS_ERR, "Error %s '%s', "
+				"unable to load buffer pool (stage 1)",
+				what, full_filename);
+		return;
+	}
+
+	/* If dump is larger than the buffer pool(s), then we ignore the
+	extra trailing. This could happen if a dump is made, then buffer
+	pool is shrunk and then load it attempted. */
+	total_buffer_pools_pages = buf_pool_get_n_pages();
+	if (dump_n > total_buffer_pools_pages) {
+		dump_n = total_buffer_pools_pages;
+	}
+
+	if (dump_n == 0) {
+		fclose(f);
+		ut_sprintf_timestamp(now);
+		buf_load_status(STATUS_NOTICE,
+				"Buffer pool(s) load completed at %s "
+				"(%s was empty)", now, full_filename);
+		return;
+	}
+
+	dump = ut_malloc(dump_n * sizeof(*dump));
+
+	if (dump == NULL) {
+		fclose(f);
+		buf_load_status(STATUS_ERR,
+				"Cannot allocate %lu bytes: %s",
+				(ulong) (dump_n * sizeof(*dump)),
+				strerror(errno));
+		return;
+	}
+
+	dump_tmp = ut_malloc(dump_n * sizeof(*dump_tmp));
+
+	if (dump_tmp == NULL) {
+		ut_free(dump);
+		fclose(f);
+		buf_load_status(STATUS_ERR,
+				"Cannot allocate %lu bytes: %s",
+				(ulong) (dump_n * sizeof(*dump_tmp)),
+				strerror(errno));
+		return;
+	}
+
+	rewind(f);
+
+	for (i = 0; i < dump_n && !SHUTTING_DOWN(); i++) {
+		fscanf_ret = fscanf(f, "%lu,%lu", &space_id, &page_no);
+
+		if (fscanf_ret != 2) {
+			if (feof(f)) {
+				break;
+			}
+			/* else */
+
+			ut_free(dump);
+			ut_free(dump_tmp);
+			fclose(f);
+			buf_load_status(STATUS_ERR,
+					"Error parsing '%s', unable to "
+					"load buffer pool (stage 2)",
+					full_filename);
+			return;
+		}
+
+		if (space_id > ULINT32_MASK || page_no > ULINT32_MASK) {
+			ut_free(dump);
+			ut_free(dump_tmp);
+			fclose(f);
+			buf_load_status(STATUS_ERR,
+					"Error parsing '%s': bogus "
+					"space,page %lu,%lu at line %lu, "
+					"unable to load buffer pool",
+					full_filename, space_id, page_no,
+					(ulong) i);
+			return;
+		}
+
+		dump[i] = BUF_DUMP_CREATE(space_id, page_no);
+	}
+
+	/* Set dump_n to the actual number of initialized elements,
+	i could be smaller than dump_n here if the file got truncated after
+	we read it the first time. */
+	dump_n = i;
+
+	fclose(f);
+
+	if (!SHUTTING_DOWN()) {
+		buf_dump_sort(dump, dump_tmp, 0, dump_n);
+	}
+
+	ut_free(dump_tmp);
+
+	last_check_time = ut_time_ms();
+	last_activity_count = srv_activity_count;
+	n_io = 0;
+
+	for (i = 0; i < dump_n && !SHUTTING_DOWN(); ) {
+		ulint	space_ids[BUF_LOAD_BATCH];
+		ulint	page_nos[BUF_LOAD_BATCH];
+		ulint	n;
+
+		for (n = 0; n < BUF_LOAD_BATCH && i < dump_n; n++, i++) {
+			space_ids[n] = BUF_DUMP_SPACE(dump[i]);
+			page_nos[n] = BUF_DUMP_PAGE(dump[i]);
+		}
+
+		n_io += buf_read_load_pages(space_ids, page_nos, n);
+
+		if (i % (BUF_LOAD_BATCH * 16) == 0 || i == dump_n) {
+			buf_load_status(STATUS_INFO,
+					"Loaded %lu/%lu pages",
+					(ulong) i, (ulong) dump_n);
+		}
+
+		if (buf_load_abort_flag) {
+			buf_load_abort_flag = FALSE;
+			ut_free(dump);
+			buf_load_status(
+				STATUS_NOTICE,
+				"Buffer pool(s) load aborted on request");
+			return;
+		}
+
+		buf_load_throttle_if_needed(
+			&last_check_time, &last_activity_count, &n_io);
+	}
+
+	ut_free(dump);
+
+	if (i < dump_n) {
+		buf_load_status(STATUS_NOTICE,
+				"Buffer pool(s) load aborted at shutdown "
+				"after %lu/%lu pages",
+				(ulong) i, (ulong) dump_n);
+		return;
+	}
+
+	ut_sprintf_timestamp(now);
+
+	buf_load_status(STATUS_NOTICE,
+			"Buffer pool(s) load completed at %s", now);
+}
+
+/*****************************************************************//**
+This is the main thread for buffer pool dump/load. It waits for an
+event and when waked up either performs a dump or load and sleeps
+again. At startup it loads the buffer pool if
+innodb_buffer_pool_load_at_startup is set, and at shutdown it dumps
+the buffer pool if innodb_buffer_pool_dump_at_shutdown is set.
+@return this function does not return, it calls os_thread_exit() */
+UNIV_INTERN
+os_thread_ret_t
+buf_dump_thread(
+/*============*/
+	void*	arg __attribute__((unused)))	/*!< in: a dummy parameter
+						required by os_thread_create */
+{
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(buf_dump_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	buf_dump_thread_active = TRUE;
+
+	buf_dump_status(STATUS_INFO, "not started");
+	buf_load_status(STATUS_INFO, "not started");
+
+	if (srv_buffer_pool_load_at_startup) {
+		buf_load();
+	}
+
+	while (!SHUTTING_DOWN()) {
+		ib_int64_t	sig_count;
+
+		sig_count = os_event_reset(srv_buf_dump_event);
+
+		if (buf_dump_should_start) {
+			buf_dump_should_start = FALSE;
+			buf_dump(TRUE /* quit on shutdown */);
+		}
+
+		if (buf_load_should_start) {
+			buf_load_should_start = FALSE;
+			buf_load();
+		}
+
+		if (!SHUTTING_DOWN()) {
+			os_event_wait_low(srv_buf_dump_event, sig_count);
+		}
+	}
+
+	/* A dump taken during a 'very fast' shutdown would be useless:
+	the next startup has to do crash recovery anyway. */
+	if (srv_buffer_pool_dump_at_shutdown && srv_fast_shutdown != 2) {
+		buf_dump(FALSE /* ignore shutdown down flag,
+		keep going even if we are in a shutdown state */);
+	}
+
+	buf_dump_thread_active = FALSE;
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
@@ -43,6 +43,9 @@ Created 11/11/1995 Heikki Tuuri
 #include "log0log.h"
 #include "os0file.h"
 #include "trx0sys.h"
+#include "srv0start.h"
+#include "log0recv.h"
+#include "os0thread.h"
 #include "mysql/plugin.h"
 #include "mysql/service_thd_wait.h"
 
@@ -79,6 +82,30 @@ static ulint buf_lru_flush_page_count = 0;
 
 /* @} */
 
+/** Event to wake up the page cleaner thread before its one second
+timeout, e.g. when a thread cannot find a free block */
+UNIV_INTERN os_event_t	buf_flush_event;
+
+/** Event set by the page cleaner thread each time it has made a pass
+over the LRU lists of all the buffer pool instances */
+UNIV_INTERN os_event_t	buf_flush_LRU_event;
+
+/** TRUE while the page cleaner thread is running */
+UNIV_INTERN ibool	buf_page_cleaner_is_active = FALSE;
+
+/** Checkpoint age, in percent of log_sys->max_modified_age_async,
+above which the page cleaner flushes more than the redo generation
+rate alone asks for */
+#define BUF_FLUSH_AGE_LWM	50
+
+/** Upper limit of a page cleaner flush_list batch, in percent of
+srv_io_capacity */
+#define BUF_FLUSH_MAX_IO_PCT	200
+
+/** How long a thread that is out of free blocks waits for the page
+cleaner before it flushes the LRU list itself, in microseconds */
+#define BUF_FLUSH_LRU_WAIT_USEC	100000
+
 /******************************************************************//**
 Increases flush_list size in bytes with zip_size for compressed page,
 UNIV_PAGE_SIZE for uncompressed page in inline function */
@@ -1024,6 +1051,8 @@ buf_flush_init_for_writing(
 	ib_uint64_t	newest_lsn)	/*!< in: newest modification lsn
 					to the page */
 {
+	ib_uint32_t	checksum;
+
 	ut_ad(page);
 
 	if (page_zip_) {
@@ -1052,7 +1081,8 @@ buf_flush_init_for_writing(
 					+ FIL_PAGE_SPACE_OR_CHKSUM,
 					srv_use_checksums
 					? page_zip_calc_checksum(
-						page_zip->data, zip_size)
+						page_zip->data, zip_size,
+						srv_checksum_algorithm)
 					: BUF_NO_CHECKSUM_MAGIC);
 			return;
 		}
@@ -1075,20 +1105,38 @@ buf_flush_init_for_writing(
 
 	/* Store the new formula checksum */
 
-	mach_write_to_4(page + FIL_PAGE_SPACE_OR_CHKSUM,
-			srv_use_checksums
-			? buf_calc_page_new_checksum(page)
-			: BUF_NO_CHECKSUM_MAGIC);
+	switch (srv_use_checksums
+		? (srv_checksum_algorithm_t) srv_checksum_algorithm
+		: SRV_CHECKSUM_ALGORITHM_NONE) {
+	case SRV_CHECKSUM_ALGORITHM_CRC32:
+		checksum = buf_calc_page_crc32(page);
+		break;
+	case SRV_CHECKSUM_ALGORITHM_INNODB:
+		checksum = buf_calc_page_new_checksum(page);
+		break;
+	case SRV_CHECKSUM_ALGORITHM_NONE:
+		checksum = BUF_NO_CHECKSUM_MAGIC;
+		break;
+	default:
+		ut_error;
+	}
+
+	mach_write_to_4(page + FIL_PAGE_SPACE_OR_CHKSUM, checksum);
 
 	/* We overwrite the first 4 bytes of the end lsn field to store
 	the old formula checksum. Since it depends also on the field
 	FIL_PAGE_SPACE_OR_CHKSUM, it has to be calculated after storing the
-	new formula checksum. */
+	new formula checksum. The crc32 algorithm stores the same value
+	in both fields. */
+
+	if (srv_use_checksums
+	    && srv_checksum_algorithm == SRV_CHECKSUM_ALGORITHM_INNODB) {
+
+		checksum = buf_calc_page_old_checksum(page);
+	}
 
 	mach_write_to_4(page + UNIV_PAGE_SIZE - FIL_PAGE_END_LSN_OLD_CHKSUM,
-			srv_use_checksums
-			? buf_calc_page_old_checksum(page)
-			: BUF_NO_CHECKSUM_MAGIC);
+			checksum);
 }
 
 #ifndef UNIV_HOTBACKUP
@@ -1156,8 +1204,7 @@ buf_flush_write_block_low(
 	case BUF_BLOCK_ZIP_DIRTY:
 		frame = bpage->zip.data;
 		if (UNIV_LIKELY(srv_use_checksums)) {
-			ut_a(mach_read_from_4(frame + FIL_PAGE_SPACE_OR_CHKSUM)
-			     == page_zip_calc_checksum(frame, zip_size));
+			ut_a(page_zip_verify_checksum(frame, zip_size));
 		}
 		mach_write_to_8(frame + FIL_PAGE_LSN,
 				bpage->newest_modification);
@@ -2205,6 +2252,225 @@ buf_flush_get_desired_flush_rate(void)
 	return(rate > 0 ? (ulint) rate : 0);
 }
 
+/*********************************************************************//**
+Flushes pages from the end of the LRU list of every buffer pool instance
+whose margin of replaceable pages has become too small. Unlike
+buf_flush_free_margin() this does not wait for an LRU batch that
+somebody else is running. */
+static
+void
+buf_flush_LRU_tail(void)
+/*====================*/
+{
+	ulint	i;
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool_t*	buf_pool;
+		ulint		n_to_flush;
+
+		buf_pool = buf_pool_from_array(i);
+
+		n_to_flush = buf_flush_LRU_recommendation(buf_pool);
+
+		if (n_to_flush > 0) {
+			buf_flush_LRU(buf_pool, n_to_flush);
+		}
+	}
+}
+
+/*********************************************************************//**
+Determines how many pages the page cleaner should flush from the flush
+lists in the current one second interval. With adaptive flushing the
+amount follows the rate at which redo is generated. In any case it grows
+towards and beyond innodb_io_capacity as the age of the oldest
+modification approaches the point where log_check_margins() would start
+a synchronous preflush.
+@return	number of pages to flush from the flush lists */
+static
+ulint
+buf_flush_page_cleaner_n_pages(void)
+/*================================*/
+{
+	ib_uint64_t	oldest_lsn;
+	ib_uint64_t	age;
+	ulint		age_pct;
+	ulint		n_pages	= 0;
+
+	oldest_lsn = buf_pool_get_oldest_modification();
+
+	if (oldest_lsn == 0 || log_sys->max_modified_age_async == 0) {
+
+		/* Nothing is dirty */
+		return(0);
+	}
+
+	age = log_get_lsn() - oldest_lsn;
+	age_pct = (ulint) (age * 100 / log_sys->max_modified_age_async);
+
+	if (buf_get_modified_ratio_pct() > srv_max_buf_pool_modified_pct) {
+
+		/* Try to keep the number of modified pages in the
+		buffer pool under the limit wished by the user */
+		n_pages = srv_io_capacity;
+	}
+
+	if (srv_adaptive_flushing) {
+
+		/* Keep up with the redo generation rate so that
+		checkpoints do not produce bursts of IO */
+		n_pages = ut_max(n_pages, buf_flush_get_desired_flush_rate());
+	}
+
+	/* This is done even without adaptive flushing: the master thread
+	no longer flushes periodically, and nothing else would advance the
+	checkpoint before log_check_margins() stalls the user threads. */
+	if (age_pct > BUF_FLUSH_AGE_LWM) {
+		ulint	pct;
+
+		/* The checkpoint age is getting close to the log
+		capacity: flush harder, reaching srv_io_capacity when
+		the age reaches the async preflush point. */
+		pct = (age_pct - BUF_FLUSH_AGE_LWM) * 100
+			/ (100 - BUF_FLUSH_AGE_LWM);
+
+		n_pages = ut_max(n_pages, srv_io_capacity * pct / 100);
+	}
+
+	return(ut_min(n_pages, srv_io_capacity * BUF_FLUSH_MAX_IO_PCT / 100));
+}
+
+/*********************************************************************//**
+Asks the page cleaner thread to flush the LRU lists and waits a while
+for it to do so. This is used by threads which cannot find a free block
+in buf_pool.
+@return	TRUE if the page cleaner made a pass over the LRU lists, FALSE if
+it is not running or did not respond in time, in which case the caller
+must flush the LRU list itself */
+UNIV_INTERN
+ibool
+buf_flush_page_cleaner_wait_LRU(
+/*============================*/
+	buf_pool_t*	buf_pool)	/*!< in: buffer pool instance */
+{
+	ib_int64_t	sig_count;
+
+	if (!buf_page_cleaner_is_active) {
+
+		return(FALSE);
+	}
+
+	sig_count = os_event_reset(buf_flush_LRU_event);
+
+	os_event_set(buf_flush_event);
+
+	/* The page cleaner may be stuck in a flush_list batch waiting
+	for a page latch that we hold: do not wait for it forever. */
+
+	if (os_event_wait_time_low(buf_flush_LRU_event,
+				   BUF_FLUSH_LRU_WAIT_USEC, sig_count)
+	    == OS_SYNC_TIME_EXCEEDED) {
+
+		return(FALSE);
+	}
+
+	buf_flush_wait_batch_end(buf_pool, BUF_FLUSH_LRU);
+
+	return(TRUE);
+}
+
+/*********************************************************************//**
+The page cleaner thread. Once a second, or whenever it is woken up by
+a thread which has run out of free blocks, it tops up the free margin at
+the end of the LRU list of every buffer pool instance. Once a second it
+also flushes a batch from the flush lists, sized by
+buf_flush_page_cleaner_n_pages(). At shutdown the master thread does the
+final flush; the page cleaner exits once the master and purge threads have
+been suspended.
+@return	a dummy parameter */
+UNIV_INTERN
+os_thread_ret_t
+buf_flush_page_cleaner_thread(
+/*==========================*/
+	void*	arg __attribute__((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+	ulint	next_loop_time	= ut_time_ms() + 1000;
+
+#ifdef UNIV_DEBUG_THREAD_CREATION
+	fprintf(stderr, "Page cleaner thread starts, id %lu\n",
+		os_thread_pf(os_thread_get_curr_id()));
+#endif /* UNIV_DEBUG_THREAD_CREATION */
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(buf_page_cleaner_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	buf_page_cleaner_is_active = TRUE;
+
+	for (;;) {
+		ib_int64_t	sig_count;
+		ulint		cur_time;
+
+		sig_count = os_event_reset(buf_flush_event);
+
+		if (srv_shutdown_state != SRV_SHUTDOWN_NONE
+		    && srv_get_active_thread_type() == ULINT_UNDEFINED) {
+
+			/* Nobody is going to need free blocks any more
+			and the master thread has done its final flush. */
+			break;
+		}
+
+		buf_flush_LRU_tail();
+
+		os_event_set(buf_flush_LRU_event);
+
+		cur_time = ut_time_ms();
+
+		if (cur_time >= next_loop_time) {
+			next_loop_time = cur_time + 1000;
+
+			/* Recovery flushes the flush lists itself and
+			expects no concurrent flush_list batch. */
+			if (srv_shutdown_state == SRV_SHUTDOWN_NONE
+			    && !recv_recovery_on
+			    && srv_force_recovery < SRV_FORCE_NO_BACKGROUND) {
+				ulint	n_pages;
+
+				n_pages = buf_flush_page_cleaner_n_pages();
+
+				if (n_pages > 0) {
+					buf_flush_list(n_pages,
+						       IB_ULONGLONG_MAX);
+				}
+			}
+
+			cur_time = ut_time_ms();
+		}
+
+		if (next_loop_time > cur_time) {
+			/* Sleep until the next one second interval
+			begins or until somebody wakes us up. We use
+			ut_min() to avoid a long sleep in case of wrap
+			around. */
+			os_event_wait_time_low(
+				buf_flush_event,
+				ut_min(1000000,
+				       (next_loop_time - cur_time) * 1000),
+				sig_count);
+		}
+	}
+
+	buf_page_cleaner_is_active = FALSE;
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
 /******************************************************************//**
 Validates the flush list.
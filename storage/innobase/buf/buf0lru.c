@@ -1207,9 +1207,15 @@ loop:
 		os_event_set(srv_lock_timeout_thread_event);
 	}
 
-	/* No free block was found: try to flush the LRU list */
+	/* No free block was found: ask the page cleaner to flush the LRU
+	list. During recovery and late in shutdown, when the page cleaner
+	is not running, or when it does not respond in time, flush the LRU
+	list ourselves. */
+
+	if (!buf_flush_page_cleaner_wait_LRU(buf_pool)) {
+		buf_flush_free_margin(buf_pool);
+	}
 
-	buf_flush_free_margin(buf_pool);
 	++srv_buf_pool_wait_free;
 
 	os_aio_simulated_wake_handler_threads();
@@ -1870,7 +1876,8 @@ alloc:
 				UNIV_LIKELY(srv_use_checksums)
 				? page_zip_calc_checksum(
 					b->zip.data,
-					page_zip_get_size(&b->zip))
+					page_zip_get_size(&b->zip),
+					srv_checksum_algorithm)
 				: BUF_NO_CHECKSUM_MAGIC);
 		}
 
@@ -394,7 +394,6 @@ buf_read_page(
 	ulint	zip_size,/*!< in: compressed page size in bytes, or 0 */
 	ulint	offset)	/*!< in: page number */
 {
-	buf_pool_t*	buf_pool = buf_pool_get(space, offset);
 	ib_int64_t	tablespace_version;
 	ulint		count;
 	ulint		err;
@@ -418,9 +417,6 @@ buf_read_page(
 			(ulong) space, (ulong) offset);
 	}
 
-	/* Flush pages from the end of the LRU list if necessary */
-	buf_flush_free_margin(buf_pool);
-
 	/* Increment number of I/O operations used for LRU policy. */
 	buf_LRU_stat_inc_io();
 
@@ -688,9 +684,6 @@ buf_read_ahead_linear(
 
 	os_aio_simulated_wake_handler_threads();
 
-	/* Flush pages from the end of the LRU list if necessary */
-	buf_flush_free_margin(buf_pool);
-
 #ifdef UNIV_DEBUG
 	if (buf_debug_prints && (count > 0)) {
 		fprintf(stderr,
@@ -776,9 +769,6 @@ tablespace_deleted:
 
 	os_aio_simulated_wake_handler_threads();
 
-	/* Flush pages from the end of all the LRU lists if necessary */
-	buf_flush_free_margins();
-
 #ifdef UNIV_DEBUG
 	if (buf_debug_prints) {
 		fprintf(stderr,
@@ -788,6 +778,76 @@ tablespace_deleted:
 #endif /* UNIV_DEBUG */
 }
 
+/********************************************************************//**
+Issues read requests for pages which the buffer pool load wants to read
+in, in order to warm up the buffer pool after a restart. Pages whose
+tablespace no longer exists or which lie beyond the end of their
+tablespace are silently skipped. The caller should pass the pages sorted
+by (space, page_no) so that the reads are as sequential as possible.
+@return	number of page read requests issued */
+UNIV_INTERN
+ulint
+buf_read_load_pages(
+/*================*/
+	const ulint*	space_ids,	/*!< in: array of space ids */
+	const ulint*	page_nos,	/*!< in: array of page numbers */
+	ulint		n_stored)	/*!< in: number of elements
+					in the arrays */
+{
+	ulint		i;
+	ulint		count		= 0;
+	ulint		space		= ULINT_UNDEFINED;
+	ulint		zip_size	= ULINT_UNDEFINED;
+	ulint		space_size	= 0;
+	ib_int64_t	tablespace_version = 0;
+
+	for (i = 0; i < n_stored; i++) {
+		ulint		err;
+		buf_pool_t*	buf_pool;
+
+		if (space_ids[i] != space) {
+			/* Look up the tablespace only once for each
+			run of pages belonging to it. */
+			space = space_ids[i];
+			zip_size = fil_space_get_zip_size(space);
+			space_size = fil_space_get_size(space);
+			tablespace_version = fil_space_get_version(space);
+		}
+
+		if (zip_size == ULINT_UNDEFINED
+		    || page_nos[i] >= space_size) {
+			/* The tablespace was dropped or truncated
+			after the dump was taken. */
+			continue;
+		}
+
+		buf_pool = buf_pool_get(space, page_nos[i]);
+
+		while (buf_pool->n_pend_reads
+		       > buf_pool->curr_size / BUF_READ_AHEAD_PEND_LIMIT) {
+			os_thread_sleep(500000);
+		}
+
+		count += buf_read_page_low(
+			&err, FALSE,
+			BUF_READ_ANY_PAGE | OS_AIO_SIMULATED_WAKE_LATER,
+			space, zip_size, FALSE, tablespace_version,
+			page_nos[i]);
+	}
+
+	os_aio_simulated_wake_handler_threads();
+
+#ifdef UNIV_DEBUG
+	if (buf_debug_prints && n_stored > 0) {
+		fprintf(stderr,
+			"Buffer pool load read space %lu pages %lu\n",
+			(ulong) space_ids[0], (ulong) n_stored);
+	}
+#endif /* UNIV_DEBUG */
+
+	return(count);
+}
+
 /********************************************************************//**
 Issues read requests for pages which recovery wants to read in. */
 UNIV_INTERN
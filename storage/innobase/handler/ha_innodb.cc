@@ -60,6 +60,7 @@ this program; if not, write to the Free Software Foundation, Inc.,
 /* Include necessary InnoDB headers */
 extern "C" {
 #include "univ.i"
+#include "buf0dump.h"
 #include "buf0lru.h"
 #include "btr0sea.h"
 #include "os0file.h"
@@ -102,8 +103,6 @@ enum_tx_isolation thd_get_trx_isolation(const THD* thd);
 
 /** to protect innobase_open_files */
 static mysql_mutex_t innobase_share_mutex;
-/** to force correct commit order in binlog */
-static mysql_mutex_t prepare_commit_mutex;
 static ulong commit_threads = 0;
 static mysql_cond_t commit_cond;
 static mysql_mutex_t commit_cond_m;
@@ -196,6 +195,23 @@ static TYPELIB innodb_stats_method_typelib = {
 	NULL
 };
 
+/** Possible values for system variable "innodb_checksum_algorithm". */
+static const char* innodb_checksum_algorithm_names[] = {
+	"crc32",
+	"innodb",
+	"none",
+	NullS
+};
+
+/** Used to define an enumerate type of the system variable
+innodb_checksum_algorithm. */
+static TYPELIB innodb_checksum_algorithm_typelib = {
+	array_elements(innodb_checksum_algorithm_names) - 1,
+	"innodb_checksum_algorithm_typelib",
+	innodb_checksum_algorithm_names,
+	NULL
+};
+
 /* The following counter is used to convey information to InnoDB
 about server activity: in selects it is not sensible to call
 srv_active_wake_master_thread after each fetch or search, we only do
@@ -220,14 +236,12 @@ static const char* innobase_change_buffering_values[IBUF_USE_COUNT] = {
 /* Keys to register pthread mutexes/cond in the current file with
 performance schema */
 static mysql_pfs_key_t	innobase_share_mutex_key;
-static mysql_pfs_key_t	prepare_commit_mutex_key;
 static mysql_pfs_key_t	commit_cond_mutex_key;
 static mysql_pfs_key_t	commit_cond_key;
 
 static PSI_mutex_info	all_pthread_mutexes[] = {
         {&commit_cond_mutex_key, "commit_cond_mutex", 0},
-        {&innobase_share_mutex_key, "innobase_share_mutex", 0},
-        {&prepare_commit_mutex_key, "prepare_commit_mutex", 0}
+        {&innobase_share_mutex_key, "innobase_share_mutex", 0}
 };
 
 static PSI_cond_info	all_innodb_conds[] = {
@@ -268,6 +282,8 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 	{&purge_sys_bh_mutex_key, "purge_sys_bh_mutex", 0},
 	{&recv_sys_mutex_key, "recv_sys_mutex", 0},
 	{&rseg_mutex_key, "rseg_mutex", 0},
+	{&row_merge_pass_mutex_key, "row_merge_pass_mutex", 0},
+	{&row_merge_scan_mutex_key, "row_merge_scan_mutex", 0},
 #  ifdef UNIV_SYNC_DEBUG
 	{&rw_lock_debug_mutex_key, "rw_lock_debug_mutex", 0},
 #  endif /* UNIV_SYNC_DEBUG */
@@ -282,7 +298,9 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 	{&sync_thread_mutex_key, "sync_thread_mutex", 0},
 #  endif /* UNIV_SYNC_DEBUG */
 	{&trx_doublewrite_mutex_key, "trx_doublewrite_mutex", 0},
-	{&trx_undo_mutex_key, "trx_undo_mutex", 0}
+	{&trx_undo_mutex_key, "trx_undo_mutex", 0},
+	{&trx_sys_mutex_key, "trx_sys_mutex", 0},
+	{&read_view_mutex_key, "read_view_mutex", 0}
 };
 # endif /* UNIV_PFS_MUTEX */
 
@@ -317,12 +335,17 @@ performance schema instrumented if "UNIV_PFS_THREAD"
 is defined */
 static PSI_thread_info	all_innodb_threads[] = {
 	{&trx_rollback_clean_thread_key, "trx_rollback_clean_thread", 0},
+	{&recv_apply_thread_key, "recv_apply_thread", 0},
+	{&row_merge_thread_key, "row_merge_thread", 0},
 	{&io_handler_thread_key, "io_handler_thread", 0},
 	{&srv_lock_timeout_thread_key, "srv_lock_timeout_thread", 0},
 	{&srv_error_monitor_thread_key, "srv_error_monitor_thread", 0},
 	{&srv_monitor_thread_key, "srv_monitor_thread", 0},
 	{&srv_master_thread_key, "srv_master_thread", 0},
-	{&srv_purge_thread_key, "srv_purge_thread", 0}
+	{&srv_purge_thread_key, "srv_purge_thread", 0},
+	{&srv_purge_worker_thread_key, "srv_purge_worker_thread", 0},
+	{&buf_page_cleaner_thread_key, "page_cleaner_thread", 0},
+	{&buf_dump_thread_key, "buf_dump_thread", 0}
 };
 # endif /* UNIV_PFS_THREAD */
 
@@ -609,6 +632,10 @@ innobase_commit_low(
 	trx_t*	trx);	/*!< in: transaction handle */
 
 static SHOW_VAR innodb_status_variables[]= {
+  {"buffer_pool_dump_status",
+  (char*) &export_vars.innodb_buffer_pool_dump_status,	  SHOW_CHAR},
+  {"buffer_pool_load_status",
+  (char*) &export_vars.innodb_buffer_pool_load_status,	  SHOW_CHAR},
   {"buffer_pool_pages_data",
   (char*) &export_vars.innodb_buffer_pool_pages_data,	  SHOW_LONG},
   {"buffer_pool_bytes_data",
@@ -663,6 +690,12 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_dblwr_pages_written,	  SHOW_LONG},
   {"dblwr_writes",
   (char*) &export_vars.innodb_dblwr_writes,		  SHOW_LONG},
+  {"deadlock_search_time",
+  (char*) &export_vars.innodb_deadlock_search_time,	  SHOW_LONGLONG},
+  {"deadlock_searches",
+  (char*) &export_vars.innodb_deadlock_searches,	  SHOW_LONG},
+  {"deadlocks",
+  (char*) &export_vars.innodb_deadlocks,		  SHOW_LONG},
   {"have_atomic_builtins",
   (char*) &export_vars.innodb_have_atomic_builtins,	  SHOW_BOOL},
   {"log_waits",
@@ -1611,18 +1644,6 @@ trx_is_registered_for_2pc(
 	return(trx->is_registered == 1);
 }
 
-/*********************************************************************//**
-Note that a transaction owns the prepare_commit_mutex. */
-static inline
-void
-trx_owns_prepare_commit_mutex_set(
-/*==============================*/
-	trx_t*	trx)	/* in: transaction */
-{
-	ut_a(trx_is_registered_for_2pc(trx));
-	trx->owns_prepare_mutex = 1;
-}
-
 /*********************************************************************//**
 Note that a transaction has been registered with MySQL 2PC coordinator. */
 static inline
@@ -1632,7 +1653,6 @@ trx_register_for_2pc(
 	trx_t*	trx)	/* in: transaction */
 {
 	trx->is_registered = 1;
-	ut_ad(trx->owns_prepare_mutex == 0);
 }
 
 /*********************************************************************//**
@@ -1644,19 +1664,6 @@ trx_deregister_from_2pc(
 	trx_t*	trx)	/* in: transaction */
 {
 	trx->is_registered = 0;
-	trx->owns_prepare_mutex = 0;
-}
-
-/*********************************************************************//**
-Check whether atransaction owns the prepare_commit_mutex.
-@return true if transaction owns the prepare commit mutex */
-static inline
-bool
-trx_has_prepare_commit_mutex(
-/*=========================*/
-	const trx_t*	trx)	/* in: transaction */
-{
-	return(trx->owns_prepare_mutex == 1);
 }
 
 /*********************************************************************//**
@@ -1687,7 +1694,9 @@ ha_innobase::ha_innobase(handlerton *hton, TABLE_SHARE *table_arg)
 		  HA_TABLE_SCAN_ON_INDEX),
   start_of_scan(0),
   num_write_row(0)
-{}
+{
+	ds_mrr.init(this);
+}
 
 /*********************************************************************//**
 Destruct ha_innobase handler. */
@@ -2578,8 +2587,6 @@ innobase_change_buffering_inited_ok:
 	mysql_mutex_init(innobase_share_mutex_key,
 			 &innobase_share_mutex,
 			 MY_MUTEX_INIT_FAST);
-	mysql_mutex_init(prepare_commit_mutex_key,
-			 &prepare_commit_mutex, MY_MUTEX_INIT_FAST);
 	mysql_mutex_init(commit_cond_mutex_key,
 			 &commit_cond_m, MY_MUTEX_INIT_FAST);
 	mysql_cond_init(commit_cond_key, &commit_cond, NULL);
@@ -2627,7 +2634,6 @@ innobase_end(
 		srv_free_paths_and_sizes();
 		my_free(internal_innobase_data_file_path);
 		mysql_mutex_destroy(&innobase_share_mutex);
-		mysql_mutex_destroy(&prepare_commit_mutex);
 		mysql_mutex_destroy(&commit_cond_m);
 		mysql_cond_destroy(&commit_cond);
 	}
@@ -2790,9 +2796,13 @@ innobase_commit(
 		/* We were instructed to commit the whole transaction, or
 		this is an SQL statement end and autocommit is on */
 
-		/* We need current binlog position for ibbackup to work.
-		Note, the position is current because of
-		prepare_commit_mutex */
+		/* For ibbackup to work the order of transactions in
+		binlog and InnoDB must be the same. Wait for the
+		transactions written to the binlog before this one to
+		be committed. This is done before taking a commit
+		concurrency slot, since those transactions may need
+		one. */
+		mysql_bin_log_commit_order_wait(thd);
 retry:
 		if (innobase_commit_concurrency > 0) {
 			mysql_mutex_lock(&commit_cond_m);
@@ -2812,8 +2822,9 @@ retry:
 
 		/* The following calls to read the MySQL binary log
 		file name and the position return consistent results:
-		1) Other InnoDB transactions cannot intervene between
-		these calls as we are holding prepare_commit_mutex.
+		1) The position is the end of this transaction in the
+		binlog, and InnoDB commits the transactions in binlog
+		order.
 		2) Binary logging of other engines is not relevant
 		to InnoDB as all InnoDB requires is that committing
 		InnoDB transactions appear in the same order in the
@@ -2824,15 +2835,18 @@ retry:
 		a rotation when the counter drops to zero. See
 		LOCK_prep_xids and COND_prep_xids in log.cc. */
 		trx->mysql_log_file_name = mysql_bin_log_file_name();
-		trx->mysql_log_offset = (ib_int64_t) mysql_bin_log_file_pos();
+		trx->mysql_log_offset =
+			(ib_int64_t) mysql_bin_log_commit_pos(thd);
 
 		/* Don't do write + flush right now. For group commit
-		to work we want to do the flush after releasing the
-		prepare_commit_mutex. */
+		to work we want to do the flush after letting the next
+		transaction of the binlog commit. */
 		trx->flush_log_later = TRUE;
 		innobase_commit_low(trx);
 		trx->flush_log_later = FALSE;
 
+		mysql_bin_log_commit_order_done(thd);
+
 		if (innobase_commit_concurrency > 0) {
 			mysql_mutex_lock(&commit_cond_m);
 			commit_threads--;
@@ -2840,11 +2854,6 @@ retry:
 			mysql_mutex_unlock(&commit_cond_m);
 		}
 
-		if (trx_has_prepare_commit_mutex(trx)) {
-  
-			mysql_mutex_unlock(&prepare_commit_mutex);
-  		}
-  
 		trx_deregister_from_2pc(trx);
 
 		/* Now do a write + flush of logs. */
@@ -2921,9 +2930,6 @@ innobase_rollback(
 	    || !thd_test_options(thd, OPTION_NOT_AUTOCOMMIT | OPTION_BEGIN)) {
 
 		error = trx_rollback_for_mysql(trx);
-                if (trx_has_prepare_commit_mutex(trx)) {
-                  mysql_mutex_unlock(&prepare_commit_mutex);
-                }
 		trx_deregister_from_2pc(trx);
 	} else {
 		error = trx_rollback_last_sql_stat_for_mysql(trx);
@@ -3237,7 +3243,8 @@ ha_innobase::index_flags(
 const
 {
 	return(HA_READ_NEXT | HA_READ_PREV | HA_READ_ORDER
-	       | HA_READ_RANGE | HA_KEYREAD_ONLY);
+	       | HA_READ_RANGE | HA_KEYREAD_ONLY
+	       | HA_DO_INDEX_COND_PUSHDOWN);
 }
 
 /****************************************************************//**
@@ -4201,6 +4208,8 @@ ha_innobase::close(void)
 
 	DBUG_ENTER("ha_innobase::close");
 
+	ds_mrr.reset();
+
 	thd = ha_thd();
 	if (thd != NULL) {
 		innobase_release_temporary_latches(ht, thd);
@@ -4918,9 +4927,11 @@ include_field:
 
 		if (index == clust_index) {
 			templ->rec_field_no = templ->clust_rec_field_no;
+			templ->icp_rec_field_no = ULINT_UNDEFINED;
 		} else {
 			templ->rec_field_no = dict_index_get_nth_col_pos(
 								index, i);
+			templ->icp_rec_field_no = templ->rec_field_no;
 			if (templ->rec_field_no == ULINT_UNDEFINED) {
 				prebuilt->need_to_access_clustered = TRUE;
 			}
@@ -5752,6 +5763,8 @@ ha_innobase::index_end(void)
 	int	error	= 0;
 	DBUG_ENTER("index_end");
 	active_index=MAX_KEY;
+	prebuilt->idx_cond = NULL;
+	ds_mrr.dsmrr_close();
 	DBUG_RETURN(error);
 }
 
@@ -6129,6 +6142,14 @@ ha_innobase::change_active_index(
 	dict_index_copy_types(prebuilt->search_tuple, prebuilt->index,
 			      prebuilt->index->n_fields);
 
+	/* Check the index condition pushed down by MySQL, if it was
+	pushed for this index, in row_search_for_mysql(). */
+
+	prebuilt->idx_cond = pushed_idx_cond
+		&& keynr == pushed_idx_cond_keyno
+		&& !dict_index_is_clust(prebuilt->index)
+		? this : NULL;
+
 	/* MySQL changes the active index for a handle also during some
 	queries, for example SELECT MAX(a), SUM(a) first retrieves the MAX()
 	and then calculates the sum. Previously we played safe and used
@@ -6316,6 +6337,121 @@ ha_innobase::index_last(
 	DBUG_RETURN(error);
 }
 
+/**********************************************************************//**
+Reads the first row of a multi-range set. The rows are read in primary
+key order if the caller gave a buffer for the row references, see
+DsMrr_impl.
+@return	0, HA_ERR_END_OF_FILE, or error number */
+UNIV_INTERN
+int
+ha_innobase::read_multi_range_first(
+/*================================*/
+	KEY_MULTI_RANGE**	found_range_p,	/*!< out: range of the row */
+	KEY_MULTI_RANGE*	ranges,		/*!< in: ranges to read */
+	uint			range_count,	/*!< in: number of ranges */
+	bool			sorted,		/*!< in: TRUE if the rows
+						must be in index order */
+	HANDLER_BUFFER*		buffer)		/*!< in: buffer for row
+						references, or NULL */
+{
+	/* The clone which scans the index does not take the row locks
+	of a locking read, so those read the ranges in index order */
+
+	return(ds_mrr.dsmrr_first(found_range_p, ranges, range_count, sorted,
+				  prebuilt->select_lock_type == LOCK_NONE
+				  ? buffer : NULL));
+}
+
+/**********************************************************************//**
+Reads the next row of a multi-range set.
+@return	0, HA_ERR_END_OF_FILE, or error number */
+UNIV_INTERN
+int
+ha_innobase::read_multi_range_next(
+/*===============================*/
+	KEY_MULTI_RANGE**	found_range_p)	/*!< out: range of the row */
+{
+	return(ds_mrr.dsmrr_next(found_range_p));
+}
+
+/**********************************************************************//**
+Checks if the rows of a range scan can be read in primary key order.
+@return	FALSE if they can, TRUE if not */
+UNIV_INTERN
+bool
+ha_innobase::multi_range_read_info(
+/*===============================*/
+	uint		keynr,		/*!< in: index to scan */
+	ha_rows		rows,		/*!< in: estimated number of rows */
+	uint*		bufsz,		/*!< in/out: buffer size */
+	ha_rows*	buf_rows)	/*!< out: rows in one buffer fill */
+{
+	if (prebuilt->select_lock_type != LOCK_NONE) {
+
+		return(TRUE);
+	}
+
+	return(ds_mrr.dsmrr_info(keynr, rows, bufsz, buf_rows));
+}
+
+/****************************************************************//**
+Pushes down an index condition; it is checked in row_search_for_mysql()
+on the secondary index records, before the clustered index records are
+looked up.
+@return the part of the condition that MySQL must check: idx_cond if
+the condition is not pushed down, NULL otherwise */
+UNIV_INTERN
+Item*
+ha_innobase::idx_cond_push(
+/*=======================*/
+	uint	keyno,		/*!< in: index number */
+	Item*	idx_cond)	/*!< in: condition on the index columns */
+{
+	DBUG_ENTER("ha_innobase::idx_cond_push");
+	DBUG_ASSERT(keyno != MAX_KEY);
+	DBUG_ASSERT(idx_cond != NULL);
+
+	if (keyno == table_share->primary_key) {
+		/* The columns of the clustered index record are the row
+		itself, there is no lookup to save. */
+
+		DBUG_RETURN(idx_cond);
+	}
+
+	pushed_idx_cond = idx_cond;
+	pushed_idx_cond_keyno = keyno;
+
+	if (active_index == keyno) {
+		prebuilt->idx_cond = this;
+	}
+
+	DBUG_RETURN(NULL);
+}
+
+/****************************************************************//**
+Stops checking the index condition pushed by idx_cond_push(). */
+UNIV_INTERN
+void
+ha_innobase::cancel_pushed_idx_cond(void)
+/*=====================================*/
+{
+	handler::cancel_pushed_idx_cond();
+	prebuilt->idx_cond = NULL;
+}
+
+/*********************************************************************//**
+Checks the index condition pushed down by MySQL, see
+handler_index_cond_check().
+@return ICP_NO_MATCH, ICP_MATCH, or ICP_OUT_OF_RANGE */
+extern "C" UNIV_INTERN
+enum icp_result
+innobase_index_cond(
+/*================*/
+	void*	file)	/*!< in/out: pointer to ha_innobase */
+{
+	return(handler_index_cond_check(file));
+}
+
 /****************************************************************//**
 Initialize a table scan.
 @return	0 or error number */
@@ -9142,6 +9278,8 @@ UNIV_INTERN
 int
 ha_innobase::reset()
 {
+	ds_mrr.reset();
+
 	if (prebuilt->blob_heap) {
 		row_mysql_prebuilt_free_blob_heap(prebuilt);
 	}
@@ -9296,6 +9434,12 @@ ha_innobase::external_lock(
 	DBUG_ENTER("ha_innobase::external_lock");
 	DBUG_PRINT("enter",("lock_type: %d", lock_type));
 
+	if (lock_type == F_UNLCK) {
+		/* Release the clone of a range scan in primary key order
+		before this handle stops counting as a table in use */
+		ds_mrr.reset();
+	}
+
 	update_thd(thd);
 
 	/* Statement based binlogging does not work in isolation level
@@ -10615,33 +10759,6 @@ innobase_xa_prepare(
 
 	srv_active_wake_master_thread();
 
-	if (thd_sql_command(thd) != SQLCOM_XA_PREPARE
-	    && (all
-		|| !thd_test_options(
-			thd, OPTION_NOT_AUTOCOMMIT | OPTION_BEGIN))) {
-
-		/* For ibbackup to work the order of transactions in binlog
-		and InnoDB must be the same. Consider the situation
-
-		  thread1> prepare; write to binlog; ...
-			  <context switch>
-		  thread2> prepare; write to binlog; commit
-		  thread1>			     ... commit
-
-		To ensure this will not happen we're taking the mutex on
-		prepare, and releasing it on commit.
-
-		Note: only do it for normal commits, done via ha_commit_trans.
-		If 2pc protocol is executed by external transaction
-		coordinator, it will be just a regular MySQL client
-		executing XA PREPARE and XA COMMIT commands.
-		In this case we cannot know how many minutes or hours
-		will be between XA PREPARE and XA COMMIT, and we don't want
-		to block for undefined period of time. */
-		mysql_mutex_lock(&prepare_commit_mutex);
-		trx_owns_prepare_commit_mutex_set(trx);
-	}
-
 	return(error);
 }
 
@@ -11217,6 +11334,66 @@ innodb_adaptive_hash_index_update(
 	}
 }
 
+/****************************************************************//**
+Trigger a dump of the buffer pool if innodb_buffer_pool_dump_now is set
+to ON. This function is registered as a callback with MySQL. */
+static
+void
+buffer_pool_dump_now(
+/*=================*/
+	THD*				thd,	/*!< in: thread handle */
+	struct st_mysql_sys_var*	var,	/*!< in: pointer to system
+						variable */
+	void*				var_ptr,/*!< out: where the formal
+						string goes */
+	const void*			save)	/*!< in: immediate result from
+						check function */
+{
+	if (*(my_bool*) save) {
+		buf_dump_start();
+	}
+}
+
+/****************************************************************//**
+Trigger a load of the buffer pool if innodb_buffer_pool_load_now is set
+to ON. This function is registered as a callback with MySQL. */
+static
+void
+buffer_pool_load_now(
+/*=================*/
+	THD*				thd,	/*!< in: thread handle */
+	struct st_mysql_sys_var*	var,	/*!< in: pointer to system
+						variable */
+	void*				var_ptr,/*!< out: where the formal
+						string goes */
+	const void*			save)	/*!< in: immediate result from
+						check function */
+{
+	if (*(my_bool*) save) {
+		buf_load_start();
+	}
+}
+
+/****************************************************************//**
+Abort a load of the buffer pool if innodb_buffer_pool_load_abort
+is set to ON. This function is registered as a callback with MySQL. */
+static
+void
+buffer_pool_load_abort(
+/*===================*/
+	THD*				thd,	/*!< in: thread handle */
+	struct st_mysql_sys_var*	var,	/*!< in: pointer to system
+						variable */
+	void*				var_ptr,/*!< out: where the formal
+						string goes */
+	const void*			save)	/*!< in: immediate result from
+						check function */
+{
+	if (*(my_bool*) save) {
+		buf_load_abort();
+	}
+}
+
 /****************************************************************//**
 Update the system variable innodb_old_blocks_pct using the "saved"
 value. This function is registered as a callback with MySQL. */
@@ -11459,6 +11636,16 @@ static MYSQL_SYSVAR_BOOL(checksums, innobase_use_checksums,
   "Disable with --skip-innodb-checksums.",
   NULL, NULL, TRUE);
 
+static MYSQL_SYSVAR_ENUM(checksum_algorithm, srv_checksum_algorithm,
+  PLUGIN_VAR_RQCMDARG,
+  "The algorithm InnoDB uses for page checksumming when writing pages. "
+  "Possible values are CRC32 (hardware accelerated if the CPU supports "
+  "it), INNODB (the default, for compatibility with older versions) and "
+  "NONE. Pages written with any of these algorithms are accepted when "
+  "reading, so the setting can be changed at any time.",
+  NULL, NULL, SRV_CHECKSUM_ALGORITHM_INNODB,
+  &innodb_checksum_algorithm_typelib);
+
 static MYSQL_SYSVAR_STR(data_home_dir, innobase_data_home_dir,
   PLUGIN_VAR_READONLY,
   "The common part for InnoDB table spaces.",
@@ -11491,13 +11678,25 @@ static MYSQL_SYSVAR_ULONG(rollback_segments, srv_rollback_segments,
   1,			/* Minimum value */
   TRX_SYS_N_RSEGS, 0);	/* Maximum value */
 
+static MYSQL_SYSVAR_ULONG(merge_sort_threads, srv_merge_sort_threads,
+  PLUGIN_VAR_OPCMDARG,
+  "Number of threads that scan the clustered index and merge sorted runs "
+  "in parallel when creating indexes. Each thread uses 3 MiB of merge "
+  "buffers, and while scanning 1 MiB plus a sort buffer per new index.",
+  NULL, NULL,
+  4,			/* Default setting */
+  1,			/* Minimum value */
+  64, 0);		/* Maximum value */
+
 static MYSQL_SYSVAR_ULONG(purge_threads, srv_n_purge_threads,
   PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
-  "Purge threads can be either 0 or 1.",
+  "Number of purge threads. 0 lets the master thread do the purge, N > 0 "
+  "starts a purge thread and N - 1 purge worker threads that purge the "
+  "records of different tables in parallel.",
   NULL, NULL,
   0,			/* Default setting */
   0,			/* Minimum value */
-  1, 0);		/* Maximum value */
+  UNIV_MAX_PARALLELISM, 0);	/* Maximum value */
 
 static MYSQL_SYSVAR_ULONG(fast_shutdown, innobase_fast_shutdown,
   PLUGIN_VAR_OPCMDARG,
@@ -11618,6 +11817,13 @@ static MYSQL_SYSVAR_BOOL(adaptive_hash_index, btr_search_enabled,
   "Disable with --skip-innodb-adaptive-hash-index.",
   NULL, innodb_adaptive_hash_index_update, TRUE);
 
+static MYSQL_SYSVAR_ULONG(adaptive_hash_index_parts, btr_search_n_parts,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of partitions of the InnoDB adaptive hash index. Each index is "
+  "mapped to one partition by its index id, and each partition has a "
+  "latch of its own.",
+  NULL, NULL, 8, 1, 512, 0);
+
 static MYSQL_SYSVAR_ULONG(replication_delay, srv_replication_delay,
   PLUGIN_VAR_RQCMDARG,
   "Replication thread delay (ms) on the slave server if "
@@ -11651,6 +11857,42 @@ static MYSQL_SYSVAR_LONG(buffer_pool_instances, innobase_buffer_pool_instances,
   "Number of buffer pool instances, set to higher value on high-end machines to increase scalability",
   NULL, NULL, 1L, 1L, MAX_BUFFER_POOLS, 1L);
 
+static MYSQL_SYSVAR_STR(buffer_pool_filename, srv_buf_dump_filename,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_MEMALLOC,
+  "Filename to/from which to dump/load the InnoDB buffer pool",
+  NULL, NULL, SRV_BUF_DUMP_FILENAME_DEFAULT);
+
+/* These are dummy variables; setting them only triggers the action
+through the update callback. */
+static my_bool	innodb_buffer_pool_dump_now = FALSE;
+static my_bool	innodb_buffer_pool_load_now = FALSE;
+static my_bool	innodb_buffer_pool_load_abort = FALSE;
+
+static MYSQL_SYSVAR_BOOL(buffer_pool_dump_now, innodb_buffer_pool_dump_now,
+  PLUGIN_VAR_RQCMDARG,
+  "Trigger an immediate dump of the buffer pool into a file named @@innodb_buffer_pool_filename",
+  NULL, buffer_pool_dump_now, FALSE);
+
+static MYSQL_SYSVAR_BOOL(buffer_pool_dump_at_shutdown, srv_buffer_pool_dump_at_shutdown,
+  PLUGIN_VAR_RQCMDARG,
+  "Dump the buffer pool into a file named @@innodb_buffer_pool_filename",
+  NULL, NULL, FALSE);
+
+static MYSQL_SYSVAR_BOOL(buffer_pool_load_now, innodb_buffer_pool_load_now,
+  PLUGIN_VAR_RQCMDARG,
+  "Trigger an immediate load of the buffer pool from a file named @@innodb_buffer_pool_filename",
+  NULL, buffer_pool_load_now, FALSE);
+
+static MYSQL_SYSVAR_BOOL(buffer_pool_load_abort, innodb_buffer_pool_load_abort,
+  PLUGIN_VAR_RQCMDARG,
+  "Abort a currently running load of the buffer pool",
+  NULL, buffer_pool_load_abort, FALSE);
+
+static MYSQL_SYSVAR_BOOL(buffer_pool_load_at_startup, srv_buffer_pool_load_at_startup,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Load the buffer pool from a file named @@innodb_buffer_pool_filename",
+  NULL, NULL, FALSE);
+
 static MYSQL_SYSVAR_ULONG(commit_concurrency, innobase_commit_concurrency,
   PLUGIN_VAR_RQCMDARG,
   "Helps in performance tuning in heavily concurrent environments.",
@@ -11825,6 +12067,13 @@ static MYSQL_SYSVAR_BOOL(print_all_deadlocks, srv_print_all_deadlocks,
   "Print all deadlocks to MySQL error log (off by default)",
   NULL, NULL, FALSE);
 
+static MYSQL_SYSVAR_BOOL(deadlock_detect, srv_deadlock_detect,
+  PLUGIN_VAR_OPCMDARG,
+  "Check lock waits for deadlocks (on by default). When off, deadlocks "
+  "are resolved only by innodb_lock_wait_timeout, which avoids the cost "
+  "of the check when many transactions wait for the same row.",
+  NULL, NULL, TRUE);
+
 static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(additional_mem_pool_size),
   MYSQL_SYSVAR(autoextend_increment),
@@ -11833,7 +12082,14 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
 #endif /* !DBUG_OFF */
   MYSQL_SYSVAR(buffer_pool_size),
   MYSQL_SYSVAR(buffer_pool_instances),
+  MYSQL_SYSVAR(buffer_pool_filename),
+  MYSQL_SYSVAR(buffer_pool_dump_now),
+  MYSQL_SYSVAR(buffer_pool_dump_at_shutdown),
+  MYSQL_SYSVAR(buffer_pool_load_now),
+  MYSQL_SYSVAR(buffer_pool_load_abort),
+  MYSQL_SYSVAR(buffer_pool_load_at_startup),
   MYSQL_SYSVAR(checksums),
+  MYSQL_SYSVAR(checksum_algorithm),
   MYSQL_SYSVAR(commit_concurrency),
   MYSQL_SYSVAR(concurrency_tickets),
   MYSQL_SYSVAR(data_file_path),
@@ -11873,6 +12129,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(stats_on_metadata),
   MYSQL_SYSVAR(stats_sample_pages),
   MYSQL_SYSVAR(adaptive_hash_index),
+  MYSQL_SYSVAR(adaptive_hash_index_parts),
   MYSQL_SYSVAR(stats_method),
   MYSQL_SYSVAR(replication_delay),
   MYSQL_SYSVAR(status_file),
@@ -11896,6 +12153,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(io_capacity),
   MYSQL_SYSVAR(purge_threads),
   MYSQL_SYSVAR(purge_batch_size),
+  MYSQL_SYSVAR(merge_sort_threads),
   MYSQL_SYSVAR(rollback_segments),
 #ifdef UNIV_DEBUG
   MYSQL_SYSVAR(trx_rseg_n_slots_debug),
@@ -11903,6 +12161,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(trx_purge_view_update_only_debug),
 #endif /* UNIV_DEBUG */
   MYSQL_SYSVAR(print_all_deadlocks),
+  MYSQL_SYSVAR(deadlock_detect),
   NULL
 };
 
@@ -97,6 +97,8 @@ class ha_innobase: public handler
 					ROW_SEL_EXACT, ROW_SEL_EXACT_PREFIX,
 					or undefined */
 	uint		num_write_row;	/*!< number of write_row() calls */
+	DsMrr_impl	ds_mrr;		/*!< reads the rows of range scans
+					in primary key order */
 
 	uint store_key_val_for_row(uint keynr, char* buff, uint buff_len,
                                    const uchar* record);
@@ -159,6 +161,14 @@ class ha_innobase: public handler
 	int index_prev(uchar * buf);
 	int index_first(uchar * buf);
 	int index_last(uchar * buf);
+	int read_multi_range_first(KEY_MULTI_RANGE **found_range_p,
+				   KEY_MULTI_RANGE *ranges, uint range_count,
+				   bool sorted, HANDLER_BUFFER *buffer);
+	int read_multi_range_next(KEY_MULTI_RANGE **found_range_p);
+	bool multi_range_read_info(uint keynr, ha_rows rows, uint *bufsz,
+				   ha_rows *buf_rows);
+	Item* idx_cond_push(uint keyno, Item* idx_cond);
+	void cancel_pushed_idx_cond();
 
 	int rnd_init(bool scan);
 	int rnd_end();
@@ -252,6 +262,21 @@ const char* mysql_bin_log_file_name(void);
  */
 ulonglong mysql_bin_log_file_pos(void);
 
+/** Get the end position in the MySQL binlog of the transaction being
+ * committed by a thread.
+ * @return byte offset from the beginning of the binlog
+ */
+ulonglong mysql_bin_log_commit_pos(MYSQL_THD thd);
+
+/** Wait until all the transactions written to the MySQL binlog before
+ * the one being committed by a thread have been committed by the
+ * engines. */
+void mysql_bin_log_commit_order_wait(MYSQL_THD thd);
+
+/** Let the next transaction of the MySQL binlog be committed by the
+ * engines. */
+void mysql_bin_log_commit_order_done(MYSQL_THD thd);
+
 /**
   Check if a user thread is a replication slave thread
   @param thd  user thread
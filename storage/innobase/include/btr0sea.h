@@ -35,12 +35,14 @@ Created 2/17/1996 Heikki Tuuri
 #include "ha0ha.h"
 
 /*****************************************************************//**
-Creates and initializes the adaptive search system at a database start. */
+Creates and initializes the adaptive search system at a database start.
+The system is split into btr_search_n_parts partitions. */
 UNIV_INTERN
 void
 btr_search_sys_create(
 /*==================*/
-	ulint	hash_size);	/*!< in: hash index hash table size */
+	ulint	hash_size);	/*!< in: hash index hash table size,
+				summed over all partitions */
 /*****************************************************************//**
 Frees the adaptive search system at a database shutdown. */
 UNIV_INTERN
@@ -79,13 +81,30 @@ btr_search_info_create(
 	mem_heap_t*	heap);	/*!< in: heap where created */
 /*****************************************************************//**
 Returns the value of ref_count. The value is protected by
-btr_search_latch.
+the adaptive hash index partition latch of the index.
 @return	ref_count value. */
 UNIV_INTERN
 ulint
 btr_search_info_get_ref_count(
 /*==========================*/
-	btr_search_t*   info);	/*!< in: search info. */
+	btr_search_t*		info,	/*!< in: search info. */
+	const dict_index_t*	index);	/*!< in: index of info */
+/********************************************************************//**
+Gets the adaptive hash index partition of an index.
+@return	partition */
+UNIV_INLINE
+btr_search_part_t*
+btr_search_get_part(
+/*================*/
+	const dict_index_t*	index);	/*!< in: index */
+/********************************************************************//**
+Gets the latch protecting the adaptive hash index partition of an index.
+@return	latch */
+UNIV_INLINE
+rw_lock_t*
+btr_search_get_latch(
+/*=================*/
+	const dict_index_t*	index);	/*!< in: index */
 /*********************************************************************//**
 Updates the search info. */
 UNIV_INLINE
@@ -111,7 +130,8 @@ btr_search_guess_on_hash(
 	ulint		latch_mode,	/*!< in: BTR_SEARCH_LEAF, ... */
 	btr_cur_t*	cursor,		/*!< out: tree cursor */
 	ulint		has_search_latch,/*!< in: latch mode the caller
-					currently has on btr_search_latch:
+					currently has on
+					btr_search_get_latch(index):
 					RW_S_LATCH, RW_X_LATCH, or 0 */
 	mtr_t*		mtr);		/*!< in: mtr */
 /********************************************************************//**
@@ -195,7 +215,8 @@ struct btr_search_struct{
 	ulint	ref_count;	/*!< Number of blocks in this index tree
 				that have search index built
 				i.e. block->index points to this index.
-				Protected by btr_search_latch except
+				Protected by the partition latch
+				btr_search_get_latch(index) except
 				when during initialization in
 				btr_search_info_create(). */
 
@@ -245,19 +266,41 @@ struct btr_search_struct{
 #endif /* UNIV_DEBUG */
 };
 
+/** A partition of the hash index system */
+struct btr_search_part_struct{
+	rw_lock_t*	latch;		/*!< the latch protecting this
+					partition; allocated from dynamic
+					memory, see btr0sea.c */
+	hash_table_t*	hash_index;	/*!< the adaptive hash index of the
+					index trees mapped to this partition,
+					mapping dtuple_fold values
+					to rec_t pointers on index pages */
+	ulint		n_hash_succ;	/*!< number of successful lookups
+					in this partition; not protected
+					by any latch, for monitoring only */
+	ulint		n_hash_fail;	/*!< number of failed lookups
+					in this partition; not protected
+					by any latch, for monitoring only */
+	byte		pad[64];	/*!< padding to keep the counters
+					of neighbouring partitions on
+					different cache lines */
+};
+
 /** The hash index system */
 typedef struct btr_search_sys_struct	btr_search_sys_t;
 
 /** The hash index system */
 struct btr_search_sys_struct{
-	hash_table_t*	hash_index;	/*!< the adaptive hash index,
-					mapping dtuple_fold values
-					to rec_t pointers on index pages */
+	btr_search_part_t*	parts;	/*!< array of n_parts partitions */
+	ulint			n_parts;/*!< number of partitions */
 };
 
 /** The adaptive hash index */
 extern btr_search_sys_t*	btr_search_sys;
 
+/** Number of adaptive hash index partitions to create at startup */
+extern ulong	btr_search_n_parts;
+
 #ifdef UNIV_SEARCH_PERF_STAT
 /** Number of successful adaptive hash index lookups */
 extern ulint	btr_search_n_succ;
@@ -38,14 +38,18 @@ typedef struct btr_pcur_struct		btr_pcur_t;
 typedef struct btr_cur_struct		btr_cur_t;
 /** B-tree search information for the adaptive hash index */
 typedef struct btr_search_struct	btr_search_t;
+/** A partition of the adaptive hash index */
+typedef struct btr_search_part_struct	btr_search_part_t;
 
 #ifndef UNIV_HOTBACKUP
 
-/** @brief The latch protecting the adaptive search system
+/** @brief The latches protecting the adaptive search system
 
-This latch protects the
-(1) hash index;
-(2) columns of a record to which we have a pointer in the hash index;
+The adaptive hash index is split into btr_search_sys->n_parts
+partitions, and an index tree is mapped to one of them by its index
+id. The latch of a partition protects the
+(1) hash index of that partition;
+(2) columns of a record to which we have a pointer in that hash index;
 
 but does NOT protect:
 
@@ -53,16 +57,34 @@ but does NOT protect:
 (4) next or previous records on the same page.
 
 Bear in mind (3) and (4) when using the hash index.
-*/
-extern rw_lock_t*	btr_search_latch_temp;
+See btr_search_get_latch(). */
 
-#endif /* UNIV_HOTBACKUP */
+# ifdef UNIV_SYNC_DEBUG
+/********************************************************************//**
+Checks if the thread owns the latches of all adaptive hash index
+partitions in the given mode.
+@return	TRUE if all of them are owned */
+UNIV_INTERN
+ibool
+btr_search_own_all(
+/*===============*/
+	ulint	lock_type);	/*!< in: RW_LOCK_SHARED or RW_LOCK_EX */
+/********************************************************************//**
+Checks if the thread owns the latch of any adaptive hash index
+partition in the given mode.
+@return	TRUE if some latch is owned */
+UNIV_INTERN
+ibool
+btr_search_own_any(
+/*===============*/
+	ulint	lock_type);	/*!< in: RW_LOCK_SHARED or RW_LOCK_EX */
+# endif /* UNIV_SYNC_DEBUG */
 
-/** The latch protecting the adaptive search system */
-#define btr_search_latch	(*btr_search_latch_temp)
+#endif /* UNIV_HOTBACKUP */
 
 /** Flag: has the search system been enabled?
-Protected by btr_search_latch. */
+Protected by the latches of all adaptive hash index partitions:
+it is only changed while all of them are x-latched. */
 extern char	btr_search_enabled;
 
 #ifdef UNIV_BLOB_DEBUG
@@ -74,8 +74,10 @@ Created 11/5/1995 Heikki Tuuri
 					/*!< The maximum number of buffer
 					pools that can be defined */
 
-#define BUF_POOL_WATCH_SIZE 1		/*!< Maximum number of concurrent
-					buffer pool watches */
+#define BUF_POOL_WATCH_SIZE UNIV_MAX_PARALLELISM
+					/*!< Maximum number of concurrent
+					buffer pool watches: one per purge
+					thread, see innodb_purge_threads */
 
 extern	buf_pool_t*	buf_pool_ptr;	/*!< The buffer pools
 					of the database */
@@ -657,6 +659,17 @@ buf_calc_page_old_checksum(
 /*=======================*/
 	const byte*	 page);	/*!< in: buffer page */
 /********************************************************************//**
+Calculates the CRC32C checksum of a page. The value is stored to the page
+when it is written to a file with innodb_checksum_algorithm=crc32, both to
+FIL_PAGE_SPACE_OR_CHKSUM and to the old formula checksum field at the end
+of the page.
+@return	checksum */
+UNIV_INTERN
+ib_uint32_t
+buf_calc_page_crc32(
+/*================*/
+	const byte*	page);	/*!< in: buffer page */
+/********************************************************************//**
 Checks if a page is corrupt.
 @return	TRUE if corrupted */
 UNIV_INTERN
@@ -1620,7 +1633,8 @@ struct buf_block_struct{
 
 	/** @name Hash search fields
 	These 5 fields may only be modified when we have
-	an x-latch on btr_search_latch AND
+	an x-latch on the adaptive hash index partition latch
+	of the index, btr_search_get_latch(index), AND
 	- we are holding an s-latch or x-latch on buf_block_struct::lock or
 	- we know that buf_block_struct::buf_fix_count == 0.
 
@@ -1628,7 +1642,8 @@ struct buf_block_struct{
 	in the buffer pool in buf0buf.c.
 
 	Another exception is that assigning block->index = NULL
-	is allowed whenever holding an x-latch on btr_search_latch. */
+	is allowed whenever holding an x-latch on the partition
+	latch of block->index. */
 
 	/* @{ */
 
@@ -0,0 +1,92 @@
+/*****************************************************************************
+
+Copyright (c) 2012, Oracle and/or its affiliates. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file include/buf0dump.h
+Implements a buffer pool dump/load.
+
+The dump is a text file with one "space,page_no" line for every page in
+the LRU lists of the buffer pool instances. The load reads the file back,
+sorts the entries and issues asynchronous reads for them in the background.
+*******************************************************/
+
+#ifndef buf0dump_h
+#define buf0dump_h
+
+#include "univ.i"
+#include "os0thread.h"
+
+/** TRUE while the buffer pool dump/load thread is running */
+extern ibool	buf_dump_thread_active;
+
+/*****************************************************************//**
+Wakes up the buffer pool dump/load thread and instructs it to start
+a dump. This function is called by MySQL code via buffer_pool_dump_now()
+and it should return immediately because the whole MySQL is frozen during
+its execution. */
+UNIV_INTERN
+void
+buf_dump_start(void);
+/*================*/
+
+/*****************************************************************//**
+Wakes up the buffer pool dump/load thread and instructs it to start
+a load. This function is called by MySQL code via buffer_pool_load_now()
+and it should return immediately because the whole MySQL is frozen during
+its execution. */
+UNIV_INTERN
+void
+buf_load_start(void);
+/*================*/
+
+/*****************************************************************//**
+Aborts a currently running buffer pool load. This function is called by
+MySQL code via buffer_pool_load_abort() and it should return immediately
+because the whole MySQL is frozen during its execution. */
+UNIV_INTERN
+void
+buf_load_abort(void);
+/*================*/
+
+/*****************************************************************//**
+Copies the current dump and load status messages, to be shown in
+SHOW STATUS. */
+UNIV_INTERN
+void
+buf_dump_status_get(
+/*================*/
+	char*	dump_status,	/*!< out: dump status */
+	ulint	dump_size,	/*!< in: size of dump_status */
+	char*	load_status,	/*!< out: load status */
+	ulint	load_size);	/*!< in: size of load_status */
+
+/*****************************************************************//**
+This is the main thread for buffer pool dump/load. It waits for an
+event and when waked up either performs a dump or load and sleeps
+again. At startup it loads the buffer pool if
+innodb_buffer_pool_load_at_startup is set, and at shutdown it dumps
+the buffer pool if innodb_buffer_pool_dump_at_shutdown is set.
+@return this function does not return, it calls os_thread_exit() */
+UNIV_INTERN
+os_thread_ret_t
+buf_dump_thread(
+/*============*/
+	void*	arg);	/*!< in: a dummy parameter required by
+			os_thread_create */
+
+#endif /* buf0dump_h */
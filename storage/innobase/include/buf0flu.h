@@ -32,6 +32,14 @@ Created 11/5/1995 Heikki Tuuri
 #include "mtr0types.h"
 #include "buf0types.h"
 #include "log0log.h"
+#include "os0sync.h"
+
+/** Event to wake up the page cleaner thread */
+extern os_event_t	buf_flush_event;
+/** Event set by the page cleaner after each pass over the LRU lists */
+extern os_event_t	buf_flush_LRU_event;
+/** TRUE while the page cleaner thread is running */
+extern ibool		buf_page_cleaner_is_active;
 
 /********************************************************************//**
 Remove a block from the flush list of modified blocks. */
@@ -220,6 +228,29 @@ UNIV_INTERN
 ulint
 buf_flush_get_desired_flush_rate(void);
 /*==================================*/
+/*********************************************************************//**
+Asks the page cleaner thread to flush the LRU lists and waits a while
+for it to do so. This is used by threads which cannot find a free block
+in buf_pool.
+@return	TRUE if the page cleaner made a pass over the LRU lists, FALSE if
+it is not running or did not respond in time, in which case the caller
+must flush the LRU list itself */
+UNIV_INTERN
+ibool
+buf_flush_page_cleaner_wait_LRU(
+/*============================*/
+	buf_pool_t*	buf_pool);	/*!< in: buffer pool instance */
+/*********************************************************************//**
+The page cleaner thread. Keeps the free margins of the LRU lists topped
+up and flushes the flush lists at a rate driven by redo generation and
+checkpoint age.
+@return	a dummy parameter */
+UNIV_INTERN
+os_thread_ret_t
+buf_flush_page_cleaner_thread(
+/*==========================*/
+	void*	arg);	/*!< in: a dummy parameter required by
+			os_thread_create */
 
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
 /******************************************************************//**
@@ -146,6 +146,21 @@ buf_read_recv_pages(
 					array */
 	ulint		n_stored);	/*!< in: number of page numbers
 					in the array */
+/********************************************************************//**
+Issues read requests for pages which the buffer pool load wants to read
+in, in order to warm up the buffer pool after a restart. Pages whose
+tablespace no longer exists or which lie beyond the end of their
+tablespace are silently skipped. The caller should pass the pages sorted
+by (space, page_no) so that the reads are as sequential as possible.
+@return	number of page read requests issued */
+UNIV_INTERN
+ulint
+buf_read_load_pages(
+/*================*/
+	const ulint*	space_ids,	/*!< in: array of space ids */
+	const ulint*	page_nos,	/*!< in: array of page numbers */
+	ulint		n_stored);	/*!< in: number of elements
+					in the arrays */
 
 /** The size in pages of the area which the read-ahead algorithms read if
 invoked */
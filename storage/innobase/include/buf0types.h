@@ -72,6 +72,19 @@ enum buf_remove_t {
 					don't write or sync to disk */
 };
 
+/** Alternatives for srv_checksum_algorithm, which can be changed by
+setting innodb_checksum_algorithm */
+enum srv_checksum_algorithm_enum {
+	SRV_CHECKSUM_ALGORITHM_CRC32,	/*!< Write crc32c, allow crc32c,
+					innodb or none when reading */
+	SRV_CHECKSUM_ALGORITHM_INNODB,	/*!< Write innodb, allow crc32c,
+					innodb or none when reading */
+	SRV_CHECKSUM_ALGORITHM_NONE	/*!< Write none, allow crc32c,
+					innodb or none when reading */
+};
+
+typedef enum srv_checksum_algorithm_enum	srv_checksum_algorithm_t;
+
 /** Parameters of binary buddy system for compressed pages (buf0buddy.h) */
 /* @{ */
 #define BUF_BUDDY_LOW_SHIFT	PAGE_ZIP_MIN_SIZE_SHIFT
@@ -29,6 +29,7 @@ Created 5/11/2006 Osku Salerma
 
 #include "trx0types.h"
 #include "m_ctype.h" /* CHARSET_INFO */
+#include "my_base.h" /* enum icp_result */
 
 /*********************************************************************//**
 Wrapper around MySQL's copy_and_convert function.
@@ -326,5 +327,15 @@ innobase_convert_to_filename_charset(
 	const char*     from,   /* in: identifier to convert */
 	ulint           len);   /* in: length of 'to', in bytes */
 
+/*********************************************************************//**
+Checks the index condition pushed down by MySQL on the index columns
+stored in the MySQL record buffer.
+@return ICP_NO_MATCH, ICP_MATCH, or ICP_OUT_OF_RANGE */
+UNIV_INTERN
+enum icp_result
+innobase_index_cond(
+/*================*/
+	void*	file);	/*!< in/out: pointer to ha_innobase */
+
 
 #endif
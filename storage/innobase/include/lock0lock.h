@@ -597,8 +597,8 @@ lock_check_trx_id_sanity(
 	const rec_t*	rec,		/*!< in: user record */
 	dict_index_t*	index,		/*!< in: clustered index */
 	const ulint*	offsets,	/*!< in: rec_get_offsets(rec, index) */
-	ibool		has_kernel_mutex);/*!< in: TRUE if the caller owns the
-					kernel mutex */
+	ibool		has_trx_sys_mutex);/*!< in: TRUE if the caller owns
+					trx_sys->mutex */
 /*********************************************************************//**
 Prints info of a table lock. */
 UNIV_INTERN
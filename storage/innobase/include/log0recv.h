@@ -381,6 +381,7 @@ typedef struct recv_sys_struct	recv_sys_t;
 struct recv_sys_struct{
 #ifndef UNIV_HOTBACKUP
 	mutex_t		mutex;	/*!< mutex protecting the fields apply_log_recs,
+				apply_next_cell, n_apply_threads,
 				n_addrs, and the state field in each recv_addr
 				struct */
 #endif /* !UNIV_HOTBACKUP */
@@ -392,6 +393,14 @@ struct recv_sys_struct{
 	ibool		apply_batch_on;
 				/*!< this is TRUE when a log rec application
 				batch is running */
+	ulint		apply_next_cell;
+				/*!< the next cell of addr_hash to be
+				handed out to a thread applying the
+				current batch */
+	ulint		n_apply_threads;
+				/*!< number of recovery apply threads
+				that are still working on the current
+				batch */
 	ib_uint64_t	lsn;	/*!< log sequence number */
 	ulint		last_log_buf_size;
 				/*!< size of the log buffer when the database
@@ -445,8 +445,22 @@ UNIV_INTERN
 ulint
 page_zip_calc_checksum(
 /*===================*/
-        const void*     data,   /*!< in: compressed page */
-        ulint           size)   /*!< in: size of compressed page */
+	const void*	data,	/*!< in: compressed page */
+	ulint		size,	/*!< in: size of compressed page */
+	srv_checksum_algorithm_t algo)
+				/*!< in: algorithm to use */
+	__attribute__((nonnull));
+
+/**********************************************************************//**
+Verify a compressed page's checksum. A checksum written with any of
+the srv_checksum_algorithm_t algorithms is accepted.
+@return	TRUE if the stored checksum is valid */
+UNIV_INTERN
+ibool
+page_zip_verify_checksum(
+/*=====================*/
+	const void*	data,	/*!< in: compressed page */
+	ulint		size)	/*!< in: size of compressed page */
 	__attribute__((nonnull));
 
 #ifndef UNIV_HOTBACKUP
@@ -36,7 +36,7 @@ Created 2/16/1997 Heikki Tuuri
 
 /*********************************************************************//**
 Opens a read view where exactly the transactions serialized before this
-point in time are seen in the view.
+point in time are seen in the view. The caller must own trx_sys->mutex.
 @return	own: read view struct */
 UNIV_INTERN
 read_view_t*
@@ -48,7 +48,7 @@ read_view_open_now(
 					allocated */
 /*********************************************************************//**
 Makes a copy of the oldest existing read view, or opens a new. The view
-must be closed with ..._close.
+must be closed with ..._close. The caller must own trx_sys->mutex.
 @return	own: read view struct */
 UNIV_INTERN
 read_view_t*
@@ -59,7 +59,7 @@ read_view_oldest_copy_or_open_new(
 	mem_heap_t*	heap);		/*!< in: memory heap from which
 					allocated */
 /*********************************************************************//**
-Closes a read view. */
+Closes a read view. The caller must own trx_sys->read_view_mutex. */
 UNIV_INTERN
 void
 read_view_close(
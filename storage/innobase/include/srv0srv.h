@@ -66,6 +66,18 @@ extern os_event_t	srv_timeout_event;
 /* The error monitor thread waits on this event. */
 extern os_event_t	srv_error_event;
 
+/* The buffer pool dump/load thread waits on this event. */
+extern os_event_t	srv_buf_dump_event;
+
+/** The buffer pool dump/load file name */
+#define SRV_BUF_DUMP_FILENAME_DEFAULT	"ib_buffer_pool"
+extern char*		srv_buf_dump_filename;
+
+/** Boolean config knobs that tell InnoDB to dump the buffer pool at shutdown
+and/or load it during startup. */
+extern my_bool		srv_buffer_pool_dump_at_shutdown;
+extern my_bool		srv_buffer_pool_load_at_startup;
+
 /* If the last data file is auto-extended, we add this many pages to it
 at a time */
 #define SRV_AUTO_EXTEND_INCREMENT	\
@@ -213,6 +225,10 @@ extern unsigned long long	srv_stats_sample_pages;
 
 extern ibool	srv_use_doublewrite_buf;
 extern ibool	srv_use_checksums;
+/* The "innodb_checksum_algorithm" setting, a srv_checksum_algorithm_t.
+It is not defined as enum type because the configure option takes
+unsigned integer type. */
+extern ulong	srv_checksum_algorithm;
 
 extern ulong	srv_max_buf_pool_modified_pct;
 extern ulong	srv_max_purge_lag;
@@ -298,7 +314,9 @@ extern ulint srv_os_log_pending_writes;
 log buffer and have to flush it */
 extern ulint srv_log_waits;
 
-/* the number of purge threads to use from the worker pool (currently 0 or 1) */
+/* the number of purge threads: 0 lets the master thread do the purge,
+1 or more starts a purge thread and srv_n_purge_threads - 1 purge worker
+threads */
 extern ulong srv_n_purge_threads;
 
 /* the number of pages to purge in one batch */
@@ -307,6 +325,10 @@ extern ulong srv_purge_batch_size;
 /* the number of rollback segments to use */
 extern ulong srv_rollback_segments;
 
+/* the number of threads that scan the clustered index and merge the
+runs of a merge sort pass when creating indexes */
+extern ulong srv_merge_sort_threads;
+
 /* variable that counts amount of data read in total (in bytes) */
 extern ulint srv_data_read;
 
@@ -340,6 +362,19 @@ extern ulint srv_buf_pool_reads;
 /** print all user-level transactions deadlocks to mysqld stderr */
 extern my_bool srv_print_all_deadlocks;
 
+/** If this is FALSE, lock waits are not checked for deadlocks; a
+deadlock is then resolved by innodb_lock_wait_timeout */
+extern my_bool srv_deadlock_detect;
+
+/** Number of deadlocks detected */
+extern ulint srv_n_deadlocks;
+
+/** Number of deadlock searches done */
+extern ulint srv_n_deadlock_searches;
+
+/** Total time spent in deadlock searches, in microseconds */
+extern ib_uint64_t srv_deadlock_search_time;
+
 /** Status variables to be passed to MySQL */
 typedef struct export_var_struct export_struc;
 
@@ -355,12 +390,17 @@ extern srv_sys_t*	srv_sys;
 # ifdef UNIV_PFS_THREAD
 /* Keys to register InnoDB threads with performance schema */
 extern mysql_pfs_key_t	trx_rollback_clean_thread_key;
+extern mysql_pfs_key_t	recv_apply_thread_key;
+extern mysql_pfs_key_t	row_merge_thread_key;
 extern mysql_pfs_key_t	io_handler_thread_key;
 extern mysql_pfs_key_t	srv_lock_timeout_thread_key;
 extern mysql_pfs_key_t	srv_error_monitor_thread_key;
 extern mysql_pfs_key_t	srv_monitor_thread_key;
 extern mysql_pfs_key_t	srv_master_thread_key;
 extern mysql_pfs_key_t	srv_purge_thread_key;
+extern mysql_pfs_key_t	srv_purge_worker_thread_key;
+extern mysql_pfs_key_t	buf_page_cleaner_thread_key;
+extern mysql_pfs_key_t	buf_dump_thread_key;
 
 /* This macro register the current thread and its key with performance
 schema */
@@ -454,6 +494,8 @@ typedef enum srv_stats_method_name_enum		srv_stats_method_name_t;
 enum srv_thread_type {
 	SRV_WORKER = 0,	/**< threads serving parallelized queries and
 			queries released from lock wait */
+	SRV_PURGE_WORKER,/**< purge worker threads, which purge their
+			share of the batches of the purge thread */
 	SRV_MASTER	/**< the master thread, (whose type number must
 			be biggest) */
 };
@@ -676,6 +718,16 @@ srv_purge_thread(
 	void*	arg __attribute__((unused))); /*!< in: a dummy parameter
 					      required by os_thread_create */
 
+/*********************************************************************//**
+Purge worker thread: purges the undo log records handed to it by the
+purge thread in trx_purge().
+@return	a dummy parameter */
+UNIV_INTERN
+os_thread_ret_t
+srv_purge_worker_thread(
+/*====================*/
+	void*	arg);	/*!< in: purge thread number, > 0 */
+
 /**********************************************************************//**
 Enqueues a task to server task queue and releases a worker thread, if there
 is a suspended one. */
@@ -705,6 +757,8 @@ struct export_var_struct{
 	ulint innodb_data_writes;		/*!< I/O write requests */
 	ulint innodb_data_written;		/*!< Data bytes written */
 	ulint innodb_data_reads;		/*!< I/O read requests */
+	char  innodb_buffer_pool_dump_status[512];/*!< Buf pool dump status */
+	char  innodb_buffer_pool_load_status[512];/*!< Buf pool load status */
 	ulint innodb_buffer_pool_pages_total;	/*!< Buffer pool size */
 	ulint innodb_buffer_pool_pages_data;	/*!< Data pages */
 	ulint innodb_buffer_pool_bytes_data;	/*!< File bytes used */
@@ -724,6 +778,10 @@ struct export_var_struct{
 	ulint innodb_buffer_pool_read_ahead;	/*!< srv_read_ahead */
 	ulint innodb_buffer_pool_read_ahead_evicted;/*!< srv_read_ahead evicted*/
 	ulint innodb_dblwr_pages_written;	/*!< srv_dblwr_pages_written */
+	ulint innodb_deadlocks;			/*!< srv_n_deadlocks */
+	ulint innodb_deadlock_searches;		/*!< srv_n_deadlock_searches */
+	ib_int64_t innodb_deadlock_search_time;	/*!< srv_deadlock_search_time,
+						in microseconds */
 	ulint innodb_dblwr_writes;		/*!< srv_dblwr_writes */
 	ibool innodb_have_atomic_builtins;	/*!< HAVE_ATOMIC_BUILTINS */
 	ulint innodb_log_waits;			/*!< srv_log_waits */
@@ -775,6 +833,7 @@ extern ulint	srv_n_threads_active[];
 #else /* !UNIV_HOTBACKUP */
 # define srv_use_adaptive_hash_indexes		FALSE
 # define srv_use_checksums			TRUE
+# define srv_checksum_algorithm			SRV_CHECKSUM_ALGORITHM_INNODB
 # define srv_use_native_aio			FALSE
 # define srv_force_recovery			0UL
 # define srv_set_io_thread_op_info(t,info)	((void) 0)
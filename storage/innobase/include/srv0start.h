@@ -29,6 +29,13 @@ Created 10/10/1995 Heikki Tuuri
 #include "univ.i"
 #include "ut0byte.h"
 
+/** Path separator of the file system */
+#ifdef __WIN__
+#define SRV_PATH_SEPARATOR	'\\'
+#else
+#define SRV_PATH_SEPARATOR	'/'
+#endif
+
 /*********************************************************************//**
 Normalizes a directory path for Windows: converts slashes to backslashes. */
 UNIV_INTERN
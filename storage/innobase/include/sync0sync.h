@@ -96,6 +96,8 @@ extern mysql_pfs_key_t	mutex_list_mutex_key;
 extern mysql_pfs_key_t	purge_sys_bh_mutex_key;
 extern mysql_pfs_key_t	recv_sys_mutex_key;
 extern mysql_pfs_key_t	rseg_mutex_key;
+extern mysql_pfs_key_t	row_merge_pass_mutex_key;
+extern mysql_pfs_key_t	row_merge_scan_mutex_key;
 # ifdef UNIV_SYNC_DEBUG
 extern mysql_pfs_key_t	rw_lock_debug_mutex_key;
 # endif /* UNIV_SYNC_DEBUG */
@@ -111,6 +113,8 @@ extern mysql_pfs_key_t	sync_thread_mutex_key;
 # endif /* UNIV_SYNC_DEBUG */
 extern mysql_pfs_key_t	trx_doublewrite_mutex_key;
 extern mysql_pfs_key_t	trx_undo_mutex_key;
+extern mysql_pfs_key_t	trx_sys_mutex_key;
+extern mysql_pfs_key_t	read_view_mutex_key;
 #endif /* UNIV_PFS_MUTEX */
 
 /******************************************************************//**
@@ -441,7 +445,7 @@ except for data dictionary latches. */
 	(!sync_thread_levels_nonempty_gen(TRUE))
 /******************************************************************//**
 Checks if the level array for the current thread is empty,
-except for the btr_search_latch.
+except for an adaptive hash index partition latch.
 @return	a latch, or NULL if empty except the exceptions specified below */
 UNIV_INTERN
 void*
@@ -449,7 +453,7 @@ sync_thread_levels_nonempty_trx(
 /*============================*/
 	ibool	has_search_latch)
 				/*!< in: TRUE if and only if the thread
-				is supposed to hold btr_search_latch */
+				is supposed to hold a search latch */
 	__attribute__((warn_unused_result));
 
 /******************************************************************//**
@@ -666,6 +670,8 @@ or row lock! */
 #define	SYNC_KERNEL		300
 #define SYNC_REC_LOCK		299
 #define	SYNC_TRX_LOCK_HEAP	298
+#define SYNC_TRX_SYS		296	/* trx_sys->mutex */
+#define SYNC_READ_VIEW		294	/* trx_sys->read_view_mutex */
 #define SYNC_TRX_SYS_HEADER	290
 #define	SYNC_PURGE_QUEUE	200
 #define SYNC_LOG		170
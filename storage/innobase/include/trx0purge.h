@@ -34,6 +34,7 @@ Created 3/26/1996 Heikki Tuuri
 #include "page0page.h"
 #include "usr0sess.h"
 #include "fil0fil.h"
+#include "row0types.h"
 
 /** The global data structure coordinating a purge */
 extern trx_purge_t*	purge_sys;
@@ -88,28 +89,10 @@ trx_purge_add_update_undo_to_history(
 	page_t*	undo_page,	/*!< in: update undo log header page,
 				x-latched */
 	mtr_t*	mtr);		/*!< in: mtr */
-/********************************************************************//**
-Fetches the next undo log record from the history list to purge. It must be
-released with the corresponding release function.
-@return copy of an undo log record or pointer to trx_purge_dummy_rec,
-if the whole undo log can skipped in purge; NULL if none left */
-UNIV_INTERN
-trx_undo_rec_t*
-trx_purge_fetch_next_rec(
-/*=====================*/
-	roll_ptr_t*	roll_ptr,/*!< out: roll pointer to undo record */
-	trx_undo_inf_t** cell,	/*!< out: storage cell for the record in the
-				purge array */
-	mem_heap_t*	heap);	/*!< in: memory heap where copied */
-/*******************************************************************//**
-Releases a reserved purge undo record. */
-UNIV_INTERN
-void
-trx_purge_rec_release(
-/*==================*/
-	trx_undo_inf_t*	cell);	/*!< in: storage cell */
 /*******************************************************************//**
-This function runs a purge batch.
+This function runs a purge batch. The undo log records of the batch are
+split by table between the purge threads, the calling thread purges its
+own share and waits for the purge worker threads to purge theirs.
 @return	number of undo log pages handled in the batch */
 UNIV_INTERN
 ulint
@@ -117,6 +100,24 @@ trx_purge(
 /*======*/
 	ulint	limit);		/*!< in: the maximum number of records to
 				purge in one batch */
+/*******************************************************************//**
+Checks if a purge worker thread has been handed undo log records to purge.
+NOTE! The kernel mutex has to be reserved by the caller!
+@return	TRUE if the thread has records to purge */
+UNIV_INTERN
+ibool
+trx_purge_worker_has_work(
+/*======================*/
+	ulint	id);		/*!< in: purge thread number, > 0 */
+/*******************************************************************//**
+Purges the undo log records handed to a purge worker thread in the current
+batch, and tells the thread running trx_purge() when all the purge worker
+threads are done. */
+UNIV_INTERN
+void
+trx_purge_worker_run(
+/*=================*/
+	ulint	id);		/*!< in: purge thread number, > 0 */
 /******************************************************************//**
 Prints information of the purge system to stderr. */
 UNIV_INTERN
@@ -124,6 +125,33 @@ void
 trx_purge_sys_print(void);
 /*======================*/
 
+/** An undo log record handed to a purge thread */
+struct trx_purge_rec_struct{
+	trx_undo_rec_t*	undo_rec;	/*!< copy of the undo log record,
+					allocated from purge_sys->batch_heap */
+	roll_ptr_t	roll_ptr;	/*!< roll pointer to the record */
+	trx_purge_rec_t* next;		/*!< next record to purge by the
+					same thread, in undo log order */
+};
+
+/** The state of a purge thread. Thread 0 is the thread calling trx_purge(),
+the other ones are purge worker threads. Every purge thread runs its own
+query graph with its own transaction, so that the threads can freeze the
+data dictionary independently of each other. */
+struct trx_purge_thr_struct{
+	sess_t*		sess;		/*!< System session running the
+					query of the thread */
+	que_t*		query;		/*!< The query graph, with a single
+					purge node */
+	purge_node_t*	node;		/*!< The purge node of query */
+	trx_purge_rec_t* last_rec;	/*!< The last record handed to the
+					thread in the current batch */
+	ibool		pending;	/*!< TRUE if the thread has been
+					handed records that it has not
+					purged yet; protected by the kernel
+					mutex */
+};
+
 /** The control structure used in the purge operation */
 struct trx_purge_struct{
 	ulint		state;		/*!< Purge system state */
@@ -178,6 +206,20 @@ struct trx_purge_struct{
 					the next record to purge belongs */
 	ulint		hdr_offset;	/*!< Header byte offset on the page */
 	/*-----------------------------*/
+	ulint		n_thrs;		/*!< Number of purge threads: 1 if
+					purge is run by the master thread,
+					else innodb_purge_threads */
+	trx_purge_thr_t* thrs;		/*!< The purge threads; thrs[0].sess
+					and thrs[0].query are sess and query
+					above */
+	ulint		n_pending;	/*!< Number of purge worker threads
+					that have not purged their share of
+					the current batch yet; protected by
+					the kernel mutex */
+	os_event_t	batch_done;	/*!< Set when n_pending drops to 0 */
+	mem_heap_t*	batch_heap;	/*!< Copies of the undo log records of
+					the current batch */
+	/*-----------------------------*/
 	trx_undo_arr_t*	arr;		/*!< Array of transaction numbers and
 					undo numbers of the undo records
 					currently under processing in purge */
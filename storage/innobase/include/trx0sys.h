@@ -216,7 +216,7 @@ trx_sysf_rseg_set_page_no(
 					the slot is reset to unused */
 	mtr_t*		mtr);		/*!< in: mtr */
 /*****************************************************************//**
-Allocates a new transaction id.
+Allocates a new transaction id. The caller must own trx_sys->mutex.
 @return	new, allocated trx id */
 UNIV_INLINE
 trx_id_t
@@ -250,6 +250,7 @@ trx_read_trx_id(
 	const byte*	ptr);	/*!< in: pointer to memory from where to read */
 /****************************************************************//**
 Looks for the trx handle with the given id in trx_list.
+The caller must own trx_sys->mutex.
 @return	the trx handle or NULL if not found */
 UNIV_INLINE
 trx_t*
@@ -260,7 +261,7 @@ trx_get_on_id(
 Returns the minumum trx id in trx list. This is the smallest id for which
 the trx can possibly be active. (But, you must look at the trx->conc_state to
 find out if the minimum trx id transaction itself is active, or already
-committed.)
+committed.) The caller must own trx_sys->mutex.
 @return	the minimum trx id, or trx_sys->max_trx_id if the trx list is empty */
 UNIV_INLINE
 trx_id_t
@@ -268,6 +269,7 @@ trx_list_get_min_trx_id(void);
 /*=========================*/
 /****************************************************************//**
 Checks if a transaction with the given id is active.
+The caller must own trx_sys->mutex.
 @return	TRUE if active */
 UNIV_INLINE
 ibool
@@ -275,6 +277,16 @@ trx_is_active(
 /*==========*/
 	trx_id_t	trx_id);/*!< in: trx id of the transaction */
 /****************************************************************//**
+Looks for an active transaction with the given id. Acquires and releases
+trx_sys->mutex. The caller should own the kernel mutex, which keeps the
+returned trx in trx_list after trx_sys->mutex has been released.
+@return	the trx handle or NULL if not found or not active */
+UNIV_INLINE
+trx_t*
+trx_get_active_on_id(
+/*=================*/
+	trx_id_t	trx_id);/*!< in: trx id of the transaction */
+/****************************************************************//**
 Checks that trx is in the trx list.
 @return	TRUE if is in */
 UNIV_INTERN
@@ -609,9 +621,26 @@ struct trx_doublewrite_struct{
 				blocks which have been cached to write_buf */
 };
 
-/** The transaction system central memory data structure; protected by the
-kernel mutex */
+/** The transaction system central memory data structure. The rollback
+segment lists and mysql_trx_list are protected by the kernel mutex, the
+transaction list and the read view list by the mutexes below. */
 struct trx_sys_struct{
+	mutex_t		mutex;		/*!< mutex protecting max_trx_id,
+					trx_list, latest_rseg and the
+					conc_state transitions of the
+					transactions in trx_list; the
+					lock system uses kernel_mutex, which
+					is acquired before this one if
+					both are needed. A transaction is
+					removed from trx_list only while
+					holding both mutexes, so that either
+					of them keeps the trx objects in the
+					list valid */
+	mutex_t		read_view_mutex;/*!< mutex protecting view_list
+					and the read_view fields of trx
+					objects; a view is inserted to
+					view_list while also holding
+					trx_sys->mutex */
 	trx_id_t	max_trx_id;	/*!< The smallest number not yet
 					assigned as a transaction id or
 					transaction number */
@@ -640,6 +669,32 @@ struct trx_sys_struct{
 					on trx no, biggest first */
 };
 
+/** Test if trx_sys->mutex is owned. */
+#define trx_sys_mutex_own() mutex_own(&trx_sys->mutex)
+
+/** Acquire the trx_sys->mutex. */
+#define trx_sys_mutex_enter() do {			\
+	mutex_enter(&trx_sys->mutex);			\
+} while (0)
+
+/** Release the trx_sys->mutex. */
+#define trx_sys_mutex_exit() do {			\
+	mutex_exit(&trx_sys->mutex);			\
+} while (0)
+
+/** Test if trx_sys->read_view_mutex is owned. */
+#define read_view_mutex_own() mutex_own(&trx_sys->read_view_mutex)
+
+/** Acquire the trx_sys->read_view_mutex. */
+#define read_view_mutex_enter() do {			\
+	mutex_enter(&trx_sys->read_view_mutex);		\
+} while (0)
+
+/** Release the trx_sys->read_view_mutex. */
+#define read_view_mutex_exit() do {			\
+	mutex_exit(&trx_sys->read_view_mutex);		\
+} while (0)
+
 /** When a trx id which is zero modulo this number (which must be a power of
 two) is assigned, the field TRX_SYS_TRX_ID_STORE on the transaction system
 page is updated */
@@ -35,6 +35,7 @@ Created 3/26/1996 Heikki Tuuri
 #include "que0types.h"
 #include "mem0mem.h"
 #include "read0types.h"
+#include "sync0rw.h"
 #include "trx0xa.h"
 #include "ut0vec.h"
 
@@ -155,7 +156,7 @@ trx_start(
 			is passed, the system chooses the rollback segment
 			automatically in a round-robin fashion */
 /****************************************************************//**
-Starts a new transaction.
+Starts a new transaction. The caller must not own trx_sys->mutex.
 @return	TRUE */
 UNIV_INTERN
 ibool
@@ -173,8 +174,8 @@ trx_start_if_not_started(
 /*=====================*/
 	trx_t*	trx);	/*!< in: transaction */
 /*************************************************************//**
-Starts the transaction if it is not yet started. Assumes we have reserved
-the kernel mutex! */
+Starts the transaction if it is not yet started. Unlike
+trx_start_if_not_started(), does not refresh trx->support_xa. */
 UNIV_INLINE
 void
 trx_start_if_not_started_low(
@@ -490,10 +491,6 @@ struct trx_struct{
 				       	transaction has been registered with
 				       	the coordinator using the XA API, and
 				       	is set to 0 after commit or rollback. */
-	unsigned	owns_prepare_mutex:1;/* 1 if owns prepare mutex, if
-					this is set to 1 then registered should
-					also be set to 1. This is used in the
-					XA code */
 	/*------------------------------*/
 	ulint		isolation_level;/* TRX_ISO_REPEATABLE_READ, ... */
 	ulint		check_foreigns;	/* normally TRUE, but if the user
@@ -528,8 +525,14 @@ struct trx_struct{
 	ulint		has_search_latch;
 					/* TRUE if this trx has latched the
 					search system latch in S-mode */
-	ulint		deadlock_mark;	/*!< a mark field used in deadlock
-					checking algorithm.  */
+	rw_lock_t*	search_latch;	/*!< the adaptive hash index
+					partition latch that this trx holds
+					in S-mode if has_search_latch,
+					or NULL */
+	ib_uint64_t	deadlock_mark;	/*!< a mark field used in deadlock
+					checking algorithm: the value of the
+					search counter of the last deadlock
+					search that visited this trx */
 	trx_dict_op_t	dict_operation;	/**< @see enum trx_dict_op */
 
 	/* Fields protected by the srv_conc_mutex. */
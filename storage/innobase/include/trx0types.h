@@ -55,6 +55,10 @@ typedef struct trx_undo_arr_struct trx_undo_arr_t;
 typedef struct trx_undo_inf_struct trx_undo_inf_t;
 /** The control structure used in the purge operation */
 typedef struct trx_purge_struct	trx_purge_t;
+/** An undo log record handed to a purge thread */
+typedef struct trx_purge_rec_struct trx_purge_rec_t;
+/** The state of a purge thread */
+typedef struct trx_purge_thr_struct trx_purge_thr_t;
 /** Rollback command node in a query graph */
 typedef struct roll_node_struct	roll_node_t;
 /** Commit command node in a query graph */
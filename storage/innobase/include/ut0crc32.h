@@ -0,0 +1,52 @@
+/*****************************************************************************
+
+Copyright (c) 2012, Oracle and/or its affiliates. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file include/ut0crc32.h
+CRC32C (CRC-32 with the Castagnoli polynomial) implementation
+*******************************************************/
+
+#ifndef ut0crc32_h
+#define ut0crc32_h
+
+#include "univ.i"
+
+/********************************************************************//**
+Initializes the data structures used by ut_crc32(). Selects the
+SSE4.2 implementation if the CPU supports the crc32 instruction and
+the slice-by-8 table driven implementation otherwise. Must be called
+before ut_crc32() is used. */
+UNIV_INTERN
+void
+ut_crc32_init(void);
+/*===============*/
+
+/********************************************************************//**
+Calculates CRC32C.
+@param ptr	- data over which to calculate CRC32C.
+@param len	- data length in bytes.
+@return CRC32C */
+typedef ib_uint32_t (*ib_ut_crc32_t)(const byte* ptr, ulint len);
+
+/** Pointer to the CRC32C implementation chosen by ut_crc32_init() */
+extern ib_ut_crc32_t	ut_crc32;
+
+/** TRUE if ut_crc32() uses the SSE4.2 crc32 instruction */
+extern ibool		ut_crc32_sse42_enabled;
+
+#endif /* ut0crc32_h */
@@ -44,8 +44,9 @@ Created 5/7/1996 Heikki Tuuri
 graph of transactions */
 #define LOCK_MAX_N_STEPS_IN_DEADLOCK_CHECK 1000000
 
-/* Restricts the recursion depth of the search we will do in the waits-for
-graph of transactions */
+/* Restricts the depth of the search we will do in the waits-for
+graph of transactions; this is also the size of the explicit stack
+of the search */
 #define LOCK_MAX_DEPTH_IN_DEADLOCK_CHECK 200
 
 /* When releasing transaction locks, this specifies how often we release
@@ -372,11 +373,48 @@ Monitor will then fetch it and print */
 UNIV_INTERN ibool	lock_deadlock_found = FALSE;
 UNIV_INTERN FILE*	lock_latest_err_file;
 
-/* Flags for recursive deadlock search */
+/* Return values of the deadlock search */
 #define LOCK_VICTIM_IS_START	1
 #define LOCK_VICTIM_IS_OTHER	2
 #define LOCK_EXCEED_MAX_DEPTH	3
 
+/** A frame of the explicit stack of the deadlock search: the position
+in the lock queue of wait_lock where the search continues when it
+backtracks to this frame */
+typedef struct lock_deadlock_frame_struct {
+	const lock_t*	wait_lock;	/*!< lock that a trx on the current
+					path of the waits-for graph is
+					waiting for */
+	const lock_t*	lock;		/*!< lock ahead of wait_lock in its
+					queue that we descended from */
+	ulint		heap_no;	/*!< heap number of the record that
+					wait_lock is waiting for, or
+					ULINT_UNDEFINED for a table lock */
+} lock_deadlock_frame_t;
+
+/** State of one deadlock search */
+typedef struct lock_deadlock_ctx_struct {
+	const trx_t*	start;		/*!< the transaction that requested
+					the lock; the search looks for a path
+					in the waits-for graph back to it */
+	const lock_t*	wait_lock;	/*!< lock that the transaction we are
+					currently looking at waits for */
+	ib_uint64_t	mark;		/*!< value of trx->deadlock_mark of
+					the transactions already visited in
+					this search */
+	ulint		depth;		/*!< number of frames on the stack */
+	ulint		cost;		/*!< number of locks looked at */
+} lock_deadlock_ctx_t;
+
+/** Explicit stack of the deadlock search, protected by kernel_mutex */
+static lock_deadlock_frame_t
+	lock_deadlock_stack[LOCK_MAX_DEPTH_IN_DEADLOCK_CHECK];
+
+/** Incremented at the start of each deadlock search, protected by
+kernel_mutex. A transaction whose deadlock_mark equals this has been
+visited by the current search. */
+static ib_uint64_t	lock_deadlock_mark_counter = 0;
+
 /********************************************************************//**
 Checks if a lock request results in a deadlock.
 @return TRUE if a deadlock was detected and we chose trx as a victim;
@@ -388,27 +426,6 @@ lock_deadlock_occurs(
 /*=================*/
 	lock_t*	lock,	/*!< in: lock the transaction is requesting */
 	trx_t*	trx);	/*!< in: transaction */
-/********************************************************************//**
-Looks recursively for a deadlock.
-@return 0 if no deadlock found, LOCK_VICTIM_IS_START if there was a
-deadlock and we chose 'start' as the victim, LOCK_VICTIM_IS_OTHER if a
-deadlock was found and we chose some other trx as a victim: we must do
-the search again in this last case because there may be another
-deadlock!
-LOCK_EXCEED_MAX_DEPTH if the lock search exceeds max steps or max depth. */
-static
-ulint
-lock_deadlock_recursive(
-/*====================*/
-	trx_t*	start,		/*!< in: recursion starting point */
-	trx_t*	trx,		/*!< in: a transaction waiting for a lock */
-	lock_t*	wait_lock,	/*!< in:  lock that is waiting to be granted */
-	ulint*	cost,		/*!< in/out: number of calculation steps thus
-				far: if this exceeds LOCK_MAX_N_STEPS_...
-				we return LOCK_EXCEED_MAX_DEPTH */
-	ulint	depth);		/*!< in: recursion depth: if this exceeds
-				LOCK_MAX_DEPTH_IN_DEADLOCK_CHECK, we
-				return LOCK_EXCEED_MAX_DEPTH */
 
 /*********************************************************************//**
 Gets the nth bit of a record lock.
@@ -439,6 +456,11 @@ lock_rec_get_nth_bit(
 
 /*************************************************************************/
 
+/* The lock system is protected by the kernel mutex, which also covers
+the query thread and lock wait states. The transaction list and the read
+views are protected by trx_sys->mutex and trx_sys->read_view_mutex, which
+are acquired after the kernel mutex when both are needed. */
+
 #define lock_mutex_enter_kernel()	mutex_enter(&kernel_mutex)
 #define lock_mutex_exit_kernel()	mutex_exit(&kernel_mutex)
 
@@ -453,15 +475,15 @@ lock_check_trx_id_sanity(
 	const rec_t*	rec,		/*!< in: user record */
 	dict_index_t*	index,		/*!< in: index */
 	const ulint*	offsets,	/*!< in: rec_get_offsets(rec, index) */
-	ibool		has_kernel_mutex)/*!< in: TRUE if the caller owns the
-					kernel mutex */
+	ibool		has_trx_sys_mutex)/*!< in: TRUE if the caller owns
+					trx_sys->mutex */
 {
 	ibool	is_ok		= TRUE;
 
 	ut_ad(rec_offs_validate(rec, index, offsets));
 
-	if (!has_kernel_mutex) {
-		mutex_enter(&kernel_mutex);
+	if (!has_trx_sys_mutex) {
+		trx_sys_mutex_enter();
 	}
 
 	/* A sanity check: the trx_id in rec must be smaller than the global
@@ -485,8 +507,8 @@ lock_check_trx_id_sanity(
 		is_ok = FALSE;
 	}
 
-	if (!has_kernel_mutex) {
-		mutex_exit(&kernel_mutex);
+	if (!has_trx_sys_mutex) {
+		trx_sys_mutex_exit();
 	}
 
 	return(is_ok);
@@ -1596,12 +1618,15 @@ lock_sec_rec_some_has_impl_off_kernel(
 	const ulint*	offsets)/*!< in: rec_get_offsets(rec, index) */
 {
 	const page_t*	page = page_align(rec);
+	ibool		is_ok;
 
 	ut_ad(mutex_own(&kernel_mutex));
 	ut_ad(!dict_index_is_clust(index));
 	ut_ad(page_rec_is_user_rec(rec));
 	ut_ad(rec_offs_validate(rec, index, offsets));
 
+	trx_sys_mutex_enter();
+
 	/* Some transaction may have an implicit x-lock on the record only
 	if the max trx id for the page >= min trx id for the trx list, or
 	database recovery is running. We do not write the changes of a page
@@ -1611,14 +1636,20 @@ lock_sec_rec_some_has_impl_off_kernel(
 	if (page_get_max_trx_id(page) < trx_list_get_min_trx_id()
 	    && !recv_recovery_is_on()) {
 
+		trx_sys_mutex_exit();
+
 		return(NULL);
 	}
 
 	/* Ok, in this case it is possible that some transaction has an
 	implicit x-lock. We have to look in the clustered index. */
 
-	if (!lock_check_trx_id_sanity(page_get_max_trx_id(page),
-				      rec, index, offsets, TRUE)) {
+	is_ok = lock_check_trx_id_sanity(page_get_max_trx_id(page),
+					 rec, index, offsets, TRUE);
+
+	trx_sys_mutex_exit();
+
+	if (!is_ok) {
 		buf_page_print(page, 0, 0);
 
 		/* The page is corrupt: try to avoid a crash by returning
@@ -3382,295 +3413,348 @@ lock_deadlock_lock_print(
 }
 
 /********************************************************************//**
-Checks if a lock request results in a deadlock.
-@return TRUE if a deadlock was detected and we chose trx as a victim;
-FALSE if no deadlock, or there was a deadlock, but we chose other
-transaction(s) as victim(s) */
+Gets the first lock ahead of ctx->wait_lock in its lock queue.
+@return	first lock ahead of wait_lock, or NULL if there is none */
 static
-ibool
-lock_deadlock_occurs(
-/*=================*/
-	lock_t*	lock,	/*!< in: lock the transaction is requesting */
-	trx_t*	trx)	/*!< in: transaction */
+const lock_t*
+lock_deadlock_get_first_lock(
+/*=========================*/
+	const lock_deadlock_ctx_t*	ctx,	/*!< in: search state */
+	ulint*				heap_no)/*!< out: heap number of the
+						record wait_lock waits for,
+						or ULINT_UNDEFINED for a
+						table lock */
 {
-	trx_t*		mark_trx;
-	ulint		ret;
-	ulint		cost	= 0;
+	const lock_t*	lock = ctx->wait_lock;
 
-	ut_ad(trx);
-	ut_ad(lock);
-	ut_ad(mutex_own(&kernel_mutex));
-retry:
-	/* We check that adding this trx to the waits-for graph
-	does not produce a cycle. First mark all active transactions
-	with 0: */
-
-	mark_trx = UT_LIST_GET_FIRST(trx_sys->trx_list);
+	if (lock_get_type_low(lock) == LOCK_REC) {
 
-	while (mark_trx) {
-		mark_trx->deadlock_mark = 0;
-		mark_trx = UT_LIST_GET_NEXT(trx_list, mark_trx);
-	}
+		*heap_no = lock_rec_find_set_bit(lock);
+		ut_a(*heap_no != ULINT_UNDEFINED);
 
-	ret = lock_deadlock_recursive(trx, trx, lock, &cost, 0);
+		lock = lock_rec_get_first_on_page_addr(
+			lock->un_member.rec_lock.space,
+			lock->un_member.rec_lock.page_no);
 
-	switch (ret) {
-	case LOCK_VICTIM_IS_OTHER:
-		/* We chose some other trx as a victim: retry if there still
-		is a deadlock */
-		goto retry;
+		/* Position on the first lock on the same record. */
+		while (lock != ctx->wait_lock
+		       && !lock_rec_get_nth_bit(lock, *heap_no)) {
 
-	case LOCK_EXCEED_MAX_DEPTH:
-		/* If the lock search exceeds the max step
-		or the max depth, the current trx will be
-		the victim. Print its information. */
-		lock_deadlock_start_print();
+			lock = lock_rec_get_next_on_page_const(lock);
+		}
 
-		lock_deadlock_fputs(
-			"TOO DEEP OR LONG SEARCH IN THE LOCK TABLE"
-			" WAITS-FOR GRAPH, WE WILL ROLL BACK"
-			" FOLLOWING TRANSACTION \n\n"
-			"*** TRANSACTION:\n");
+		/* Only the locks ahead of wait_lock in the queue
+		can block it. */
+		if (lock == ctx->wait_lock) {
+			lock = NULL;
+		}
+	} else {
+		*heap_no = ULINT_UNDEFINED;
 
-		lock_deadlock_trx_print(trx, 3000);
+		lock = UT_LIST_GET_PREV(un_member.tab_lock.locks, lock);
+	}
 
-		lock_deadlock_fputs(
-			"*** WAITING FOR THIS LOCK TO BE GRANTED:\n");
+	return(lock);
+}
 
-		lock_deadlock_lock_print(lock);
+/********************************************************************//**
+Gets the next lock ahead of ctx->wait_lock in its lock queue.
+@return	next lock ahead of wait_lock, or NULL if there is none */
+static
+const lock_t*
+lock_deadlock_get_next_lock(
+/*========================*/
+	const lock_deadlock_ctx_t*	ctx,	/*!< in: search state */
+	const lock_t*			lock,	/*!< in: current lock */
+	ulint				heap_no)/*!< in: heap number of the
+						record, or ULINT_UNDEFINED
+						for a table lock */
+{
+	ut_ad(mutex_own(&kernel_mutex));
 
-		break;
+	if (heap_no != ULINT_UNDEFINED) {
 
-	case LOCK_VICTIM_IS_START:
-		lock_deadlock_fputs("*** WE ROLL BACK TRANSACTION (2)\n");
-		break;
+		do {
+			lock = lock_rec_get_next_on_page_const(lock);
+		} while (lock != NULL
+			 && lock != ctx->wait_lock
+			 && !lock_rec_get_nth_bit(lock, heap_no));
 
-	default:
-		/* No deadlock detected*/
-		return(FALSE);
+		if (lock == ctx->wait_lock) {
+			lock = NULL;
+		}
+	} else {
+		lock = UT_LIST_GET_PREV(un_member.tab_lock.locks, lock);
 	}
 
-	lock_deadlock_found = TRUE;
-
-	return(TRUE);
+	return(lock);
 }
 
 /********************************************************************//**
-Looks recursively for a deadlock.
-@return 0 if no deadlock found, LOCK_VICTIM_IS_START if there was a
-deadlock and we chose 'start' as the victim, LOCK_VICTIM_IS_OTHER if a
-deadlock was found and we chose some other trx as a victim: we must do
-the search again in this last case because there may be another
-deadlock!
-LOCK_EXCEED_MAX_DEPTH if the lock search exceeds max steps or max depth. */
+Reports a deadlock cycle and chooses its victim. The cycle is closed by
+ctx->wait_lock, which waits for a lock held by the starting transaction.
+@return LOCK_VICTIM_IS_START if the starting transaction should be rolled
+back, LOCK_VICTIM_IS_OTHER if the transaction of ctx->wait_lock was chosen
+and its lock wait has been cancelled */
 static
 ulint
-lock_deadlock_recursive(
-/*====================*/
-	trx_t*	start,		/*!< in: recursion starting point */
-	trx_t*	trx,		/*!< in: a transaction waiting for a lock */
-	lock_t*	wait_lock,	/*!< in: lock that is waiting to be granted */
-	ulint*	cost,		/*!< in/out: number of calculation steps thus
-				far: if this exceeds LOCK_MAX_N_STEPS_...
-				we return LOCK_EXCEED_MAX_DEPTH */
-	ulint	depth)		/*!< in: recursion depth: if this exceeds
-				LOCK_MAX_DEPTH_IN_DEADLOCK_CHECK, we
-				return LOCK_EXCEED_MAX_DEPTH */
+lock_deadlock_choose_victim(
+/*========================*/
+	const lock_deadlock_ctx_t*	ctx,	/*!< in: search state */
+	const lock_t*			lock)	/*!< in: lock of the starting
+						transaction that blocks
+						ctx->wait_lock */
 {
-	ulint	ret;
-	lock_t*	lock;
-	trx_t*	lock_trx;
-	ulint	heap_no		= ULINT_UNDEFINED;
+	trx_t*	wait_trx = ctx->wait_lock->trx;
 
-	ut_a(trx);
-	ut_a(start);
-	ut_a(wait_lock);
 	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock->trx == ctx->start);
 
-	if (trx->deadlock_mark == 1) {
-		/* We have already exhaustively searched the subtree starting
-		from this trx */
+	srv_n_deadlocks++;
 
-		return(0);
-	}
+	lock_deadlock_start_print();
 
-	*cost = *cost + 1;
+	lock_deadlock_fputs("\n*** (1) TRANSACTION:\n");
 
-	if (lock_get_type_low(wait_lock) == LOCK_REC) {
-		ulint		space;
-		ulint		page_no;
+	lock_deadlock_trx_print(wait_trx, 3000);
 
-		heap_no = lock_rec_find_set_bit(wait_lock);
-		ut_a(heap_no != ULINT_UNDEFINED);
+	lock_deadlock_fputs("*** (1) WAITING FOR THIS LOCK TO BE GRANTED:\n");
 
-		space = wait_lock->un_member.rec_lock.space;
-		page_no = wait_lock->un_member.rec_lock.page_no;
+	lock_deadlock_lock_print(ctx->wait_lock);
 
-		lock = lock_rec_get_first_on_page_addr(space, page_no);
+	lock_deadlock_fputs("*** (2) TRANSACTION:\n");
 
-		/* Position the iterator on the first matching record lock. */
-		while (lock != NULL
-		       && lock != wait_lock
-		       && !lock_rec_get_nth_bit(lock, heap_no)) {
+	lock_deadlock_trx_print(lock->trx, 3000);
 
-			lock = lock_rec_get_next_on_page(lock);
-		}
+	lock_deadlock_fputs("*** (2) HOLDS THE LOCK(S):\n");
 
-		if (lock == wait_lock) {
-			lock = NULL;
-		}
+	lock_deadlock_lock_print(lock);
 
-		ut_ad(lock == NULL || lock_rec_get_nth_bit(lock, heap_no));
+	lock_deadlock_fputs("*** (2) WAITING FOR THIS LOCK TO BE GRANTED:\n");
 
-	} else {
-		lock = wait_lock;
+	lock_deadlock_lock_print(ctx->start->wait_lock);
+
+#ifdef UNIV_DEBUG
+	if (lock_print_waits) {
+		fputs("Deadlock detected\n", stderr);
 	}
+#endif /* UNIV_DEBUG */
+
+	if (trx_weight_ge(wait_trx, ctx->start)) {
+		/* Our search starting point transaction is 'smaller',
+		let us choose 'start' as the victim and roll back it */
+
+		return(LOCK_VICTIM_IS_START);
+	}
+
+	lock_deadlock_found = TRUE;
+
+	/* Let us choose the transaction of wait_lock as a victim to try
+	to avoid deadlocking our search starting point transaction */
+
+	lock_deadlock_fputs("*** WE ROLL BACK TRANSACTION (1)\n");
 
-	/* Look at the locks ahead of wait_lock in the lock queue */
+	wait_trx->was_chosen_as_deadlock_victim = TRUE;
+
+	lock_cancel_waiting_and_release(wait_trx->wait_lock);
+
+	/* Since wait_trx and its wait_lock are no longer in the
+	waits-for graph, the caller has to search again. Note that our
+	selective algorithm can choose several transactions as victims,
+	but still we may end up rolling back also the search starting
+	point transaction! */
+
+	return(LOCK_VICTIM_IS_OTHER);
+}
+
+/********************************************************************//**
+Looks for a deadlock: does a depth-first search of the waits-for graph
+starting from ctx->wait_lock, with an explicit stack instead of recursion.
+Each transaction is visited at most once per search, so that the cost is
+linear in the number of lock waits even with many waiters on a hot row.
+@return 0 if no deadlock found, LOCK_VICTIM_IS_START if there was a
+deadlock and we chose 'start' as the victim, LOCK_VICTIM_IS_OTHER if a
+deadlock was found and we chose some other trx as a victim: we must do
+the search again in this last case because there may be another
+deadlock!
+LOCK_EXCEED_MAX_DEPTH if the lock search exceeds max steps or max depth. */
+static
+ulint
+lock_deadlock_search(
+/*=================*/
+	lock_deadlock_ctx_t*	ctx)	/*!< in/out: search state */
+{
+	const lock_t*	lock;
+	ulint		heap_no;
+
+	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(ctx->depth == 0);
+	ut_ad(ctx->wait_lock->trx == ctx->start);
+
+	lock = lock_deadlock_get_first_lock(ctx, &heap_no);
 
 	for (;;) {
-		/* Get previous table lock. */
-		if (heap_no == ULINT_UNDEFINED) {
+		/* Backtrack when the lock queue of the current
+		wait_lock has been exhausted. */
+		while (lock == NULL && ctx->depth > 0) {
+			lock_deadlock_frame_t*	frame;
 
-			lock = UT_LIST_GET_PREV(
-				un_member.tab_lock.locks, lock);
+			frame = &lock_deadlock_stack[--ctx->depth];
+
+			ctx->wait_lock = frame->wait_lock;
+			heap_no = frame->heap_no;
+
+			lock = lock_deadlock_get_next_lock(
+				ctx, frame->lock, heap_no);
 		}
 
 		if (lock == NULL) {
-			/* We can mark this subtree as searched */
-			trx->deadlock_mark = 1;
-
-			return(FALSE);
+			/* The whole subgraph reachable from the
+			starting point was searched. */
+			return(0);
 		}
 
-		if (lock_has_to_wait(wait_lock, lock)) {
+		ctx->cost++;
 
-			ibool	too_far
-				= depth > LOCK_MAX_DEPTH_IN_DEADLOCK_CHECK
-				|| *cost > LOCK_MAX_N_STEPS_IN_DEADLOCK_CHECK;
+		if (!lock_has_to_wait(ctx->wait_lock, lock)) {
 
-			lock_trx = lock->trx;
+			lock = lock_deadlock_get_next_lock(ctx, lock, heap_no);
 
-			if (lock_trx == start) {
+		} else if (lock->trx == ctx->start) {
 
-				/* We came back to the recursion starting
-				point: a deadlock detected; or we have
-				searched the waits-for graph too long */
+			/* We came back to the search starting
+			point: a deadlock detected */
 
-				lock_deadlock_start_print();
+			return(lock_deadlock_choose_victim(ctx, lock));
 
-				lock_deadlock_fputs("\n*** (1) TRANSACTION:\n");
+		} else if (ctx->depth >= LOCK_MAX_DEPTH_IN_DEADLOCK_CHECK
+			   || ctx->cost > LOCK_MAX_N_STEPS_IN_DEADLOCK_CHECK) {
 
-				lock_deadlock_trx_print(wait_lock->trx, 3000);
+#ifdef UNIV_DEBUG
+			if (lock_print_waits) {
+				fputs("Deadlock search exceeds"
+				      " max steps or depth.\n", stderr);
+			}
+#endif /* UNIV_DEBUG */
+			/* The information about transaction/lock
+			to be rolled back is available in the top
+			level. Do not print anything here. */
+			return(LOCK_EXCEED_MAX_DEPTH);
 
-				lock_deadlock_fputs(
-					"*** (1) WAITING FOR THIS LOCK"
-					" TO BE GRANTED:\n");
+		} else if (lock->trx->que_state == TRX_QUE_LOCK_WAIT
+			   && lock->trx->deadlock_mark != ctx->mark) {
 
-				lock_deadlock_lock_print(wait_lock);
+			/* Another trx ahead has requested a lock in an
+			incompatible mode, and is itself waiting for a
+			lock: descend to the locks it waits for. If the
+			trx was already visited in this search, its
+			subgraph either did not lead back to start or is
+			on the current path, so we can skip it. */
 
-				lock_deadlock_fputs("*** (2) TRANSACTION:\n");
+			lock_deadlock_frame_t*	frame;
 
-				lock_deadlock_trx_print(lock->trx, 3000);
+			lock->trx->deadlock_mark = ctx->mark;
 
-				lock_deadlock_fputs(
-					"*** (2) HOLDS THE LOCK(S):\n");
+			frame = &lock_deadlock_stack[ctx->depth++];
 
-				lock_deadlock_lock_print(lock);
+			frame->wait_lock = ctx->wait_lock;
+			frame->lock = lock;
+			frame->heap_no = heap_no;
 
-				lock_deadlock_fputs(
-					"*** (2) WAITING FOR THIS LOCK"
-					" TO BE GRANTED:\n");
+			ctx->wait_lock = lock->trx->wait_lock;
 
-				lock_deadlock_lock_print(start->wait_lock);
+			lock = lock_deadlock_get_first_lock(ctx, &heap_no);
 
-#ifdef UNIV_DEBUG
-				if (lock_print_waits) {
-					fputs("Deadlock detected\n",
-					      stderr);
-				}
-#endif /* UNIV_DEBUG */
+		} else {
+			lock = lock_deadlock_get_next_lock(ctx, lock, heap_no);
+		}
+	}
+}
 
-				if (trx_weight_ge(wait_lock->trx, start)) {
-					/* Our recursion starting point
-					transaction is 'smaller', let us
-					choose 'start' as the victim and roll
-					back it */
+/********************************************************************//**
+Checks if a lock request results in a deadlock.
+@return TRUE if a deadlock was detected and we chose trx as a victim;
+FALSE if no deadlock, or there was a deadlock, but we chose other
+transaction(s) as victim(s) */
+static
+ibool
+lock_deadlock_occurs(
+/*=================*/
+	lock_t*	lock,	/*!< in: lock the transaction is requesting */
+	trx_t*	trx)	/*!< in: transaction */
+{
+	lock_deadlock_ctx_t	ctx;
+	ulint			ret;
+	ullint			start_time;
 
-					return(LOCK_VICTIM_IS_START);
-				}
+	ut_ad(trx);
+	ut_ad(lock);
+	ut_ad(lock->trx == trx);
+	ut_ad(mutex_own(&kernel_mutex));
 
-				lock_deadlock_found = TRUE;
+	if (!srv_deadlock_detect) {
+		/* Deadlocks are only resolved by
+		innodb_lock_wait_timeout. */
+		return(FALSE);
+	}
 
-				/* Let us choose the transaction of wait_lock
-				as a victim to try to avoid deadlocking our
-				recursion starting point transaction */
+	start_time = ut_time_us(NULL);
 
-				lock_deadlock_fputs(
-					"*** WE ROLL BACK TRANSACTION (1)\n");
+	srv_n_deadlock_searches++;
 
-				wait_lock->trx->was_chosen_as_deadlock_victim
-					= TRUE;
+	ctx.start = trx;
+	ctx.cost = 0;
 
-				lock_cancel_waiting_and_release(wait_lock);
+	do {
+		/* A new mark value makes all transactions unvisited
+		without having to walk the transaction list. */
+		ctx.mark = ++lock_deadlock_mark_counter;
+		ctx.wait_lock = lock;
+		ctx.depth = 0;
 
-				/* Since trx and wait_lock are no longer
-				in the waits-for graph, we can return FALSE;
-				note that our selective algorithm can choose
-				several transactions as victims, but still
-				we may end up rolling back also the recursion
-				starting point transaction! */
+		ret = lock_deadlock_search(&ctx);
 
-				return(LOCK_VICTIM_IS_OTHER);
-			}
+		/* If we chose some other trx as a victim, retry if
+		there still is a deadlock */
+	} while (ret == LOCK_VICTIM_IS_OTHER);
 
-			if (too_far) {
+	switch (ret) {
+	case LOCK_EXCEED_MAX_DEPTH:
+		/* If the lock search exceeds the max step
+		or the max depth, the current trx will be
+		the victim. Print its information. */
+		lock_deadlock_start_print();
 
-#ifdef UNIV_DEBUG
-				if (lock_print_waits) {
-					fputs("Deadlock search exceeds"
-					      " max steps or depth.\n",
-					      stderr);
-				}
-#endif /* UNIV_DEBUG */
-				/* The information about transaction/lock
-				to be rolled back is available in the top
-				level. Do not print anything here. */
-				return(LOCK_EXCEED_MAX_DEPTH);
-			}
+		lock_deadlock_fputs(
+			"TOO DEEP OR LONG SEARCH IN THE LOCK TABLE"
+			" WAITS-FOR GRAPH, WE WILL ROLL BACK"
+			" FOLLOWING TRANSACTION \n\n"
+			"*** TRANSACTION:\n");
 
-			if (lock_trx->que_state == TRX_QUE_LOCK_WAIT) {
+		lock_deadlock_trx_print(trx, 3000);
 
-				/* Another trx ahead has requested lock	in an
-				incompatible mode, and is itself waiting for
-				a lock */
+		lock_deadlock_fputs(
+			"*** WAITING FOR THIS LOCK TO BE GRANTED:\n");
 
-				ret = lock_deadlock_recursive(
-					start, lock_trx,
-					lock_trx->wait_lock, cost, depth + 1);
+		lock_deadlock_lock_print(lock);
 
-				if (ret != 0) {
+		break;
 
-					return(ret);
-				}
-			}
-		}
-		/* Get the next record lock to check. */
-		if (heap_no != ULINT_UNDEFINED) {
+	case LOCK_VICTIM_IS_START:
+		lock_deadlock_fputs("*** WE ROLL BACK TRANSACTION (2)\n");
+		break;
 
-			ut_a(lock != NULL);
+	default:
+		/* No deadlock detected*/
+		srv_deadlock_search_time += ut_time_us(NULL) - start_time;
+		return(FALSE);
+	}
 
-			do {
-				lock = lock_rec_get_next_on_page(lock);
-			} while (lock != NULL
-				&& lock != wait_lock
-				&& !lock_rec_get_nth_bit(lock, heap_no));
+	lock_deadlock_found = TRUE;
 
-			if (lock == wait_lock) {
-				lock = NULL;
-			}
-		}
-	}/* end of the 'for (;;)'-loop */
+	srv_deadlock_search_time += ut_time_us(NULL) - start_time;
+
+	return(TRUE);
 }
 
 /*========================= TABLE LOCKS ==============================*/
@@ -4185,6 +4269,7 @@ lock_release_off_kernel(
 	dict_table_t*	table;
 	ulint		count;
 	lock_t*		lock;
+	trx_id_t	max_trx_id	= 0;
 
 	ut_ad(mutex_own(&kernel_mutex));
 
@@ -4211,8 +4296,17 @@ lock_release_off_kernel(
 
 				table = lock->un_member.tab_lock.table;
 
-				table->query_cache_inv_trx_id
-					= trx_sys->max_trx_id;
+				/* The transaction is already committed
+				in memory: any transaction that gets an
+				id after this read will see its changes. */
+
+				if (max_trx_id == 0) {
+					trx_sys_mutex_enter();
+					max_trx_id = trx_sys->max_trx_id;
+					trx_sys_mutex_exit();
+				}
+
+				table->query_cache_inv_trx_id = max_trx_id;
 			}
 
 			lock_table_dequeue(lock);
@@ -4590,9 +4684,13 @@ lock_print_info_summary(
 	      "TRANSACTIONS\n"
 	      "------------\n", file);
 
+	trx_sys_mutex_enter();
+
 	fprintf(file, "Trx id counter " TRX_ID_FMT "\n",
 		(ullint) trx_sys->max_trx_id);
 
+	trx_sys_mutex_exit();
+
 	fprintf(file,
 		"Purge done for trx's n:o < " TRX_ID_FMT
 		" undo n:o < " TRX_ID_FMT "\n",
@@ -4643,6 +4741,11 @@ lock_print_info_all_transactions(
 	}
 
 loop:
+	/* The trx found below cannot be removed from trx_list as
+	long as we hold the kernel mutex. */
+
+	trx_sys_mutex_enter();
+
 	trx = UT_LIST_GET_FIRST(trx_sys->trx_list);
 
 	i = 0;
@@ -4657,6 +4760,8 @@ loop:
 		i++;
 	}
 
+	trx_sys_mutex_exit();
+
 	if (trx == NULL) {
 		lock_mutex_exit_kernel();
 
@@ -4669,6 +4774,8 @@ loop:
 		fputs("---", file);
 		trx_print(file, trx, 600);
 
+		read_view_mutex_enter();
+
 		if (trx->read_view) {
 			fprintf(file,
 				"Trx read view will not see trx with"
@@ -4678,6 +4785,8 @@ loop:
 				(ullint) trx->read_view->up_limit_id);
 		}
 
+		read_view_mutex_exit();
+
 		if (trx->que_state == TRX_QUE_LOCK_WAIT) {
 			fprintf(file,
 				"------- TRX HAS BEEN WAITING %lu SEC"
@@ -5158,6 +5267,7 @@ lock_validate(void)
 	ulint		i;
 
 	lock_mutex_enter_kernel();
+	trx_sys_mutex_enter();
 
 	trx = UT_LIST_GET_FIRST(trx_sys->trx_list);
 
@@ -5177,6 +5287,8 @@ lock_validate(void)
 		trx = UT_LIST_GET_NEXT(trx_list, trx);
 	}
 
+	trx_sys_mutex_exit();
+
 	/* Iterate over all the record locks and validate the locks. We
 	don't want to hog the lock_sys_t::mutex and the trx_sys_t::mutex.
 	Release both mutexes during the validation check. */
@@ -5554,6 +5666,7 @@ lock_sec_rec_read_check_and_lock(
 {
 	enum db_err	err;
 	ulint		heap_no;
+	trx_id_t	min_trx_id;
 
 	ut_ad(!dict_index_is_clust(index));
 	ut_ad(block->frame == page_align(rec));
@@ -5579,7 +5692,11 @@ lock_sec_rec_read_check_and_lock(
 	if the max trx id for the page >= min trx id for the trx list or a
 	database recovery is running. */
 
-	if ((page_get_max_trx_id(block->frame) >= trx_list_get_min_trx_id()
+	trx_sys_mutex_enter();
+	min_trx_id = trx_list_get_min_trx_id();
+	trx_sys_mutex_exit();
+
+	if ((page_get_max_trx_id(block->frame) >= min_trx_id
 	     || recv_recovery_is_on())
 	    && !page_rec_is_supremum(rec)) {
 
@@ -40,6 +40,7 @@ Created 12/9/1995 Heikki Tuuri
 #include "mem0mem.h"
 #include "buf0buf.h"
 #include "buf0flu.h"
+#include "buf0dump.h"
 #include "srv0srv.h"
 #include "log0recv.h"
 #include "fil0fil.h"
@@ -3204,6 +3205,24 @@ loop:
 
 	count++;
 
+	/* The buffer pool dump/load thread may still be dumping the
+	buffer pool or issuing reads for a load; wait for it first, while
+	the page cleaner is still around to supply free blocks. */
+
+	if (buf_dump_thread_active) {
+
+		os_event_set(srv_buf_dump_event);
+
+		if (srv_print_verbose_log && count > 600) {
+			ut_print_timestamp(stderr);
+			fprintf(stderr, "  InnoDB: Waiting for the buffer pool"
+				" dump/load thread to exit\n");
+			count = 0;
+		}
+
+		goto loop;
+	}
+
 	mutex_enter(&kernel_mutex);
 
 	/* We need the monitor threads to stop before we proceed with
@@ -3288,6 +3307,9 @@ loop:
 			case SRV_WORKER:
 				thread_type = "worker threads";
 				break;
+			case SRV_PURGE_WORKER:
+				thread_type = "purge worker threads";
+				break;
 			case SRV_MASTER:
 				thread_type = "master thread";
 				break;
@@ -3302,6 +3324,23 @@ loop:
 		goto loop;
 	}
 
+	/* The page cleaner exits once the background threads above have
+	been suspended. It must not issue any more writes after this. */
+
+	if (buf_page_cleaner_is_active) {
+
+		if (srv_print_verbose_log && count > 600) {
+			ut_print_timestamp(stderr);
+			fprintf(stderr, "  InnoDB: Waiting for the page"
+				" cleaner thread to exit\n");
+			count = 0;
+		}
+
+		os_event_set(buf_flush_event);
+
+		goto loop;
+	}
+
 	mutex_enter(&log_sys->mutex);
 	server_busy = log_sys->n_pending_checkpoint_writes
 #ifdef UNIV_LOG_ARCHIVE
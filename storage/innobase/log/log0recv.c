@@ -150,6 +150,7 @@ UNIV_INTERN ib_uint64_t	recv_max_page_lsn;
 
 #ifdef UNIV_PFS_THREAD
 UNIV_INTERN mysql_pfs_key_t	trx_rollback_clean_thread_key;
+UNIV_INTERN mysql_pfs_key_t	recv_apply_thread_key;
 #endif /* UNIV_PFS_THREAD */
 
 #ifdef UNIV_PFS_MUTEX
@@ -336,6 +337,8 @@ recv_sys_init(
 
 	recv_sys->apply_log_recs = FALSE;
 	recv_sys->apply_batch_on = FALSE;
+	recv_sys->apply_next_cell = 0;
+	recv_sys->n_apply_threads = 0;
 
 	recv_sys->last_block_buf_start = mem_alloc(2 * OS_FILE_LOG_BLOCK_SIZE);
 
@@ -1729,9 +1732,112 @@ recv_read_in_area(
 	return(n);
 }
 
+/*******************************************************************//**
+Applies the log records of the addr_hash cells handed out through
+recv_sys->apply_next_cell, until every cell of the batch has been handed
+out. The log records of pages that are in the buffer pool are applied
+right away; the other pages are read in, together with the pages of the
+surrounding area that have log records too, and the i/o handler threads
+apply the log records when the reads complete.
+The caller must own recv_sys->mutex; it is released while applying. */
+static
+void
+recv_apply_cells(
+/*=============*/
+	ibool	print_progress)	/*!< in: TRUE if the progress in percents
+				should be printed to stderr */
+{
+	recv_addr_t*	recv_addr;
+	ulint		n_cells;
+	ulint		i;
+	mtr_t		mtr;
+
+	ut_ad(mutex_own(&recv_sys->mutex));
+
+	n_cells = hash_get_n_cells(recv_sys->addr_hash);
+
+	while ((i = recv_sys->apply_next_cell) < n_cells) {
+
+		recv_sys->apply_next_cell++;
+
+		recv_addr = HASH_GET_FIRST(recv_sys->addr_hash, i);
+
+		while (recv_addr) {
+			ulint	space = recv_addr->space;
+			ulint	zip_size = fil_space_get_zip_size(space);
+			ulint	page_no = recv_addr->page_no;
+
+			if (recv_addr->state == RECV_NOT_PROCESSED) {
+				mutex_exit(&(recv_sys->mutex));
+
+				if (buf_page_peek(space, page_no)) {
+					buf_block_t*	block;
+
+					mtr_start(&mtr);
+
+					block = buf_page_get(
+						space, zip_size, page_no,
+						RW_X_LATCH, &mtr);
+					buf_block_dbg_add_level(
+						block, SYNC_NO_ORDER_CHECK);
+
+					recv_recover_page(FALSE, block);
+					mtr_commit(&mtr);
+				} else {
+					recv_read_in_area(space, zip_size,
+							  page_no);
+				}
+
+				mutex_enter(&(recv_sys->mutex));
+			}
+
+			recv_addr = HASH_GET_NEXT(addr_hash, recv_addr);
+		}
+
+		if (print_progress
+		    && (i * 100) / n_cells != ((i + 1) * 100) / n_cells) {
+
+			fprintf(stderr, "%lu ", (ulong) ((i * 100) / n_cells));
+		}
+	}
+}
+
+/*******************************************************************//**
+A thread which helps the thread running recv_apply_hashed_log_recs() to
+apply a batch of log records.
+@return	a dummy parameter */
+static
+os_thread_ret_t
+recv_apply_thread(
+/*==============*/
+	void*	arg __attribute__((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(recv_apply_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	mutex_enter(&(recv_sys->mutex));
+
+	recv_apply_cells(FALSE);
+
+	ut_a(recv_sys->n_apply_threads > 0);
+	recv_sys->n_apply_threads--;
+
+	mutex_exit(&(recv_sys->mutex));
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 /*******************************************************************//**
 Empties the hash table of stored log records, applying them to appropriate
-pages. */
+pages. The batch is applied by the calling thread and
+srv_n_read_io_threads - 1 recovery apply threads, which take the cells
+of the hash table in turns, so that the log records of distinct pages
+are applied in parallel. */
 UNIV_INTERN
 void
 recv_apply_hashed_log_recs(
@@ -1746,11 +1852,9 @@ recv_apply_hashed_log_recs(
 				the caller must in this case own the log
 				mutex */
 {
-	recv_addr_t* recv_addr;
 	ulint	i;
 	ulint	n_pages;
 	ibool	has_printed	= FALSE;
-	mtr_t	mtr;
 loop:
 	mutex_enter(&(recv_sys->mutex));
 
@@ -1771,67 +1875,36 @@ loop:
 
 	recv_sys->apply_log_recs = TRUE;
 	recv_sys->apply_batch_on = TRUE;
+	recv_sys->apply_next_cell = 0;
 
-	for (i = 0; i < hash_get_n_cells(recv_sys->addr_hash); i++) {
-
-		recv_addr = HASH_GET_FIRST(recv_sys->addr_hash, i);
-
-		while (recv_addr) {
-			ulint	space = recv_addr->space;
-			ulint	zip_size = fil_space_get_zip_size(space);
-			ulint	page_no = recv_addr->page_no;
-
-			if (recv_addr->state == RECV_NOT_PROCESSED) {
-				if (!has_printed) {
-					ut_print_timestamp(stderr);
-					fputs("  InnoDB: Starting an"
-					      " apply batch of log records"
-					      " to the database...\n"
-					      "InnoDB: Progress in percents: ",
-					      stderr);
-					has_printed = TRUE;
-				}
-
-				mutex_exit(&(recv_sys->mutex));
-
-				if (buf_page_peek(space, page_no)) {
-					buf_block_t*	block;
-
-					mtr_start(&mtr);
+	if (recv_sys->n_addrs != 0) {
+		ut_print_timestamp(stderr);
+		fputs("  InnoDB: Starting an"
+		      " apply batch of log records"
+		      " to the database...\n"
+		      "InnoDB: Progress in percents: ",
+		      stderr);
+		has_printed = TRUE;
 
-					block = buf_page_get(
-						space, zip_size, page_no,
-						RW_X_LATCH, &mtr);
-					buf_block_dbg_add_level(
-						block, SYNC_NO_ORDER_CHECK);
+		/* Start the threads that apply the batch with us. They
+		exit when all the cells of the hash table have been
+		handed out. */
 
-					recv_recover_page(FALSE, block);
-					mtr_commit(&mtr);
-				} else {
-					recv_read_in_area(space, zip_size,
-							  page_no);
-				}
+		ut_a(recv_sys->n_apply_threads == 0);
 
-				mutex_enter(&(recv_sys->mutex));
-			}
+		for (i = 1; i < srv_n_read_io_threads; i++) {
+			recv_sys->n_apply_threads++;
 
-			recv_addr = HASH_GET_NEXT(addr_hash, recv_addr);
+			os_thread_create(recv_apply_thread, NULL, NULL);
 		}
 
-		if (has_printed
-		    && (i * 100) / hash_get_n_cells(recv_sys->addr_hash)
-		    != ((i + 1) * 100)
-		    / hash_get_n_cells(recv_sys->addr_hash)) {
-
-			fprintf(stderr, "%lu ", (ulong)
-				((i * 100)
-				 / hash_get_n_cells(recv_sys->addr_hash)));
-		}
+		recv_apply_cells(TRUE);
 	}
 
-	/* Wait until all the pages have been processed */
+	/* Wait until all the pages have been processed and the
+	recovery apply threads have stopped looking at the hash table */
 
-	while (recv_sys->n_addrs != 0) {
+	while (recv_sys->n_addrs != 0 || recv_sys->n_apply_threads != 0) {
 
 		mutex_exit(&(recv_sys->mutex));
 
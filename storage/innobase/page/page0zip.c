@@ -37,6 +37,9 @@ Created June 2005 by Marko Makela
 #include "page0types.h"
 #include "log0recv.h"
 #include "zlib.h"
+#include "ut0crc32.h"
+#include "buf0buf.h"
+#include "srv0srv.h"
 #ifndef UNIV_HOTBACKUP
 # include "buf0lru.h"
 # include "btr0sea.h"
@@ -4767,7 +4770,9 @@ ulint
 page_zip_calc_checksum(
 /*===================*/
 	const void*	data,	/*!< in: compressed page */
-	ulint		size)	/*!< in: size of compressed page */
+	ulint		size,	/*!< in: size of compressed page */
+	srv_checksum_algorithm_t algo)
+				/*!< in: algorithm to use */
 {
 	/* Exclude FIL_PAGE_SPACE_OR_CHKSUM, FIL_PAGE_LSN,
 	and FIL_PAGE_FILE_FLUSH_LSN from the checksum. */
@@ -4777,11 +4782,62 @@ page_zip_calc_checksum(
 
 	ut_ad(size > FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID);
 
-	adler = adler32(0L, s + FIL_PAGE_OFFSET,
-			FIL_PAGE_LSN - FIL_PAGE_OFFSET);
-	adler = adler32(adler, s + FIL_PAGE_TYPE, 2);
-	adler = adler32(adler, s + FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID,
-			size - FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID);
+	switch (algo) {
+	case SRV_CHECKSUM_ALGORITHM_CRC32:
+		return((ulint) (ut_crc32(s + FIL_PAGE_OFFSET,
+					 FIL_PAGE_LSN - FIL_PAGE_OFFSET)
+				^ ut_crc32(s + FIL_PAGE_TYPE, 2)
+				^ ut_crc32(s + FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID,
+					   size
+					   - FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID)));
+	case SRV_CHECKSUM_ALGORITHM_INNODB:
+		adler = adler32(0L, s + FIL_PAGE_OFFSET,
+				FIL_PAGE_LSN - FIL_PAGE_OFFSET);
+		adler = adler32(adler, s + FIL_PAGE_TYPE, 2);
+		adler = adler32(adler, s + FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID,
+				size - FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID);
+
+		return((ulint) adler);
+	case SRV_CHECKSUM_ALGORITHM_NONE:
+		return(BUF_NO_CHECKSUM_MAGIC);
+	}
+
+	ut_error;
+	return(0);
+}
+
+/**********************************************************************//**
+Verify a compressed page's checksum. A checksum written with any of
+the srv_checksum_algorithm_t algorithms is accepted.
+@return	TRUE if the stored checksum is valid */
+UNIV_INTERN
+ibool
+page_zip_verify_checksum(
+/*=====================*/
+	const void*	data,	/*!< in: compressed page */
+	ulint		size)	/*!< in: size of compressed page */
+{
+	ulint	stored;
+
+	stored = mach_read_from_4((const byte*) data
+				  + FIL_PAGE_SPACE_OR_CHKSUM);
+
+	if (stored == BUF_NO_CHECKSUM_MAGIC) {
+		return(TRUE);
+	}
+
+	/* Try the configured algorithm first, so that a page written
+	with it is verified with a single checksum computation. */
+
+	if (srv_checksum_algorithm == SRV_CHECKSUM_ALGORITHM_CRC32) {
+		return(stored == page_zip_calc_checksum(
+			       data, size, SRV_CHECKSUM_ALGORITHM_CRC32)
+		       || stored == page_zip_calc_checksum(
+			       data, size, SRV_CHECKSUM_ALGORITHM_INNODB));
+	}
 
-	return((ulint) adler);
+	return(stored == page_zip_calc_checksum(
+		       data, size, SRV_CHECKSUM_ALGORITHM_INNODB)
+	       || stored == page_zip_calc_checksum(
+		       data, size, SRV_CHECKSUM_ALGORITHM_CRC32));
 }
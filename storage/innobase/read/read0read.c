@@ -179,12 +179,19 @@ read_view_oldest_copy_or_open_new(
 	ulint		n;
 	ulint		i;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_sys_mutex_own());
+
+	/* The read view mutex keeps old_view from being closed while
+	we copy it. */
+
+	read_view_mutex_enter();
 
 	old_view = UT_LIST_GET_LAST(trx_sys->view_list);
 
 	if (old_view == NULL) {
 
+		read_view_mutex_exit();
+
 		return(read_view_open_now(cr_trx_id, heap));
 	}
 
@@ -238,6 +245,8 @@ read_view_oldest_copy_or_open_new(
 
 	UT_LIST_ADD_LAST(view_list, trx_sys->view_list, view_copy);
 
+	read_view_mutex_exit();
+
 	return(view_copy);
 }
 
@@ -258,7 +267,7 @@ read_view_open_now(
 	trx_t*		trx;
 	ulint		n;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_sys_mutex_own());
 
 	view = read_view_create_low(UT_LIST_GET_LEN(trx_sys->trx_list), heap);
 
@@ -309,9 +318,15 @@ read_view_open_now(
 		view->up_limit_id = view->low_limit_id;
 	}
 
+	/* Views are inserted while holding trx_sys->mutex, which keeps
+	view_list sorted on low_limit_no. */
+
+	read_view_mutex_enter();
 
 	UT_LIST_ADD_FIRST(view_list, trx_sys->view_list, view);
 
+	read_view_mutex_exit();
+
 	return(view);
 }
 
@@ -323,7 +338,7 @@ read_view_close(
 /*============*/
 	read_view_t*	view)	/*!< in: read view */
 {
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(read_view_mutex_own());
 
 	UT_LIST_REMOVE(view_list, trx_sys->view_list, view);
 }
@@ -339,7 +354,7 @@ read_view_close_for_mysql(
 {
 	ut_a(trx->global_read_view);
 
-	mutex_enter(&kernel_mutex);
+	read_view_mutex_enter();
 
 	read_view_close(trx->global_read_view);
 
@@ -348,7 +363,7 @@ read_view_close_for_mysql(
 	trx->read_view = NULL;
 	trx->global_read_view = NULL;
 
-	mutex_exit(&kernel_mutex);
+	read_view_mutex_exit();
 }
 
 /*********************************************************************//**
@@ -421,7 +436,7 @@ read_cursor_view_create_for_mysql(
 	curview->n_mysql_tables_in_use = cr_trx->n_mysql_tables_in_use;
 	cr_trx->n_mysql_tables_in_use = 0;
 
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 
 	curview->read_view = read_view_create_low(
 		UT_LIST_GET_LEN(trx_sys->trx_list), curview->heap);
@@ -474,9 +489,13 @@ read_cursor_view_create_for_mysql(
 		view->up_limit_id = view->low_limit_id;
 	}
 
+	read_view_mutex_enter();
+
 	UT_LIST_ADD_FIRST(view_list, trx_sys->view_list, view);
 
-	mutex_exit(&kernel_mutex);
+	read_view_mutex_exit();
+
+	trx_sys_mutex_exit();
 
 	return(curview);
 }
@@ -499,12 +518,12 @@ read_cursor_view_close_for_mysql(
 	belong to this transaction */
 	trx->n_mysql_tables_in_use += curview->n_mysql_tables_in_use;
 
-	mutex_enter(&kernel_mutex);
+	read_view_mutex_enter();
 
 	read_view_close(curview->read_view);
 	trx->read_view = trx->global_read_view;
 
-	mutex_exit(&kernel_mutex);
+	read_view_mutex_exit();
 
 	mem_heap_free(curview->heap);
 }
@@ -522,7 +541,7 @@ read_cursor_set_for_mysql(
 {
 	ut_a(trx);
 
-	mutex_enter(&kernel_mutex);
+	read_view_mutex_enter();
 
 	if (UNIV_LIKELY(curview != NULL)) {
 		trx->read_view = curview->read_view;
@@ -530,5 +549,5 @@ read_cursor_set_for_mysql(
 		trx->read_view = trx->global_read_view;
 	}
 
-	mutex_exit(&kernel_mutex);
+	read_view_mutex_exit();
 }
@@ -56,6 +56,9 @@ Completed by Sunny Bains and Marko Makela
 #include "log0log.h"
 #include "ut0sort.h"
 #include "handler0alter.h"
+#include "srv0srv.h"
+#include "os0thread.h"
+#include "os0sync.h"
 
 /* Ignore posix_fadvise() on those platforms where it does not exist */
 #if defined __WIN__
@@ -132,6 +135,98 @@ struct merge_file_struct {
 /** Information about temporary files used in merge sort */
 typedef struct merge_file_struct merge_file_t;
 
+/** State shared by the threads that merge the runs of one pass of
+row_merge(). Each output run is produced by one thread, which takes
+the next output run number from the shared counter. */
+struct row_merge_pass_struct {
+	mutex_t			mutex;	/*!< protects next, n_threads,
+					n_rec and error */
+	trx_t*			trx;	/*!< transaction */
+	const dict_index_t*	index;	/*!< index being created */
+	const merge_file_t*	file;	/*!< input file */
+	int			fd;	/*!< output file handle */
+	struct TABLE*		table;	/*!< MySQL table, for reporting
+					erroneous key value if applicable */
+	ulint			num_run;/*!< number of input runs */
+	const ulint*		run_offset;
+					/*!< first block of each input run;
+					run_offset[num_run] is the end of
+					the input file */
+	const ulint*		out_offset;
+					/*!< first block of each output run;
+					out_offset[n_out] is the end of
+					the output file */
+	ulint			n_out;	/*!< number of output runs */
+	ulint			next;	/*!< next output run to produce */
+	ulint			n_threads;/*!< number of helper threads
+					that have not exited yet */
+	os_event_t		event;	/*!< set when n_threads drops
+					to zero */
+	ib_uint64_t		n_rec;	/*!< number of records written
+					to the output file */
+	ulint			error;	/*!< DB_SUCCESS or the first
+					error that was encountered */
+};
+
+/** State shared by the threads that merge the runs of one pass */
+typedef struct row_merge_pass_struct row_merge_pass_t;
+
+/** Maximum number of key ranges per thread of a clustered index scan.
+Threads that are done with their ranges take over the remaining ones,
+so that a range with many records does not leave the others idle. */
+#define ROW_MERGE_SCAN_RANGES	4
+
+/** State shared by the threads that scan the clustered index in
+row_merge_read_clustered_index(). The index is split into key ranges
+at the node pointers of the root page, and each thread takes the next
+range from the shared counter. Every full sort buffer is a run of its
+own, so the threads append their blocks to the end of the files in
+whatever order they are written. */
+struct row_merge_scan_struct {
+	mutex_t			mutex;	/*!< protects next, n_threads,
+					n_rows, error, error_key_num and
+					the offset and n_rec of files[] */
+	trx_t*			trx;	/*!< transaction */
+	struct TABLE*		table;	/*!< MySQL table, for reporting
+					erroneous key value if applicable */
+	const dict_table_t*	old_table;/*!< table where rows are
+					read from */
+	const dict_table_t*	new_table;/*!< table where indexes are
+					created */
+	dict_index_t**		index;	/*!< indexes to be created */
+	merge_file_t*		files;	/*!< temporary files */
+	ulint			n_index;/*!< number of indexes to create */
+	const ulint*		nonnull;/*!< columns changed to NOT NULL,
+					or NULL */
+	ulint			n_nonnull;/*!< number of columns changed
+					to NOT NULL */
+	const dtuple_t**	bound;	/*!< range k starts at bound[k] and
+					ends before bound[k + 1]; NULL stands
+					for the start or the end of the index */
+	ulint			n_ranges;/*!< number of key ranges */
+	ulint			next;	/*!< next range to scan */
+	ulint			n_threads;/*!< number of helper threads
+					that have not exited yet */
+	os_event_t		event;	/*!< set when n_threads drops
+					to zero */
+	ulint			n_rows;	/*!< number of rows read */
+	ulint			error;	/*!< DB_SUCCESS or the first
+					error that was encountered */
+	ulint			error_key_num;/*!< index that caused error */
+};
+
+/** State shared by the threads that scan the clustered index */
+typedef struct row_merge_scan_struct row_merge_scan_t;
+
+#ifdef UNIV_PFS_MUTEX
+UNIV_INTERN mysql_pfs_key_t	row_merge_pass_mutex_key;
+UNIV_INTERN mysql_pfs_key_t	row_merge_scan_mutex_key;
+#endif /* UNIV_PFS_MUTEX */
+
+#ifdef UNIV_PFS_THREAD
+UNIV_INTERN mysql_pfs_key_t	row_merge_thread_key;
+#endif /* UNIV_PFS_THREAD */
+
 #ifdef UNIV_DEBUG
 /******************************************************//**
 Display a merge tuple. */
@@ -435,38 +530,36 @@ row_merge_buf_add(
 /** Structure for reporting duplicate records. */
 struct row_merge_dup_struct {
 	const dict_index_t*	index;		/*!< index being sorted */
-	struct TABLE*		table;		/*!< MySQL table object */
+	struct TABLE*		table;		/*!< MySQL table object, or
+						NULL if the first duplicate
+						is only remembered in entry */
 	ulint			n_dup;		/*!< number of duplicates */
+	const dfield_t*		entry;		/*!< first duplicate entry */
 };
 
 /** Structure for reporting duplicate records. */
 typedef struct row_merge_dup_struct row_merge_dup_t;
 
 /*************************************************************//**
-Report a duplicate key. */
+Convert a duplicate index entry to MySQL format in the row buffer of
+the MySQL table, for the error message. */
 static
 void
-row_merge_dup_report(
-/*=================*/
-	row_merge_dup_t*	dup,	/*!< in/out: for reporting duplicates */
+row_merge_dup_to_mysql(
+/*===================*/
+	const dict_index_t*	index,	/*!< in: index being sorted */
+	struct TABLE*		table,	/*!< in/out: MySQL table object */
 	const dfield_t*		entry)	/*!< in: duplicate index entry */
 {
 	mrec_buf_t* 		buf;
 	const dtuple_t*		tuple;
 	dtuple_t		tuple_store;
 	const rec_t*		rec;
-	const dict_index_t*	index	= dup->index;
 	ulint			n_fields= dict_index_get_n_fields(index);
 	mem_heap_t*		heap;
 	ulint*			offsets;
 	ulint			n_ext;
 
-	if (dup->n_dup++) {
-		/* Only report the first duplicate record,
-		but count all duplicate records. */
-		return;
-	}
-
 	/* Convert the tuple to a record and then to MySQL format. */
 	heap = mem_heap_create((1 + REC_OFFS_HEADER_SIZE + n_fields)
 			       * sizeof *offsets
@@ -480,11 +573,33 @@ row_merge_dup_report(
 	rec = rec_convert_dtuple_to_rec(*buf, index, tuple, n_ext);
 	offsets = rec_get_offsets(rec, index, NULL, ULINT_UNDEFINED, &heap);
 
-	innobase_rec_to_mysql(dup->table, rec, index, offsets);
+	innobase_rec_to_mysql(table, rec, index, offsets);
 
 	mem_heap_free(heap);
 }
 
+/*************************************************************//**
+Report a duplicate key. */
+static
+void
+row_merge_dup_report(
+/*=================*/
+	row_merge_dup_t*	dup,	/*!< in/out: for reporting duplicates */
+	const dfield_t*		entry)	/*!< in: duplicate index entry */
+{
+	if (dup->n_dup++) {
+		/* Only report the first duplicate record,
+		but count all duplicate records. */
+		return;
+	}
+
+	dup->entry = entry;
+
+	if (dup->table) {
+		row_merge_dup_to_mysql(dup->index, dup->table, entry);
+	}
+}
+
 /*************************************************************//**
 Compare two tuples.
 @return	1, 0, -1 if a is greater, equal, less, respectively, than b */
@@ -736,6 +851,13 @@ row_merge_read(
 	/* Each block is read exactly once.  Free up the file cache. */
 	posix_fadvise(fd, ofs, sizeof *buf, POSIX_FADV_DONTNEED);
 #endif /* POSIX_FADV_DONTNEED */
+#ifdef POSIX_FADV_WILLNEED
+	/* The next block of a run is likely to be read next.  Let the
+	kernel read it in the background while this block is merged.
+	With several merge threads, each thread reads its own runs, so
+	that POSIX_FADV_SEQUENTIAL alone does not cover all streams. */
+	posix_fadvise(fd, ofs + sizeof *buf, sizeof *buf, POSIX_FADV_WILLNEED);
+#endif /* POSIX_FADV_WILLNEED */
 
 	if (UNIV_UNLIKELY(!success)) {
 		ut_print_timestamp(stderr);
@@ -1139,108 +1261,134 @@ row_merge_cmp(
 	return(cmp);
 }
 
-/********************************************************************//**
-Reads clustered index of the table and create temporary files
-containing the index entries for the indexes to be built.
-@return	DB_SUCCESS or error */
-static __attribute__((nonnull))
-ulint
-row_merge_read_clustered_index(
-/*===========================*/
-	trx_t*			trx,	/*!< in: transaction */
-	struct TABLE*		table,	/*!< in/out: MySQL table object,
-					for reporting erroneous records */
-	const dict_table_t*	old_table,/*!< in: table where rows are
-					read from */
-	const dict_table_t*	new_table,/*!< in: table where indexes are
-					created; identical to old_table
-					unless creating a PRIMARY KEY */
-	dict_index_t**		index,	/*!< in: indexes to be created */
-	merge_file_t*		files,	/*!< in: temporary files */
-	ulint			n_index,/*!< in: number of indexes to create */
-	row_merge_block_t*	block)	/*!< in/out: file buffer */
+/*************************************************************//**
+Record an error of a clustered index scan.
+@return	TRUE if this was the first error of the scan */
+static
+ibool
+row_merge_scan_set_error(
+/*=====================*/
+	row_merge_scan_t*	scan,	/*!< in/out: clustered index scan */
+	ulint			error,	/*!< in: error code */
+	ulint			key_num)/*!< in: index that caused the error */
 {
-	dict_index_t*		clust_index;	/* Clustered index */
-	mem_heap_t*		row_heap;	/* Heap memory to create
-						clustered index records */
-	row_merge_buf_t**	merge_buf;	/* Temporary list for records*/
-	btr_pcur_t		pcur;		/* Persistent cursor on the
-						clustered index */
-	mtr_t			mtr;		/* Mini transaction */
-	ulint			err = DB_SUCCESS;/* Return code */
-	ulint			i;
-	ulint			n_nonnull = 0;	/* number of columns
-						changed to NOT NULL */
-	ulint*			nonnull = NULL;	/* NOT NULL columns */
+	ibool	first;
 
-	trx->op_info = "reading clustered index";
+	ut_ad(error != DB_SUCCESS);
 
-	ut_ad(trx);
-	ut_ad(old_table);
-	ut_ad(new_table);
-	ut_ad(index);
-	ut_ad(files);
-
-	/* Create and initialize memory for record buffers */
-
-	merge_buf = mem_alloc(n_index * sizeof *merge_buf);
-
-	for (i = 0; i < n_index; i++) {
-		merge_buf[i] = row_merge_buf_create(index[i]);
+	mutex_enter(&scan->mutex);
+	first = (scan->error == DB_SUCCESS);
+	if (first) {
+		scan->error = error;
+		scan->error_key_num = key_num;
 	}
+	mutex_exit(&scan->mutex);
 
-	mtr_start(&mtr);
-
-	/* Find the clustered index and create a persistent cursor
-	based on that. */
-
-	clust_index = dict_table_get_first_index(old_table);
+	return(first);
+}
 
-	btr_pcur_open_at_index_side(
-		TRUE, clust_index, BTR_SEARCH_LEAF, &pcur, TRUE, &mtr);
+/*************************************************************//**
+Sort a full buffer of index entries and append it to the end of the
+temporary file as a run of its own.
+@return	TRUE on success, FALSE if an error was recorded in scan */
+static
+ibool
+row_merge_scan_write(
+/*=================*/
+	row_merge_scan_t*	scan,	/*!< in/out: clustered index scan */
+	ulint			i,	/*!< in: number of the index */
+	row_merge_buf_t*	buf,	/*!< in/out: sort buffer */
+	row_merge_block_t*	block)	/*!< out: file buffer */
+{
+	merge_file_t*	file	= &scan->files[i];
+	ulint		offset;
+
+	ut_ad(buf->n_tuples);
+
+	if (dict_index_is_unique(buf->index)) {
+		row_merge_dup_t	dup;
+		dup.index = buf->index;
+		dup.table = NULL;
+		dup.n_dup = 0;
+
+		row_merge_buf_sort(buf, &dup);
+
+		if (dup.n_dup) {
+			/* Only the first thread to fail may use the
+			MySQL row buffer. */
+			if (row_merge_scan_set_error(
+				    scan, DB_DUPLICATE_KEY, i)) {
+				row_merge_dup_to_mysql(
+					dup.index, scan->table, dup.entry);
+			}
+			return(FALSE);
+		}
+	} else {
+		row_merge_buf_sort(buf, NULL);
+	}
 
-	if (UNIV_UNLIKELY(old_table != new_table)) {
-		ulint	n_cols = dict_table_get_n_cols(old_table);
+	row_merge_buf_write(buf, file, block);
 
-		/* A primary key will be created.  Identify the
-		columns that were flagged NOT NULL in the new table,
-		so that we can quickly check that the records in the
-		(old) clustered index do not violate the added NOT
-		NULL constraints. */
+	mutex_enter(&scan->mutex);
+	offset = file->offset++;
+	file->n_rec += buf->n_tuples;
+	mutex_exit(&scan->mutex);
 
-		ut_a(n_cols == dict_table_get_n_cols(new_table));
+	if (!row_merge_write(file->fd, offset, block)) {
+		row_merge_scan_set_error(scan, DB_OUT_OF_FILE_SPACE, i);
+		return(FALSE);
+	}
 
-		nonnull = mem_alloc(n_cols * sizeof *nonnull);
+	UNIV_MEM_INVALID(block[0], sizeof block[0]);
 
-		for (i = 0; i < n_cols; i++) {
-			if (dict_table_get_nth_col(old_table, i)->prtype
-			    & DATA_NOT_NULL) {
+	return(TRUE);
+}
 
-				continue;
-			}
+/*************************************************************//**
+Read one key range of the clustered index into the sort buffers. Full
+buffers are written to the temporary files.
+@return	TRUE on success, FALSE if an error was recorded in scan */
+static
+ibool
+row_merge_scan_range(
+/*=================*/
+	row_merge_scan_t*	scan,	/*!< in/out: clustered index scan */
+	const dtuple_t*		start,	/*!< in: first key of the range,
+					or NULL for the start of the index */
+	const dtuple_t*		end,	/*!< in: first key after the range,
+					or NULL for the end of the index */
+	row_merge_buf_t**	merge_buf,/*!< in/out: sort buffers */
+	row_merge_block_t*	block,	/*!< out: file buffer */
+	mem_heap_t*		row_heap,/*!< in/out: heap for building rows */
+	ulint*			n_rows)	/*!< in/out: number of rows read */
+{
+	dict_index_t*	clust_index;	/* Clustered index */
+	btr_pcur_t	pcur;		/* Persistent cursor on the
+					clustered index */
+	mtr_t		mtr;		/* Mini transaction */
+	ibool		success	= TRUE;
+	ulint		i;
 
-			if (dict_table_get_nth_col(new_table, i)->prtype
-			    & DATA_NOT_NULL) {
+	clust_index = dict_table_get_first_index(scan->old_table);
 
-				nonnull[n_nonnull++] = i;
-			}
-		}
+	mtr_start(&mtr);
 
-		if (!n_nonnull) {
-			mem_free(nonnull);
-			nonnull = NULL;
-		}
+	if (start) {
+		/* Position the cursor on the last record before the
+		range, so that moving to the next record enters it. */
+		btr_pcur_open(clust_index, start, PAGE_CUR_L,
+			      BTR_SEARCH_LEAF, &pcur, &mtr);
+	} else {
+		btr_pcur_open_at_index_side(
+			TRUE, clust_index, BTR_SEARCH_LEAF, &pcur, TRUE, &mtr);
 	}
 
-	row_heap = mem_heap_create(sizeof(mrec_buf_t));
-
-	/* Scan the clustered index. */
 	for (;;) {
 		const rec_t*	rec;
 		ulint*		offsets;
-		dtuple_t*	row		= NULL;
+		dtuple_t*	row;
 		row_ext_t*	ext;
-		ibool		has_next	= TRUE;
+		ulint		error;
 
 		btr_pcur_move_to_next_on_page(&pcur);
 
@@ -1248,10 +1396,21 @@ row_merge_read_clustered_index(
 		in order to release the latch on the old page. */
 
 		if (btr_pcur_is_after_last_on_page(&pcur)) {
-			if (UNIV_UNLIKELY(trx_is_interrupted(trx))) {
-				i = 0;
-				err = DB_INTERRUPTED;
-				goto err_exit;
+			if (UNIV_UNLIKELY(trx_is_interrupted(scan->trx))) {
+				row_merge_scan_set_error(
+					scan, DB_INTERRUPTED, 0);
+				success = FALSE;
+				break;
+			}
+
+			/* Stop if another thread has failed. */
+			mutex_enter(&scan->mutex);
+			error = scan->error;
+			mutex_exit(&scan->mutex);
+
+			if (error != DB_SUCCESS) {
+				success = FALSE;
+				break;
 			}
 
 			/* Store the cursor position on the last user
@@ -1273,138 +1432,424 @@ row_merge_read_clustered_index(
 			btr_pcur_restore_position(BTR_SEARCH_LEAF,
 						  &pcur, &mtr);
 			/* Move to the successor of the original record. */
-			has_next = btr_pcur_move_to_next_user_rec(&pcur, &mtr);
+			if (!btr_pcur_move_to_next_user_rec(&pcur, &mtr)) {
+				break;
+			}
 		}
 
-		if (UNIV_LIKELY(has_next)) {
-			rec = btr_pcur_get_rec(&pcur);
-			offsets = rec_get_offsets(rec, clust_index, NULL,
-						  ULINT_UNDEFINED, &row_heap);
+		rec = btr_pcur_get_rec(&pcur);
+		offsets = rec_get_offsets(rec, clust_index, NULL,
+					  ULINT_UNDEFINED, &row_heap);
 
-			/* Skip delete marked records. */
-			if (rec_get_deleted_flag(
-				    rec, dict_table_is_comp(old_table))) {
-				continue;
-			}
+		/* The rest of the index belongs to the next range. */
+		if (end && cmp_dtuple_rec(end, rec, offsets) <= 0) {
+			break;
+		}
 
-			srv_n_rows_inserted++;
+		/* Skip delete marked records. */
+		if (rec_get_deleted_flag(
+			    rec, dict_table_is_comp(scan->old_table))) {
+			mem_heap_empty(row_heap);
+			continue;
+		}
 
-			/* Build a row based on the clustered index. */
+		(*n_rows)++;
 
-			row = row_build(ROW_COPY_POINTERS, clust_index,
-					rec, offsets,
-					new_table, &ext, row_heap);
+		/* Build a row based on the clustered index. */
 
-			if (UNIV_LIKELY_NULL(nonnull)) {
-				for (i = 0; i < n_nonnull; i++) {
-					dfield_t*	field
-						= &row->fields[nonnull[i]];
-					dtype_t*	field_type
-						= dfield_get_type(field);
+		row = row_build(ROW_COPY_POINTERS, clust_index,
+				rec, offsets,
+				scan->new_table, &ext, row_heap);
 
-					ut_a(!(field_type->prtype
-					       & DATA_NOT_NULL));
+		if (UNIV_LIKELY_NULL(scan->nonnull)) {
+			for (i = 0; i < scan->n_nonnull; i++) {
+				dfield_t*	field
+					= &row->fields[scan->nonnull[i]];
+				dtype_t*	field_type
+					= dfield_get_type(field);
 
-					if (dfield_is_null(field)) {
-						err = DB_PRIMARY_KEY_IS_NULL;
-						i = 0;
-						goto err_exit;
-					}
+				ut_a(!(field_type->prtype & DATA_NOT_NULL));
 
-					field_type->prtype |= DATA_NOT_NULL;
+				if (dfield_is_null(field)) {
+					row_merge_scan_set_error(
+						scan, DB_PRIMARY_KEY_IS_NULL,
+						0);
+					success = FALSE;
+					goto func_exit;
 				}
+
+				field_type->prtype |= DATA_NOT_NULL;
 			}
 		}
 
 		/* Build all entries for all the indexes to be created
 		in a single scan of the clustered index. */
 
-		for (i = 0; i < n_index; i++) {
+		for (i = 0; i < scan->n_index; i++) {
 			row_merge_buf_t*	buf	= merge_buf[i];
-			merge_file_t*		file	= &files[i];
-			const dict_index_t*	index	= buf->index;
 
-			if (UNIV_LIKELY
-			    (row && row_merge_buf_add(buf, row, ext))) {
-				file->n_rec++;
+			if (UNIV_LIKELY(row_merge_buf_add(buf, row, ext))) {
 				continue;
 			}
 
-			/* The buffer must be sufficiently large
-			to hold at least one record. */
-			ut_ad(buf->n_tuples || !has_next);
-
 			/* We have enough data tuples to form a block.
 			Sort them and write to disk. */
 
-			if (buf->n_tuples) {
-				if (dict_index_is_unique(index)) {
-					row_merge_dup_t	dup;
-					dup.index = buf->index;
-					dup.table = table;
-					dup.n_dup = 0;
+			if (!row_merge_scan_write(scan, i, buf, block)) {
+				success = FALSE;
+				goto func_exit;
+			}
 
-					row_merge_buf_sort(buf, &dup);
+			merge_buf[i] = buf = row_merge_buf_empty(buf);
 
-					if (dup.n_dup) {
-						err = DB_DUPLICATE_KEY;
-err_exit:
-						trx->error_key_num = i;
-						goto func_exit;
-					}
-				} else {
-					row_merge_buf_sort(buf, NULL);
-				}
+			/* Try writing the record again, now that the
+			buffer has been written out and emptied. */
+
+			if (UNIV_UNLIKELY(!row_merge_buf_add(buf, row, ext))) {
+				/* An empty buffer should have enough
+				room for at least one record. */
+				ut_error;
 			}
+		}
 
-			row_merge_buf_write(buf, file, block);
+		mem_heap_empty(row_heap);
+	}
 
-			if (!row_merge_write(file->fd, file->offset++,
-					     block)) {
-				err = DB_OUT_OF_FILE_SPACE;
-				goto err_exit;
-			}
+func_exit:
+	btr_pcur_close(&pcur);
+	mtr_commit(&mtr);
+	mem_heap_empty(row_heap);
 
-			UNIV_MEM_INVALID(block[0], sizeof block[0]);
-			merge_buf[i] = row_merge_buf_empty(buf);
+	return(success);
+}
 
-			if (UNIV_LIKELY(row != NULL)) {
-				/* Try writing the record again, now
-				that the buffer has been written out
-				and emptied. */
+/*************************************************************//**
+Scan key ranges of the clustered index until all of them have been
+handed out or an error has occurred, and write out what is left in the
+sort buffers of this thread. */
+static
+void
+row_merge_scan_run(
+/*===============*/
+	row_merge_scan_t*	scan,	/*!< in/out: clustered index scan */
+	row_merge_block_t*	block)	/*!< out: file buffer */
+{
+	row_merge_buf_t**	merge_buf;	/* Temporary list for records*/
+	mem_heap_t*		row_heap;	/* Heap memory to create
+						clustered index records */
+	ulint			n_rows	= 0;
+	ibool			success	= TRUE;
+	ulint			i;
 
-				if (UNIV_UNLIKELY
-				    (!row_merge_buf_add(buf, row, ext))) {
-					/* An empty buffer should have enough
-					room for at least one record. */
-					ut_error;
-				}
+	/* Create and initialize memory for record buffers */
 
-				file->n_rec++;
-			}
+	merge_buf = mem_alloc(scan->n_index * sizeof *merge_buf);
+
+	for (i = 0; i < scan->n_index; i++) {
+		merge_buf[i] = row_merge_buf_create(scan->index[i]);
+	}
+
+	row_heap = mem_heap_create(sizeof(mrec_buf_t));
+
+	while (success) {
+		ulint	k;	/*!< key range number */
+
+		mutex_enter(&scan->mutex);
+
+		if (scan->error != DB_SUCCESS || scan->next >= scan->n_ranges) {
+			mutex_exit(&scan->mutex);
+			break;
 		}
 
-		mem_heap_empty(row_heap);
+		k = scan->next++;
 
-		if (UNIV_UNLIKELY(!has_next)) {
-			goto func_exit;
+		mutex_exit(&scan->mutex);
+
+		success = row_merge_scan_range(
+			scan, scan->bound[k], scan->bound[k + 1],
+			merge_buf, block, row_heap, &n_rows);
+	}
+
+	for (i = 0; i < scan->n_index; i++) {
+		if (success && merge_buf[i]->n_tuples) {
+			success = row_merge_scan_write(
+				scan, i, merge_buf[i], block);
 		}
+
+		row_merge_buf_free(merge_buf[i]);
 	}
 
-func_exit:
-	btr_pcur_close(&pcur);
-	mtr_commit(&mtr);
 	mem_heap_free(row_heap);
+	mem_free(merge_buf);
 
-	if (UNIV_LIKELY_NULL(nonnull)) {
-		mem_free(nonnull);
+	mutex_enter(&scan->mutex);
+	scan->n_rows += n_rows;
+	mutex_exit(&scan->mutex);
+}
+
+/*************************************************************//**
+A thread which helps row_merge_read_clustered_index() to scan the key
+ranges of the clustered index. It allocates its own file buffer.
+@return	a dummy parameter */
+static
+os_thread_ret_t
+row_merge_scan_thread(
+/*==================*/
+	void*	arg)	/*!< in: row_merge_scan_t* */
+{
+	row_merge_scan_t*	scan = arg;
+	row_merge_block_t*	block;
+	ulint			block_size;
+	ibool			last;
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(row_merge_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	block_size = sizeof *block;
+	block = os_mem_alloc_large(&block_size);
+
+	/* If the buffer cannot be allocated, leave the work to the
+	other threads. */
+	if (block) {
+		row_merge_scan_run(scan, block);
+		os_mem_free_large(block, block_size);
+	}
+
+	mutex_enter(&scan->mutex);
+	ut_a(scan->n_threads > 0);
+	last = (--scan->n_threads == 0);
+	mutex_exit(&scan->mutex);
+
+	/* Do not touch scan after this: it is freed as soon as the
+	event has been set. */
+	if (last) {
+		os_event_set(scan->event);
+	}
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/*************************************************************//**
+Split the clustered index into key ranges at the node pointers of the
+root page. The first node pointer is the minimum record and is never
+used as a bound. If the root is a leaf page, the whole index is one
+range.
+@return	number of ranges */
+static
+ulint
+row_merge_scan_split(
+/*=================*/
+	dict_index_t*		clust_index,/*!< in: clustered index */
+	ulint			n_max,	/*!< in: maximum number of ranges */
+	const dtuple_t**	bound,	/*!< out: n_max + 1 range bounds,
+					see row_merge_scan_struct */
+	mem_heap_t*		heap)	/*!< in/out: heap for the bounds */
+{
+	mtr_t		mtr;
+	buf_block_t*	block;
+	const page_t*	page;
+	const rec_t*	rec;
+	ulint		n_recs;
+	ulint		n;
+	ulint		i;
+	ulint		k;
+
+	mtr_start(&mtr);
+
+	block = btr_block_get(dict_index_get_space(clust_index),
+			      dict_table_zip_size(clust_index->table),
+			      dict_index_get_page(clust_index),
+			      RW_S_LATCH, clust_index, &mtr);
+	page = buf_block_get_frame(block);
+	n_recs = page_get_n_recs(page);
+
+	n = btr_page_get_level(page, &mtr) ? ut_min(n_max, n_recs) : 1;
+
+	bound[0] = bound[n] = NULL;
+
+	/* Range k starts at node pointer k * n_recs / n. */
+	rec = page_get_infimum_rec(page);
+
+	for (i = 0, k = 1; k < n; i++) {
+		rec = page_rec_get_next_const(rec);
+
+		if (i == k * n_recs / n) {
+			bound[k++] = dict_index_build_data_tuple(
+				clust_index, (rec_t*) rec,
+				dict_index_get_n_unique_in_tree(clust_index),
+				heap);
+		}
+	}
+
+	mtr_commit(&mtr);
+
+	return(n);
+}
+
+/********************************************************************//**
+Reads clustered index of the table and create temporary files
+containing the index entries for the indexes to be built. The index is
+split into key ranges, which are read by the calling thread and up to
+srv_merge_sort_threads - 1 helper threads.
+@return	DB_SUCCESS or error */
+static __attribute__((nonnull))
+ulint
+row_merge_read_clustered_index(
+/*===========================*/
+	trx_t*			trx,	/*!< in: transaction */
+	struct TABLE*		table,	/*!< in/out: MySQL table object,
+					for reporting erroneous records */
+	const dict_table_t*	old_table,/*!< in: table where rows are
+					read from */
+	const dict_table_t*	new_table,/*!< in: table where indexes are
+					created; identical to old_table
+					unless creating a PRIMARY KEY */
+	dict_index_t**		index,	/*!< in: indexes to be created */
+	merge_file_t*		files,	/*!< in: temporary files */
+	ulint			n_index,/*!< in: number of indexes to create */
+	row_merge_block_t*	block)	/*!< in/out: file buffer */
+{
+	row_merge_scan_t	scan;		/* Clustered index scan */
+	mem_heap_t*		heap;		/* Heap for the range bounds */
+	ulint			n_threads;
+	ulint			err;
+	ulint			i;
+	ulint			n_nonnull = 0;	/* number of columns
+						changed to NOT NULL */
+	ulint*			nonnull = NULL;	/* NOT NULL columns */
+
+	trx->op_info = "reading clustered index";
+
+	ut_ad(trx);
+	ut_ad(old_table);
+	ut_ad(new_table);
+	ut_ad(index);
+	ut_ad(files);
+
+	if (UNIV_UNLIKELY(old_table != new_table)) {
+		ulint	n_cols = dict_table_get_n_cols(old_table);
+
+		/* A primary key will be created.  Identify the
+		columns that were flagged NOT NULL in the new table,
+		so that we can quickly check that the records in the
+		(old) clustered index do not violate the added NOT
+		NULL constraints. */
+
+		ut_a(n_cols == dict_table_get_n_cols(new_table));
+
+		nonnull = mem_alloc(n_cols * sizeof *nonnull);
+
+		for (i = 0; i < n_cols; i++) {
+			if (dict_table_get_nth_col(old_table, i)->prtype
+			    & DATA_NOT_NULL) {
+
+				continue;
+			}
+
+			if (dict_table_get_nth_col(new_table, i)->prtype
+			    & DATA_NOT_NULL) {
+
+				nonnull[n_nonnull++] = i;
+			}
+		}
+
+		if (!n_nonnull) {
+			mem_free(nonnull);
+			nonnull = NULL;
+		}
+	}
+
+	n_threads = srv_merge_sort_threads;
+
+	heap = mem_heap_create(1024);
+
+	scan.trx = trx;
+	scan.table = table;
+	scan.old_table = old_table;
+	scan.new_table = new_table;
+	scan.index = index;
+	scan.files = files;
+	scan.n_index = n_index;
+	scan.nonnull = nonnull;
+	scan.n_nonnull = n_nonnull;
+	scan.bound = mem_heap_alloc(
+		heap, (n_threads * ROW_MERGE_SCAN_RANGES + 1)
+		* sizeof *scan.bound);
+	scan.n_ranges = row_merge_scan_split(
+		dict_table_get_first_index(old_table),
+		n_threads > 1 ? n_threads * ROW_MERGE_SCAN_RANGES : 1,
+		scan.bound, heap);
+	scan.next = 0;
+	scan.n_threads = 0;
+	scan.n_rows = 0;
+	scan.error = DB_SUCCESS;
+	scan.error_key_num = 0;
+
+	mutex_create(row_merge_scan_mutex_key, &scan.mutex,
+		     SYNC_NO_ORDER_CHECK);
+	scan.event = os_event_create(NULL);
+
+	n_threads = ut_min(n_threads, scan.n_ranges);
+
+	for (i = 1; i < n_threads; i++) {
+		mutex_enter(&scan.mutex);
+		scan.n_threads++;
+		mutex_exit(&scan.mutex);
+
+		os_thread_create(row_merge_scan_thread, &scan, NULL);
 	}
 
+	row_merge_scan_run(&scan, block);
+
+	if (n_threads > 1) {
+		os_event_wait(scan.event);
+	}
+
+	ut_ad(scan.n_threads == 0);
+
+	os_event_free(scan.event);
+	mutex_free(&scan.mutex);
+
+	srv_n_rows_inserted += scan.n_rows;
+
+	err = scan.error;
+
+	if (err != DB_SUCCESS) {
+		trx->error_key_num = scan.error_key_num;
+		goto func_exit;
+	}
+
+	/* The merge sort expects at least one block in every file,
+	even if it only holds the end-of-chunk marker. */
 	for (i = 0; i < n_index; i++) {
-		row_merge_buf_free(merge_buf[i]);
+		row_merge_buf_t*	buf;
+
+		if (files[i].offset) {
+			continue;
+		}
+
+		buf = row_merge_buf_create(index[i]);
+		row_merge_buf_write(buf, &files[i], block);
+		row_merge_buf_free(buf);
+
+		if (!row_merge_write(files[i].fd, files[i].offset++, block)) {
+			err = DB_OUT_OF_FILE_SPACE;
+			trx->error_key_num = i;
+			goto func_exit;
+		}
+
+		UNIV_MEM_INVALID(block[0], sizeof block[0]);
 	}
 
-	mem_free(merge_buf);
+func_exit:
+	mem_heap_free(heap);
+
+	if (UNIV_LIKELY_NULL(nonnull)) {
+		mem_free(nonnull);
+	}
 
 	trx->op_info = "";
 
@@ -1434,6 +1879,30 @@ func_exit:
 		}							\
 	} while (0)
 
+/*************************************************************//**
+Record an error of a merge pass.
+@return	TRUE if this was the first error of the pass */
+static
+ibool
+row_merge_pass_set_error(
+/*=====================*/
+	row_merge_pass_t*	pass,	/*!< in/out: merge pass */
+	ulint			error)	/*!< in: error code */
+{
+	ibool	first;
+
+	ut_ad(error != DB_SUCCESS);
+
+	mutex_enter(&pass->mutex);
+	first = (pass->error == DB_SUCCESS);
+	if (first) {
+		pass->error = error;
+	}
+	mutex_exit(&pass->mutex);
+
+	return(first);
+}
+
 /*************************************************************//**
 Merge two blocks of records on disk and write a bigger block.
 @return	DB_SUCCESS or error code */
@@ -1450,7 +1919,7 @@ row_merge_blocks(
 	ulint*			foffs1,	/*!< in/out: offset of second
 					source list in the file */
 	merge_file_t*		of,	/*!< in/out: output file */
-	struct TABLE*		table)	/*!< in/out: MySQL table, for
+	row_merge_pass_t*	pass)	/*!< in/out: merge pass, for
 					reporting erroneous key value
 					if applicable */
 {
@@ -1511,8 +1980,14 @@ corrupt:
 		case 0:
 			if (UNIV_UNLIKELY
 			    (dict_index_is_unique(index) && !null_eq)) {
-				innobase_rec_to_mysql(table, mrec0,
-						      index, offsets0);
+				/* Only the first thread to fail may
+				use the MySQL row buffer. */
+				if (row_merge_pass_set_error(
+					    pass, DB_DUPLICATE_KEY)) {
+					innobase_rec_to_mysql(
+						pass->table, mrec0,
+						index, offsets0);
+				}
 				mem_heap_free(heap);
 				return(DB_DUPLICATE_KEY);
 			}
@@ -1622,7 +2097,134 @@ done0:
 }
 
 /*************************************************************//**
-Merge disk files.
+Produce output runs of a merge pass until all of them have been
+handed out or an error has occurred. */
+static
+void
+row_merge_pass_run(
+/*===============*/
+	row_merge_pass_t*	pass,	/*!< in/out: merge pass */
+	row_merge_block_t*	block)	/*!< in/out: 3 buffers */
+{
+	const ulint	half	= pass->num_run / 2;
+
+	for (;;) {
+		ulint		k;	/*!< output run number */
+		ulint		foffs0;	/*!< first input offset */
+		ulint		foffs1;	/*!< second input offset */
+		merge_file_t	of;	/*!< output run */
+		ulint		error;
+
+		mutex_enter(&pass->mutex);
+
+		if (pass->error != DB_SUCCESS || pass->next >= pass->n_out) {
+			mutex_exit(&pass->mutex);
+			return;
+		}
+
+		k = pass->next++;
+
+		mutex_exit(&pass->mutex);
+
+		if (UNIV_UNLIKELY(trx_is_interrupted(pass->trx))) {
+			row_merge_pass_set_error(pass, DB_INTERRUPTED);
+			return;
+		}
+
+		of.fd = pass->fd;
+		of.offset = pass->out_offset[k];
+		of.n_rec = 0;
+
+		if (k < half) {
+			/* Merge a run of the first half of the input
+			with the corresponding run of the second half. */
+			foffs0 = pass->run_offset[k];
+			foffs1 = pass->run_offset[half + k];
+
+			error = row_merge_blocks(pass->index, pass->file,
+						 block, &foffs0, &foffs1,
+						 &of, pass);
+		} else {
+			/* Copy the last run of the second half. */
+			foffs0 = pass->run_offset[half + k];
+
+			error = row_merge_blocks_copy(pass->index, pass->file,
+						      block, &foffs0, &of)
+				? DB_SUCCESS : DB_CORRUPTION;
+		}
+
+		/* The output run must fit in the space of its input
+		runs, or it would have overwritten the next output run. */
+		if (error == DB_SUCCESS
+		    && UNIV_UNLIKELY(of.offset > pass->out_offset[k + 1])) {
+			error = DB_CORRUPTION;
+		}
+
+		if (error != DB_SUCCESS) {
+			row_merge_pass_set_error(pass, error);
+			return;
+		}
+
+		mutex_enter(&pass->mutex);
+		pass->n_rec += of.n_rec;
+		mutex_exit(&pass->mutex);
+	}
+}
+
+/*************************************************************//**
+A thread which helps row_merge() to merge the runs of a pass. It
+allocates its own merge buffers.
+@return	a dummy parameter */
+static
+os_thread_ret_t
+row_merge_thread(
+/*=============*/
+	void*	arg)	/*!< in: row_merge_pass_t* */
+{
+	row_merge_pass_t*	pass = arg;
+	row_merge_block_t*	block;
+	ulint			block_size;
+	ibool			last;
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(row_merge_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	block_size = 3 * sizeof *block;
+	block = os_mem_alloc_large(&block_size);
+
+	/* If the buffers cannot be allocated, leave the work to the
+	other threads. */
+	if (block) {
+		row_merge_pass_run(pass, block);
+		os_mem_free_large(block, block_size);
+	}
+
+	mutex_enter(&pass->mutex);
+	ut_a(pass->n_threads > 0);
+	last = (--pass->n_threads == 0);
+	mutex_exit(&pass->mutex);
+
+	/* Do not touch pass after this: row_merge() frees it as soon
+	as the event has been set. */
+	if (last) {
+		os_event_set(pass->event);
+	}
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/*************************************************************//**
+Merge disk files. Each run of the first half of the input file is
+merged with the corresponding run of the second half. The output
+runs are produced by the calling thread and up to
+srv_merge_sort_threads - 1 helper threads. Since an output run is
+at most as long as its input runs, each output run is written at the
+file offset where its input runs would start if they were laid out
+one after another. Thus the threads never need to wait for each other;
+the output file may contain unused blocks after the end of a run.
 @return	DB_SUCCESS or error code */
 static __attribute__((nonnull))
 ulint
@@ -1639,27 +2241,24 @@ row_merge(
 					if applicable */
 	ulint*			num_run,/*!< in/out: Number of runs remain
 					to be merged */
-	ulint*			run_offset) /*!< in/out: Array contains the
+	ulint*			run_offset, /*!< in/out: Array contains the
 					first offset number for each merge
-					run */
+					run, and the end of the file */
+	ulint*			out_offset) /*!< out: scratch array of
+					the same size as run_offset */
 {
-	ulint		foffs0;	/*!< first input offset */
-	ulint		foffs1;	/*!< second input offset */
-	ulint		error;	/*!< error code */
-	merge_file_t	of;	/*!< output file */
-	const ulint	ihalf	= run_offset[*num_run / 2];
-				/*!< half the input file */
-	ulint		n_run	= 0;
-				/*!< num of runs generated from this merge */
-
+	row_merge_pass_t	pass;	/*!< merge pass */
+	ulint			half	= *num_run / 2;
+	ulint			n_out	= *num_run - half;
+	ulint			n_threads;
+	ulint			error;
+	ulint			k;
 
 	UNIV_MEM_ASSERT_W(block[0], 3 * sizeof block[0]);
 
-	ut_ad(ihalf < file->offset);
-
-	of.fd = *tmpfd;
-	of.offset = 0;
-	of.n_rec = 0;
+	ut_ad(half > 0);
+	ut_ad(run_offset[*num_run] == file->offset);
+	ut_ad(run_offset[half] < file->offset);
 
 #ifdef POSIX_FADV_SEQUENTIAL
 	/* The input file will be read sequentially, starting from the
@@ -1669,83 +2268,86 @@ row_merge(
 		      POSIX_FADV_SEQUENTIAL | POSIX_FADV_NOREUSE);
 #endif /* POSIX_FADV_SEQUENTIAL */
 
-	/* Merge blocks to the output file. */
-	foffs0 = 0;
-	foffs1 = ihalf;
+	/* Compute where each output run will be written. */
+	out_offset[0] = 0;
 
-	UNIV_MEM_INVALID(run_offset, *num_run * sizeof *run_offset);
+	for (k = 0; k < n_out; k++) {
+		ulint	len;
 
-	for (; foffs0 < ihalf && foffs1 < file->offset; foffs0++, foffs1++) {
-
-		if (UNIV_UNLIKELY(trx_is_interrupted(trx))) {
-			return(DB_INTERRUPTED);
+		if (k < half) {
+			len = run_offset[k + 1] - run_offset[k]
+				+ run_offset[half + k + 1]
+				- run_offset[half + k];
+		} else {
+			len = run_offset[half + k + 1] - run_offset[half + k];
 		}
 
-		/* Remember the offset number for this run */
-		run_offset[n_run++] = of.offset;
+		out_offset[k + 1] = out_offset[k] + len;
+	}
 
-		error = row_merge_blocks(index, file, block,
-					 &foffs0, &foffs1, &of, table);
+	ut_ad(out_offset[n_out] == file->offset);
 
-		if (error != DB_SUCCESS) {
-			return(error);
-		}
+	pass.trx = trx;
+	pass.index = index;
+	pass.file = file;
+	pass.fd = *tmpfd;
+	pass.table = table;
+	pass.num_run = *num_run;
+	pass.run_offset = run_offset;
+	pass.out_offset = out_offset;
+	pass.n_out = n_out;
+	pass.next = 0;
+	pass.n_threads = 0;
+	pass.n_rec = 0;
+	pass.error = DB_SUCCESS;
 
-	}
+	mutex_create(row_merge_pass_mutex_key, &pass.mutex,
+		     SYNC_NO_ORDER_CHECK);
+	pass.event = os_event_create(NULL);
 
-	/* Copy the last blocks, if there are any. */
+	n_threads = ut_min(srv_merge_sort_threads, n_out);
 
-	while (foffs0 < ihalf) {
-		if (UNIV_UNLIKELY(trx_is_interrupted(trx))) {
-			return(DB_INTERRUPTED);
-		}
+	for (k = 1; k < n_threads; k++) {
+		mutex_enter(&pass.mutex);
+		pass.n_threads++;
+		mutex_exit(&pass.mutex);
+
+		os_thread_create(row_merge_thread, &pass, NULL);
+	}
 
-		/* Remember the offset number for this run */
-		run_offset[n_run++] = of.offset;
+	row_merge_pass_run(&pass, block);
 
-		if (!row_merge_blocks_copy(index, file, block, &foffs0, &of)) {
-			return(DB_CORRUPTION);
-		}
+	if (n_threads > 1) {
+		os_event_wait(pass.event);
 	}
 
-	ut_ad(foffs0 == ihalf);
+	ut_ad(pass.n_threads == 0);
 
-	while (foffs1 < file->offset) {
-		if (UNIV_UNLIKELY(trx_is_interrupted(trx))) {
-			return(DB_INTERRUPTED);
-		}
+	os_event_free(pass.event);
+	mutex_free(&pass.mutex);
 
-		/* Remember the offset number for this run */
-		run_offset[n_run++] = of.offset;
+	error = pass.error;
 
-		if (!row_merge_blocks_copy(index, file, block, &foffs1, &of)) {
-			return(DB_CORRUPTION);
-		}
+	if (error != DB_SUCCESS) {
+		return(error);
 	}
 
-	ut_ad(foffs1 == file->offset);
-
-	if (UNIV_UNLIKELY(of.n_rec != file->n_rec)) {
+	if (UNIV_UNLIKELY(pass.n_rec != file->n_rec)) {
 		return(DB_CORRUPTION);
 	}
 
-	ut_ad(n_run <= *num_run);
-
-	*num_run = n_run;
-
 	/* Each run can contain one or more offsets. As merge goes on,
 	the number of runs (to merge) will reduce until we have one
 	single run. So the number of runs will always be smaller than
 	the number of offsets in file */
-	ut_ad((*num_run) <= file->offset);
+	ut_ad(n_out < *num_run);
 
-	/* The number of offsets in output file is always equal or
-	smaller than input file */
-	ut_ad(of.offset <= file->offset);
+	*num_run = n_out;
+	memcpy(run_offset, out_offset, (n_out + 1) * sizeof *run_offset);
 
 	/* Swap file descriptors for the next pass. */
 	*tmpfd = file->fd;
-	*file = of;
+	file->fd = pass.fd;
 
 	UNIV_MEM_INVALID(block[0], 3 * sizeof block[0]);
 
@@ -1769,10 +2371,10 @@ row_merge_sort(
 					reporting erroneous key value
 					if applicable */
 {
-	ulint	half = file->offset / 2;
 	ulint	num_runs;
 	ulint*	run_offset;
 	ulint	error = DB_SUCCESS;
+	ulint	i;
 
 	/* Record the number of merge runs we need to perform */
 	num_runs = file->offset;
@@ -1782,12 +2384,14 @@ row_merge_sort(
 		return(error);
 	}
 
-	/* "run_offset" records each run's first offset number */
-	run_offset = (ulint*) mem_alloc(file->offset * sizeof(ulint));
+	/* "run_offset" records each run's first offset number, followed
+	by the end of the file, and the same again for the output of
+	a merge pass. Initially, each block is a run of its own. */
+	run_offset = (ulint*) mem_alloc(2 * (num_runs + 1) * sizeof(ulint));
 
-	/* This tells row_merge() where to start for the first round
-	of merge. */
-	run_offset[half] = half;
+	for (i = 0; i <= num_runs; i++) {
+		run_offset[i] = i;
+	}
 
 	/* The file should always contain at least one byte (the end
 	of file marker).  Thus, it must be at least one block. */
@@ -1796,7 +2400,8 @@ row_merge_sort(
 	/* Merge the runs until we have one big run */
 	do {
 		error = row_merge(trx, index, file, block, tmpfd,
-				  table, &num_runs, run_offset);
+				  table, &num_runs, run_offset,
+				  run_offset + file->offset + 1);
 
 		UNIV_MEM_ASSERT_RW(run_offset, num_runs * sizeof *run_offset);
 
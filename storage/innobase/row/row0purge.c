@@ -75,6 +75,8 @@ row_purge_node_create(
 
 	node->heap = mem_heap_create(256);
 
+	node->recs = NULL;
+
 	return(node);
 }
 
@@ -728,9 +730,9 @@ err_exit:
 }
 
 /***********************************************************//**
-Fetches an undo log record and does the purge for the recorded operation.
-If none left, or the current purge completed, returns the control to the
-parent node, which is always a query thread node. */
+Takes the next undo log record handed to the purge node by trx_purge() and
+does the purge for the recorded operation. If none left, returns the
+control to the parent node, which is always a query thread node. */
 static __attribute__((nonnull))
 void
 row_purge(
@@ -743,10 +745,7 @@ row_purge(
 	ut_ad(node);
 	ut_ad(thr);
 
-	node->undo_rec = trx_purge_fetch_next_rec(&node->roll_ptr,
-						  &node->reservation,
-						  node->heap);
-	if (!node->undo_rec) {
+	if (node->recs == NULL) {
 		/* Purge completed for this query thread */
 
 		thr->run_node = que_node_get_parent(node);
@@ -754,8 +753,13 @@ row_purge(
 		return;
 	}
 
-	if (node->undo_rec != &trx_purge_dummy_rec
-	    && row_purge_parse_undo_rec(node, &updated_extern, thr)) {
+	node->undo_rec = node->recs->undo_rec;
+	node->roll_ptr = node->recs->roll_ptr;
+	node->recs = node->recs->next;
+
+	ut_ad(node->undo_rec != &trx_purge_dummy_rec);
+
+	if (row_purge_parse_undo_rec(node, &updated_extern, thr)) {
 		node->found_clust = FALSE;
 
 		node->index = dict_table_get_next_index(
@@ -778,7 +782,6 @@ row_purge(
 	}
 
 	/* Do some cleanup */
-	trx_purge_rec_release(node->reservation);
 	mem_heap_empty(node->heap);
 
 	thr->run_node = node;
@@ -1225,7 +1225,7 @@ row_sel_try_search_shortcut(
 	ut_ad(plan->unique_search);
 	ut_ad(!plan->must_get_clust);
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
+	ut_ad(rw_lock_own(btr_search_get_latch(index), RW_LOCK_SHARED));
 #endif /* UNIV_SYNC_DEBUG */
 
 	row_sel_open_pcur(plan, TRUE, mtr);
@@ -1318,6 +1318,10 @@ row_sel(
 	rec_t*		old_vers;
 	rec_t*		clust_rec;
 	ibool		search_latch_locked;
+	rw_lock_t*	search_latch			= NULL;
+					/* the adaptive hash index partition
+					latch that is s-latched if
+					search_latch_locked */
 	ibool		consistent_read;
 
 	/* The following flag becomes TRUE when we are doing a
@@ -1395,11 +1399,23 @@ table_loop:
 	if (consistent_read && plan->unique_search && !plan->pcur_is_open
 	    && !plan->must_get_clust
 	    && !plan->table->big_rows) {
+		if (search_latch_locked
+		    && search_latch != btr_search_get_latch(plan->index)) {
+			/* The previous table of the join was looked up
+			in a different partition of the hash index */
+
+			rw_lock_s_unlock(search_latch);
+
+			search_latch_locked = FALSE;
+		}
+
 		if (!search_latch_locked) {
-			rw_lock_s_lock(&btr_search_latch);
+			search_latch = btr_search_get_latch(plan->index);
+
+			rw_lock_s_lock(search_latch);
 
 			search_latch_locked = TRUE;
-		} else if (rw_lock_get_writer(&btr_search_latch) == RW_LOCK_WAIT_EX) {
+		} else if (rw_lock_get_writer(search_latch) == RW_LOCK_WAIT_EX) {
 
 			/* There is an x-latch request waiting: release the
 			s-latch for a moment; as an s-latch here is often
@@ -1408,8 +1424,8 @@ table_loop:
 			from acquiring an s-latch for a long time, lowering
 			performance significantly in multiprocessors. */
 
-			rw_lock_s_unlock(&btr_search_latch);
-			rw_lock_s_lock(&btr_search_latch);
+			rw_lock_s_unlock(search_latch);
+			rw_lock_s_lock(search_latch);
 		}
 
 		found_flag = row_sel_try_search_shortcut(node, plan, &mtr);
@@ -1432,7 +1448,7 @@ table_loop:
 	}
 
 	if (search_latch_locked) {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(search_latch);
 
 		search_latch_locked = FALSE;
 	}
@@ -2008,7 +2024,7 @@ lock_wait_or_error:
 
 func_exit:
 	if (search_latch_locked) {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(search_latch);
 	}
 	if (UNIV_LIKELY_NULL(heap)) {
 		mem_heap_free(heap);
@@ -2693,6 +2709,137 @@ row_sel_field_store_in_mysql_format(
 	}
 }
 
+/**************************************************************//**
+Convert a field in the Innobase format to a field in the MySQL format.
+@return TRUE on success, FALSE if the field could not be retrieved */
+static __attribute__((warn_unused_result))
+ibool
+row_sel_store_mysql_field(
+/*======================*/
+	byte*		mysql_rec,	/*!< out: record in the
+					MySQL format */
+	row_prebuilt_t*	prebuilt,	/*!< in/out: prebuilt struct */
+	const rec_t*	rec,		/*!< in: InnoDB record;
+					must be protected by
+					a page latch */
+	const ulint*	offsets,	/*!< in: array returned by
+					rec_get_offsets() */
+	ulint		field_no,	/*!< in: templ->rec_field_no or
+					templ->clust_rec_field_no or
+					templ->icp_rec_field_no */
+	const mysql_row_templ_t*templ)	/*!< in: row template */
+{
+	mem_heap_t*	extern_field_heap	= NULL;
+	mem_heap_t*	heap;
+	const byte*	data;
+	ulint		len;
+
+	if (UNIV_UNLIKELY(rec_offs_nth_extern(offsets, field_no))) {
+
+		/* Copy an externally stored field to the temporary
+		heap */
+
+		ut_a(!prebuilt->trx->has_search_latch);
+
+		if (UNIV_UNLIKELY(templ->type == DATA_BLOB)) {
+			if (prebuilt->blob_heap == NULL) {
+				prebuilt->blob_heap = mem_heap_create(
+					UNIV_PAGE_SIZE);
+			}
+
+			heap = prebuilt->blob_heap;
+		} else {
+			extern_field_heap
+				= mem_heap_create(UNIV_PAGE_SIZE);
+
+			heap = extern_field_heap;
+		}
+
+		/* NOTE: if we are retrieving a big BLOB, we may
+		already run out of memory in the next call, which
+		causes an assert */
+
+		data = btr_rec_copy_externally_stored_field(
+			rec, offsets,
+			dict_table_zip_size(prebuilt->table),
+			field_no, &len, heap);
+
+		if (UNIV_UNLIKELY(!data)) {
+			/* The externally stored field
+			was not written yet. This
+			record should only be seen by
+			recv_recovery_rollback_active()
+			or any TRX_ISO_READ_UNCOMMITTED
+			transactions. */
+
+			if (extern_field_heap) {
+				mem_heap_free(extern_field_heap);
+			}
+
+			return(FALSE);
+		}
+
+		ut_a(len != UNIV_SQL_NULL);
+	} else {
+		/* Field is stored in the row. */
+
+		data = rec_get_nth_field(rec, offsets, field_no, &len);
+
+		if (UNIV_UNLIKELY(templ->type == DATA_BLOB)
+		    && len != UNIV_SQL_NULL) {
+
+			/* It is a BLOB field locally stored in the
+			InnoDB record: we MUST copy its contents to
+			prebuilt->blob_heap here because later code
+			assumes all BLOB values have been copied to a
+			safe place. */
+
+			if (prebuilt->blob_heap == NULL) {
+				prebuilt->blob_heap = mem_heap_create(
+					UNIV_PAGE_SIZE);
+			}
+
+			data = memcpy(mem_heap_alloc(
+					prebuilt->blob_heap, len),
+					data, len);
+		}
+	}
+
+	if (len != UNIV_SQL_NULL) {
+		row_sel_field_store_in_mysql_format(
+			mysql_rec + templ->mysql_col_offset,
+			templ, data, len);
+
+		/* Cleanup */
+		if (extern_field_heap) {
+			mem_heap_free(extern_field_heap);
+			extern_field_heap = NULL;
+		}
+
+		if (templ->mysql_null_bit_mask) {
+			/* It is a nullable column with a non-NULL
+			value */
+			mysql_rec[templ->mysql_null_byte_offset]
+				&= ~(byte) templ->mysql_null_bit_mask;
+		}
+	} else {
+		/* MySQL assumes that the field for an SQL
+		NULL value is set to the default value. */
+
+		UNIV_MEM_ASSERT_RW(prebuilt->default_rec
+				   + templ->mysql_col_offset,
+				   templ->mysql_col_len);
+		mysql_rec[templ->mysql_null_byte_offset]
+			|= (byte) templ->mysql_null_bit_mask;
+		memcpy(mysql_rec + templ->mysql_col_offset,
+		       (const byte*) prebuilt->default_rec
+		       + templ->mysql_col_offset,
+		       templ->mysql_col_len);
+	}
+
+	return(TRUE);
+}
+
 /**************************************************************//**
 Convert a row in the Innobase format to a row in the MySQL format.
 Note that the template in prebuilt may advise us to copy only a few
@@ -2715,8 +2862,6 @@ row_sel_store_mysql_rec(
 	const ulint*	offsets)	/*!< in: array returned by
 					rec_get_offsets(rec) */
 {
-	mem_heap_t*	extern_field_heap	= NULL;
-	mem_heap_t*	heap;
 	ulint		i;
 
 	ut_ad(prebuilt->mysql_template);
@@ -2732,114 +2877,15 @@ row_sel_store_mysql_rec(
 	for (i = 0; i < prebuilt->n_template; i++) {
 
 		const mysql_row_templ_t*templ = prebuilt->mysql_template + i;
-		const byte*		data;
-		ulint			len;
-		ulint			field_no;
-
-		field_no = rec_clust
-			? templ->clust_rec_field_no : templ->rec_field_no;
-
-		if (UNIV_UNLIKELY(rec_offs_nth_extern(offsets, field_no))) {
-
-			/* Copy an externally stored field to the temporary
-			heap */
-
-			ut_a(!prebuilt->trx->has_search_latch);
-
-			if (UNIV_UNLIKELY(templ->type == DATA_BLOB)) {
-				if (prebuilt->blob_heap == NULL) {
-					prebuilt->blob_heap = mem_heap_create(
-						UNIV_PAGE_SIZE);
-				}
-
-				heap = prebuilt->blob_heap;
-			} else {
-				extern_field_heap
-					= mem_heap_create(UNIV_PAGE_SIZE);
-
-				heap = extern_field_heap;
-			}
-
-			/* NOTE: if we are retrieving a big BLOB, we may
-			already run out of memory in the next call, which
-			causes an assert */
-
-			data = btr_rec_copy_externally_stored_field(
-				rec, offsets,
-				dict_table_zip_size(prebuilt->table),
-				field_no, &len, heap);
-
-			if (UNIV_UNLIKELY(!data)) {
-				/* The externally stored field
-				was not written yet. This
-				record should only be seen by
-				recv_recovery_rollback_active()
-				or any TRX_ISO_READ_UNCOMMITTED
-				transactions. */
-
-				if (extern_field_heap) {
-					mem_heap_free(extern_field_heap);
-				}
-
-				return(FALSE);
-			}
-
-			ut_a(len != UNIV_SQL_NULL);
-		} else {
-			/* Field is stored in the row. */
-
-			data = rec_get_nth_field(rec, offsets, field_no, &len);
-
-			if (UNIV_UNLIKELY(templ->type == DATA_BLOB)
-			    && len != UNIV_SQL_NULL) {
-
-				/* It is a BLOB field locally stored in the
-				InnoDB record: we MUST copy its contents to
-				prebuilt->blob_heap here because later code
-				assumes all BLOB values have been copied to a
-				safe place. */
-
-				if (prebuilt->blob_heap == NULL) {
-					prebuilt->blob_heap = mem_heap_create(
-						UNIV_PAGE_SIZE);
-				}
-
-				data = memcpy(mem_heap_alloc(
-						prebuilt->blob_heap, len),
-						data, len);
-			}
-		}
-
-		if (len != UNIV_SQL_NULL) {
-			row_sel_field_store_in_mysql_format(
-				mysql_rec + templ->mysql_col_offset,
-				templ, data, len);
-
-			/* Cleanup */
-			if (extern_field_heap) {
-				mem_heap_free(extern_field_heap);
-				extern_field_heap = NULL;
-			}
-
-			if (templ->mysql_null_bit_mask) {
-				/* It is a nullable column with a non-NULL
-				value */
-				mysql_rec[templ->mysql_null_byte_offset]
-					&= ~(byte) templ->mysql_null_bit_mask;
-			}
-		} else {
-			/* MySQL assumes that the field for an SQL
-			NULL value is set to the default value. */
-
-			UNIV_MEM_ASSERT_RW(prebuilt->default_rec
-					   + templ->mysql_col_offset,
-					   templ->mysql_col_len);
-			mysql_rec[templ->mysql_null_byte_offset]
-				|= (byte) templ->mysql_null_bit_mask;
-			memcpy(mysql_rec + templ->mysql_col_offset,
-			       (const byte*) prebuilt->default_rec
-			       + templ->mysql_col_offset,
-			       templ->mysql_col_len);
+		const ulint		field_no
+			= rec_clust
+			? templ->clust_rec_field_no
+			: templ->rec_field_no;
+
+		if (!row_sel_store_mysql_field(mysql_rec, prebuilt,
+					       rec, offsets,
+					       field_no, templ)) {
+			return(FALSE);
 		}
 	}
 
@@ -3399,6 +3445,54 @@ row_sel_try_search_shortcut_for_mysql(
 	return(SEL_FOUND);
 }
 
+/*******************************************************************//**
+Checks the index condition pushed down by MySQL on a secondary index
+record, before the clustered index record is looked up. The columns of
+the index that are in the template are converted to MySQL format in
+mysql_rec for the condition to be evaluated on them.
+@return ICP_NO_MATCH, ICP_MATCH, or ICP_OUT_OF_RANGE */
+static
+enum icp_result
+row_search_idx_cond_check(
+/*======================*/
+	byte*			mysql_rec,	/*!< out: record in MySQL
+						format; only the index
+						columns are valid */
+	row_prebuilt_t*		prebuilt,	/*!< in/out: prebuilt struct
+						for the table handle */
+	const rec_t*		rec,		/*!< in: secondary index
+						record */
+	const ulint*		offsets)	/*!< in: rec_get_offsets() */
+{
+	ulint	i;
+
+	if (!prebuilt->idx_cond
+	    || prebuilt->template_type != ROW_MYSQL_REC_FIELDS) {
+
+		return(ICP_MATCH);
+	}
+
+	ut_ad(!dict_index_is_clust(prebuilt->index));
+	ut_ad(rec_offs_validate(rec, prebuilt->index, offsets));
+
+	for (i = 0; i < prebuilt->n_template; i++) {
+		const mysql_row_templ_t*templ = prebuilt->mysql_template + i;
+
+		if (templ->icp_rec_field_no == ULINT_UNDEFINED) {
+			continue;
+		}
+
+		if (!row_sel_store_mysql_field(mysql_rec, prebuilt,
+					       rec, offsets,
+					       templ->icp_rec_field_no,
+					       templ)) {
+			return(ICP_NO_MATCH);
+		}
+	}
+
+	return(innobase_index_cond(prebuilt->idx_cond));
+}
+
 /********************************************************************//**
 Searches for rows in the database. This is used in the interface to
 MySQL. This function opens a cursor, and also implements fetch next
@@ -3547,16 +3641,16 @@ row_search_for_mysql(
 	/* PHASE 0: Release a possible s-latch we are holding on the
 	adaptive hash index latch if there is someone waiting behind */
 
-	if (UNIV_UNLIKELY(rw_lock_get_writer(&btr_search_latch) != RW_LOCK_NOT_LOCKED)
-	    && trx->has_search_latch) {
+	if (trx->has_search_latch
+	    && UNIV_UNLIKELY(rw_lock_get_writer(trx->search_latch)
+			     != RW_LOCK_NOT_LOCKED)) {
 
 		/* There is an x-latch request on the adaptive hash index:
 		release the s-latch to reduce starvation and wait for
 		BTR_SEA_TIMEOUT rounds before trying to keep it again over
 		calls from MySQL */
 
-		rw_lock_s_unlock(&btr_search_latch);
-		trx->has_search_latch = FALSE;
+		trx_search_latch_release_if_reserved(trx);
 
 		trx->search_latch_timeout = BTR_SEA_TIMEOUT;
 	}
@@ -3709,9 +3803,20 @@ row_search_for_mysql(
 			hash index semaphore! */
 
 #ifndef UNIV_SEARCH_DEBUG
+			rw_lock_t*	ahi_latch
+				= btr_search_get_latch(index);
+
+			if (trx->has_search_latch
+			    && trx->search_latch != ahi_latch) {
+				/* We kept the latch of another hash
+				index partition over calls from MySQL */
+				trx_search_latch_release_if_reserved(trx);
+			}
+
 			if (!trx->has_search_latch) {
-				rw_lock_s_lock(&btr_search_latch);
+				rw_lock_s_lock(ahi_latch);
 				trx->has_search_latch = TRUE;
+				trx->search_latch = ahi_latch;
 			}
 #endif
 			switch (row_sel_try_search_shortcut_for_mysql(
@@ -3772,8 +3877,8 @@ release_search_latch_if_needed:
 
 					trx->search_latch_timeout--;
 
-					rw_lock_s_unlock(&btr_search_latch);
-					trx->has_search_latch = FALSE;
+					trx_search_latch_release_if_reserved(
+						trx);
 				}
 
 				/* NOTE that we do NOT store the cursor
@@ -3795,10 +3900,7 @@ release_search_latch_if_needed:
 	/*-------------------------------------------------------------*/
 	/* PHASE 3: Open or restore index cursor position */
 
-	if (trx->has_search_latch) {
-		rw_lock_s_unlock(&btr_search_latch);
-		trx->has_search_latch = FALSE;
-	}
+	trx_search_latch_release_if_reserved(trx);
 
 	ut_ad(prebuilt->sql_stat_start || trx->conc_state == TRX_ACTIVE);
 	ut_ad(trx->conc_state == TRX_NOT_STARTED
@@ -4393,7 +4495,22 @@ no_gap_lock:
 
 			if (!lock_sec_rec_cons_read_sees(
 				    rec, trx->read_view)) {
-				goto requires_clust_rec;
+				/* The secondary index record may be
+				stale, but the pushed index condition
+				can still exclude it, or end the scan,
+				before the clustered index lookup. */
+				switch (row_search_idx_cond_check(
+						buf, prebuilt, rec, offsets)) {
+				case ICP_NO_MATCH:
+					goto next_rec;
+				case ICP_OUT_OF_RANGE:
+					err = DB_RECORD_NOT_FOUND;
+					goto idx_cond_failed;
+				case ICP_MATCH:
+					goto requires_clust_rec;
+				}
+
+				ut_error;
 			}
 		}
 	}
@@ -4440,6 +4557,34 @@ no_gap_lock:
 		goto next_rec;
 	}
 
+	/* Check the index condition pushed down by MySQL, if any, before
+	the clustered index record is fetched. */
+
+	if (index != clust_index) {
+		switch (row_search_idx_cond_check(
+				buf, prebuilt, rec, offsets)) {
+		case ICP_NO_MATCH:
+			if ((srv_locks_unsafe_for_binlog
+			     || trx->isolation_level <= TRX_ISO_READ_COMMITTED)
+			    && prebuilt->select_lock_type != LOCK_NONE
+			    && !did_semi_consistent_read) {
+
+				/* No need to keep a lock on a record that
+				does not match the pushed index condition
+				if we do not want to use next-key
+				locking. */
+
+				row_unlock_for_mysql(prebuilt, TRUE);
+			}
+			goto next_rec;
+		case ICP_OUT_OF_RANGE:
+			err = DB_RECORD_NOT_FOUND;
+			goto idx_cond_failed;
+		case ICP_MATCH:
+			break;
+		}
+	}
+
 	/* Get the clustered index record if needed, if we did not do the
 	search using the clustered index. */
 
@@ -4773,6 +4918,13 @@ lock_table_wait:
 #endif /* UNIV_SEARCH_DEBUG */
 	goto func_exit;
 
+idx_cond_failed:
+	/* The pushed index condition found the end of the range being
+	read: store the cursor position as at the end of the index, so
+	that a fetch next will continue from this record. */
+
+	btr_pcur_store_position(pcur, &mtr);
+
 normal_return:
 	/*-------------------------------------------------------------*/
 	que_thr_stop_for_mysql_no_error(thr, trx);
@@ -4865,9 +5017,13 @@ row_search_check_if_query_cache_permitted(
 		if (trx->isolation_level >= TRX_ISO_REPEATABLE_READ
 		    && !trx->read_view) {
 
+			trx_sys_mutex_enter();
+
 			trx->read_view = read_view_open_now(
 				trx->id, trx->global_read_view_heap);
 			trx->global_read_view = trx->read_view;
+
+			trx_sys_mutex_exit();
 		}
 	}
 
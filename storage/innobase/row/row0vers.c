@@ -70,6 +70,7 @@ row_vers_impl_x_locked_off_kernel(
 	dtuple_t*	entry	= NULL; /* assignment to eliminate compiler
 					warning */
 	trx_t*		trx;
+	trx_t*		active_trx;
 	ulint		rec_del;
 #ifdef UNIV_DEBUG
 	ulint		err;
@@ -123,18 +124,25 @@ row_vers_impl_x_locked_off_kernel(
 	mutex_enter(&kernel_mutex);
 
 	trx = NULL;
+
+	trx_sys_mutex_enter();
+
 	if (!trx_is_active(trx_id)) {
 		/* The transaction that modified or inserted clust_rec is no
 		longer active: no implicit lock on rec */
+		trx_sys_mutex_exit();
 		goto exit_func;
 	}
 
 	if (!lock_check_trx_id_sanity(trx_id, clust_rec, clust_index,
 				      clust_offsets, TRUE)) {
 		/* Corruption noticed: try to avoid a crash by returning */
+		trx_sys_mutex_exit();
 		goto exit_func;
 	}
 
+	trx_sys_mutex_exit();
+
 	comp = page_rec_is_comp(rec);
 	ut_ad(index->table == clust_index->table);
 	ut_ad(!!comp == dict_table_is_comp(index->table));
@@ -182,22 +190,15 @@ row_vers_impl_x_locked_off_kernel(
 		if (prev_version == NULL) {
 			mutex_enter(&kernel_mutex);
 
-			if (!trx_is_active(trx_id)) {
-				/* Transaction no longer active: no
-				implicit x-lock */
-
-				break;
-			}
-
-			/* If the transaction is still active,
-			clust_rec must be a fresh insert, because no
-			previous version was found. */
-			ut_ad(err == DB_SUCCESS);
+			/* If the transaction is still active, clust_rec
+			must be a fresh insert, because no previous
+			version was found, and there is an implicit
+			x-lock on rec. Otherwise there is no implicit
+			x-lock. */
 
-			/* It was a freshly inserted version: there is an
-			implicit x-lock on rec */
+			trx = trx_get_active_on_id(trx_id);
 
-			trx = trx_get_on_id(trx_id);
+			ut_ad(!trx || err == DB_SUCCESS);
 
 			break;
 		}
@@ -223,7 +224,9 @@ row_vers_impl_x_locked_off_kernel(
 
 		mutex_enter(&kernel_mutex);
 
-		if (!trx_is_active(trx_id)) {
+		active_trx = trx_get_active_on_id(trx_id);
+
+		if (active_trx == NULL) {
 			/* Transaction no longer active: no implicit x-lock */
 
 			break;
@@ -247,7 +250,7 @@ row_vers_impl_x_locked_off_kernel(
 			prev_version */
 
 			if (rec_del != vers_del) {
-				trx = trx_get_on_id(trx_id);
+				trx = active_trx;
 
 				break;
 			}
@@ -261,7 +264,7 @@ row_vers_impl_x_locked_off_kernel(
 						dtuple_get_n_fields(entry));
 			if (0 != cmp_dtuple_rec(entry, rec, offsets)) {
 
-				trx = trx_get_on_id(trx_id);
+				trx = active_trx;
 
 				break;
 			}
@@ -269,7 +272,7 @@ row_vers_impl_x_locked_off_kernel(
 			/* The delete mark should be set in rec for it to be
 			in the state required by prev_version */
 
-			trx = trx_get_on_id(trx_id);
+			trx = active_trx;
 
 			break;
 		}
@@ -665,7 +668,7 @@ row_vers_build_for_semi_consistent_read(
 			rec_trx_id = version_trx_id;
 		}
 
-		mutex_enter(&kernel_mutex);
+		trx_sys_mutex_enter();
 		version_trx = trx_get_on_id(version_trx_id);
 		if (version_trx
 		    && (version_trx->conc_state == TRX_COMMITTED_IN_MEMORY
@@ -673,7 +676,7 @@ row_vers_build_for_semi_consistent_read(
 
 			version_trx = NULL;
 		}
-		mutex_exit(&kernel_mutex);
+		trx_sys_mutex_exit();
 
 		if (!version_trx) {
 
@@ -77,6 +77,7 @@ Created 10/8/1995 Heikki Tuuri
 #include "ibuf0ibuf.h"
 #include "buf0flu.h"
 #include "buf0lru.h"
+#include "buf0dump.h"
 #include "btr0sea.h"
 #include "dict0load.h"
 #include "dict0boot.h"
@@ -264,7 +265,9 @@ that during a time of heavy update/insert activity. */
 
 UNIV_INTERN ulong	srv_max_buf_pool_modified_pct	= 75;
 
-/* the number of purge threads to use from the worker pool (currently 0 or 1).*/
+/* the number of purge threads: 0 lets the master thread do the purge,
+1 or more starts a purge thread and srv_n_purge_threads - 1 purge worker
+threads */
 UNIV_INTERN ulong srv_n_purge_threads = 0;
 
 /* the number of pages to purge in one batch */
@@ -273,6 +276,10 @@ UNIV_INTERN ulong srv_purge_batch_size = 20;
 /* the number of rollback segments to use */
 UNIV_INTERN ulong srv_rollback_segments = TRX_SYS_N_RSEGS;
 
+/* the number of threads that merge the runs of a merge sort pass
+when creating indexes */
+UNIV_INTERN ulong srv_merge_sort_threads = 4;
+
 /* variable counts amount of data read in total (in bytes) */
 UNIV_INTERN ulint srv_data_read = 0;
 
@@ -362,6 +369,15 @@ UNIV_INTERN ulint	srv_conc_n_waiting_threads = 0;
 /* print all user-level transactions deadlocks to mysqld stderr */
 UNIV_INTERN my_bool	srv_print_all_deadlocks = FALSE;
 
+/* If this is FALSE, lock waits are not checked for deadlocks; a
+deadlock is then resolved by innodb_lock_wait_timeout */
+UNIV_INTERN my_bool	srv_deadlock_detect = TRUE;
+
+/* Deadlock search counters, protected by kernel_mutex */
+UNIV_INTERN ulint	srv_n_deadlocks = 0;
+UNIV_INTERN ulint	srv_n_deadlock_searches = 0;
+UNIV_INTERN ib_uint64_t	srv_deadlock_search_time = 0;
+
 typedef struct srv_conc_slot_struct	srv_conc_slot_t;
 struct srv_conc_slot_struct{
 	os_event_t			event;		/*!< event to wait */
@@ -402,6 +418,10 @@ UNIV_INTERN unsigned long long	srv_stats_sample_pages = 8;
 
 UNIV_INTERN ibool	srv_use_doublewrite_buf	= TRUE;
 UNIV_INTERN ibool	srv_use_checksums = TRUE;
+/* The checksum algorithm used when writing pages, a
+srv_checksum_algorithm_t. Pages written with any of the algorithms
+are accepted when reading. */
+UNIV_INTERN ulong	srv_checksum_algorithm = SRV_CHECKSUM_ALGORITHM_INNODB;
 
 UNIV_INTERN ulong	srv_replication_delay		= 0;
 
@@ -517,7 +537,6 @@ state of IO activity and the level of IO utilization is past
 intervals. Following macros define thresholds for these conditions. */
 #define SRV_PEND_IO_THRESHOLD	(PCT_IO(3))
 #define SRV_RECENT_IO_ACTIVITY	(PCT_IO(5))
-#define SRV_PAST_IO_ACTIVITY	(PCT_IO(200))
 
 /*
 	IMPLEMENTATION OF THE SERVER MAIN PROGRAM
@@ -689,7 +708,7 @@ Unix.*/
 
 /* Thread slot in the thread table */
 struct srv_slot_struct{
-	unsigned	type:1;		/*!< thread type: user, utility etc. */
+	unsigned	type:2;		/*!< thread type: user, utility etc. */
 	unsigned	in_use:1;	/*!< TRUE if this slot is in use */
 	unsigned	suspended:1;	/*!< TRUE if the thread is waiting
 					for the event of this slot */
@@ -710,6 +729,16 @@ UNIV_INTERN os_event_t	srv_monitor_event;
 
 UNIV_INTERN os_event_t	srv_error_event;
 
+UNIV_INTERN os_event_t	srv_buf_dump_event;
+
+/** The buffer pool dump/load file name */
+UNIV_INTERN char*	srv_buf_dump_filename;
+
+/** Boolean config knobs that tell InnoDB to dump the buffer pool at shutdown
+and/or load it during startup. */
+UNIV_INTERN my_bool	srv_buffer_pool_dump_at_shutdown = FALSE;
+UNIV_INTERN my_bool	srv_buffer_pool_load_at_startup = FALSE;
+
 UNIV_INTERN os_event_t	srv_lock_timeout_thread_event;
 
 UNIV_INTERN srv_sys_t*	srv_sys	= NULL;
@@ -837,6 +866,7 @@ srv_thread_type_validate(
 {
 	switch (type) {
 	case SRV_WORKER:
+	case SRV_PURGE_WORKER:
 	case SRV_MASTER:
 		return(TRUE);
 	}
@@ -1048,6 +1078,8 @@ srv_init(void)
 
 	srv_monitor_event = os_event_create(NULL);
 
+	srv_buf_dump_event = os_event_create(NULL);
+
 	srv_lock_timeout_thread_event = os_event_create(NULL);
 
 	for (i = 0; i < SRV_MASTER + 1; i++) {
@@ -1834,6 +1866,7 @@ srv_printf_innodb_monitor(
 	double	time_elapsed;
 	time_t	current_time;
 	ulint	n_reserved;
+	ulint	i;
 	ibool	ret;
 
 	mutex_enter(&srv_innodb_monitor_mutex);
@@ -1919,7 +1952,15 @@ srv_printf_innodb_monitor(
 	      "-------------------------------------\n", file);
 	ibuf_print(file);
 
-	ha_print_info(file, btr_search_sys->hash_index);
+	for (i = 0; i < btr_search_sys->n_parts; i++) {
+		const btr_search_part_t*	part
+			= &btr_search_sys->parts[i];
+
+		fprintf(file, "Partition %lu: %lu hash hits, %lu misses, ",
+			(ulong) i, (ulong) part->n_hash_succ,
+			(ulong) part->n_hash_fail);
+		ha_print_info(file, part->hash_index);
+	}
 
 	fprintf(file,
 		"%.2f hash searches/s, %.2f non-hash searches/s\n",
@@ -2067,6 +2108,12 @@ srv_export_innodb_status(void)
 #endif /* UNIV_DEBUG */
 	export_vars.innodb_buffer_pool_pages_total = buf_pool_get_n_pages();
 
+	buf_dump_status_get(
+		export_vars.innodb_buffer_pool_dump_status,
+		sizeof(export_vars.innodb_buffer_pool_dump_status),
+		export_vars.innodb_buffer_pool_load_status,
+		sizeof(export_vars.innodb_buffer_pool_load_status));
+
 	export_vars.innodb_buffer_pool_pages_misc
 	       	= buf_pool_get_n_pages() - LRU_len - free_len;
 #ifdef HAVE_ATOMIC_BUILTINS
@@ -2088,6 +2135,9 @@ srv_export_innodb_status(void)
 	export_vars.innodb_pages_read = stat.n_pages_read;
 	export_vars.innodb_pages_written = stat.n_pages_written;
 	export_vars.innodb_row_lock_waits = srv_n_lock_wait_count;
+	export_vars.innodb_deadlocks = srv_n_deadlocks;
+	export_vars.innodb_deadlock_searches = srv_n_deadlock_searches;
+	export_vars.innodb_deadlock_search_time = srv_deadlock_search_time;
 	export_vars.innodb_row_lock_current_waits
 		= srv_n_lock_wait_current_count;
 	export_vars.innodb_row_lock_time = srv_n_lock_wait_time / 1000;
@@ -2673,7 +2723,8 @@ srv_wake_master_thread(void)
 }
 
 /*******************************************************************//**
-Wakes up the purge thread if it's not already awake. */
+Wakes up the purge thread and the purge worker threads if they are not
+already awake. */
 UNIV_INTERN
 void
 srv_wake_purge_thread(void)
@@ -2687,6 +2738,11 @@ srv_wake_purge_thread(void)
 
 		srv_release_threads(SRV_WORKER, 1);
 
+		if (srv_n_purge_threads > 1) {
+			srv_release_threads(SRV_PURGE_WORKER,
+					    srv_n_purge_threads - 1);
+		}
+
 		mutex_exit(&kernel_mutex);
 	}
 }
@@ -2760,7 +2816,6 @@ srv_master_thread(
 	ulint		n_tables_to_drop;
 	ulint		n_ios;
 	ulint		n_ios_old;
-	ulint		n_ios_very_old;
 	ulint		n_pend_ios;
 	ulint		next_itr_time;
 	ulint		i;
@@ -2794,9 +2849,6 @@ loop:
 
 	srv_main_thread_op_info = "reserving kernel mutex";
 
-	buf_get_total_stat(&buf_stat);
-	n_ios_very_old = log_sys->n_log_ios + buf_stat.n_pages_read
-		+ buf_stat.n_pages_written;
 	mutex_enter(&kernel_mutex);
 
 	/* Store the user activity counter at the start of this loop */
@@ -2902,34 +2954,8 @@ loop:
 			srv_sync_log_buffer_in_background();
 		}
 
-		if (UNIV_UNLIKELY(buf_get_modified_ratio_pct()
-				  > srv_max_buf_pool_modified_pct)) {
-
-			/* Try to keep the number of modified pages in the
-			buffer pool under the limit wished by the user */
-
-			srv_main_thread_op_info =
-				"flushing buffer pool pages";
-			n_pages_flushed = buf_flush_list(
-				PCT_IO(100), IB_ULONGLONG_MAX);
-
-		} else if (srv_adaptive_flushing) {
-
-			/* Try to keep the rate of flushing of dirty
-			pages such that redo log generation does not
-			produce bursts of IO at checkpoint time. */
-			ulint n_flush = buf_flush_get_desired_flush_rate();
-
-			if (n_flush) {
-				srv_main_thread_op_info =
-					"flushing buffer pool pages";
-				n_flush = ut_min(PCT_IO(100), n_flush);
-				n_pages_flushed =
-					buf_flush_list(
-						n_flush,
-						IB_ULONGLONG_MAX);
-			}
-		}
+		/* Dirty pages are flushed by the page cleaner thread,
+		see buf_flush_page_cleaner_thread() */
 
 		if (srv_activity_count == old_activity_count) {
 
@@ -2948,30 +2974,7 @@ loop:
 	seconds */
 	mem_validate_all_blocks();
 #endif
-	/* If i/os during the 10 second period were less than 200% of
-	capacity, we assume that there is free disk i/o capacity
-	available, and it makes sense to flush srv_io_capacity pages.
-
-	Note that this is done regardless of the fraction of dirty
-	pages relative to the max requested by the user. The one second
-	loop above requests writes for that case. The writes done here
-	are not required, and may be disabled. */
-
-	buf_get_total_stat(&buf_stat);
-	n_pend_ios = buf_get_n_pending_ios() + log_sys->n_pending_writes;
-	n_ios = log_sys->n_log_ios + buf_stat.n_pages_read
-		+ buf_stat.n_pages_written;
-
 	srv_main_10_second_loops++;
-	if (n_pend_ios < SRV_PEND_IO_THRESHOLD
-	    && (n_ios - n_ios_very_old < SRV_PAST_IO_ACTIVITY)) {
-
-		srv_main_thread_op_info = "flushing buffer pool pages";
-		buf_flush_list(PCT_IO(100), IB_ULONGLONG_MAX);
-
-		/* Flush logs if needed */
-		srv_sync_log_buffer_in_background();
-	}
 
 	/* We run a batch of insert buffer merge every 10 seconds,
 	even if the server were active */
@@ -2993,27 +2996,6 @@ loop:
 		}
 	}
 
-	srv_main_thread_op_info = "flushing buffer pool pages";
-
-	/* Flush a few oldest pages to make a new checkpoint younger */
-
-	if (buf_get_modified_ratio_pct() > 70) {
-
-		/* If there are lots of modified pages in the buffer pool
-		(> 70 %), we assume we can afford reserving the disk(s) for
-		the time it requires to flush 100 pages */
-
-		n_pages_flushed = buf_flush_list(
-			PCT_IO(100), IB_ULONGLONG_MAX);
-	} else {
-		/* Otherwise, we only flush a small number of pages so that
-		we do not unnecessarily use much disk i/o capacity from
-		other work */
-
-		n_pages_flushed = buf_flush_list(
-			  PCT_IO(10), IB_ULONGLONG_MAX);
-	}
-
 	srv_main_thread_op_info = "making checkpoint";
 
 	/* Make a new checkpoint about once in 10 seconds */
@@ -3244,7 +3226,7 @@ srv_purge_thread(
 	ulint		retries = 0;
 	ulint		n_total_purged = ULINT_UNDEFINED;
 
-	ut_a(srv_n_purge_threads == 1);
+	ut_a(srv_n_purge_threads >= 1);
 
 #ifdef UNIV_PFS_THREAD
 	pfs_register_thread(srv_purge_thread_key);
@@ -3335,6 +3317,84 @@ srv_purge_thread(
 	OS_THREAD_DUMMY_RETURN;	/* Not reached, avoid compiler warning */
 }
 
+/*********************************************************************//**
+Purge worker thread: purges the undo log records handed to it by the
+purge thread in trx_purge().
+@return	a dummy parameter */
+UNIV_INTERN
+os_thread_ret_t
+srv_purge_worker_thread(
+/*====================*/
+	void*	arg)	/*!< in: purge thread number, > 0 */
+{
+	srv_slot_t*	slot;
+	ulint		id = (ulint) arg;
+
+	ut_a(id > 0);
+	ut_a(id < srv_n_purge_threads);
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(srv_purge_worker_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+#ifdef UNIV_DEBUG_THREAD_CREATION
+	fprintf(stderr, "InnoDB: Purge worker thread %lu running, id %lu\n",
+		(ulong) id, os_thread_pf(os_thread_get_curr_id()));
+#endif /* UNIV_DEBUG_THREAD_CREATION */
+
+	mutex_enter(&kernel_mutex);
+
+	slot = srv_table_reserve_slot(SRV_PURGE_WORKER);
+
+	++srv_n_threads_active[SRV_PURGE_WORKER];
+
+	/* The purge thread does not start a batch once the shutdown has
+	begun, and it waits for the batch it is running to be purged, so
+	the records handed to this thread are always purged before the
+	thread exits. */
+
+	for (;;) {
+		if (trx_purge_worker_has_work(id)) {
+
+			mutex_exit(&kernel_mutex);
+
+			trx_purge_worker_run(id);
+
+			mutex_enter(&kernel_mutex);
+
+		} else if (srv_shutdown_state == SRV_SHUTDOWN_EXIT_THREADS) {
+
+			break;
+		} else {
+			srv_suspend_thread(slot);
+
+			mutex_exit(&kernel_mutex);
+
+			os_event_wait(slot->event);
+
+			mutex_enter(&kernel_mutex);
+		}
+	}
+
+	/* Decrement the active count. */
+	srv_suspend_thread(slot);
+
+	slot->in_use = FALSE;
+
+	mutex_exit(&kernel_mutex);
+
+#ifdef UNIV_DEBUG_THREAD_CREATION
+	fprintf(stderr, "InnoDB: Purge worker thread %lu exiting, id %lu\n",
+		(ulong) id, os_thread_pf(os_thread_get_curr_id()));
+#endif /* UNIV_DEBUG_THREAD_CREATION */
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;	/* Not reached, avoid compiler warning */
+}
+
 /**********************************************************************//**
 Enqueues a task to server task queue and releases a worker thread, if there
 is a suspended one. */
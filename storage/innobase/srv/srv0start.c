@@ -66,6 +66,7 @@ Created 2/16/1996 Heikki Tuuri
 # include "os0proc.h"
 # include "sync0sync.h"
 # include "buf0flu.h"
+# include "buf0dump.h"
 # include "buf0rea.h"
 # include "dict0boot.h"
 # include "dict0load.h"
@@ -87,6 +88,7 @@ Created 2/16/1996 Heikki Tuuri
 # include "btr0pcur.h"
 # include "os0sync.h" /* for INNODB_RW_LOCKS_USE_ATOMICS */
 # include "zlib.h" /* for ZLIB_VERSION */
+# include "ut0crc32.h"
 
 /** Log sequence number immediately after startup */
 UNIV_INTERN ib_uint64_t	srv_start_lsn;
@@ -144,6 +146,8 @@ UNIV_INTERN mysql_pfs_key_t	srv_error_monitor_thread_key;
 UNIV_INTERN mysql_pfs_key_t	srv_monitor_thread_key;
 UNIV_INTERN mysql_pfs_key_t	srv_master_thread_key;
 UNIV_INTERN mysql_pfs_key_t	srv_purge_thread_key;
+UNIV_INTERN mysql_pfs_key_t	srv_purge_worker_thread_key;
+UNIV_INTERN mysql_pfs_key_t	buf_page_cleaner_thread_key;
 #endif /* UNIV_PFS_THREAD */
 
 /*********************************************************************//**
@@ -497,12 +501,6 @@ io_handler_thread(
 }
 #endif /* !UNIV_HOTBACKUP */
 
-#ifdef __WIN__
-#define SRV_PATH_SEPARATOR	'\\'
-#else
-#define SRV_PATH_SEPARATOR	'/'
-#endif
-
 /*********************************************************************//**
 Normalizes a directory path for Windows: converts slashes to backslashes. */
 UNIV_INTERN
@@ -1164,6 +1162,14 @@ innobase_start_or_create_for_mysql(void)
 	fputs(" InnoDB: and extra copying\n", stderr);
 #endif /* UNIV_ZIP_COPY */
 
+	ut_crc32_init();
+
+	ut_print_timestamp(stderr);
+	fprintf(stderr,
+		" InnoDB: Using %s to compute crc32 checksums\n",
+		ut_crc32_sse42_enabled
+		? "CPU crc32 instructions" : "slice-by-8 tables");
+
 	/* Since InnoDB does not currently clean up all its internal data
 	structures in MySQL Embedded Server Library server_end(), we
 	print an error message if someone tries to start up InnoDB a
@@ -1847,6 +1853,10 @@ innobase_start_or_create_for_mysql(void)
 
 	trx_sys_create_rsegs(TRX_SYS_N_RSEGS - 1);
 
+	/* Create the page cleaner thread which flushes dirty pages in
+	the background. Recovery has been completed by now. */
+	os_thread_create(&buf_flush_page_cleaner_thread, NULL, NULL);
+
 	/* Create the thread which watches the timeouts for lock waits */
 	os_thread_create(&srv_lock_timeout_thread, NULL,
 			 thread_ids + 2 + SRV_MAX_N_IO_THREADS);
@@ -1873,21 +1883,28 @@ innobase_start_or_create_for_mysql(void)
 	os_thread_create(&srv_master_thread, NULL, thread_ids
 			 + (1 + SRV_MAX_N_IO_THREADS));
 
-	/* Currently we allow only a single purge thread. */
-	ut_a(srv_n_purge_threads == 0 || srv_n_purge_threads == 1);
+	ut_a(srv_n_purge_threads <= UNIV_MAX_PARALLELISM);
 
-	/* If the user has requested a separate purge thread then
-	start the purge thread. */
-	if (srv_n_purge_threads == 1) {
+	/* If the user has requested separate purge threads then start
+	the purge thread and the purge worker threads that it hands its
+	batches over to. */
+	if (srv_n_purge_threads > 0) {
 		os_thread_create(&srv_purge_thread, NULL, NULL);
 	}
 
+	for (i = 1; i < srv_n_purge_threads; i++) {
+		os_thread_create(&srv_purge_worker_thread, (void*) i, NULL);
+	}
+
 	/* Wait for the purge and master thread to startup. */
 
 	while (srv_shutdown_state == SRV_SHUTDOWN_NONE) {
 		if (srv_thread_has_reserved_slot(SRV_MASTER) == ULINT_UNDEFINED
-		    || (srv_n_purge_threads == 1
+		    || (srv_n_purge_threads > 0
 			&& srv_thread_has_reserved_slot(SRV_WORKER)
+			== ULINT_UNDEFINED)
+		    || (srv_n_purge_threads > 1
+			&& srv_thread_has_reserved_slot(SRV_PURGE_WORKER)
 			== ULINT_UNDEFINED)) {
 
 			ut_print_timestamp(stderr);
@@ -1900,6 +1917,11 @@ innobase_start_or_create_for_mysql(void)
 		}
 	}
 
+	/* Create the buffer pool dump/load thread; it loads the buffer
+	pool from the dump file in the background if the user asked for
+	it at startup. */
+	os_thread_create(&buf_dump_thread, NULL, NULL);
+
 #ifdef UNIV_DEBUG
 	/* buf_debug_prints = TRUE; */
 #endif /* UNIV_DEBUG */
@@ -1277,6 +1277,7 @@ fetch_data_into_cache(
 	i_s_locks_row_t*	requested_lock_row;
 
 	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_sys_mutex_own());
 
 	trx_i_s_cache_clear(cache);
 
@@ -1336,9 +1337,11 @@ trx_i_s_possibly_fetch_data_into_cache(
 
 	/* We need to read trx_sys and record/table lock queues */
 	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 
 	fetch_data_into_cache(cache);
 
+	trx_sys_mutex_exit();
 	mutex_exit(&kernel_mutex);
 
 	return(0);
@@ -190,32 +190,39 @@ trx_purge_arr_get_biggest(
 }
 
 /****************************************************************//**
-Builds a purge 'query' graph. The actual purge is performed by executing
-this query graph.
-@return	own: the query graph */
+Builds the purge 'query' graph of a purge thread. The actual purge is
+performed by executing this query graph. */
 static
-que_t*
-trx_purge_graph_build(void)
-/*=======================*/
+void
+trx_purge_graph_build(
+/*==================*/
+	trx_purge_thr_t*	pthr)	/*!< in/out: purge thread */
 {
 	mem_heap_t*	heap;
 	que_fork_t*	fork;
 	que_thr_t*	thr;
-	/*	que_thr_t*	thr2; */
+	trx_t*		trx;
+
+	ut_ad(mutex_own(&kernel_mutex));
+
+	pthr->sess = sess_open();
+
+	trx = pthr->sess->trx;
+
+	trx->is_purge = 1;
+
+	ut_a(trx_start_low(trx, ULINT_UNDEFINED));
 
 	heap = mem_heap_create(512);
 	fork = que_fork_create(NULL, NULL, QUE_FORK_PURGE, heap);
-	fork->trx = purge_sys->trx;
+	fork->trx = trx;
 
 	thr = que_thr_create(fork, heap);
 
-	thr->child = row_purge_node_create(thr, heap);
-
-	/*	thr2 = que_thr_create(fork, fork, heap);
+	pthr->node = row_purge_node_create(thr, heap);
+	thr->child = pthr->node;
 
-	thr2->child = row_purge_node_create(fork, thr2, heap);	 */
-
-	return(fork);
+	pthr->query = fork;
 }
 
 /********************************************************************//**
@@ -227,6 +234,8 @@ trx_purge_sys_create(
 /*=================*/
 	ib_bh_t*	ib_bh)	/*!< in, own: UNDO log min binary heap */
 {
+	ulint	i;
+
 	ut_ad(mutex_own(&kernel_mutex));
 
 	purge_sys = mem_zalloc(sizeof(trx_purge_t));
@@ -253,18 +262,34 @@ trx_purge_sys_create(
 
 	purge_sys->arr = trx_undo_arr_create();
 
-	purge_sys->sess = sess_open();
+	/* Without a purge thread, the master thread runs the purge
+	batches by itself. */
+	purge_sys->n_thrs = ut_max(srv_n_purge_threads, 1);
+	ut_a(purge_sys->n_thrs <= UNIV_MAX_PARALLELISM);
+
+	purge_sys->thrs = mem_zalloc(
+		purge_sys->n_thrs * sizeof(*purge_sys->thrs));
+
+	for (i = 0; i < purge_sys->n_thrs; i++) {
+		trx_purge_graph_build(&purge_sys->thrs[i]);
+	}
+
+	purge_sys->sess = purge_sys->thrs[0].sess;
 
 	purge_sys->trx = purge_sys->sess->trx;
 
-	purge_sys->trx->is_purge = 1;
+	purge_sys->query = purge_sys->thrs[0].query;
 
-	ut_a(trx_start_low(purge_sys->trx, ULINT_UNDEFINED));
+	purge_sys->batch_done = os_event_create(NULL);
 
-	purge_sys->query = trx_purge_graph_build();
+	purge_sys->batch_heap = mem_heap_create(UNIV_PAGE_SIZE);
+
+	trx_sys_mutex_enter();
 
 	purge_sys->view = read_view_oldest_copy_or_open_new(0,
 							    purge_sys->heap);
+
+	trx_sys_mutex_exit();
 }
 
 /************************************************************************
@@ -274,24 +299,37 @@ void
 trx_purge_sys_close(void)
 /*======================*/
 {
+	ulint	i;
+
 	ut_ad(!mutex_own(&kernel_mutex));
 
-	que_graph_free(purge_sys->query);
+	for (i = 0; i < purge_sys->n_thrs; i++) {
+		trx_purge_thr_t*	pthr = &purge_sys->thrs[i];
+
+		que_graph_free(pthr->query);
+
+		ut_a(pthr->sess->trx->is_purge);
+		pthr->sess->trx->conc_state = TRX_NOT_STARTED;
+		sess_close(pthr->sess);
+	}
 
-	ut_a(purge_sys->sess->trx->is_purge);
-	purge_sys->sess->trx->conc_state = TRX_NOT_STARTED;
-	sess_close(purge_sys->sess);
+	mem_free(purge_sys->thrs);
+	purge_sys->thrs = NULL;
 	purge_sys->sess = NULL;
+	purge_sys->query = NULL;
+
+	os_event_free(purge_sys->batch_done);
+	mem_heap_free(purge_sys->batch_heap);
 
 	if (purge_sys->view != NULL) {
-		/* Because acquiring the kernel mutex is a pre-condition
+		/* Because acquiring the read view mutex is a pre-condition
 		of read_view_close(). We don't really need it here. */
-		mutex_enter(&kernel_mutex);
+		read_view_mutex_enter();
 
 		read_view_close(purge_sys->view);
 		purge_sys->view = NULL;
 
-		mutex_exit(&kernel_mutex);
+		read_view_mutex_exit();
 	}
 
 	trx_undo_arr_free(purge_sys->arr);
@@ -1044,7 +1082,7 @@ Fetches the next undo log record from the history list to purge. It must be
 released with the corresponding release function.
 @return copy of an undo log record or pointer to trx_purge_dummy_rec,
 if the whole undo log can skipped in purge; NULL if none left */
-UNIV_INTERN
+static
 trx_undo_rec_t*
 trx_purge_fetch_next_rec(
 /*=====================*/
@@ -1057,7 +1095,6 @@ trx_purge_fetch_next_rec(
 
 
 	if (purge_sys->state == TRX_STOP_PURGE) {
-		trx_purge_truncate_if_arr_empty();
 
 		return(NULL);
 	} else if (!purge_sys->next_stored) {
@@ -1066,8 +1103,6 @@ trx_purge_fetch_next_rec(
 		if (!purge_sys->next_stored) {
 			purge_sys->state = TRX_STOP_PURGE;
 
-			trx_purge_truncate_if_arr_empty();
-
 			if (srv_print_thread_releases) {
 				fprintf(stderr,
 					"Purge: No logs left in the"
@@ -1083,14 +1118,10 @@ trx_purge_fetch_next_rec(
 
 		purge_sys->state = TRX_STOP_PURGE;
 
-		trx_purge_truncate_if_arr_empty();
-
 		return(NULL);
 	} else if (purge_sys->purge_trx_no >= purge_sys->view->low_limit_no) {
 		purge_sys->state = TRX_STOP_PURGE;
 
-		trx_purge_truncate_if_arr_empty();
-
 		return(NULL);
 	}
 
@@ -1119,7 +1150,7 @@ trx_purge_fetch_next_rec(
 
 /*******************************************************************//**
 Releases a reserved purge undo record. */
-UNIV_INTERN
+UNIV_INLINE
 void
 trx_purge_rec_release(
 /*==================*/
@@ -1129,7 +1160,156 @@ trx_purge_rec_release(
 }
 
 /*******************************************************************//**
-This function runs a purge batch.
+Fetches the undo log records of a purge batch and hands them over to the
+purge threads. All the records of a table go to the same thread, so that
+the undo log records of a row are purged in the order they were written.
+@return	the reservation in the purge array covering the whole batch, or
+NULL if the batch is empty */
+static
+trx_undo_inf_t*
+trx_purge_attach_undo_recs(void)
+/*============================*/
+{
+	trx_undo_inf_t*	batch_cell	= NULL;
+	ulint		i;
+
+	mem_heap_empty(purge_sys->batch_heap);
+
+	for (i = 0; i < purge_sys->n_thrs; i++) {
+		purge_sys->thrs[i].node->recs = NULL;
+		purge_sys->thrs[i].last_rec = NULL;
+	}
+
+	for (;;) {
+		trx_undo_rec_t*	undo_rec;
+		roll_ptr_t	roll_ptr;
+		trx_undo_inf_t*	cell;
+		trx_purge_rec_t* rec;
+		trx_purge_thr_t* pthr;
+		ulint		type;
+		ulint		cmpl_info;
+		ibool		updated_extern;
+		undo_no_t	undo_no;
+		table_id_t	table_id;
+
+		undo_rec = trx_purge_fetch_next_rec(
+			&roll_ptr, &cell, purge_sys->batch_heap);
+
+		if (undo_rec == NULL) {
+
+			break;
+		}
+
+		/* The first record of the batch is the oldest one: its
+		reservation keeps the history list from being truncated
+		until all the purge threads are done with the batch. */
+
+		if (batch_cell == NULL) {
+			batch_cell = cell;
+		} else {
+			trx_purge_rec_release(cell);
+		}
+
+		if (undo_rec == &trx_purge_dummy_rec) {
+
+			continue;
+		}
+
+		trx_undo_rec_get_pars(undo_rec, &type, &cmpl_info,
+				      &updated_extern, &undo_no, &table_id);
+
+		pthr = &purge_sys->thrs[table_id % purge_sys->n_thrs];
+
+		rec = mem_heap_alloc(purge_sys->batch_heap, sizeof(*rec));
+		rec->undo_rec = undo_rec;
+		rec->roll_ptr = roll_ptr;
+		rec->next = NULL;
+
+		if (pthr->last_rec != NULL) {
+			pthr->last_rec->next = rec;
+		} else {
+			pthr->node->recs = rec;
+		}
+
+		pthr->last_rec = rec;
+	}
+
+	return(batch_cell);
+}
+
+/*******************************************************************//**
+Runs the purge query graph of a purge thread until the thread has purged
+the records handed to it. */
+static
+void
+trx_purge_run_thr(
+/*==============*/
+	trx_purge_thr_t*	pthr)	/*!< in: purge thread */
+{
+	que_thr_t*	thr;
+
+	mutex_enter(&kernel_mutex);
+
+	thr = que_fork_start_command(pthr->query);
+
+	ut_ad(thr);
+
+	mutex_exit(&kernel_mutex);
+
+	que_run_threads(thr);
+}
+
+/*******************************************************************//**
+Checks if a purge worker thread has been handed undo log records to purge.
+NOTE! The kernel mutex has to be reserved by the caller!
+@return	TRUE if the thread has records to purge */
+UNIV_INTERN
+ibool
+trx_purge_worker_has_work(
+/*======================*/
+	ulint	id)		/*!< in: purge thread number, > 0 */
+{
+	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(id > 0);
+	ut_a(id < purge_sys->n_thrs);
+
+	return(purge_sys->thrs[id].pending);
+}
+
+/*******************************************************************//**
+Purges the undo log records handed to a purge worker thread in the current
+batch, and tells the thread running trx_purge() when all the purge worker
+threads are done. */
+UNIV_INTERN
+void
+trx_purge_worker_run(
+/*=================*/
+	ulint	id)		/*!< in: purge thread number, > 0 */
+{
+	trx_purge_thr_t*	pthr = &purge_sys->thrs[id];
+
+	ut_ad(!mutex_own(&kernel_mutex));
+	ut_ad(pthr->pending);
+
+	trx_purge_run_thr(pthr);
+
+	mutex_enter(&kernel_mutex);
+
+	pthr->pending = FALSE;
+
+	ut_ad(purge_sys->n_pending > 0);
+
+	if (--purge_sys->n_pending == 0) {
+		os_event_set(purge_sys->batch_done);
+	}
+
+	mutex_exit(&kernel_mutex);
+}
+
+/*******************************************************************//**
+This function runs a purge batch. The undo log records of the batch are
+split by table between the purge threads, the calling thread purges its
+own share and waits for the purge worker threads to purge theirs.
 @return	number of undo log pages handled in the batch */
 UNIV_INTERN
 ulint
@@ -1138,14 +1318,18 @@ trx_purge(
 	ulint	limit)		/*!< in: the maximum number of records to
 				purge in one batch */
 {
-	que_thr_t*	thr;
+	trx_undo_inf_t*	batch_cell;
 	ulint		old_pages_handled;
+	ulint		n_pending;
+	ulint		i;
 
 	ut_a(purge_sys->trx->n_active_thrs == 0);
 
 	rw_lock_x_lock(&purge_sys->latch);
 
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
+
+	read_view_mutex_enter();
 
 	/* Close and free the old purge view */
 
@@ -1177,10 +1361,12 @@ trx_purge(
 		}
 	}
 
+	read_view_mutex_exit();
+
 	purge_sys->view = read_view_oldest_copy_or_open_new(
 		0, purge_sys->heap);
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 
 	rw_lock_x_unlock(&(purge_sys->latch));
 
@@ -1196,21 +1382,47 @@ trx_purge(
 
 	old_pages_handled = purge_sys->n_pages_handled;
 
+	batch_cell = trx_purge_attach_undo_recs();
+
+	if (srv_print_thread_releases) {
+
+		fputs("Starting purge\n", stderr);
+	}
+
+	/* Wake up the purge worker threads that have records to purge */
 
 	mutex_enter(&kernel_mutex);
 
-	thr = que_fork_start_command(purge_sys->query);
+	ut_ad(purge_sys->n_pending == 0);
 
-	ut_ad(thr);
+	for (i = 1; i < purge_sys->n_thrs; i++) {
+		if (purge_sys->thrs[i].node->recs != NULL) {
+			purge_sys->thrs[i].pending = TRUE;
+			purge_sys->n_pending++;
+		}
+	}
+
+	n_pending = purge_sys->n_pending;
+
+	if (n_pending > 0) {
+		os_event_reset(purge_sys->batch_done);
+
+		srv_release_threads(SRV_PURGE_WORKER, purge_sys->n_thrs - 1);
+	}
 
 	mutex_exit(&kernel_mutex);
 
-	if (srv_print_thread_releases) {
+	trx_purge_run_thr(&purge_sys->thrs[0]);
 
-		fputs("Starting purge\n", stderr);
+	if (n_pending > 0) {
+		os_event_wait(purge_sys->batch_done);
 	}
 
-	que_run_threads(thr);
+	if (batch_cell != NULL) {
+		trx_purge_rec_release(batch_cell);
+	}
+
+	trx_purge_truncate_if_arr_empty();
 
 	if (srv_print_thread_releases) {
 
@@ -553,6 +553,7 @@ trx_rollback_or_clean_recovered(
 
 loop:
 	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 
 	for (trx = UT_LIST_GET_FIRST(trx_sys->trx_list); trx;
 	     trx = UT_LIST_GET_NEXT(trx_list, trx)) {
@@ -566,6 +567,7 @@ loop:
 			continue;
 
 		case TRX_COMMITTED_IN_MEMORY:
+			trx_sys_mutex_exit();
 			mutex_exit(&kernel_mutex);
 			fprintf(stderr,
 				"InnoDB: Cleaning up trx with id "
@@ -577,6 +579,7 @@ loop:
 		case TRX_ACTIVE:
 			if (all || trx_get_dict_operation(trx)
 			    != TRX_DICT_OP_NONE) {
+				trx_sys_mutex_exit();
 				mutex_exit(&kernel_mutex);
 				trx_rollback_active(trx);
 				goto loop;
@@ -584,6 +587,8 @@ loop:
 		}
 	}
 
+	trx_sys_mutex_exit();
+
 	if (all) {
 		ut_print_timestamp(stderr);
 		fprintf(stderr,
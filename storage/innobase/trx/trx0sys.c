@@ -132,6 +132,8 @@ static const ulint	FILE_FORMAT_NAME_N
 /* Key to register the mutex with performance schema */
 UNIV_INTERN mysql_pfs_key_t	trx_doublewrite_mutex_key;
 UNIV_INTERN mysql_pfs_key_t	file_format_max_mutex_key;
+UNIV_INTERN mysql_pfs_key_t	trx_sys_mutex_key;
+UNIV_INTERN mysql_pfs_key_t	read_view_mutex_key;
 #endif /* UNIV_PFS_MUTEX */
 
 #ifndef UNIV_HOTBACKUP
@@ -640,21 +642,20 @@ trx_in_trx_list(
 {
 	trx_t*	trx;
 
-	ut_ad(mutex_own(&(kernel_mutex)));
-
-	trx = UT_LIST_GET_FIRST(trx_sys->trx_list);
+	ut_ad(!trx_sys_mutex_own());
 
-	while (trx != NULL) {
+	trx_sys_mutex_enter();
 
-		if (trx == in_trx) {
+	trx = UT_LIST_GET_FIRST(trx_sys->trx_list);
 
-			return(TRUE);
-		}
+	while (trx != NULL && trx != in_trx) {
 
 		trx = UT_LIST_GET_NEXT(trx_list, trx);
 	}
 
-	return(FALSE);
+	trx_sys_mutex_exit();
+
+	return(trx != NULL);
 }
 
 /*****************************************************************//**
@@ -667,7 +668,7 @@ trx_sys_flush_max_trx_id(void)
 	trx_sysf_t*	sys_header;
 	mtr_t		mtr;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_sys_mutex_own());
 
 	mtr_start(&mtr);
 
@@ -1005,6 +1006,10 @@ trx_sys_init_at_db_start(void)
 
 	trx_sys = mem_zalloc(sizeof(*trx_sys));
 
+	mutex_create(trx_sys_mutex_key, &trx_sys->mutex, SYNC_TRX_SYS);
+	mutex_create(read_view_mutex_key, &trx_sys->read_view_mutex,
+		     SYNC_READ_VIEW);
+
 	sys_header = trx_sysf_get(&mtr);
 
 	trx_rseg_list_and_array_init(sys_header, ib_bh, &mtr);
@@ -1694,6 +1699,9 @@ trx_sys_close(void)
 	ut_a(UT_LIST_GET_LEN(trx_sys->view_list) == 0);
 	ut_a(UT_LIST_GET_LEN(trx_sys->mysql_trx_list) == 0);
 
+	mutex_free(&trx_sys->read_view_mutex);
+	mutex_free(&trx_sys->mutex);
+
 	mem_free(trx_sys);
 
 	trx_sys = NULL;
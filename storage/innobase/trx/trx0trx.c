@@ -110,7 +110,6 @@ trx_create(
 	trx->conc_state = TRX_NOT_STARTED;
 
 	trx->is_registered = 0;
-	trx->owns_prepare_mutex = 0;
 
 	trx->start_time = ut_time();
 
@@ -166,6 +165,7 @@ trx_create(
 
 	trx->wait_lock = NULL;
 	trx->was_chosen_as_deadlock_victim = FALSE;
+	trx->deadlock_mark = 0;
 	UT_LIST_INIT(trx->wait_thrs);
 
 	trx->lock_heap = mem_heap_create_in_buffer(256);
@@ -175,6 +175,7 @@ trx_create(
 
 	trx->dict_operation_lock_mode = 0;
 	trx->has_search_latch = FALSE;
+	trx->search_latch = NULL;
 	trx->search_latch_timeout = BTR_SEA_TIMEOUT;
 
 	trx->declared_to_be_inside_innodb = FALSE;
@@ -248,9 +249,10 @@ trx_search_latch_release_if_reserved(
 	trx_t*	   trx) /*!< in: transaction */
 {
 	if (trx->has_search_latch) {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(trx->search_latch);
 
 		trx->has_search_latch = FALSE;
+		trx->search_latch = NULL;
 	}
 }
 
@@ -389,8 +391,12 @@ trx_free_prepared(
 	ut_a(ib_vector_is_empty(trx->autoinc_locks));
 	ib_vector_free(trx->autoinc_locks);
 
+	trx_sys_mutex_enter();
+
 	UT_LIST_REMOVE(trx_list, trx_sys->trx_list, trx);
 
+	trx_sys_mutex_exit();
+
 	mem_free(trx);
 }
 
@@ -445,6 +451,8 @@ trx_list_insert_ordered(
 
 	ut_ad(mutex_own(&kernel_mutex));
 
+	trx_sys_mutex_enter();
+
 	trx2 = UT_LIST_GET_FIRST(trx_sys->trx_list);
 
 	while (trx2 != NULL) {
@@ -468,6 +476,8 @@ trx_list_insert_ordered(
 	} else {
 		UT_LIST_ADD_LAST(trx_list, trx_sys->trx_list, trx);
 	}
+
+	trx_sys_mutex_exit();
 }
 
 /****************************************************************//**
@@ -575,7 +585,9 @@ trx_lists_init_at_db_start(void)
 		undo = UT_LIST_GET_FIRST(rseg->update_undo_list);
 
 		while (undo != NULL) {
+			trx_sys_mutex_enter();
 			trx = trx_get_on_id(undo->trx_id);
+			trx_sys_mutex_exit();
 
 			if (NULL == trx) {
 				trx = trx_create(trx_dummy_sess);
@@ -668,7 +680,7 @@ trx_assign_rseg(
 {
 	trx_rseg_t*	rseg = trx_sys->latest_rseg;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_sys_mutex_own());
 
 	rseg = UT_LIST_GET_NEXT(rseg_list, rseg);
 
@@ -695,7 +707,7 @@ trx_start_low(
 {
 	trx_rseg_t*	rseg;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(!trx_sys_mutex_own());
 	ut_ad(trx->rseg == NULL);
 
 	if (trx->is_purge) {
@@ -710,6 +722,14 @@ trx_start_low(
 
 	ut_a(rseg_id == ULINT_UNDEFINED);
 
+	trx->start_time = time(NULL);
+
+	/* The transaction does not need the kernel mutex to start:
+	trx_sys->mutex covers the id assignment and trx_list, so that
+	starting transactions does not contend with the lock system. */
+
+	trx_sys_mutex_enter();
+
 	rseg = trx_assign_rseg(srv_rollback_segments);
 
 	trx->id = trx_sys_get_new_trx_id();
@@ -722,10 +742,11 @@ trx_start_low(
 	trx->rseg = rseg;
 
 	trx->conc_state = TRX_ACTIVE;
-	trx->start_time = time(NULL);
 
 	UT_LIST_ADD_FIRST(trx_list, trx_sys->trx_list, trx);
 
+	trx_sys_mutex_exit();
+
 	return(TRUE);
 }
 
@@ -751,12 +772,8 @@ trx_start(
 	generated by the same transaction, doesn't. */
 	trx->support_xa = thd_supports_xa(trx->mysql_thd);
 
-	mutex_enter(&kernel_mutex);
-
 	ret = trx_start_low(trx, rseg_id);
 
-	mutex_exit(&kernel_mutex);
-
 	return(ret);
 }
 
@@ -774,7 +791,7 @@ trx_serialisation_number_get(
 
 	ut_ad(mutex_own(&rseg->mutex));
 
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 
 	trx->no = trx_sys_get_new_trx_id();
 
@@ -792,19 +809,19 @@ trx_serialisation_number_get(
 
 		mutex_enter(&purge_sys->bh_mutex);
 
-		/* This is to reduce the pressure on the kernel mutex,
+		/* This is to reduce the pressure on trx_sys->mutex,
 		though in reality it should make very little (read no)
 		difference because this code path is only taken when the
 		rbs is empty. */
 
-		mutex_exit(&kernel_mutex);
+		trx_sys_mutex_exit();
 
 		ptr = ib_bh_push(purge_sys->ib_bh, &rseg_queue);
 		ut_a(ptr);
 
 		mutex_exit(&purge_sys->bh_mutex);
 	} else {
-		mutex_exit(&kernel_mutex);
+		trx_sys_mutex_exit();
 	}
 }
 
@@ -956,7 +973,9 @@ trx_commit_off_kernel(
 	committed. */
 
 	/*--------------------------------------*/
+	trx_sys_mutex_enter();
 	trx->conc_state = TRX_COMMITTED_IN_MEMORY;
+	trx_sys_mutex_exit();
 	/*--------------------------------------*/
 
 	/* If we release kernel_mutex below and we are still doing
@@ -975,6 +994,8 @@ trx_commit_off_kernel(
 
 	lock_release_off_kernel(trx);
 
+	read_view_mutex_enter();
+
 	if (trx->global_read_view) {
 		read_view_close(trx->global_read_view);
 		mem_heap_empty(trx->global_read_view_heap);
@@ -983,6 +1004,8 @@ trx_commit_off_kernel(
 
 	trx->read_view = NULL;
 
+	read_view_mutex_exit();
+
 	if (lsn) {
 
 		mutex_exit(&kernel_mutex);
@@ -1012,13 +1035,13 @@ trx_commit_off_kernel(
 		there are > 2 users in the database. Then at least 2 users can
 		gather behind one doing the physical log write to disk.
 
-		If we are calling trx_commit() under prepare_commit_mutex, we
+		If we are calling trx_commit() in binlog commit order, we
 		will delay possible log write and flush to a separate function
 		trx_commit_complete_for_mysql(), which is only called when the
-		thread has released the mutex. This is to make the
-		group commit algorithm to work. Otherwise, the prepare_commit
-		mutex would serialize all commits and prevent a group of
-		transactions from gathering. */
+		next transaction has been allowed to commit. This is to make
+		the group commit algorithm to work. Otherwise, the binlog
+		commit order would serialize all commits and prevent a group
+		of transactions from gathering. */
 
 		if (trx->flush_log_later) {
 			/* Do nothing yet */
@@ -1056,16 +1079,20 @@ trx_commit_off_kernel(
 	/* Free all savepoints */
 	trx_roll_free_all_savepoints(trx);
 
+	ut_ad(UT_LIST_GET_LEN(trx->wait_thrs) == 0);
+	ut_ad(UT_LIST_GET_LEN(trx->trx_locks) == 0);
+
+	trx_sys_mutex_enter();
+
 	trx->conc_state = TRX_NOT_STARTED;
 	trx->rseg = NULL;
 	trx->undo_no = 0;
 	trx->last_sql_stat_start.least_undo_no = 0;
 
-	ut_ad(UT_LIST_GET_LEN(trx->wait_thrs) == 0);
-	ut_ad(UT_LIST_GET_LEN(trx->trx_locks) == 0);
-
 	UT_LIST_REMOVE(trx_list, trx_sys->trx_list, trx);
 
+	trx_sys_mutex_exit();
+
 	trx->error_state = DB_SUCCESS;
 }
 
@@ -1084,12 +1111,18 @@ trx_cleanup_at_db_startup(
 		trx_undo_insert_cleanup(trx);
 	}
 
+	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
+
 	trx->conc_state = TRX_NOT_STARTED;
 	trx->rseg = NULL;
 	trx->undo_no = 0;
 	trx->last_sql_stat_start.least_undo_no = 0;
 
 	UT_LIST_REMOVE(trx_list, trx_sys->trx_list, trx);
+
+	trx_sys_mutex_exit();
+	mutex_exit(&kernel_mutex);
 }
 
 /********************************************************************//**
@@ -1109,7 +1142,7 @@ trx_assign_read_view(
 		return(trx->read_view);
 	}
 
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 
 	if (!trx->read_view) {
 		trx->read_view = read_view_open_now(
@@ -1117,7 +1150,7 @@ trx_assign_read_view(
 		trx->global_read_view = trx->read_view;
 	}
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 
 	return(trx->read_view);
 }
@@ -1966,7 +1999,9 @@ trx_prepare_off_kernel(
 	ut_ad(mutex_own(&kernel_mutex));
 
 	/*--------------------------------------*/
+	trx_sys_mutex_enter();
 	trx->conc_state = TRX_PREPARED;
+	trx_sys_mutex_exit();
 	trx_n_prepared++;
 	/*--------------------------------------*/
 
@@ -2067,7 +2102,7 @@ trx_recover_for_mysql(
 	/* We should set those transactions which are in the prepared state
 	to the xid_list */
 
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 
 	trx = UT_LIST_GET_FIRST(trx_sys->trx_list);
 
@@ -2104,7 +2139,7 @@ trx_recover_for_mysql(
 		trx = UT_LIST_GET_NEXT(trx_list, trx);
 	}
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 
 	if (count > 0){
 		ut_print_timestamp(stderr);
@@ -2134,7 +2169,7 @@ trx_get_trx_by_xid(
 		return(NULL);
 	}
 
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 
 	trx = UT_LIST_GET_FIRST(trx_sys->trx_list);
 
@@ -2161,7 +2196,7 @@ trx_get_trx_by_xid(
 		trx = UT_LIST_GET_NEXT(trx_list, trx);
 	}
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 
 	return(trx);
 }
@@ -0,0 +1,213 @@
+/*****************************************************************************
+
+Copyright (c) 2012, Oracle and/or its affiliates. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+*****************************************************************************/
+
+/***************************************************************//**
+@file ut/ut0crc32.c
+CRC32C (CRC-32 with the Castagnoli polynomial) implementation
+
+There are two implementations: one using the crc32 instruction of
+SSE4.2 capable x86-64 CPUs, and a table driven "slice-by-8" software
+implementation which processes 8 bytes per step. The software tables
+are computed at startup by ut_crc32_init(), which also picks the
+implementation that ut_crc32 points to.
+********************************************************************/
+
+#include "univ.i"
+#include "ut0crc32.h"
+
+/** The reflected Castagnoli polynomial */
+#define UT_CRC32_POLY	0x82F63B78UL
+
+/** Pointer to the CRC32C implementation chosen by ut_crc32_init() */
+UNIV_INTERN ib_ut_crc32_t	ut_crc32;
+
+/** TRUE if ut_crc32() uses the SSE4.2 crc32 instruction */
+UNIV_INTERN ibool		ut_crc32_sse42_enabled = FALSE;
+
+/** Lookup tables of the slice-by-8 implementation; ut_crc32_slice8_table[k]
+gives the CRC of a byte followed by k zero bytes */
+static ib_uint32_t	ut_crc32_slice8_table[8][256];
+
+/** TRUE once ut_crc32_slice8_table[][] has been computed */
+static ibool		ut_crc32_slice8_table_initialized = FALSE;
+
+#if defined(__GNUC__) && defined(__x86_64__)
+/********************************************************************//**
+Checks whether the CPU supports the SSE4.2 crc32 instruction.
+@return	TRUE if supported */
+static
+ibool
+ut_cpuid_has_sse42(void)
+/*====================*/
+{
+	ib_uint32_t	eax;
+	ib_uint32_t	ebx;
+	ib_uint32_t	ecx;
+	ib_uint32_t	edx;
+
+	asm("cpuid"
+	    : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+	    : "a" (0));
+
+	if (eax < 1) {
+		return(FALSE);
+	}
+
+	asm("cpuid"
+	    : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+	    : "a" (1));
+
+	/* CPUID.01H:ECX.SSE42[bit 20] */
+	return((ecx >> 20) & 1);
+}
+
+/********************************************************************//**
+Calculates CRC32C using the SSE4.2 crc32 instruction.
+@return	CRC32C */
+static
+ib_uint32_t
+ut_crc32_sse42(
+/*===========*/
+	const byte*	buf,	/*!< in: data over which to calculate CRC32C */
+	ulint		len)	/*!< in: data length in bytes */
+{
+	ib_uint64_t	crc = (ib_uint32_t) (-1);
+
+	ut_a(ut_crc32_sse42_enabled);
+
+	while (len > 0 && ((ulint) buf & 7)) {
+		asm("crc32b %1, %0" : "+r" (crc) : "rm" (*buf));
+		buf++;
+		len--;
+	}
+
+	while (len >= 8) {
+		asm("crc32q %1, %0"
+		    : "+r" (crc) : "rm" (*(const ib_uint64_t*) buf));
+		buf += 8;
+		len -= 8;
+	}
+
+	while (len > 0) {
+		asm("crc32b %1, %0" : "+r" (crc) : "rm" (*buf));
+		buf++;
+		len--;
+	}
+
+	return((ib_uint32_t) ~crc);
+}
+#endif /* __GNUC__ && __x86_64__ */
+
+/********************************************************************//**
+Computes the lookup tables of the slice-by-8 implementation. */
+static
+void
+ut_crc32_slice8_table_init(void)
+/*============================*/
+{
+	ulint		i;
+	ulint		j;
+	ulint		k;
+	ib_uint32_t	c;
+
+	for (i = 0; i < 256; i++) {
+		c = (ib_uint32_t) i;
+		for (j = 0; j < 8; j++) {
+			c = (c & 1) ? (c >> 1) ^ UT_CRC32_POLY : (c >> 1);
+		}
+		ut_crc32_slice8_table[0][i] = c;
+	}
+
+	for (i = 0; i < 256; i++) {
+		c = ut_crc32_slice8_table[0][i];
+		for (k = 1; k < 8; k++) {
+			c = ut_crc32_slice8_table[0][c & 0xFF] ^ (c >> 8);
+			ut_crc32_slice8_table[k][i] = c;
+		}
+	}
+
+	ut_crc32_slice8_table_initialized = TRUE;
+}
+
+/********************************************************************//**
+Calculates CRC32C using the slice-by-8 lookup tables. The input is
+consumed byte by byte within each 8-byte step, so that the result
+does not depend on the byte order of the CPU.
+@return	CRC32C */
+static
+ib_uint32_t
+ut_crc32_slice8(
+/*============*/
+	const byte*	buf,	/*!< in: data over which to calculate CRC32C */
+	ulint		len)	/*!< in: data length in bytes */
+{
+	ib_uint32_t	(*t)[256] = ut_crc32_slice8_table;
+	ib_uint32_t		crc = (ib_uint32_t) (-1);
+
+	ut_a(ut_crc32_slice8_table_initialized);
+
+	while (len >= 8) {
+		crc ^= (ib_uint32_t) buf[0]
+			| ((ib_uint32_t) buf[1] << 8)
+			| ((ib_uint32_t) buf[2] << 16)
+			| ((ib_uint32_t) buf[3] << 24);
+
+		crc = t[7][crc & 0xFF]
+			^ t[6][(crc >> 8) & 0xFF]
+			^ t[5][(crc >> 16) & 0xFF]
+			^ t[4][crc >> 24]
+			^ t[3][buf[4]]
+			^ t[2][buf[5]]
+			^ t[1][buf[6]]
+			^ t[0][buf[7]];
+
+		buf += 8;
+		len -= 8;
+	}
+
+	while (len > 0) {
+		crc = t[0][(crc ^ *buf) & 0xFF] ^ (crc >> 8);
+		buf++;
+		len--;
+	}
+
+	return(~crc);
+}
+
+/********************************************************************//**
+Initializes the data structures used by ut_crc32(). Selects the
+SSE4.2 implementation if the CPU supports the crc32 instruction and
+the slice-by-8 table driven implementation otherwise. Must be called
+before ut_crc32() is used. */
+UNIV_INTERN
+void
+ut_crc32_init(void)
+/*===============*/
+{
+#if defined(__GNUC__) && defined(__x86_64__)
+	ut_crc32_sse42_enabled = ut_cpuid_has_sse42();
+
+	if (ut_crc32_sse42_enabled) {
+		ut_crc32 = ut_crc32_sse42;
+		return;
+	}
+#endif /* __GNUC__ && __x86_64__ */
+
+	ut_crc32_slice8_table_init();
+	ut_crc32 = ut_crc32_slice8;
+}
@@ -648,7 +648,9 @@ ha_myisam::ha_myisam(handlerton *hton, TABLE_SHARE *table_arg)
                   HA_CAN_INSERT_DELAYED | HA_CAN_BIT_FIELD | HA_CAN_RTREEKEYS |
                   HA_HAS_RECORDS | HA_STATS_RECORDS_IS_EXACT | HA_CAN_REPAIR),
    can_enable_indexes(1)
-{}
+{
+  ds_mrr.init(this);
+}
 
 handler *ha_myisam::clone(const char *name, MEM_ROOT *mem_root)
 {
@@ -806,6 +808,7 @@ int ha_myisam::open(const char *name, int mode, uint test_if_locked)
 int ha_myisam::close(void)
 {
   MI_INFO *tmp=file;
+  ds_mrr.reset();
   file=0;
   return mi_close(tmp);
 }
@@ -1625,7 +1628,17 @@ int ha_myisam::index_read_idx_map(uchar *buf, uint index, const uchar *key,
 {
   MYSQL_INDEX_READ_ROW_START(table_share->db.str, table_share->table_name.str);
   ha_statistic_increment(&SSV::ha_read_key_count);
+  /*
+    Check the pushed index condition only if it was pushed for 'index'.
+    This lookup is not part of a range scan, so no end of range applies.
+  */
+  end_range= NULL;
+  mi_set_index_cond_func(file, index == pushed_idx_cond_keyno ?
+                         handler_index_cond_check : NULL, this);
   int error=mi_rkey(file, buf, index, key, keypart_map, find_flag);
+  mi_set_index_cond_func(file, pushed_idx_cond &&
+                         active_index == pushed_idx_cond_keyno ?
+                         handler_index_cond_check : NULL, this);
   table->status=error ? STATUS_NOT_FOUND: 0;
   MYSQL_INDEX_READ_ROW_DONE(error);
   return error;
@@ -1706,6 +1719,65 @@ int ha_myisam::index_next_same(uchar *buf,
   return error;
 }
 
+int ha_myisam::index_init(uint idx, bool sorted)
+{
+  active_index= idx;
+  if (idx == pushed_idx_cond_keyno)
+    mi_set_index_cond_func(file, handler_index_cond_check, this);
+  return 0;
+}
+
+int ha_myisam::index_end()
+{
+  active_index= MAX_KEY;
+  mi_set_index_cond_func(file, NULL, 0);
+  ds_mrr.dsmrr_close();
+  return 0;
+}
+
+int ha_myisam::read_multi_range_first(KEY_MULTI_RANGE **found_range_p,
+                                      KEY_MULTI_RANGE *ranges,
+                                      uint range_count, bool sorted,
+                                      HANDLER_BUFFER *buffer)
+{
+  return ds_mrr.dsmrr_first(found_range_p, ranges, range_count, sorted,
+                            buffer);
+}
+
+int ha_myisam::read_multi_range_next(KEY_MULTI_RANGE **found_range_p)
+{
+  return ds_mrr.dsmrr_next(found_range_p);
+}
+
+bool ha_myisam::multi_range_read_info(uint keynr, ha_rows rows, uint *bufsz,
+                                      ha_rows *buf_rows)
+{
+  return ds_mrr.dsmrr_info(keynr, rows, bufsz, buf_rows);
+}
+
+
+/*
+  The pushed index condition is checked by mi_rkey(), mi_rnext(),
+  mi_rnext_same() and mi_rprev() on the unpacked key, before the row
+  is read from the data file.
+*/
+
+Item *ha_myisam::idx_cond_push(uint keyno, Item *idx_cond)
+{
+  pushed_idx_cond_keyno= keyno;
+  pushed_idx_cond= idx_cond;
+  if (active_index == keyno)
+    mi_set_index_cond_func(file, handler_index_cond_check, this);
+  return NULL;
+}
+
+void ha_myisam::cancel_pushed_idx_cond()
+{
+  handler::cancel_pushed_idx_cond();
+  if (file)
+    mi_set_index_cond_func(file, NULL, 0);
+}
+
 
 int ha_myisam::rnd_init(bool scan)
 {
@@ -1714,6 +1786,12 @@ int ha_myisam::rnd_init(bool scan)
   return mi_reset(file);                        // Free buffers
 }
 
+int ha_myisam::rnd_end()
+{
+  ds_mrr.dsmrr_close();
+  return 0;
+}
+
 int ha_myisam::rnd_next(uchar *buf)
 {
   MYSQL_READ_ROW_START(table_share->db.str, table_share->table_name.str,
@@ -1826,6 +1904,7 @@ int ha_myisam::extra(enum ha_extra_function operation)
 
 int ha_myisam::reset(void)
 {
+  ds_mrr.reset();
   return mi_reset(file);
 }
 
@@ -1869,6 +1948,8 @@ int ha_myisam::delete_table(const char *name)
 
 int ha_myisam::external_lock(THD *thd, int lock_type)
 {
+  if (lock_type == F_UNLCK)
+    ds_mrr.reset();
   file->in_use.data= thd;
   return mi_lock_database(file, !table->s->tmp_table ?
 			  lock_type : ((lock_type == F_UNLCK) ?
@@ -2110,7 +2191,8 @@ static int myisam_init(void *p)
   myisam_hton->db_type= DB_TYPE_MYISAM;
   myisam_hton->create= myisam_create_handler;
   myisam_hton->panic= myisam_panic;
-  myisam_hton->flags= HTON_CAN_RECREATE | HTON_SUPPORT_LOG_TABLES;
+  myisam_hton->flags= HTON_CAN_RECREATE | HTON_SUPPORT_LOG_TABLES |
+                      HTON_SUPPORTS_PARALLEL_SCAN;
   myisam_hton->is_supported_system_table= myisam_is_supported_system_table;
 
   return 0;
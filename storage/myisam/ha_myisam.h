@@ -45,6 +45,7 @@ class ha_myisam: public handler
   ulonglong int_table_flags;
   char    *data_file_name, *index_file_name;
   bool can_enable_indexes;
+  DsMrr_impl ds_mrr;
   int repair(THD *thd, MI_CHECK &param, bool optimize);
 
  public:
@@ -57,9 +58,12 @@ class ha_myisam: public handler
   ulonglong table_flags() const { return int_table_flags; }
   ulong index_flags(uint inx, uint part, bool all_parts) const
   {
-    return ((table_share->key_info[inx].algorithm == HA_KEY_ALG_FULLTEXT) ?
-            0 : HA_READ_NEXT | HA_READ_PREV | HA_READ_RANGE |
-            HA_READ_ORDER | HA_KEYREAD_ONLY);
+    if (table_share->key_info[inx].algorithm == HA_KEY_ALG_FULLTEXT)
+      return 0;
+    return (HA_READ_NEXT | HA_READ_PREV | HA_READ_RANGE |
+            HA_READ_ORDER | HA_KEYREAD_ONLY |
+            (table_share->key_info[inx].algorithm == HA_KEY_ALG_RTREE ?
+             0 : HA_DO_INDEX_COND_PUSHDOWN));
   }
   uint max_supported_keys()          const { return MI_MAX_KEY; }
   uint max_supported_key_length()    const { return MI_MAX_KEY_LENGTH; }
@@ -83,6 +87,16 @@ class ha_myisam: public handler
   int index_first(uchar * buf);
   int index_last(uchar * buf);
   int index_next_same(uchar *buf, const uchar *key, uint keylen);
+  int index_init(uint idx, bool sorted);
+  int index_end();
+  int read_multi_range_first(KEY_MULTI_RANGE **found_range_p,
+                             KEY_MULTI_RANGE *ranges, uint range_count,
+                             bool sorted, HANDLER_BUFFER *buffer);
+  int read_multi_range_next(KEY_MULTI_RANGE **found_range_p);
+  bool multi_range_read_info(uint keynr, ha_rows rows, uint *bufsz,
+                             ha_rows *buf_rows);
+  Item *idx_cond_push(uint keyno, Item *idx_cond);
+  void cancel_pushed_idx_cond();
   int ft_init()
   {
     if (!ft_handler)
@@ -98,6 +112,7 @@ class ha_myisam: public handler
   }
   int ft_read(uchar *buf);
   int rnd_init(bool scan);
+  int rnd_end();
   int rnd_next(uchar *buf);
   int rnd_pos(uchar * buf, uchar *pos);
   int restart_rnd_next(uchar *buf, uchar *pos);
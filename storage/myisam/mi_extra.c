@@ -443,3 +443,16 @@ int mi_reset(MI_INFO *info)
                  HA_STATE_PREV_FOUND);
   DBUG_RETURN(error);
 }
+
+
+/*
+  Set the function used to check the index condition pushed down by the
+  SQL layer; NULL disables the check.
+*/
+
+void mi_set_index_cond_func(MI_INFO *info, index_cond_func_t check_func,
+                            void *func_arg)
+{
+  info->index_cond_func= check_func;
+  info->index_cond_func_arg= func_arg;
+}
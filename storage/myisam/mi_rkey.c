@@ -30,6 +30,7 @@ int mi_rkey(MI_INFO *info, uchar *buf, int inx, const uchar *key,
   MI_KEYDEF *keyinfo;
   HA_KEYSEG *last_used_keyseg;
   uint pack_key_length, use_key_length, nextflag;
+  int res= ICP_MATCH;
   DBUG_ENTER("mi_rkey");
   DBUG_PRINT("enter", ("base: 0x%lx  buf: 0x%lx  inx: %d  search_flag: %d",
                        (long) info, (long) buf, inx, search_flag));
@@ -105,53 +106,59 @@ int mi_rkey(MI_INFO *info, uchar *buf, int inx, const uchar *key,
         to the end of the file. So we can test if the found key
         references a new record.
       */
-      if (info->lastpos >= info->state->data_file_length)
+      if (info->lastpos >= info->state->data_file_length &&
+          search_flag == HA_READ_KEY_EXACT &&
+          last_used_keyseg == keyinfo->seg + keyinfo->keysegs)
       {
-        /* The key references a concurrently inserted record. */
-        if (search_flag == HA_READ_KEY_EXACT &&
-            last_used_keyseg == keyinfo->seg + keyinfo->keysegs)
-        {
-          /* Simply ignore the key if it matches exactly. (Bug #29838) */
-          my_errno= HA_ERR_KEY_NOT_FOUND;
-          info->lastpos= HA_OFFSET_ERROR;
-        }
-        else
+        /* Simply ignore the key if it matches exactly. (Bug #29838) */
+        my_errno= HA_ERR_KEY_NOT_FOUND;
+        info->lastpos= HA_OFFSET_ERROR;
+      }
+      else
+      {
+        /*
+          If searching for a partial key (or using >, >=, < or <=) and
+          the data is outside of the data file, we need to continue
+          searching for the first key inside the data file.
+
+          We also continue searching while the index condition pushed
+          down by the SQL layer rejects the found key.
+        */
+        while (info->lastpos >= info->state->data_file_length ||
+               (buf && info->index_cond_func &&
+                (res= mi_check_index_cond(info, inx, buf)) == ICP_NO_MATCH))
         {
+          uint not_used[2];
           /*
-            If searching for a partial key (or using >, >=, < or <=) and
-            the data is outside of the data file, we need to continue
-            searching for the first key inside the data file.
+            Skip rows that are inserted by other threads since we got
+            a lock. Note that this can only happen if we are not
+            searching after a full length exact key, because the keys
+            are sorted according to position.
           */
-          do
+          if  (_mi_search_next(info, keyinfo, info->lastkey,
+                               info->lastkey_length,
+                               myisam_readnext_vec[search_flag],
+                               info->s->state.key_root[inx]))
+            break; /* purecov: inspected */
+          /*
+            Check that the found key does still match the search.
+            _mi_search_next() delivers the next key regardless of its
+            value.
+          */
+          if (search_flag == HA_READ_KEY_EXACT &&
+              ha_key_cmp(keyinfo->seg, key_buff, info->lastkey,
+                         use_key_length, SEARCH_FIND, not_used))
           {
-            uint not_used[2];
-            /*
-              Skip rows that are inserted by other threads since we got
-              a lock. Note that this can only happen if we are not
-              searching after a full length exact key, because the keys
-              are sorted according to position.
-            */
-            if  (_mi_search_next(info, keyinfo, info->lastkey,
-                                 info->lastkey_length,
-                                 myisam_readnext_vec[search_flag],
-                                 info->s->state.key_root[inx]))
-              break; /* purecov: inspected */
-            /*
-              Check that the found key does still match the search.
-              _mi_search_next() delivers the next key regardless of its
-              value.
-            */
-            if (search_flag == HA_READ_KEY_EXACT &&
-                ha_key_cmp(keyinfo->seg, key_buff, info->lastkey,
-                           use_key_length, SEARCH_FIND, not_used))
-            {
-              /* purecov: begin inspected */
-              my_errno= HA_ERR_KEY_NOT_FOUND;
-              info->lastpos= HA_OFFSET_ERROR;
-              break;
-              /* purecov: end */
-            }
-          } while (info->lastpos >= info->state->data_file_length);
+            my_errno= HA_ERR_KEY_NOT_FOUND;
+            info->lastpos= HA_OFFSET_ERROR;
+            break;
+          }
+        }
+        if (res == ICP_OUT_OF_RANGE)
+        {
+          /* Change error from HA_ERR_END_OF_FILE */
+          my_errno= HA_ERR_KEY_NOT_FOUND;
+          info->lastpos= HA_OFFSET_ERROR;
         }
       }
     }
@@ -29,6 +29,7 @@ int mi_rnext_same(MI_INFO *info, uchar *buf)
 {
   int error;
   uint inx,not_used[2];
+  int res= ICP_MATCH;
   MI_KEYDEF *keyinfo;
   DBUG_ENTER("mi_rnext_same");
 
@@ -76,9 +77,18 @@ int mi_rnext_same(MI_INFO *info, uchar *buf)
           info->lastpos= HA_OFFSET_ERROR;
           break;
         }
-        /* Skip rows that are inserted by other threads since we got a lock */
-        if (info->lastpos < info->state->data_file_length)
+        /*
+          Skip rows that are inserted by other threads since we got a
+          lock, and rows that do not match the pushed index condition
+        */
+        if (info->lastpos < info->state->data_file_length &&
+            (!buf || !info->index_cond_func ||
+             (res= mi_check_index_cond(info, inx, buf)) != ICP_NO_MATCH))
+        {
+          if (res != ICP_MATCH)
+            error= 1;                           /* Out of range or crashed */
           break;
+        }
       }
   }
   if (info->s->concurrent_insert)
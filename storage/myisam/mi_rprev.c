@@ -27,6 +27,7 @@ int mi_rprev(MI_INFO *info, uchar *buf, int inx)
 {
   int error,changed;
   register uint flag;
+  int res= ICP_MATCH;
   MYISAM_SHARE *share=info->s;
   DBUG_ENTER("mi_rprev");
 
@@ -52,22 +53,28 @@ int mi_rprev(MI_INFO *info, uchar *buf, int inx)
     error=_mi_search(info,share->keyinfo+inx,info->lastkey,
 		     USE_WHOLE_KEY, flag, share->state.key_root[inx]);
 
-  if (share->concurrent_insert)
+  if (!error)
   {
-    if (!error)
+    while ((share->concurrent_insert &&
+            info->lastpos >= info->state->data_file_length) ||
+           (buf && info->index_cond_func &&
+            (res= mi_check_index_cond(info, inx, buf)) == ICP_NO_MATCH))
     {
-      while (info->lastpos >= info->state->data_file_length)
-      {
-	/* Skip rows that are inserted by other threads since we got a lock */
-	if  ((error=_mi_search_next(info,share->keyinfo+inx,info->lastkey,
-				    info->lastkey_length,
-				    SEARCH_SMALLER,
-				    share->state.key_root[inx])))
-	  break;
-      }
+      /*
+        Skip rows that are inserted by other threads since we got a lock,
+        and rows that do not match the pushed index condition
+      */
+      if  ((error=_mi_search_next(info,share->keyinfo+inx,info->lastkey,
+                                  info->lastkey_length,
+                                  SEARCH_SMALLER,
+                                  share->state.key_root[inx])))
+        break;
     }
-    mysql_rwlock_unlock(&share->key_root_lock[inx]);
+    if (!error && res != ICP_MATCH)
+      error= 1;                                 /* Out of range or crashed */
   }
+  if (share->concurrent_insert)
+    mysql_rwlock_unlock(&share->key_root_lock[inx]);
   info->update&= (HA_STATE_CHANGED | HA_STATE_ROW_CHANGED);
   info->update|= HA_STATE_PREV_FOUND;
   if (error)